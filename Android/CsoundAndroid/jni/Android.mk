@@ -73,6 +73,7 @@ $(CSOUND_SRC_ROOT)/OOps/dumpf.c \
 $(CSOUND_SRC_ROOT)/OOps/fftlib.c \
 $(CSOUND_SRC_ROOT)/OOps/lpred.c \
 $(CSOUND_SRC_ROOT)/OOps/pffft.c \
+$(CSOUND_SRC_ROOT)/OOps/pffftd.c \
 $(CSOUND_SRC_ROOT)/OOps/goto_ops.c \
 $(CSOUND_SRC_ROOT)/OOps/midiinterop.c \
 $(CSOUND_SRC_ROOT)/OOps/midiops.c \
@@ -96,6 +97,8 @@ $(CSOUND_SRC_ROOT)/OOps/ugens6.c \
 $(CSOUND_SRC_ROOT)/OOps/ugtabs.c \
 $(CSOUND_SRC_ROOT)/OOps/ugrw1.c \
 $(CSOUND_SRC_ROOT)/OOps/vdelay.c \
+$(CSOUND_SRC_ROOT)/OOps/vecops.c \
+$(CSOUND_SRC_ROOT)/OOps/vecmath.c \
 $(CSOUND_SRC_ROOT)/OOps/compile_ops.c \
 $(CSOUND_SRC_ROOT)/Opcodes/babo.c \
 $(CSOUND_SRC_ROOT)/Opcodes/bilbar.c \
@@ -161,6 +164,7 @@ $(CSOUND_SRC_ROOT)/Top/cscorfns.c \
 $(CSOUND_SRC_ROOT)/Top/csmodule.c \
 $(CSOUND_SRC_ROOT)/Top/csound.c \
 $(CSOUND_SRC_ROOT)/Top/getstring.c \
+$(CSOUND_SRC_ROOT)/Top/lockstep.c \
 $(CSOUND_SRC_ROOT)/Top/main.c \
 $(CSOUND_SRC_ROOT)/Top/new_opts.c \
 $(CSOUND_SRC_ROOT)/Top/one_file.c \
@@ -179,6 +183,7 @@ $(CSOUND_SRC_ROOT)/Opcodes/cross2.c \
 $(CSOUND_SRC_ROOT)/Opcodes/dam.c            \
 $(CSOUND_SRC_ROOT)/Opcodes/dcblockr.c       \
 $(CSOUND_SRC_ROOT)/Opcodes/filter.c \
+$(CSOUND_SRC_ROOT)/Opcodes/filterbank.c \
 $(CSOUND_SRC_ROOT)/Opcodes/flanger.c        \
 $(CSOUND_SRC_ROOT)/Opcodes/follow.c         \
 $(CSOUND_SRC_ROOT)/Opcodes/fout.c \
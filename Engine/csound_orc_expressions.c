@@ -28,13 +28,16 @@
 #include "csound_type_system.h"
 #include "csound_orc_semantics.h"
 #include "csound_standard_types.h"
+#include "aops.h"
 #include <inttypes.h>
 
 extern void print_tree(CSOUND *, char *, TREE *);
 extern void handle_optional_args(CSOUND *, TREE *);
 extern ORCTOKEN *make_token(CSOUND *, char *);
 extern ORCTOKEN *make_label(CSOUND *, char *);
+extern ORCTOKEN *make_string(CSOUND *, char *);
 extern OENTRIES* find_opcode2(CSOUND *, char*);
+extern OENTRY* resolve_opcode(CSOUND*, OENTRIES*, char*, char*);
 extern char* resolve_opcode_get_outarg(CSOUND* , OENTRIES* , char*);
 extern TREE* appendToTree(CSOUND * csound, TREE *first, TREE *newlast);
 extern  char* get_arg_string_from_tree(CSOUND* csound, TREE* tree,
@@ -58,7 +61,6 @@ extern CS_VARIABLE* find_var_from_pools(CSOUND* csound, char* varName,
                                  char* varBaseName, TYPE_TABLE* typeTable);
 
 
-static int32_t genlabs = 300;
 
 TREE* tree_tail(TREE* node) {
   TREE* t = node;
@@ -195,7 +197,8 @@ static TREE * create_ans_token(CSOUND *csound, char* var)
 }
 
 static TREE * create_goto_token(CSOUND *csound, char * booleanVar,
-                                TREE * gotoNode, int32_t type)
+                                TREE * gotoNode, int32_t type,
+                                TYPE_TABLE *typeTable)
 {
   char* op = (char *)csound->Malloc(csound, 8); /* Unchecked */
   TREE *opTree, *bVar;
@@ -214,7 +217,7 @@ static TREE * create_goto_token(CSOUND *csound, char * booleanVar,
     break;
   case THEN_TOKEN:
     // *** yi ***
-    if (csound->inZero) goto icase;
+    if (typeTable->inZero) goto icase;
     /* fall through */
   case KTHEN_TOKEN:
     strNcpy(op, "cngoto", 8);
@@ -226,7 +229,7 @@ static TREE * create_goto_token(CSOUND *csound, char * booleanVar,
     case 0: strNcpy(op, "cggoto", 8); break;
     case 0x8000:
       // *** yi ***
-      strNcpy(op,csound->inZero? "cingoto":"cngoto", 8);
+      strNcpy(op,typeTable->inZero? "cingoto":"cngoto", 8);
       break;
     default: printf("Whooops %d\n", type);
     }
@@ -247,12 +250,13 @@ static TREE * create_goto_token(CSOUND *csound, char * booleanVar,
 
 /* THIS PROBABLY NEEDS TO CHANGE TO RETURN DIFFERENT GOTO
    TYPES LIKE IGOTO, ETC */
-static TREE *create_simple_goto_token(CSOUND *csound, TREE *label, int32_t type)
+static TREE *create_simple_goto_token(CSOUND *csound, TREE *label, int32_t type,
+                                       TYPE_TABLE *typeTable)
 {
   char* op = (char *)csound->Calloc(csound, 6);
   TREE * opTree;
   char *gt[3] = {"kgoto", "igoto", "goto"};
-  if (csound->inZero && type==2) type = 1;
+  if (typeTable->inZero && type==2) type = 1;
   strNcpy(op, gt[type],6);       /* kgoto, igoto, goto ?? */
   opTree = create_opcode_token(csound, op);
   opTree->left = NULL;
@@ -318,7 +322,7 @@ static TREE *create_cond_expression(CSOUND *csound,
                                     TYPE_TABLE* typeTable)
 {
   TREE *last = NULL;
-  int32 ln1 = genlabs++, ln2 = genlabs++;
+  int32 ln1 = typeTable->labelCount++, ln2 = typeTable->labelCount++;
   TREE *L1 = create_synthetic_label(csound, ln1);
   TREE *L2 = create_synthetic_label(csound, ln2);
   TREE *b = create_boolean_expression(csound, root->left, line, locn,
@@ -393,7 +397,8 @@ static TREE *create_cond_expression(CSOUND *csound,
   last->next = d;
   while (last->next != NULL) last = last->next;
   //Last is now last assignment
-  last->next = create_simple_goto_token(csound, L2, type==2?0:type);
+  last->next = create_simple_goto_token(csound, L2, type==2?0:type,
+                                        typeTable);
   while (last->next != NULL) last = last->next;
   last->next = create_synthetic_label(csound,ln1);
   while (last->next != NULL) last = last->next;
@@ -956,6 +961,215 @@ void handle_negative_number(CSOUND* csound, TREE* root)
 }
 
 
+/* Fusion of a-rate expressions: create_expression() gives every operator
+   its own opcode writing a synthetic a-rate variable. Trees of a-rate
+   arithmetic and math functions are folded into one ##fuse call instead,
+   which takes the tree in postfix form followed by its operands and
+   evaluates it without intermediate signals (see OOps/aops.c).         */
+
+static const struct {
+  const char *name;
+  char        code;
+} fuse_functions[] = {
+  { "abs", 'A' },    { "exp", 'E' },    { "log", 'L' },    { "log10", 'G' },
+  { "log2", 'B' },   { "sqrt", 'Q' },   { "sin", 'S' },    { "cos", 'C' },
+  { "tan", 'T' },    { "sininv", 'U' }, { "cosinv", 'V' }, { "taninv", 'W' },
+  { "sinh", 'H' },   { "cosh", 'K' },   { "tanh", 'N' },   { "int", 'I' },
+  { "frac", 'F' },   { "round", 'R' },  { "floor", 'D' },  { "ceil", 'P' },
+  { NULL, '\0' }
+};
+
+typedef struct {
+  char    prog[2 * FUSE_MAXARGS + 2];
+  TREE    *args[FUSE_MAXARGS];
+  TREE    *nodes[FUSE_MAXARGS];     /* absorbed opcode nodes */
+  int32_t len, nargs, nnodes, depth;
+} FUSE_PROG;
+
+/* true if node resolves to a built-in opcode: a UDO of the same name
+   (or an overload for these argument types) must be called as written */
+static int32_t fuse_builtin(CSOUND *csound, TREE *node, TYPE_TABLE *typeTable)
+{
+  OENTRIES *entries;
+  OENTRY *entry = NULL;
+  TREE *arg;
+  char intypes[8], *type;
+  int32_t len = 0;
+
+  for (arg = node->right; arg != NULL; arg = arg->next) {
+    type = get_arg_type2(csound, arg, typeTable);
+    if (type == NULL || type[1] != '\0' || len >= 2) {
+      csound->Free(csound, type);
+      return 0;
+    }
+    intypes[len++] = *type;
+    csound->Free(csound, type);
+  }
+  intypes[len] = '\0';
+  entries = find_opcode2(csound, node->value->lexeme);
+  if (entries == NULL)
+    return 0;
+  if (entries->count > 0)
+    entry = resolve_opcode(csound, entries, "a", intypes);
+  csound->Free(csound, entries);
+  return entry != NULL && entry->useropinfo == NULL;
+}
+
+/* postfix code of an opcode node that can be fused, 0 if it cannot */
+static char fuse_code(CSOUND *csound, TREE *node, TYPE_TABLE *typeTable)
+{
+  TREE *arg;
+  char *name, *out, code = '\0';
+  int32_t nargs = 0, i;
+
+  if (node->type != T_OPCALL || node->left == NULL ||
+      node->left->next != NULL || node->value->optype != NULL)
+    return '\0';
+  out = node->left->value->lexeme;
+  if (out[0] != '#' || out[1] != 'a')
+    return '\0';
+  for (arg = node->right; arg != NULL; arg = arg->next)
+    nargs++;
+  name = node->value->lexeme;
+  if (nargs == 2) {
+    if (!strcmp(name, "##add")) code = '+';
+    else if (!strcmp(name, "##sub")) code = '-';
+    else if (!strcmp(name, "##mul")) code = '*';
+    else if (!strcmp(name, "##div")) code = '/';
+    else if (!strcmp(name, "##mod")) code = '%';
+  }
+  else if (nargs == 1) {
+    for (i = 0; fuse_functions[i].name != NULL; i++)
+      if (!strcmp(name, fuse_functions[i].name)) {
+        code = fuse_functions[i].code;
+        break;
+      }
+  }
+  if (code != '\0' && !fuse_builtin(csound, node, typeTable))
+    code = '\0';
+  return code;
+}
+
+/* append node and the fusable nodes of chain feeding it to fp */
+static int32_t fuse_node(CSOUND *csound, TREE *chain, TREE *node,
+                         FUSE_PROG *fp, TYPE_TABLE *typeTable)
+{
+  TREE *arg, *src;
+  char code = fuse_code(csound, node, typeTable);
+
+  for (arg = node->right; arg != NULL; arg = arg->next) {
+    src = NULL;
+    if (arg->type == T_IDENT && arg->value->lexeme[0] == '#') {
+      for (src = chain; src != node; src = src->next)
+        if (src->left != NULL &&
+            !strcmp(src->left->value->lexeme, arg->value->lexeme))
+          break;
+      if (src == node || fuse_code(csound, src, typeTable) == '\0')
+        src = NULL;
+    }
+    if (src != NULL) {
+      if (fp->nnodes >= FUSE_MAXARGS ||
+          !fuse_node(csound, chain, src, fp, typeTable))
+        return 0;
+      fp->nodes[fp->nnodes++] = src;
+    }
+    else {
+      char *type;
+      if (fp->nargs >= FUSE_MAXARGS || ++fp->depth > FUSE_MAXDEPTH ||
+          (arg->type != T_IDENT && arg->type != NUMBER_TOKEN &&
+           arg->type != INTEGER_TOKEN))
+        return 0;
+      type = get_arg_type2(csound, arg, typeTable);
+      if (type == NULL || type[1] != '\0' || strchr("akicpr", *type) == NULL) {
+        csound->Free(csound, type);
+        return 0;
+      }
+      fp->prog[fp->len++] = (*type == 'a' ? 'a' : 'k');
+      fp->args[fp->nargs++] = arg;
+      csound->Free(csound, type);
+    }
+  }
+  if (node->right->next != NULL)    /* binary operators pop one */
+    fp->depth--;
+  fp->prog[fp->len++] = code;
+  return 1;
+}
+
+/* drop a synthetic variable that is no longer written by any opcode */
+static void fuse_remove_var(CSOUND *csound, char *name, TYPE_TABLE *typeTable)
+{
+  CS_VAR_POOL *pool = typeTable->localPool;
+  CS_VARIABLE *var = pool->head, *prv = NULL;
+
+  while (var != NULL && strcmp(var->varName, name)) {
+    prv = var;
+    var = var->next;
+  }
+  if (var == NULL)
+    return;
+  if (prv == NULL) pool->head = var->next;
+  else prv->next = var->next;
+  if (pool->tail == var) pool->tail = prv;
+  cs_hash_table_remove(csound, pool->table, name);
+  pool->poolSize -= var->memBlockSize;
+  pool->varCount--;
+}
+
+/* fuse the a-rate expression trees of an expression chain, working
+   back from its result so that each fused tree is as large as possible */
+static TREE *fuse_expression(CSOUND *csound, TREE *chain,
+                             TYPE_TABLE *typeTable)
+{
+  TREE *node, *prev, **nodes;
+  int32_t count = 0, i, j, k;
+
+  for (node = chain; node != NULL; node = node->next)
+    count++;
+  if (count < 2)
+    return chain;
+  nodes = (TREE**) csound->Malloc(csound, count * sizeof(TREE*));
+  for (i = 0, node = chain; node != NULL; node = node->next)
+    nodes[i++] = node;
+
+  for (i = count - 1; i > 0; i--) {
+    FUSE_PROG fp;
+    TREE *arg;
+    char *prog;
+
+    node = nodes[i];
+    if (node == NULL || fuse_code(csound, node, typeTable) == '\0')
+      continue;
+    memset(&fp, 0, sizeof(FUSE_PROG));
+    if (!fuse_node(csound, chain, node, &fp, typeTable) || fp.nnodes == 0)
+      continue;
+
+    /* the root becomes the ##fuse call, absorbed nodes leave the chain */
+    for (j = 0; j < fp.nnodes; j++) {
+      for (prev = NULL, node = chain; node != fp.nodes[j]; node = node->next)
+        prev = node;
+      if (prev == NULL) chain = node->next;
+      else prev->next = node->next;
+      fuse_remove_var(csound, node->left->value->lexeme, typeTable);
+      for (k = 0; nodes[k] != node; k++);
+      nodes[k] = NULL;
+    }
+    node = nodes[i];
+    prog = (char*) csound->Malloc(csound, fp.len + 3);
+    snprintf(prog, fp.len + 3, "\"%.*s\"", fp.len, fp.prog);
+    node->value->lexeme = cs_strdup(csound, "##fuse");
+    node->right = make_leaf(csound, node->line, node->locn, STRING_TOKEN,
+                            make_string(csound, prog));
+    for (arg = node->right, j = 0; j < fp.nargs; j++) {
+      arg->next = fp.args[j];
+      arg = arg->next;
+    }
+    arg->next = NULL;
+    csound->Free(csound, prog);
+  }
+  csound->Free(csound, nodes);
+  return chain;
+}
+
 static void collapse_last_assigment(CSOUND* csound, TREE* anchor,
                                     TYPE_TABLE* typeTable)
 {
@@ -1021,6 +1235,9 @@ TREE* expand_statement(CSOUND* csound, TREE* current, TYPE_TABLE* typeTable)
         expressionNodes =
           create_expression(csound, currentArg,
                             currentArg->line, currentArg->locn, typeTable);
+        if (expressionNodes != NULL && csound->oparms->expr_fuse)
+          expressionNodes = fuse_expression(csound, expressionNodes,
+                                            typeTable);
         // free discarded node
       }
       else {
@@ -1171,7 +1388,8 @@ TREE* expand_if_statement(CSOUND* csound,
                                   last->left->value->lexeme,
                                   right,
                                   last->left->type == 'k' ||
-                                  right->type =='k');
+                                  right->type =='k',
+                                  typeTable);
     last->next = gotoToken;
     gotoToken->next = current->next;
   }
@@ -1188,7 +1406,7 @@ TREE* expand_if_statement(CSOUND* csound,
     if (UNLIKELY(PARSER_DEBUG))
       csound->Message(csound, "Found if-then\n");
     if (right->next != NULL) {
-      endLabelCounter = genlabs++;
+      endLabelCounter = typeTable->labelCount++;
     }
 
     while (ifBlockCurrent != NULL) {
@@ -1215,8 +1433,8 @@ TREE* expand_if_statement(CSOUND* csound,
         int32_t gotoType;
 
         statements = tempRight->right;
-        label = create_synthetic_ident(csound, genlabs);
-        labelEnd = create_synthetic_label(csound, genlabs++);
+        label = create_synthetic_ident(csound, typeTable->labelCount);
+        labelEnd = create_synthetic_label(csound, typeTable->labelCount++);
         tempRight->right = label;
 
         typeTable->labelList =
@@ -1230,14 +1448,16 @@ TREE* expand_if_statement(CSOUND* csound,
           gotoToken = create_goto_token(csound,
             last->value->lexeme,
             tempRight,
-            gotoType
+            gotoType,
+            typeTable
           );
         } else {
           gotoType = (last->left->value->lexeme[1] == 'B');
           gotoToken = create_goto_token(csound,
             last->left->value->lexeme,
             tempRight,
-            gotoType
+            gotoType,
+            typeTable
           );
         }
         gotoToken->next = statements;
@@ -1251,7 +1471,7 @@ TREE* expand_if_statement(CSOUND* csound,
                                                   endLabelCounter);
           int32_t type = (gotoType == 1) ? 0 : 2;
           TREE *gotoEndLabelToken =
-            create_simple_goto_token(csound, endLabel, type);
+            create_simple_goto_token(csound, endLabel, type, typeTable);
           if (UNLIKELY(PARSER_DEBUG))
             csound->Message(csound, "Creating simple goto token\n");
 
@@ -1302,8 +1522,8 @@ TREE* expand_until_statement(CSOUND* csound, TREE* current,
 
   TREE* gotoToken;
 
-  int32 topLabelCounter = genlabs++;
-  int32 endLabelCounter = genlabs++;
+  int32 topLabelCounter = typeTable->labelCount++;
+  int32 endLabelCounter = typeTable->labelCount++;
   TREE* tempRight = current->right;
   TREE* last = NULL;
   TREE* labelEnd;
@@ -1345,7 +1565,8 @@ TREE* expand_until_statement(CSOUND* csound, TREE* current,
                         current->left->value->lexeme :
                         last->left->value->lexeme,
                       labelEnd,
-                      gotoType+0x8000*dowhile);
+                      gotoType+0x8000*dowhile,
+                      typeTable);
   gotoToken->next = tempRight;
   gotoToken->right->next = labelEnd;
 
@@ -1359,7 +1580,8 @@ TREE* expand_until_statement(CSOUND* csound, TREE* current,
                                           topLabelCounter);
   TREE *gotoTopLabelToken = create_simple_goto_token(csound,
                                                      topLabel,
-                                                     (gotoType==1 ? 0 : 1));
+                                                     (gotoType==1 ? 0 : 1),
+                                                     typeTable);
 
   appendToTree(csound, last, gotoTopLabelToken);
   gotoTopLabelToken->next = labelEnd;
@@ -1388,7 +1610,7 @@ TREE* expand_for_statement(
   indexAssign->value->type = T_ASSIGNMENT;
   char *indexName = create_synthetic_var_name(
     csound,
-    genlabs++,
+    typeTable->labelCount++,
     isPerfRate ? 'k' : 'i'
   );
   TREE *indexIdent = create_empty_token(csound);
@@ -1409,7 +1631,7 @@ TREE* expand_for_statement(
   arrayAssign->value->type = T_ASSIGNMENT;
   char *arrayName = create_synthetic_array_var_name(
     csound,
-    genlabs++,
+    typeTable->labelCount++,
     isPerfRate ? 'k' : 'i'
   );
   TREE *arrayIdent = create_empty_token(csound);
@@ -1428,7 +1650,7 @@ TREE* expand_for_statement(
   arrayLength->value->type = T_ASSIGNMENT;
   char *arrayLengthName = create_synthetic_var_name(
     csound,
-    genlabs++,
+    typeTable->labelCount++,
     isPerfRate ? 'k' : 'i'
   );
   TREE *arrayLengthIdent = create_empty_token(csound);
@@ -1446,7 +1668,7 @@ TREE* expand_for_statement(
   arrayAssign->next = arrayLength;
 
 
-  TREE* loopLabel = create_synthetic_label(csound, genlabs++);
+  TREE* loopLabel = create_synthetic_label(csound, typeTable->labelCount++);
   loopLabel->type = LABEL_TOKEN;
   loopLabel->value->type = LABEL_TOKEN;
   CS_VARIABLE *loopLabelVar = csoundCreateVariable(
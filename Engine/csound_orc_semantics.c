@@ -34,6 +34,8 @@
 #include "csound_standard_types.h"
 #include "csound_orc_expressions.h"
 #include "csound_orc_semantics.h"
+#include "csound_threads.h"
+#include "csmodule.h"
 
 #if defined(_WIN32) || defined(_WIN64)
 # define strtok_r strtok_s
@@ -762,8 +764,9 @@ OENTRY* find_opcode(CSOUND *csound, char *opname)
     return 0;
 
   shortName = get_opcode_short_name(csound, opname);
+  csoundLoadDeferredOpcodes(csound, shortName);
 
-  head = cs_hash_table_get(csound, csound->opcodes, shortName);
+  head = opcode_list_find(csound, shortName);
 
   retVal = (head != NULL) ? head->value : NULL;
   if (shortName != opname) csound->Free(csound, shortName);
@@ -794,7 +797,9 @@ OENTRIES* find_opcode2(CSOUND* csound, char* opname)
   }
 
   shortName = get_opcode_short_name(csound, opname);
-  head = cs_hash_table_get(csound, csound->opcodes, shortName);
+  /* a plugin deferred by the opcode manifest may add overloads */
+  csoundLoadDeferredOpcodes(csound, shortName);
+  head = opcode_list_find(csound, shortName);
   retVal = get_entries(csound, cs_cons_length(head));
   while (head != NULL) {
     retVal->entries[i++] = head->value;
@@ -1279,6 +1284,11 @@ char* get_arg_string_from_tree(CSOUND* csound, TREE* tree,
     char* argType = get_arg_type2(csound, current, typeTable);
     if (argType == NULL) {
       // if we failed to find argType, exit from parser
+      if (typeTable->bail != NULL) {
+        /* on a verify worker: fail this body only */
+        synterr(csound, Str("Could not parse type for argument\n"));
+        longjmp(*typeTable->bail, 1);
+      }
       csound->Die(csound, "Could not parse type for argument");
     } else {
       argType = convert_internal_to_external(csound, argType);
@@ -2409,6 +2419,10 @@ int32_t verify_xin_xout(CSOUND *csound, TREE *udoTree, TYPE_TABLE *typeTable) {
   return 1;
 }
 
+static int32_t needs_source_order(CSOUND *, TREE *, TYPE_TABLE *);
+static int32_t verify_deferred_instrs(CSOUND *, TYPE_TABLE *);
+static int32_t ends_deferred_run(CSOUND *, TREE *);
+
 TREE* verify_tree(CSOUND * csound, TREE *root, TYPE_TABLE* typeTable)
 {
   TREE *anchor = NULL;
@@ -2425,6 +2439,14 @@ TREE* verify_tree(CSOUND * csound, TREE *root, TYPE_TABLE* typeTable)
   if (UNLIKELY(PARSER_DEBUG)) csound->Message(csound, "Verifying AST\n");
 
   while (current != NULL) {
+    /* deferred bodies come before what follows them */
+    if (typeTable->deferInstr && typeTable->deferred != NULL &&
+        ends_deferred_run(csound, current) &&
+        !verify_deferred_instrs(csound, typeTable)) {
+      cs_cons_free(csound, typeTable->labelList);
+      typeTable->labelList = parentLabelList;
+      return NULL;
+    }
     switch(current->type) {
     case STRUCT_TOKEN:
       if (PARSER_DEBUG) csound->Message(csound, "Struct definition found\n");
@@ -2436,14 +2458,21 @@ TREE* verify_tree(CSOUND * csound, TREE *root, TYPE_TABLE* typeTable)
       }
       break;
     case INSTR_TOKEN:
-      csound->inZero = 0;
+      typeTable->inZero = 0;
       if (UNLIKELY(PARSER_DEBUG)) csound->Message(csound, "Instrument found\n");
       typeTable->localPool = csoundCreateVarPool(csound);
       current->markup = typeTable->localPool;
 
-      if (current->right) {
+      if (typeTable->deferInstr && current->right != NULL &&
+          !needs_source_order(csound, current->right, typeTable)) {
+        typeTable->deferred = cs_cons(csound, current, typeTable->deferred);
+      }
+      else if (current->right) {
+        int32_t deferInstr = typeTable->deferInstr;
 
+        typeTable->deferInstr = 0;
         newRight = verify_tree(csound, current->right, typeTable);
+        typeTable->deferInstr = deferInstr;
 
         if (newRight == NULL) {
           cs_cons_free(csound, typeTable->labelList);
@@ -2496,15 +2525,23 @@ TREE* verify_tree(CSOUND * csound, TREE *root, TYPE_TABLE* typeTable)
                            0x0000);
         udo_name = current->left->value->lexeme;
       }
-      csound->inZero = 0;
+      typeTable->inZero = 0;
       if (UNLIKELY(PARSER_DEBUG)) csound->Message(csound, "UDO found\n");
 
       typeTable->localPool = csoundCreateVarPool(csound);
       current->markup = typeTable->localPool;
 
-      if (current->right != NULL) {
+      if (typeTable->deferInstr && current->right != NULL &&
+          !needs_source_order(csound, current->right, typeTable)) {
+        /* the definition is in place, the body can wait */
+        typeTable->deferred = cs_cons(csound, current, typeTable->deferred);
+      }
+      else if (current->right != NULL) {
+        int32_t deferInstr = typeTable->deferInstr;
 
+        typeTable->deferInstr = 0;
         newRight = verify_tree(csound, current->right, typeTable);
+        typeTable->deferInstr = deferInstr;
 
         if (newRight == NULL) {
           cs_cons_free(csound, typeTable->labelList);
@@ -2535,7 +2572,7 @@ TREE* verify_tree(CSOUND * csound, TREE *root, TYPE_TABLE* typeTable)
                                                      typeTable);
       add_udo_definition(csound, false, current->value->lexeme, inArgStringDecl,
                          outArgStringDecl, UNDEFINED);
-      csound->inZero = 0;
+      typeTable->inZero = 0;
       if (UNLIKELY(PARSER_DEBUG)) csound->Message(csound, "UDO found\n");
 
       typeTable->localPool = csoundCreateVarPool(csound);
@@ -2667,7 +2704,7 @@ TREE* verify_tree(CSOUND * csound, TREE *root, TYPE_TABLE* typeTable)
       break;
     case ENDIN_TOKEN:
     case UDOEND_TOKEN:
-      csound->inZero = 1;
+      typeTable->inZero = 1;
       /* fall through */
     default:
       transformed = convert_statement_to_opcall(csound, current, typeTable);
@@ -2711,6 +2748,11 @@ TREE* verify_tree(CSOUND * csound, TREE *root, TYPE_TABLE* typeTable)
 
   }
 
+  if (typeTable->deferInstr && typeTable->deferred != NULL &&
+      !verify_deferred_instrs(csound, typeTable)) {
+    anchor = NULL;
+  }
+
   if (PARSER_DEBUG) csound->Message(csound, "[End Verifying AST]\n");
 
   cs_cons_free(csound, typeTable->labelList);
@@ -3370,3 +3412,234 @@ void add_instr_variable(CSOUND *csound,  TREE *x) {
       csound->Warning(csound, "Could not add instrument ref %s", varname);
   }
 }
+
+/* Parallel verification of instrument and UDO bodies.
+   With -j N (N > 1), the orchestra is verified in source order, but
+   runs of instrument and UDO bodies that only refer to globals, types
+   and opcodes already known are set aside and verified together on N
+   threads, each with its own copy of the type table, before the next
+   top-level statement.  A UDO's definition is added where it stands,
+   so the bodies around it may call it; only its body is set aside.
+   Any other body is verified where it stands,
+   so -j N accepts and rejects the same orchestras as -j 1.  Workers
+   must not Die: a fatal error fails the body through typeTable->bail.
+   Results do not depend on thread timing: every body is verified
+   against the same global state, and into its own local pool. */
+
+#define PARALLEL_VERIFY_MIN 8   /* fewest instruments worth threading */
+
+typedef struct {
+  CSOUND *csound;
+  TYPE_TABLE *typeTable;
+  TREE **instrs;
+  int32_t count, nthreads;
+  volatile long failed;
+} VERIFY_JOBS;
+
+typedef struct {
+  VERIFY_JOBS *jobs;
+  int32_t first;
+} VERIFY_WORKER;
+
+/* does a body name a global, type or opcode not yet defined? */
+static int32_t needs_source_order(CSOUND *csound, TREE *t,
+                                  TYPE_TABLE *typeTable)
+{
+  char name[256];
+  for ( ; t != NULL; t = t->next) {
+    if (t->value != NULL && t->value->lexeme != NULL) {
+      const char *s = t->value->lexeme;
+      if (strchr(s, '@') != NULL)
+        return 1;
+      if (t->value->optype != NULL) {
+        size_t n = strcspn(t->value->optype, "[");
+        if (n >= sizeof(name)) return 1;
+        memcpy(name, t->value->optype, n);
+        name[n] = '\0';
+        if (csoundGetTypeWithVarTypeName(csound->typePool, name) == NULL)
+          return 1;
+      }
+      if (t->type == T_OPCALL || t->type == T_FUNCTION) {
+        /* a UDO defined further down */
+        char *op = get_opcode_short_name(csound, (char *) s);
+        int32_t known;
+        csoundLoadDeferredOpcodes(csound, op);
+        known = opcode_list_find(csound, op) != NULL;
+        if (op != s)
+          csound->Free(csound, op);
+        if (!known)
+          return 1;
+      }
+      else if (*s == 'g') {
+        size_t n = strcspn(s, ":.[");
+        if (n >= sizeof(name)) return 1;
+        memcpy(name, s, n);
+        name[n] = '\0';
+        if (csoundFindVariableWithName(csound, csound->engineState.varPool,
+                                       name) == NULL &&
+            csoundFindVariableWithName(csound, typeTable->globalPool,
+                                       name) == NULL &&
+            opcode_list_find(csound, name) == NULL)
+          return 1;
+      }
+    }
+    if (needs_source_order(csound, t->left, typeTable) ||
+        needs_source_order(csound, t->right, typeTable))
+      return 1;
+  }
+  return 0;
+}
+
+/* must the bodies set aside so far be verified before this statement?
+   Instruments and UDOs continue a run, unless the UDO overloads an
+   opcode that a body set aside may already have resolved */
+static int32_t ends_deferred_run(CSOUND *csound, TREE *t)
+{
+  if (t->type == INSTR_TOKEN)
+    return 0;
+  if (t->type == UDO_TOKEN)
+    return opcode_list_find(csound, t->left->value->lexeme) != NULL;
+  return 1;
+}
+
+/* load any deferred plugin a body may use, as workers must not */
+static void load_deferred_opcodes(CSOUND *csound, TREE *t)
+{
+  for ( ; t != NULL; t = t->next) {
+    if (t->value != NULL && t->value->lexeme != NULL) {
+      char *name = get_opcode_short_name(csound, t->value->lexeme);
+      csoundLoadDeferredOpcodes(csound, name);
+      if (name != t->value->lexeme)
+        csound->Free(csound, name);
+    }
+    load_deferred_opcodes(csound, t->left);
+    load_deferred_opcodes(csound, t->right);
+  }
+}
+
+static int32_t verify_instr_body(CSOUND *csound, TREE *instr,
+                                 TYPE_TABLE *typeTable)
+{
+  TREE *newRight;
+  jmp_buf bail;
+  if (instr->right == NULL)
+    return 1;
+  typeTable->localPool = (CS_VAR_POOL *) instr->markup;
+  typeTable->inZero = 0;
+  typeTable->bail = &bail;
+  if (setjmp(bail) != 0) {
+    typeTable->bail = NULL;
+    typeTable->localPool = typeTable->instr0LocalPool;
+    return 0;
+  }
+  newRight = verify_tree(csound, instr->right, typeTable);
+  typeTable->bail = NULL;
+  if (newRight != NULL)
+    instr->right = newRight;
+  /* old style UDOs check xin and xout against their signature */
+  if (newRight != NULL && instr->type == UDO_TOKEN &&
+      instr->left->left != NULL &&
+      instr->left->left->type == UDO_ANS_TOKEN &&
+      !verify_xin_xout(csound, instr, typeTable)) {
+    synterr(csound, Str("%s UDO"), instr->left->value->lexeme);
+    newRight = NULL;
+  }
+  typeTable->localPool = typeTable->instr0LocalPool;
+  return newRight != NULL;
+}
+
+static uintptr_t verify_instr_thread(void *p)
+{
+  VERIFY_WORKER *w = (VERIFY_WORKER *) p;
+  VERIFY_JOBS *jobs = w->jobs;
+  TYPE_TABLE typeTable = *jobs->typeTable;
+  int32_t i, failed = 0;
+  typeTable.deferInstr = 0;
+  typeTable.deferred = NULL;
+  for (i = w->first; i < jobs->count; i += jobs->nthreads) {
+    /* label numbers only need to be unique within a body */
+    typeTable.labelCount = 300;
+    typeTable.labelList = NULL;
+    if (!verify_instr_body(jobs->csound, jobs->instrs[i], &typeTable))
+      failed++;
+  }
+  /* every body is verified; the compile fails afterwards */
+  if (failed)
+    ATOMIC_SET(jobs->failed, 1);
+  return 0;
+}
+
+/* verify the instrument and UDO bodies set aside since the last
+   top-level statement, emptying typeTable->deferred */
+static int32_t verify_deferred_instrs(CSOUND *csound, TYPE_TABLE *typeTable)
+{
+  int32_t nthreads = csound->oparms->numThreads;
+  int32_t count = 0, i;
+  TREE **instrs;
+  CONS_CELL *cell;
+  VERIFY_JOBS jobs;
+  VERIFY_WORKER *workers;
+  void **threads;
+
+  for (cell = typeTable->deferred; cell != NULL; cell = cell->next)
+    count++;
+  /* list is in reverse order */
+  instrs = (TREE **) csound->Malloc(csound, sizeof(TREE *) * count);
+  i = count;
+  for (cell = typeTable->deferred; cell != NULL; cell = cell->next)
+    instrs[--i] = (TREE *) cell->value;
+  cs_cons_free(csound, typeTable->deferred);
+  typeTable->deferred = NULL;
+  for (i = 0; i < count; i++)
+    load_deferred_opcodes(csound, instrs[i]->right);
+
+  jobs.csound = csound;
+  jobs.typeTable = typeTable;
+  jobs.instrs = instrs;
+  jobs.count = count;
+  jobs.failed = 0;
+  if (count < PARALLEL_VERIFY_MIN)
+    nthreads = 1;
+  if (nthreads > count)
+    nthreads = count;
+  jobs.nthreads = nthreads > 0 ? nthreads : 1;
+  workers = (VERIFY_WORKER *)
+    csound->Malloc(csound, sizeof(VERIFY_WORKER) * jobs.nthreads);
+  threads = (void **) csound->Calloc(csound, sizeof(void *) * jobs.nthreads);
+  for (i = 0; i < jobs.nthreads; i++) {
+    workers[i].jobs = &jobs;
+    workers[i].first = i;
+  }
+  /* the calling thread takes the first share */
+  for (i = 1; i < jobs.nthreads; i++)
+    threads[i] = csoundCreateThread(verify_instr_thread, &workers[i]);
+  verify_instr_thread(&workers[0]);
+  for (i = 1; i < jobs.nthreads; i++) {
+    if (threads[i] != NULL)
+      csoundJoinThread(threads[i]);
+    else
+      verify_instr_thread(&workers[i]);
+  }
+
+  csound->Free(csound, threads);
+  csound->Free(csound, workers);
+  csound->Free(csound, instrs);
+  typeTable->inZero = 0;
+  return !jobs.failed;
+}
+
+TREE* verify_tree_parallel(CSOUND * csound, TREE *root, TYPE_TABLE *typeTable)
+{
+  if (csound->oparms->numThreads < 2)
+    return verify_tree(csound, root, typeTable);
+
+  typeTable->deferInstr = 1;
+  typeTable->deferred = NULL;
+  root = verify_tree(csound, root, typeTable);
+  typeTable->deferInstr = 0;
+  if (typeTable->deferred != NULL) {     /* left by an earlier failure */
+    cs_cons_free(csound, typeTable->deferred);
+    typeTable->deferred = NULL;
+  }
+  return root;
+}
@@ -58,7 +58,7 @@ void fsig_copy_value(CSOUND* csound, const CS_TYPE* cstype, void* dest,
     PVSDAT *fsigout = (PVSDAT*) dest;
     PVSDAT *fsigin = (PVSDAT*) src;
     int32_t N = fsigin->N;
-    memcpy(dest, src, sizeof(PVSDAT) - sizeof(AUXCH));
+    memcpy(dest, src, PVSDAT_HEADER);
     if(fsigout->frame.auxp == NULL ||
        fsigout->frame.size < (N + 2) * sizeof(float))
       ((CSOUND *)csound)->AuxAlloc(csound,
@@ -270,6 +270,7 @@ OENTRY opcodlst_1[] = {
   { "##mul.aa",  S(AOP),0,           "a",    "aa",   NULL,   mulaa   },
   { "##div.aa",  S(AOP),0,           "a",    "aa",   NULL,   divaa   },
   { "##mod.aa",  S(AOP),0,           "a",    "aa",   NULL,   modaa   },
+  { "##fuse",    S(FUSE),0,          "a",    "SM",   fusea_set, fusea },
   { "##addin.i", S(ASSIGN),0,       "i",    "i",    addin,  NULL    },
   { "##addin.k", S(ASSIGN),0,        "k",    "k",    NULL,   addin   },
   { "##addin.K", S(ASSIGN),0,        "a",    "k",    NULL,   addinak },
@@ -1015,8 +1016,10 @@ OENTRY opcodlst_1[] = {
     (SUBR)reverbx_set,(SUBR) reverbx },
   { "=.f",      S(FASSIGN),0,     "f",   "f", (SUBR)fassign_set, (SUBR)fassign },
   { "init.f",   S(FASSIGN),0,     "f",   "f", (SUBR)fassign_set, NULL, NULL    },
-  { "pvsanal",  S(PVSANAL), 0,    "f",   "aiiiioo", pvsanalset, pvsanal   },
-  { "pvsynth",  S(PVSYNTH),0,     "a",   "fo",     pvsynthset, pvsynth },
+  { "pvsanal",  S(PVSANAL), 0,    "f",   "aiiiiooooj", pvsanalset, pvsanal,
+    pvsanal_deinit },
+  { "pvsynth",  S(PVSYNTH),0,     "a",   "fo",     pvsynthset, pvsynth,
+    pvsynth_deinit },
   { "pvsadsyn", S(PVADS),0,       "a",   "fikopo", pvadsynset, pvadsyn, NULL },
   { "pvscross", S(PVSCROSS),0,    "f",   "ffkk",   pvscrosset, pvscross, NULL },
   { "pvsfread", S(PVSFREAD),0,    "f",   "kSo",    pvsfreadset_S, pvsfread, NULL},
@@ -1613,7 +1616,7 @@ OENTRY opcodlst_1[] = {
   {"lpcanal", S(LPREDA), 0,  "i[]iii", "iiii",
    (SUBR) lpred_i, NULL},
   {"pvslpc", S(LPCPVS), 0,  "f", "aiiio",
-   (SUBR) lpcpvs_init, (SUBR) lpcpvs},
+   (SUBR) lpcpvs_init, (SUBR) lpcpvs, (SUBR) lpcpvs_deinit},
   {"pvscfs", S(PVSCFS), 0,  "k[]kk", "fip",
    (SUBR) pvscoefs_init, (SUBR) pvscoefs},
   {"apoleparams", S(CF2P), 0,  "k[]", "k[]",
@@ -51,7 +51,10 @@ static const char *envVar_list[] = {
     "CSNOSTOP",
     "CSOUND7RC",
     "CSSTRNGS",
+    "CS_DECODE_CACHE",
     "CS_LANG",
+    "CS_PLUGIN_MANIFEST",
+    "CS_VCO2_CACHE",
     "HOME",
     "INCDIR",
     "OPCODE7DIR",
@@ -1679,6 +1679,7 @@ static int32_t gen30(FGDATA *ff, FUNC *ftp)
     int32_t     l1, l2, minh = 0, maxh = 0, i;
     MYFLT   xsr, minfrac, maxfrac;
     int32_t     nargs = ff->e.pcnt - 4;
+    OPDS    fftkey;       /* only its address is used, to own the setups */
 
     if (UNLIKELY(nargs < 3)) {
       return fterror(ff, Str("insufficient gen arguments"));
@@ -1726,7 +1727,8 @@ static int32_t gen30(FGDATA *ff, FUNC *ftp)
     for (i = 0; i < l2; i++)
       x[i] = xsr * f2[i];
     /* filter */
-    csound->RealFFT(csound, csound->RealFFTSetup(csound,l2,FFT_FWD), x);
+    csound->RealFFT(csound,
+                    csound->RealFFTSetupFor(csound,l2,FFT_FWD,&fftkey), x);
     x[l2] = x[1];
     x[1] = x[l2 + 1] = FL(0.0);
     for (i = 0; i < (minh << 1); i++)
@@ -1740,7 +1742,9 @@ static int32_t gen30(FGDATA *ff, FUNC *ftp)
       x[i] = FL(0.0);
     x[1] = x[l1];
     x[l1] = x[l1 + 1] = FL(0.0);
-    csound->RealFFT(csound, csound->RealFFTSetup(csound,l1,FFT_INV), x);
+    csound->RealFFT(csound,
+                    csound->RealFFTSetupFor(csound,l1,FFT_INV,&fftkey), x);
+    csound->ReleaseFFTSetups(csound, &fftkey);
     /* write dest. table */
     /* memcpy(f1, x, l1*sizeof(MYFLT)); */
     for (i = 0; i < l1; i++)
@@ -2625,9 +2629,21 @@ static int32_t gen01raw(FGDATA *ff, FUNC *ftp)
         ftp->end1 = ftp->flenfrms;      /* Greg Sullivan */
       }
     }
-    /* read sound with opt gain */
-
-    if (UNLIKELY((inlocs=getsndin(csound, fd, ftp->ftable, table_length, p)) < 0)) {
+    /* read sound with opt gain, a compressed file from its decoded */
+    /* frames, which later loads of it share                        */
+    inlocs = -1;
+    if (p->filetyp == TYP_FLAC || p->filetyp == TYP_OGG ||
+        p->filetyp == TYP_MPEG) {
+      SNDMEMFILE *snd = csound->DecodedSoundFile(csound,
+                                                 csound->GetFileName(p->fd),
+                                                 1, NULL, NULL);
+      if (snd != NULL) {
+        inlocs = getsndin_decoded(csound, snd, ftp->ftable, table_length, p);
+        csound->ReleaseDecodedSoundFile(csound, snd);
+      }
+    }
+    if (inlocs < 0 &&
+        UNLIKELY((inlocs=getsndin(csound, fd, ftp->ftable, table_length, p)) < 0)) {
       return fterror(ff, Str("GEN1 read error"));
     }
 
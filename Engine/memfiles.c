@@ -32,6 +32,13 @@
 #include "namedins.h"
 #include <string.h>
 #include <inttypes.h>
+#include <sys/stat.h>
+#if defined(WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
 
 static int32_t Load_Het_File_(CSOUND *csound, const char *filnam,
                           char **allocp, int32 *len)
@@ -689,3 +696,430 @@ SNDMEMFILE *csoundLoadSoundFile(CSOUND *csound, const char *fileName, void *sfi)
     /* return with pointer to file structure */
     return p;
 }
+
+ /* ------------------------------------------------------------------------ */
+
+/* Compressed sound files (FLAC, Ogg, MP3) cost far more to decode than to
+   read.  With --decode-cache=N, the first time one is asked for, it is
+   decoded to sample frames in a background thread (or at once, for a
+   caller that waits), and later opens are served from the decoded frames
+   for as long as they fit in N megabytes; files no reader holds go least
+   recently used first.  A file whose frames alone would not fit is never
+   decoded.  If CS_DECODE_CACHE names a directory, the frames are also stored
+   there, keyed by a hash of the compressed file's contents and the name
+   of its decoder, so that later runs load them with a single read.      */
+
+typedef struct DECODED_ {
+    struct DECODED_ *nxt;
+    struct DECODE_CACHE_ *cache;
+    char        *fullName, *decoder, *dir;
+    int64_t     size, mtime;            /* of the file when opened  */
+    SNDMEMFILE  *(*decode)(CSOUND *, const char *, size_t);
+    SNDMEMFILE  *snd;                   /* NULL until decoded       */
+    void        *thread;                /* decoding it, if not NULL */
+    int32_t     refs, done;
+    uint64_t    used;
+} DECODED;
+
+typedef struct DECODE_CACHE_ {
+    CSOUND      *csound;
+    void        *lock;
+    DECODED     *entries;
+    size_t      bytes;
+    uint64_t    clock;
+    volatile int32_t stop;
+} DECODE_CACHE;
+
+/* header of a file in the CS_DECODE_CACHE directory, followed by the
+   interleaved frames */
+typedef struct {
+    char        magic[8];
+    int32_t     nChannels, fileType, sampleFormat, sampleSize;
+    double      sampleRate;
+    int64_t     nFrames;
+} DECODED_HEADER;
+
+static const char decoded_magic[8] = { 'C', 'S', 'D', 'E', 'C', 'O', 'D', '1' };
+
+static size_t decoded_bytes(const SNDMEMFILE *snd)
+{
+    return sizeof(SNDMEMFILE)
+      + snd->nFrames * (size_t) snd->nChannels * sizeof(MYFLT);
+}
+
+static int32_t decode_cache_destroy(CSOUND *csound, void *pp)
+{
+    DECODE_CACHE  *cache = (DECODE_CACHE *) pp;
+    DECODED       *e;
+    void          **threads;
+    int32_t       i, n = 0;
+    if (cache->lock == NULL)
+      return OK;
+    /* let the decoders still running finish, sooner if they can */
+    cache->stop = 1;
+    csound->LockMutex(cache->lock);
+    for (e = cache->entries; e != NULL; e = e->nxt)
+      n++;
+    threads = (void **) csound->Calloc(csound, (n + 1) * sizeof(void *));
+    for (n = 0, e = cache->entries; e != NULL; e = e->nxt)
+      if (e->thread != NULL) {
+        threads[n++] = e->thread;
+        e->thread = NULL;
+      }
+    csound->UnlockMutex(cache->lock);
+    for (i = 0; i < n; i++)
+      csound->JoinThread(threads[i]);
+    csound->Free(csound, threads);
+    csound->DestroyMutex(cache->lock);
+    cache->lock = NULL;
+    return OK;
+}
+
+static DECODE_CACHE *decode_cache(CSOUND *csound)
+{
+    DECODE_CACHE *cache =
+      (DECODE_CACHE *) csound->QueryGlobalVariable(csound, "::DECODE_CACHE::");
+    if (cache == NULL) {
+      csound->CreateGlobalVariable(csound, "::DECODE_CACHE::",
+                                   sizeof(DECODE_CACHE));
+      cache = (DECODE_CACHE *) csound->QueryGlobalVariable(csound,
+                                                        "::DECODE_CACHE::");
+      cache->csound = csound;
+      cache->lock = csound->Create_Mutex(0);
+      csound->RegisterResetCallback(csound, (void*) cache,
+                                    decode_cache_destroy);
+    }
+    return cache;
+}
+
+/* drop the least recently used files nobody holds, other than keep,  */
+/* while the cache is over its size; called with the cache locked      */
+
+static void decode_cache_trim(CSOUND *csound, DECODE_CACHE *cache,
+                              DECODED *keep)
+{
+    size_t  maxBytes = (size_t) csound->oparms->decode_cache << 20;
+    while (cache->bytes > maxBytes) {
+      DECODED *e, **pe, **lru = NULL;
+      for (pe = &cache->entries; (e = *pe) != NULL; pe = &e->nxt)
+        if (e != keep && e->snd != NULL && e->refs == 0 &&
+            (lru == NULL || e->used < (*lru)->used))
+          lru = pe;
+      if (lru == NULL)
+        break;
+      e = *lru;
+      *lru = e->nxt;
+      cache->bytes -= decoded_bytes(e->snd);
+      /* its decoder is done with it, apart from returning */
+      if (e->thread != NULL)
+        csound->JoinThread(e->thread);
+      csound->Free(csound, e->snd);
+      csound->Free(csound, e->fullName);
+      csound->Free(csound, e->decoder);
+      if (e->dir != NULL)
+        csound->Free(csound, e->dir);
+      csound->Free(csound, e);
+    }
+}
+
+/* decode with libsndfile, which handles FLAC and Ogg, giving up on */
+/* files of more than maxBytes of frames                            */
+
+static SNDMEMFILE *decode_sndfile(CSOUND *csound, DECODE_CACHE *cache,
+                                  const char *fullName, size_t maxBytes)
+{
+    SFLIB_INFO  sfinfo;
+    SNDMEMFILE  *p;
+    void        *sf;
+    size_t      n = 0, maxFrames, limit;
+    int32_t     tooLong = 0;
+    memset(&sfinfo, 0, sizeof(SFLIB_INFO));
+    sf = csound->SndfileOpen(csound, fullName, SFM_READ, &sfinfo);
+    if (sf == NULL || sfinfo.channels < 1) {
+      if (sf != NULL)
+        csound->SndfileClose(csound, sf);
+      return NULL;
+    }
+    limit = maxBytes / ((size_t) sfinfo.channels * sizeof(MYFLT));
+    if (sfinfo.frames > 0 && (uint64_t) sfinfo.frames > (uint64_t) limit) {
+      csound->SndfileClose(csound, sf);
+      return NULL;
+    }
+    maxFrames = (sfinfo.frames > 0 ? (size_t) sfinfo.frames : 65536);
+    if (maxFrames > limit)
+      maxFrames = limit;
+    p = (SNDMEMFILE *) csound->Calloc(csound, sizeof(SNDMEMFILE)
+                                      + maxFrames * sfinfo.channels
+                                      * sizeof(MYFLT));
+    while (!cache->stop) {
+      int64_t m;
+      if (n == maxFrames) {     /* length unknown or wrong: grow */
+        if (maxFrames >= limit) {
+          MYFLT probe[64];      /* at the end, or too long after all? */
+          if (sfinfo.channels <= 64 &&
+              csound->SndfileRead(csound, sf, probe, 1) <= 0)
+            break;
+          tooLong = 1;
+          break;
+        }
+        maxFrames = (maxFrames < limit / 2 ? maxFrames * 2 : limit);
+        p = (SNDMEMFILE *) csound->ReAlloc(csound, p, sizeof(SNDMEMFILE)
+                                           + maxFrames * sfinfo.channels
+                                           * sizeof(MYFLT));
+      }
+      m = csound->SndfileRead(csound, sf, &(p->data[n * sfinfo.channels]),
+                              (int64_t) (maxFrames - n < 65536 ?
+                                         maxFrames - n : 65536));
+      if (m <= 0)
+        break;
+      n += (size_t) m;
+    }
+    csound->SndfileClose(csound, sf);
+    if (cache->stop || tooLong) {
+      csound->Free(csound, p);
+      return NULL;
+    }
+    p->nFrames = n;
+    p->sampleRate = (double) sfinfo.samplerate;
+    p->nChannels = sfinfo.channels;
+    p->sampleFormat = SF2FORMAT(sfinfo.format);
+    p->fileType = SF2TYPE(sfinfo.format);
+    return p;
+}
+
+/* 64 bit FNV-1a hash of the contents of a file */
+
+static int32_t decode_hash(const char *fullName, uint64_t *hash)
+{
+    unsigned char buf[16384];
+    uint64_t      h = UINT64_C(0xcbf29ce484222325);
+    size_t        i, n;
+    FILE          *f = fopen(fullName, "rb");
+    if (f == NULL)
+      return NOTOK;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+      for (i = 0; i < n; i++)
+        h = (h ^ buf[i]) * UINT64_C(0x100000001b3);
+    fclose(f);
+    *hash = h;
+    return OK;
+}
+
+/* load frames stored by decode_store(), if the header agrees with the */
+/* size of the file and the frames take no more than maxBytes           */
+
+static SNDMEMFILE *decode_load(CSOUND *csound, const char *path,
+                               size_t maxBytes)
+{
+    DECODED_HEADER  hdr;
+    SNDMEMFILE      *p = NULL;
+    size_t          n;
+    struct stat     st;
+    FILE            *f = fopen(path, "rb");
+    if (f == NULL)
+      return NULL;
+    if (fstat(fileno(f), &st) == 0 &&
+        fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+        !memcmp(hdr.magic, decoded_magic, sizeof(decoded_magic)) &&
+        hdr.sampleSize == (int32_t) sizeof(MYFLT) && hdr.nChannels > 0 &&
+        hdr.nFrames >= 0 &&
+        (uint64_t) hdr.nFrames <= (uint64_t) (maxBytes / sizeof(MYFLT)) /
+                                   (uint64_t) hdr.nChannels &&
+        (uint64_t) st.st_size == sizeof(hdr) + (uint64_t) hdr.nFrames
+                                 * hdr.nChannels * sizeof(MYFLT)) {
+      n = (size_t) hdr.nFrames * hdr.nChannels;
+      p = (SNDMEMFILE *) csound->Calloc(csound, sizeof(SNDMEMFILE)
+                                        + n * sizeof(MYFLT));
+      if (fread(p->data, sizeof(MYFLT), n, f) != n || fgetc(f) != EOF) {
+        csound->Free(csound, p);
+        p = NULL;
+      }
+      else {
+        p->nFrames = (size_t) hdr.nFrames;
+        p->sampleRate = hdr.sampleRate;
+        p->nChannels = hdr.nChannels;
+        p->sampleFormat = hdr.sampleFormat;
+        p->fileType = hdr.fileType;
+      }
+    }
+    fclose(f);
+    return p;
+}
+
+static volatile long decode_stores = 0;
+
+static void decode_store(const char *path, const SNDMEMFILE *p)
+{
+    DECODED_HEADER  hdr;
+    char            tmp[1040];
+    size_t          n = p->nFrames * (size_t) p->nChannels;
+    long            serial = ATOMIC_INCR(decode_stores);
+    FILE            *f;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, decoded_magic, sizeof(decoded_magic));
+    hdr.nChannels = p->nChannels;
+    hdr.fileType = p->fileType;
+    hdr.sampleFormat = p->sampleFormat;
+    hdr.sampleSize = (int32_t) sizeof(MYFLT);
+    hdr.sampleRate = p->sampleRate;
+    hdr.nFrames = (int64_t) p->nFrames;
+    /* write to a temporary file first, so that concurrent readers */
+    /* never see a partial one                                      */
+    snprintf(tmp, sizeof(tmp), "%s.%d.%ld", path, (int32_t) getpid(), serial);
+    if ((f = fopen(tmp, "wb")) != NULL) {
+      int32_t ok = (fwrite(&hdr, sizeof(hdr), 1, f) == 1 &&
+                    fwrite(p->data, sizeof(MYFLT), n, f) == n);
+      if (fclose(f) != 0 || !ok || rename(tmp, path) != 0)
+        remove(tmp);
+    }
+}
+
+/* the decoded frames of e, from the cache directory if they are there */
+
+static SNDMEMFILE *decode_entry(CSOUND *csound, DECODED *e)
+{
+    SNDMEMFILE  *snd = NULL;
+    char        path[1024];
+    uint64_t    hash;
+    int32_t     stored = 0;
+    size_t      maxBytes = (size_t) csound->oparms->decode_cache << 20;
+    if (e->dir != NULL && decode_hash(e->fullName, &hash) == OK) {
+      snprintf(path, sizeof(path), "%s/%016" PRIx64 "-%s-%d.pcm", e->dir,
+               hash, e->decoder, (int32_t) sizeof(MYFLT));
+      stored = 1;
+      snd = decode_load(csound, path, maxBytes);
+    }
+    if (snd == NULL) {
+      snd = (e->decode != NULL ? e->decode(csound, e->fullName, maxBytes)
+             : decode_sndfile(csound, e->cache, e->fullName, maxBytes));
+      if (snd != NULL && stored && !e->cache->stop)
+        decode_store(path, snd);
+    }
+    return snd;
+}
+
+/* called with the cache locked */
+static void decode_done(CSOUND *csound, DECODED *e, SNDMEMFILE *snd)
+{
+    if (snd != NULL) {
+      snd->name = snd->fullName = e->fullName;
+      snd->loopMode = 0;
+      snd->startOffs = snd->loopStart = snd->loopEnd = 0.0;
+      snd->baseFreq = snd->scaleFac = 1.0;
+      e->cache->bytes += decoded_bytes(snd);
+    }
+    e->snd = snd;
+    e->done = 1;
+    decode_cache_trim(csound, e->cache, e);
+}
+
+static uintptr_t decode_thread(void *pp)
+{
+    DECODED       *e = (DECODED *) pp;
+    DECODE_CACHE  *cache = e->cache;
+    CSOUND        *csound = cache->csound;
+    SNDMEMFILE    *snd = decode_entry(csound, e);
+    csound->LockMutex(cache->lock);
+    decode_done(csound, e, snd);
+    csound->UnlockMutex(cache->lock);
+    return 0;
+}
+
+/**
+ * Return the decoded sample frames of the compressed sound file
+ * 'fullName' (as found by FileOpen), or NULL if they are not available,
+ * or the cache is disabled with --decode-cache=0.  The first call for a
+ * file starts decoding it in the background and returns NULL, unless
+ * 'wait' is non-zero, in which case the file is decoded (or the decoder
+ * running is waited for) before returning.
+ * 'decode' decodes a file into an SNDMEMFILE allocated with
+ * csound->Malloc, setting its data, nFrames, nChannels, sampleRate,
+ * sampleFormat and fileType, and returns NULL on failure or if the
+ * frames would take more than its last argument of bytes, checking
+ * before decoding when it can; it runs in another thread.  If it is NULL the file is decoded with libsndfile.
+ * 'decoder' names it, as files decoded differently are kept apart.
+ * The frames hold full scale as 1.0, and may be shared with other
+ * callers; each non-NULL return is to be released with
+ * csoundReleaseDecodedSoundFile().
+ */
+
+SNDMEMFILE *csoundDecodedSoundFile(CSOUND *csound, const char *fullName,
+                                   int32_t wait, const char *decoder,
+                                   SNDMEMFILE *(*decode)(CSOUND *,
+                                                         const char *,
+                                                         size_t))
+{
+    DECODE_CACHE  *cache;
+    DECODED       *e;
+    SNDMEMFILE    *snd = NULL;
+    struct stat   st;
+
+    if (csound->oparms->decode_cache <= 0 || fullName == NULL ||
+        stat(fullName, &st) != 0)
+      return NULL;
+    if (decoder == NULL)
+      decoder = "sndfile";
+    cache = decode_cache(csound);
+    csound->LockMutex(cache->lock);
+    for (e = cache->entries; e != NULL; e = e->nxt)
+      if (e->size == (int64_t) st.st_size &&
+          e->mtime == (int64_t) st.st_mtime &&
+          !strcmp(e->decoder, decoder) && !strcmp(e->fullName, fullName))
+        break;
+    if (e == NULL) {
+      const char *dir = csound->GetEnv(csound, "CS_DECODE_CACHE");
+      e = (DECODED *) csound->Calloc(csound, sizeof(DECODED));
+      e->cache = cache;
+      e->fullName = cs_strdup(csound, (char*) fullName);
+      e->decoder = cs_strdup(csound, (char*) decoder);
+      if (dir != NULL && dir[0] != '\0')
+        e->dir = cs_strdup(csound, (char*) dir);
+      e->size = (int64_t) st.st_size;
+      e->mtime = (int64_t) st.st_mtime;
+      e->decode = decode;
+      e->nxt = cache->entries;
+      cache->entries = e;
+      if (wait) {
+        /* decode here, with the entry marked as being decoded */
+        csound->UnlockMutex(cache->lock);
+        snd = decode_entry(csound, e);
+        csound->LockMutex(cache->lock);
+        decode_done(csound, e, snd);
+      }
+      else if ((e->thread = csound->CreateThread(decode_thread,
+                                                 (void*) e)) == NULL)
+        e->done = 1;
+    }
+    else if (wait && !e->done && e->thread != NULL) {
+      void *thread = e->thread;
+      e->thread = NULL;
+      e->refs++;                /* not to be dropped meanwhile */
+      csound->UnlockMutex(cache->lock);
+      csound->JoinThread(thread);
+      csound->LockMutex(cache->lock);
+      e->refs--;
+    }
+    if ((snd = e->snd) != NULL) {
+      e->refs++;
+      e->used = ++cache->clock;
+    }
+    csound->UnlockMutex(cache->lock);
+    return snd;
+}
+
+void csoundReleaseDecodedSoundFile(CSOUND *csound, SNDMEMFILE *snd)
+{
+    DECODE_CACHE  *cache;
+    DECODED       *e;
+    if (snd == NULL)
+      return;
+    cache = decode_cache(csound);
+    csound->LockMutex(cache->lock);
+    for (e = cache->entries; e != NULL; e = e->nxt)
+      if (e->snd == snd) {
+        e->refs--;
+        break;
+      }
+    decode_cache_trim(csound, cache, NULL);
+    csound->UnlockMutex(cache->lock);
+}
@@ -62,6 +62,7 @@ extern void csound_orcset_lineno(int32_t,  void*);
 extern int32_t csound_orclex_destroy(void *);
 extern void print_tree(CSOUND *, char *, TREE *);
 extern TREE* verify_tree(CSOUND *, TREE *, TYPE_TABLE*);
+extern TREE* verify_tree_parallel(CSOUND *, TREE *, TYPE_TABLE*);
 extern TREE *csound_orc_expand_expressions(CSOUND *, TREE *);
 extern TREE* csound_orc_optimize(CSOUND *, TREE *);
 //extern void csp_orc_analyze_tree(CSOUND* csound, TREE* root);
@@ -264,8 +265,14 @@ TREE *csoundParseOrc(CSOUND *csound, const char *str)
 
       typeTable->localPool = typeTable->instr0LocalPool;
       typeTable->labelList = NULL;
-
-      astTree = verify_tree(csound, astTree, typeTable);
+      typeTable->labelCount = 300;
+      typeTable->inZero = csound->inZero;
+      typeTable->deferInstr = 0;
+      typeTable->deferred = NULL;
+      typeTable->bail = NULL;
+
+      astTree = verify_tree_parallel(csound, astTree, typeTable);
+      csound->inZero = typeTable->inZero;
 //      csound->Free(csound, typeTable->instr0LocalPool);
 //      csound->Free(csound, typeTable->globalPool);
 //      csound->Free(csound, typeTable);
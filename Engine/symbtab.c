@@ -296,7 +296,7 @@ OENTRY* csound_find_internal_oentry(CSOUND* csound, OENTRY* oentry) {
     }
     shortName = get_opcode_short_name(csound, oentry->opname);
 
-    items = cs_hash_table_get(csound, csound->opcodes, shortName);
+    items = opcode_list_find(csound, shortName);
 
     while (items != NULL) {
         ep = items->value;
@@ -346,6 +346,8 @@ int32_t add_udo_definition(CSOUND *csound, bool newStyle, char *opname,
 
     /* check if opcode is already defined */
     if (UNLIKELY(opc != NULL)) {
+      /* built-in entries are shared between instances */
+      opc = opcode_list_unshare(csound, opc);
 
       // check if the opcode is already declared
       if (opc->flags & UNDEFINED) {
@@ -383,6 +385,12 @@ int32_t add_udo_definition(CSOUND *csound, bool newStyle, char *opname,
     csound->opcodeInfo = inm;
 
     if (opc != NULL) {
+      /* call the UDO, not the built-in it replaces */
+      OENTRY *udo = find_opcode(csound, "##userOpcode");
+      opc->dsblksiz = udo->dsblksiz;
+      opc->init = udo->init;
+      opc->perf = udo->perf;
+      opc->deinit = udo->deinit;
       opc->useropinfo = inm;
       newopc = opc;
     } else {
@@ -420,5 +428,6 @@ void synterr(CSOUND *csound, const char *s, ...)
      * This function may not be necessary at all in the end if some of this is
      * done in the parser
      */
-    csound->synterrcnt++;
+    /* instrument bodies may be verified on several threads */
+    ATOMIC_INCR(csound->synterrcnt);
 }
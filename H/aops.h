@@ -75,6 +75,29 @@ typedef struct {
     MYFLT   *r, *a;
 } EVAL;
 
+/* Fused a-rate expressions (##fuse). The expression compiler passes the
+   expression in postfix form: 'a' and 'k' push the next audio or scalar
+   operand, + - * / % are the binary operators, and the upper-case codes
+   below are the one-argument math functions.                          */
+#define FUSE_LANES      16      /* samples evaluated per instruction */
+#define FUSE_MAXDEPTH   8       /* evaluation stack depth            */
+#define FUSE_MAXARGS    32      /* operands of one expression        */
+
+typedef struct {
+    char    op, src;            /* instruction, second operand       */
+    MYFLT   *arg;               /* audio or scalar operand           */
+    MYFLT   *buf;               /* scalar operand, broadcast         */
+} FUSE_INSN;
+
+typedef struct {
+    OPDS    h;
+    MYFLT   *r;
+    STRINGDAT *prog;
+    MYFLT   *args[FUSE_MAXARGS];
+    AUXCH   code;
+    int32_t ncode;
+} FUSE;
+
 typedef struct {
     OPDS    h;
     MYFLT   *ar;
@@ -99,6 +99,19 @@ extern "C" {
    */
   int32_t csoundLoadAndInitModules(CSOUND *csound, const char *opdir);
 
+  /**
+   * Load the plugin libraries that the opcode manifest (CS_PLUGIN_MANIFEST)
+   * deferred at startup and that provide opcode 'opname'.
+   * Return value is the number of libraries loaded.
+   */
+  int32_t csoundLoadDeferredOpcodes(CSOUND *csound, const char *opname);
+
+  /**
+   * Load all plugin libraries deferred by the opcode manifest.
+   * Return value is the number of libraries loaded.
+   */
+  int32_t csoundLoadAllDeferredOpcodes(CSOUND *csound);
+
   /**
    * Call destructor functions of all loaded modules that have a
    * csoundModuleDestroy symbol, for Csound instance 'csound'.
@@ -44,6 +44,11 @@ typedef struct type_table {
     CS_VAR_POOL* instr0LocalPool;
     CS_VAR_POOL* localPool;
     CONS_CELL* labelList;
+    int32_t labelCount;         /* next synthetic label number */
+    int32_t inZero;             /* verifying instr0 statements */
+    int32_t deferInstr;         /* leave instrument and UDO bodies for later */
+    CONS_CELL* deferred;        /* bodies left, in reverse order */
+    jmp_buf* bail;              /* set on verify workers, which must not Die */
 } TYPE_TABLE;
 
 
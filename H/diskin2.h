@@ -31,6 +31,9 @@
 #define POS_FRAC_SCALE  0x10000000
 #define POS_FRAC_MASK   0x0FFFFFFF
 
+struct DISKIN2_FILE_;                   /* shared pages of a sound file  */
+struct DISKIN2_KERNEL_;                 /* shared sinc interpolation kernel */
+
 typedef struct {
     OPDS    h;
     MYFLT   *aOut[DISKIN2_MAXCHN];
@@ -73,6 +76,9 @@ typedef struct {
     void    *cb;
     int32_t     async;
   MYFLT     transpose;
+    struct DISKIN2_FILE_   *cfile;
+    struct DISKIN2_KERNEL_ *kernel;
+    SNDMEMFILE  *pcm;           /* decoded frames of a compressed file */
 } DISKIN2;
 
 typedef struct {
@@ -115,6 +121,9 @@ typedef struct {
   MYFLT aOut_bufsize;
   void *cb;
   int32_t  async;
+    struct DISKIN2_FILE_   *cfile;
+    struct DISKIN2_KERNEL_ *kernel;
+    SNDMEMFILE  *pcm;           /* decoded frames of a compressed file */
 } DISKIN2_ARRAY;
 
 int32_t diskin2_init(CSOUND *csound, DISKIN2 *p);
@@ -93,6 +93,7 @@ int32_t modak(CSOUND *, void *);
 int32_t addaa(CSOUND *, void *), subaa(CSOUND *, void *);
 int32_t mulaa(CSOUND *, void *), divaa(CSOUND *, void *);
 int32_t modaa(CSOUND *, void *);
+int32_t fusea_set(CSOUND *, void *), fusea(CSOUND *, void *);
 int32_t addin(CSOUND *, void *), addina(CSOUND *, void *);
 int32_t subin(CSOUND *, void *), subina(CSOUND *, void *);
 int32_t addinak(CSOUND *, void *), subinak(CSOUND *, void *);
@@ -361,7 +362,9 @@ int32_t lfoset(CSOUND *, void *);
 int32_t lfok(CSOUND *, void *), lfoa(CSOUND *, void *);
 int32_t mute_inst(CSOUND *, void *);
 int32_t pvsanalset(CSOUND *, void *), pvsanal(CSOUND *, void *);
+int32_t pvsanal_deinit(CSOUND *, void *);
 int32_t pvsynthset(CSOUND *, void *), pvsynth(CSOUND *, void *);
+int32_t pvsynth_deinit(CSOUND *, void *);
 int32_t pvadsynset(CSOUND *, void *), pvadsyn(CSOUND *, void *);
 int32_t pvscrosset(CSOUND *, void *), pvscross(CSOUND *, void *);
 int32_t pvsfreadset(CSOUND *, void *), pvsfread(CSOUND *, void *);
@@ -512,6 +515,7 @@ int32_t lpred_run2(CSOUND *csound, void *p);
 int32_t lpred_alloc2(CSOUND *csound, void *p);
 int32_t lpcpvs(CSOUND *csound, void *p);
 int32_t lpcpvs_init(CSOUND *csound, void *p);
+int32_t lpcpvs_deinit(CSOUND *csound, void *p);
 int32_t pvscoefs_init(CSOUND *csound, void *p);
 int32_t pvscoefs(CSOUND *csound, void *p);
 int32_t coef2parm_init(CSOUND *csound, void *p);
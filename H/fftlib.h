@@ -140,8 +140,26 @@ extern "C" {
    * setup:   an FFT setup created with csoundRealFFT2Setup()
    */
   void csoundRealFFT2(CSOUND *csound, void *setup, MYFLT *sig);
+
+   /**
+   * As csoundRealFFT2Setup(), but the setup belongs to the opcode owner:
+   * a later request from the same opcode with the same size and direction
+   * (e.g. when its instrument instance is reused) returns the same setup.
+   * The opcode's deinit must call csoundReleaseFFTSetups().
+   */
+  void *csoundRealFFT2SetupFor(CSOUND *csound, int32_t FFTsize, int32_t d,
+                               OPDS *owner);
   void csoundDCT(CSOUND *csound, void *p, MYFLT *sig);
   void *csoundDCTSetup(CSOUND *csound, int32_t FFTsize, int32_t d);
+  void *csoundDCTSetupFor(CSOUND *csound, int32_t FFTsize, int32_t d,
+                          OPDS *owner);
+
+   /**
+   * Hands back every setup made for owner by csoundRealFFT2SetupFor() or
+   * csoundDCTSetupFor(). They are kept, scratch and all, for the next
+   * request of the same size, direction and library, and freed on reset.
+   */
+  void csoundReleaseFFTSetups(CSOUND *csound, OPDS *owner);
   void csoundComplexFFTnp2(CSOUND *csound, MYFLT *buf, int32_t FFTsize);
   void csoundInverseComplexFFTnp2(CSOUND *csound, MYFLT *buf, int32_t FFTsize);
 #ifdef __cplusplus
@@ -0,0 +1,93 @@
+/*
+    lockstep.h: running the instances of an instrument in lockstep
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#ifndef CSOUND_LOCKSTEP_H
+#define CSOUND_LOCKSTEP_H
+
+#include "vecops.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* With --lockstep the active instances of an instrument are performed
+   together, one opcode at a time across all of them, and an opcode with
+   a batch kernel is called once for the whole group.  A voice leaves the
+   group when it jumps, and finishes its cycle on its own.  As this
+   interleaves the voices, instruments that write globals, tables,
+   channels, zak or the stack, print, monitor the output or call UDOs
+   are always performed one instance at a time.                    */
+
+#define LOCKSTEP_VOICES 64      /* voices in one group */
+#define LOCKSTEP_LANES  8       /* voices a kernel computes side by side */
+#define LOCKSTEP_CHUNK  16      /* samples of a lane block */
+#define LOCKSTEP_OPS    64      /* batch kernels that can be registered */
+
+typedef struct lockstep LOCKSTEP;
+
+/* Perform n voices of one opcode, p[i] being voice i's OPDS.  Voices
+   with a sample-accurate offset or end never reach a kernel.  A kernel
+   sets err[i] (initially 0) when voice i fails, as the opcode's perf
+   function returning non-zero would; returning non-zero stops them all. */
+typedef int32_t (*LOCKSTEP_PERF)(CSOUND *, const LOCKSTEP *, OPDS **p,
+                                 int32_t n, char *err);
+
+struct lockstep {
+    const VECMATH *math;        /* the engine's a-rate math functions */
+    int32_t     count;
+    struct {
+      SUBR          perf;
+      LOCKSTEP_PERF batch;
+    } ops[LOCKSTEP_OPS];
+};
+
+/* Give the opcode whose perf function is perf a batch kernel; plugins
+   call this from their init function.                                  */
+static inline int32_t csoundLockstepRegister(CSOUND *csound, SUBR perf,
+                                             LOCKSTEP_PERF batch)
+{
+    LOCKSTEP *ls = (LOCKSTEP*) csound->QueryGlobalVariable(csound,
+                                                           "::lockstep::");
+    int32_t  i;
+    if (ls == NULL) {
+      if (UNLIKELY(csound->CreateGlobalVariable(csound, "::lockstep::",
+                                                sizeof(LOCKSTEP)) != 0))
+        return NOTOK;
+      ls = (LOCKSTEP*) csound->QueryGlobalVariable(csound, "::lockstep::");
+    }
+    for (i = 0; i < ls->count; i++)
+      if (ls->ops[i].perf == perf) {
+        ls->ops[i].batch = batch;
+        return OK;
+      }
+    if (UNLIKELY(ls->count >= LOCKSTEP_OPS))
+      return NOTOK;
+    ls->ops[ls->count].perf = perf;
+    ls->ops[ls->count].batch = batch;
+    ls->count++;
+    return OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* CSOUND_LOCKSTEP_H */
@@ -177,6 +177,31 @@ extern "C" {
      building pffft.c */
   int32_t pffft_simd_size(void);
 
+  /*
+    Double precision versions of the functions above, built from the
+    same source (pffftd.c). The simd path uses AVX (4 doubles per
+    vector) where the build enables it, and otherwise pairs of SSE2
+    or AArch64 NEON registers; other targets are scalar. The size
+    restrictions are the same.
+  */
+  typedef struct PFFFTD_Setup PFFFTD_Setup;
+  PFFFTD_Setup *pffftd_new_setup(int32_t N, pffft_transform_t transform);
+  void pffftd_destroy_setup(PFFFTD_Setup *);
+  void pffftd_transform(PFFFTD_Setup *setup, const double *input,
+                        double *output, double *work,
+                        pffft_direction_t direction);
+  void pffftd_transform_ordered(PFFFTD_Setup *setup, const double *input,
+                                double *output, double *work,
+                                pffft_direction_t direction);
+  void pffftd_zreorder(PFFFTD_Setup *setup, const double *input,
+                       double *output, pffft_direction_t direction);
+  void pffftd_zconvolve_accumulate(PFFFTD_Setup *setup, const double *dft_a,
+                                   const double *dft_b, double *dft_ab,
+                                   double scaling);
+  void *pffftd_aligned_malloc(size_t nb_bytes);
+  void pffftd_aligned_free(void *);
+  int32_t pffftd_simd_size(void);
+
 #ifdef __cplusplus
 }
 #endif
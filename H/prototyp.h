@@ -94,10 +94,17 @@ int32_t     delete_memfile(CSOUND *, const char *);
 char    *csoundTmpFileName(CSOUND *, const char *);
 void    *SAsndgetset(CSOUND *, char *, void *, MYFLT *, MYFLT *, MYFLT *, int32_t);
 int32_t     getsndin(CSOUND *, void *, MYFLT *, int32_t, void *);
+int32_t     getsndin_decoded(CSOUND *, SNDMEMFILE *, MYFLT *, int32_t, void *);
 void    *sndgetset(CSOUND *, void *);
 void    dbfs_init(CSOUND *, MYFLT dbfs);
 int32_t     csoundLoadExternals(CSOUND *);
 SNDMEMFILE  *csoundLoadSoundFile(CSOUND *, const char *name, void *sfinfo);
+SNDMEMFILE  *csoundDecodedSoundFile(CSOUND *, const char *fullName,
+                                    int32_t wait, const char *decoder,
+                                    SNDMEMFILE *(*decode)(CSOUND *,
+                                                          const char *,
+                                                          size_t));
+void    csoundReleaseDecodedSoundFile(CSOUND *, SNDMEMFILE *);
 int32_t     PVOCEX_LoadFile(CSOUND *, const char *fname, PVOCEX_MEMFILE *p);
 void    print_opcodedir_warning(CSOUND *);
 int32_t     check_rtaudio_name(char *fName, char **devName, int32_t isOutput);
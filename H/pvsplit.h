@@ -0,0 +1,108 @@
+/*
+    pvsplit.h: split amplitude and frequency frames of fsigs
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#ifndef CSOUND_PVSPLIT_H
+#define CSOUND_PVSPLIT_H
+
+#include "pstream.h"
+
+/* With --pvs-split, pvsanal also keeps each frame of its fsig split, the
+   NB amplitudes of the bins in one float array and their frequencies in
+   another.  An opcode that knows the split layout works on the arrays of
+   its input when they hold the current frame, and splits its own output;
+   otherwise it does what it always did.  Every writer fills in the
+   interleaved frame as well, so opcodes that only know that one are none
+   the wiser.
+
+   The split arrays live in the fsig's split member, amplitudes first and
+   the frequencies pvs_split_stride(NB) floats on, and splitcount holds
+   the framecount they were written for.  Header copies of a PVSDAT stop
+   short of both, like they do of the frame, so a copy never shares them;
+   a writer that does not split never touches them, so its frames are
+   never taken for split ones.                                          */
+
+/* floats in each split array, keeping them aligned */
+static inline int32_t pvs_split_stride(int32_t NB)
+{
+    return (NB + 15) & ~15;
+}
+
+static inline size_t pvs_split_bytes(int32_t N)
+{
+    return 2 * (size_t) pvs_split_stride(N / 2 + 1) * sizeof(float);
+}
+
+/* set up the frame of f and its split arrays, which a writer does instead
+   of allocating the frame itself */
+static inline void pvs_split_alloc(CSOUND *csound, PVSDAT *f)
+{
+    size_t bytes = (f->N + 2) * sizeof(float);
+    if (f->frame.auxp == NULL || f->frame.size < bytes)
+      csound->AuxAlloc(csound, bytes, &f->frame);
+    bytes = pvs_split_bytes(f->N);
+    if (f->split.auxp == NULL || f->split.size < bytes)
+      csound->AuxAlloc(csound, bytes, &f->split);
+    f->splitcount = 0;
+}
+
+/* the amplitudes of the split frame of f, frequencies following
+   pvs_split_stride(NB) floats on; whether they are current or not */
+static inline float *pvs_split_arrays(const PVSDAT *f)
+{
+    return (float*) f->split.auxp;
+}
+
+/* whether f has split arrays at all */
+static inline int32_t pvs_split_has(const PVSDAT *f)
+{
+    return (!f->sliding && f->split.auxp != NULL &&
+            f->split.size >= pvs_split_bytes(f->N));
+}
+
+/* the amplitudes of f's current frame, or NULL when it is not split */
+static inline const float *pvs_split_amps(const PVSDAT *f)
+{
+    return (pvs_split_has(f) && f->splitcount == f->framecount) ?
+      pvs_split_arrays(f) : NULL;
+}
+
+/* interleave the split frame of f into its frame, which makes it current;
+   called by a writer after setting framecount */
+static inline void pvs_split_done(PVSDAT *f)
+{
+    int32_t NB = f->N / 2 + 1, i;
+    const float *amp = pvs_split_arrays(f);
+    const float *fr = amp + pvs_split_stride(NB);
+    float *frame = (float*) f->frame.auxp;
+    for (i = 0; i < NB; i++) {
+      frame[2 * i] = amp[i];
+      frame[2 * i + 1] = fr[i];
+    }
+    f->splitcount = f->framecount;
+}
+
+/* for opcodes that change the interleaved frame of f in place */
+static inline void pvs_split_drop(PVSDAT *f)
+{
+    f->splitcount = 0;
+}
+
+#endif  /* CSOUND_PVSPLIT_H */
@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include "lockstep.h"
+
 typedef struct {
   OPDS    h;
   MYFLT   *xr, *ia, *idur, *ib;
@@ -132,3 +134,5 @@ typedef struct {
   AUXCH   auxch;
 } EXPSEG2;                         /*gab-A1*/
 
+/* linseg.a for voices in lockstep */
+int32_t linseg_lanes(CSOUND *, const LOCKSTEP *, OPDS **, int32_t, char *);
@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include "lockstep.h"
+
 typedef struct {
         OPDS    h;
         MYFLT   *sr, *xcps, *iphs;
@@ -85,3 +87,5 @@ typedef struct  {
     double      phs, looplength;
 } LPOSC;
 
+/* oscili.a for voices in lockstep */
+int32_t osckki_lanes(CSOUND *, const LOCKSTEP *, OPDS **, int32_t, char *);
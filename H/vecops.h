@@ -0,0 +1,109 @@
+/*
+    vecops.h: vector kernels for a-rate arithmetic and math
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#ifndef CSOUND_VECOPS_H
+#define CSOUND_VECOPS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* instruction sets, in order of preference on the same CPU */
+#define VECOPS_SCALAR   0
+#define VECOPS_SSE2     1
+#define VECOPS_AVX      2
+#define VECOPS_NEON     3
+
+/* Kernels take unaligned buffers of any length n, may be called in
+   place (r == a or r == b), and give exactly the results of the plain
+   C loops: each lane is one IEEE operation, with no reassociation.  */
+typedef struct {
+    int32_t     level;
+    const char  *name;
+    /* r[i] = a[i] OP b[i] */
+    void    (*add)(MYFLT *r, const MYFLT *a, const MYFLT *b, uint32_t n);
+    void    (*sub)(MYFLT *r, const MYFLT *a, const MYFLT *b, uint32_t n);
+    void    (*mul)(MYFLT *r, const MYFLT *a, const MYFLT *b, uint32_t n);
+    void    (*div)(MYFLT *r, const MYFLT *a, const MYFLT *b, uint32_t n);
+    /* r[i] = a[i] OP b */
+    void    (*addk)(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n);
+    void    (*subk)(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n);
+    void    (*mulk)(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n);
+    void    (*divk)(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n);
+    /* r[i] = b OP a[i], for the operators that do not commute */
+    void    (*ksub)(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n);
+    void    (*kdiv)(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n);
+    /* r[i] = f(a[i]) */
+    void    (*absv)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void    (*sqrtv)(MYFLT *r, const MYFLT *a, uint32_t n);
+    /* non-zero if any a[i] == 0 */
+    int32_t (*anyzero)(const MYFLT *a, uint32_t n);
+} VECOPS;
+
+/* accuracy of the a-rate math functions, --math-accuracy */
+#define VECMATH_EXACT   0       /* the C library */
+#define VECMATH_ULP     1       /* within 1 ulp, 3 for tan and the
+                                   hyperbolic functions */
+#define VECMATH_FAST    2       /* within 1e-7 relative error */
+
+/* Math functions over buffers of any length, which may be in place.
+   asin, acos and atan are the C library's in every mode, and so is pow
+   in all but the fast one; atan2 and hypot are within 2 ulp in the ulp
+   mode, and atan2 within 1e-8 radians in the fast one.               */
+typedef struct {
+    int32_t     accuracy;
+    const char  *name;
+    /* r[i] = f(a[i]) */
+    void    (*expv)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void    (*exp2v)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void    (*logv)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void    (*log2v)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void    (*log10v)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void    (*sinv)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void    (*cosv)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void    (*tanv)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void    (*asinv)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void    (*acosv)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void    (*atanv)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void    (*sinhv)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void    (*coshv)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void    (*tanhv)(MYFLT *r, const MYFLT *a, uint32_t n);
+    /* r[i] = a[i]^b */
+    void    (*powv)(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n);
+    /* r[i] = f(a[i], b[i]) */
+    void    (*atan2v)(MYFLT *r, const MYFLT *a, const MYFLT *b, uint32_t n);
+    void    (*hypotv)(MYFLT *r, const MYFLT *a, const MYFLT *b, uint32_t n);
+} VECMATH;
+
+/* kernels for the best instruction set of this CPU */
+const VECOPS *csoundVecOps(void);
+/* kernels for one instruction set, NULL if the CPU or build lacks it */
+const VECOPS *csoundVecOpsLevel(int32_t level);
+/* math functions of an accuracy, the C library for unknown ones */
+const VECMATH *csoundVecMath(int32_t accuracy);
+/* those chosen for an engine by --math-accuracy */
+#define VECMATH_CS(csound) csoundVecMath((csound)->oparms->math_accuracy)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* CSOUND_VECOPS_H */
@@ -253,13 +253,8 @@ void *sndgetset(CSOUND *csound, void *p_)
     return NULL;
 }
 
-/* a simplified soundin */
-
-int32_t getsndin(CSOUND *csound, void *fd_, MYFLT *fp, int32_t nlocs, void *p_)
+static MYFLT getsndin_scalefac(CSOUND *csound, SOUNDIN *p)
 {
-    SNDFILE *fd = (SNDFILE*) fd_;
-    SOUNDIN *p = (SOUNDIN*) p_;
-    int32_t     i = 0, n;
     MYFLT   scalefac;
 
     if (p->format == AE_FLOAT || p->format == AE_DOUBLE) {
@@ -273,6 +268,17 @@ int32_t getsndin(CSOUND *csound, void *fd_, MYFLT *fp, int32_t nlocs, void *p_)
     }
     else
       scalefac = csound->e0dbfs;
+    return scalefac;
+}
+
+/* a simplified soundin */
+
+int32_t getsndin(CSOUND *csound, void *fd_, MYFLT *fp, int32_t nlocs, void *p_)
+{
+    SNDFILE *fd = (SNDFILE*) fd_;
+    SOUNDIN *p = (SOUNDIN*) p_;
+    int32_t     i = 0, n;
+    MYFLT   scalefac = getsndin_scalefac(csound, p);
 
     if (p->nchanls == 1 || p->channel == ALLCHNLS) {  /* MONO or ALLCHNLS */
       for ( ; i < nlocs; i++) {
@@ -310,6 +316,40 @@ int32_t getsndin(CSOUND *csound, void *fd_, MYFLT *fp, int32_t nlocs, void *p_)
     return n;
 }
 
+/* getsndin() from the decoded frames of the file sndgetset() opened, */
+/* from where it left it; -1 if they are not of that file             */
+
+int32_t getsndin_decoded(CSOUND *csound, SNDMEMFILE *snd, MYFLT *fp,
+                         int32_t nlocs, void *p_)
+{
+    SOUNDIN *p = (SOUNDIN*) p_;
+    MYFLT   scalefac = getsndin_scalefac(csound, p);
+    int64_t start = (int64_t) snd->nFrames - p->framesrem;
+    int32_t i = 0, nch = p->nchanls;
+    const MYFLT *x;
+
+    /* lossy formats decode differently after a seek, so only FLAC */
+    /* is taken from anywhere but the start                         */
+    if (snd->nChannels != nch || p->framesrem < (int64_t) 0 ||
+        start < (int64_t) 0 || p->skiptime < FL(0.0) ||
+        (start > 0 && snd->fileType != TYP_FLAC))
+      return -1;
+    x = &(snd->data[start * nch]);
+    if (nch == 1 || p->channel == ALLCHNLS) {         /* MONO or ALLCHNLS */
+      int64_t n = p->framesrem * nch;
+      for ( ; i < nlocs && i < n; i++)
+        fp[i] = x[i] * scalefac;
+      p->audrem = n - i;
+    }
+    else {                                /* MULTI-CHANNEL, SELECT ONE */
+      for ( ; i < nlocs && i < p->framesrem; i++)
+        fp[i] = x[i * nch + p->channel - 1] * scalefac;
+      p->audrem = (p->framesrem - i) * nch;
+    }
+    memset(&(fp[i]), 0, (nlocs-i)*sizeof(MYFLT)); /* if incomplete PAD */
+    return i;
+}
+
 void dbfs_init(CSOUND *csound, MYFLT dbfs)
 {
     csound->dbfs_to_float = FL(1.0) / dbfs;
@@ -23,6 +23,7 @@
 
 #include "csoundCore.h" /*                                      AOPS.C  */
 #include "aops.h"
+#include "vecops.h"
 #include <math.h>
 #include <time.h>
 
@@ -279,9 +280,13 @@ int32_t modkk(CSOUND *csound, AOP *p)
   return OK;
 }
 
-#define KA(OPNAME,OP)                                                   \
+/* samples from offset to nsmps, none if the event ends before offset */
+#define SPAN(offset,nsmps) ((nsmps) > (offset) ? (nsmps) - (offset) : 0)
+
+/* r = a OP b[n] is done by the vecops kernel computing b[n] OP a */
+#define KA(OPNAME,OP,KERNEL)                                            \
   int32_t OPNAME(CSOUND *csound, AOP *p) {                              \
-    uint32_t n, nsmps = CS_KSMPS;                                       \
+    uint32_t nsmps = CS_KSMPS;                                          \
     IGN(csound);                                                        \
     if (LIKELY(nsmps!=1)) {                                             \
       MYFLT   *r, a, *b;                                                \
@@ -295,8 +300,8 @@ int32_t modkk(CSOUND *csound, AOP *p)
         nsmps -= early;                                                 \
         memset(&r[nsmps], '\0', early*sizeof(MYFLT));                   \
       }                                                                 \
-      for (n=offset; n<nsmps; n++)                                      \
-        r[n] = a OP b[n];                                               \
+      csoundVecOps()->KERNEL(&r[offset], &b[offset], a,                 \
+                             SPAN(offset, nsmps));                      \
       return OK;                                                        \
     }                                                                   \
     else {                                                              \
@@ -306,10 +311,10 @@ int32_t modkk(CSOUND *csound, AOP *p)
   }
 
 
-KA(addka,+)
-KA(subka,-)
-KA(mulka,*)
-KA(divka,/)
+KA(addka,+,addk)
+KA(subka,-,ksub)
+KA(mulka,*,mulk)
+KA(divka,/,kdiv)
 
 int32_t modka(CSOUND *csound, AOP *p)
 {
@@ -332,9 +337,9 @@ int32_t modka(CSOUND *csound, AOP *p)
   return OK;
 }
 
-#define AK(OPNAME,OP)                                   \
+#define AK(OPNAME,OP,KERNEL)                            \
   int32_t OPNAME(CSOUND *csound, AOP *p) {              \
-    uint32_t n, nsmps = CS_KSMPS;                       \
+    uint32_t nsmps = CS_KSMPS;                          \
     IGN(csound);                                        \
     if (LIKELY(nsmps != 1)) {                           \
       MYFLT   *r, *a, b;                                \
@@ -349,8 +354,8 @@ int32_t modka(CSOUND *csound, AOP *p)
         nsmps -= early;                                 \
         memset(&r[nsmps], '\0', early*sizeof(MYFLT));   \
       }                                                 \
-      for (n=offset; n<nsmps; n++)                      \
-        r[n] = a[n] OP b;                               \
+      csoundVecOps()->KERNEL(&r[offset], &a[offset], b, \
+                             SPAN(offset, nsmps));      \
       return OK;                                        \
     }                                                   \
     else {                                              \
@@ -359,12 +364,12 @@ int32_t modka(CSOUND *csound, AOP *p)
     }                                                   \
   }
 
-AK(addak,+)
-AK(subak,-)
-AK(mulak,*)
+AK(addak,+,addk)
+AK(subak,-,subk)
+AK(mulak,*,mulk)
 //AK(divak,/)
 int32_t divak(CSOUND *csound, AOP *p) {
-  uint32_t n, nsmps = CS_KSMPS;
+  uint32_t nsmps = CS_KSMPS;
   MYFLT b = *p->b;
   if (LIKELY(nsmps != 1)) {
     MYFLT   *r, *a;
@@ -381,8 +386,7 @@ int32_t divak(CSOUND *csound, AOP *p) {
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n=offset; n<nsmps; n++)
-      r[n] = a[n] / b;
+    csoundVecOps()->divk(&r[offset], &a[offset], b, SPAN(offset, nsmps));
     return OK;
   }
   else {
@@ -415,11 +419,11 @@ int32_t modak(CSOUND *csound, AOP *p)
   return OK;
 }
 
-#define AA(OPNAME,OP)                                                   \
+#define AA(OPNAME,OP,KERNEL)                                            \
   int32_t OPNAME(CSOUND *csound, AOP *p) {                              \
     MYFLT   *r, *a, *b;                                                 \
     IGN(csound);                                                        \
-    uint32_t n, nsmps = CS_KSMPS;                                       \
+    uint32_t nsmps = CS_KSMPS;                                          \
     if (LIKELY(nsmps!=1)) {                                             \
       uint32_t offset = p->h.insdshead->ksmps_offset;                   \
       uint32_t early  = p->h.insdshead->ksmps_no_end;                   \
@@ -431,8 +435,8 @@ int32_t modak(CSOUND *csound, AOP *p)
         nsmps -= early;                                                 \
         memset(&r[nsmps], '\0', early*sizeof(MYFLT));                   \
       }                                                                 \
-      for (n=offset; n<nsmps; n++)                                      \
-        r[n] = a[n] OP b[n];                                            \
+      csoundVecOps()->KERNEL(&r[offset], &a[offset], &b[offset],        \
+                             SPAN(offset, nsmps));                      \
       return OK;                                                        \
     }                                                                   \
     else {                                                              \
@@ -441,60 +445,17 @@ int32_t modak(CSOUND *csound, AOP *p)
     }                                                                   \
   }
 
-/* VL
-   experimental code using SSE for operations
-   needs memory alignment - 16 bytes
-*/
-#ifdef USE_SSE
-#include "emmintrin.h"
-#define AA_VEC(OPNAME,OP)                                               \
-  int32_t OPNAME(CSOUND *csound, AOP *p){                               \
-    MYFLT   *r, *a, *b;                                                 \
-    __m128d va, vb;                                                     \
-    uint32_t n, nsmps = CS_KSMPS, end;                                  \
-    if (LIKELY(nsmps!=1)) {                                             \
-      uint32_t offset = p->h.insdshead->ksmps_offset;                   \
-      uint32_t early  = p->h.insdshead->ksmps_no_end;                   \
-      r = p->r; a = p->a; b = p->b;                                     \
-      if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));      \
-      if (UNLIKELY(early)) {                                            \
-        nsmps -= early;                                                 \
-        memset(&r[nsmps], '\0', early*sizeof(MYFLT));                   \
-      }                                                                 \
-      end = nsmps;                                                      \
-      for (n=offset; n<end; n+=2) {                                     \
-        va = _mm_loadu_pd(&a[n]);                                       \
-        vb = _mm_loadu_pd(&b[n]);                                       \
-        va = OP(va,vb);                                                 \
-        _mm_storeu_pd(&r[n],va);                                        \
-      }                                                                 \
-      return OK;                                                        \
-    }                                                                   \
-    else {                                                              \
-      *p->r = *p->a + *p->b;                                            \
-      return OK;                                                        \
-    }                                                                   \
-  }                                                                     \
-
-AA_VEC(addaa,_mm_add_pd)
-AA_VEC(subaa,_mm_sub_pd)
-AA_VEC(mulaa,_mm_mul_pd)
-AA_VEC(divaa,_mm_div_pd)
-
-#else
-AA(addaa,+)
-AA(subaa,-)
-AA(mulaa,*)
+AA(addaa,+,add)
+AA(subaa,-,sub)
+AA(mulaa,*,mul)
 //AA(divaa,/)
-#endif
 
 int32_t divaa(CSOUND *csound, AOP *p)
 {
   MYFLT   *r, *a, *b;
-  int32_t     err = 0;
-  IGN(csound);
-  uint32_t n, nsmps = CS_KSMPS;
+  uint32_t nsmps = CS_KSMPS;
   if (LIKELY(nsmps!=1)) {
+    const VECOPS *v = csoundVecOps();
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     r = p->r;
@@ -505,14 +466,9 @@ int32_t divaa(CSOUND *csound, AOP *p)
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n=offset; n<nsmps; n++ ) {
-      MYFLT bb = b[n];
-      if (UNLIKELY(bb==FL(0.0) && err==0)) {
-        csound->Warning(csound, Str("Division by zero"));
-        err = 1;
-      }
-      r[n] = a[n] / bb;
-    }
+    if (UNLIKELY(v->anyzero(&b[offset], SPAN(offset, nsmps))))
+      csound->Warning(csound, Str("Division by zero"));
+    v->div(&r[offset], &a[offset], &b[offset], SPAN(offset, nsmps));
     return OK;
   }
   else {
@@ -850,11 +806,29 @@ int32_t atan21(CSOUND *csound, AOP *p)
   return OK;
 }
 
-#define LIBA(OPNAME,LIBNAME) int32_t OPNAME(CSOUND *csound, EVAL *p) {  \
+/* the same through the math functions of the engine's accuracy */
+#define MATHA(OPNAME,KERNEL) int32_t OPNAME(CSOUND *csound, EVAL *p) {  \
+    const VECMATH *vm = VECMATH_CS(csound);                             \
+    uint32_t offset = p->h.insdshead->ksmps_offset;                     \
+    uint32_t early  = p->h.insdshead->ksmps_no_end;                     \
+    uint32_t nsmps =CS_KSMPS;                                           \
+    MYFLT   *r, *a;                                                     \
+    r = p->r;                                                           \
+    a = p->a;                                                           \
+    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));        \
+    if (UNLIKELY(early)) {                                              \
+      nsmps -= early;                                                   \
+      memset(&r[nsmps], '\0', early*sizeof(MYFLT));                     \
+    }                                                                   \
+    vm->KERNEL(&r[offset], &a[offset], SPAN(offset, nsmps));            \
+    return OK;                                                          \
+  }
+/* and for functions with exact vector instructions */
+#define VECA(OPNAME,KERNEL) int32_t OPNAME(CSOUND *csound, EVAL *p) {   \
     IGN(csound);                                                        \
     uint32_t offset = p->h.insdshead->ksmps_offset;                     \
     uint32_t early  = p->h.insdshead->ksmps_no_end;                     \
-    uint32_t n, nsmps =CS_KSMPS;                                        \
+    uint32_t nsmps =CS_KSMPS;                                           \
     MYFLT   *r, *a;                                                     \
     r = p->r;                                                           \
     a = p->a;                                                           \
@@ -863,25 +837,203 @@ int32_t atan21(CSOUND *csound, AOP *p)
       nsmps -= early;                                                   \
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));                     \
     }                                                                   \
-    for (n = offset; n < nsmps; n++)                                    \
-      r[n] = LIBNAME(a[n]);                                             \
+    csoundVecOps()->KERNEL(&r[offset], &a[offset], SPAN(offset, nsmps)); \
     return OK;                                                          \
   }
-LIBA(absa,FABS)
-LIBA(expa,EXP)
-LIBA(loga,LOG)
-LIBA(sqrta,SQRT)
-LIBA(sina,SIN)
-LIBA(cosa,COS)
-LIBA(tana,TAN)
-LIBA(asina,ASIN)
-LIBA(acosa,ACOS)
-LIBA(atana,ATAN)
-LIBA(sinha,SINH)
-LIBA(cosha,COSH)
-LIBA(tanha,TANH)
-LIBA(log10a,LOG10)
-LIBA(log2a,LOG2)
+VECA(absa,absv)
+MATHA(expa,expv)
+MATHA(loga,logv)
+VECA(sqrta,sqrtv)
+MATHA(sina,sinv)
+MATHA(cosa,cosv)
+MATHA(tana,tanv)
+MATHA(asina,asinv)
+MATHA(acosa,acosv)
+MATHA(atana,atanv)
+MATHA(sinha,sinhv)
+MATHA(cosha,coshv)
+MATHA(tanha,tanhv)
+MATHA(log10a,log10v)
+MATHA(log2a,log2v)
+
+/* Fused a-rate expressions: the expression compiler replaces a tree of
+   a-rate arithmetic and math functions by one ##fuse call, which runs the
+   postfix program FUSE_LANES samples at a time on a small stack, so that
+   no intermediate signal is written out between operators.             */
+
+enum { FUSE_STACK, FUSE_AUDIO, FUSE_SCALAR };
+
+static inline int32_t fuse_binary(char c)
+{
+  return (c == '+' || c == '-' || c == '*' || c == '/' || c == '%');
+}
+
+static inline int32_t fuse_unary(char c)
+{
+  return (c != '\0' && strchr("AELGBQSCTUVWHKNIFRDP", c) != NULL);
+}
+
+int32_t fusea_set(CSOUND *csound, FUSE *p)
+{
+  const char *s = p->prog->data;
+  int32_t   nargs = GetInputArgCnt(&(p->h)) - 1;
+  int32_t   narg = 0, nscal = 0, ncode = 0, depth = 0, i;
+  size_t    len, size;
+  FUSE_INSN *code;
+  MYFLT     *buf;
+
+  if (UNLIKELY(s == NULL))
+    goto err;
+  len = strlen(s);
+  for (i = 0; s[i] != '\0'; i++)
+    if (s[i] == 'k') nscal++;
+  size = len * sizeof(FUSE_INSN) + nscal * FUSE_LANES * sizeof(MYFLT);
+  if (p->code.auxp == NULL || p->code.size < size)
+    csound->AuxAlloc(csound, size, &p->code);
+  code = (FUSE_INSN*) p->code.auxp;
+  buf = (MYFLT*) (code + len);
+  for (i = 0; s[i] != '\0'; i++) {
+    FUSE_INSN *c = &code[ncode++];
+    if (s[i] == 'a' || s[i] == 'k') {
+      if (UNLIKELY(narg >= nargs))
+        goto err;
+      c->arg = p->args[narg++];
+      c->src = (s[i] == 'a' ? FUSE_AUDIO : FUSE_SCALAR);
+      c->buf = NULL;
+      if (c->src == FUSE_SCALAR) {
+        c->buf = buf;
+        buf += FUSE_LANES;
+      }
+      /* an operand directly followed by a binary operator is */
+      /* not pushed, but read by the operator in place         */
+      if (depth > 0 && fuse_binary(s[i + 1]))
+        c->op = s[++i];
+      else {
+        c->op = 'p';
+        if (UNLIKELY(++depth > FUSE_MAXDEPTH))
+          goto err;
+      }
+    }
+    else if (fuse_binary(s[i])) {
+      if (UNLIKELY(depth < 2))
+        goto err;
+      depth--;
+      c->op = s[i]; c->src = FUSE_STACK;
+      c->arg = c->buf = NULL;
+    }
+    else if (fuse_unary(s[i])) {
+      if (UNLIKELY(depth < 1))
+        goto err;
+      c->op = s[i]; c->src = FUSE_STACK;
+      c->arg = c->buf = NULL;
+    }
+    else
+      goto err;
+  }
+  if (UNLIKELY(depth != 1 || narg != nargs))
+    goto err;
+  p->ncode = ncode;
+  return OK;
+ err:
+  return csound->InitError(csound, Str("invalid fused expression"));
+}
+
+#define FUSE_BINOP(OP)                                  \
+  if (c->src == FUSE_STACK) y = stk[sp--];              \
+  x = stk[sp];                                          \
+  for (j = 0; j < m; j++) x[j] = x[j] OP y[j];          \
+  break;
+
+#define FUSE_LIB(LIBNAME)                               \
+  x = stk[sp];                                          \
+  for (j = 0; j < m; j++) x[j] = LIBNAME(x[j]);         \
+  break;
+
+/* the math functions as the separate opcodes compute them */
+#define FUSE_MATH(KERNEL)                               \
+  x = stk[sp];                                          \
+  vm->KERNEL(x, x, m);                                  \
+  break;
+
+int32_t fusea(CSOUND *csound, FUSE *p)
+{
+  FUSE_INSN *code = (FUSE_INSN*) p->code.auxp, *end = code + p->ncode, *c;
+  MYFLT    stk[FUSE_MAXDEPTH][FUSE_LANES], *r = p->r, *x, *y, intpart;
+  const VECMATH *vm = VECMATH_CS(csound);
+  uint32_t offset = p->h.insdshead->ksmps_offset;
+  uint32_t early  = p->h.insdshead->ksmps_no_end;
+  uint32_t n, j, m, nsmps = CS_KSMPS;
+  int32_t  sp, divzero = 0;
+
+  /* scalar operands are constant over the k-cycle */
+  for (c = code; c < end; c++)
+    if (c->src == FUSE_SCALAR) {
+      MYFLT b = *c->arg;
+      for (j = 0; j < FUSE_LANES; j++) c->buf[j] = b;
+    }
+  if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
+  if (UNLIKELY(early)) {
+    nsmps -= early;
+    memset(&r[nsmps], '\0', early*sizeof(MYFLT));
+  }
+  for (n = offset; n < nsmps; n += m) {
+    m = (nsmps - n < FUSE_LANES ? nsmps - n : FUSE_LANES);
+    sp = -1;
+    for (c = code; c < end; c++) {
+      y = (c->src == FUSE_AUDIO ? c->arg + n : c->buf);
+      switch (c->op) {
+      case 'p':
+        x = stk[++sp];
+        memcpy(x, y, m*sizeof(MYFLT));
+        break;
+      case '+': FUSE_BINOP(+)
+      case '-': FUSE_BINOP(-)
+      case '*': FUSE_BINOP(*)
+      case '/':
+        if (c->src == FUSE_STACK) y = stk[sp--];
+        x = stk[sp];
+        for (j = 0; j < m; j++) divzero |= (y[j] == FL(0.0));
+        for (j = 0; j < m; j++) x[j] = x[j] / y[j];
+        break;
+      case '%':
+        if (c->src == FUSE_STACK) y = stk[sp--];
+        x = stk[sp];
+        for (j = 0; j < m; j++) x[j] = MOD(x[j], y[j]);
+        break;
+      case 'A': FUSE_LIB(FABS)
+      case 'E': FUSE_MATH(expv)
+      case 'L': FUSE_MATH(logv)
+      case 'G': FUSE_MATH(log10v)
+      case 'B': FUSE_MATH(log2v)
+      case 'Q': FUSE_LIB(SQRT)
+      case 'S': FUSE_MATH(sinv)
+      case 'C': FUSE_MATH(cosv)
+      case 'T': FUSE_MATH(tanv)
+      case 'U': FUSE_MATH(asinv)
+      case 'V': FUSE_MATH(acosv)
+      case 'W': FUSE_MATH(atanv)
+      case 'H': FUSE_MATH(sinhv)
+      case 'K': FUSE_MATH(coshv)
+      case 'N': FUSE_MATH(tanhv)
+      case 'I':
+        x = stk[sp];
+        for (j = 0; j < m; j++) { MODF(x[j], &intpart); x[j] = intpart; }
+        break;
+      case 'F':
+        x = stk[sp];
+        for (j = 0; j < m; j++) x[j] = MODF(x[j], &intpart);
+        break;
+      case 'R': FUSE_LIB((MYFLT) MYFLT2LRND)
+      case 'D': FUSE_LIB((MYFLT) MYFLOOR)
+      case 'P': FUSE_LIB((MYFLT) MYCEIL)
+      }
+    }
+    memcpy(&r[n], stk[0], m*sizeof(MYFLT));
+  }
+  if (UNLIKELY(divzero))
+    csound->Warning(csound, Str("Division by zero"));
+  return OK;
+}
 
 int32_t atan2aa(CSOUND *csound, AOP *p)
 {
@@ -923,7 +1075,6 @@ int32_t aampdb(CSOUND *csound, EVAL *p)
   uint32_t early  = p->h.insdshead->ksmps_no_end;
   uint32_t n, nsmps =CS_KSMPS;
   MYFLT   *r = p->r, *a = p->a;
-  IGN(csound);
 
   if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
   if (UNLIKELY(early)) {
@@ -931,7 +1082,8 @@ int32_t aampdb(CSOUND *csound, EVAL *p)
     memset(&r[nsmps], '\0', early*sizeof(MYFLT));
   }
   for (n = offset; n < nsmps; n++)
-    r[n] = EXP(a[n] * LOG10D20);
+    r[n] = a[n] * LOG10D20;
+  VECMATH_CS(csound)->expv(&r[offset], &r[offset], SPAN(offset, nsmps));
   return OK;
 }
 
@@ -962,7 +1114,10 @@ int32_t aampdbfs(CSOUND *csound, EVAL *p)
     memset(&r[nsmps], '\0', early*sizeof(MYFLT));
   }
   for (n = offset; n < nsmps; n++)
-    r[n] = csound->e0dbfs * EXP(a[n] * LOG10D20);
+    r[n] = a[n] * LOG10D20;
+  VECMATH_CS(csound)->expv(&r[offset], &r[offset], SPAN(offset, nsmps));
+  for (n = offset; n < nsmps; n++)
+    r[n] = csound->e0dbfs * r[n];
   return OK;
 }
 
@@ -1314,14 +1469,13 @@ int32_t powoftwoa(CSOUND *csound, EVAL *p)
   MYFLT    *a=p->a, *r=p->r;
   uint32_t offset = p->h.insdshead->ksmps_offset;
   uint32_t early  = p->h.insdshead->ksmps_no_end;
-  uint32_t n, nsmps =CS_KSMPS;
+  uint32_t nsmps =CS_KSMPS;
   if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
   if (UNLIKELY(early)) {
     nsmps -= early;
     memset(&r[nsmps], '\0', early*sizeof(MYFLT));
   }
-  for (n = offset; n < nsmps; n++)
-    r[n] = POWER(FL(2.0), a[n]);
+  VECMATH_CS(csound)->exp2v(&r[offset], &a[offset], SPAN(offset, nsmps));
   return OK;
 }
 
@@ -1348,10 +1502,9 @@ int32_t asemitone(CSOUND *csound, EVAL *p)            /* JPff */
     nsmps -= early;
     memset(&r[nsmps], '\0', early*sizeof(MYFLT));
   }
-  for (n = offset; n < nsmps; n++) {
-    MYFLT aa = (a[n])*ONEd12;
-    r[n] = POWER(FL(2.0), aa);
-  }
+  for (n = offset; n < nsmps; n++)
+    r[n] = (a[n])*ONEd12;
+  VECMATH_CS(csound)->exp2v(&r[offset], &r[offset], SPAN(offset, nsmps));
   return OK;
 }
 
@@ -1375,10 +1528,9 @@ int32_t acent(CSOUND *csound, EVAL *p)        /* JPff */
     nsmps -= early;
     memset(&r[nsmps], '\0', early*sizeof(MYFLT));
   }
-  for (n = offset; n < nsmps; n++) {
-    MYFLT aa = (a[n])*ONEd1200;
-    r[n] = POWER(FL(2.0), aa);
-  }
+  for (n = offset; n < nsmps; n++)
+    r[n] = (a[n])*ONEd1200;
+  VECMATH_CS(csound)->exp2v(&r[offset], &r[offset], SPAN(offset, nsmps));
   return OK;
 }
 
@@ -1403,10 +1555,9 @@ int32_t dba(CSOUND *csound, EVAL *p)          /* JPff */
     nsmps -= early;
     memset(&r[nsmps], '\0', early*sizeof(MYFLT));
   }
-  for (n = offset; n < nsmps; n++) {
-    MYFLT aa = a[n];
-    r[n] = POWER(FL(2.0), aa*LOG2_10D20);
-  }
+  for (n = offset; n < nsmps; n++)
+    r[n] = a[n]*LOG2_10D20;
+  VECMATH_CS(csound)->exp2v(&r[offset], &r[offset], SPAN(offset, nsmps));
   return OK;
 }
 
@@ -1950,12 +2101,12 @@ int32_t addina(CSOUND *csound, ASSIGN *p)
   MYFLT* val = p->a;
   MYFLT* ans = p->r;
   uint32_t    offset = p->h.insdshead->ksmps_offset;
-  uint32_t    nsmps = CS_KSMPS, n;
+  uint32_t    nsmps = CS_KSMPS;
   uint32_t    early = nsmps-p->h.insdshead->ksmps_no_end;
 
   CSOUND_SPOUT_SPINLOCK
-    for (n=offset; n<early; n++)
-      ans[n] += val[n];
+    csoundVecOps()->add(&ans[offset], &ans[offset], &val[offset],
+                        SPAN(offset, early));
   CSOUND_SPOUT_SPINUNLOCK
     return OK;
 }
@@ -1965,13 +2116,12 @@ int32_t addinak(CSOUND *csound, ASSIGN *p)
   MYFLT val;
   MYFLT* ans = p->r;
   uint32_t    offset = p->h.insdshead->ksmps_offset;
-  uint32_t    nsmps = CS_KSMPS, n;
+  uint32_t    nsmps = CS_KSMPS;
   uint32_t    early = nsmps-p->h.insdshead->ksmps_no_end;
 
   CSOUND_SPOUT_SPINLOCK
     val = *p->a;
-  for (n=offset; n<early; n++)
-    ans[n] += val;
+  csoundVecOps()->addk(&ans[offset], &ans[offset], val, SPAN(offset, early));
   CSOUND_SPOUT_SPINUNLOCK
     return OK;
 }
@@ -1997,12 +2147,12 @@ int32_t subina(CSOUND *csound, ASSIGN *p)
   MYFLT* val = p->a;
   MYFLT* ans = p->r;
   uint32_t    offset = p->h.insdshead->ksmps_offset;
-  uint32_t    nsmps = CS_KSMPS, n;
+  uint32_t    nsmps = CS_KSMPS;
   uint32_t    early = nsmps-p->h.insdshead->ksmps_no_end;
 
   CSOUND_SPOUT_SPINLOCK
-    for (n=offset; n<early; n++)
-      ans[n] -= val[n];
+    csoundVecOps()->sub(&ans[offset], &ans[offset], &val[offset],
+                        SPAN(offset, early));
   CSOUND_SPOUT_SPINUNLOCK
     return OK;
 }
@@ -2012,13 +2162,12 @@ int32_t subinak(CSOUND *csound, ASSIGN *p)
   MYFLT val;
   MYFLT* ans = p->r;
   uint32_t    offset = p->h.insdshead->ksmps_offset;
-  uint32_t    nsmps = CS_KSMPS, n;
+  uint32_t    nsmps = CS_KSMPS;
   uint32_t    early = nsmps-p->h.insdshead->ksmps_no_end;
 
   CSOUND_SPOUT_SPINLOCK
     val = *p->a;
-  for (n=offset; n<early; n++)
-    ans[n] -= val;
+  csoundVecOps()->subk(&ans[offset], &ans[offset], val, SPAN(offset, early));
   CSOUND_SPOUT_SPINUNLOCK
     return OK;
 }
@@ -36,6 +36,7 @@
 
 #include "bus.h"
 #include "namedins.h"
+#include "pvsplit.h"
 
 int32_t *csoundGetChannelLock(CSOUND *csound, const char *name);
 
@@ -192,7 +193,7 @@ int32_t pvsin_init(CSOUND *csound, FCHAN *p)
         p->lock = (spin_lock_t *)
                 csoundGetChannelLock(csound, p->name);
         csoundSpinLock(p->lock);
-        memcpy(&(p->init), p->f, sizeof(PVSDAT)-sizeof(AUXCH));
+        memcpy(&(p->init), p->f, PVSDAT_HEADER);
         csoundSpinUnLock(p->lock);
     } 
 
@@ -202,7 +203,7 @@ int32_t pvsin_init(CSOUND *csound, FCHAN *p)
     p->init.wintype = (int32_t)(*p->wintype);
     p->init.format = (int32_t)(*p->format);
     p->init.framecount = 0;
-    memcpy(p->r, &p->init, sizeof(PVSDAT)-sizeof(AUXCH));
+    memcpy(p->r, &p->init, PVSDAT_HEADER);
     if (p->r->frame.auxp == NULL ||
         p->r->frame.size < sizeof(float) * (N + 2))
         csound->AuxAlloc(csound, (N + 2) * sizeof(float), &p->r->frame);
@@ -238,7 +239,7 @@ int32_t pvsin_perf(CSOUND *csound, FCHAN *p)
     }
     size = p->f->N < fout->N ? p->f->N : fout->N;
     csoundSpinLock(p->lock);
-    memcpy(fout, p->f, sizeof(PVSDAT)-sizeof(AUXCH));
+    memcpy(fout, p->f, PVSDAT_HEADER);
     if(p->f->frame.auxp != NULL)
         memcpy(fout->frame.auxp, p->f->frame.auxp, sizeof(float)*(size+2));
     else memset(fout->frame.auxp, 0, sizeof(float)*(size+2));
@@ -265,7 +266,7 @@ int32_t pvsout_init(CSOUND *csound, FCHAN *p)
         if(p->f->frame.auxp == NULL || p->f->N < fin->N) {
             csound->AuxAlloc(csound, (p->f->N + 2) * sizeof(float), &p->f->frame);
         } 
-        memcpy(p->f, fin, sizeof(PVSDAT)-sizeof(AUXCH));
+        memcpy(p->f, fin, PVSDAT_HEADER);
         csoundSpinUnLock(p->lock);
     }
     return OK;
@@ -300,7 +301,7 @@ int32_t pvsout_perf(CSOUND *csound, FCHAN *p)
     }
     csoundSpinLock(p->lock);
     size = fin->N < p->f->N ? fin->N : p->f->N;
-    memcpy(p->f, fin, sizeof(PVSDAT)-sizeof(AUXCH));
+    memcpy(p->f, fin, PVSDAT_HEADER);
     if(p->f->frame.auxp != NULL)
         memcpy(p->f->frame.auxp, fin->frame.auxp, sizeof(float)*(size+2));
     csoundSpinUnLock(p->lock);
@@ -332,7 +333,9 @@ PUBLIC const float *csoundGetPvsData(const PVSDAT *pvsdat) {
 }
 
 PUBLIC void csoundSetPvsData(PVSDAT *pvsdat, const float *frame) {
-  memcpy(pvsdat->frame.auxp, frame, pvsdat->frame.size);
+  /* the frame may have split arrays after it, which are now stale */
+  memcpy(pvsdat->frame.auxp, frame, (pvsdat->N + 2) * sizeof(float));
+  pvs_split_drop(pvsdat);
 }
 
 PUBLIC PVSDAT *csoundInitPvsChannel(CSOUND *csound, const char* name,
@@ -2600,7 +2603,7 @@ PUBLIC int32_t csoundSetPvsChannel(CSOUND *csound, const char *name,
     csoundSpinLock(lock);
     if (f->frame.auxp == NULL || f->N < fin->N) 
        csound->AuxAlloc(csound, fin->frame.size, &f->frame);
-    memcpy(f, fin, sizeof(PVSDAT)-sizeof(AUXCH));
+    memcpy(f, fin, PVSDAT_HEADER);
     if (fin->frame.auxp != NULL)
       memcpy(f->frame.auxp, fin->frame.auxp, fin->frame.size);
     csoundSpinUnLock(lock);
@@ -2621,7 +2624,7 @@ PUBLIC int32_t csoundGetPvsChannel(CSOUND *csound, const char *name,
       csoundGetChannelLock(csound, name);
     if (UNLIKELY(f == NULL)) return CSOUND_ERROR;
     csoundSpinLock(lock);
-    memcpy(fout, f, sizeof(PVSDAT)-sizeof(AUXCH));
+    memcpy(fout, f, PVSDAT_HEADER);
     if (fout->frame.auxp != NULL && f->frame.auxp != NULL)
       memcpy(fout->frame.auxp, f->frame.auxp, sizeof(float)*(fout->N));
     csoundSpinUnLock(lock);
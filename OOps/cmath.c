@@ -26,6 +26,7 @@
 
 #include "csoundCore.h"
 #include "cmath.h"
+#include "vecops.h"
 #include <math.h>
 
 int32_t ipow(CSOUND *csound, POW *p)        /*      Power for i-rate */
@@ -67,8 +68,10 @@ int32_t apow(CSOUND *csound, POW *p)        /* Power routine for a-rate  */
       }
     }
     else {
+      VECMATH_CS(csound)->powv(&out[offset], &in[offset], powerOf,
+                               nsmps > offset ? nsmps - offset : 0);
       for (n = offset; n < nsmps; n++)
-        out[n] = POWER(in[n], powerOf) / norm;
+        out[n] = out[n] / norm;
     }
     return OK;
 }
@@ -219,8 +219,9 @@ OSC_MESS *csoundReadOSCMessage(CSOUND *csound, const char *address,
   if(p->address == NULL) return NULL;
   csoundSpinLock(lock);
   do {
-    if(!strcmp(p->address, address) && !strcmp(p->type, type) &&
-       p->flag) break;
+    /* slots still being filled by the server have flag 2 */
+    if(p->flag == 1 && !strcmp(p->address, address) &&
+       !strcmp(p->type, type)) break;
   } while((p = p->nxt) != NULL);
   csoundSpinUnLock(lock);
   return p;
@@ -35,13 +35,276 @@ typedef struct DISKIN_INST_ {
 } DISKIN_INST;
 
 
+/* ------------- pages and kernels shared by all instances ------------- */
+/* Sample frames read from a file are kept in pages of DISKIN2_PAGE_FRAMES */
+/* frames, which every instance reading the same file (by name, format,   */
+/* channels and length) copies from, so that voices playing one file at  */
+/* different pitches read and convert it once.  A file is referenced by   */
+/* the instances using it; pages are dropped least recently used first    */
+/* when the cache would grow beyond --diskin-cache megabytes, and a file  */
+/* nobody uses goes with its last page.                                   */
+/* With --diskin-sinc-tables, sinc interpolation weights are tabulated   */
+/* for DISKIN2_PHASES fractional positions per sample, for each window    */
+/* size and band of upward transposition (DISKIN2_BANDS per octave), and  */
+/* shared in the same way; they differ from the weights computed per      */
+/* sample by -50 to -70 dB above the centre of a band, so are not the     */
+/* default.                                                               */
+/* Up to DISKIN2_SPARE_KERNELS kernels nobody uses are kept, and init     */
+/* builds the bands either side of the starting pitch, so that a voice    */
+/* moving between neighbouring bands does not allocate and tabulate them  */
+/* on the performance thread.                                             */
+
+#define DISKIN2_PAGE_FRAMES     4096
+#define DISKIN2_PHASE_BITS      8
+#define DISKIN2_PHASES          (1 << DISKIN2_PHASE_BITS)
+#define DISKIN2_PHASE_SHIFT     (POS_FRAC_SHIFT - DISKIN2_PHASE_BITS)
+#define DISKIN2_BANDS           48
+#define DISKIN2_MAXBAND         (DISKIN2_BANDS * 16)
+#define DISKIN2_SPARE_KERNELS   8
+
+typedef struct DISKIN2_PAGE_ {
+  struct DISKIN2_FILE_  *file;
+  struct DISKIN2_PAGE_  *prv, *nxt;     /* most recently used first */
+  int32_t page;
+  MYFLT   *data;                        /* DISKIN2_PAGE_FRAMES frames */
+} DISKIN2_PAGE;
+
+typedef struct DISKIN2_FILE_ {
+  char    *name;
+  int32_t format, nChannels, fileLength;
+  int32_t refs, npages, loaded;
+  DISKIN2_PAGE **pages;
+  struct DISKIN2_FILE_ *nxt;
+} DISKIN2_FILE;
+
+typedef struct DISKIN2_KERNEL_ {
+  int32_t winSize, band, refs;
+  uint32_t used;                        /* when it was last in use */
+  /* for each phase, winSize weights then their steps to the next phase */
+  MYFLT   *w;
+  struct DISKIN2_KERNEL_ *nxt;
+} DISKIN2_KERNEL;
+
+typedef struct {
+  void    *lock;
+  DISKIN2_FILE   *files;
+  DISKIN2_KERNEL *kernels;
+  DISKIN2_PAGE   *mru, *lru;
+  size_t  bytes;
+  uint32_t clock;
+} DISKIN2_CACHE;
+
+static int32_t diskin2_cache_destroy(CSOUND *csound, void *pp)
+{
+    DISKIN2_CACHE *cache = (DISKIN2_CACHE *) pp;
+    if (cache->lock != NULL)
+      csound->DestroyMutex(cache->lock);
+    cache->lock = NULL;
+    return OK;
+}
+
+static DISKIN2_CACHE *diskin2_cache(CSOUND *csound)
+{
+    DISKIN2_CACHE *cache =
+      (DISKIN2_CACHE *) csound->QueryGlobalVariable(csound,
+                                                    "::DISKIN2_CACHE::");
+    if (cache == NULL) {
+      csound->CreateGlobalVariable(csound, "::DISKIN2_CACHE::",
+                                   sizeof(DISKIN2_CACHE));
+      cache = (DISKIN2_CACHE *) csound->QueryGlobalVariable(csound,
+                                                        "::DISKIN2_CACHE::");
+      cache->lock = csound->Create_Mutex(0);
+      csound->RegisterResetCallback(csound, (void*) cache,
+                                    diskin2_cache_destroy);
+    }
+    return cache;
+}
+
+/* called with the cache locked */
+static void diskin2_page_unlink(DISKIN2_CACHE *cache, DISKIN2_PAGE *pg)
+{
+    if (pg->prv != NULL) pg->prv->nxt = pg->nxt;
+    else cache->mru = pg->nxt;
+    if (pg->nxt != NULL) pg->nxt->prv = pg->prv;
+    else cache->lru = pg->prv;
+    pg->prv = pg->nxt = NULL;
+}
+
+static void diskin2_page_link(DISKIN2_CACHE *cache, DISKIN2_PAGE *pg)
+{
+    pg->prv = NULL;
+    pg->nxt = cache->mru;
+    if (cache->mru != NULL) cache->mru->prv = pg;
+    else cache->lru = pg;
+    cache->mru = pg;
+}
+
+static void diskin2_file_free(CSOUND *csound, DISKIN2_CACHE *cache,
+                              DISKIN2_FILE *f)
+{
+    DISKIN2_FILE **fp = &cache->files;
+    while (*fp != f)
+      fp = &((*fp)->nxt);
+    *fp = f->nxt;
+    csound->Free(csound, f->pages);
+    csound->Free(csound, f->name);
+    csound->Free(csound, f);
+}
+
+static void diskin2_page_free(CSOUND *csound, DISKIN2_CACHE *cache,
+                              DISKIN2_PAGE *pg)
+{
+    DISKIN2_FILE *f = pg->file;
+    diskin2_page_unlink(cache, pg);
+    f->pages[pg->page] = NULL;
+    cache->bytes -= (size_t) DISKIN2_PAGE_FRAMES * f->nChannels * sizeof(MYFLT);
+    csound->Free(csound, pg->data);
+    csound->Free(csound, pg);
+    if (--f->loaded == 0 && f->refs == 0)
+      diskin2_file_free(csound, cache, f);
+}
+
+/* the shared pages of the file opened as fd, or NULL if there is no cache */
+static DISKIN2_FILE *diskin2_file_open(CSOUND *csound, void *fd,
+                                       int32_t format, int32_t nChannels,
+                                       int32_t fileLength)
+{
+    DISKIN2_CACHE *cache;
+    DISKIN2_FILE  *f;
+    const char    *name = csound->GetFileName(fd);
+    if (csound->oparms->diskin_cache <= 0 || name == NULL || fileLength < 1)
+      return NULL;
+    cache = diskin2_cache(csound);
+    csound->LockMutex(cache->lock);
+    for (f = cache->files; f != NULL; f = f->nxt)
+      if (f->format == format && f->nChannels == nChannels &&
+          f->fileLength == fileLength && !strcmp(f->name, name))
+        break;
+    if (f == NULL) {
+      f = (DISKIN2_FILE *) csound->Calloc(csound, sizeof(DISKIN2_FILE));
+      f->name = cs_strdup(csound, name);
+      f->format = format;
+      f->nChannels = nChannels;
+      f->fileLength = fileLength;
+      f->npages = (int32_t) (((int64_t) fileLength + DISKIN2_PAGE_FRAMES - 1)
+                             / DISKIN2_PAGE_FRAMES);
+      f->pages = (DISKIN2_PAGE **) csound->Calloc(csound, f->npages *
+                                                  sizeof(DISKIN2_PAGE *));
+      f->nxt = cache->files;
+      cache->files = f;
+    }
+    f->refs++;
+    csound->UnlockMutex(cache->lock);
+    return f;
+}
+
+static void diskin2_file_close(CSOUND *csound, DISKIN2_FILE **fp)
+{
+    DISKIN2_CACHE *cache;
+    DISKIN2_FILE  *f = *fp;
+    if (f == NULL)
+      return;
+    *fp = NULL;
+    cache = diskin2_cache(csound);
+    csound->LockMutex(cache->lock);
+    if (--f->refs == 0 && f->loaded == 0)
+      diskin2_file_free(csound, cache, f);
+    csound->UnlockMutex(cache->lock);
+}
+
+/* the decoded frames of a compressed file, as far as they are decoded */
+/* and match the file opened as fd                                     */
+
+static SNDMEMFILE *diskin2_decoded(CSOUND *csound, void *fd,
+                                   int32_t format, int32_t nChannels,
+                                   int32_t fileLength)
+{
+    SNDMEMFILE *snd;
+    /* only FLAC seeks exactly, so that the pages read from disk hold */
+    /* the same samples as the frames decoded from the start          */
+    if (SF2TYPE(format) != TYP_FLAC)
+      return NULL;
+    snd = csound->DecodedSoundFile(csound, csound->GetFileName(fd), 0,
+                                   NULL, NULL);
+    if (snd != NULL && (snd->nChannels != nChannels ||
+                        snd->nFrames != (size_t) fileLength)) {
+      csound->ReleaseDecodedSoundFile(csound, snd);
+      snd = NULL;
+    }
+    return snd;
+}
+
+/* read sample frames start to start + frames - 1, all within the file, */
+/* into buf through the pages of f, loading them with sf where missing; */
+/* returns the number of mono samples read                              */
+
+static int32_t diskin2_file_read(CSOUND *csound, DISKIN2_FILE *f, void *sf,
+                                 MYFLT *buf, int32_t start, int32_t frames)
+{
+    DISKIN2_CACHE *cache = diskin2_cache(csound);
+    int32_t nch = f->nChannels, done = 0;
+    size_t  bytes = (size_t) DISKIN2_PAGE_FRAMES * nch * sizeof(MYFLT);
+    size_t  maxBytes = (size_t) csound->oparms->diskin_cache << 20;
+
+    csound->LockMutex(cache->lock);
+    while (done < frames) {
+      int32_t pos = start + done, page = pos / DISKIN2_PAGE_FRAMES;
+      int32_t ofs = pos - page * DISKIN2_PAGE_FRAMES;
+      int32_t n = DISKIN2_PAGE_FRAMES - ofs;
+      DISKIN2_PAGE *pg = f->pages[page];
+      if (n > frames - done)
+        n = frames - done;
+      if (pg == NULL) {
+        /* read the page unlocked, so that other voices are not held up */
+        /* by the disk; sf is ours alone                                */
+        int32_t i = 0, len = f->fileLength - page * DISKIN2_PAGE_FRAMES;
+        csound->UnlockMutex(cache->lock);
+        pg = (DISKIN2_PAGE *) csound->Calloc(csound, sizeof(DISKIN2_PAGE));
+        pg->data = (MYFLT *) csound->Malloc(csound, bytes);
+        pg->file = f;
+        pg->page = page;
+        if (len > DISKIN2_PAGE_FRAMES)
+          len = DISKIN2_PAGE_FRAMES;
+        csound->SndfileSeek(csound, sf,
+                            (sf_count_t) page * DISKIN2_PAGE_FRAMES, SEEK_SET);
+        i = (int32_t) csound->SndfileReadSamples(csound, sf, pg->data,
+                                                 (sf_count_t) len * nch);
+        if (UNLIKELY(i < 0))
+          i = 0;
+        memset(&pg->data[i], 0, bytes - i * sizeof(MYFLT));
+        csound->LockMutex(cache->lock);
+        if (f->pages[page] != NULL) {
+          /* another voice loaded it meanwhile */
+          csound->Free(csound, pg->data);
+          csound->Free(csound, pg);
+          pg = f->pages[page];
+          diskin2_page_unlink(cache, pg);
+        }
+        else {
+          while (cache->lru != NULL && cache->bytes + bytes > maxBytes)
+            diskin2_page_free(csound, cache, cache->lru);
+          f->pages[page] = pg;
+          f->loaded++;
+          cache->bytes += bytes;
+        }
+      }
+      else
+        diskin2_page_unlink(cache, pg);
+      diskin2_page_link(cache, pg);
+      memcpy(&buf[done * nch], &pg->data[ofs * nch],
+             (size_t) n * nch * sizeof(MYFLT));
+      done += n;
+    }
+    csound->UnlockMutex(cache->lock);
+    return done * nch;
+}
+
 static CS_NOINLINE void diskin2_read_buffer(CSOUND *csound,
                                             DISKIN2 *p, int32_t bufReadPos)
 {
     MYFLT *tmp;
     int32_t nsmps;
     int32_t i;
-    IGN(csound);
     /* swap buffer pointers */
     tmp = p->buf;
     p->buf = p->prvBuf;
@@ -68,12 +331,25 @@ static CS_NOINLINE void diskin2_read_buffer(CSOUND *csound,
       if (nsmps > 0L) {         /* if there is anything to read: */
         if (nsmps > (int32_t) p->bufSize)
           nsmps = (int32_t) p->bufSize;
-        nsmps *= (int32_t) p->nChannels;
-        csound->SndfileSeek(csound, p->sf, (sf_count_t) p->bufStartPos, SEEK_SET);
-        /* convert sample count to mono samples and read file */
-        i = (int32_t) csound->SndfileReadSamples(csound, p->sf, p->buf, (sf_count_t) nsmps);
-        if (UNLIKELY(i < 0))  /* error ? */
-          i = 0;    /* clear entire buffer to zero */
+        if (p->pcm != NULL) {   /* from the decoded frames */
+          i = nsmps * (int32_t) p->nChannels;
+          memcpy(p->buf, &(p->pcm->data[(size_t) p->bufStartPos
+                                        * p->nChannels]),
+                 (size_t) i * sizeof(MYFLT));
+        }
+        else if (p->cfile != NULL)      /* through the shared pages */
+          i = diskin2_file_read(csound, p->cfile, p->sf, p->buf,
+                                p->bufStartPos, nsmps);
+        else {
+          nsmps *= (int32_t) p->nChannels;
+          csound->SndfileSeek(csound, p->sf, (sf_count_t) p->bufStartPos,
+                              SEEK_SET);
+          /* convert sample count to mono samples and read file */
+          i = (int32_t) csound->SndfileReadSamples(csound, p->sf, p->buf,
+                                                   (sf_count_t) nsmps);
+          if (UNLIKELY(i < 0))  /* error ? */
+            i = 0;    /* clear entire buffer to zero */
+        }
       }
     }
     /* fill rest of buffer with zero samples */
@@ -184,6 +460,314 @@ static inline void init_sine_gen(double a, double f, double p, double c,
     *x *= a; *v *= a;
 }
 
+/* the band of transposition by inc (in POS_FRAC_SCALE units), rounded */
+/* to the nearest: 0 up to the ratio at which diskin2 has always       */
+/* started to lower the cutoff, and for the first half band above it   */
+
+static int32_t diskin2_band(int64_t inc)
+{
+    double  r, lim = (double) (POS_FRAC_SCALE + (POS_FRAC_SCALE >> 12));
+    int32_t band;
+    if (inc < (int64_t) 0)
+      inc = -inc;
+    if ((double) inc <= lim)
+      return 0;
+    r = log2((double) inc / lim) * DISKIN2_BANDS;
+    band = (r < (double) DISKIN2_MAXBAND ? (int32_t) (r + 0.5)
+            : DISKIN2_MAXBAND);
+    return band;
+}
+
+/* weights of a window of winSize samples, -(winSize / 2 - 1) to       */
+/* winSize / 2 around the read position, for fractional positions j /  */
+/* DISKIN2_PHASES; the sinc is stretched by 1 / warp, and the window   */
+/* corrected as diskin2 did when it computed the weights per sample    */
+
+static void diskin2_kernel_fill(DISKIN2_KERNEL *k, MYFLT winFact0)
+{
+    int32_t W = k->winSize, wsized2 = W >> 1, i, j;
+    double  warp = (k->band == 0 ? 1.0 :
+                    pow(2.0, -(double) k->band / DISKIN2_BANDS));
+    double  pidwarp = PI * warp, c = 2.0 * cos(pidwarp) - 2.0;
+    double  winFact = (double) winFact0, x, v;
+    MYFLT   *w = k->w;
+
+    if (k->band != 0) {
+      x = v = (double) wsized2; x *= x; x = 1.0 / x;
+      v *= warp; v -= (double) ((int32_t) v) + 0.5; v *= 4.0 * v;
+      winFact = (winFact - x) * v + x;
+    }
+    for (j = 0; j <= DISKIN2_PHASES; j++, w += 2 * W) {
+      double d = (double) (1 - wsized2) - (double) j / DISKIN2_PHASES, a;
+      init_sine_gen((1.0 / PI), pidwarp, (pidwarp * d), c, &x, &v);
+      for (i = 0; i < W; i++) {
+        if (d == 0.0)
+          w[i] = (MYFLT) warp;
+        else {
+          a = 1.0 - d * d * winFact;
+          w[i] = (MYFLT) (x * a * a / d);
+        }
+        d += 1.0; v += c * x; x += v;
+      }
+      if (j > 0)
+        for (i = 0; i < W; i++)
+          w[i - W] = w[i] - w[i - 2 * W];
+    }
+}
+
+/* the kernel for winSize and band, made if missing; called locked */
+
+static DISKIN2_KERNEL *diskin2_kernel_find(CSOUND *csound,
+                                           DISKIN2_CACHE *cache,
+                                           int32_t winSize, MYFLT winFact,
+                                           int32_t band)
+{
+    DISKIN2_KERNEL *k;
+    for (k = cache->kernels; k != NULL; k = k->nxt)
+      if (k->winSize == winSize && k->band == band)
+        return k;
+    k = (DISKIN2_KERNEL *) csound->Calloc(csound, sizeof(DISKIN2_KERNEL));
+    k->winSize = winSize;
+    k->band = band;
+    k->used = ++cache->clock;
+    /* one more phase than needed, its steps unused */
+    k->w = (MYFLT *) csound->Calloc(csound, (size_t) (DISKIN2_PHASES + 1) *
+                                    2 * winSize * sizeof(MYFLT));
+    diskin2_kernel_fill(k, winFact);
+    k->nxt = cache->kernels;
+    cache->kernels = k;
+    return k;
+}
+
+/* drop the kernels nobody has used for longest, beyond the spare ones */
+
+static void diskin2_kernel_trim(CSOUND *csound, DISKIN2_CACHE *cache)
+{
+    for (;;) {
+      DISKIN2_KERNEL **kk, **old = NULL, *t;
+      int32_t spare = 0;
+      for (kk = &cache->kernels; *kk != NULL; kk = &(*kk)->nxt)
+        if ((*kk)->refs == 0) {
+          spare++;
+          if (old == NULL || (*kk)->used < (*old)->used)
+            old = kk;
+        }
+      if (spare <= DISKIN2_SPARE_KERNELS)
+        return;
+      t = *old;
+      *old = t->nxt;
+      csound->Free(csound, t->w);
+      csound->Free(csound, t);
+    }
+}
+
+static void diskin2_kernel_unref(DISKIN2_CACHE *cache, DISKIN2_KERNEL *k)
+{
+    if (--k->refs == 0)
+      k->used = ++cache->clock;
+}
+
+/* the kernel for transposing by inc, keeping a reference to it in *kp */
+
+static const DISKIN2_KERNEL *diskin2_kernel(CSOUND *csound,
+                                            DISKIN2_KERNEL **kp,
+                                            int32_t winSize, MYFLT winFact,
+                                            int64_t inc)
+{
+    DISKIN2_CACHE  *cache;
+    DISKIN2_KERNEL *k = *kp;
+    int32_t band = diskin2_band(inc);
+    if (k != NULL && k->winSize == winSize && k->band == band)
+      return k;
+    cache = diskin2_cache(csound);
+    csound->LockMutex(cache->lock);
+    if (k != NULL)
+      diskin2_kernel_unref(cache, k);
+    k = diskin2_kernel_find(csound, cache, winSize, winFact, band);
+    k->refs++;
+    diskin2_kernel_trim(csound, cache);
+    csound->UnlockMutex(cache->lock);
+    return (*kp = k);
+}
+
+/* at init, with --diskin-sinc-tables: take the kernel for inc, and make */
+/* its neighbours spare ones                                               */
+
+static void diskin2_kernel_prepare(CSOUND *csound, DISKIN2_KERNEL **kp,
+                                   int32_t winSize, MYFLT winFact,
+                                   int64_t inc)
+{
+    DISKIN2_CACHE *cache;
+    int32_t band, b;
+    if (winSize <= 4 || !csound->oparms->diskin_sinc_tables)
+      return;
+    band = diskin2_kernel(csound, kp, winSize, winFact, inc)->band;
+    cache = diskin2_cache(csound);
+    csound->LockMutex(cache->lock);
+    for (b = band - 1; b <= band + 1; b += 2)
+      if (b >= 0 && b <= DISKIN2_MAXBAND) {
+        DISKIN2_KERNEL *k =
+          diskin2_kernel_find(csound, cache, winSize, winFact, b);
+        if (k->refs == 0)
+          k->used = ++cache->clock;
+      }
+    diskin2_kernel_trim(csound, cache);
+    csound->UnlockMutex(cache->lock);
+}
+
+static void diskin2_kernel_release(CSOUND *csound, DISKIN2_KERNEL **kp)
+{
+    DISKIN2_CACHE *cache;
+    if (*kp == NULL)
+      return;
+    cache = diskin2_cache(csound);
+    csound->LockMutex(cache->lock);
+    diskin2_kernel_unref(cache, *kp);
+    csound->UnlockMutex(cache->lock);
+    *kp = NULL;
+}
+
+/* interpolation weights at fractional position frac (POS_FRAC_SCALE units) */
+
+static inline void diskin2_sinc_weights(const DISKIN2_KERNEL *k, int32_t frac,
+                                        MYFLT *w)
+{
+    int32_t W = k->winSize, i;
+    int32_t j = frac >> DISKIN2_PHASE_SHIFT;
+    MYFLT   t = (MYFLT) (frac & ((1 << DISKIN2_PHASE_SHIFT) - 1))
+      * (FL(1.0) / (MYFLT) (1 << DISKIN2_PHASE_SHIFT));
+    const MYFLT *r = k->w + (size_t) j * 2 * W, *dr = r + W;
+    for (i = 0; i < W; i++)
+      w[i] = r[i] + t * dr[i];
+}
+
+/* s[c] = sum of w[i] * x[i * nch + c], winSize a multiple of 4 */
+
+static inline void diskin2_sinc_dot(const MYFLT *w, const MYFLT *x,
+                                    int32_t winSize, int32_t nch, MYFLT *s)
+{
+    int32_t i, c;
+    if (nch == 1) {
+      MYFLT a0 = FL(0.0), a1 = FL(0.0), a2 = FL(0.0), a3 = FL(0.0);
+      for (i = 0; i < winSize; i += 4) {
+        a0 += w[i] * x[i];
+        a1 += w[i + 1] * x[i + 1];
+        a2 += w[i + 2] * x[i + 2];
+        a3 += w[i + 3] * x[i + 3];
+      }
+      s[0] = (a0 + a1) + (a2 + a3);
+    }
+    else if (nch == 2) {
+      MYFLT l0 = FL(0.0), r0 = FL(0.0), l1 = FL(0.0), r1 = FL(0.0);
+      for (i = 0; i < winSize; i += 2) {
+        l0 += w[i] * x[2 * i];
+        r0 += w[i] * x[2 * i + 1];
+        l1 += w[i + 1] * x[2 * i + 2];
+        r1 += w[i + 1] * x[2 * i + 3];
+      }
+      s[0] = l0 + l1;
+      s[1] = r0 + r1;
+    }
+    else {
+      for (c = 0; c < nch; c++)
+        s[c] = FL(0.0);
+      for (i = 0; i < winSize; i++)
+        for (c = 0; c < nch; c++)
+          s[c] += w[i] * x[i * nch + c];
+    }
+}
+
+/* without --diskin-sinc-tables, the windowed sinc is computed per output */
+/* sample, as it always was                                               */
+
+typedef struct {
+    int32_t warp;
+    MYFLT   onedwarp, winFact;
+    double  pidwarp_d, c;
+} DISKIN2_SINC;
+
+static void diskin2_sinc_init(DISKIN2_SINC *q, int32_t winSize,
+                              MYFLT winFact, int64_t inc)
+{
+    int32_t wsized2 = winSize >> 1;
+    int32_t nn = POS_FRAC_SCALE + (POS_FRAC_SCALE >> 12);
+    double  x, v;
+    if (inc > (int64_t) nn || inc < (int64_t) (-nn)) {
+      q->warp = 1;                    /* enable warp */
+      q->onedwarp = (inc >= (int64_t) 0 ?
+                     ((MYFLT)nn / (MYFLT)inc)
+                     : ((MYFLT)(-nn) / (MYFLT)inc));
+      q->pidwarp_d = PI * (double)q->onedwarp;
+      q->c = 2.0 * cos(q->pidwarp_d) - 2.0;
+      /* correct window for kwarp */
+      x = v = (double)wsized2; x *= x; x = 1.0 / x;
+      v *= (double)q->onedwarp; v -= (double)((int32_t)v) + 0.5; v *= 4.0 * v;
+      q->winFact = (MYFLT)(((double)winFact - x) * v + x);
+    }
+    else {
+      q->warp = 0;
+      q->onedwarp = FL(0.0);
+      q->pidwarp_d = q->c = 0.0;
+      q->winFact = winFact;
+    }
+}
+
+/* the winSize weights at position pos_frac, from sample -(winSize/2 - 1); */
+/* returns the index of the only sample to read, on a sample, or -1        */
+
+static int32_t diskin2_sinc_direct(const DISKIN2_SINC *q, int32_t winSize,
+                                   int64_t pos_frac, MYFLT *w)
+{
+    int32_t wsized2 = winSize >> 1, i;
+    double  d, frac_d, x, v;
+    MYFLT   a0, a1;
+    frac_d = (double)((int32_t)(pos_frac & (int64_t)POS_FRAC_MASK))
+      * (1.0 / (double)POS_FRAC_SCALE);
+    d = (double)(1 - wsized2) - frac_d;
+    if (q->warp) {                          /* ---- warp enabled ---- */
+      init_sine_gen((1.0 / PI), q->pidwarp_d, (q->pidwarp_d * d), q->c,
+                    &x, &v);
+      for (i = 0; i < winSize; i++) {
+        /* avoid division by zero at samples 0 and 1 */
+        if (UNLIKELY(i == wsized2 - 1 && frac_d < 0.00003))
+          a1 = q->onedwarp;
+        else if (UNLIKELY(i == wsized2 && frac_d > 0.99997))
+          a1 = q->onedwarp;
+        else {
+          a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * q->winFact;
+          a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
+        }
+        w[i] = a1;
+        d += 1.0; v += q->c * x; x += v;
+      }
+      return -1;
+    }
+    /* ---- warp disabled ---- */
+    /* avoid division by zero */
+    if (frac_d < 0.00001 || frac_d > 0.99999)
+      return wsized2 - (frac_d < 0.5 ? 1 : 0);
+    a0 = (MYFLT)(sin(PI * frac_d) / PI);
+    for (i = 0; i < winSize; i += 2) {
+      a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * q->winFact;
+      a1 = a1 * a1 / (MYFLT)d;
+      w[i] = a1*a0;
+      d += 1.0;
+      a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * q->winFact;
+      a1 = -(a1 * a1 / (MYFLT)d);
+      w[i + 1] = a1*a0;
+      d += 1.0;
+    }
+    return -1;
+}
+
+/* whether the window of sinc interpolation from sample frame start is */
+/* all in the current buffer, at bufPos, without wrapping in the file   */
+
+#define DISKIN2_WINDOW_IN_BUFFER(p, start, bufPos)                      \
+  ((uint32_t) (bufPos) <= (uint32_t) ((p)->bufSize - (p)->winSize) &&   \
+   (!(p)->wrapMode ||                                                   \
+    ((start) >= 0 && (start) <= (p)->fileLength - (p)->winSize)))
+
 /* calculate buffer size in sample frames */
 
 static int32_t diskin2_calc_buffer_size(DISKIN2 *p, int32_t n_monoSamps)
@@ -378,6 +962,15 @@ static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
     }
     /* set file parameters from header info */
     p->fileLength = (int32_t) sfinfo.frames;
+    /* read a FLAC file from its decoded frames, with --decode-cache, */
+    /* once there are any, otherwise share the pages of the file      */
+    csound->ReleaseDecodedSoundFile(csound, p->pcm);
+    p->pcm = diskin2_decoded(csound, fd, sfinfo.format, p->nChannels,
+                             p->fileLength);
+    diskin2_file_close(csound, &(p->cfile));
+    if (p->pcm == NULL)
+      p->cfile = diskin2_file_open(csound, fd, sfinfo.format, p->nChannels,
+                                   p->fileLength);
     p->warpScale = 1.0;
     if (MYFLT2LONG(CS_ESR) != sfinfo.samplerate) {
       if (LIKELY(p->winSize != 1)) {
@@ -405,6 +998,9 @@ static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
     }
     p->pos_frac_inc = (int64_t)0;
     p->prv_kTranspose = FL(0.0);
+    diskin2_kernel_prepare(csound, &(p->kernel), p->winSize, p->winFact,
+                           (int64_t) ((double) *(p->kTranspose) *
+                                      p->warpScale * (double) POS_FRAC_SCALE));
     p->transpose = FL(1.0);
     /* allocate and initialise buffers */
     p->bufSize = diskin2_calc_buffer_size(p, MYFLT2LONG(p->BufSize));
@@ -541,6 +1137,10 @@ int32_t diskin2_async_deinit(CSOUND *csound, DISKIN2 *p){
     csound->Free(csound, current);
     csound->DestroyCircularBuffer(csound, ((DISKIN2 *)p)->cb);
   }
+  diskin2_file_close(csound, &(p->cfile));
+  diskin2_kernel_release(csound, &(p->kernel));
+  csound->ReleaseDecodedSoundFile(csound, p->pcm);
+  p->pcm = NULL;
 
   return OK;
 }
@@ -568,10 +1168,11 @@ int32_t diskin2_perf_synchronous(CSOUND *csound, DISKIN2 *p)
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     int32_t      nsmps = CS_KSMPS;
     int32_t      chn, i, nn;
-    double   d, frac_d, x, c, v, pidwarp_d;
-    MYFLT    frac, a0, a1, a2, a3, onedwarp, winFact;
+    MYFLT    frac, a0, a1, a2, a3, w[1024], s[DISKIN2_MAXCHN];
     int32_t  ndx;
-    int32_t  wsized2, warp;
+    int32_t  wsized2, start, bufPos;
+    const DISKIN2_KERNEL *kern;
+    DISKIN2_SINC sinc;
 
 
     if (UNLIKELY(p->fdch.fd == NULL) ) goto file_error;
@@ -639,99 +1240,36 @@ int32_t diskin2_perf_synchronous(CSOUND *csound, DISKIN2 *p)
       }
       break;
     default:                  /* ---- sinc interpolation ---- */
+      kern = (csound->oparms->diskin_sinc_tables ?
+              diskin2_kernel(csound, &(p->kernel), p->winSize, p->winFact,
+                             p->pos_frac_inc) : NULL);
+      if (kern == NULL)
+        diskin2_sinc_init(&sinc, p->winSize, p->winFact, p->pos_frac_inc);
       wsized2 = p->winSize >> 1;
-      nn = POS_FRAC_SCALE + (POS_FRAC_SCALE >> 12);
-      if (p->pos_frac_inc > (int64_t) nn ||
-          p->pos_frac_inc < (int64_t) (-nn)) {
-        warp = 1;                     /* enable warp */
-        onedwarp = (p->pos_frac_inc >= (int64_t) 0 ?
-                    ((MYFLT)nn / (MYFLT)p->pos_frac_inc)
-                    : ((MYFLT)(-nn) / (MYFLT)p->pos_frac_inc));
-        pidwarp_d = PI * (double)onedwarp;
-        c = 2.0 * cos(pidwarp_d) - 2.0;
-        /* correct window for kwarp */
-        x = v = (double)wsized2; x *= x; x = 1.0 / x;
-        v *= (double)onedwarp; v -= (double)((int32_t)v) + 0.5; v *= 4.0 * v;
-        winFact = (MYFLT)(((double)p->winFact - x) * v + x);
-      }
-      else {
-        warp = 0;
-        onedwarp = FL(0.0);
-        pidwarp_d = c = 0.0;
-        winFact = p->winFact;
-      }
       for (nn = offset; nn < nsmps; nn++) {
-        frac_d = (double)((int32_t)(p->pos_frac & (int64_t)POS_FRAC_MASK))
-          * (1.0 / (double)POS_FRAC_SCALE);
-        ndx += (int32_t)(1 - wsized2);
-        d = (double)(1 - wsized2) - frac_d;
-        if (warp) {                           /* ---- warp enabled ---- */
-          init_sine_gen((1.0 / PI), pidwarp_d, (pidwarp_d * d), c, &x, &v);
-          /* samples -(window size / 2 - 1) to -1 */
-          i = wsized2 - 1;
-          do {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-            diskin2_get_sample(csound, p, ndx, nn, a1);
-            ndx++;
-            d += 1.0; v += c * x; x += v;
-          } while (--i);
-          /* sample 0 */
-          /* avoid division by zero */
-          if (UNLIKELY(frac_d < 0.00003)) {
-            a1 = onedwarp;
-          }
-          else {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-          }
-          diskin2_get_sample(csound, p, ndx, nn, a1);
-          ndx++;
-          d += 1.0; v += c * x; x += v;
-          /* sample 1 */
-          /* avoid division by zero */
-          if (UNLIKELY(frac_d > 0.99997)) {
-            a1 = onedwarp;
-          }
-          else {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-          }
-          diskin2_get_sample(csound, p, ndx, nn, a1);
-          ndx++;
-          d += 1.0; v += c * x; x += v;
-          /* samples 2 to (window size / 2) */
-          i = wsized2 - 1;
-          do {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-            diskin2_get_sample(csound, p, ndx, nn, a1);
-            ndx++;
-            d += 1.0; v += c * x; x += v;
-          } while (--i);
+        start = ndx + 1 - wsized2;
+        if (kern == NULL) {
+          i = diskin2_sinc_direct(&sinc, p->winSize, p->pos_frac, w);
+          if (i >= 0)                 /* on a sample */
+            diskin2_get_sample(csound, p, start + i, nn, FL(1.0));
+          else
+            for (i = 0; i < p->winSize; i++)
+              diskin2_get_sample(csound, p, start + i, nn, w[i]);
+          diskin2_file_pos_inc(p, &ndx);
+          continue;
         }
-        else {                                /* ---- warp disabled ---- */
-          /* avoid division by zero */
-          if (frac_d < 0.00001 || frac_d > 0.99999) {
-            ndx += (int32_t) (wsized2 - (frac_d < 0.5 ? 1 : 0));
-            diskin2_get_sample(csound, p, ndx, nn, FL(1.0));
-          }
-          else {
-            a0 = (MYFLT)(sin(PI * frac_d) / PI);
-            i = wsized2;
-            do {
-              a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-              a1 = a1 * a1 / (MYFLT)d;
-              diskin2_get_sample(csound, p, ndx, nn, a1*a0);
-              d += 1.0;
-              ndx++;
-              a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-              a1 = -(a1 * a1 / (MYFLT)d);
-              diskin2_get_sample(csound, p, ndx, nn, a1*a0);
-              d += 1.0;
-              ndx++;
-            } while (--i);
-          }
+        diskin2_sinc_weights(kern, (int32_t) (p->pos_frac &
+                                              (int64_t) POS_FRAC_MASK), w);
+        bufPos = start - p->bufStartPos;
+        if (DISKIN2_WINDOW_IN_BUFFER(p, start, bufPos)) {
+          diskin2_sinc_dot(w, &p->buf[bufPos * p->nChannels], p->winSize,
+                           p->nChannels, s);
+          for (chn = 0; chn < p->nChannels; chn++)
+            p->aOut[chn][nn] += s[chn];
+        }
+        else {                        /* across buffers or the file end */
+          for (i = 0; i < p->winSize; i++)
+            diskin2_get_sample(csound, p, start + i, nn, w[i]);
         }
         /* update file position */
         diskin2_file_pos_inc(p, &ndx);
@@ -756,10 +1294,11 @@ int32_t diskin_file_read(CSOUND *csound, DISKIN2 *p)
    //p->aOut_bufsize;// - p->h.insdshead->ksmps_offset;
     int32_t i, nn;
     int32_t chn, chans = p->nChannels;
-    double  d, frac_d, x, c, v, pidwarp_d;
-    MYFLT   frac, a0, a1, a2, a3, onedwarp, winFact;
+    MYFLT   frac, a0, a1, a2, a3, w[1024], s[DISKIN2_MAXCHN];
     int32_t ndx;
-    int32_t wsized2, warp;
+    int32_t wsized2, start, bufPos;
+    const DISKIN2_KERNEL *kern;
+    DISKIN2_SINC sinc;
     MYFLT   *aOut = (MYFLT *)p->aOut_buf; /* needs to be allocated */
     MYFLT transpose = p->transpose;
 
@@ -827,99 +1366,36 @@ int32_t diskin_file_read(CSOUND *csound, DISKIN2 *p)
       }
       break;
     default:                  /* ---- sinc interpolation ---- */
+      kern = (csound->oparms->diskin_sinc_tables ?
+              diskin2_kernel(csound, &(p->kernel), p->winSize, p->winFact,
+                             p->pos_frac_inc) : NULL);
+      if (kern == NULL)
+        diskin2_sinc_init(&sinc, p->winSize, p->winFact, p->pos_frac_inc);
       wsized2 = p->winSize >> 1;
-      nn = POS_FRAC_SCALE + (POS_FRAC_SCALE >> 12);
-      if (p->pos_frac_inc > (int64_t) nn ||
-          p->pos_frac_inc < (int64_t) (-nn)) {
-        warp = 1;                     /* enable warp */
-        onedwarp = (p->pos_frac_inc >= (int64_t) 0 ?
-                    ((MYFLT)nn / (MYFLT)p->pos_frac_inc)
-                    : ((MYFLT)(-nn) / (MYFLT)p->pos_frac_inc));
-        pidwarp_d = PI * (double)onedwarp;
-        c = 2.0 * cos(pidwarp_d) - 2.0;
-        /* correct window for kwarp */
-        x = v = (double)wsized2; x *= x; x = 1.0 / x;
-        v *= (double)onedwarp; v -= (double)((int32_t)v) + 0.5; v *= 4.0 * v;
-        winFact = (MYFLT)(((double)p->winFact - x) * v + x);
-      }
-      else {
-        warp = 0;
-        onedwarp = FL(0.0);
-        pidwarp_d = c = 0.0;
-        winFact = p->winFact;
-      }
       for (nn = 0; nn < nsmps; nn++) {
-        frac_d = (double)((int32_t)(p->pos_frac & (int64_t)POS_FRAC_MASK))
-          * (1.0 / (double)POS_FRAC_SCALE);
-        ndx += (int32_t)(1 - wsized2);
-        d = (double)(1 - wsized2) - frac_d;
-        if (warp) {                           /* ---- warp enabled ---- */
-          init_sine_gen((1.0 / PI), pidwarp_d, (pidwarp_d * d), c, &x, &v);
-          /* samples -(window size / 2 - 1) to -1 */
-          i = wsized2 - 1;
-          do {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-            diskin2_get_sample(csound, p, ndx, nn, a1);
-            ndx++;
-            d += 1.0; v += c * x; x += v;
-          } while (--i);
-          /* sample 0 */
-          /* avoid division by zero */
-          if (UNLIKELY(frac_d < 0.00003)) {
-            a1 = onedwarp;
-          }
-          else {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-          }
-          diskin2_get_sample(csound, p, ndx, nn, a1);
-          ndx++;
-          d += 1.0; v += c * x; x += v;
-          /* sample 1 */
-          /* avoid division by zero */
-          if (UNLIKELY(frac_d > 0.99997)) {
-            a1 = onedwarp;
-          }
-          else {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-          }
-          diskin2_get_sample(csound, p, ndx, nn, a1);
-          ndx++;
-          d += 1.0; v += c * x; x += v;
-          /* samples 2 to (window size / 2) */
-          i = wsized2 - 1;
-          do {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-            diskin2_get_sample(csound, p, ndx, nn, a1);
-            ndx++;
-            d += 1.0; v += c * x; x += v;
-          } while (--i);
+        start = ndx + 1 - wsized2;
+        if (kern == NULL) {
+          i = diskin2_sinc_direct(&sinc, p->winSize, p->pos_frac, w);
+          if (i >= 0)                 /* on a sample */
+            diskin2_get_sample(csound, p, start + i, nn, FL(1.0));
+          else
+            for (i = 0; i < p->winSize; i++)
+              diskin2_get_sample(csound, p, start + i, nn, w[i]);
+          diskin2_file_pos_inc(p, &ndx);
+          continue;
         }
-        else {                                /* ---- warp disabled ---- */
-          /* avoid division by zero */
-          if (frac_d < 0.00001 || frac_d > 0.99999) {
-            ndx += (int32_t) (wsized2 - (frac_d < 0.5 ? 1 : 0));
-            diskin2_get_sample(csound, p, ndx, nn, FL(1.0));
-          }
-          else {
-            a0 = (MYFLT)(sin(PI * frac_d) / PI);
-            i = wsized2;
-            do {
-              a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-              a1 = a0 * a1 * a1 / (MYFLT)d;
-              diskin2_get_sample(csound, p, ndx, nn, a1);
-              d += 1.0;
-              ndx++;
-              a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-              a1 = -(a0 * a1 * a1 / (MYFLT)d);
-              diskin2_get_sample(csound, p, ndx, nn, a1);
-              d += 1.0;
-              ndx++;
-            } while (--i);
-          }
+        diskin2_sinc_weights(kern, (int32_t) (p->pos_frac &
+                                              (int64_t) POS_FRAC_MASK), w);
+        bufPos = start - p->bufStartPos;
+        if (DISKIN2_WINDOW_IN_BUFFER(p, start, bufPos)) {
+          diskin2_sinc_dot(w, &p->buf[bufPos * chans], p->winSize,
+                           chans, s);
+          for (chn = 0; chn < chans; chn++)
+            aOut[nn * chans + chn] += s[chn];
+        }
+        else {                        /* across buffers or the file end */
+          for (i = 0; i < p->winSize; i++)
+            diskin2_get_sample(csound, p, start + i, nn, w[i]);
         }
         /* update file position */
         diskin2_file_pos_inc(p, &ndx);
@@ -1169,7 +1645,6 @@ static CS_NOINLINE void diskin2_read_buffer_array(CSOUND *csound,
     MYFLT   *tmp;
     int32_t nsmps;
     int32_t i;
-    IGN(csound);
     /* swap buffer pointers */
     tmp = p->buf;
     p->buf = p->prvBuf;
@@ -1196,12 +1671,25 @@ static CS_NOINLINE void diskin2_read_buffer_array(CSOUND *csound,
       if (nsmps > 0L) {         /* if there is anything to read: */
         if (nsmps > (int32_t) p->bufSize)
           nsmps = (int32_t) p->bufSize;
-        nsmps *= (int32_t) p->nChannels;
-        csound->SndfileSeek(csound, p->sf, (sf_count_t) p->bufStartPos, SEEK_SET);
-        /* convert sample count to mono samples and read file */
-        i = (int32_t) csound->SndfileReadSamples(csound, p->sf, p->buf, (sf_count_t) nsmps);
-        if (UNLIKELY(i < 0))  /* error ? */
-          i = 0;    /* clear entire buffer to zero */
+        if (p->pcm != NULL) {   /* from the decoded frames */
+          i = nsmps * (int32_t) p->nChannels;
+          memcpy(p->buf, &(p->pcm->data[(size_t) p->bufStartPos
+                                        * p->nChannels]),
+                 (size_t) i * sizeof(MYFLT));
+        }
+        else if (p->cfile != NULL)      /* through the shared pages */
+          i = diskin2_file_read(csound, p->cfile, p->sf, p->buf,
+                                p->bufStartPos, nsmps);
+        else {
+          nsmps *= (int32_t) p->nChannels;
+          csound->SndfileSeek(csound, p->sf, (sf_count_t) p->bufStartPos,
+                              SEEK_SET);
+          /* convert sample count to mono samples and read file */
+          i = (int32_t) csound->SndfileReadSamples(csound, p->sf, p->buf,
+                                                   (sf_count_t) nsmps);
+          if (UNLIKELY(i < 0))  /* error ? */
+            i = 0;    /* clear entire buffer to zero */
+        }
       }
     }
     /* fill rest of buffer with zero samples */
@@ -1349,6 +1837,10 @@ int32_t diskin2_async_deinit_array(CSOUND *csound,  DISKIN2_ARRAY *p){
     csound->Free(csound, current);
     csound->DestroyCircularBuffer(csound, ((DISKIN2_ARRAY *)p)->cb);
   }
+  diskin2_file_close(csound, &(p->cfile));
+  diskin2_kernel_release(csound, &(p->kernel));
+  csound->ReleaseDecodedSoundFile(csound, p->pcm);
+  p->pcm = NULL;
     return OK;
 }
 
@@ -1359,10 +1851,11 @@ int32_t diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p)
   int32_t nsmps = p->aOut_bufsize;// - p->h.insdshead->ksmps_offset;
     int32_t i, nn;
     int32_t chn, chans = p->nChannels;
-    double  d, frac_d, x, c, v, pidwarp_d;
-    MYFLT   frac, a0, a1, a2, a3, onedwarp, winFact;
+    MYFLT   frac, a0, a1, a2, a3, w[1024], s[DISKIN2_MAXCHN];
     int32_t   ndx;
-    int32_t     wsized2, warp;
+    int32_t     wsized2, start, bufPos;
+    const DISKIN2_KERNEL *kern;
+    DISKIN2_SINC sinc;
     MYFLT  *aOut = (MYFLT *)p->aOut_buf; /* needs to be allocated */
 
     if (UNLIKELY(p->fdch.fd == NULL) ) goto file_error;
@@ -1429,99 +1922,36 @@ int32_t diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p)
       }
       break;
     default:                  /* ---- sinc interpolation ---- */
+      kern = (csound->oparms->diskin_sinc_tables ?
+              diskin2_kernel(csound, &(p->kernel), p->winSize, p->winFact,
+                             p->pos_frac_inc) : NULL);
+      if (kern == NULL)
+        diskin2_sinc_init(&sinc, p->winSize, p->winFact, p->pos_frac_inc);
       wsized2 = p->winSize >> 1;
-      nn = POS_FRAC_SCALE + (POS_FRAC_SCALE >> 12);
-      if (p->pos_frac_inc > (int64_t) nn ||
-          p->pos_frac_inc < (int64_t) (-nn)) {
-        warp = 1;                     /* enable warp */
-        onedwarp = (p->pos_frac_inc >= (int64_t) 0 ?
-                    ((MYFLT)nn / (MYFLT)p->pos_frac_inc)
-                    : ((MYFLT)(-nn) / (MYFLT)p->pos_frac_inc));
-        pidwarp_d = PI * (double)onedwarp;
-        c = 2.0 * cos(pidwarp_d) - 2.0;
-        /* correct window for kwarp */
-        x = v = (double)wsized2; x *= x; x = 1.0 / x;
-        v *= (double)onedwarp; v -= (double)((int32_t)v) + 0.5; v *= 4.0 * v;
-        winFact = (MYFLT)(((double)p->winFact - x) * v + x);
-      }
-      else {
-        warp = 0;
-        onedwarp = FL(0.0);
-        pidwarp_d = c = 0.0;
-        winFact = p->winFact;
-      }
       for (nn = 0; nn < nsmps; nn++) {
-        frac_d = (double)((int32_t)(p->pos_frac & (int64_t)POS_FRAC_MASK))
-          * (1.0 / (double)POS_FRAC_SCALE);
-        ndx += (int32_t)(1 - wsized2);
-        d = (double)(1 - wsized2) - frac_d;
-        if (warp) {                           /* ---- warp enabled ---- */
-          init_sine_gen((1.0 / PI), pidwarp_d, (pidwarp_d * d), c, &x, &v);
-          /* samples -(window size / 2 - 1) to -1 */
-          i = wsized2 - 1;
-          do {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-            diskin2_get_sample_array(csound, p, ndx, nn, a1);
-            ndx++;
-            d += 1.0; v += c * x; x += v;
-          } while (--i);
-          /* sample 0 */
-          /* avoid division by zero */
-          if (UNLIKELY(frac_d < 0.00003)) {
-            a1 = onedwarp;
-          }
-          else {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-          }
-          diskin2_get_sample_array(csound, p, ndx, nn, a1);
-          ndx++;
-          d += 1.0; v += c * x; x += v;
-          /* sample 1 */
-          /* avoid division by zero */
-          if (UNLIKELY(frac_d > 0.99997)) {
-            a1 = onedwarp;
-          }
-          else {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-          }
-          diskin2_get_sample_array(csound, p, ndx, nn, a1);
-          ndx++;
-          d += 1.0; v += c * x; x += v;
-          /* samples 2 to (window size / 2) */
-          i = wsized2 - 1;
-          do {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-            diskin2_get_sample_array(csound, p, ndx, nn, a1);
-            ndx++;
-            d += 1.0; v += c * x; x += v;
-          } while (--i);
+        start = ndx + 1 - wsized2;
+        if (kern == NULL) {
+          i = diskin2_sinc_direct(&sinc, p->winSize, p->pos_frac, w);
+          if (i >= 0)                 /* on a sample */
+            diskin2_get_sample_array(csound, p, start + i, nn, FL(1.0));
+          else
+            for (i = 0; i < p->winSize; i++)
+              diskin2_get_sample_array(csound, p, start + i, nn, w[i]);
+          diskin2_file_pos_inc_array(p, &ndx);
+          continue;
         }
-        else {                                /* ---- warp disabled ---- */
-          /* avoid division by zero */
-          if (frac_d < 0.00001 || frac_d > 0.99999) {
-            ndx += (int32_t) (wsized2 - (frac_d < 0.5 ? 1 : 0));
-            diskin2_get_sample_array(csound, p, ndx, nn, FL(1.0));
-          }
-          else {
-            a0 = (MYFLT)(sin(PI * frac_d) / PI);
-            i = wsized2;
-            do {
-              a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-              a1 = a0 * a1 * a1 / (MYFLT)d;
-              diskin2_get_sample_array(csound, p, ndx, nn, a1);
-              d += 1.0;
-              ndx++;
-              a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-              a1 = -(a0 * a1 * a1 / (MYFLT)d);
-              diskin2_get_sample_array(csound, p, ndx, nn, a1);
-              d += 1.0;
-              ndx++;
-            } while (--i);
-          }
+        diskin2_sinc_weights(kern, (int32_t) (p->pos_frac &
+                                              (int64_t) POS_FRAC_MASK), w);
+        bufPos = start - p->bufStartPos;
+        if (DISKIN2_WINDOW_IN_BUFFER(p, start, bufPos)) {
+          diskin2_sinc_dot(w, &p->buf[bufPos * chans], p->winSize,
+                           chans, s);
+          for (chn = 0; chn < chans; chn++)
+            aOut[nn * chans + chn] += s[chn];
+        }
+        else {                        /* across buffers or the file end */
+          for (i = 0; i < p->winSize; i++)
+            diskin2_get_sample_array(csound, p, start + i, nn, w[i]);
         }
         /* update file position */
         diskin2_file_pos_inc_array(p, &ndx);
@@ -1661,6 +2091,15 @@ static int32_t diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p,
     }
     /* set file parameters from header info */
     p->fileLength = (int32_t) sfinfo.frames;
+    /* read a FLAC file from its decoded frames, with --decode-cache, */
+    /* once there are any, otherwise share the pages of the file      */
+    csound->ReleaseDecodedSoundFile(csound, p->pcm);
+    p->pcm = diskin2_decoded(csound, fd, sfinfo.format, p->nChannels,
+                             p->fileLength);
+    diskin2_file_close(csound, &(p->cfile));
+    if (p->pcm == NULL)
+      p->cfile = diskin2_file_open(csound, fd, sfinfo.format, p->nChannels,
+                                   p->fileLength);
     p->warpScale = 1.0;
     if (MYFLT2LONG(CS_ESR) != sfinfo.samplerate) {
       if (LIKELY(p->winSize != 1)) {
@@ -1688,6 +2127,9 @@ static int32_t diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p,
     }
     p->pos_frac_inc = (int64_t)0;
     p->prv_kTranspose = FL(0.0);
+    diskin2_kernel_prepare(csound, &(p->kernel), p->winSize, p->winFact,
+                           (int64_t) ((double) *(p->kTranspose) *
+                                      p->warpScale * (double) POS_FRAC_SCALE));
     /* allocate and initialise buffers */
     p->bufSize = diskin2_calc_buffer_size_array(p, MYFLT2LONG(p->BufSize));
     n = 2 * p->bufSize * p->nChannels * (int32_t)sizeof(MYFLT);
@@ -1806,10 +2248,11 @@ int32_t diskin2_perf_synchronous_array(CSOUND *csound, DISKIN2_ARRAY *p)
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     int32_t nsmps = CS_KSMPS, ksmps = CS_KSMPS;
     int32_t chn, i, nn;
-    double  d, frac_d, x, c, v, pidwarp_d;
-    MYFLT   frac, a0, a1, a2, a3, onedwarp, winFact;
+    MYFLT   frac, a0, a1, a2, a3, w[1024], s[DISKIN2_MAXCHN];
     int32_t   ndx;
-    int32_t     wsized2, warp;
+    int32_t     wsized2, start, bufPos;
+    const DISKIN2_KERNEL *kern;
+    DISKIN2_SINC sinc;
     MYFLT *aOut = (MYFLT *) p->aOut->data;
 
 
@@ -1878,99 +2321,36 @@ int32_t diskin2_perf_synchronous_array(CSOUND *csound, DISKIN2_ARRAY *p)
       }
       break;
     default:                  /* ---- sinc interpolation ---- */
+      kern = (csound->oparms->diskin_sinc_tables ?
+              diskin2_kernel(csound, &(p->kernel), p->winSize, p->winFact,
+                             p->pos_frac_inc) : NULL);
+      if (kern == NULL)
+        diskin2_sinc_init(&sinc, p->winSize, p->winFact, p->pos_frac_inc);
       wsized2 = p->winSize >> 1;
-      nn = POS_FRAC_SCALE + (POS_FRAC_SCALE >> 12);
-      if (p->pos_frac_inc > (int64_t) nn ||
-          p->pos_frac_inc < (int64_t) (-nn)) {
-        warp = 1;                     /* enable warp */
-        onedwarp = (p->pos_frac_inc >= (int64_t) 0 ?
-                    ((MYFLT)nn / (MYFLT)p->pos_frac_inc)
-                    : ((MYFLT)(-nn) / (MYFLT)p->pos_frac_inc));
-        pidwarp_d = PI * (double)onedwarp;
-        c = 2.0 * cos(pidwarp_d) - 2.0;
-        /* correct window for kwarp */
-        x = v = (double)wsized2; x *= x; x = 1.0 / x;
-        v *= (double)onedwarp; v -= (double)((int32_t)v) + 0.5; v *= 4.0 * v;
-        winFact = (MYFLT)(((double)p->winFact - x) * v + x);
-      }
-      else {
-        warp = 0;
-        onedwarp = FL(0.0);
-        pidwarp_d = c = 0.0;
-        winFact = p->winFact;
-      }
       for (nn = offset; nn < nsmps; nn++) {
-        frac_d = (double)((int32_t)(p->pos_frac & (int64_t)POS_FRAC_MASK))
-          * (1.0 / (double)POS_FRAC_SCALE);
-        ndx += (int32_t)(1 - wsized2);
-        d = (double)(1 - wsized2) - frac_d;
-        if (warp) {                           /* ---- warp enabled ---- */
-          init_sine_gen((1.0 / PI), pidwarp_d, (pidwarp_d * d), c, &x, &v);
-          /* samples -(window size / 2 - 1) to -1 */
-          i = wsized2 - 1;
-          do {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-            diskin2_get_sample_array(csound, p, ndx, nn, a1);
-            ndx++;
-            d += 1.0; v += c * x; x += v;
-          } while (--i);
-          /* sample 0 */
-          /* avoid division by zero */
-          if (UNLIKELY(frac_d < 0.00003)) {
-            a1 = onedwarp;
-          }
-          else {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-          }
-          diskin2_get_sample_array(csound, p, ndx, nn, a1);
-          ndx++;
-          d += 1.0; v += c * x; x += v;
-          /* sample 1 */
-          /* avoid division by zero */
-          if (UNLIKELY(frac_d > 0.99997)) {
-            a1 = onedwarp;
-          }
-          else {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-          }
-          diskin2_get_sample_array(csound, p, ndx, nn, a1);
-          ndx++;
-          d += 1.0; v += c * x; x += v;
-          /* samples 2 to (window size / 2) */
-          i = wsized2 - 1;
-          do {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-            diskin2_get_sample_array(csound, p, ndx, nn, a1);
-            ndx++;
-            d += 1.0; v += c * x; x += v;
-          } while (--i);
+        start = ndx + 1 - wsized2;
+        if (kern == NULL) {
+          i = diskin2_sinc_direct(&sinc, p->winSize, p->pos_frac, w);
+          if (i >= 0)                 /* on a sample */
+            diskin2_get_sample_array(csound, p, start + i, nn, FL(1.0));
+          else
+            for (i = 0; i < p->winSize; i++)
+              diskin2_get_sample_array(csound, p, start + i, nn, w[i]);
+          diskin2_file_pos_inc_array(p, &ndx);
+          continue;
         }
-        else {                                /* ---- warp disabled ---- */
-          /* avoid division by zero */
-          if (frac_d < 0.00001 || frac_d > 0.99999) {
-            ndx += (int32_t) (wsized2 - (frac_d < 0.5 ? 1 : 0));
-            diskin2_get_sample_array(csound, p, ndx, nn, FL(1.0));
-          }
-          else {
-            a0 = (MYFLT)(sin(PI * frac_d) / PI);
-            i = wsized2;
-            do {
-              a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-              a1 = a0 * a1 * a1 / (MYFLT)d;
-              diskin2_get_sample_array(csound, p, ndx, nn, a1);
-              d += 1.0;
-              ndx++;
-              a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-              a1 = -(a0 * a1 * a1 / (MYFLT)d);
-              diskin2_get_sample_array(csound, p, ndx, nn, a1);
-              d += 1.0;
-              ndx++;
-            } while (--i);
-          }
+        diskin2_sinc_weights(kern, (int32_t) (p->pos_frac &
+                                              (int64_t) POS_FRAC_MASK), w);
+        bufPos = start - p->bufStartPos;
+        if (DISKIN2_WINDOW_IN_BUFFER(p, start, bufPos)) {
+          diskin2_sinc_dot(w, &p->buf[bufPos * p->nChannels], p->winSize,
+                           p->nChannels, s);
+          for (chn = 0; chn < p->nChannels; chn++)
+            aOut[chn * ksmps + nn] += s[chn];
+        }
+        else {                        /* across buffers or the file end */
+          for (i = 0; i < p->winSize; i++)
+            diskin2_get_sample_array(csound, p, start + i, nn, w[i]);
         }
         /* update file position */
         diskin2_file_pos_inc_array(p, &ndx);
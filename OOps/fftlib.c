@@ -3376,6 +3376,37 @@ void pffft_execute(CSOUND_FFT_SETUP *setup,
     sig[i] = buf[i]/s;
 }
 
+#ifdef USE_DOUBLE
+/* double precision pffft: no conversion, and sizes of the form
+   2^a 3^b 5^c as well as powers of two */
+static
+void pffftd_execute(CSOUND_FFT_SETUP *setup,
+                    MYFLT *sig) {
+  int32_t i, N = setup->N;
+  MYFLT *buf = setup->buffer, *work = setup->buffer + N;
+  uintptr_t align = sizeof(MYFLT)*pffftd_simd_size() - 1;
+  if(!setup->p2 && setup->d == PFFFT_BACKWARD)
+    sig[1] = sig[N];   /* Nyquist is at the end in the np2 layout */
+  if(((uintptr_t) sig & align) == 0)
+    buf = sig;
+  else
+    memcpy(buf, sig, sizeof(MYFLT)*N);
+  pffftd_transform_ordered((PFFFTD_Setup *) setup->setup,
+                           buf, buf, work, setup->d);
+  if(setup->d == PFFFT_BACKWARD) {
+    MYFLT s = FL(1.0)/N;
+    for(i=0;i<N;i++)
+      sig[i] = buf[i]*s;
+  }
+  else if(buf != sig)
+    memcpy(sig, buf, sizeof(MYFLT)*N);
+  if(!setup->p2 && setup->d == PFFFT_FORWARD) {
+    sig[N] = sig[1];
+    sig[1] = sig[N+1] = FL(0.0);
+  }
+}
+#endif
+
 #if defined(__MACH__)
 /* vDSP FFT implementation */
 #include <Accelerate/Accelerate.h>
@@ -3424,33 +3455,172 @@ void *align_alloc(CSOUND *csound, size_t nb_bytes){
   return p;
 }
 
-int32_t setupDispose(CSOUND *csound, void *pp){
-  IGN(csound);
-  CSOUND_FFT_SETUP *setup =(CSOUND_FFT_SETUP *) pp;
-  switch(setup->lib){
+/*
+  FFT plan cache.
+  Plans (pffft and vDSP twiddle tables) do not depend on direction
+  and are never written after creation, so one plan per (size, library)
+  is shared by every setup in the engine, and destroyed on reset.
+  Setups themselves only hold a plan pointer, direction and a scratch
+  buffer, so two callers must never share one. A setup asked for with
+  csoundRealFFT2SetupFor() or csoundDCTSetupFor() belongs to the opcode
+  passed in: when the instrument instance is recycled for a new note,
+  that opcode gets the same setup back, and its deinit hands it back
+  with csoundReleaseFFTSetups(). Setups handed back go to a pool keyed
+  by (size, direction, library), so the next note asking for the same
+  transform takes one, scratch and all, instead of allocating. Setups
+  from csoundRealFFT2Setup() are always new and live until reset.
+  The cache lock is a spinlock, so nothing is allocated while it is
+  held: new plans and setups are made outside and linked in under it.
+*/
+
+typedef struct fft_plan {
+  void    *setup;
+  int32_t N, lib;
+  struct fft_plan *nxt;
+} FFT_PLAN;
+
+typedef struct fft_inst {
+  CSOUND_FFT_SETUP setup;       /* first, so a setup pointer is its FFT_INST */
+  const OPDS *owner;
+  int32_t lib, dir;             /* library and direction requested */
+  void    *mem;                 /* block holding setup.buffer */
+  struct fft_inst *nxt;
+} FFT_INST;
+
+#define FFT_CACHE_BUCKETS 64
+
+typedef struct {
+  spin_lock_t lock;
+  FFT_PLAN *plans;
+  FFT_INST *insts[FFT_CACHE_BUCKETS];   /* in use, by owner */
+  FFT_INST *idle[FFT_CACHE_BUCKETS];    /* handed back, by transform */
+} FFT_CACHE;
+
+static void fft_plan_destroy(void *setup, int32_t lib){
+  if(setup == NULL) return;
+  switch(lib){
 #if defined(__MACH__)
   case VDSP_LIB:
 #ifdef USE_DOUBLE
-     vDSP_destroy_fftsetupD((FFTSetupD)
+    vDSP_destroy_fftsetupD((FFTSetupD) setup);
 #else
-     vDSP_destroy_fftsetup((FFTSetup)
+    vDSP_destroy_fftsetup((FFTSetup) setup);
 #endif
-                           setup->setup);
     break;
 #endif
   case PFFT_LIB:
-    pffft_destroy_setup((PFFFT_Setup *)setup->setup);
+    pffft_destroy_setup((PFFFT_Setup *) setup);
+    break;
+#ifdef USE_DOUBLE
+  case PFFTD_LIB:
+    pffftd_destroy_setup((PFFFTD_Setup *) setup);
     break;
+#endif
+  }
+}
+
+static int32_t fft_cache_destroy(CSOUND *csound, void *pp){
+  FFT_CACHE *cache = (FFT_CACHE *) pp;
+  FFT_PLAN *plan = cache->plans;
+  IGN(csound);
+  while(plan != NULL) {
+    fft_plan_destroy(plan->setup, plan->lib);
+    plan = plan->nxt;
   }
+  cache->plans = NULL;
   return OK;
 }
 
-void *csoundRealFFT2Setup(CSOUND *csound,
-                         int32_t FFTsize,
-                         int32_t d){
+static FFT_CACHE *fft_cache(CSOUND *csound){
+  FFT_CACHE *cache =
+    (FFT_CACHE *) csound->QueryGlobalVariable(csound, "::FFT_CACHE::");
+  if(cache == NULL) {
+    csound->CreateGlobalVariable(csound, "::FFT_CACHE::", sizeof(FFT_CACHE));
+    cache = (FFT_CACHE *) csound->QueryGlobalVariable(csound, "::FFT_CACHE::");
+    csoundSpinLockInit(&cache->lock);
+    csound->RegisterResetCallback(csound, (void*) cache, fft_cache_destroy);
+  }
+  return cache;
+}
+
+/* called with the cache locked */
+static FFT_PLAN *fft_plan_find(FFT_CACHE *cache, int32_t N, int32_t lib){
+  FFT_PLAN *plan;
+  for(plan = cache->plans; plan != NULL; plan = plan->nxt)
+    if(plan->N == N && plan->lib == lib)
+      return plan;
+  return NULL;
+}
+
+static void *fft_plan(CSOUND *csound, FFT_CACHE *cache,
+                      int32_t N, int32_t lib){
+  FFT_PLAN *plan, *other;
+  csoundSpinLock(&cache->lock);
+  plan = fft_plan_find(cache, N, lib);
+  csoundSpinUnLock(&cache->lock);
+  if(plan != NULL)
+    return plan->setup;
+  plan = (FFT_PLAN *) csound->Calloc(csound, sizeof(FFT_PLAN));
+  plan->N = N;
+  plan->lib = lib;
+  switch(lib){
+#if defined(__MACH__)
+  case VDSP_LIB:
+    plan->setup = (void *)
+#ifdef USE_DOUBLE
+      vDSP_create_fftsetupD(ConvertFFTSize(csound, N),kFFTRadix2);
+#else
+      vDSP_create_fftsetup(ConvertFFTSize(csound, N),kFFTRadix2);
+#endif
+    break;
+#endif
+  case PFFT_LIB:
+    plan->setup = (void *) pffft_new_setup(N,PFFFT_REAL);
+    break;
+#ifdef USE_DOUBLE
+  case PFFTD_LIB:
+    /* other sizes fall back to the FFTLIB code */
+    if(N % (2*pffftd_simd_size()*pffftd_simd_size()) == 0)
+      plan->setup = (void *) pffftd_new_setup(N,PFFFT_REAL);
+    break;
+#endif
+  }
+  csoundSpinLock(&cache->lock);
+  /* another thread may have made the same plan meanwhile */
+  other = fft_plan_find(cache, N, lib);
+  if(other == NULL) {
+    plan->nxt = cache->plans;
+    cache->plans = plan;
+  }
+  csoundSpinUnLock(&cache->lock);
+  if(other != NULL) {
+    fft_plan_destroy(plan->setup, lib);
+    csound->Free(csound, plan);
+    plan = other;
+  }
+  return plan->setup;
+}
+
+static FFT_INST **fft_bucket(FFT_CACHE *cache, const OPDS *owner){
+  return &cache->insts[((uintptr_t) owner >> 4) % FFT_CACHE_BUCKETS];
+}
+
+static FFT_INST **fft_idle_bucket(FFT_CACHE *cache, int32_t N,
+                                  int32_t d, int32_t lib){
+  return &cache->idle[((uint32_t) N * 3 + d * 7 + lib) % FFT_CACHE_BUCKETS];
+}
+
+static void *fft_setup(CSOUND *csound, int32_t FFTsize, int32_t d,
+                       const OPDS *owner){
   CSOUND_FFT_SETUP *setup;
+  FFT_CACHE *cache;
+  FFT_INST *inst, **pp;
   int32_t lib = csound->oparms->fft_lib;
-  if(lib == PFFT_LIB && FFTsize <= 16){
+#ifndef USE_DOUBLE
+  if(lib == PFFTD_LIB)
+    lib = PFFT_LIB;      /* nothing to gain in single precision */
+#endif
+  if((lib == PFFT_LIB || lib == PFFTD_LIB) && FFTsize <= 16){
     csound->Warning(csound,
       "FFTsize %d \n"
       "Cannot use PFFT with sizes <= 16\n"
@@ -3458,20 +3628,42 @@ void *csoundRealFFT2Setup(CSOUND *csound,
         FFTsize);
     lib = 0;
   }
-  setup = (CSOUND_FFT_SETUP *)
-    csound->Calloc(csound, sizeof(CSOUND_FFT_SETUP));
+  cache = fft_cache(csound);
+  if(owner != NULL) {
+    csoundSpinLock(&cache->lock);
+    for(inst = *fft_bucket(cache, owner); inst != NULL; inst = inst->nxt)
+      if(inst->owner == owner && inst->setup.N == FFTsize &&
+         inst->lib == lib && inst->dir == d)
+        break;
+    if(inst == NULL) {
+      /* take one handed back by an earlier note */
+      for(pp = fft_idle_bucket(cache, FFTsize, d, lib);
+          (inst = *pp) != NULL; pp = &inst->nxt)
+        if(inst->setup.N == FFTsize && inst->lib == lib && inst->dir == d) {
+          *pp = inst->nxt;
+          inst->owner = owner;
+          pp = fft_bucket(cache, owner);
+          inst->nxt = *pp;
+          *pp = inst;
+          break;
+        }
+    }
+    csoundSpinUnLock(&cache->lock);
+    if(inst != NULL)
+      return (void *) &inst->setup;
+  }
+  inst = (FFT_INST *) csound->Calloc(csound, sizeof(FFT_INST));
+  inst->owner = owner;
+  inst->lib = lib;
+  inst->dir = d;
+  setup = &inst->setup;
   setup->N = FFTsize;
   setup->p2 = IS_POW_TWO(FFTsize);
   switch(lib){
 #if defined(__MACH__)
   case VDSP_LIB:
     setup->M = ConvertFFTSize(csound, FFTsize);
-    setup->setup = (void *)
-#ifdef USE_DOUBLE
-      vDSP_create_fftsetupD(setup->M,kFFTRadix2);
-#else
-      vDSP_create_fftsetup(setup->M,kFFTRadix2);
-#endif
+    setup->setup = fft_plan(csound, cache, FFTsize, lib);
       setup->d = (d ==  FFT_FWD ?
                 kFFTDirection_Forward :
                 kFFTDirection_Inverse);
@@ -3479,8 +3671,10 @@ void *csoundRealFFT2Setup(CSOUND *csound,
     break;
 #endif
   case PFFT_LIB:
-    setup->setup = (void *)
-      pffft_new_setup(FFTsize,PFFFT_REAL);
+#ifdef USE_DOUBLE
+  case PFFTD_LIB:
+#endif
+    setup->setup = fft_plan(csound, cache, FFTsize, lib);
     setup->d = (d ==  FFT_FWD ?
                 PFFFT_FORWARD :
                 PFFFT_BACKWARD);
@@ -3489,20 +3683,66 @@ void *csoundRealFFT2Setup(CSOUND *csound,
   default:
     setup->lib = 0;
     setup->d = d;
-    return (void *) setup;
   }
-  setup->buffer = (MYFLT *) align_alloc(csound, sizeof(MYFLT)*FFTsize);
-  csound->RegisterResetCallback(csound, (void*) setup,
-                                (int32_t (*)(CSOUND *, void *))
-                                setupDispose);
+  /* pffftd also takes its work area from here */
+  if(setup->lib != 0) {
+    setup->buffer = (MYFLT *)
+      align_alloc(csound, sizeof(MYFLT)*FFTsize*(lib == PFFTD_LIB ? 2 : 1));
+    if(setup->buffer != NULL)
+      inst->mem = *((void **) setup->buffer - 1);
+  }
+  if(owner != NULL) {
+    csoundSpinLock(&cache->lock);
+    pp = fft_bucket(cache, owner);
+    inst->nxt = *pp;
+    *pp = inst;
+    csoundSpinUnLock(&cache->lock);
+  }
   return (void *) setup;
 }
- 
+
+void *csoundRealFFT2Setup(CSOUND *csound,
+                         int32_t FFTsize,
+                         int32_t d){
+  return fft_setup(csound, FFTsize, d, NULL);
+}
+
+void *csoundRealFFT2SetupFor(CSOUND *csound,
+                             int32_t FFTsize,
+                             int32_t d, OPDS *owner){
+  return fft_setup(csound, FFTsize, d, owner);
+}
+
+void csoundReleaseFFTSetups(CSOUND *csound, OPDS *owner){
+  FFT_CACHE *cache = fft_cache(csound);
+  FFT_INST *inst, **pp, **idle;
+  if(owner == NULL) return;
+  csoundSpinLock(&cache->lock);
+  pp = fft_bucket(cache, owner);
+  while((inst = *pp) != NULL) {
+    if(inst->owner == owner) {
+      *pp = inst->nxt;
+      inst->owner = NULL;
+      idle = fft_idle_bucket(cache, inst->setup.N, inst->dir, inst->lib);
+      inst->nxt = *idle;
+      *idle = inst;
+    }
+    else pp = &inst->nxt;
+  }
+  csoundSpinUnLock(&cache->lock);
+}
+
 void csoundRealFFT2(CSOUND *csound,
                      void *p, MYFLT *sig){
   CSOUND_FFT_SETUP *setup =
         (CSOUND_FFT_SETUP *) p;
-  
+
+#ifdef USE_DOUBLE
+  if(setup->lib == PFFTD_LIB && setup->setup != NULL) {
+    pffftd_execute(setup,sig);
+    return;
+  }
+#endif
   if(!setup->p2) {
      setup->d == FFT_FWD ?
       csoundRealFFTnp2(csound,
@@ -3533,19 +3773,29 @@ void csoundRealFFT2(CSOUND *csound,
 }
 
 
-void *csoundDCTSetup(CSOUND *csound,
-                     int32_t FFTsize, int32_t d){
+static void *dct_setup(CSOUND *csound,
+                       int32_t FFTsize, int32_t d, OPDS *owner){
  CSOUND_FFT_SETUP *setup;
  setup = (CSOUND_FFT_SETUP *)
-   csoundRealFFT2Setup(csound,
-                       FFTsize*4,d);
- if(setup->lib == 0){
+   fft_setup(csound, FFTsize*4, d, owner);
+ if(setup->lib == 0 && setup->buffer == NULL){
   setup->buffer = (MYFLT *)
     csound->Calloc(csound, sizeof(MYFLT)*setup->N);
+  ((FFT_INST *) setup)->mem = setup->buffer;
  }
  return setup;
 }
 
+void *csoundDCTSetup(CSOUND *csound,
+                     int32_t FFTsize, int32_t d){
+ return dct_setup(csound, FFTsize, d, NULL);
+}
+
+void *csoundDCTSetupFor(CSOUND *csound,
+                        int32_t FFTsize, int32_t d, OPDS *owner){
+ return dct_setup(csound, FFTsize, d, owner);
+}
+
 
 void pffft_DCT_execute(CSOUND *csound,
                      void *p, MYFLT *sig){
@@ -3652,6 +3902,26 @@ void vDSP_DCT_execute(CSOUND *csound,
 }
 #endif
 
+/* in-place real FFT of the DCT buffer, in the direction of the setup */
+static void DCT_rfft(CSOUND *csound, CSOUND_FFT_SETUP *setup, MYFLT *buf){
+  int32_t N = setup->N;
+#ifdef USE_DOUBLE
+  if(setup->lib == PFFTD_LIB && setup->setup != NULL) {
+    int32_t i;
+    pffftd_transform_ordered((PFFFTD_Setup *) setup->setup,
+                             buf, buf, buf + N, setup->d);
+    if(setup->d == PFFFT_BACKWARD)
+      for(i=0;i<N;i++)
+        buf[i] /= N;
+    return;
+  }
+#endif
+  if(setup->d == FFT_FWD)
+    csoundRealFFT(csound,buf,N);
+  else
+    csoundInverseRealFFT(csound,buf,N);
+}
+
 void DCT_execute(CSOUND *csound,
                      void *p, MYFLT *sig){
   CSOUND_FFT_SETUP *setup =
@@ -3667,7 +3937,7 @@ void DCT_execute(CSOUND *csound,
     buffer[i] = FL(0.0);
     buffer[i+1] = sig[j];
   }
-  csoundRealFFT(csound,buffer,N);
+  DCT_rfft(csound,setup,buffer);
   for(i=j=0; i < N/2; i+=2, j++){
     sig[j] = buffer[i];
   }
@@ -3683,7 +3953,7 @@ void DCT_execute(CSOUND *csound,
     buffer[i] = -sig[j];
     buffer[i+1] = FL(0.0);
   }
-  csoundInverseRealFFT(csound,buffer,N);
+  DCT_rfft(csound,setup,buffer);
   for(i=j=0; i < N/2; i+=2, j++){
     sig[j] = buffer[i+1];
   }
@@ -3703,6 +3973,11 @@ CSOUND_FFT_SETUP *setup =
   case PFFT_LIB:
     pffft_DCT_execute(csound,setup,sig);
     break;
+#ifdef USE_DOUBLE
+  case PFFTD_LIB:
+    DCT_execute(csound,setup,sig);
+    break;
+#endif
   default:
     DCT_execute(csound,setup,sig);
     setup->lib = 0;
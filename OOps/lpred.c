@@ -938,7 +938,7 @@ int32_t lpcpvs_init(CSOUND *csound, LPCPVS *p) {
   p->fout->wintype = PVS_WIN_HANN;
   p->fout->format = PVS_AMP_FREQ;
 
-  p->fftsetup = csound->RealFFTSetup(csound,p->N,FFT_FWD);
+  p->fftsetup = csound->RealFFTSetupFor(csound,p->N,FFT_FWD,&p->h);
 
   Nbytes = (N+2)*sizeof(float);
   if(p->fout->frame.auxp == NULL || Nbytes > p->fout->frame.size)
@@ -949,6 +949,11 @@ int32_t lpcpvs_init(CSOUND *csound, LPCPVS *p) {
   return OK;
 }
 
+int32_t lpcpvs_deinit(CSOUND *csound, LPCPVS *p) {
+  csound->ReleaseFFTSetups(csound, &p->h);
+  return OK;
+}
+
 int32_t lpcpvs(CSOUND *csound, LPCPVS *p){
   MYFLT *buf = (MYFLT *) p->buf.auxp;
   MYFLT *cbuf = (MYFLT *) p->cbuf.auxp;
@@ -28,6 +28,7 @@
 
 #include "csoundCore.h"
 #include "pstream.h"
+#include "pvsplit.h"
 #include "pvfileio.h"
 
 #ifdef _DEBUG
@@ -827,6 +828,7 @@ int32_t pvsftr(CSOUND *csound, PVSFTR *p)
         for (i=0;i < nbins;i++)
           fdest[(i*2) + 1] = (float) p->ftablef[i];
       }
+      pvs_split_drop(p->fdest);
       p->lastframe = p->fdest->framecount;
     }
     return OK;
@@ -29,6 +29,8 @@
 #include <math.h>
 #include "csoundCore.h"
 #include "pstream.h"
+#include "pvsplit.h"
+#include "vecops.h"
 
         double  besseli(double x);
 static  void    hamming(MYFLT *win, int32_t winLen, int32_t even);
@@ -94,19 +96,320 @@ static CS_NOINLINE int32_t PVS_CreateWindow(CSOUND *csound, MYFLT *buf,
 }
 
 
+/* The sliding DFT is done for a range of bins, split into parts that
+   worker threads can take on.  Each bin is a recursion of its own on the
+   same input, but its window takes in the two bins either side of it, so
+   a part also keeps its neighbours' bins next to its own, updating them
+   exactly as the neighbour does.  Parts then share only the input and
+   the frame, where each writes its own bins.                          */
+
+#define SDFT_PARTS      16
+#define SDFT_MINBINS    32      /* bins of a part at least */
+
+/* the windows as convolutions in frequency: each bin is w0 times itself,
+   less w1 times the sum of the bins either side and plus w2 times that
+   of the bins two away; e1 and e2 fold the missing neighbours of the
+   end bins back in, edge1 says whether the bins next to them get the
+   same and hack whether bin 1 is the mean of bins 0 and 2 instead    */
+typedef struct {
+    MYFLT   w0, w1, w2, e1, e2;
+    int32_t edge1, hack;
+} SDFT_WIN;
+
+static const SDFT_WIN sdft_rect = {
+    FL(1.0), FL(0.0), FL(0.0), FL(0.0), FL(0.0), 0, 0
+};
+
+static const SDFT_WIN *sdft_window(int32_t wintype)
+{
+    static const SDFT_WIN hamming_w = {
+      FL(0.54), FL(0.23), FL(0.0), FL(0.46), FL(0.0), 0, 0
+    };
+    static const SDFT_WIN hann_w = {
+      FL(0.5), FL(0.25), FL(0.0), FL(0.5), FL(0.0), 0, 0
+    };
+    static const SDFT_WIN blackman_w = {
+      FL(0.42), FL(0.25), FL(0.04), FL(0.5), FL(0.08), 1, 0
+    };
+    static const SDFT_WIN blackman_exact_w = {
+      FL(0.42659071367153912296),
+      FL(0.49656061908856405847)*FL(0.5),
+      FL(0.076848667239896818573)*FL(0.5),
+      FL(0.49656061908856405847), FL(0.076848667239896818573), 1, 0
+    };
+    static const SDFT_WIN nuttallc3_w = {
+      FL(0.375), FL(0.5)*FL(0.5), FL(0.125)*FL(0.5),
+      FL(0.5), FL(0.125), 1, 1
+    };
+    static const SDFT_WIN bharris_3_w = {
+      FL(0.44959), FL(0.49364)*FL(0.5), FL(0.05677)*FL(0.5),
+      FL(0.49364), FL(0.05677), 1, 1
+    };
+    static const SDFT_WIN bharris_min_w = {
+      FL(0.42323), FL(0.4973406)*FL(0.5), FL(0.0782793)*FL(0.5),
+      FL(0.4973406), FL(0.0782793), 1, 1
+    };
+    switch (wintype) {
+    case PVS_WIN_HAMMING:        return &hamming_w;
+    case PVS_WIN_HANN:           return &hann_w;
+    case PVS_WIN_RECT:           return &sdft_rect;
+    case PVS_WIN_BLACKMAN:       return &blackman_w;
+    case PVS_WIN_BLACKMAN_EXACT: return &blackman_exact_w;
+    case PVS_WIN_NUTTALLC3:      return &nuttallc3_w;
+    case PVS_WIN_BHARRIS_3:      return &bharris_3_w;
+    case PVS_WIN_BHARRIS_MIN:    return &bharris_min_w;
+    }
+    return NULL;
+}
+
+struct sdft_workers;
+
+typedef struct {
+    int32_t lo, hi;             /* bins written */
+    int32_t slo, shi;           /* bins kept, two more each side if any */
+    MYFLT   *re, *im;           /* the bins kept, unwindowed */
+    MYFLT   *pre, *pim;         /* the bins written, windowed, a sample ago */
+    MYFLT   *wre, *wim, *y, *x; /* scratch */
+} SDFT_PART;
+
+/* the analysis of one pvsanal, kept at the start of its sdft memory */
+typedef struct sdft_job {
+    CSOUND  *csound;
+    PVSANAL *p;
+    const SDFT_WIN *win;
+    struct sdft_workers *workers;
+    int32_t nparts;
+    SDFT_PART part[SDFT_PARTS];
+    uint32_t offset, nsmps;     /* of this cycle */
+    MYFLT   *dx;                /* change of input at each sample */
+} SDFT_JOB;
+
+typedef struct {
+    struct sdft_workers *w;
+    int32_t part;               /* of each job, the one this thread does */
+    void    *thread;
+} SDFT_THREAD;
+
+/* The worker threads of an engine, which all its sliding analyses share
+   and the first to ask for them starts.  They work for one analysis at a
+   time; one that finds them busy does all its parts itself, which gives
+   the same frames.  They are stopped when the engine is reset.        */
+typedef struct sdft_workers {
+    CSOUND  *csound;
+    void    *lock;              /* held by the analysis they work for */
+    void    *start, *done;      /* barriers of the threads and the caller */
+    int32_t nthreads, quit;
+    SDFT_JOB *job;
+    SDFT_THREAD thread[SDFT_PARTS - 1];
+} SDFT_WORKERS;
+
+/* MYFLTs taken by an array of n, keeping the next one aligned */
+static inline size_t sdft_span(int32_t n)
+{
+    return ((size_t) n + 7) & ~((size_t) 7);
+}
+
+static void sdft_part(SDFT_JOB *job, SDFT_PART *t);
+
+static uintptr_t sdft_thread(void *arg)
+{
+    SDFT_THREAD  *t = (SDFT_THREAD *) arg;
+    SDFT_WORKERS *w = t->w;
+    CSOUND       *csound = w->csound;
+    for (;;) {
+      csound->WaitBarrier(w->start);
+      if (w->quit)
+        break;
+      if (t->part < w->job->nparts)
+        sdft_part(w->job, &w->job->part[t->part]);
+      csound->WaitBarrier(w->done);
+    }
+    return 0;
+}
+
+/* called with the workers locked, or by the reset */
+static void sdft_workers_stop(CSOUND *csound, SDFT_WORKERS *w)
+{
+    int32_t i;
+    if (w->nthreads == 0)
+      return;
+    w->quit = 1;
+    csound->WaitBarrier(w->start);
+    for (i = 0; i < w->nthreads; i++)
+      csound->JoinThread(w->thread[i].thread);
+    csound->DestroyBarrier(w->start);
+    csound->DestroyBarrier(w->done);
+    w->nthreads = w->quit = 0;
+}
+
+static int32_t sdft_workers_destroy(CSOUND *csound, void *pp)
+{
+    SDFT_WORKERS *w = (SDFT_WORKERS *) pp;
+    sdft_workers_stop(csound, w);
+    if (w->lock != NULL)
+      csound->DestroyMutex(w->lock);
+    w->lock = NULL;
+    return OK;
+}
+
+/* the workers of the engine, with n threads at least, or NULL when they
+   cannot be started */
+static SDFT_WORKERS *sdft_workers(CSOUND *csound, int32_t n)
+{
+    SDFT_WORKERS *w =
+      (SDFT_WORKERS *) csound->QueryGlobalVariable(csound, "::SDFT_WORKERS::");
+    int32_t i;
+    if (w == NULL) {
+      csound->CreateGlobalVariable(csound, "::SDFT_WORKERS::",
+                                   sizeof(SDFT_WORKERS));
+      w = (SDFT_WORKERS *) csound->QueryGlobalVariable(csound,
+                                                       "::SDFT_WORKERS::");
+      w->csound = csound;
+      w->lock = csound->Create_Mutex(0);
+      csound->RegisterResetCallback(csound, (void*) w, sdft_workers_destroy);
+    }
+    if (n > SDFT_PARTS - 1)
+      n = SDFT_PARTS - 1;
+    csound->LockMutex(w->lock);
+    if (w->nthreads < n) {
+      sdft_workers_stop(csound, w);
+      w->start = csound->CreateBarrier(n + 1);
+      w->done = csound->CreateBarrier(n + 1);
+      if (UNLIKELY(w->start == NULL || w->done == NULL)) {
+        if (w->start != NULL) csound->DestroyBarrier(w->start);
+        if (w->done != NULL) csound->DestroyBarrier(w->done);
+        csound->UnlockMutex(w->lock);
+        return NULL;
+      }
+      for (i = 0; i < n; i++) {
+        w->thread[i].w = w;
+        w->thread[i].part = i + 1;
+        w->thread[i].thread = csound->CreateThread(sdft_thread, &w->thread[i]);
+      }
+      w->nthreads = n;
+    }
+    csound->UnlockMutex(w->lock);
+    return w;
+}
+
+/* the frames of this cycle, with the workers if they are free */
+static void sdft_run(CSOUND *csound, SDFT_JOB *job)
+{
+    SDFT_WORKERS *w = job->workers;
+    int32_t      i = 1;
+    if (w != NULL && csound->LockMutexNoWait(w->lock) == 0) {
+      w->job = job;
+      csound->WaitBarrier(w->start);
+      sdft_part(job, &job->part[0]);
+      csound->WaitBarrier(w->done);
+      i = w->nthreads + 1;
+      csound->UnlockMutex(w->lock);
+    }
+    else
+      sdft_part(job, &job->part[0]);
+    for ( ; i < job->nparts; i++)
+      sdft_part(job, &job->part[i]);
+}
+
+int32_t pvsanal_deinit(CSOUND *csound, PVSANAL *p)
+{
+    csound->ReleaseFFTSetups(csound, &p->h);
+    return OK;
+}
+
+/* bins lo to hi of NB in nparts parts, the engine's workers doing all but
+   the first, which the caller does itself */
+static int32_t sdft_setup(CSOUND *csound, PVSANAL *p, int32_t lo, int32_t hi,
+                          int32_t nparts)
+{
+    SDFT_JOB  *job;
+    int32_t   NB = p->fsig->NB, i, m;
+    size_t    size;
+    char      *mem;
+
+    if (nparts > (hi - lo) / SDFT_MINBINS)
+      nparts = (hi - lo) / SDFT_MINBINS;
+    if (nparts > SDFT_PARTS)
+      nparts = SDFT_PARTS;
+    if (nparts < 1)
+      nparts = 1;
+    m = ((hi - lo) / nparts) & ~7;
+    size = sdft_span((sizeof(SDFT_JOB) + sizeof(MYFLT) - 1) / sizeof(MYFLT))
+      + sdft_span(CS_KSMPS);
+    for (i = 0; i < nparts; i++) {
+      int32_t plo = lo + i * m, phi = (i == nparts - 1 ? hi : plo + m);
+      int32_t ns = (phi + 2 < NB ? phi + 2 : NB) - (plo > 2 ? plo - 2 : 0);
+      size += 2 * sdft_span(ns) + 6 * sdft_span(phi - plo);
+    }
+    csound->AuxAlloc(csound, size * sizeof(MYFLT), &p->sdft);
+    mem = (char *) p->sdft.auxp;
+    job = (SDFT_JOB *) mem;
+    mem += sdft_span((sizeof(SDFT_JOB) + sizeof(MYFLT) - 1) / sizeof(MYFLT))
+      * sizeof(MYFLT);
+    job->csound = csound;
+    job->p = p;
+    job->win = sdft_window(p->fsig->wintype);
+    if (job->win == NULL)
+      job->win = &sdft_rect;
+    job->nparts = nparts;
+    job->dx = (MYFLT *) mem;
+    mem += sdft_span(CS_KSMPS) * sizeof(MYFLT);
+    for (i = 0; i < nparts; i++) {
+      SDFT_PART *t = &job->part[i];
+      int32_t   j, ns, nw;
+      MYFLT     **arr[6];
+      t->lo = lo + i * m;
+      t->hi = (i == nparts - 1 ? hi : t->lo + m);
+      t->slo = (t->lo > 2 ? t->lo - 2 : 0);
+      t->shi = (t->hi + 2 < NB ? t->hi + 2 : NB);
+      ns = t->shi - t->slo;
+      nw = t->hi - t->lo;
+      t->re = (MYFLT *) mem;
+      mem += sdft_span(ns) * sizeof(MYFLT);
+      t->im = (MYFLT *) mem;
+      mem += sdft_span(ns) * sizeof(MYFLT);
+      arr[0] = &t->pre; arr[1] = &t->pim; arr[2] = &t->wre;
+      arr[3] = &t->wim; arr[4] = &t->y; arr[5] = &t->x;
+      for (j = 0; j < 6; j++) {
+        *arr[j] = (MYFLT *) mem;
+        mem += sdft_span(nw) * sizeof(MYFLT);
+      }
+      /* the phase of a silent bin counts as 0 */
+      for (j = 0; j < nw; j++)
+        t->pre[j] = FL(1.0);
+    }
+    if (nparts > 1) {
+      job->workers = sdft_workers(csound, nparts - 1);
+      if (UNLIKELY(job->workers == NULL))
+        return csound->InitError(csound, Str("pvsanal: could not start "
+                                             "threads\n"));
+    }
+    return OK;
+}
+
 int32_t pvssanalset(CSOUND *csound, PVSANAL *p)
 {
     /* opcode params */
     int32_t N = MYFLT2LRND(*p->winsize);
-    int32_t NB;
+    int32_t NB, lo, hi;
     int32_t i;
     int32_t wintype = MYFLT2LRND(*p->wintype);
 
-    if (N<=0) return csound->InitError(csound, Str("Invalid window size"));
+    if (N<8) return csound->InitError(csound, Str("Invalid window size"));
     /* deal with iinit and iformat later on! */
 
     N = N + N%2;               /* Make N even */
     NB = N/2+1;                 /* Number of bins */
+    lo = MYFLT2LRND(*p->lobin);
+    hi = MYFLT2LRND(*p->hibin);
+    if (lo < 0) lo = 0;
+    if (hi < 0 || hi >= NB) hi = NB - 1;
+    if (UNLIKELY(lo > hi))
+      return csound->InitError(csound, Str("pvsanal: no bins between "
+                                           "ilowbin and ihighbin\n"));
+    if (sdft_window(wintype) == NULL)
+      csound->Warning(csound,
+                      Str("Unknown window type; replaced by rectangular\n"));
 
     /* Need space for NB complex numbers for each of ksmps */
     if (p->fsig->frame.auxp==NULL ||
@@ -118,11 +421,6 @@ int32_t pvssanalset(CSOUND *csound, PVSANAL *p)
         N*sizeof(MYFLT) > (uint32_t)p->input.size)
       csound->AuxAlloc(csound, N*sizeof(MYFLT),&p->input);
     else memset(p->input.auxp, 0, N*sizeof(MYFLT));
-    csound->AuxAlloc(csound, NB * sizeof(double), &p->oldInPhase);
-   if (p->analwinbuf.auxp==NULL ||
-        NB*sizeof(CMPLX) > (uint32_t)p->analwinbuf.size)
-      csound->AuxAlloc(csound, NB*sizeof(CMPLX),&p->analwinbuf);
-    else memset(p->analwinbuf.auxp, 0, NB*sizeof(CMPLX));
     p->inptr = 0;                 /* Pointer in circular buffer */
     p->fsig->NB = p->Ii = NB;
     p->fsig->wintype = wintype;
@@ -156,7 +454,7 @@ int32_t pvssanalset(CSOUND *csound, PVSANAL *p)
 /*       for (i=0; i<NB; i++)  */
 /*         printf("c[%d] = %f   \ts[%d] = %f\n", i, c[i], i, s[i]); */
     }
-    return OK;
+    return sdft_setup(csound, p, lo, hi + 1, MYFLT2LRND(*p->threads));
 }
 
 int32_t pvsanalset(CSOUND *csound, PVSANAL *p)
@@ -262,7 +560,9 @@ int32_t pvsanalset(CSOUND *csound, PVSANAL *p)
     p->fsig->framecount = 1;
     p->fsig->format = PVS_AMP_FREQ;      /* only this, for now */
     p->fsig->sliding = 0;
-    p->setup = csound->RealFFTSetup(csound,N,FFT_FWD);
+    if (csound->oparms->pvs_split)
+      pvs_split_alloc(csound, p->fsig);
+    p->setup = csound->RealFFTSetupFor(csound,N,FFT_FWD,&p->h);
     return OK;
 }
 
@@ -402,6 +702,14 @@ static void generate_frame(CSOUND *csound, PVSANAL *p)
     for (i=0;i < N+2;i++)
       /* *ofp++ = (float)(*fp++); */
       ofp[i] = (float) fp[i];
+    if (pvs_split_has(p->fsig)) {
+      float *amp = pvs_split_arrays(p->fsig);
+      float *fr = amp + pvs_split_stride(N2 + 1);
+      for (i = 0; i <= N2; i++) {
+        amp[i] = (float) fp[2 * i];
+        fr[i] = (float) fp[2 * i + 1];
+      }
+    }
 
     p->nI += p->fsig->overlap;                          /* increment time */
     if (p->nI > (synWinLen + p->fsig->overlap))
@@ -428,6 +736,8 @@ static void anal_tick(CSOUND *csound, PVSANAL *p,MYFLT samp)
     if (p->inptr== p->fsig->overlap) {
       generate_frame(csound, p);
       p->fsig->framecount++;
+      if (pvs_split_has(p->fsig))
+        p->fsig->splitcount = p->fsig->framecount;
       p->inptr = 0;
 
     }
@@ -436,6 +746,11 @@ static void anal_tick(CSOUND *csound, PVSANAL *p,MYFLT samp)
 
 }
 
+/* phases below this are wrapped by rounding to a multiple of 2 pi,
+   which takes adding and subtracting 1.5 * 2^52 */
+#define SDFT_WRAP_MAX   0x1p40
+#define SDFT_SHIFTER    6755399441055744.0
+
 static inline double mod2Pi(double x)
 {
     x = fmod(x,TWOPI);
@@ -449,21 +764,107 @@ static inline double mod2Pi(double x)
       return x;
 }
 
+/* The frames of the samples offset to nsmps for the bins of part t.  For
+   each sample the bins kept take the change of input and turn on by their
+   frequency, those written are windowed, and the difference of their
+   phase from a sample ago, less the turn of the bin itself, is found as
+   the angle of the product of the frame with the last one conjugated
+   and turned back, which needs no unwrapping.                         */
+static void sdft_part(SDFT_JOB *job, SDFT_PART *t)
+{
+    PVSANAL *p = job->p;
+    const SDFT_WIN *win = job->win;
+    const VECMATH *vm = VECMATH_CS(job->csound);
+    int32_t  NB = p->Ii, N = p->fsig->N;
+    int32_t  lo = t->lo, hi = t->hi, slo = t->slo, ns = t->shi - slo;
+    int32_t  nw = hi - lo, j, a, b;
+    const double *c = p->cosine, *s = p->sine;
+    MYFLT    *re = t->re, *im = t->im, *pre = t->pre, *pim = t->pim;
+    MYFLT    *wre = t->wre, *wim = t->wim, *y = t->y, *x = t->x;
+    MYFLT    w0 = win->w0, w1 = win->w1, w2 = win->w2;
+    MYFLT    esr = CS_ESR;
+    uint32_t n;
+
+    /* the bins written whose neighbours are all there */
+    a = (lo > 2 ? lo : 2);
+    b = (hi < NB - 2 ? hi : NB - 2);
+    for (n = job->offset; n < job->nsmps; n++) {
+      CMPLX *ff = (CMPLX *) p->fsig->frame.auxp + n*NB;
+      MYFLT dx = job->dx[n];
+      /* fw is the current frame at this sample */
+      for (j = 0; j < ns; j++) {
+        double ci = c[slo + j], si = s[slo + j];
+        MYFLT  fr = re[j] + dx, fi = im[j];
+        re[j] = ci*fr - si*fi;
+        im[j] = ci*fi + si*fr;
+      }
+      /* window */
+      for (j = a; j < b; j++) {
+        int32_t k = j - slo;
+        wre[j - lo] = (w0*re[k] - w1*(re[k+1] + re[k-1])) +
+          w2*(re[k+2] + re[k-2]);
+        wim[j - lo] = (w0*im[k] - w1*(im[k+1] + im[k-1])) +
+          w2*(im[k+2] + im[k-2]);
+      }
+      if (lo == 0) {
+        wre[0] = w0*re[0] + (-win->e1*re[1] + win->e2*re[2]);
+        wim[0] = w0*im[0];
+      }
+      if (lo <= 1 && hi > 1) {
+        int32_t k = 1 - slo;
+        wre[1 - lo] = w0*re[k] - w1*(re[k+1] + re[k-1]);
+        wim[1 - lo] = w0*im[k] - w1*(im[k+1] + im[k-1]);
+        if (win->edge1)
+          wre[1 - lo] += -win->e1*re[k+1] + win->e2*re[k+2];
+        if (win->hack) {
+          wre[1 - lo] = 0.5 * (re[k+1] + re[k-1]);
+          wim[1 - lo] = 0.5 * (im[k+1] + im[k-1]);
+        }
+      }
+      if (lo <= NB - 2 && hi > NB - 2) {
+        int32_t k = NB - 2 - slo;
+        wre[NB - 2 - lo] = w0*re[k] - w1*(re[k+1] + re[k-1]);
+        wim[NB - 2 - lo] = w0*im[k] - w1*(im[k+1] + im[k-1]);
+        if (win->edge1)
+          wre[NB - 2 - lo] += -win->e1*re[k-1] + win->e2*re[k-2];
+      }
+      if (hi == NB) {
+        int32_t k = NB - 1 - slo;
+        wre[NB - 1 - lo] = w0*re[k] + (-win->e1*re[k-1] + win->e2*re[k-2]);
+        wim[NB - 1 - lo] = w0*im[k];
+      }
+      /* phase difference */
+      for (j = 0; j < nw; j++) {
+        double cj = c[lo + j], sj = s[lo + j];
+        /* a silent bin has phase 0, now as a sample ago */
+        MYFLT  wr = (wre[j] == FL(0.0) && wim[j] == FL(0.0) ? FL(1.0) : wre[j]);
+        MYFLT  dot = wr*pre[j] + wim[j]*pim[j];
+        MYFLT  crs = wim[j]*pre[j] - wr*pim[j];
+        x[j] = dot*cj + crs*sj;
+        y[j] = crs*cj - dot*sj;
+        pre[j] = wr;
+        pim[j] = wim[j];
+      }
+      vm->atan2v(y, y, x, nw);
+      vm->hypotv(x, wre, wim, nw);
+      /* Convert to AMP_FREQ */
+      for (j = 0; j < nw; j++) {
+        ff[lo + j].re = x[j];
+        ff[lo + j].im = esr * ((lo + j) + y[j] * N / TWOPI)/N;
+      }
+    }
+}
+
 int32_t pvssanal(CSOUND *csound, PVSANAL *p)
 {
     MYFLT *ain;
-    int32_t NB = p->Ii, loc;
-    int32_t N = p->fsig->N;
+    int32_t loc;
     MYFLT *data = (MYFLT*)(p->input.auxp);
-    CMPLX *fw = (CMPLX*)(p->analwinbuf.auxp);
-    double *c = p->cosine;
-    double *s = p->sine;
-    double *h = (double*)p->oldInPhase.auxp;
+    SDFT_JOB *job = (SDFT_JOB *) p->sdft.auxp;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t i, nsmps = CS_KSMPS;
-    int32_t wintype = p->fsig->wintype;
-    if (UNLIKELY(data==NULL)) {
+    if (UNLIKELY(data==NULL || job==NULL)) {
       return csound->PerfError(csound,&(p->h),
                                Str("pvsanal: Not Initialised.\n"));
     }
@@ -471,199 +872,13 @@ int32_t pvssanal(CSOUND *csound, PVSANAL *p)
     loc = p->inptr;             /* Circular buffer */
     nsmps -= early;
     for (i=offset; i < nsmps; i++) {
-      MYFLT re, im, dx;
-      CMPLX* ff;
-      int32_t j;
-
-/*       printf("%d: in = %f\n", i, *ain); */
-      dx = *ain - data[loc];    /* Change in sample */
-      data[loc] = *ain++;       /* Remember input sample */
-      /* get the frame for this sample */
-      ff = (CMPLX*)(p->fsig->frame.auxp) + i*NB;
-      /* fw is the current frame at this sample */
-      for (j = 0; j < NB; j++) {
-        double ci = c[j], si = s[j];
-        re = fw[j].re + dx;
-        im = fw[j].im;
-        fw[j].re = ci*re - si*im;
-        fw[j].im = ci*im + si*re;
-      }
+      job->dx[i] = ain[i] - data[loc];    /* Change in sample */
+      data[loc] = ain[i];                 /* Remember input sample */
       loc++; if (UNLIKELY(loc==p->nI)) loc = 0; /* Circular buffer */
-      /* apply window and transfer to ff buffer*/
-      /* Rectang :Fw_t =     F_t                          */
-      /* Hamming :Fw_t = 0.54F_t - 0.23[ F_{t-1}+F_{t+1}] */
-      /* Hamming :Fw_t = 0.5 F_t - 0.25[ F_{t-1}+F_{t+1}] */
-      /* Blackman:Fw_t = 0.42F_t - 0.25[ F_{t-1}+F_{t+1}]+0.04[F_{t-2}+F_{t+2}] */
-      /* Blackman_exact:Fw_t = 0.42659071367153912296F_t
-         - 0.24828030954428202923 [F_{t-1}+F_{t+1}]
-         + 0.038424333619948409286 [F_{t-2}+F_{t+2}]      */
-      /* Nuttall_C3:Fw_t = 0.375  F_t - 0.25[ F_{t-1}+F_{t+1}] +
-                                      0.0625 [F_{t-2}+F_{t+2}] */
-      /* BHarris_3:Fw_t = 0.44959 F_t - 0.24682[ F_{t-1}+F_{t+1}] +
-                                      0.02838 [F_{t-2}+F_{t+2}] */
-      /* BHarris_min:Fw_t = 0.42323 F_t - 0.2486703 [ F_{t-1}+F_{t+1}] +
-                                      0.0391396 [F_{t-2}+F_{t+2}] */
-      switch (wintype) {
-      case PVS_WIN_HAMMING:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.54)*fw[j].re;
-          ff[j].im = FL(0.54)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.23)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.23)*(fw[j+1].im + fw[j-1].im);
-        }
-        ff[0].re -= FL(0.46)*fw[1].re;
-        ff[NB-1].re -= FL(0.46)*fw[NB-2].re;
-        break;
-      case PVS_WIN_HANN:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.5)*fw[j].re;
-          ff[j].im = FL(0.5)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.25)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.25)*(fw[j+1].im + fw[j-1].im);
-        }
-        ff[0].re -= FL(0.5)*fw[1].re;
-        ff[NB-1].re -= FL(0.5)*fw[NB-2].re;
-        break;
-      default:
-        csound->Warning(csound,
-                        Str("Unknown window type; replaced by rectangular\n"));
-        /* FALLTHRU */
-      case PVS_WIN_RECT:
-        memcpy(ff, fw, NB*sizeof(CMPLX));
-        /* for (j=0; j<NB; j++) { */
-        /*   ff[j].re = fw[j].re; */
-        /*   ff[j].im = fw[j].im; */
-        /* } */
-        break;
-      case PVS_WIN_BLACKMAN:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.42)*fw[j].re;
-          ff[j].im = FL(0.42)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.25)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.25)*(fw[j+1].im + fw[j-1].im);
-        }
-        for (j=2; j<NB-2; j++) {
-          ff[j].re += FL(0.04)*(fw[j+2].re + fw[j-2].re);
-          ff[j].im += FL(0.04)*(fw[j+2].im + fw[j-2].im);
-        }
-        ff[0].re    += -FL(0.5)*fw[1].re + FL(0.08)*fw[2].re;
-        ff[NB-1].re += -FL(0.5)*fw[NB-2].re + FL(0.08)*fw[NB-3].re;
-        ff[1].re    += -FL(0.5)*fw[2].re + FL(0.08)*fw[3].re;
-        ff[NB-2].re += -FL(0.5)*fw[NB-3].re + FL(0.08)*fw[NB-4].re;
-        break;
-    case PVS_WIN_BLACKMAN_EXACT:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.42659071367153912296)*fw[j].re;
-          ff[j].im = FL(0.42659071367153912296)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.49656061908856405847)*FL(0.5)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.49656061908856405847)*FL(0.5)*(fw[j+1].im + fw[j-1].im);
-        }
-        for (j=2; j<NB-2; j++) {
-          ff[j].re += FL(0.076848667239896818573)*FL(0.5)*(fw[j+2].re + fw[j-2].re);
-          ff[j].im += FL(0.076848667239896818573)*FL(0.5)*(fw[j+2].im + fw[j-2].im);
-        }
-        ff[0].re    += -FL(0.49656061908856405847) * fw[1].re
-                      + FL(0.076848667239896818573) * fw[2].re;
-        ff[NB-1].re += -FL(0.49656061908856405847) * fw[NB-2].re
-                      + FL(0.076848667239896818573) * fw[NB-3].re;
-        ff[1].re    += -FL(0.49656061908856405847) * fw[2].re
-                      + FL(0.076848667239896818573) * fw[3].re;
-        ff[NB-2].re += -FL(0.49656061908856405847) * fw[NB-3].re
-                      + FL(0.076848667239896818573) * fw[NB-4].re;
-        break;
-      case PVS_WIN_NUTTALLC3:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.375)*fw[j].re;
-          ff[j].im = FL(0.375)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.5)*FL(0.5)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.5)*FL(0.5)*(fw[j+1].im + fw[j-1].im);
-        }
-        for (j=2; j<NB-2; j++) {
-          ff[j].re += FL(0.125)*FL(0.5)*(fw[j+2].re + fw[j-2].re);
-          ff[j].im += FL(0.125)*FL(0.5)*(fw[j+2].im + fw[j-2].im);
-        }
-        ff[0].re    += -FL(0.5) * fw[1].re    + FL(0.125) * fw[2].re;
-        ff[NB-1].re += -FL(0.5) * fw[NB-2].re + FL(0.125) * fw[NB-3].re;
-        ff[1].re    += -FL(0.5) * fw[2].re    + FL(0.125) * fw[3].re;
-        ff[NB-2].re += -FL(0.5) * fw[NB-3].re + FL(0.125) * fw[NB-4].re;
-        ff[1].re = 0.5 * (fw[2].re + fw[0].re); /* HACK???? */
-        ff[1].im = 0.5 * (fw[2].im + fw[0].im);
-        break;
-      case PVS_WIN_BHARRIS_3:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.44959)*fw[j].re;
-          ff[j].im = FL(0.44959)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.49364)*FL(0.5)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.49364)*FL(0.5)*(fw[j+1].im + fw[j-1].im);
-        }
-        for (j=2; j<NB-2; j++) {
-          ff[j].re += FL(0.05677)*FL(0.5)*(fw[j+2].re + fw[j-2].re);
-          ff[j].im += FL(0.05677)*FL(0.5)*(fw[j+2].im + fw[j-2].im);
-        }
-        ff[0].re    += -FL(0.49364) * fw[1].re    + FL(0.05677) * fw[2].re;
-        ff[NB-1].re += -FL(0.49364) * fw[NB-2].re + FL(0.05677) * fw[NB-3].re;
-        ff[1].re    += -FL(0.49364) * fw[2].re    + FL(0.05677) * fw[3].re;
-        ff[NB-2].re += -FL(0.49364) * fw[NB-3].re + FL(0.05677) * fw[NB-4].re;
-        ff[1].re = 0.5 * (fw[2].re + fw[0].re); /* HACK???? */
-        ff[1].im = 0.5 * (fw[2].im + fw[0].im);
-        break;
-      case PVS_WIN_BHARRIS_MIN:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.42323)*fw[j].re;
-          ff[j].im = FL(0.42323)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.4973406)*FL(0.5)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.4973406)*FL(0.5)*(fw[j+1].im + fw[j-1].im);
-        }
-        for (j=2; j<NB-2; j++) {
-          ff[j].re += FL(0.0782793)*FL(0.5)*(fw[j+2].re + fw[j-2].re);
-          ff[j].im += FL(0.0782793)*FL(0.5)*(fw[j+2].im + fw[j-2].im);
-        }
-        ff[0].re    += -FL(0.4973406) * fw[1].re    + FL(0.0782793) * fw[2].re;
-        ff[NB-1].re += -FL(0.4973406) * fw[NB-2].re + FL(0.0782793) * fw[NB-3].re;
-        ff[1].re    += -FL(0.4973406) * fw[2].re    + FL(0.0782793) * fw[3].re;
-        ff[NB-2].re += -FL(0.4973406) * fw[NB-3].re + FL(0.0782793) * fw[NB-4].re;
-        ff[1].re = 0.5 * (fw[2].re + fw[0].re); /* HACK???? */
-        ff[1].im = 0.5 * (fw[2].im + fw[0].im);
-        break;
-      }
-/*       if (i==9) { */
-/*         printf("Frame as Amp/Freq %d\n", i); */
-/*         for (j = 0; j < NB; j++) */
-/*           printf("%d: %f\t%f\n", j, ff[j].re, ff[j].im); */
-/*       } */
-      for (j = 0; j < NB; j++) { /* Convert to AMP_FREQ */
-        double thismag = hypot(ff[j].re, ff[j].im);
-        double phase = atan2(ff[j].im, ff[j].re);
-        double angleDif  = phase -  h[j];
-        h[j] = phase;
-            /*subtract expected phase difference */
-        angleDif -= (double)j * TWOPI/N;
-        angleDif =  mod2Pi(angleDif);
-        angleDif =  angleDif * N /TWOPI;
-        ff[j].re = thismag;
-        ff[j].im = CS_ESR * (j + angleDif)/N;
-      }
-/*       if (i==9) { */
-/*         printf("Frame as Amp/Freq %d\n", i); */
-/*         for (j = 0; j < NB; j++) */
-/*           printf("%d: %f\t%f\n", j, ff[j].re, ff[j].im); */
-/*       } */
     }
-
+    job->offset = offset;
+    job->nsmps = nsmps;
+    sdft_run(csound, job);
     p->inptr = loc;
     return OK;
 }
@@ -735,7 +950,8 @@ int32_t pvsynthset(CSOUND *csound, PVSYNTH *p)
     Lf = Mf = 1 - M%2;
     /* deal with iinit later on! */
     csound->AuxAlloc(csound, overlap * sizeof(MYFLT), &p->overlapbuf);
-    csound->AuxAlloc(csound, (N+2) * sizeof(MYFLT), &p->synbuf);
+    /* with room for split_polar() */
+    csound->AuxAlloc(csound, (N+2+2*nBins) * sizeof(MYFLT), &p->synbuf);
     csound->AuxAlloc(csound, (M+Mf) * sizeof(MYFLT), &p->analwinbuf);
     csound->AuxAlloc(csound, (M+Mf) * sizeof(MYFLT), &p->synwinbuf);
     csound->AuxAlloc(csound, nBins * sizeof(MYFLT), &p->oldOutPhase);
@@ -830,7 +1046,13 @@ int32_t pvsynthset(CSOUND *csound, PVSYNTH *p)
     p->outptr = 0;
     p->nextOut = (MYFLT *) (p->output.auxp);
     p->buflen = buflen;
-    p->setup = csound->RealFFTSetup(csound,N,FFT_INV);
+    p->setup = csound->RealFFTSetupFor(csound,N,FFT_INV,&p->h);
+    return OK;
+}
+
+int32_t pvsynth_deinit(CSOUND *csound, PVSYNTH *p)
+{
+    csound->ReleaseFFTSetups(csound, &p->h);
     return OK;
 }
 
@@ -845,6 +1067,36 @@ static MYFLT synth_tick(CSOUND *csound, PVSYNTH *p)
     return outbuf[p->outptr++];
 }
 
+/* The reconversion of process_frame() for a split frame, a pass over
+   the bins at a time, which leaves the sines and cosines to the engine's
+   vector math functions.  The extra room in synbuf holds them.          */
+static void split_polar(CSOUND *csound, PVSYNTH *p, const float *amp,
+                        MYFLT *syn)
+{
+    int32_t i, NB = p->fsig->N/2 + 1;
+    const float *fr = amp + pvs_split_stride(NB);
+    MYFLT *oldOutPhase = (MYFLT *) (p->oldOutPhase.auxp);
+    MYFLT *c = syn + p->fsig->N + 2, *s = c + NB;
+
+    for (i = 0; i < NB; i++)
+      oldOutPhase[i] += p->TwoPioverR * ((MYFLT) fr[i] - ((MYFLT)i * p->Fexact));
+    oldOutPhase[p->bin_index] = (MYFLT) fmod(oldOutPhase[p->bin_index], TWOPI);
+#ifdef USE_DOUBLE
+    VECMATH_CS(csound)->cosv(c, oldOutPhase, NB);
+    VECMATH_CS(csound)->sinv(s, oldOutPhase, NB);
+#else
+    IGN(csound);
+    for (i = 0; i < NB; i++) {
+      c[i] = (MYFLT) cos((double) oldOutPhase[i]);
+      s[i] = (MYFLT) sin((double) oldOutPhase[i]);
+    }
+#endif
+    for (i = 0; i < NB; i++) {
+      syn[2*i] = (MYFLT) amp[i] * c[i];
+      syn[2*i+1] = (MYFLT) amp[i] * s[i];
+    }
+}
+
 static void process_frame(CSOUND *csound, PVSYNTH *p)
 {
     int32_t i,j,k,ii,NO,NO2;
@@ -856,6 +1108,7 @@ static void process_frame(CSOUND *csound, PVSYNTH *p)
     MYFLT mag,phase,angledif, the_phase;
     int32_t synWinLen = p->fsig->winsize / 2;
     int32_t overlap = p->fsig->overlap;
+    const float *amp;
     /*int32 format = p->fsig->format; */
 
     /* fsigs MUST be corect format, as we offer no mechanism for
@@ -875,46 +1128,50 @@ static void process_frame(CSOUND *csound, PVSYNTH *p)
        This automatically incorporates the proper phase scaling for
        time modifications. */
 
-    if (LIKELY(NO <= N)) {
-      for (i = 0; i < NO+2; i++)
-        syn[i] = (MYFLT) anal[i];
-    }
+    if ((amp = pvs_split_amps(p->fsig)) != NULL)
+      split_polar(csound, p, amp, syn);
     else {
-      for (i = 0; i <= N+1; i++)
-        syn[i] = (MYFLT) anal[i];
-      for (i = N+2; i < NO+2; i++)
-        syn[i] = FL(0.0);
-    }
+      if (LIKELY(NO <= N)) {
+        for (i = 0; i < NO+2; i++)
+          syn[i] = (MYFLT) anal[i];
+      }
+      else {
+        for (i = 0; i <= N+1; i++)
+          syn[i] = (MYFLT) anal[i];
+        for (i = N+2; i < NO+2; i++)
+          syn[i] = FL(0.0);
+      }
 #ifdef NOTDEF
-    if (format==PVS_AMP_PHASE) {
-      for (ii=0 /*, i0=syn, i1=syn+1*/; ii<= NO2; ii+=2 /* i++, i0+=2,  i1+=2*/) {
-        mag = syn[ii];    /* *i0; */
-        phase = syn[ii+1]; /* *i1; */
-        /* *i0 */ syn[ii] = (MYFLT)((double)mag * cos((double)phase));
-        /* *i1 */ syn[ii+1] = (MYFLT)((double)mag * sin((double)phase));
+      if (format==PVS_AMP_PHASE) {
+        for (ii=0 /*, i0=syn, i1=syn+1*/; ii<= NO2; ii+=2 /* i++, i0+=2,  i1+=2*/) {
+          mag = syn[ii];    /* *i0; */
+          phase = syn[ii+1]; /* *i1; */
+          /* *i0 */ syn[ii] = (MYFLT)((double)mag * cos((double)phase));
+          /* *i1 */ syn[ii+1] = (MYFLT)((double)mag * sin((double)phase));
+        }
       }
-    }
-    else if (format == PVS_AMP_FREQ) {
+      else if (format == PVS_AMP_FREQ) {
 #endif
-      for (i=ii=0 /*, i0=syn, i1=syn+1*/; i<= NO2; i++, ii+=2 /*i0+=2,  i1+=2*/) {
-        mag = syn[ii]; /* *i0; */
-        /* RWD variation to keep phase wrapped within +- TWOPI */
-        /* this is spread across several frame cycles, as the problem does not
-           develop for a while */
-
-        angledif = p->TwoPioverR * ( /* *i1 */ syn[ii+1] - ((MYFLT)i * p->Fexact));
-        the_phase = /* *(oldOutPhase + i) */ oldOutPhase[i] + angledif;
-        if (i== p->bin_index)
-          the_phase = (MYFLT) fmod(the_phase,TWOPI);
-        /* *(oldOutPhase + i) = the_phase; */
-        oldOutPhase[i] = the_phase;
-        phase = the_phase;
-        /* *i0 */ syn[ii]  = (MYFLT)((double)mag * cos((double)phase));
-        /* *i1 */ syn[ii+1] = (MYFLT)((double)mag * sin((double)phase));
-      }
+        for (i=ii=0 /*, i0=syn, i1=syn+1*/; i<= NO2; i++, ii+=2 /*i0+=2,  i1+=2*/) {
+          mag = syn[ii]; /* *i0; */
+          /* RWD variation to keep phase wrapped within +- TWOPI */
+          /* this is spread across several frame cycles, as the problem does not
+             develop for a while */
+
+          angledif = p->TwoPioverR * ( /* *i1 */ syn[ii+1] - ((MYFLT)i * p->Fexact));
+          the_phase = /* *(oldOutPhase + i) */ oldOutPhase[i] + angledif;
+          if (i== p->bin_index)
+            the_phase = (MYFLT) fmod(the_phase,TWOPI);
+          /* *(oldOutPhase + i) = the_phase; */
+          oldOutPhase[i] = the_phase;
+          phase = the_phase;
+          /* *i0 */ syn[ii]  = (MYFLT)((double)mag * cos((double)phase));
+          /* *i1 */ syn[ii+1] = (MYFLT)((double)mag * sin((double)phase));
+        }
 #ifdef NOTDEF
-    }
+      }
 #endif
+    }
 
     /* for phase normalization */
     if (++(p->bin_index) == NO2+1)
@@ -1010,12 +1267,13 @@ int32_t pvssynth(CSOUND *csound, PVSYNTH *p)
     double *h = (double*)p->oldOutPhase.auxp;
     double *output = (double*)p->output.auxp;
 
-    /* Get real part from AMP/FREQ */
+    /* Get real part from AMP/FREQ, a pass over the bins at a time */
     for (i=0; i<ksmps; i++) {
-      MYFLT a;
+      double a0, a1;
+      int32_t big = 0;
       ff = (CMPLX*)(p->fsig->frame.auxp) + i*NB;
       for (k=0; k<NB; k++) {
-        double tmp, phase;
+        double tmp;
 
         tmp = ff[k].im; /* Actually frequency */
         /* subtract bin mid frequency */
@@ -1024,15 +1282,37 @@ int32_t pvssynth(CSOUND *csound, PVSYNTH *p)
         tmp *= TWOPI /CS_ESR;
         /* add the overlap phase advance back in */
         tmp += (double)k*TWOPI/N;
-        h[k] = phase = mod2Pi(h[k] + tmp);
-        output[k] = ff[k].re*cos(phase);
+        output[k] = h[k] + tmp;
+        big |= !(fabs(output[k]) < SDFT_WRAP_MAX);
       }
-      a = FL(0.0);
-      for (k=1; k<NB-1; k++) {
-        a -= output[k];
-        if (k+1<NB-1) a+=output[++k];
+      /* wrap the phases by rounding rather than fmod(), while they are
+         small enough for it */
+      if (LIKELY(!big))
+        for (k=0; k<NB; k++) {
+          double q = (output[k] * (1.0/TWOPI) + SDFT_SHIFTER) - SDFT_SHIFTER;
+          h[k] = output[k] - TWOPI * q;
+        }
+      else
+        for (k=0; k<NB; k++)
+          h[k] = mod2Pi(output[k]);
+#ifdef USE_DOUBLE
+      VECMATH_CS(csound)->cosv(output, h, NB);
+#else
+      for (k=0; k<NB; k++)
+        output[k] = cos(h[k]);
+#endif
+      for (k=0; k<NB; k++)
+        output[k] *= ff[k].re;
+      /* the odd bins negated, in two sums */
+      a0 = a1 = 0.0;
+      for (k=1; k+1<NB-1; k+=2) {
+        a0 -= output[k];
+        a1 += output[k+1];
       }
-      aout[i] = (a+a+output[0]-output[NB-1])/N;
+      if (k<NB-1)
+        a0 -= output[k];
+      a0 += a1;
+      aout[i] = (MYFLT) ((a0+a0+output[0]-output[NB-1])/N);
     }
     return OK;
 }
@@ -290,6 +290,58 @@ int32_t linseg(CSOUND *csound, LINSEG *p)
                            Str("linseg: not initialised (arate)\n"));
 }
 
+/* linseg for voices in lockstep: the voices that stay within their
+   segment for the whole cycle ramp side by side in a lane block;
+   those about to change segment take the sample-by-sample path.      */
+int32_t linseg_lanes(CSOUND *csound, const LOCKSTEP *ls, OPDS **pp,
+                     int32_t n, char *err)
+{
+    LINSEG  *p[LOCKSTEP_LANES];
+    double  val[LOCKSTEP_LANES], inc[LOCKSTEP_LANES];
+    MYFLT   blk[LOCKSTEP_CHUNK][LOCKSTEP_LANES];
+    uint32_t k, len, s, nsmps = csound->ksmps;
+    int32_t l, m, v = 0;
+    IGN(ls);
+
+    while (v < n) {
+      for (m = 0; v < n && m < LOCKSTEP_LANES; v++) {
+        LINSEG *q = (LINSEG*) pp[v];
+        if (UNLIKELY(q->auxch.auxp == NULL ||
+                     (q->segsrem && q->curcnt <= (int32) nsmps))) {
+          err[v] = (linseg(csound, q) != OK);
+          continue;
+        }
+        p[m] = q;
+        val[m] = q->curval;
+        /* after the last segment the value holds */
+        inc[m] = (q->segsrem ? q->curainc : 0.0);
+        m++;
+      }
+      if (m == 0)
+        break;
+      for (l = m; l < LOCKSTEP_LANES; l++) {
+        val[l] = val[0]; inc[l] = inc[0];
+      }
+      for (s = 0; s < nsmps; s += len) {
+        len = (nsmps - s < LOCKSTEP_CHUNK ? nsmps - s : LOCKSTEP_CHUNK);
+        for (k = 0; k < len; k++)
+          for (l = 0; l < LOCKSTEP_LANES; l++) {
+            blk[k][l] = (MYFLT) val[l];
+            val[l] += inc[l];
+          }
+        for (l = 0; l < m; l++)
+          for (k = 0; k < len; k++)
+            p[l]->rslt[s + k] = blk[k][l];
+      }
+      for (l = 0; l < m; l++) {
+        p[l]->curval = val[l];
+        if (p[l]->segsrem)
+          p[l]->curcnt -= nsmps;
+      }
+    }
+    return OK;
+}
+
 /* **** ADSR is just a construction and use of linseg */
 
 #define MAXSEGDUR (INT_MAX/CS_ESR)
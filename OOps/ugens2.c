@@ -1287,6 +1287,67 @@ int32_t osckki(CSOUND *csound, OSC   *p)
                            Str("oscili: not initialised"));
 }
 
+/* osckki for voices in lockstep: LOCKSTEP_LANES voices are stepped
+   side by side into a lane block, which is then copied out to each
+   voice.  Spare lanes repeat the first voice and are not copied.     */
+int32_t osckki_lanes(CSOUND *csound, const LOCKSTEP *ls, OPDS **pp,
+                     int32_t n, char *err)
+{
+    OSC     *p[LOCKSTEP_LANES];
+    const MYFLT *ft[LOCKSTEP_LANES];
+    MYFLT   amp[LOCKSTEP_LANES], lodiv[LOCKSTEP_LANES];
+    int32_t phs[LOCKSTEP_LANES], inc[LOCKSTEP_LANES];
+    int32_t lobits[LOCKSTEP_LANES], lomask[LOCKSTEP_LANES];
+    MYFLT   blk[LOCKSTEP_CHUNK][LOCKSTEP_LANES];
+    uint32_t k, len, s, nsmps = csound->ksmps;
+    int32_t l, m, v = 0;
+    IGN(ls);
+
+    while (v < n) {
+      for (m = 0; v < n && m < LOCKSTEP_LANES; v++) {
+        OSC  *q = (OSC*) pp[v];
+        FUNC *ftp = q->ftp;
+        if (UNLIKELY(ftp == NULL)) {
+          err[v] = (osckki(csound, q) != OK);   /* reports the error */
+          continue;
+        }
+        p[m] = q;
+        ft[m] = ftp->ftable;
+        lobits[m] = ftp->lobits;
+        lomask[m] = ftp->lomask;
+        lodiv[m] = ftp->lodiv;
+        phs[m] = q->lphs;
+        inc[m] = MYFLT2LONG(*q->xcps * q->h.insdshead->sicvt);
+        amp[m] = *q->xamp;
+        m++;
+      }
+      if (m == 0)
+        break;
+      for (l = m; l < LOCKSTEP_LANES; l++) {
+        ft[l] = ft[0]; lobits[l] = lobits[0]; lomask[l] = lomask[0];
+        lodiv[l] = lodiv[0]; phs[l] = phs[0]; inc[l] = inc[0];
+        amp[l] = amp[0];
+      }
+      for (s = 0; s < nsmps; s += len) {
+        len = (nsmps - s < LOCKSTEP_CHUNK ? nsmps - s : LOCKSTEP_CHUNK);
+        for (k = 0; k < len; k++)
+          for (l = 0; l < LOCKSTEP_LANES; l++) {
+            const MYFLT *ftab = ft[l] + (phs[l] >> lobits[l]);
+            MYFLT fract = (MYFLT)(phs[l] & lomask[l]) * lodiv[l];
+            MYFLT v1 = ftab[0];
+            blk[k][l] = (v1 + (ftab[1] - v1) * fract) * amp[l];
+            phs[l] = (phs[l] + inc[l]) & PHMASK;
+          }
+        for (l = 0; l < m; l++)
+          for (k = 0; k < len; k++)
+            p[l]->sr[s + k] = blk[k][l];
+      }
+      for (l = 0; l < m; l++)
+        p[l]->lphs = phs[l];
+    }
+    return OK;
+}
+
 int32_t osckai(CSOUND *csound, OSC   *p)
 {
 
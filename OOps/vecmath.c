@@ -0,0 +1,661 @@
+/*
+    vecmath.c: vector approximations of the a-rate math functions
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#include "csoundCore.h"
+#include "vecops.h"
+#include <float.h>
+#include <math.h>
+
+/* The approximations are written without branches or library calls,
+   on doubles whatever MYFLT is, so that the loops over them compile
+   to vector code. Argument reduction and the polynomials of the
+   accurate versions follow fdlibm (Sun Microsystems, 1993); the fast
+   versions use shorter series for about 1e-7 relative error.
+
+   Arguments outside the range of a reduction go to the C library:
+   each block of samples is checked first, and only a block holding
+   such an argument is done one sample at a time.                    */
+
+#define VM_BLOCK        64
+#define VM_SHIFTER      6755399441055744.0      /* 1.5 * 2^52 */
+
+static inline uint64_t vm_bits(double x)
+{
+    uint64_t u;
+    memcpy(&u, &x, sizeof(u));
+    return u;
+}
+
+static inline double vm_double(uint64_t u)
+{
+    double x;
+    memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+/* Integer work is done on uint64_t with logical shifts only, as SSE2
+   has no arithmetic shifts, compares or conversions of 64 bit lanes. */
+
+/* x rounded to the nearest integer, as a double and as an integer */
+static inline double vm_round(double x, uint64_t *k)
+{
+    double t = x + VM_SHIFTER;
+    *k = vm_bits(t) - vm_bits(VM_SHIFTER);
+    return t - VM_SHIFTER;
+}
+
+/* the integer k as a double, for |k| < 2^51 */
+static inline double vm_itod(uint64_t k)
+{
+    return vm_double(vm_bits(VM_SHIFTER) + k) - VM_SHIFTER;
+}
+
+/* y with its sign flipped where bit 1 of q is set */
+static inline double vm_negif(double y, uint64_t q)
+{
+    return vm_double(vm_bits(y) ^ ((q & 2) << 62));
+}
+
+/* a - b, and its rounding error in e (Knuth's two-sum) */
+static inline double vm_diff(double a, double b, double *e)
+{
+    double r = a - b, bb = r - a;
+    *e = (a - (r - bb)) + (-b - bb);
+    return r;
+}
+
+/* Choices between two computed values are blends of bits: written as
+   conditional expressions, the compiler would move the computation
+   of each value into a branch of its own.                            */
+static inline double vm_blend(uint64_t m, double a, double b)
+{
+    return vm_double((vm_bits(a) & m) | (vm_bits(b) & ~m));
+}
+
+/* a where bit 0 of q is set, b elsewhere */
+static inline double vm_oddsel(uint64_t q, double a, double b)
+{
+    return vm_blend(0 - (q & 1), a, b);
+}
+
+/* a where the sign bit of x is set, b elsewhere */
+static inline double vm_negsel(double x, double a, double b)
+{
+    return vm_blend(0 - (vm_bits(x) >> 63), a, b);
+}
+
+/* |y| with the sign of x */
+static inline double vm_copysign(double y, double x)
+{
+    return vm_double((vm_bits(y) & ~(1ULL << 63)) | (vm_bits(x) & (1ULL << 63)));
+}
+
+/* exp */
+
+#define VM_EXP_MAX      708.0
+#define VM_EXP2_MAX     1021.0
+
+static const double
+  ln2hi   = 6.93147180369123816490e-01,
+  ln2lo   = 1.90821492927058770002e-10,
+  invln2  = 1.44269504088896338700e+00,
+  P1      = 1.66666666666666019037e-01,
+  P2      = -2.77777777770155933842e-03,
+  P3      = 6.61375632143793436117e-05,
+  P4      = -1.65339022054652515390e-06,
+  P5      = 4.13813679705723846039e-08;
+
+/* exp(hi - lo) * 2^k, with |hi - lo| <= ln2/2 and |k| <= 1022 */
+static inline double vm_exp_core(double hi, double lo, uint64_t k,
+                                 const int fast)
+{
+    double r = hi - lo, y;
+    if (fast) {
+      y = 1.0 + r*(1.0 + r*(1.0/2 + r*(1.0/6 + r*(1.0/24 + r*(1.0/120 +
+            r*(1.0/720 + r*(1.0/5040)))))));
+    }
+    else {
+      double t = r*r;
+      double c = r - t*(P1 + t*(P2 + t*(P3 + t*(P4 + t*P5))));
+      y = 1.0 - ((lo - (r*c)/(2.0 - c)) - hi);
+    }
+    return y * vm_double((k + 1023) << 52);
+}
+
+/* for |x| <= VM_EXP_MAX */
+static inline double vm_exp(double x, const int fast)
+{
+    uint64_t k;
+    double  kd = vm_round(x*invln2, &k);
+    return vm_exp_core(x - kd*ln2hi, kd*ln2lo, k, fast);
+}
+
+/* for |x| <= VM_EXP2_MAX */
+static inline double vm_exp2(double x, const int fast)
+{
+    uint64_t k;
+    double  f = x - vm_round(x, &k), fh;
+    /* f*ln2 as hi - lo, hi exact: fh has 21 bits and ln2hi 32 */
+    fh = vm_double(vm_bits(f) & 0xffffffff00000000ULL);
+    return vm_exp_core(fh*ln2hi, -((f - fh)*ln2hi + f*ln2lo), k, fast);
+}
+
+/* log */
+
+static const double
+  Lg1     = 6.666666666666735130e-01,
+  Lg2     = 3.999999999940941908e-01,
+  Lg3     = 2.857142874366239149e-01,
+  Lg4     = 2.222219843214978396e-01,
+  Lg5     = 1.818357216161805012e-01,
+  Lg6     = 1.531383769920937332e-01,
+  Lg7     = 1.479819860511658591e-01,
+  ivln2hi = 1.44269504072144627571e+00,
+  ivln2lo = 1.67517131648865118353e-10,
+  ivln10hi = 4.34294481878168880939e-01,
+  ivln10lo = 2.50829467116452752298e-11,
+  log10_2hi = 3.01029995663611771306e-01,
+  log10_2lo = 3.69423907715893078616e-13;
+
+typedef struct {
+    double  k, f, hfsq, r;
+} VM_LOG;
+
+/* x = 2^k * (1 + f) with sqrt(2)/2 <= 1 + f < sqrt(2), and
+   log(1 + f) = f - hfsq + r, for positive normal x                  */
+static inline VM_LOG vm_log_reduce(double x, const int fast)
+{
+    VM_LOG  l;
+    uint64_t hx, i, u = vm_bits(x);
+    double  s, z, w;
+    hx = (u >> 32) & 0x000fffff;
+    i = (hx + 0x95f64) & 0x100000;
+    l.k = vm_itod((u >> 52) + (i >> 20) - 1023);
+    u = ((hx | (i ^ 0x3ff00000)) << 32) | (u & 0xffffffffULL);
+    l.f = vm_double(u) - 1.0;
+    s = l.f/(2.0 + l.f);
+    z = s*s;
+    l.hfsq = 0.5*l.f*l.f;
+    if (fast) {
+      /* log(1 + f) = 2 atanh(s) = f - f*s */
+      l.r = l.hfsq - l.f*s + 2.0*s*z*(1.0/3 + z*(1.0/5 + z*(1.0/7 + z/9)));
+    }
+    else {
+      w = z*z;
+      l.r = s*(l.hfsq + z*(Lg1 + w*(Lg3 + w*(Lg5 + w*Lg7))) +
+               w*(Lg2 + w*(Lg4 + w*Lg6)));
+    }
+    return l;
+}
+
+static inline double vm_log(double x, const int fast)
+{
+    VM_LOG l = vm_log_reduce(x, fast);
+    double y = l.k*ln2hi - ((l.hfsq - (l.r + l.k*ln2lo)) - l.f);
+    return y;
+}
+
+/* f - hfsq + r split as hi + lo, hi with 21 bits */
+#define VM_LOG_HILO(l, hi, lo)                                          \
+    hi = vm_double(vm_bits(l.f - l.hfsq) & 0xffffffff00000000ULL);      \
+    lo = (l.f - hi) - l.hfsq + l.r
+
+static inline double vm_log2(double x, const int fast)
+{
+    VM_LOG l = vm_log_reduce(x, fast);
+    double hi, lo, vhi, vlo, w;
+    VM_LOG_HILO(l, hi, lo);
+    vhi = hi*ivln2hi;
+    vlo = (lo + hi)*ivln2lo + lo*ivln2hi;
+    w = l.k + vhi;
+    vlo += (l.k - w) + vhi;
+    return vlo + w;
+}
+
+static inline double vm_log10(double x, const int fast)
+{
+    VM_LOG l = vm_log_reduce(x, fast);
+    double hi, lo, vhi, vlo, w, y2;
+    VM_LOG_HILO(l, hi, lo);
+    vhi = hi*ivln10hi;
+    y2 = l.k*log10_2hi;
+    vlo = l.k*log10_2lo + (lo + hi)*ivln10lo + lo*ivln10hi;
+    w = y2 + vhi;
+    vlo += (y2 - w) + vhi;
+    return vlo + w;
+}
+
+/* sin, cos, tan */
+
+#define VM_TRIG_MAX     0x1p19
+
+static const double
+  invpio2 = 6.36619772367581382433e-01,
+  pio2_1  = 1.57079632673412561417e+00,
+  pio2_1t = 6.07710050650619224932e-11,
+  pio2_2  = 6.07710050630396597660e-11,
+  pio2_3  = 2.02226624871116645580e-21,
+  pio2_3t = 8.47842766036889956997e-32,
+  S1      = -1.66666666666666324348e-01,
+  S2      = 8.33333333332248946124e-03,
+  S3      = -1.98412698298579493134e-04,
+  S4      = 2.75573137070700676789e-06,
+  S5      = -2.50507602534068634195e-08,
+  S6      = 1.58969099521155010221e-10,
+  C1      = 4.16666666666666019037e-02,
+  C2      = -1.38888888888741095749e-03,
+  C3      = 2.48015872894767294178e-05,
+  C4      = -2.75573143513906633035e-07,
+  C5      = 2.08757232129817482790e-09,
+  C6      = -1.13596475577881948265e-11;
+
+typedef struct {
+    double  s, c;           /* sin and cos of the reduced argument */
+    uint64_t q;             /* its quadrant */
+} VM_TRIG;
+
+/* x = q*pi/2 + y, |y| <= pi/4, for |x| <= VM_TRIG_MAX */
+static inline VM_TRIG vm_trig(double x, const int fast)
+{
+    VM_TRIG t;
+    double  nd = vm_round(x*invpio2, &t.q), r, w, y0, y1, z;
+    r = x - nd*pio2_1;
+    w = nd*pio2_1t;
+    if (fast) {
+      y0 = r - w;
+      z = y0*y0;
+      t.s = y0*(1.0 + z*(-1.0/6 + z*(1.0/120 + z*(-1.0/5040 +
+                 z*(1.0/362880)))));
+      t.c = 1.0 + z*(-1.0/2 + z*(1.0/24 + z*(-1.0/720 + z*(1.0/40320))));
+    }
+    else {
+      /* pi/2 in four parts, the first three of 33 bits so that their
+         products with nd are exact; the rounding errors of the two
+         subtractions are carried into the tail w                    */
+      double u = r, v, hz, e;
+      r = vm_diff(u, nd*pio2_2, &e);
+      u = r;
+      r = vm_diff(u, nd*pio2_3, &w);
+      w = nd*pio2_3t - (e + w);
+      y0 = r - w;
+      y1 = (r - y0) - w;
+      z = y0*y0;
+      w = z*z;
+      /* fdlibm __kernel_sin(y0, y1, 1) and __kernel_cos(y0, y1) */
+      u = S2 + z*(S3 + z*S4) + z*w*(S5 + z*S6);
+      v = z*y0;
+      t.s = y0 - ((z*(0.5*y1 - v*u) - y1) - v*S1);
+      u = z*(C1 + z*(C2 + z*C3)) + w*w*(C4 + z*(C5 + z*C6));
+      hz = 0.5*z;
+      v = 1.0 - hz;
+      t.c = v + (((1.0 - v) - hz) + (z*u - y0*y1));
+    }
+    return t;
+}
+
+static inline double vm_sin(double x, const int fast)
+{
+    VM_TRIG t = vm_trig(x, fast);
+    return vm_negif(vm_oddsel(t.q, t.c, t.s), t.q);
+}
+
+static inline double vm_cos(double x, const int fast)
+{
+    VM_TRIG t = vm_trig(x, fast);
+    return vm_negif(vm_oddsel(t.q, t.s, t.c), t.q + 1);
+}
+
+static inline double vm_tan(double x, const int fast)
+{
+    VM_TRIG t = vm_trig(x, fast);
+    return vm_oddsel(t.q, -t.c, t.s)/vm_oddsel(t.q, t.s, t.c);
+}
+
+/* sinh, cosh, tanh */
+
+#define VM_TANH_MAX     20.0            /* tanh(20) rounds to 1 */
+
+/* sinh by its series, for |x| < 1 */
+static inline double vm_sinh_series(double x, const int fast)
+{
+    double z = x*x, p;
+    if (fast)
+      p = 1.0/6 + z*(1.0/120 + z*(1.0/5040 + z*(1.0/362880)));
+    else
+      p = 1.0/6 + z*(1.0/120 + z*(1.0/5040 + z*(1.0/362880 +
+          z*(1.0/39916800 + z*(1.0/6227020800.0 + z*(1.0/1307674368000.0 +
+          z*(1.0/355687428096000.0 + z*(1.0/121645100408832000.0))))))));
+    return x + x*z*p;
+}
+
+static inline double vm_sinh(double x, const int fast)
+{
+    double ax = fabs(x), e = vm_exp(ax, fast);
+    return vm_negsel(ax - 1.0, vm_sinh_series(x, fast),
+                     vm_copysign(0.5*(e - 1.0/e), x));
+}
+
+static inline double vm_cosh(double x, const int fast)
+{
+    double e = vm_exp(fabs(x), fast);
+    return 0.5*(e + 1.0/e);
+}
+
+/* cosh by its series, for |x| < 1 */
+static inline double vm_cosh_series(double x, const int fast)
+{
+    double z = x*x, p;
+    if (fast)
+      p = 1.0/24 + z*(1.0/720 + z*(1.0/40320 + z*(1.0/3628800)));
+    else
+      p = 1.0/24 + z*(1.0/720 + z*(1.0/40320 + z*(1.0/3628800 +
+          z*(1.0/479001600 + z*(1.0/87178291200.0 +
+          z*(1.0/20922789888000.0 + z*(1.0/6402373705728000.0 +
+          z*(1.0/2432902008176640000.0))))))));
+    return 1.0 + z*(0.5 + z*p);
+}
+
+static inline double vm_tanh(double x, const int fast)
+{
+    double ax = fabs(x);
+    return vm_negsel(ax - 1.0, vm_sinh_series(x, fast)/vm_cosh_series(x, fast),
+                     vm_copysign(1.0 - 2.0/(vm_exp(2.0*ax, fast) + 1.0), x));
+}
+
+/* atan2, hypot */
+
+static const double
+  aT0       = 3.33333333333329318027e-01,
+  aT1       = -1.99999999998764832476e-01,
+  aT2       = 1.42857142725034663711e-01,
+  aT3       = -1.11111104054623557880e-01,
+  aT4       = 9.09088713343650656196e-02,
+  aT5       = -7.69187620504482999495e-02,
+  aT6       = 6.66107313738753120669e-02,
+  aT7       = -5.83357013379057348645e-02,
+  aT8       = 4.97687799461593236017e-02,
+  aT9       = -3.65315727442169155270e-02,
+  aT10      = 1.62858201153657823623e-02,
+  tanpio8   = 4.14213562373095034e-01,
+  pio4_hi   = 7.85398163397448278999e-01,
+  pio4_lo   = 3.06161699786838301793e-17,
+  pio2_hi   = 1.57079632679489655800e+00,
+  pio2_lo   = 6.12323399573676603587e-17,
+  pi_hi     = 3.14159265358979311600e+00,
+  pi_lo     = 1.22464679914735317720e-16;
+
+#define VM_ATAN2_MAX    0x1p1020     /* u + v cannot overflow */
+#define VM_HYPOT_MAX    0x1p500
+
+/* atan2(y, x) for finite y and x, not both zero: the smaller of |x| and
+   |y| over the larger is taken to |t| <= tan(pi/8) by atan(a) =
+   pi/4 + atan((a-1)/(a+1)) where needed, and fdlibm's polynomial for
+   atan on |t| < 7/16, cut short in the fast version, does the rest.  */
+static inline double vm_atan2(double y, double x, const int fast)
+{
+    double   ax = fabs(x), ay = fabs(y), u, v, t, z, w, s, r;
+    uint64_t sw = 0 - (uint64_t) (ay > ax), big;
+    /* t = u/v, or (u/v - 1)/(u/v + 1) past tan(pi/8), in one division */
+    u = vm_blend(sw, ax, ay);
+    v = vm_blend(sw, ay, ax);
+    big = 0 - (uint64_t) (u > tanpio8*v);
+    t = vm_blend(big, u - v, u)/vm_blend(big, u + v, v);
+    z = t*t;
+    w = z*z;
+    if (fast)
+      s = z*(aT0 + z*(aT1 + z*(aT2 + z*(aT3 + z*(aT4 + z*(aT5 + z*aT6))))));
+    else
+      s = z*(aT0 + w*(aT2 + w*(aT4 + w*(aT6 + w*(aT8 + w*aT10))))) +
+        w*(aT1 + w*(aT3 + w*(aT5 + w*(aT7 + w*aT9))));
+    r = vm_blend(big, pio4_hi - ((t*s - pio4_lo) - t), t - t*s);
+    r = vm_blend(sw, pio2_hi - (r - pio2_lo), r);
+    r = vm_negsel(x, pi_hi - (r - pi_lo), r);
+    return vm_copysign(r, y);
+}
+
+static inline double vm_hypot(double x, double y)
+{
+    return sqrt(x*x + y*y);
+}
+
+/* the kernels */
+
+#define VM_LIBEXP2(x)   POWER(FL(2.0), x)
+
+#define VM_ABSLE(x, LIMIT)      (fabs(x) <= LIMIT)
+#define VM_NORMAL(x, LIMIT)     ((x >= DBL_MIN) & (x <= DBL_MAX))
+
+/* functions valid where IN(x, LIMIT), the library for the rest */
+#define VECMATH_LIM(NAME, EXPR, IN, LIMIT, LIB)                         \
+  static void NAME(MYFLT *r, const MYFLT *a, uint32_t n)                \
+  {                                                                     \
+    uint32_t i, j, m;                                                   \
+    int32_t  out;                                                       \
+    for (i = 0; i < n; i += m) {                                        \
+      m = (n - i < VM_BLOCK ? n - i : VM_BLOCK);                        \
+      out = 0;                                                          \
+      for (j = i; j < i + m; j++)                                       \
+        out |= !IN((double) a[j], LIMIT);                               \
+      if (LIKELY(!out)) {                                               \
+        for (j = i; j < i + m; j++) {                                   \
+          double x = (double) a[j];                                     \
+          r[j] = (MYFLT) (EXPR);                                        \
+        }                                                               \
+      }                                                                 \
+      else {                                                            \
+        for (j = i; j < i + m; j++) {                                   \
+          double x = (double) a[j];                                     \
+          r[j] = (IN(x, LIMIT) ? (MYFLT) (EXPR) : LIB(a[j]));           \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+  }
+
+/* functions of two arguments valid where IN(u, v), the library for the
+   rest */
+#define VECMATH_LIM2(NAME, EXPR, IN, LIB)                               \
+  static void NAME(MYFLT *r, const MYFLT *a, const MYFLT *b, uint32_t n) \
+  {                                                                     \
+    uint32_t i, j, m;                                                   \
+    int32_t  out;                                                       \
+    for (i = 0; i < n; i += m) {                                        \
+      m = (n - i < VM_BLOCK ? n - i : VM_BLOCK);                        \
+      out = 0;                                                          \
+      for (j = i; j < i + m; j++)                                       \
+        out |= !IN((double) a[j], (double) b[j]);                       \
+      if (LIKELY(!out)) {                                               \
+        for (j = i; j < i + m; j++) {                                   \
+          double u = (double) a[j], v = (double) b[j];                  \
+          r[j] = (MYFLT) (EXPR);                                        \
+        }                                                               \
+      }                                                                 \
+      else {                                                            \
+        for (j = i; j < i + m; j++) {                                   \
+          double u = (double) a[j], v = (double) b[j];                  \
+          r[j] = (IN(u, v) ? (MYFLT) (EXPR) : LIB(a[j], b[j]));         \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+  }
+
+#define VM_ATAN2_IN(u, v)                                               \
+  ((fabs(u) <= VM_ATAN2_MAX) & (fabs(v) <= VM_ATAN2_MAX) &              \
+   ((u != 0.0) | (v != 0.0)))
+#define VM_HYPOT_IN(u, v)                                               \
+  (((fabs(u) > fabs(v) ? fabs(u) : fabs(v)) <= VM_HYPOT_MAX) &          \
+   (((fabs(u) > fabs(v) ? fabs(u) : fabs(v)) >= 1.0/VM_HYPOT_MAX) |     \
+    ((u == 0.0) & (v == 0.0))))
+
+#define VECMATH_KERNELS(SFX, FAST)                                      \
+  VECMATH_LIM(expv_##SFX, vm_exp(x, FAST),                              \
+              VM_ABSLE, VM_EXP_MAX, EXP)                                \
+  VECMATH_LIM(exp2v_##SFX, vm_exp2(x, FAST),                            \
+              VM_ABSLE, VM_EXP2_MAX, VM_LIBEXP2)                        \
+  VECMATH_LIM(logv_##SFX, vm_log(x, FAST),                              \
+              VM_NORMAL, 0, LOG)                                        \
+  VECMATH_LIM(log2v_##SFX, vm_log2(x, FAST),                            \
+              VM_NORMAL, 0, LOG2)                                       \
+  VECMATH_LIM(log10v_##SFX, vm_log10(x, FAST),                          \
+              VM_NORMAL, 0, LOG10)                                      \
+  VECMATH_LIM(sinv_##SFX, vm_sin(x, FAST),                              \
+              VM_ABSLE, VM_TRIG_MAX, SIN)                               \
+  VECMATH_LIM(cosv_##SFX, vm_cos(x, FAST),                              \
+              VM_ABSLE, VM_TRIG_MAX, COS)                               \
+  VECMATH_LIM(tanv_##SFX, vm_tan(x, FAST),                              \
+              VM_ABSLE, VM_TRIG_MAX, TAN)                               \
+  VECMATH_LIM(sinhv_##SFX, vm_sinh(x, FAST),                            \
+              VM_ABSLE, VM_EXP_MAX, SINH)                               \
+  VECMATH_LIM(coshv_##SFX, vm_cosh(x, FAST),                            \
+              VM_ABSLE, VM_EXP_MAX, COSH)                               \
+  VECMATH_LIM(tanhv_##SFX, vm_tanh(x, FAST),                            \
+              VM_ABSLE, VM_TANH_MAX, TANH)                              \
+  VECMATH_LIM2(atan2v_##SFX, vm_atan2(u, v, FAST), VM_ATAN2_IN, ATAN2)  \
+  VECMATH_LIM2(hypotv_##SFX, vm_hypot(u, v), VM_HYPOT_IN, HYPOT)
+
+/* the C library, one sample at a time */
+#define VECMATH_LIB(NAME, EXPR)                                         \
+  static void NAME(MYFLT *r, const MYFLT *a, uint32_t n)                \
+  {                                                                     \
+    uint32_t i;                                                         \
+    for (i = 0; i < n; i++)                                             \
+      r[i] = EXPR;                                                      \
+  }
+
+VECMATH_LIB(expv_lib, EXP(a[i]))
+VECMATH_LIB(exp2v_lib, POWER(FL(2.0), a[i]))
+VECMATH_LIB(logv_lib, LOG(a[i]))
+VECMATH_LIB(log2v_lib, LOG2(a[i]))
+VECMATH_LIB(log10v_lib, LOG10(a[i]))
+VECMATH_LIB(sinv_lib, SIN(a[i]))
+VECMATH_LIB(cosv_lib, COS(a[i]))
+VECMATH_LIB(tanv_lib, TAN(a[i]))
+VECMATH_LIB(asinv_lib, ASIN(a[i]))
+VECMATH_LIB(acosv_lib, ACOS(a[i]))
+VECMATH_LIB(atanv_lib, ATAN(a[i]))
+VECMATH_LIB(sinhv_lib, SINH(a[i]))
+VECMATH_LIB(coshv_lib, COSH(a[i]))
+VECMATH_LIB(tanhv_lib, TANH(a[i]))
+
+static void powv_lib(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n)
+{
+    uint32_t i;
+    for (i = 0; i < n; i++)
+      r[i] = POWER(a[i], b);
+}
+
+static void atan2v_lib(MYFLT *r, const MYFLT *a, const MYFLT *b, uint32_t n)
+{
+    uint32_t i;
+    for (i = 0; i < n; i++)
+      r[i] = ATAN2(a[i], b[i]);
+}
+
+static void hypotv_lib(MYFLT *r, const MYFLT *a, const MYFLT *b, uint32_t n)
+{
+    uint32_t i;
+    for (i = 0; i < n; i++)
+      r[i] = HYPOT(a[i], b[i]);
+}
+
+VECMATH_KERNELS(ulp, 0)
+VECMATH_KERNELS(fast, 1)
+
+/* x^b as exp(b log|x|), signed for odd b; only accurate to a few ulp
+   times |b log x|, so the accurate table keeps the library pow       */
+static void powv_fast(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n)
+{
+    uint32_t i, j, m;
+    int32_t  out;
+    double   bd = (double) b;
+    int32_t  bint = (bd == floor(bd));
+    double   neg = (bint && fmod(bd, 2.0) != 0.0 ? -1.0 : 1.0), t, y;
+
+    if (UNLIKELY(bd == 0.0 || !(fabs(bd) < 0x1p53))) {
+      powv_lib(r, a, b, n);
+      return;
+    }
+    /* the library for zero, subnormal, infinite and NaN x, and for
+       negative x when b is not an integer                           */
+#define VM_POW_IN(x)    (VM_NORMAL(fabs(x), 0) & ((x > 0.0) | bint))
+    /* b log|x| beyond the range of vm_exp gives inf or 0 */
+#define VM_POW(x)                                                       \
+    (t = bd*vm_log(fabs(x), 1),                                         \
+     y = vm_negsel(VM_EXP_MAX - t, VM_EXP_MAX, t),                      \
+     y = vm_exp(vm_negsel(y + VM_EXP_MAX, -VM_EXP_MAX, y), 1),          \
+     y = vm_negsel(VM_EXP_MAX - t, HUGE_VAL, y),                        \
+     y = vm_negsel(t + VM_EXP_MAX, 0.0, y),                             \
+     vm_negsel(x, neg*y, y))
+    for (i = 0; i < n; i += m) {
+      m = (n - i < VM_BLOCK ? n - i : VM_BLOCK);
+      out = 0;
+      for (j = i; j < i + m; j++)
+        out |= !VM_POW_IN((double) a[j]);
+      if (LIKELY(!out)) {
+        for (j = i; j < i + m; j++) {
+          double x = (double) a[j];
+          r[j] = (MYFLT) VM_POW(x);
+        }
+      }
+      else {
+        for (j = i; j < i + m; j++) {
+          double x = (double) a[j];
+          r[j] = (VM_POW_IN(x) ? (MYFLT) VM_POW(x) : POWER(a[j], b));
+        }
+      }
+    }
+#undef VM_POW
+#undef VM_POW_IN
+}
+
+static const VECMATH vecmath_lib = {
+    VECMATH_EXACT, "exact",
+    expv_lib, exp2v_lib, logv_lib, log2v_lib, log10v_lib,
+    sinv_lib, cosv_lib, tanv_lib, asinv_lib, acosv_lib, atanv_lib,
+    sinhv_lib, coshv_lib, tanhv_lib, powv_lib,
+    atan2v_lib, hypotv_lib
+};
+
+static const VECMATH vecmath_ulp = {
+    VECMATH_ULP, "ulp",
+    expv_ulp, exp2v_ulp, logv_ulp, log2v_ulp, log10v_ulp,
+    sinv_ulp, cosv_ulp, tanv_ulp, asinv_lib, acosv_lib, atanv_lib,
+    sinhv_ulp, coshv_ulp, tanhv_ulp, powv_lib,
+    atan2v_ulp, hypotv_ulp
+};
+
+static const VECMATH vecmath_fast = {
+    VECMATH_FAST, "fast",
+    expv_fast, exp2v_fast, logv_fast, log2v_fast, log10v_fast,
+    sinv_fast, cosv_fast, tanv_fast, asinv_lib, acosv_lib, atanv_lib,
+    sinhv_fast, coshv_fast, tanhv_fast, powv_fast,
+    atan2v_fast, hypotv_fast
+};
+
+const VECMATH *csoundVecMath(int32_t accuracy)
+{
+    switch (accuracy) {
+    case VECMATH_ULP:
+      return &vecmath_ulp;
+    case VECMATH_FAST:
+      return &vecmath_fast;
+    }
+    return &vecmath_lib;
+}
@@ -0,0 +1,302 @@
+/*
+    vecops.c: vector kernels for a-rate signal arithmetic
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#include "csoundCore.h"
+#include "vecops.h"
+#include <math.h>
+
+/* The kernels of every instruction set are expanded from the same
+   macros below, with V_T the vector type, V_N its number of lanes and
+   the other V_ macros its operations. Samples left over after the
+   last full vector are done one at a time by the same C expression
+   as the scalar kernels.                                            */
+
+#define VECOPS_AA(SFX, ATTR, NAME, VOP, OP)                             \
+  static ATTR void NAME##_##SFX(MYFLT *r, const MYFLT *a,               \
+                                const MYFLT *b, uint32_t n)             \
+  {                                                                     \
+    uint32_t i = 0;                                                     \
+    for (; i + V_N <= n; i += V_N)                                      \
+      V_ST(r + i, VOP(V_LD(a + i), V_LD(b + i)));                       \
+    for (; i < n; i++)                                                  \
+      r[i] = a[i] OP b[i];                                              \
+  }
+
+#define VECOPS_AK(SFX, ATTR, NAME, VEXPR, EXPR)                         \
+  static ATTR void NAME##_##SFX(MYFLT *r, const MYFLT *a,               \
+                                MYFLT b, uint32_t n)                    \
+  {                                                                     \
+    uint32_t i = 0;                                                     \
+    V_T vb = V_SET1(b);                                                 \
+    for (; i + V_N <= n; i += V_N) {                                    \
+      V_T va = V_LD(a + i);                                             \
+      V_ST(r + i, VEXPR);                                               \
+    }                                                                   \
+    for (; i < n; i++)                                                  \
+      r[i] = EXPR;                                                      \
+  }
+
+#define VECOPS_A(SFX, ATTR, NAME, VOP, OP)                              \
+  static ATTR void NAME##_##SFX(MYFLT *r, const MYFLT *a, uint32_t n)   \
+  {                                                                     \
+    uint32_t i = 0;                                                     \
+    for (; i + V_N <= n; i += V_N)                                      \
+      V_ST(r + i, VOP(V_LD(a + i)));                                    \
+    for (; i < n; i++)                                                  \
+      r[i] = OP(a[i]);                                                  \
+  }
+
+#define VECOPS_KERNELS(SFX, ATTR)                                       \
+  VECOPS_AA(SFX, ATTR, add, V_ADD, +)                                   \
+  VECOPS_AA(SFX, ATTR, sub, V_SUB, -)                                   \
+  VECOPS_AA(SFX, ATTR, mul, V_MUL, *)                                   \
+  VECOPS_AA(SFX, ATTR, div, V_DIV, /)                                   \
+  VECOPS_AK(SFX, ATTR, addk, V_ADD(va, vb), a[i] + b)                   \
+  VECOPS_AK(SFX, ATTR, subk, V_SUB(va, vb), a[i] - b)                   \
+  VECOPS_AK(SFX, ATTR, mulk, V_MUL(va, vb), a[i] * b)                   \
+  VECOPS_AK(SFX, ATTR, divk, V_DIV(va, vb), a[i] / b)                   \
+  VECOPS_AK(SFX, ATTR, ksub, V_SUB(vb, va), b - a[i])                   \
+  VECOPS_AK(SFX, ATTR, kdiv, V_DIV(vb, va), b / a[i])                   \
+  VECOPS_A(SFX, ATTR, absv, V_ABS, FABS)                                \
+  VECOPS_A(SFX, ATTR, sqrtv, V_SQRT, SQRT)                              \
+  static ATTR int32_t anyzero_##SFX(const MYFLT *a, uint32_t n)         \
+  {                                                                     \
+    uint32_t i = 0;                                                     \
+    int32_t  z = 0;                                                     \
+    for (; i + V_N <= n; i += V_N)                                      \
+      z |= V_ANYZERO(V_LD(a + i));                                      \
+    for (; i < n; i++)                                                  \
+      z |= (a[i] == FL(0.0));                                           \
+    return z;                                                           \
+  }
+
+#define VECOPS_TABLE(SFX, LEVEL, NAME)                                  \
+  { LEVEL, NAME, add_##SFX, sub_##SFX, mul_##SFX, div_##SFX,            \
+    addk_##SFX, subk_##SFX, mulk_##SFX, divk_##SFX, ksub_##SFX,         \
+    kdiv_##SFX, absv_##SFX, sqrtv_##SFX, anyzero_##SFX }
+
+/* plain C, one sample per step */
+#define V_T             MYFLT
+#define V_N             1
+#define V_LD(p)         (*(p))
+#define V_ST(p, v)      (*(p) = (v))
+#define V_SET1(x)       (x)
+#define V_ADD(x, y)     ((x) + (y))
+#define V_SUB(x, y)     ((x) - (y))
+#define V_MUL(x, y)     ((x) * (y))
+#define V_DIV(x, y)     ((x) / (y))
+#define V_ABS(x)        FABS(x)
+#define V_SQRT(x)       SQRT(x)
+#define V_ANYZERO(x)    ((x) == FL(0.0))
+
+VECOPS_KERNELS(c, )
+static const VECOPS vecops_c = VECOPS_TABLE(c, VECOPS_SCALAR, "scalar");
+
+#undef V_T
+#undef V_N
+#undef V_LD
+#undef V_ST
+#undef V_SET1
+#undef V_ADD
+#undef V_SUB
+#undef V_MUL
+#undef V_DIV
+#undef V_ABS
+#undef V_SQRT
+#undef V_ANYZERO
+
+#if defined(__x86_64__) || defined(_M_X64) || \
+    (defined(__i386__) && defined(__SSE2__))
+#define VECOPS_X86
+#include <immintrin.h>
+
+#ifndef USE_DOUBLE
+#define V_T             __m128
+#define V_N             4
+#define V_LD(p)         _mm_loadu_ps(p)
+#define V_ST(p, v)      _mm_storeu_ps(p, v)
+#define V_SET1(x)       _mm_set1_ps(x)
+#define V_ADD(x, y)     _mm_add_ps(x, y)
+#define V_SUB(x, y)     _mm_sub_ps(x, y)
+#define V_MUL(x, y)     _mm_mul_ps(x, y)
+#define V_DIV(x, y)     _mm_div_ps(x, y)
+#define V_ABS(x)        _mm_andnot_ps(_mm_set1_ps(-0.0f), x)
+#define V_SQRT(x)       _mm_sqrt_ps(x)
+#define V_ANYZERO(x)    _mm_movemask_ps(_mm_cmpeq_ps(x, _mm_setzero_ps()))
+#else
+#define V_T             __m128d
+#define V_N             2
+#define V_LD(p)         _mm_loadu_pd(p)
+#define V_ST(p, v)      _mm_storeu_pd(p, v)
+#define V_SET1(x)       _mm_set1_pd(x)
+#define V_ADD(x, y)     _mm_add_pd(x, y)
+#define V_SUB(x, y)     _mm_sub_pd(x, y)
+#define V_MUL(x, y)     _mm_mul_pd(x, y)
+#define V_DIV(x, y)     _mm_div_pd(x, y)
+#define V_ABS(x)        _mm_andnot_pd(_mm_set1_pd(-0.0), x)
+#define V_SQRT(x)       _mm_sqrt_pd(x)
+#define V_ANYZERO(x)    _mm_movemask_pd(_mm_cmpeq_pd(x, _mm_setzero_pd()))
+#endif
+
+VECOPS_KERNELS(sse2, )
+static const VECOPS vecops_sse2 = VECOPS_TABLE(sse2, VECOPS_SSE2, "SSE2");
+
+#undef V_T
+#undef V_N
+#undef V_LD
+#undef V_ST
+#undef V_SET1
+#undef V_ADD
+#undef V_SUB
+#undef V_MUL
+#undef V_DIV
+#undef V_ABS
+#undef V_SQRT
+#undef V_ANYZERO
+
+/* AVX kernels are compiled for that target only, and chosen at run
+   time when the CPU has it, so the library still runs on any x86-64 */
+#if defined(__GNUC__)
+#define VECOPS_AVX_TARGET __attribute__((target("avx")))
+
+#ifndef USE_DOUBLE
+#define V_T             __m256
+#define V_N             8
+#define V_LD(p)         _mm256_loadu_ps(p)
+#define V_ST(p, v)      _mm256_storeu_ps(p, v)
+#define V_SET1(x)       _mm256_set1_ps(x)
+#define V_ADD(x, y)     _mm256_add_ps(x, y)
+#define V_SUB(x, y)     _mm256_sub_ps(x, y)
+#define V_MUL(x, y)     _mm256_mul_ps(x, y)
+#define V_DIV(x, y)     _mm256_div_ps(x, y)
+#define V_ABS(x)        _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x)
+#define V_SQRT(x)       _mm256_sqrt_ps(x)
+#define V_ANYZERO(x)                                                    \
+  _mm256_movemask_ps(_mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_EQ_OQ))
+#else
+#define V_T             __m256d
+#define V_N             4
+#define V_LD(p)         _mm256_loadu_pd(p)
+#define V_ST(p, v)      _mm256_storeu_pd(p, v)
+#define V_SET1(x)       _mm256_set1_pd(x)
+#define V_ADD(x, y)     _mm256_add_pd(x, y)
+#define V_SUB(x, y)     _mm256_sub_pd(x, y)
+#define V_MUL(x, y)     _mm256_mul_pd(x, y)
+#define V_DIV(x, y)     _mm256_div_pd(x, y)
+#define V_ABS(x)        _mm256_andnot_pd(_mm256_set1_pd(-0.0), x)
+#define V_SQRT(x)       _mm256_sqrt_pd(x)
+#define V_ANYZERO(x)                                                    \
+  _mm256_movemask_pd(_mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_EQ_OQ))
+#endif
+
+VECOPS_KERNELS(avx, VECOPS_AVX_TARGET)
+static const VECOPS vecops_avx = VECOPS_TABLE(avx, VECOPS_AVX, "AVX");
+
+#undef V_T
+#undef V_N
+#undef V_LD
+#undef V_ST
+#undef V_SET1
+#undef V_ADD
+#undef V_SUB
+#undef V_MUL
+#undef V_DIV
+#undef V_ABS
+#undef V_SQRT
+#undef V_ANYZERO
+#endif  /* __GNUC__ */
+#endif  /* x86 */
+
+/* Advanced SIMD is part of every AArch64 CPU; 32-bit NEON has neither
+   doubles nor exact division and square root, so it uses the C loops */
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define VECOPS_ARM64
+#include <arm_neon.h>
+
+#ifndef USE_DOUBLE
+#define V_T             float32x4_t
+#define V_N             4
+#define V_LD(p)         vld1q_f32(p)
+#define V_ST(p, v)      vst1q_f32(p, v)
+#define V_SET1(x)       vdupq_n_f32(x)
+#define V_ADD(x, y)     vaddq_f32(x, y)
+#define V_SUB(x, y)     vsubq_f32(x, y)
+#define V_MUL(x, y)     vmulq_f32(x, y)
+#define V_DIV(x, y)     vdivq_f32(x, y)
+#define V_ABS(x)        vabsq_f32(x)
+#define V_SQRT(x)       vsqrtq_f32(x)
+#define V_ANYZERO(x)    (vmaxvq_u32(vceqzq_f32(x)) != 0)
+#else
+#define V_T             float64x2_t
+#define V_N             2
+#define V_LD(p)         vld1q_f64(p)
+#define V_ST(p, v)      vst1q_f64(p, v)
+#define V_SET1(x)       vdupq_n_f64(x)
+#define V_ADD(x, y)     vaddq_f64(x, y)
+#define V_SUB(x, y)     vsubq_f64(x, y)
+#define V_MUL(x, y)     vmulq_f64(x, y)
+#define V_DIV(x, y)     vdivq_f64(x, y)
+#define V_ABS(x)        vabsq_f64(x)
+#define V_SQRT(x)       vsqrtq_f64(x)
+#define V_ANYZERO(x)                                                    \
+  (vmaxvq_u32(vreinterpretq_u32_u64(vceqzq_f64(x))) != 0)
+#endif
+
+VECOPS_KERNELS(neon, )
+static const VECOPS vecops_neon = VECOPS_TABLE(neon, VECOPS_NEON, "NEON");
+#endif  /* AArch64 */
+
+const VECOPS *csoundVecOpsLevel(int32_t level)
+{
+    switch (level) {
+    case VECOPS_SCALAR:
+      return &vecops_c;
+#ifdef VECOPS_X86
+    case VECOPS_SSE2:
+      return &vecops_sse2;
+#ifdef VECOPS_AVX_TARGET
+    case VECOPS_AVX:
+      __builtin_cpu_init();
+      return (__builtin_cpu_supports("avx") ? &vecops_avx : NULL);
+#endif
+#endif
+#ifdef VECOPS_ARM64
+    case VECOPS_NEON:
+      return &vecops_neon;
+#endif
+    }
+    return NULL;
+}
+
+const VECOPS *csoundVecOps(void)
+{
+    /* the choice is the same in every thread, so a race only repeats it */
+    static const VECOPS *volatile ops = NULL;
+    const VECOPS *o = ops;
+    int32_t level;
+
+    if (UNLIKELY(o == NULL)) {
+      for (level = VECOPS_NEON; o == NULL; level--)
+        o = csoundVecOpsLevel(level);
+      ops = o;
+    }
+    return o;
+}
@@ -67,20 +67,48 @@ typedef struct {
 } OSCSEND;
 
 
-typedef struct osc_pat {
-    struct osc_pat *next;
-    union {
-      MYFLT number;
-      STRINGDAT string;
-      void     *blob;
-    } args[ARG_CNT-1];
-} OSC_PAT;
+/* one argument of a queued message */
+typedef union {
+    MYFLT number;
+    STRINGDAT string;
+    void     *blob;
+} OSC_ARG;
+
+#define OSC_INDEX_SIZE (256)    /* hash buckets per port */
+#define OSC_QUEUE_SIZE (128)    /* message slots per listener */
+#define OSC_STRING_SIZE (1024)  /* bytes per queued string */
+#define OSC_BLOB_SIZE (16384)   /* bytes per queued blob, at least */
+
+/* bucket links are read by the server thread while i-time code
+   changes them */
+#if defined(MSVC)
+#define OSC_GETP(var) InterlockedCompareExchangePointer((void **) &var, \
+                                                        NULL, NULL)
+#define OSC_SETP(var, val) InterlockedExchangePointer((void **) &var, val)
+#elif defined(HAVE_ATOMIC_BUILTIN)
+#define OSC_GETP(var) __atomic_load_n(&var, __ATOMIC_ACQUIRE)
+#define OSC_SETP(var, val) __atomic_store_n(&var, val, __ATOMIC_RELEASE)
+#else
+#define OSC_GETP(var) var
+#define OSC_SETP(var, val) var = val
+#endif
+
+struct osclcommon;
+
+/* listeners on a port, indexed by the hash of their path */
+typedef struct {
+    CSOUND  *csound;
+    void    *mutex_;            /* serialises changes to the index */
+    void    *globals;
+    volatile long calls;        /* odd while the handler runs */
+    struct osclcommon *bucket[OSC_INDEX_SIZE];
+} OSC_INDEX;
 
 typedef struct {
     lo_server_thread thread;
     CSOUND  *csound;
     void    *mutex_;
-    void    *oplst;             /* list of opcodes listening on this port */
+    OSC_INDEX *index;           /* opcodes listening on this port */
 } OSC_PORT;
 
 /* structure for global variables */
@@ -90,7 +118,7 @@ typedef struct {
     /* for OSCinit/OSClisten */
     int32_t   nPorts;
     OSC_PORT  *ports;
-    int32_t   osccounter;
+    volatile long osccounter;
     void      *mutex_;
 } OSC_GLOBALS;
 
@@ -108,13 +136,23 @@ typedef struct {
     MYFLT   *port;              /* Port number on which to listen */
 } OSCINITM;
 
+/* Messages for a listener are queued in a ring of preallocated slots,
+   written only by the port's server thread and read only by the
+   performance thread, so neither side takes a lock. Strings and blobs
+   are copied into space set aside for each slot at i-time; messages
+   whose payload does not fit are dropped. */
 typedef struct osclcommon {
-    lo_method method;
     char    *saved_path;
     char    saved_types[ARG_CNT];    /* copy of type list */
-    OSC_PAT *patterns;          /* FIFO list of pending messages */
-    OSC_PAT *freePatterns;      /* free message stack */
-    struct osclcomon *nxt;       /* pointer to next opcode on the same port */
+    uint32_t hash;              /* hash of saved_path */
+    int32_t nargs;
+    OSC_ARG *slots;             /* OSC_QUEUE_SIZE messages of nargs args */
+    char    *payload;           /* string and blob space of all slots */
+    int32_t capacity[ARG_CNT];  /* bytes of payload for each argument */
+    volatile long rpos, wpos;   /* next slot to read and to write */
+    volatile long dropped;      /* messages lost to a full queue */
+    volatile long oversized;    /* messages lost to a short payload */
+    struct osclcommon *nxt;     /* next listener in the same bucket */
 } OSCLCOMMON;
 
 typedef struct {
@@ -414,6 +452,7 @@ static int32_t OSC_reset(CSOUND *csound, OSC_GLOBALS *p)
         lo_server_thread_stop(p->ports[i].thread);
         lo_server_thread_free(p->ports[i].thread);
         csound->DestroyMutex(p->ports[i].mutex_);
+        csound->Free(csound, p->ports[i].index);
       }
     csound->DestroyGlobalVariable(csound, "_OSC_globals");
     return OK;
@@ -451,29 +490,140 @@ static CS_NOINLINE OSC_GLOBALS *alloc_globals(CSOUND *csound)
 
  /* ------------------------------------------------------------------------ */
 
-static CS_NOINLINE OSC_PAT *alloc_pattern(CSOUND *csound)
+/* FNV-1a hash of an OSC path */
+static uint32_t osc_hash(const char *path)
+{
+    uint32_t h = 2166136261u;
+    while (*path != '\0')
+      h = (h ^ (unsigned char) *path++) * 16777619u;
+    return h;
+}
+
+/* check an incoming type list against a listener's,
+   allowing the numeric and string coercions liblo makes */
+static int32_t osc_types_match(const char *want, const char *types)
 {
-    OSC_PAT *p;
-    size_t  nbytes;
+    for ( ; *want != '\0' && *types != '\0'; want++, types++) {
+      if (*want == *types)
+        continue;
+      if (strchr("ifhd", *want) != NULL && strchr("ifhd", *types) != NULL)
+        continue;
+      if ((*want == 's' || *want == 'S') && (*types == 's' || *types == 'S'))
+        continue;
+      return 0;
+    }
+    return *want == *types;
+}
+
+/* add and remove listeners; the index is only changed at i-time,
+   under the mutex, and links are published atomically so that the
+   handler can walk a bucket without it */
+static void osc_index_add(OSC_INDEX *x, OSCLCOMMON *o)
+{
+    OSCLCOMMON **b;
+    o->hash = osc_hash(o->saved_path);
+    b = &x->bucket[o->hash % OSC_INDEX_SIZE];
+    x->csound->LockMutex(x->mutex_);
+    o->nxt = *b;
+    OSC_SETP(*b, o);
+    x->csound->UnlockMutex(x->mutex_);
+}
 
-    /* number of bytes to allocate */
-    nbytes = sizeof(OSC_PAT);
-    /* allocate and initialise structure */
-    p = (OSC_PAT*) csound->Calloc(csound, nbytes);
+static void osc_index_remove(OSC_INDEX *x, OSCLCOMMON *o)
+{
+    OSCLCOMMON **b = &x->bucket[o->hash % OSC_INDEX_SIZE];
+    long    c;
+    x->csound->LockMutex(x->mutex_);
+    for ( ; *b != NULL; b = &(*b)->nxt)
+      if (*b == o) {
+        OSC_SETP(*b, o->nxt);
+        break;
+      }
+    x->csound->UnlockMutex(x->mutex_);
+    /* a handler call that started before the unlink may still be
+       writing to o; the port has one server thread, so once the call
+       count moves on, o is no longer seen */
+    c = ATOMIC_GET(x->calls);
+    if (c & 1)
+      while (ATOMIC_GET(x->calls) == c)
+        x->csound->Sleep(1);
+    o->nxt = NULL;
+}
 
-    return p;
+static OSC_INDEX *osc_index_new(CSOUND *csound, OSC_PORT *port,
+                                OSC_GLOBALS *g)
+{
+    OSC_INDEX *x = (OSC_INDEX*) csound->Calloc(csound, sizeof(OSC_INDEX));
+    x->csound = csound;
+    x->mutex_ = port->mutex_;
+    x->globals = g;
+    return x;
 }
 
-static inline OSC_PAT *get_pattern(CSOUND *csound,OSCLCOMMON *pp)
+/* allocate the ring; capacity[] gives the payload bytes of each
+   string or blob argument, and is 0 for numbers */
+static int32_t osc_queue_init(CSOUND *csound, OSCLCOMMON *o)
 {
-    OSC_PAT *p;
+    int32_t i, r, bytes = 0;
+    o->nargs = (int32_t) strlen(o->saved_types);
+    o->slots = (OSC_ARG*)
+      csound->Calloc(csound,
+                     sizeof(OSC_ARG) * OSC_QUEUE_SIZE * (o->nargs + 1));
+    o->rpos = o->wpos = o->dropped = o->oversized = 0;
+    o->payload = NULL;
+    if (UNLIKELY(o->slots == NULL))
+      return NOTOK;
+    for (i = 0; i < o->nargs; i++)
+      bytes += o->capacity[i];
+    if (bytes == 0)
+      return OK;
+    o->payload = (char*) csound->Calloc(csound, (size_t) bytes * OSC_QUEUE_SIZE);
+    if (UNLIKELY(o->payload == NULL))
+      return NOTOK;
+    /* each slot's strings and blobs point at its own space for good */
+    for (r = 0; r < OSC_QUEUE_SIZE; r++) {
+      char *d = o->payload + (size_t) r * bytes;
+      for (i = 0; i < o->nargs; i++) {
+        OSC_ARG *m = &o->slots[r * o->nargs + i];
+        if (o->capacity[i] == 0)
+          continue;
+        if (o->saved_types[i] == 's') {
+          m->string.data = d;
+          m->string.size = o->capacity[i];
+        }
+        else
+          m->blob = d;
+        d += o->capacity[i];
+      }
+    }
+    return OK;
+}
 
-    if (pp->freePatterns != NULL) {
-      p = pp->freePatterns;
-      pp->freePatterns = p->next;
-      return p;
+/* payload space for the arguments of a listener */
+static void osc_queue_capacity(OSCLCOMMON *o, const char *types,
+                               MYFLT **args, uint32_t ksmps)
+{
+    int32_t i;
+    for (i = 0; o->saved_types[i] != '\0'; i++) {
+      o->capacity[i] = 0;
+      if (o->saved_types[i] == 's')
+        o->capacity[i] = OSC_STRING_SIZE;
+      else if (o->saved_types[i] == 'b') {
+        int32_t bytes = OSC_BLOB_SIZE;
+        if (types[i] == 'a')
+          bytes = (int32_t) (sizeof(MYFLT) * (ksmps + 1));
+        else if (types[i] == 'A' || types[i] == 'D') {
+          ARRAYDAT *arr = (ARRAYDAT*) args[i];
+          int32_t j, n = arr->dimensions + 1;
+          for (j = 0; arr->sizes != NULL && j < arr->dimensions; j++)
+            n *= arr->sizes[j];
+          if ((int32_t) (n * sizeof(MYFLT)) > bytes)
+            bytes = (int32_t) (n * sizeof(MYFLT));
+        }
+        /* the length word of the blob, and its padding */
+        o->capacity[i] = ((bytes + 3) & ~3) + 8;
+      }
     }
-    return alloc_pattern(csound);
 }
 
 typedef struct {
@@ -484,101 +634,93 @@ typedef struct {
 static int32_t OSCcounter(CSOUND *csound, OSCcount *p)
 {
     OSC_GLOBALS *g = alloc_globals(csound);
-    *p->ans = (MYFLT)g->osccounter;
+    *p->ans = (MYFLT)ATOMIC_GET(g->osccounter);
     return OK;
 }
 
-
+/* Single method registered for each port: finds the listener
+   in the index and copies the message into its next free slot,
+   without locking or allocating */
 static int32_t OSC_handler(const char *path, const char *types,
                        lo_arg **argv, int32_t argc, lo_message data, void *p)
 {
     IGN(argc);  IGN(data);
-    OSC_PORT  *pp = (OSC_PORT*) p;
+    OSC_INDEX  *x = (OSC_INDEX*) p;
     OSCLCOMMON *o;
-    CSOUND    *csound = (CSOUND *) pp->csound;
+    uint32_t  h = osc_hash(path);
     int32_t       retval = 1;
 
-    pp->csound->LockMutex(pp->mutex_);
-    o = (OSCLCOMMON*) pp->oplst;
-    //printf("opst=%p\n", o);
-    while (o != NULL) {
-      //printf("Looking at %s/%s against %s/%s\n",
-      //       o->saved_path, path,o->saved_types, types);
-      if (strcmp(o->saved_path, path) == 0 &&
-          strcmp(o->saved_types, types) == 0) {
-        /* Message is for this guy */
-        int32_t     i;
-        OSC_PAT *m;
-        OSC_GLOBALS *g = alloc_globals(csound);
-        pp->csound->LockMutex(g->mutex_);
-        g->osccounter++;
-        pp->csound->UnlockMutex(g->mutex_);
-        m = get_pattern(csound, o);
-        if (m != NULL) {
-          /* queue message for being read by OSClisten opcode */
-          m->next = NULL;
-          if (o->patterns == NULL)
-            o->patterns = m;
-          else {
-            OSC_PAT *mm;
-            for (mm = o->patterns; mm->next != NULL; mm = mm->next)
-              ;
-            mm->next = m;
+    ATOMIC_INCR(x->calls);
+    for (o = OSC_GETP(x->bucket[h % OSC_INDEX_SIZE]); o != NULL;
+         o = OSC_GETP(o->nxt))
+      if (o->hash == h && strcmp(o->saved_path, path) == 0 &&
+          osc_types_match(o->saved_types, types))
+        break;
+    if (o != NULL) {
+      /* Message is for this guy */
+      int32_t  i;
+      long     w = o->wpos, nw = (w + 1) % OSC_QUEUE_SIZE;
+      OSC_ARG  *m;
+      OSC_GLOBALS *g = (OSC_GLOBALS*) x->globals;
+      retval = 0;
+      if (UNLIKELY(nw == ATOMIC_GET(o->rpos))) {
+        /* queue full */
+        ATOMIC_INCR(o->dropped);
+        ATOMIC_INCR(x->calls);
+        return retval;
+      }
+      m = &o->slots[w * o->nargs];
+      /* copy argument list; the slot is not seen until wpos moves */
+      for (i = 0; o->saved_types[i] != '\0'; i++) {
+        switch (types[i]) {
+        default:              /* Should not happen */
+        case 'i':
+          m[i].number = (MYFLT) argv[i]->i; break;
+        case 'h':
+          m[i].number = (MYFLT) argv[i]->i64; break;
+        case 'c':
+          m[i].number= (MYFLT) argv[i]->c; break;
+        case 'f':
+          m[i].number = (MYFLT) argv[i]->f; break;
+        case 'd':
+          m[i].number= (MYFLT) argv[i]->d; break;
+        case 's':
+        case 'S':
+          {
+            const char *src = (char*) &(argv[i]->s);
+            size_t len = strlen(src);
+            if (UNLIKELY(len >= (size_t) o->capacity[i]))
+              goto oversized;
+            memcpy(m[i].string.data, src, len + 1);
+            break;
           }
-          /* copy argument list */
-          for (i = 0; o->saved_types[i] != '\0'; i++) {
-            switch (types[i]) {
-            default:              /* Should not happen */
-            case 'i':
-              m->args[i].number = (MYFLT) argv[i]->i; break;
-            case 'h':
-              m->args[i].number = (MYFLT) argv[i]->i64; break;
-            case 'c':
-               m->args[i].number= (MYFLT) argv[i]->c; break;
-            case 'f':
-               m->args[i].number = (MYFLT) argv[i]->f; break;
-            case 'd':
-               m->args[i].number= (MYFLT) argv[i]->d; break;
-            case 's':
-              { // ***NO CHECK THAT m->args[i] IS A STRING
-                char  *src = (char*) &(argv[i]->s), *dst = m->args[i].string.data;
-                if (m->args[i].string.size <= strlen(src)) {
-                  if (dst != NULL) csound->Free(csound, dst);
-                  dst = csound->Strdup(csound, src);
-                  // who sets m->args[i].string.size ??
-                  m->args[i].string.data = dst;
-                  m->args[i].string.size = strlen(dst)+1;
-                }
-                else strcpy(dst, src);
-                break;
-              }
-            case 'b':
-              {
-                int32_t len =
-                  lo_blobsize((lo_blob)argv[i]);
-                m->args[i].blob =
-                  csound->Malloc(csound,len);
-                memcpy(m->args[i].blob, argv[i], len);
+        case 'b':
+          {
+            int32_t len =
+              lo_blobsize((lo_blob)argv[i]);
+            if (UNLIKELY(len > o->capacity[i]))
+              goto oversized;
+            memcpy(m[i].blob, argv[i], len);
 #ifdef OSC_DEBUG
-                {
-                  lo_blob *bb = (lo_blob*)m->args[i].blob;
-                  int32_t size = lo_blob_datasize(bb);
-                  MYFLT *data = lo_blob_dataptr(bb);
-                  int32_t   *idata = (int32_t*)data;
-                  printf("size=%d data=%.8x %.8x ...\n",size, idata[0], idata[1]);
-                }
-#endif
-              }
+            {
+              lo_blob *bb = (lo_blob*)m[i].blob;
+              int32_t size = lo_blob_datasize(bb);
+              MYFLT *data = lo_blob_dataptr(bb);
+              int32_t   *idata = (int32_t*)data;
+              printf("size=%d data=%.8x %.8x ...\n",size, idata[0], idata[1]);
             }
+#endif
           }
-          retval = 0;
         }
-        break;
       }
-      o = (OSCLCOMMON*) o->nxt;
+      ATOMIC_SET(o->wpos, nw);
+      ATOMIC_INCR(g->osccounter);
     }
-
-    pp->csound->UnlockMutex(pp->mutex_);
+    ATOMIC_INCR(x->calls);
+    return retval;
+ oversized:
+    ATOMIC_INCR(o->oversized);
+    ATOMIC_INCR(x->calls);
     return retval;
 }
 
@@ -595,11 +737,13 @@ static int32_t OSC_deinit(CSOUND *csound, OSCINIT *p)
     if (UNLIKELY(pp==NULL)) return NOTOK;
     ports = pp->ports;
     csound->Message(csound, "handle=%d\n", n);
-    csound->DestroyMutex(ports[n].mutex_);
-    ports[n].mutex_ = NULL;
     lo_server_thread_stop(ports[n].thread);
     lo_server_thread_free(ports[n].thread);
     ports[n].thread =  NULL;
+    csound->DestroyMutex(ports[n].mutex_);
+    ports[n].mutex_ = NULL;
+    csound->Free(csound, ports[n].index);
+    ports[n].index = NULL;
     csound->Message(csound, "%s", Str("OSC deinitialised\n"));
     return OK;
 }
@@ -618,13 +762,16 @@ static int32_t osc_listener_init(CSOUND *csound, OSCINIT *p)
                                         sizeof(OSC_PORT) * (n + 1));
     ports[n].csound = csound;
     ports[n].mutex_ = csound->Create_Mutex(0);
-    ports[n].oplst = NULL;
+    ports[n].index = osc_index_new(csound, &ports[n], pp);
     snprintf(buff, 32, "%d", (int32_t) *(p->port));
     ports[n].thread = lo_server_thread_new(buff, OSC_error);
     if (UNLIKELY(ports[n].thread==NULL))
       return csound->InitError(csound,
                                Str("cannot start OSC listener on port %s\n"),
                                buff);
+    /* one method for all paths, dispatched through the index */
+    lo_server_thread_add_method(ports[n].thread, NULL, NULL,
+                                OSC_handler, ports[n].index);
     ///if (lo_server_thread_start(ports[n].thread)<0)
     ///  return csound->InitError(csound,
     ///                           Str("cannot start OSC listener on port %s\n"),
@@ -653,7 +800,7 @@ static int32_t osc_listener_initMulti(CSOUND *csound, OSCINITM *p)
                                         sizeof(OSC_PORT) * (n + 1));
     ports[n].csound = csound;
     ports[n].mutex_ = csound->Create_Mutex(0);
-    ports[n].oplst = NULL;
+    ports[n].index = osc_index_new(csound, &ports[n], pp);
     snprintf(buff, 32, "%d", (int32_t) *(p->port));
     ports[n].thread = lo_server_thread_new_multicast(p->group->data,
                                                      buff, OSC_error);
@@ -661,6 +808,8 @@ static int32_t osc_listener_initMulti(CSOUND *csound, OSCINITM *p)
       return csound->InitError(csound,
                                Str("cannot start OSC listener on port %s\n"),
                                buff);
+    lo_server_thread_add_method(ports[n].thread, NULL, NULL,
+                                OSC_handler, ports[n].index);
     ///if (lo_server_thread_start(ports[n].thread)<0)
     ///  return csound->InitError(csound,
     ///                           Str("cannot start OSC listener on port %s\n"),
@@ -678,42 +827,16 @@ static int32_t osc_listener_initMulti(CSOUND *csound, OSCINITM *p)
 
 static int32_t OSC_listendeinit(CSOUND *csound, OSC_PORT *port, OSCLCOMMON *p)
 {
-    OSC_PAT *m;
-
     if (port->mutex_==NULL) return NOTOK;
-    csound->LockMutex(port->mutex_);
-    if (port->oplst == (void*)p)
-      port->oplst = p->nxt;
-    else {
-      OSCLCOMMON *o = (OSCLCOMMON*) port->oplst;
-      for ( ; o->nxt != (void*) p; o = (OSCLCOMMON*) o->nxt)
-        ;
-      o->nxt = p->nxt;
-    }
-    csound->UnlockMutex(port->mutex_);
-#ifdef LIBLO29
-    //Would like to use this call but requires liblo2.29
-    lo_server_thread_del_lo_method (port->thread, p->method);
-#else
-    lo_server_thread_del_method(port->thread, p->saved_path, p->saved_types);
-#endif
+    osc_index_remove(port->index, p);
     csound->Free(csound, p->saved_path);
     p->saved_path = NULL;
-    p->nxt = NULL;
-    m = p->patterns;
-    p->patterns = NULL;
-    while (m != NULL) {
-      OSC_PAT *mm = m->next;
-      csound->Free(csound, m);
-      m = mm;
-    }
-    m = p->freePatterns;
-    p->freePatterns = NULL;
-    while (m != NULL) {
-      OSC_PAT *mm = m->next;
-      csound->Free(csound, m);
-      m = mm;
-    }
+    if (p->payload != NULL)
+      csound->Free(csound, p->payload);
+    p->payload = NULL;
+    if (p->slots != NULL)
+      csound->Free(csound, p->slots);
+    p->slots = NULL;
     return OK;
 }
 
@@ -729,6 +852,23 @@ static int32_t OSC_listadeinit(CSOUND *csound, OSCLISTENA *p)
     return OSC_listendeinit(csound, port, &p->c);
 }
 
+/* report messages lost since the last call */
+static void osc_report_dropped(CSOUND *csound, OSCLCOMMON *o)
+{
+    long n = ATOMIC_GET(o->dropped);
+    if (n != 0) {
+      ATOMIC_SUB(o->dropped, n);
+      csound->Warning(csound, Str("OSClisten: %ld messages to %s dropped, "
+                                  "queue full\n"), n, o->saved_path);
+    }
+    n = ATOMIC_GET(o->oversized);
+    if (n != 0) {
+      ATOMIC_SUB(o->oversized, n);
+      csound->Warning(csound, Str("OSClisten: %ld messages to %s dropped, "
+                                  "payload too large\n"), n, o->saved_path);
+    }
+}
+
 
 static int32_t OSC_list_init(CSOUND *csound, OSCLISTEN *p)
 {
@@ -787,250 +927,176 @@ static int32_t OSC_list_init(CSOUND *csound, OSCLISTEN *p)
         return csound->InitError(csound, "%s", Str("invalid type"));
       }
     }
-    csound->LockMutex(p->port->mutex_);
-    p->c.nxt = p->port->oplst;
-    p->port->oplst = (void*) &p->c;
-    csound->UnlockMutex(p->port->mutex_);
-    p->c.method = lo_server_thread_add_method(p->port->thread,
-                                              p->c.saved_path, p->c.saved_types,
-                                              OSC_handler, p->port);
+    osc_queue_capacity(&p->c, (char*) p->type->data, p->args, CS_KSMPS);
+    if (UNLIKELY(osc_queue_init(csound, &p->c) != OK))
+      return csound->InitError(csound, "%s",
+                               Str("OSC: failed to allocate message queue"));
+    osc_index_add(p->port->index, &p->c);
     return OK;
 }
 
 static int32_t OSC_list(CSOUND *csound, OSCLISTEN *p)
 {
-    OSC_PAT *m;
+    OSC_ARG *m;
+    long    r = p->c.rpos;
+    int32_t i;
 
+    if (UNLIKELY(p->c.dropped || p->c.oversized))
+      osc_report_dropped(csound, &p->c);
     /* quick check for empty queue */
-    if (p->c.patterns == NULL) {
+    if (r == ATOMIC_GET(p->c.wpos)) {
       *p->kans = 0;
       return OK;
     }
-    csound->LockMutex(p->port->mutex_);
-    m = p->c.patterns;
-    /* check again for thread safety */
-    if (m != NULL) {
-      int32_t i;
-      /* unlink from queue */
-      p->c.patterns = m->next;
-      /* copy arguments */
-      //printf("copying args\n");
-      for (i = 0; p->c.saved_types[i] != '\0'; i++) {
-        //printf("%d: type %c\n", i, p->c.saved_types[i]);
-        if (p->c.saved_types[i] == 's') {
-          char *src = m->args[i].string.data;
-          char *dst = ((STRINGDAT*) p->args[i])->data;
-          if (src != NULL) {
-            if (((STRINGDAT*) p->args[i])->size <= strlen(src)){
-              if (dst != NULL) csound->Free(csound, dst);
-              dst = csound->Strdup(csound, src);
-              ((STRINGDAT*) p->args[i])->size = strlen(dst) + 1;
-              ((STRINGDAT*) p->args[i])->data = dst;
-           }
+    m = &p->c.slots[r * p->c.nargs];
+    /* copy arguments */
+    //printf("copying args\n");
+    for (i = 0; p->c.saved_types[i] != '\0'; i++) {
+      //printf("%d: type %c\n", i, p->c.saved_types[i]);
+      if (p->c.saved_types[i] == 's') {
+        char *src = m[i].string.data;
+        char *dst = ((STRINGDAT*) p->args[i])->data;
+        if (src != NULL) {
+          if (((STRINGDAT*) p->args[i])->size <= (int32_t) strlen(src)){
+            if (dst != NULL) csound->Free(csound, dst);
+            dst = csound->Strdup(csound, src);
+            ((STRINGDAT*) p->args[i])->size = (int32_t) strlen(dst) + 1;
+            ((STRINGDAT*) p->args[i])->data = dst;
+          }
           else
             strcpy(dst, src);
-          }
         }
-        else if (p->c.saved_types[i]=='b') {
-          char c = p->type->data[i];
-          int32_t len =  lo_blob_datasize(m->args[i].blob);
-          //printf("blob found %p type %c\n", m->args[i].blob, c);
-          //printf("length = %d\n", lo_blob_datasize(m->args[i].blob));
-          int32_t *idata = lo_blob_dataptr(m->args[i].blob);
-          if (c == 'D') {
-            int32_t j;
-            MYFLT *data = (MYFLT *) idata;
-            ARRAYDAT* arr = (ARRAYDAT*)p->args[i];
-            int32_t asize = 1;
-            for (j=0; j < arr->dimensions; j++) {
-              asize *= arr->sizes[j];
-            }
-            len /= sizeof(MYFLT);
-            if (asize < len) {
-              arr->data = (MYFLT *)
-                csound->ReAlloc(csound, arr->data, len*sizeof(MYFLT));
-              asize = len;
-             for (j = 0; j < arr->dimensions-1; j++)
-              asize /= arr->sizes[j];
-             arr->sizes[arr->dimensions-1] = asize;
-            }
-            memcpy(arr->data,data,len*sizeof(MYFLT));
-           }
-          else if (c == 'A') {       /* Decode an numeric array */
-            int32_t j;
-            MYFLT* data = (MYFLT*)(&idata[1+idata[0]]);
-            int32_t size = 1;
-            ARRAYDAT* foo = (ARRAYDAT*)p->args[i];
-            foo->dimensions = idata[0];
-            csound->Free(csound, foo->sizes);
-            foo->sizes = (int32_t*)csound->Malloc(csound, sizeof(int32_t)*idata[0]);
+      }
+      else if (p->c.saved_types[i]=='b') {
+        char c = p->type->data[i];
+        int32_t len =  lo_blob_datasize(m[i].blob);
+        //printf("blob found %p type %c\n", m[i].blob, c);
+        //printf("length = %d\n", lo_blob_datasize(m[i].blob));
+        int32_t *idata = lo_blob_dataptr(m[i].blob);
+        if (c == 'D') {
+          int32_t j;
+          MYFLT *data = (MYFLT *) idata;
+          ARRAYDAT* arr = (ARRAYDAT*)p->args[i];
+          int32_t asize = 1;
+          for (j=0; j < arr->dimensions; j++) {
+            asize *= arr->sizes[j];
+          }
+          len /= sizeof(MYFLT);
+          if (asize < len) {
+            arr->data = (MYFLT *)
+              csound->ReAlloc(csound, arr->data, len*sizeof(MYFLT));
+            asize = len;
+           for (j = 0; j < arr->dimensions-1; j++)
+            asize /= arr->sizes[j];
+           arr->sizes[arr->dimensions-1] = asize;
+          }
+          memcpy(arr->data,data,len*sizeof(MYFLT));
+         }
+        else if (c == 'A') {       /* Decode an numeric array */
+          int32_t j;
+          MYFLT* data = (MYFLT*)(&idata[1+idata[0]]);
+          int32_t size = 1;
+          ARRAYDAT* foo = (ARRAYDAT*)p->args[i];
+          foo->dimensions = idata[0];
+          csound->Free(csound, foo->sizes);
+          foo->sizes = (int32_t*)csound->Malloc(csound, sizeof(int32_t)*idata[0]);
 #ifdef OSC_DEBUG
-            printf("dimension=%d\n", idata[0]);
+          printf("dimension=%d\n", idata[0]);
 #endif
-            for (j=0; j<idata[0]; j++) {
-              foo->sizes[j] = idata[j+1];
+          for (j=0; j<idata[0]; j++) {
+            foo->sizes[j] = idata[j+1];
 #ifdef OSC_DEBUG
-              printf("sizes[%d] = %d\n", j, idata[j+1]);
+            printf("sizes[%d] = %d\n", j, idata[j+1]);
 #endif
-              size*=idata[j+1];
-            }
+            size*=idata[j+1];
+          }
 #ifdef OSC_DEBUG
-            printf("idata = %i %i %i %i %i %i %i ...\n",
-                   idata[0], idata[1], idata[2], idata[3],
-                   idata[4], idata[5], idata[6]);
-            printf("data = %f, %f, %f...\n", data[0], data[1], data[2]);
+          printf("idata = %i %i %i %i %i %i %i ...\n",
+                 idata[0], idata[1], idata[2], idata[3],
+                 idata[4], idata[5], idata[6]);
+          printf("data = %f, %f, %f...\n", data[0], data[1], data[2]);
 #endif
-            foo->data = (MYFLT*)csound->Malloc(csound, sizeof(MYFLT)*size);
-            memcpy(foo->data, data, sizeof(MYFLT)*size);
-            //printf("data = %f %f ...\n", foo->data[0], foo->data[1]);
-          }
-          else if (c == 'a') {
+          foo->data = (MYFLT*)csound->Malloc(csound, sizeof(MYFLT)*size);
+          memcpy(foo->data, data, sizeof(MYFLT)*size);
+          //printf("data = %f %f ...\n", foo->data[0], foo->data[1]);
+        }
+        else if (c == 'a') {
 
-            MYFLT *data= (MYFLT*)idata;
-            uint32_t len = (uint32_t)data[0];
-            if (len>CS_KSMPS) len = CS_KSMPS;
-            memcpy(p->args[i], &data[1], len*sizeof(MYFLT));
+          MYFLT *data= (MYFLT*)idata;
+          uint32_t len = (uint32_t)data[0];
+          if (len>CS_KSMPS) len = CS_KSMPS;
+          memcpy(p->args[i], &data[1], len*sizeof(MYFLT));
+        }
+        else if (c == 'G') {  /* ftable received */
+          //FUNC* data = (FUNC*)idata;
+          MYFLT *data = (MYFLT *) idata;
+          int32_t fno = MYFLT2LRND(*p->args[i]);
+          FUNC *ftp;
+          if (UNLIKELY(fno <= 0))
+            return csound->PerfError(csound, &(p->h),
+                                     Str("Invalid ftable no. %d"), fno);
+
+          ftp = csound->FTFind(csound, p->args[i]);
+          if (UNLIKELY(ftp==NULL)) {
+            return csound->PerfError(csound, &(p->h),
+                                     "%s", Str("OSC internal error"));
           }
-          else if (c == 'G') {  /* ftable received */
-            //FUNC* data = (FUNC*)idata;
-            MYFLT *data = (MYFLT *) idata;
-            int32_t fno = MYFLT2LRND(*p->args[i]);
-            FUNC *ftp;
-            if (UNLIKELY(fno <= 0))
-              return csound->PerfError(csound, &(p->h),
-                                       Str("Invalid ftable no. %d"), fno);
-
-            ftp = csound->FTFind(csound, p->args[i]);
-            if (UNLIKELY(ftp==NULL)) {
-              return csound->PerfError(csound, &(p->h),
-                                       "%s", Str("OSC internal error"));
-            }
-            if (len > (int32_t)  (ftp->flen*sizeof(MYFLT)))
-              ftp->ftable = (MYFLT*)csound->ReAlloc(csound, ftp->ftable,
-                                                    len*sizeof(MYFLT));
-            memcpy(ftp->ftable,data,len);
+          if (len > (int32_t)  (ftp->flen*sizeof(MYFLT)))
+            ftp->ftable = (MYFLT*)csound->ReAlloc(csound, ftp->ftable,
+                                                  len*sizeof(MYFLT));
+          memcpy(ftp->ftable,data,len);
 
 #if 0
-            ftp = csound->FTFind(csound, p->args[i]);
-            if (UNLIKELY(ftp==NULL)) { // need to allocate ***FIXME***
-              return csound->PerfError(csound, &(p->h),
-                                       "%s", Str("OSC internal error"));
-            }
-            memcpy(ftp, data, sizeof(FUNC)-sizeof(MYFLT*));
-            ftp->fno = fno;
+          ftp = csound->FTFind(csound, p->args[i]);
+          if (UNLIKELY(ftp==NULL)) { // need to allocate ***FIXME***
+            return csound->PerfError(csound, &(p->h),
+                                     "%s", Str("OSC internal error"));
+          }
+          memcpy(ftp, data, sizeof(FUNC)-sizeof(MYFLT*));
+          ftp->fno = fno;
 #ifdef OSC_DEBUG
-            printf("%d\n", len);
+          printf("%d\n", len);
 #endif
-            if (len > ftp->flen*sizeof(MYFLT))
-              ftp->ftable =
-                (MYFLT*)csound->ReAlloc(csound, ftp->ftable,
-                                        len-sizeof(FUNC)+sizeof(MYFLT*));
+          if (len > ftp->flen*sizeof(MYFLT))
+            ftp->ftable =
+              (MYFLT*)csound->ReAlloc(csound, ftp->ftable,
+                                      len-sizeof(FUNC)+sizeof(MYFLT*));
 #endif
-            {
+          {
 #ifdef OSC_DEBUG
-              MYFLT* dst = ftp->ftable;
-              MYFLT* src = (MYFLT*)(&(data->ftable));
-
-              //int32_t j;
-              printf("copy data: from %p to %p length %d %d\n",
-                     src, dst, len-sizeof(FUNC)+sizeof(MYFLT*), data->flen);
-              printf("was %f %f %f ...\n", dst[0], dst[1], dst[2]);
-              printf("will be %f %f %f ...\n", src[0],src[1], src[2]);
-              memcpy(dst, src, len-sizeof(FUNC)+sizeof(MYFLT*));
+            MYFLT* dst = ftp->ftable;
+            MYFLT* src = (MYFLT*)(&(data->ftable));
+
+            //int32_t j;
+            printf("copy data: from %p to %p length %d %d\n",
+                   src, dst, len-sizeof(FUNC)+sizeof(MYFLT*), data->flen);
+            printf("was %f %f %f ...\n", dst[0], dst[1], dst[2]);
+            printf("will be %f %f %f ...\n", src[0],src[1], src[2]);
+            memcpy(dst, src, len-sizeof(FUNC)+sizeof(MYFLT*));
 #endif
-              //for (j=0; j<data->flen;j++) dst[j]=src[j];
-              //printf("now %f %f %f ...\n", dst[0], dst[1], dst[2]);
-            }
+            //for (j=0; j<data->flen;j++) dst[j]=src[j];
+            //printf("now %f %f %f ...\n", dst[0], dst[1], dst[2]);
           }
-          else if (c == 'S') {
-          }
-          else return csound->PerfError(csound,  &(p->h), "Oh dear");
-          csound->Free(csound, m->args[i].blob);
         }
-        else
-          *(p->args[i]) = m->args[i].number;
+        else if (c == 'S') {
+        }
+        else return csound->PerfError(csound,  &(p->h), "Oh dear");
       }
-      /* push to stack of free message structures */
-      m->next = p->c.freePatterns;
-      p->c.freePatterns = m;
-      *p->kans = 1;
+      else
+        *(p->args[i]) = m[i].number;
+    }
+    /* release the slot to the server thread */
+    ATOMIC_SET(p->c.rpos, (r + 1) % OSC_QUEUE_SIZE);
+    *p->kans = 1;
+    {
       OSC_GLOBALS *g = alloc_globals(csound);
-      csound->LockMutex(g->mutex_);
-      g->osccounter--;
-      csound->UnlockMutex(g->mutex_);
+      ATOMIC_DECR(g->osccounter);
     }
-    else
-      *p->kans = 0;
-    csound->UnlockMutex(p->port->mutex_);
     return OK;
 }
 
 /* ******** ARRAY VERSION **** EXPERIMENTAL *** */
 
-static int32_t OSC_ahandler(const char *path, const char *types,
-                       lo_arg **argv, int32_t argc, lo_message data, void *p)
-{
-    IGN(argc);  IGN(data);
-    OSC_PORT  *pp = (OSC_PORT*) p;
-    OSCLCOMMON *o;
-    CSOUND    *csound = (CSOUND *) pp->csound;
-    int32_t   retval = 1;
-    //printf("***in ahandler\n");
-    csound->LockMutex(pp->mutex_);
-    o = (OSCLCOMMON*) pp->oplst;
-    //printf("opst=%p\n", o);
-    while (o != NULL) {
-      //printf("Looking at %s/%s against %s/%s\n",
-      //       o->saved_path, path,o->saved_types, types);
-      if (strcmp(o->saved_path, path) == 0 &&
-          strcmp(o->saved_types, types) == 0) {
-        /* Message is for this guy */
-        int32_t     i;
-        OSC_PAT *m;
-        OSC_GLOBALS *g = alloc_globals(csound);
-        csound->LockMutex(g->mutex_);
-        g->osccounter++;
-        csound->UnlockMutex(g->mutex_);
-        //printf("handler found message\n");
-        m = get_pattern(csound, o);
-        if (m != NULL) {
-          /* queue message for being read by OSClisten opcode */
-          m->next = NULL;
-          if (o->patterns == NULL)
-            o->patterns = m;
-          else {
-            OSC_PAT *mm;
-            for (mm = o->patterns; mm->next != NULL; mm = mm->next)
-              ;
-            mm->next = m;
-          }
-          /* copy argument list */
-          for (i = 0; o->saved_types[i] != '\0'; i++) {
-            switch (types[i]) {
-            default:              /* Should not happen */
-            case 'i':
-              m->args[i].number = (MYFLT) argv[i]->i; break;
-            case 'h':
-              m->args[i].number = (MYFLT) argv[i]->i64; break;
-            case 'c':
-              m->args[i].number= (MYFLT) argv[i]->c; break;
-            case 'f':
-              m->args[i].number = (MYFLT) argv[i]->f; break;
-            case 'd':
-              m->args[i].number= (MYFLT) argv[i]->d; break;
-            }
-          }
-          retval = 0;
-        }
-        break;
-      }
-      o = (OSCLCOMMON*) o->nxt;
-    }
-
-    pp->csound->UnlockMutex(pp->mutex_);
-    return retval;
-}
-
 #include "arrays.h"
 
 static int32_t OSC_alist_init(CSOUND *csound, OSCLISTENA *p)
@@ -1065,49 +1131,38 @@ static int32_t OSC_alist_init(CSOUND *csound, OSCLISTENA *p)
         return csound->InitError(csound, "%s", Str("invalid type"));
       }
     }
-    csound->LockMutex(p->port->mutex_);
-    p->c.nxt = p->port->oplst;
-    p->port->oplst = (void*) &p->c;
-    csound->UnlockMutex(p->port->mutex_);
-    p->c.method = lo_server_thread_add_method(p->port->thread,
-                                              p->c.saved_path, p->c.saved_types,
-                                              OSC_ahandler, p->port);
+    osc_queue_capacity(&p->c, (char*) p->type->data, NULL, CS_KSMPS);
+    if (UNLIKELY(osc_queue_init(csound, &p->c) != OK))
+      return csound->InitError(csound, "%s",
+                               Str("OSC: failed to allocate message queue"));
+    osc_index_add(p->port->index, &p->c);
     return OK;
 }
 
 static int32_t OSC_alist(CSOUND *csound, OSCLISTENA *p)
 {
-    OSC_PAT *m;
+    OSC_ARG *m;
+    long    r = p->c.rpos;
+    int32_t i;
+
+    if (UNLIKELY(p->c.dropped || p->c.oversized))
+      osc_report_dropped(csound, &p->c);
     /* quick check for empty queue */
-    if (p->c.patterns == NULL) {
+    if (r == ATOMIC_GET(p->c.wpos)) {
       *p->kans = 0;
       return OK;
     }
-    csound->LockMutex(p->port->mutex_);
-    m = p->c.patterns;
-    /* check again for thread safety */
-    if (m != NULL) {
-      int32_t i;
-      /* unlink from queue */
-      p->c.patterns = m->next;
-      /* copy arguments */
-      //printf("copying args\n");
-      for (i = 0; p->c.saved_types[i] != '\0'; i++) {
-        //printf("%d: type %c\n", i, p->c.saved_types[i]);
-        ((MYFLT*)p->args->data)[i] = m->args[i].number;
-      }
-      /* push to stack of free message structures */
-      m->next = p->c.freePatterns;
-      p->c.freePatterns = m;
-      *p->kans = 1;
+    m = &p->c.slots[r * p->c.nargs];
+    /* copy arguments */
+    for (i = 0; p->c.saved_types[i] != '\0'; i++)
+      ((MYFLT*)p->args->data)[i] = m[i].number;
+    /* release the slot to the server thread */
+    ATOMIC_SET(p->c.rpos, (r + 1) % OSC_QUEUE_SIZE);
+    *p->kans = 1;
+    {
       OSC_GLOBALS *g = alloc_globals(csound);
-      csound->LockMutex(g->mutex_);
-      g->osccounter--;
-      csound->UnlockMutex(g->mutex_);
+      ATOMIC_DECR(g->osccounter);
     }
-    else
-      *p->kans = 0;
-    csound->UnlockMutex(p->port->mutex_);
     return OK;
 }
 
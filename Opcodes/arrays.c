@@ -3441,6 +3441,12 @@ static uint32_t isPowerOfTwo (uint32_t x) {
   return x != 0  ? !(x & (x - 1)) : 0;
 }
 
+/* hands back the FFT setups an opcode asked for at init */
+static int32_t fft_deinit(CSOUND *csound, void *p) {
+  csound->ReleaseFFTSetups(csound, (OPDS *) p);
+  return OK;
+}
+
 
 int32_t init_rfft(CSOUND *csound, FFT *p) {
   int32_t   N = p->in->sizes[0];
@@ -3448,7 +3454,7 @@ int32_t init_rfft(CSOUND *csound, FFT *p) {
     return csound->InitError(csound, "%s",
                              Str("rfft: only one-dimensional arrays allowed"));
   tabinit(csound, p->out,N, p->h.insdshead);
-  p->setup = csound->RealFFTSetup(csound, N, FFT_FWD);
+  p->setup = csound->RealFFTSetupFor(csound, N, FFT_FWD, &p->h);
   return OK;
 }
 
@@ -3470,7 +3476,7 @@ int32_t init_rifft(CSOUND *csound, FFT *p) {
   if (UNLIKELY(p->in->dimensions > 1))
     return csound->InitError(csound, "%s",
                              Str("rifft: only one-dimensional arrays allowed"));
-  p->setup = csound->RealFFTSetup(csound, N, FFT_INV);
+  p->setup = csound->RealFFTSetupFor(csound, N, FFT_INV, &p->h);
   tabinit(csound, p->out, N, p->h.insdshead);
   return OK;
 }
@@ -3769,7 +3775,7 @@ typedef struct _pvsceps {
 int32_t pvsceps_init(CSOUND *csound, PVSCEPS *p) {
   int32_t N = p->fin->N;
   if (LIKELY(isPowerOfTwo(N))) {
-    p->setup = csound->RealFFTSetup(csound, N/2, FFT_FWD);
+    p->setup = csound->RealFFTSetupFor(csound, N/2, FFT_FWD, &p->h);
     tabinit(csound, p->out, N/2+1, p->h.insdshead);
   }
   else
@@ -3809,7 +3815,7 @@ int32_t init_ceps(CSOUND *csound, FFT *p) {
     return csound->InitError(csound, "%s",
                              Str("FFT size too small (min 64 samples)\n"));
   if (LIKELY(isPowerOfTwo(N))) {
-    p->setup = csound->RealFFTSetup(csound, N, FFT_FWD);
+    p->setup = csound->RealFFTSetupFor(csound, N, FFT_FWD, &p->h);
     tabinit(csound, p->out, N+1, p->h.insdshead);
   }
   else
@@ -3841,7 +3847,7 @@ int32_t perf_ceps(CSOUND *csound, FFT *p) {
 int32_t init_iceps(CSOUND *csound, FFT *p) {
   int32_t N = p->in->sizes[0]-1;
   if (LIKELY(isPowerOfTwo(N))) {
-    p->setup = csound->RealFFTSetup(csound, N, FFT_INV);
+    p->setup = csound->RealFFTSetupFor(csound, N, FFT_INV, &p->h);
     tabinit(csound, p->out, N+1, p->h.insdshead);
   }
   else
@@ -4272,7 +4278,7 @@ int32_t init_dct(CSOUND *csound, FFT *p) {
       return csound->InitError(csound, "%s",
                                Str("dct: only one-dimensional arrays allowed"));
     tabinit(csound, p->out, N, p->h.insdshead);
-    p->setup =  csound->DCTSetup(csound,N,FFT_FWD);
+    p->setup =  csound->DCTSetupFor(csound,N,FFT_FWD,&p->h);
     return OK;
   }
   else return
@@ -4302,7 +4308,7 @@ int32_t init_dctinv(CSOUND *csound, FFT *p) {
       return csound->InitError(csound, "%s",
                                Str("dctinv: only one-dimensional arrays allowed"));
     tabinit(csound, p->out, N, p->h.insdshead);
-    p->setup =  csound->DCTSetup(csound,N,FFT_INV);
+    p->setup =  csound->DCTSetupFor(csound,N,FFT_INV,&p->h);
     return OK;
   }
   else
@@ -4875,13 +4881,13 @@ static OENTRY arrayvars_localops[] =
     { "monitor.A", sizeof(OUTA), IB, "a[]", "",
       (SUBR)monitora_init, (SUBR)monitora_perf},
     { "rfft", sizeof(FFT), 0, "k[]","k[]",
-      (SUBR) init_rfft, (SUBR) perf_rfft, NULL},
+      (SUBR) init_rfft, (SUBR) perf_rfft, (SUBR) fft_deinit},
     {"rfft", sizeof(FFT), 0, "i[]","i[]",
-     (SUBR) rfft_i, NULL, NULL},
+     (SUBR) rfft_i, NULL, (SUBR) fft_deinit},
     {"rifft", sizeof(FFT), 0, "k[]","k[]",
-     (SUBR) init_rifft, (SUBR) perf_rifft, NULL},
+     (SUBR) init_rifft, (SUBR) perf_rifft, (SUBR) fft_deinit},
     {"rifft", sizeof(FFT), 0, "i[]","i[]",
-     (SUBR) rifft_i, NULL, NULL},
+     (SUBR) rifft_i, NULL, (SUBR) fft_deinit},
     {"cmplxprod", sizeof(FFT), 0, "k[]","k[]k[]",
      (SUBR) init_rfftmult, (SUBR) perf_rfftmult, NULL},
     {"fft", sizeof(FFT), 0, "k[]","k[]",
@@ -4917,11 +4923,11 @@ static OENTRY arrayvars_localops[] =
     {"window", sizeof(FFT), 0, "k[]","k[]Op",
      (SUBR) init_window, (SUBR) perf_window, NULL},
     {"pvsceps", sizeof(PVSCEPS), 0, "k[]","fo",
-     (SUBR) pvsceps_init, (SUBR) pvsceps_perf, NULL},
+     (SUBR) pvsceps_init, (SUBR) pvsceps_perf, (SUBR) fft_deinit},
     {"cepsinv", sizeof(FFT), 0, "k[]","k[]",
-     (SUBR) init_iceps, (SUBR) perf_iceps, NULL},
+     (SUBR) init_iceps, (SUBR) perf_iceps, (SUBR) fft_deinit},
     {"ceps", sizeof(FFT), 0, "k[]","k[]k",
-     (SUBR) init_ceps, (SUBR) perf_ceps, NULL},
+     (SUBR) init_ceps, (SUBR) perf_ceps, (SUBR) fft_deinit},
     {"getrow", sizeof(FFT), 0, "i[]","i[]i",
      (SUBR) rows_i, NULL, NULL},
     {"getrow.S", sizeof(FFT), 0, "S[]","S[]k",
@@ -4955,13 +4961,13 @@ static OENTRY arrayvars_localops[] =
     {"=.X", sizeof(TABCOPY), 0, "k[]","k", (SUBR) scalarset, (SUBR) scalarset},
     {"=.Z", sizeof(TABCOPY), 0 , "a[]", "a", NULL, (SUBR) arrayass},
     {"dct", sizeof(FFT), 0, "k[]","k[]",
-     (SUBR) init_dct, (SUBR) kdct, NULL},
+     (SUBR) init_dct, (SUBR) kdct, (SUBR) fft_deinit},
     {"dct", sizeof(FFT), 0, "i[]","i[]",
-     (SUBR) dct, NULL, NULL},
+     (SUBR) dct, NULL, (SUBR) fft_deinit},
     {"dctinv", sizeof(FFT), 0, "k[]","k[]",
-     (SUBR) init_dctinv, (SUBR) kdct, NULL},
+     (SUBR) init_dctinv, (SUBR) kdct, (SUBR) fft_deinit},
     {"dctinv", sizeof(FFT), 0, "i[]","i[]",
-     (SUBR)dctinv, NULL, NULL},
+     (SUBR)dctinv, NULL, (SUBR) fft_deinit},
     {"mfb", sizeof(MFB), 0, "k[]","k[]kki",
      (SUBR) mfb_init, (SUBR) mfb, NULL},
     {"mfb", sizeof(MFB), 0, "i[]","i[]iii",
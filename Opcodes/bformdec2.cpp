@@ -158,7 +158,7 @@ class hrtf {
   hrtf() {}
   virtual ~hrtf() {}
   virtual void init(void) = 0;
-  virtual int32_t hrtfstat_init(CSOUND *csound, MYFLT elev, MYFLT angle, MYFLT radius, STRINGDAT *filel, STRINGDAT *filer, MYFLT srxl) = 0;
+  virtual int32_t hrtfstat_init(CSOUND *csound, OPDS *owner, MYFLT elev, MYFLT angle, MYFLT radius, STRINGDAT *filel, STRINGDAT *filer, MYFLT srxl) = 0;
   virtual int32_t hrtfstat_process(CSOUND *csound, MYFLT *in, MYFLT *outsigl, MYFLT *outsigr, uint32_t offset, uint32_t early, uint32_t nsmps) = 0;
 };
 
@@ -210,7 +210,7 @@ public:
   }
 
   /* HRTF functions (adapted from csound/Opcodes/hrtfopcodes.c) */
-  virtual int32_t hrtfstat_init(CSOUND *csound,
+  virtual int32_t hrtfstat_init(CSOUND *csound, OPDS *owner,
                                 MYFLT elev, MYFLT angle, MYFLT r, STRINGDAT *ifilel, STRINGDAT *ifiler,
                                 MYFLT sr)
   {
@@ -678,10 +678,13 @@ public:
           hrtfrfloat[i+1] = magr * SIN(phaser);
         }
 
-       setup_pad = csound->RealFFTSetup(csound, irlengthpad_p, FFT_FWD);
-       setup = csound->RealFFTSetup(csound, irlength_p, FFT_FWD);
-       isetup_pad = csound->RealFFTSetup(csound, irlengthpad_p, FFT_INV);
-       isetup = csound->RealFFTSetup(csound, irlength_p, FFT_INV);
+       /* the decoder's instances run in turn, so they share its setups */
+       setup_pad =
+         csound->RealFFTSetupFor(csound, irlengthpad_p, FFT_FWD, owner);
+       setup = csound->RealFFTSetupFor(csound, irlength_p, FFT_FWD, owner);
+       isetup_pad =
+         csound->RealFFTSetupFor(csound, irlengthpad_p, FFT_INV, owner);
+       isetup = csound->RealFFTSetupFor(csound, irlength_p, FFT_INV, owner);
 
       /* ifft */
       csound->RealFFT(csound, isetup, hrtflfloat);
@@ -1681,7 +1684,7 @@ static int32_t ihoambdec(CSOUND *csound, HOAMBDEC* p)
           csound->AuxAlloc(csound, sizeof(hrtf_c), &p->binaural_mem[j]);
         p->binaural[j] = new (p->binaural_mem[j].auxp) hrtf_c;
 
-        p->binaural[j]->hrtfstat_init(csound, elev, angle[j], r, p->ifilel, p->ifiler, CS_ESR);
+        p->binaural[j]->hrtfstat_init(csound, &p->h, elev, angle[j], r, p->ifilel, p->ifiler, CS_ESR);
       }
     }
 
@@ -1700,7 +1703,7 @@ static int32_t ihoambdec(CSOUND *csound, HOAMBDEC* p)
         if (p->binaural_mem[j].auxp == NULL)
           csound->AuxAlloc(csound, sizeof(hrtf_c), &p->binaural_mem[j]);
         p->binaural[j] = new (p->binaural_mem[j].auxp) hrtf_c;
-        p->binaural[j]->hrtfstat_init(csound, elev[j], angle[j], r, p->ifilel, p->ifiler, CS_ESR);
+        p->binaural[j]->hrtfstat_init(csound, &p->h, elev[j], angle[j], r, p->ifilel, p->ifiler, CS_ESR);
       }
     }
 
@@ -1724,6 +1727,13 @@ static int32_t ihoambdec(CSOUND *csound, HOAMBDEC* p)
 }
 
 
+/* hands back the FFT setups of the binaural decoders */
+static int32_t hoambdec_deinit(CSOUND *csound, HOAMBDEC* p)
+{
+    csound->ReleaseFFTSetups(csound, &p->h);
+    return OK;
+}
+
 /* hoambdec process routine */
 static int32_t ahoambdec(CSOUND *csound, HOAMBDEC* p)
 {
@@ -2164,7 +2174,7 @@ static void process_nfc(CSOUND *csound, HOAMBDEC* p, int32_t signal_order, int32
 extern "C" {
 static OENTRY bformdec2_localops[] = {
   { (char*) "bformdec2.A", S(HOAMBDEC), 0, (char*) "a[]", (char*) "ia[]ooooNN",
-    (SUBR)ihoambdec, (SUBR)ahoambdec },
+    (SUBR)ihoambdec, (SUBR)ahoambdec, (SUBR)hoambdec_deinit },
 };
 
 LINKAGE_BUILTIN(bformdec2_localops)
@@ -0,0 +1,98 @@
+/*
+    fdn.h: delay line banks for feedback delay network reverbs
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#ifndef CSOUND_FDN_H
+#define CSOUND_FDN_H
+
+/* The lines of a bank are the lanes of its vectors.  Writes, and reads
+   that are a whole line length behind them, move a block of samples at
+   a time between the lines and a lane-major block, blk[k][l] being
+   sample k of line l, so that the filters of all lines can step
+   through the block together.  A reverb whose reads trail its writes
+   by at least FDN_BLOCK samples can compute a block from what was
+   written before it.                                                   */
+
+#define FDN_LINES   16          /* lines of a bank at most */
+#define FDN_BLOCK   16          /* samples of a block */
+
+typedef struct {
+    int32_t nlines;
+    MYFLT   *buf[FDN_LINES];
+    int32_t size[FDN_LINES];
+    int32_t pos[FDN_LINES];     /* write position */
+    double  state[FDN_LINES];   /* of the filter in each line's loop */
+} FDN;
+
+/* bytes for a line of size samples, keeping the next one aligned */
+static inline size_t fdn_line_bytes(int32_t size)
+{
+    return ((size_t) size * sizeof(MYFLT) + 15) & ~((size_t) 15);
+}
+
+/* place line l at mem and clear it */
+static inline void fdn_line_init(FDN *f, int32_t l, void *mem, int32_t size)
+{
+    f->buf[l] = (MYFLT*) mem;
+    f->size[l] = size;
+    f->pos[l] = 0;
+    f->state[l] = 0.0;
+    memset(mem, 0, (size_t) size * sizeof(MYFLT));
+}
+
+/* samples, up to n and FDN_BLOCK, before a write position wraps */
+static inline uint32_t fdn_span(const FDN *f, uint32_t n)
+{
+    int32_t l;
+    if (n > FDN_BLOCK)
+      n = FDN_BLOCK;
+    for (l = 0; l < f->nlines; l++)
+      if ((uint32_t) (f->size[l] - f->pos[l]) < n)
+        n = (uint32_t) (f->size[l] - f->pos[l]);
+    return n;
+}
+
+/* the len samples each line wrote a line length ago */
+static inline void fdn_read(const FDN *f, MYFLT blk[][FDN_LINES], uint32_t len)
+{
+    int32_t  l;
+    uint32_t k;
+    for (l = 0; l < f->nlines; l++) {
+      const MYFLT *b = f->buf[l] + f->pos[l];
+      for (k = 0; k < len; k++)
+        blk[k][l] = b[k];
+    }
+}
+
+/* write len samples to each line and move on */
+static inline void fdn_write(FDN *f, MYFLT blk[][FDN_LINES], uint32_t len)
+{
+    int32_t  l;
+    uint32_t k;
+    for (l = 0; l < f->nlines; l++) {
+      MYFLT *b = f->buf[l] + f->pos[l];
+      for (k = 0; k < len; k++)
+        b[k] = blk[k][l];
+      if ((f->pos[l] += len) >= f->size[l])
+        f->pos[l] = 0;
+    }
+}
+
+#endif  /* CSOUND_FDN_H */
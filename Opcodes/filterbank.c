@@ -0,0 +1,581 @@
+/*
+    filterbank.c: banks and cascades of second order sections
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* One opcode runs a whole bank of filters whose frequencies, Qs and
+   gains come in k-rate arrays:
+
+     asum  bqbank    ain, kfreqs[], kqs[], kgains[]
+     aouts[] bqbank  ain, kfreqs[], kqs[]
+     asum  svfbank   ain, kfreqs[], kqs[], kgains[] [, imode]
+     aouts[] svfbank ain, kfreqs[], kqs[] [, imode]
+     aout  bqcascade ain, kfreqs[], kqs[], kdbs[] [, ishelf]
+
+   bqbank is a bank of constant peak gain bandpass biquads, svfbank one of
+   state variable filters giving their bandpass (imode 0, normalised to
+   unity peak gain), lowpass (1) or highpass (2) output.  The sections of
+   a bank are independent, so they are stored structure of arrays and
+   FBANK_LANES of them are stepped through each sample side by side.
+   Gains glide across a cycle.
+
+   bqcascade puts peaking equalisers in series, the first and last being
+   shelves when ishelf is non-zero.  The sections are in transposed
+   direct form II and their coefficients glide from the old to the new
+   values across a cycle in which they change; the stability region of
+   a second order section is convex, so every filter on the way is stable
+   too.                                                                   */
+
+#include "stdopcod.h"
+#include "arrays.h"
+#include <math.h>
+
+#define FBANK_LANES 16          /* sections stepped side by side */
+
+typedef struct {
+    int32_t nsect;              /* sections */
+    int32_t nlanes;             /* and rounded up to whole lane groups */
+    AUXCH   auxch;
+    /* biquads keep their coefficients in b0 to a2; state variable
+       filters keep g in b0, 2R in b1 and 1/(1 + 2Rg + g^2) in b2 */
+    double  *b0, *b1, *b2, *a1, *a2;
+    double  *z1, *z2;           /* state */
+    double  *gain, *freq, *q;   /* the values last seen */
+    void    *blk;               /* lane block, double [ksmps][FBANK_LANES] */
+} FBANK_SECT;
+
+typedef struct {
+    OPDS    h;
+    MYFLT   *out, *in;
+    ARRAYDAT *freqs, *qs, *gains;
+    MYFLT   *imode;
+    FBANK_SECT s;
+} FBANK;
+
+typedef struct {
+    OPDS    h;
+    ARRAYDAT *outs;
+    MYFLT   *in;
+    ARRAYDAT *freqs, *qs;
+    MYFLT   *imode;
+    FBANK_SECT s;
+} FBANKA;
+
+static int32_t fbank_alloc(CSOUND *csound, OPDS *h, FBANK_SECT *s,
+                           ARRAYDAT *freqs, ARRAYDAT *qs, ARRAYDAT *gains)
+{
+    int32_t n, nl, l;
+    double  *d;
+    if (UNLIKELY(freqs->data == NULL || freqs->dimensions != 1 ||
+                 qs->data == NULL || qs->dimensions != 1 ||
+                 (gains != NULL &&
+                  (gains->data == NULL || gains->dimensions != 1))))
+      return csound->InitError(csound, Str("%s: arrays not initialised"),
+                               h->optext->t.opcod);
+    n = freqs->sizes[0];
+    if (UNLIKELY(n < 1 || qs->sizes[0] < n ||
+                 (gains != NULL && gains->sizes[0] < n)))
+      return csound->InitError(csound, Str("%s: %d sections but fewer "
+                                           "values for some of them"),
+                               h->optext->t.opcod, n);
+    nl = (n + FBANK_LANES - 1) / FBANK_LANES * FBANK_LANES;
+    csound->AuxAlloc(csound, ((size_t) nl * 10 +
+                              (size_t) h->insdshead->ksmps * FBANK_LANES)
+                     * sizeof(double), &s->auxch);
+    d = (double*) s->auxch.auxp;
+    s->b0 = d;          s->b1 = d + nl;     s->b2 = d + 2 * nl;
+    s->a1 = d + 3 * nl; s->a2 = d + 4 * nl; s->z1 = d + 5 * nl;
+    s->z2 = d + 6 * nl; s->gain = d + 7 * nl;
+    s->freq = d + 8 * nl; s->q = d + 9 * nl;
+    s->blk = d + 10 * nl;
+    for (l = 0; l < n; l++)
+      s->gain[l] = (gains != NULL ? (double) gains->data[l] : 1.0);
+    s->nsect = n;
+    s->nlanes = nl;
+    return OK;
+}
+
+static int32_t fbank_check(CSOUND *csound, OPDS *h, const FBANK_SECT *s,
+                           const ARRAYDAT *freqs, const ARRAYDAT *qs,
+                           const ARRAYDAT *gains)
+{
+    if (UNLIKELY(freqs->sizes[0] < s->nsect || qs->sizes[0] < s->nsect ||
+                 (gains != NULL && gains->sizes[0] < s->nsect)))
+      return csound->PerfError(csound, h, Str("%s: arrays shrank below "
+                                              "%d sections"),
+                               h->optext->t.opcod, s->nsect);
+    return OK;
+}
+
+static inline double clamp_freq(MYFLT f, double sr)
+{
+    return (f < FL(1.0) ? 1.0 : f > 0.49 * sr ? 0.49 * sr : (double) f);
+}
+
+static inline double clamp_q(MYFLT q)
+{
+    return (q < FL(0.001) ? 0.001 : (double) q);
+}
+
+/* bandpass of constant peak gain, from the cookbook of R. Bristow-Johnson;
+   only sections whose values changed are recomputed unless all is set */
+static void bandpass_coefs(FBANK_SECT *s, const MYFLT *freqs,
+                           const MYFLT *qs, double sr, int32_t all)
+{
+    int32_t l;
+    for (l = 0; l < s->nsect; l++) {
+      double w, alpha, a0;
+      if (!all && freqs[l] == s->freq[l] && qs[l] == s->q[l])
+        continue;
+      s->freq[l] = freqs[l];
+      s->q[l] = qs[l];
+      w = TWOPI * clamp_freq(freqs[l], sr) / sr;
+      alpha = sin(w) / (2.0 * clamp_q(qs[l]));
+      a0 = 1.0 / (1.0 + alpha);
+      s->b0[l] = alpha * a0;
+      s->b1[l] = 0.0;
+      s->b2[l] = -alpha * a0;
+      s->a1[l] = -2.0 * cos(w) * a0;
+      s->a2[l] = (1.0 - alpha) * a0;
+    }
+}
+
+/* topology preserving state variable filter, after V. Zavalishin */
+static void svf_coefs(FBANK_SECT *s, const MYFLT *freqs,
+                      const MYFLT *qs, double sr, int32_t all)
+{
+    int32_t l;
+    for (l = 0; l < s->nsect; l++) {
+      double g, r2;
+      if (!all && freqs[l] == s->freq[l] && qs[l] == s->q[l])
+        continue;
+      s->freq[l] = freqs[l];
+      s->q[l] = qs[l];
+      g = tan(PI * clamp_freq(freqs[l], sr) / sr);
+      r2 = 1.0 / clamp_q(qs[l]);
+      s->b0[l] = g;
+      s->b1[l] = r2;
+      s->b2[l] = 1.0 / (1.0 + r2 * g + g * g);
+    }
+}
+
+/* Run lane group base of a bank over in[offset..nsmps-1] into a lane
+   block, blk[k][l] being sample k of the group's section l, which is
+   added to when acc is set.  The group's coefficients and state are
+   copied into locals so that the lane loops can be vectorised.         */
+static void biquad_lanes(FBANK_SECT *s, int32_t base, const MYFLT *in,
+                         const MYFLT *gains, uint32_t offset, uint32_t nsmps,
+                         int32_t acc)
+{
+    double   b0[FBANK_LANES], b1[FBANK_LANES], b2[FBANK_LANES];
+    double   a1[FBANK_LANES], a2[FBANK_LANES];
+    double   z1[FBANK_LANES], z2[FBANK_LANES];
+    double   g[FBANK_LANES], dg[FBANK_LANES];
+    double   (*blk)[FBANK_LANES] = s->blk;
+    double   rn = 1.0 / (double) (nsmps - offset);
+    int32_t  l, nl = s->nsect - base;
+    uint32_t k;
+    if (nl > FBANK_LANES)
+      nl = FBANK_LANES;
+    for (l = 0; l < FBANK_LANES; l++) {
+      b0[l] = s->b0[base + l]; b1[l] = s->b1[base + l];
+      b2[l] = s->b2[base + l]; a1[l] = s->a1[base + l];
+      a2[l] = s->a2[base + l]; z1[l] = s->z1[base + l];
+      z2[l] = s->z2[base + l]; g[l] = s->gain[base + l];
+      dg[l] = (l < nl && gains != NULL ?
+               ((double) gains[base + l] - g[l]) * rn : 0.0);
+    }
+    for (k = offset; k < nsmps; k++) {
+      double x = (double) in[k];
+      for (l = 0; l < FBANK_LANES; l++) {
+        double y = b0[l] * x + z1[l];
+        z1[l] = b1[l] * x - a1[l] * y + z2[l];
+        z2[l] = b2[l] * x - a2[l] * y;
+        g[l] += dg[l];
+        blk[k][l] = (acc ? blk[k][l] : 0.0) + y * g[l];
+      }
+    }
+    for (l = 0; l < nl; l++) {
+      s->z1[base + l] = z1[l];
+      s->z2[base + l] = z2[l];
+      if (gains != NULL)
+        s->gain[base + l] = (double) gains[base + l];
+    }
+}
+
+static void svf_lanes(FBANK_SECT *s, int32_t base, int32_t mode,
+                      const MYFLT *in, const MYFLT *gains, uint32_t offset,
+                      uint32_t nsmps, int32_t acc)
+{
+    double   gg[FBANK_LANES], r2[FBANK_LANES], h[FBANK_LANES];
+    double   s1[FBANK_LANES], s2[FBANK_LANES];
+    double   mb[FBANK_LANES], g[FBANK_LANES], dg[FBANK_LANES];
+    double   (*blk)[FBANK_LANES] = s->blk;
+    double   ml = (mode == 1 ? 1.0 : 0.0), mh = (mode == 2 ? 1.0 : 0.0);
+    double   rn = 1.0 / (double) (nsmps - offset);
+    int32_t  l, nl = s->nsect - base;
+    uint32_t k;
+    if (nl > FBANK_LANES)
+      nl = FBANK_LANES;
+    for (l = 0; l < FBANK_LANES; l++) {
+      gg[l] = s->b0[base + l]; r2[l] = s->b1[base + l];
+      h[l] = s->b2[base + l];  s1[l] = s->z1[base + l];
+      s2[l] = s->z2[base + l]; g[l] = s->gain[base + l];
+      mb[l] = (mode == 0 ? r2[l] : 0.0);
+      dg[l] = (l < nl && gains != NULL ?
+               ((double) gains[base + l] - g[l]) * rn : 0.0);
+    }
+    for (k = offset; k < nsmps; k++) {
+      double x = (double) in[k];
+      for (l = 0; l < FBANK_LANES; l++) {
+        double hp = (x - (r2[l] + gg[l]) * s1[l] - s2[l]) * h[l];
+        double v1 = gg[l] * hp, bp = v1 + s1[l], v2, lp;
+        s1[l] = bp + v1;
+        v2 = gg[l] * bp;
+        lp = v2 + s2[l];
+        s2[l] = lp + v2;
+        g[l] += dg[l];
+        blk[k][l] = (acc ? blk[k][l] : 0.0) +
+          (mb[l] * bp + ml * lp + mh * hp) * g[l];
+      }
+    }
+    for (l = 0; l < nl; l++) {
+      s->z1[base + l] = s1[l];
+      s->z2[base + l] = s2[l];
+      if (gains != NULL)
+        s->gain[base + l] = (double) gains[base + l];
+    }
+}
+
+/* the sum of the lanes of the block */
+static void lanes_sum(const FBANK_SECT *s, MYFLT *out, uint32_t offset,
+                      uint32_t nsmps)
+{
+    double   (*blk)[FBANK_LANES] = s->blk;
+    uint32_t k;
+    int32_t  l;
+    for (k = offset; k < nsmps; k++) {
+      double acc = 0.0;
+      for (l = 0; l < FBANK_LANES; l++)
+        acc += blk[k][l];
+      out[k] = (MYFLT) acc;
+    }
+}
+
+/* the lanes of the block to the outputs of sections base onwards */
+static void lanes_out(const FBANK_SECT *s, int32_t base, MYFLT *outs,
+                      uint32_t offset, uint32_t nsmps, uint32_t ksmps)
+{
+    double   (*blk)[FBANK_LANES] = s->blk;
+    uint32_t k;
+    int32_t  l, nl = s->nsect - base;
+    if (nl > FBANK_LANES)
+      nl = FBANK_LANES;
+    for (l = 0; l < nl; l++) {
+      MYFLT *o = outs + (base + l) * ksmps;
+      for (k = offset; k < nsmps; k++)
+        o[k] = (MYFLT) blk[k][l];
+    }
+}
+
+static int32_t svf_mode(CSOUND *csound, OPDS *h, MYFLT *imode)
+{
+    int32_t mode = (int32_t) MYFLT2LRND(*imode);
+    if (UNLIKELY(mode < 0 || mode > 2))
+      return csound->InitError(csound, Str("%s: unknown mode %d"),
+                               h->optext->t.opcod, mode);
+    return OK;
+}
+
+static int32_t bqbank_init(CSOUND *csound, FBANK *p)
+{
+    if (UNLIKELY(fbank_alloc(csound, &p->h, &p->s, p->freqs, p->qs,
+                             p->gains) != OK))
+      return NOTOK;
+    bandpass_coefs(&p->s, p->freqs->data, p->qs->data, CS_ESR, 1);
+    return OK;
+}
+
+static int32_t bqbanka_init(CSOUND *csound, FBANKA *p)
+{
+    if (UNLIKELY(fbank_alloc(csound, &p->h, &p->s, p->freqs, p->qs,
+                             NULL) != OK))
+      return NOTOK;
+    tabinit(csound, p->outs, p->s.nsect, p->h.insdshead);
+    bandpass_coefs(&p->s, p->freqs->data, p->qs->data, CS_ESR, 1);
+    return OK;
+}
+
+static int32_t svfbank_init(CSOUND *csound, FBANK *p)
+{
+    if (UNLIKELY(svf_mode(csound, &p->h, p->imode) != OK ||
+                 fbank_alloc(csound, &p->h, &p->s, p->freqs, p->qs,
+                             p->gains) != OK))
+      return NOTOK;
+    svf_coefs(&p->s, p->freqs->data, p->qs->data, CS_ESR, 1);
+    return OK;
+}
+
+static int32_t svfbanka_init(CSOUND *csound, FBANKA *p)
+{
+    if (UNLIKELY(svf_mode(csound, &p->h, p->imode) != OK ||
+                 fbank_alloc(csound, &p->h, &p->s, p->freqs, p->qs,
+                             NULL) != OK))
+      return NOTOK;
+    tabinit(csound, p->outs, p->s.nsect, p->h.insdshead);
+    svf_coefs(&p->s, p->freqs->data, p->qs->data, CS_ESR, 1);
+    return OK;
+}
+
+static int32_t bqbank_perf(CSOUND *csound, FBANK *p)
+{
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t nsmps = CS_KSMPS;
+    int32_t  base;
+    if (UNLIKELY(fbank_check(csound, &p->h, &p->s, p->freqs, p->qs,
+                             p->gains) != OK))
+      return NOTOK;
+    bandpass_coefs(&p->s, p->freqs->data, p->qs->data, CS_ESR, 0);
+    memset(p->out, '\0', nsmps * sizeof(MYFLT));
+    if (UNLIKELY(early)) nsmps -= early;
+    if (UNLIKELY(offset >= nsmps)) return OK;
+    for (base = 0; base < p->s.nsect; base += FBANK_LANES)
+      biquad_lanes(&p->s, base, p->in, p->gains->data, offset, nsmps,
+                   base > 0);
+    lanes_sum(&p->s, p->out, offset, nsmps);
+    return OK;
+}
+
+static int32_t bqbanka_perf(CSOUND *csound, FBANKA *p)
+{
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t ksmps = CS_KSMPS, nsmps = ksmps;
+    int32_t  base;
+    if (UNLIKELY(fbank_check(csound, &p->h, &p->s, p->freqs, p->qs,
+                             NULL) != OK))
+      return NOTOK;
+    bandpass_coefs(&p->s, p->freqs->data, p->qs->data, CS_ESR, 0);
+    memset(p->outs->data, '\0', p->s.nsect * ksmps * sizeof(MYFLT));
+    if (UNLIKELY(early)) nsmps -= early;
+    if (UNLIKELY(offset >= nsmps)) return OK;
+    for (base = 0; base < p->s.nsect; base += FBANK_LANES) {
+      biquad_lanes(&p->s, base, p->in, NULL, offset, nsmps, 0);
+      lanes_out(&p->s, base, p->outs->data, offset, nsmps, ksmps);
+    }
+    return OK;
+}
+
+static int32_t svfbank_perf(CSOUND *csound, FBANK *p)
+{
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t nsmps = CS_KSMPS;
+    int32_t  base, mode = (int32_t) MYFLT2LRND(*p->imode);
+    if (UNLIKELY(fbank_check(csound, &p->h, &p->s, p->freqs, p->qs,
+                             p->gains) != OK))
+      return NOTOK;
+    svf_coefs(&p->s, p->freqs->data, p->qs->data, CS_ESR, 0);
+    memset(p->out, '\0', nsmps * sizeof(MYFLT));
+    if (UNLIKELY(early)) nsmps -= early;
+    if (UNLIKELY(offset >= nsmps)) return OK;
+    for (base = 0; base < p->s.nsect; base += FBANK_LANES)
+      svf_lanes(&p->s, base, mode, p->in, p->gains->data, offset, nsmps,
+                base > 0);
+    lanes_sum(&p->s, p->out, offset, nsmps);
+    return OK;
+}
+
+static int32_t svfbanka_perf(CSOUND *csound, FBANKA *p)
+{
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t ksmps = CS_KSMPS, nsmps = ksmps;
+    int32_t  base, mode = (int32_t) MYFLT2LRND(*p->imode);
+    if (UNLIKELY(fbank_check(csound, &p->h, &p->s, p->freqs, p->qs,
+                             NULL) != OK))
+      return NOTOK;
+    svf_coefs(&p->s, p->freqs->data, p->qs->data, CS_ESR, 0);
+    memset(p->outs->data, '\0', p->s.nsect * ksmps * sizeof(MYFLT));
+    if (UNLIKELY(early)) nsmps -= early;
+    if (UNLIKELY(offset >= nsmps)) return OK;
+    for (base = 0; base < p->s.nsect; base += FBANK_LANES) {
+      svf_lanes(&p->s, base, mode, p->in, NULL, offset, nsmps, 0);
+      lanes_out(&p->s, base, p->outs->data, offset, nsmps, ksmps);
+    }
+    return OK;
+}
+
+/* cascade */
+
+typedef struct {
+    OPDS    h;
+    MYFLT   *out, *in;
+    ARRAYDAT *freqs, *qs, *dbs;
+    MYFLT   *ishelf;
+    FBANK_SECT s;
+} BQCASCADE;
+
+/* peaking equaliser, or a low or high shelf, from the cookbook */
+static void eq_coefs(double c[5], int32_t type, double freq, double q,
+                     double db, double sr)
+{
+    double w = TWOPI * freq / sr, cw = cos(w);
+    double alpha = sin(w) / (2.0 * q), A = pow(10.0, db / 40.0);
+    double sa = 2.0 * sqrt(A) * alpha, a0;
+    switch (type) {
+    case 1:                     /* low shelf */
+      a0 = 1.0 / ((A + 1.0) + (A - 1.0) * cw + sa);
+      c[0] = A * ((A + 1.0) - (A - 1.0) * cw + sa) * a0;
+      c[1] = 2.0 * A * ((A - 1.0) - (A + 1.0) * cw) * a0;
+      c[2] = A * ((A + 1.0) - (A - 1.0) * cw - sa) * a0;
+      c[3] = -2.0 * ((A - 1.0) + (A + 1.0) * cw) * a0;
+      c[4] = ((A + 1.0) + (A - 1.0) * cw - sa) * a0;
+      break;
+    case 2:                     /* high shelf */
+      a0 = 1.0 / ((A + 1.0) - (A - 1.0) * cw + sa);
+      c[0] = A * ((A + 1.0) + (A - 1.0) * cw + sa) * a0;
+      c[1] = -2.0 * A * ((A - 1.0) + (A + 1.0) * cw) * a0;
+      c[2] = A * ((A + 1.0) + (A - 1.0) * cw - sa) * a0;
+      c[3] = 2.0 * ((A - 1.0) - (A + 1.0) * cw) * a0;
+      c[4] = ((A + 1.0) - (A - 1.0) * cw - sa) * a0;
+      break;
+    default:                    /* peaking */
+      a0 = 1.0 / (1.0 + alpha / A);
+      c[0] = (1.0 + alpha * A) * a0;
+      c[1] = -2.0 * cw * a0;
+      c[2] = (1.0 - alpha * A) * a0;
+      c[3] = c[1];
+      c[4] = (1.0 - alpha / A) * a0;
+    }
+}
+
+static inline int32_t cascade_type(const BQCASCADE *p, int32_t l)
+{
+    if (*p->ishelf == FL(0.0) || p->s.nsect < 2)
+      return 0;
+    return (l == 0 ? 1 : l == p->s.nsect - 1 ? 2 : 0);
+}
+
+/* the target coefficients of section l, or 0 if they have not changed */
+static int32_t cascade_target(BQCASCADE *p, int32_t l, double c[5],
+                              int32_t all)
+{
+    FBANK_SECT *s = &p->s;
+    MYFLT f = p->freqs->data[l], q = p->qs->data[l], db = p->dbs->data[l];
+    if (!all && f == s->freq[l] && q == s->q[l] && (double) db == s->gain[l])
+      return 0;
+    s->freq[l] = f;
+    s->q[l] = q;
+    s->gain[l] = db;
+    eq_coefs(c, cascade_type(p, l), clamp_freq(f, CS_ESR), clamp_q(q),
+             (double) db, CS_ESR);
+    return 1;
+}
+
+static int32_t bqcascade_init(CSOUND *csound, BQCASCADE *p)
+{
+    FBANK_SECT *s = &p->s;
+    int32_t    l;
+    if (UNLIKELY(fbank_alloc(csound, &p->h, s, p->freqs, p->qs,
+                             p->dbs) != OK))
+      return NOTOK;
+    for (l = 0; l < s->nsect; l++) {
+      double c[5];
+      (void) cascade_target(p, l, c, 1);
+      s->b0[l] = c[0]; s->b1[l] = c[1]; s->b2[l] = c[2];
+      s->a1[l] = c[3]; s->a2[l] = c[4];
+    }
+    return OK;
+}
+
+static int32_t bqcascade_perf(CSOUND *csound, BQCASCADE *p)
+{
+    FBANK_SECT *s = &p->s;
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t k, nsmps = CS_KSMPS;
+    MYFLT    *out = p->out;
+    int32_t  l;
+    if (UNLIKELY(fbank_check(csound, &p->h, s, p->freqs, p->qs,
+                             p->dbs) != OK))
+      return NOTOK;
+    if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
+    if (UNLIKELY(early)) {
+      nsmps -= early;
+      memset(&out[nsmps], '\0', early*sizeof(MYFLT));
+    }
+    if (UNLIKELY(offset >= nsmps)) return OK;
+    if (out != p->in)
+      memcpy(&out[offset], &p->in[offset], (nsmps - offset) * sizeof(MYFLT));
+    for (l = 0; l < s->nsect; l++) {
+      double b0 = s->b0[l], b1 = s->b1[l], b2 = s->b2[l];
+      double a1 = s->a1[l], a2 = s->a2[l];
+      double z1 = s->z1[l], z2 = s->z2[l], c[5];
+      if (cascade_target(p, l, c, 0)) {
+        double rn = 1.0 / (double) (nsmps - offset);
+        double db0 = (c[0] - b0) * rn, db1 = (c[1] - b1) * rn;
+        double db2 = (c[2] - b2) * rn, da1 = (c[3] - a1) * rn;
+        double da2 = (c[4] - a2) * rn;
+        for (k = offset; k < nsmps; k++) {
+          double x = (double) out[k], y;
+          b0 += db0; b1 += db1; b2 += db2; a1 += da1; a2 += da2;
+          y = b0 * x + z1;
+          z1 = b1 * x - a1 * y + z2;
+          z2 = b2 * x - a2 * y;
+          out[k] = (MYFLT) y;
+        }
+        s->b0[l] = c[0]; s->b1[l] = c[1]; s->b2[l] = c[2];
+        s->a1[l] = c[3]; s->a2[l] = c[4];
+      }
+      else
+        for (k = offset; k < nsmps; k++) {
+          double x = (double) out[k], y;
+          y = b0 * x + z1;
+          z1 = b1 * x - a1 * y + z2;
+          z2 = b2 * x - a2 * y;
+          out[k] = (MYFLT) y;
+        }
+      s->z1[l] = z1;
+      s->z2[l] = z2;
+    }
+    return OK;
+}
+
+#define S(x)    sizeof(x)
+
+static OENTRY localops[] = {
+    { "bqbank.a", S(FBANK), 0, "a", "ak[]k[]k[]",
+      (SUBR) bqbank_init, (SUBR) bqbank_perf },
+    { "bqbank.A", S(FBANKA), 0, "a[]", "ak[]k[]",
+      (SUBR) bqbanka_init, (SUBR) bqbanka_perf },
+    { "svfbank.a", S(FBANK), 0, "a", "ak[]k[]k[]o",
+      (SUBR) svfbank_init, (SUBR) svfbank_perf },
+    { "svfbank.A", S(FBANKA), 0, "a[]", "ak[]k[]o",
+      (SUBR) svfbanka_init, (SUBR) svfbanka_perf },
+    { "bqcascade", S(BQCASCADE), 0, "a", "ak[]k[]k[]o",
+      (SUBR) bqcascade_init, (SUBR) bqcascade_perf }
+};
+
+int32_t filterbank_init_(CSOUND *csound)
+{
+    return csound->AppendOpcodes(csound, &(localops[0]),
+                                 (int32_t) (sizeof(localops) / sizeof(OENTRY)));
+}
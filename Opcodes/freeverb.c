@@ -22,6 +22,7 @@
 */
 
 #include "stdopcod.h"
+#include "fdn.h"
 #include <math.h>
 
 #define DEFAULT_SRATE   44100.0
@@ -56,13 +57,6 @@ static const double offsetRoom  = 0.7;
 
 static const double allPassFeedBack = 0.5;
 
-typedef struct {
-    int32_t     nSamples;
-    int32_t     bufPos;
-    double  filterState;
-    MYFLT   buf[1];
-} freeVerbComb;
-
 typedef struct {
     int32_t     nSamples;
     int32_t     bufPos;
@@ -79,9 +73,9 @@ typedef struct {
     MYFLT           *kDampFactor;
     MYFLT           *iSampleRate;
     MYFLT           *iSkipInit;
-    freeVerbComb    *Comb[NR_COMB][2];
+    FDN             combs;      /* left channel's combs, then right's */
     freeVerbAllPass *AllPass[NR_ALLPASS][2];
-    MYFLT           *tmpBuf;
+    MYFLT           *tmpBuf;    /* left channel, then right */
     AUXCH           auxData;
     MYFLT           prvDampFactor;
     double          dampValue;
@@ -97,14 +91,6 @@ static int32_t calc_nsamples(FREEVERB *p, double delTime)
     return (int32_t) (delTime * sampleRate + 0.5);
 }
 
-static int32_t comb_nbytes(FREEVERB *p, double delTime)
-{
-    int32_t nbytes;
-    nbytes = (int32_t) sizeof(freeVerbComb) - (int32_t) sizeof(MYFLT);
-    nbytes += ((int32_t) sizeof(MYFLT) * calc_nsamples(p, delTime));
-    return ((nbytes + 15) & (~15));
-}
-
 static int32_t allpass_nbytes(FREEVERB *p, double delTime)
 {
     int32_t nbytes;
@@ -116,19 +102,18 @@ static int32_t allpass_nbytes(FREEVERB *p, double delTime)
 static int32_t freeverb_init(CSOUND *csound, FREEVERB *p)
 {
     int32_t             i, j, k, nbytes;
-    freeVerbComb    *combp;
     freeVerbAllPass *allpassp;
     /* calculate the total number of bytes to allocate */
     nbytes = 0;
     for (i = 0; i < NR_COMB; i++) {
-      nbytes += comb_nbytes(p, comb_delays[i][0]);
-      nbytes += comb_nbytes(p, comb_delays[i][1]);
+      nbytes += (int32_t) fdn_line_bytes(calc_nsamples(p, comb_delays[i][0]));
+      nbytes += (int32_t) fdn_line_bytes(calc_nsamples(p, comb_delays[i][1]));
     }
     for (i = 0; i < NR_ALLPASS; i++) {
       nbytes += allpass_nbytes(p, allpass_delays[i][0]);
       nbytes += allpass_nbytes(p, allpass_delays[i][1]);
     }
-    nbytes += (int32_t) sizeof(MYFLT) * (int32_t) CS_KSMPS;
+    nbytes += 2 * (int32_t) sizeof(MYFLT) * (int32_t) CS_KSMPS;
     /* allocate space if size has changed */
     if (nbytes != (int32_t) p->auxData.size)
       csound->AuxAlloc(csound, (int32) nbytes, &(p->auxData));
@@ -136,16 +121,12 @@ static int32_t freeverb_init(CSOUND *csound, FREEVERB *p)
       return OK;                            /*   if requested      */
     /* set up comb and allpass filters */
     nbytes = 0;
+    p->combs.nlines = NR_COMB << 1;
     for (i = 0; i < (NR_COMB << 1); i++) {
-      combp = (freeVerbComb*)((unsigned char*)p->auxData.auxp + (int32_t) nbytes);
-      p->Comb[i >> 1][i & 1] = combp;
-      k = calc_nsamples(p, comb_delays[i >> 1][i & 1]);
-      combp->nSamples = k;
-      combp->bufPos = 0;
-      combp->filterState = 0.0;
-      for (j = 0; j < k; j++)
-        combp->buf[j] = FL(0.0);
-      nbytes += comb_nbytes(p, comb_delays[i >> 1][i & 1]);
+      k = calc_nsamples(p, comb_delays[i % NR_COMB][i / NR_COMB]);
+      fdn_line_init(&p->combs, i,
+                    (unsigned char*)p->auxData.auxp + (int32_t) nbytes, k);
+      nbytes += (int32_t) fdn_line_bytes(k);
     }
     for (i = 0; i < (NR_ALLPASS << 1); i++) {
       allpassp = (freeVerbAllPass*) ((unsigned char*) p->auxData.auxp
@@ -171,12 +152,15 @@ static int32_t freeverb_init(CSOUND *csound, FREEVERB *p)
 static int32_t freeverb_perf(CSOUND *csound, FREEVERB *p)
 {
     double          feedback, damp1, damp2, x;
-    freeVerbComb    *combp;
+    double          state[FDN_LINES];
+    MYFLT           blk[FDN_BLOCK][FDN_LINES];
+    FDN             *combs = &(p->combs);
     freeVerbAllPass *allpassp;
-    int32_t             i;
+    MYFLT           *tmpBuf;
+    int32_t             i, l;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
+    uint32_t k, len, n, nsmps = CS_KSMPS;
 
     /* check if opcode was correctly initialised */
     if (UNLIKELY(p->auxData.size <= 0L || p->auxData.auxp == NULL)) goto err1;
@@ -193,33 +177,48 @@ static int32_t freeverb_perf(CSOUND *csound, FREEVERB *p)
     else
       damp1 = p->dampValue;
     damp2 = 1.0 - damp1;
-    /* comb filters (left channel) */
-    memset(p->tmpBuf,0, sizeof(MYFLT)*nsmps);
-    for (i = 0; i < NR_COMB; i++) {
-      combp = p->Comb[i][0];
-      for (n = 0; n < nsmps; n++) {
-        p->tmpBuf[n] += combp->buf[combp->bufPos];
-        x = (double) combp->buf[combp->bufPos];
-        combp->filterState = (combp->filterState * damp1) + (x * damp2);
-        x = combp->filterState * feedback + (double) p->aInL[n];
-        combp->buf[combp->bufPos] = (MYFLT) x;
-        if (UNLIKELY(++(combp->bufPos) >= combp->nSamples))
-          combp->bufPos = 0;
+    /* comb filters, of both channels side by side */
+    for (l = 0; l < combs->nlines; l++)
+      state[l] = combs->state[l];
+    for (n = 0; n < nsmps; n += len) {
+      len = fdn_span(combs, nsmps - n);
+      fdn_read(combs, blk, len);
+      for (k = 0; k < len; k++) {
+        MYFLT sumL = FL(0.0), sumR = FL(0.0);
+        for (l = 0; l < NR_COMB; l++) {
+          sumL += blk[k][l];
+          sumR += blk[k][NR_COMB + l];
+        }
+        p->tmpBuf[n + k] = sumL;
+        p->tmpBuf[nsmps + n + k] = sumR;
+        for (l = 0; l < NR_COMB; l++) {
+          x = (double) blk[k][l];
+          state[l] = (state[l] * damp1) + (x * damp2);
+          blk[k][l] = (MYFLT) (state[l] * feedback + (double) p->aInL[n + k]);
+        }
+        for (l = NR_COMB; l < (NR_COMB << 1); l++) {
+          x = (double) blk[k][l];
+          state[l] = (state[l] * damp1) + (x * damp2);
+          blk[k][l] = (MYFLT) (state[l] * feedback + (double) p->aInR[n + k]);
+        }
       }
+      fdn_write(combs, blk, len);
     }
+    for (l = 0; l < combs->nlines; l++)
+      combs->state[l] = state[l];
     /* allpass filters (left channel) */
+    tmpBuf = p->tmpBuf;
     for (i = 0; i < NR_ALLPASS; i++) {
       allpassp = p->AllPass[i][0];
       for (n = 0; n < nsmps; n++) {
-        x = (double) allpassp->buf[allpassp->bufPos] - (double) p->tmpBuf[n];
+        x = (double) allpassp->buf[allpassp->bufPos] - (double) tmpBuf[n];
         allpassp->buf[allpassp->bufPos] *= (MYFLT) allPassFeedBack;
-        allpassp->buf[allpassp->bufPos] += p->tmpBuf[n];
+        allpassp->buf[allpassp->bufPos] += tmpBuf[n];
         if (UNLIKELY(++(allpassp->bufPos) >= allpassp->nSamples))
           allpassp->bufPos = 0;
-        p->tmpBuf[n] = (MYFLT) x;
+        tmpBuf[n] = (MYFLT) x;
       }
     }
-
     /* write left channel output */
     if (UNLIKELY(offset)) memset(p->aOutL, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
@@ -227,36 +226,24 @@ static int32_t freeverb_perf(CSOUND *csound, FREEVERB *p)
       memset(&p->aOutL[nsmps], '\0', early*sizeof(MYFLT));
     }
     for (n = offset; n < nsmps; n++)
-      p->aOutL[n] = p->tmpBuf[n] * (MYFLT) fixedGain;
-    /* comb filters (right channel) */
-    memset(p->tmpBuf, 0, sizeof(MYFLT)*nsmps);
-    /* for (n = 0; n < nsmps; n++) */
-    /*   p->tmpBuf[n] = FL(0.0); */
-    for (i = 0; i < NR_COMB; i++) {
-      combp = p->Comb[i][1];
-      for (n = 0; n < nsmps; n++) {
-        p->tmpBuf[n] += combp->buf[combp->bufPos];
-        x = (double) combp->buf[combp->bufPos];
-        combp->filterState = (combp->filterState * damp1) + (x * damp2);
-        x = combp->filterState * feedback + (double) p->aInR[n];
-        combp->buf[combp->bufPos] = (MYFLT) x;
-        if (UNLIKELY(++(combp->bufPos) >= combp->nSamples))
-          combp->bufPos = 0;
-      }
-    }
+      p->aOutL[n] = tmpBuf[n] * (MYFLT) fixedGain;
+    /* both channels' combs have run over the whole ksmps, so the right
+       allpasses do too; before the combs shared a bank the right channel
+       ran over nsmps - early only, after the left had cut its output */
+    nsmps = CS_KSMPS;
     /* allpass filters (right channel) */
+    tmpBuf = p->tmpBuf + nsmps;
     for (i = 0; i < NR_ALLPASS; i++) {
       allpassp = p->AllPass[i][1];
       for (n = 0; n < nsmps; n++) {
-        x = (double) allpassp->buf[allpassp->bufPos] - (double) p->tmpBuf[n];
+        x = (double) allpassp->buf[allpassp->bufPos] - (double) tmpBuf[n];
         allpassp->buf[allpassp->bufPos] *= (MYFLT) allPassFeedBack;
-        allpassp->buf[allpassp->bufPos] += p->tmpBuf[n];
+        allpassp->buf[allpassp->bufPos] += tmpBuf[n];
         if (UNLIKELY(++(allpassp->bufPos) >= allpassp->nSamples))
           allpassp->bufPos = 0;
-        p->tmpBuf[n] = (MYFLT) x;
+        tmpBuf[n] = (MYFLT) x;
       }
     }
-    nsmps = CS_KSMPS;
     /* write right channel output */
     if (UNLIKELY(offset)) memset(p->aOutR, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
@@ -264,7 +251,7 @@ static int32_t freeverb_perf(CSOUND *csound, FREEVERB *p)
       memset(&p->aOutR[nsmps], '\0', early*sizeof(MYFLT));
     }
     for (n = offset; n < nsmps; n++)
-      p->aOutR[n] = p->tmpBuf[n] * (MYFLT) fixedGain;
+      p->aOutR[n] = tmpBuf[n] * (MYFLT) fixedGain;
 
     return OK;
  err1:
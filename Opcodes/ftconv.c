@@ -148,6 +148,13 @@ static void set_buf_pointers(FTCONV *p,
     }
 }
 
+/* hands back the FFT setups asked for at init */
+static int32_t ftconv_deinit(CSOUND *csound, FTCONV *p)
+{
+    csound->ReleaseFFTSetups(csound, &p->h);
+    return OK;
+}
+
 static int32_t ftconv_init(CSOUND *csound, FTCONV *p)
 {
     FUNC    *ftp;
@@ -214,8 +221,10 @@ static int32_t ftconv_init(CSOUND *csound, FTCONV *p)
     /* calculate FFT of impulse response partitions, in reverse order */
     /* also apply FFT amplitude scale here */
     //FFTscale = csound->GetInverseRealFFTScale(csound, (p->partSize << 1));
-    p->fwdsetup = csound->RealFFTSetup(csound,(p->partSize << 1), FFT_FWD);
-    p->invsetup = csound->RealFFTSetup(csound,(p->partSize << 1), FFT_INV);
+    p->fwdsetup =
+      csound->RealFFTSetupFor(csound,(p->partSize << 1), FFT_FWD, &p->h);
+    p->invsetup =
+      csound->RealFFTSetupFor(csound,(p->partSize << 1), FFT_INV, &p->h);
     for (j = 0; j < p->nChannels; j++) {
       i = (skipSamples * p->nChannels) + j;           /* table read position */
       n = (p->partSize << 1) * (p->nPartitions - 1);  /* IR write position */
@@ -316,6 +325,6 @@ int32_t ftconv_init_(CSOUND *csound)
                                 "mmmmmmmm", "aiiooo",
                                 (int32_t (*)(CSOUND *, void *)) ftconv_init,
                                 (int32_t (*)(CSOUND *, void *)) ftconv_perf,
-                                NULL);
+                                (int32_t (*)(CSOUND *, void *)) ftconv_deinit);
 }
 
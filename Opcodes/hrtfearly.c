@@ -236,6 +236,13 @@ typedef struct
 
 } early;
 
+/* hands back the FFT setups asked for at init */
+static int32_t early_deinit(CSOUND *csound, early *p)
+{
+    csound->ReleaseFFTSetups(csound, &p->h);
+    return OK;
+}
+
 static int32_t early_init(CSOUND *csound, early *p)
 {
     /* iterator */
@@ -779,9 +786,11 @@ static int32_t early_init(CSOUND *csound, early *p)
     p->lstnrzk = FL(-1.0);
 
     p->rotatev = FL(0.0);
-    p->setup = csound->RealFFTSetup(csound, p->irlengthpad, FFT_FWD);
-    p->isetup = csound->RealFFTSetup(csound, p->irlength, FFT_INV);
-    p->isetup_pad = csound->RealFFTSetup(csound, p->irlengthpad, FFT_INV);
+    p->setup =
+      csound->RealFFTSetupFor(csound, p->irlengthpad, FFT_FWD, &p->h);
+    p->isetup = csound->RealFFTSetupFor(csound, p->irlength, FFT_INV, &p->h);
+    p->isetup_pad =
+      csound->RealFFTSetupFor(csound, p->irlengthpad, FFT_INV, &p->h);
     return OK;
 }
 
@@ -1805,7 +1814,7 @@ static OENTRY hrtfearly_localops[] =
     {
      "hrtfearly",   sizeof(early), 0, "aaiii",
                                          "axxxxxxSSioopoOoooooooooooooooooo",
-      (SUBR)early_init, (SUBR)early_process
+      (SUBR)early_init, (SUBR)early_process, (SUBR)early_deinit
     }
   };
 
@@ -70,6 +70,13 @@ static const int32_t elevation_data[N_ELEV] = {56, 60, 72, 72, 72, 72, 72,
 #define ROUND(x) ((int32_t)floor((x)+FL(0.5)))
 #define GET_NFAZ(el_index)      ((elevation_data[el_index] / 2) + 1)
 
+/* hands back the FFT setups asked for at init */
+static int32_t hrtferxk_deinit(CSOUND *csound, HRTFER *p)
+{
+    csound->ReleaseFFTSetups(csound, &p->h);
+    return OK;
+}
+
 static int32_t hrtferxkSet(CSOUND *csound, HRTFER *p)
 {
     // int32_t    i; /* standard loop counter */
@@ -144,8 +151,8 @@ static int32_t hrtferxkSet(CSOUND *csound, HRTFER *p)
     /* } */
     memset(p->bl, 0, FILT_LENm1*sizeof(MYFLT));
     memset(p->br, 0, FILT_LENm1*sizeof(MYFLT));
-    p->setup = csound->RealFFTSetup(csound, BUF_LEN, FFT_FWD);
-    p->isetup = csound->RealFFTSetup(csound, BUF_LEN, FFT_INV);
+    p->setup = csound->RealFFTSetupFor(csound, BUF_LEN, FFT_FWD, &p->h);
+    p->isetup = csound->RealFFTSetupFor(csound, BUF_LEN, FFT_INV, &p->h);
     return OK;
 }
 
@@ -450,7 +457,7 @@ static int32_t hrtferxk(CSOUND *csound, HRTFER *p)
 static OENTRY hrtferX_localops[] =
   {
    { "hrtfer",   sizeof(HRTFER), _QQ,  "aa", "akkS",
-     (SUBR)hrtferxkSet, (SUBR)hrtferxk},
+     (SUBR)hrtferxkSet, (SUBR)hrtferxk, (SUBR)hrtferxk_deinit},
 };
 
 LINKAGE_BUILTIN(hrtferX_localops)
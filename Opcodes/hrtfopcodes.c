@@ -145,6 +145,30 @@ static int32_t swap4bytes(CSOUND* csound, MEMFIL* mfp)
 static int32_t (*swap4bytes)(CSOUND*, MEMFIL*) = NULL;
 #endif
 
+/* total number of measurements, both hemispheres */
+#define HRTF_POINTS (710)
+
+/* the measurements of a pair of data files, and the padded spectra of
+   each as hrtfstat computes them, shared by all engines in the process
+   and keyed by data files and sr */
+typedef struct hrtf_dataset_s
+{
+        struct hrtf_dataset_s *next;
+        char *filel, *filer;
+        MYFLT sr;
+        int32_t irlength, irlengthpad;
+        int32_t refs;
+        /* the data files, byte swapped */
+        float *datal, *datar;
+        /* HRTF_POINTS * (left, right) * irlengthpad */
+        MYFLT *spec;
+}
+HRTF_DATASET;
+
+static HRTF_DATASET *hrtf_dataset_get(CSOUND *, const char *, const char *,
+                                      MYFLT, int32_t, int32_t);
+static void hrtf_dataset_release(HRTF_DATASET *);
+
 /* Csound hrtf magnitude interpolation, phase truncation object */
 
 /* aleft,aright hrtfmove asrc, kaz, kel, ifilel->data, ifiler [, imode = 0,
@@ -165,6 +189,7 @@ typedef struct
         MYFLT anglev, elevv;
 
         float *fpbeginl,*fpbeginr;
+        HRTF_DATASET *data;
 
         /* see definitions in INIT */
         int32_t irlength, irlengthpad, overlapsize;
@@ -225,12 +250,26 @@ typedef struct
 }
 hrtfmove;
 
+/* hands back the FFT setups and the dataset an opcode took at init */
+static void hrtf_release(CSOUND *csound, OPDS *h, HRTF_DATASET **data)
+{
+    csound->ReleaseFFTSetups(csound, h);
+    if (*data != NULL) {
+      hrtf_dataset_release(*data);
+      *data = NULL;
+    }
+}
+
+static int32_t hrtfmove_deinit(CSOUND *csound, hrtfmove *p)
+{
+    hrtf_release(csound, &p->h, &p->data);
+    return OK;
+}
+
 static int32_t hrtfmove_init(CSOUND *csound, hrtfmove *p)
 {
     /* left and right data files: spectral mag, phase format. */
-    MEMFIL *fpl = NULL,*fpr = NULL;
     int32_t i;
-    char filel[MAXNAME],filer[MAXNAME];
 
     int32_t mode = (int32_t)*p->omode;
     int32_t fade = (int32_t)*p->ofade;
@@ -284,24 +323,20 @@ static int32_t hrtfmove_init(CSOUND *csound, hrtfmove *p)
         overlapsize = (irlength - 1);
       }
 
-    /* copy in string name */
-    strncpy(filel, (char*) p->ifilel->data, MAXNAME-1); //filel[MAXNAME-1]='\0';
-    strncpy(filer, (char*) p->ifiler->data, MAXNAME-1); //filel[MAXNAME-1]='\0';
-
-    /* reading files, with byte swap */
-    fpl = csound->LoadMemoryFile(csound, filel, CSFTYPE_FLOATS_BINARY,
-                                   swap4bytes);
-    if (UNLIKELY(fpl == NULL))
-      return
-        csound->InitError(csound,
-                          "%s", Str("\n\n\nCannot load left data file, exiting\n\n"));
-
-    fpr = csound->LoadMemoryFile(csound, filer, CSFTYPE_FLOATS_BINARY,
-                                   swap4bytes);
-    if (UNLIKELY(fpr == NULL))
+    if (UNLIKELY(irlength == 0))
+      return csound->InitError(csound,
+                               Str("hrtfmove: unsupported sr %.0f"), sr);
+
+    /* measurements shared with every opcode using the same files */
+    if (p->data != NULL)
+      hrtf_dataset_release(p->data);
+    p->data = hrtf_dataset_get(csound, (char*) p->ifilel->data,
+                               (char*) p->ifiler->data, sr,
+                               irlength, irlengthpad);
+    if (UNLIKELY(p->data == NULL))
       return
-        csound->InitError(csound,
-                          "%s", Str("\n\n\nCannot load right data file, exiting\n\n"));
+        csound->InitError(csound, "%s",
+                          Str("\n\n\nCannot load HRTF data files, exiting\n\n"));
 
     p->irlength = irlength;
     p->irlengthpad = irlengthpad;
@@ -311,8 +346,8 @@ static int32_t hrtfmove_init(CSOUND *csound, hrtfmove *p)
     p->fadebuffer = (int32_t)fade*irlength;
 
     /* file handles */
-    p->fpbeginl = (float *) fpl->beginp;
-    p->fpbeginr = (float *) fpr->beginp;
+    p->fpbeginl = p->data->datal;
+    p->fpbeginr = p->data->datar;
 
     /* common buffers (used by both min phase and phasetrunc) */
     if (!p->insig.auxp || p->insig.size < irlength * sizeof(MYFLT))
@@ -482,10 +517,12 @@ static int32_t hrtfmove_init(CSOUND *csound, hrtfmove *p)
        start with to ensure first read */
     p->anglev = -1;
     p->elevv = -41;
-    p->setup_pad = csound->RealFFTSetup(csound, p->irlengthpad, FFT_FWD);
-    p->setup = csound->RealFFTSetup(csound, p->irlength, FFT_FWD);
-    p->isetup_pad = csound->RealFFTSetup(csound, p->irlengthpad, FFT_INV);
-    p->isetup = csound->RealFFTSetup(csound, p->irlength, FFT_INV);
+    p->setup_pad =
+      csound->RealFFTSetupFor(csound, p->irlengthpad, FFT_FWD, &p->h);
+    p->setup = csound->RealFFTSetupFor(csound, p->irlength, FFT_FWD, &p->h);
+    p->isetup_pad =
+      csound->RealFFTSetupFor(csound, p->irlengthpad, FFT_INV, &p->h);
+    p->isetup = csound->RealFFTSetupFor(csound, p->irlength, FFT_INV, &p->h);
     return OK;
 }
 
@@ -1393,15 +1430,21 @@ typedef struct
         /* buffers for impulse shift */
         AUXCH leftshiftbuffer, rightshiftbuffer;
 
+        HRTF_DATASET *data;
+
   void *setup, *isetup, *isetup_pad, *setup_pad;
 }
 hrtfstat;
 
+static int32_t hrtfstat_deinit(CSOUND *csound, hrtfstat *p)
+{
+    hrtf_release(csound, &p->h, &p->data);
+    return OK;
+}
+
 static int32_t hrtfstat_init(CSOUND *csound, hrtfstat *p)
 {
     /* left and right data files: spectral mag, phase format. */
-    MEMFIL *fpl = NULL, *fpr = NULL;
-    char filel[MAXNAME], filer[MAXNAME];
 
     /* interpolation values */
     MYFLT *lowl1;
@@ -1477,24 +1520,16 @@ static int32_t hrtfstat_init(CSOUND *csound, hrtfstat *p)
         overlapsize = (irlength - 1);
       }
 
-    /* copy in string name... */
-    strncpy(filel, (char*) p->ifilel->data, MAXNAME-1); //filel[MAXNAME-1]='\0';
-    strncpy(filer, (char*) p->ifiler->data, MAXNAME-1); //filel[MAXNAME-1]='\0';
-
-    /* reading files, with byte swap */
-    fpl = csound->LoadMemoryFile(csound, filel, CSFTYPE_FLOATS_BINARY,
-                                   swap4bytes);
-    if (UNLIKELY(fpl == NULL))
-      return
-        csound->InitError(csound,
-                          "%s", Str("\n\n\nCannot load left data file, exiting\n\n"));
-
-    fpr = csound->LoadMemoryFile(csound, filer, CSFTYPE_FLOATS_BINARY,
-                                   swap4bytes);
-    if (UNLIKELY(fpr == NULL))
+    /* measurements shared with every opcode using the same files */
+    if (p->data != NULL)
+      hrtf_dataset_release(p->data);
+    p->data = hrtf_dataset_get(csound, (char*) p->ifilel->data,
+                               (char*) p->ifiler->data, sr,
+                               irlength, irlengthpad);
+    if (UNLIKELY(p->data == NULL))
       return
-        csound->InitError(csound,
-                          "%s", Str("\n\n\nCannot load right data file, exiting\n\n"));
+        csound->InitError(csound, "%s",
+                          Str("\n\n\nCannot load HRTF data files, exiting\n\n"));
 
     p->irlength = irlength;
     p->irlengthpad = irlengthpad;
@@ -1504,8 +1539,8 @@ static int32_t hrtfstat_init(CSOUND *csound, hrtfstat *p)
 
     /* start indices at correct value (start of file)/ zero indices.
        (do not need to store here, as only accessing in INIT) */
-    fpindexl = (float *) fpl->beginp;
-    fpindexr = (float *) fpr->beginp;
+    fpindexl = p->data->datal;
+    fpindexr = p->data->datar;
 
     /* buffers */
     if (!p->insig.auxp || p->insig.size < irlength * sizeof(MYFLT))
@@ -1648,6 +1683,31 @@ static int32_t hrtfstat_init(CSOUND *csound, hrtfstat *p)
     angleindex2per = angleindexlowstore - angleindex1;
     angleindex4per = angleindexhighstore - angleindex3;
 
+    p->setup_pad =
+      csound->RealFFTSetupFor(csound, p->irlengthpad, FFT_FWD, &p->h);
+    p->setup = csound->RealFFTSetupFor(csound, p->irlength, FFT_FWD, &p->h);
+    p->isetup_pad =
+      csound->RealFFTSetupFor(csound, p->irlengthpad, FFT_INV, &p->h);
+    p->isetup = csound->RealFFTSetupFor(csound, p->irlength, FFT_INV, &p->h);
+
+    /* on a measurement, with the default head radius, the filter is
+       the one the shared dataset holds */
+    if (r == FL(8.8) && elevindexhighper == FL(0.0) &&
+        angleindex2per == FL(0.0) &&
+        elev == minelev + elevindexlow * elevincrement &&
+        angle == angleindex1 * (FL(360.0) / elevationarray[elevindexlow]))
+      {
+        const MYFLT *spec;
+        int32_t pt = angleindex1;
+        for(i = 0; i < elevindexlow; i++)
+          pt += elevationarray[i];
+        spec = p->data->spec + 2 * pt * irlengthpad;
+        memcpy(hrtflpad, spec, irlengthpad * sizeof(MYFLT));
+        memcpy(hrtfrpad, spec + irlengthpad, irlengthpad * sizeof(MYFLT));
+        p->counter = 0;
+        return OK;
+      }
+
     /* read 4 nearest HRTFs */
     skip = 0;
     /* switch l and r */
@@ -1845,11 +1905,6 @@ static int32_t hrtfstat_init(CSOUND *csound, hrtfstat *p)
         hrtfrfloat[i+1] = magr * SIN(phaser);
       }
 
-    p->setup_pad = csound->RealFFTSetup(csound, p->irlengthpad, FFT_FWD);
-    p->setup = csound->RealFFTSetup(csound, p->irlength, FFT_FWD);
-    p->isetup_pad = csound->RealFFTSetup(csound, p->irlengthpad, FFT_INV);
-    p->isetup = csound->RealFFTSetup(csound, p->irlength, FFT_INV);
-
     /* ifft */
     csound->RealFFT(csound,  p->isetup, hrtflfloat);
     csound->RealFFT(csound,  p->isetup, hrtfrfloat);
@@ -2039,6 +2094,7 @@ MYFLT *ooverlap, *oradius, *osr;
         int32_t hopsize;
 
         float *fpbeginl,*fpbeginr;
+        HRTF_DATASET *data;
 
         /* to keep track of process */
         int32_t counter, t;
@@ -2067,12 +2123,16 @@ MYFLT *ooverlap, *oradius, *osr;
 }
 hrtfmove2;
 
+static int32_t hrtfmove2_deinit(CSOUND *csound, hrtfmove2 *p)
+{
+    hrtf_release(csound, &p->h, &p->data);
+    return OK;
+}
+
 static int32_t hrtfmove2_init(CSOUND *csound, hrtfmove2 *p)
 {
     /* left and right data files: spectral mag, phase format. */
-    MEMFIL *fpl = NULL, *fpr = NULL;
 
-    char filel[MAXNAME], filer[MAXNAME];
 
     /* time domain impulse length */
     int32_t irlength=0;
@@ -2106,31 +2166,23 @@ static int32_t hrtfmove2_init(CSOUND *csound, hrtfmove2 *p)
     else if(sr == 96000)
       irlength = 256;
 
-    /* copy in string name... */
-    strncpy(filel, (char*) p->ifilel->data, MAXNAME-1); //filel[MAXNAME-1] = '\0';
-    strncpy(filer, (char*) p->ifiler->data, MAXNAME-1); //filer[MAXNAME-1] = '\0';
-
-    /* reading files, with byte swap */
-    fpl = csound->LoadMemoryFile(csound, filel, CSFTYPE_FLOATS_BINARY,
-                                   swap4bytes);
-    if (UNLIKELY(fpl == NULL))
-     return
-        csound->InitError(csound,
-                          "%s", Str("\n\n\nCannot load left data file, exiting\n\n"));
-
-    fpr = csound->LoadMemoryFile(csound, filer, CSFTYPE_FLOATS_BINARY,
-                                   swap4bytes);
-    if (UNLIKELY(fpr == NULL))
+    /* measurements shared with every opcode using the same files */
+    if (p->data != NULL)
+      hrtf_dataset_release(p->data);
+    p->data = hrtf_dataset_get(csound, (char*) p->ifilel->data,
+                               (char*) p->ifiler->data, sr,
+                               irlength, 2 * irlength);
+    if (UNLIKELY(p->data == NULL))
       return
-        csound->InitError(csound,
-                          "%s", Str("\n\n\nCannot load right data file, exiting\n\n"));
+        csound->InitError(csound, "%s",
+                          Str("\n\n\nCannot load HRTF data files, exiting\n\n"));
 
     p->irlength = irlength;
     p->sroverN = sr / irlength;
 
     /* file handles */
-    p->fpbeginl = (float *) fpl->beginp;
-    p->fpbeginr = (float *) fpr->beginp;
+    p->fpbeginl = p->data->datal;
+    p->fpbeginr = p->data->datar;
 
     if(overlap != 2 && overlap != 4 && overlap != 8 && overlap != 16)
       overlap = 4;
@@ -2233,8 +2285,8 @@ static int32_t hrtfmove2_init(CSOUND *csound, hrtfmove2 *p)
     p->anglev = -1;
     p->elevv = -41;
 
-    p->setup = csound->RealFFTSetup(csound, p->irlength, FFT_FWD);
-    p->isetup = csound->RealFFTSetup(csound, p->irlength, FFT_INV);
+    p->setup = csound->RealFFTSetupFor(csound, p->irlength, FFT_FWD, &p->h);
+    p->isetup = csound->RealFFTSetupFor(csound, p->irlength, FFT_INV, &p->h);
 
     return OK;
 }
@@ -2681,15 +2733,487 @@ static int32_t hrtfmove2_process(CSOUND *csound, hrtfmove2 *p)
     return OK;
 }
 
+/* Csound hrtf multi source bus: nearest measurement, shared spectra */
+
+/* aleft, aright hrtfbus asrc[], kaz[], kel[], ifilel, ifiler [, ifade = 8,
+   sr = 44100] */
+/* every source is filtered by the measured HRTF nearest its position, with
+   woodworth itd for the default head radius. Sources are summed per ear
+   in the frequency domain, so each block costs one forward fft per source
+   and one inverse fft per ear. ifade: no of buffers per crossfade when a
+   source moves to a new measurement. Output matches summed hrtfstat
+   instances, gain included, which sits 1 to 2 dB above hrtfmove2 */
+
+static HRTF_DATASET *hrtf_datasets = NULL;
+static static_lock_t hrtf_datasets_lock = STATIC_LOCK_INIT;
+
+/* padded spectra of one measurement, as hrtfstat computes them */
+static void hrtf_point(CSOUND *csound, const HRTF_DATASET *d,
+                       const float *fpindexl, const float *fpindexr,
+                       int32_t elevindex, int32_t angleindex,
+                       void *isetup, void *setup_pad,
+                       MYFLT *hrtflfloat, MYFLT *hrtfrfloat,
+                       MYFLT *hrtflpad, MYFLT *hrtfrpad)
+{
+    int32_t irlength = d->irlength, irlengthpad = d->irlengthpad;
+    int32_t n = elevationarray[elevindex];
+    int32_t i, skip = 0, shift;
+    const float *datal = fpindexl, *datar = fpindexr;
+    const float *nonlin = d->sr == 96000 ? nonlinitd96k :
+      (d->sr == 48000 ? nonlinitd48k : nonlinitd);
+    MYFLT angle = angleindex * (FL(360.0) / n);
+    MYFLT elev = minelev + elevindex * elevincrement;
+    MYFLT radianangle, radianelev, itd = 0, itdww, freq, phasel, phaser;
+
+    for(i = 0; i < elevindex; i++)
+      skip += ((int32_t)(elevationarray[i] / 2) + 1) * irlength;
+    /* switch l and r */
+    if(angleindex > n / 2)
+      {
+        skip += (n - angleindex) * irlength;
+        datal = fpindexr;
+        datar = fpindexl;
+      }
+    else
+      skip += angleindex * irlength;
+    datal += skip;
+    datar += skip;
+
+    if(angle > FL(180.0))
+      radianangle = (angle - FL(180.0)) * PI_F / FL(180.0);
+    else
+      radianangle = angle * PI_F / FL(180.0);
+    radianelev = elev * PI_F / FL(180.0);
+    if(radianangle > PI_F / FL(2.0))
+      radianangle = FL(PI) - radianangle;
+    itdww = (radianangle + SIN(radianangle)) * FL(8.8) * COS(radianelev) / c;
+
+    hrtflfloat[0] = FABS(datal[0]);
+    hrtflfloat[1] = FABS(datal[1]);
+    hrtfrfloat[0] = FABS(datar[0]);
+    hrtfrfloat[1] = FABS(datar[1]);
+    for(i = 2; i < irlength; i += 2)
+      {
+        freq = (i / 2) * (d->sr / irlength);
+        if((i / 2) < 6)
+          itd = itdww * nonlin[(i / 2) - 1];
+        if(angle > FL(180.))
+          {
+            phasel = TWOPI_F * freq * (itd / 2);
+            phaser = TWOPI_F * freq * -(itd / 2);
+          }
+        else
+          {
+            phasel = TWOPI_F * freq * -(itd / 2);
+            phaser = TWOPI_F * freq * (itd / 2);
+          }
+        hrtflfloat[i] = datal[i] * COS(phasel);
+        hrtflfloat[i+1] = datal[i] * SIN(phasel);
+        hrtfrfloat[i] = datar[i] * COS(phaser);
+        hrtfrfloat[i+1] = datar[i] * SIN(phaser);
+      }
+
+    csound->RealFFT(csound, isetup, hrtflfloat);
+    csound->RealFFT(csound, isetup, hrtfrfloat);
+
+    /* centre impulse and zero pad */
+    shift = irlength / 2;
+    for(i = 0; i < irlength; i++)
+      {
+        hrtflpad[i] = hrtflfloat[shift];
+        hrtfrpad[i] = hrtfrfloat[shift];
+        shift = (shift + 1) % irlength;
+      }
+    for(i = irlength; i < irlengthpad; i++)
+      hrtflpad[i] = hrtfrpad[i] = FL(0.0);
+
+    csound->RealFFT(csound, setup_pad, hrtflpad);
+    csound->RealFFT(csound, setup_pad, hrtfrpad);
+}
+
+/* find or build the spectra for a pair of data files; the caller holds
+   a reference on success */
+static HRTF_DATASET *hrtf_dataset_get(CSOUND *csound, const char *namel,
+                                      const char *namer, MYFLT sr,
+                                      int32_t irlength, int32_t irlengthpad)
+{
+    HRTF_DATASET *d, *d2;
+    MEMFIL *fpl, *fpr;
+    char *filel, *filer;
+    MYFLT *spec, *scratch;
+    void *isetup, *setup_pad;
+    OPDS fftkey;             /* only its address is used, to own the setups */
+    int32_t e, a, pt = 0;
+
+    filel = csound->FindInputFile(csound, namel, "SADIR");
+    filer = csound->FindInputFile(csound, namer, "SADIR");
+    if (UNLIKELY(filel == NULL || filer == NULL)) {
+      csound->Free(csound, filel);
+      csound->Free(csound, filer);
+      return NULL;
+    }
+
+    csoundStaticLock(&hrtf_datasets_lock);
+    for (d = hrtf_datasets; d != NULL; d = d->next)
+      if (d->sr == sr && !strcmp(d->filel, filel) && !strcmp(d->filer, filer))
+        break;
+    if (d != NULL)
+      d->refs++;
+    csoundStaticUnLock(&hrtf_datasets_lock);
+    if (d != NULL) {
+      csound->Free(csound, filel);
+      csound->Free(csound, filer);
+      return d;
+    }
+
+    /* not cached: build outside the lock */
+    fpl = csound->LoadMemoryFile(csound, namel, CSFTYPE_FLOATS_BINARY,
+                                 swap4bytes);
+    fpr = csound->LoadMemoryFile(csound, namer, CSFTYPE_FLOATS_BINARY,
+                                 swap4bytes);
+    d = (HRTF_DATASET *) calloc(1, sizeof(HRTF_DATASET));
+    spec = (MYFLT *) malloc(HRTF_POINTS * 2 * irlengthpad * sizeof(MYFLT));
+    if (d != NULL && fpl != NULL && fpr != NULL) {
+      d->datal = (float *) malloc(fpl->length);
+      d->datar = (float *) malloc(fpr->length);
+    }
+    if (UNLIKELY(fpl == NULL || fpr == NULL || d == NULL || spec == NULL ||
+                 d->datal == NULL || d->datar == NULL)) {
+      if (d != NULL) {
+        free(d->datal);
+        free(d->datar);
+      }
+      free(d);
+      free(spec);
+      csound->Free(csound, filel);
+      csound->Free(csound, filer);
+      return NULL;
+    }
+    d->filel = strdup(filel);
+    d->filer = strdup(filer);
+    csound->Free(csound, filel);
+    csound->Free(csound, filer);
+    d->sr = sr;
+    d->irlength = irlength;
+    d->irlengthpad = irlengthpad;
+    d->refs = 1;
+    d->spec = spec;
+    memcpy(d->datal, fpl->beginp, fpl->length);
+    memcpy(d->datar, fpr->beginp, fpr->length);
+
+    isetup = csound->RealFFTSetupFor(csound, irlength, FFT_INV, &fftkey);
+    setup_pad = csound->RealFFTSetupFor(csound, irlengthpad, FFT_FWD, &fftkey);
+    scratch = (MYFLT *) csound->Malloc(csound, 2 * irlength * sizeof(MYFLT));
+    for (e = 0; e < 14; e++)
+      for (a = 0; a < elevationarray[e]; a++, pt++)
+        hrtf_point(csound, d, d->datal, d->datar,
+                   e, a, isetup, setup_pad, scratch, scratch + irlength,
+                   spec + (2 * pt) * irlengthpad,
+                   spec + (2 * pt + 1) * irlengthpad);
+    csound->Free(csound, scratch);
+    csound->ReleaseFFTSetups(csound, &fftkey);
+
+    csoundStaticLock(&hrtf_datasets_lock);
+    for (d2 = hrtf_datasets; d2 != NULL; d2 = d2->next)
+      if (d2->sr == sr && !strcmp(d2->filel, d->filel) &&
+          !strcmp(d2->filer, d->filer))
+        break;
+    if (d2 != NULL)               /* another engine got there first */
+      d2->refs++;
+    else {
+      d->next = hrtf_datasets;
+      hrtf_datasets = d;
+    }
+    csoundStaticUnLock(&hrtf_datasets_lock);
+    if (d2 != NULL) {
+      free(d->filel);
+      free(d->filer);
+      free(d->datal);
+      free(d->datar);
+      free(d->spec);
+      free(d);
+      d = d2;
+    }
+    return d;
+}
+
+static void hrtf_dataset_release(HRTF_DATASET *d)
+{
+    HRTF_DATASET **dp;
+    csoundStaticLock(&hrtf_datasets_lock);
+    if (--d->refs == 0) {
+      for (dp = &hrtf_datasets; *dp != NULL; dp = &(*dp)->next)
+        if (*dp == d) {
+          *dp = d->next;
+          break;
+        }
+    }
+    else d = NULL;
+    csoundStaticUnLock(&hrtf_datasets_lock);
+    if (d != NULL) {
+      free(d->filel);
+      free(d->filer);
+      free(d->datal);
+      free(d->datar);
+      free(d->spec);
+      free(d);
+    }
+}
+
+/* index of the measurement nearest to a position */
+static int32_t hrtf_nearest(MYFLT angle, MYFLT elev)
+{
+    int32_t e, a, pt = 0, i;
+    if(elev > FL(90.0))
+      elev = FL(90.0);
+    if(elev < FL(-40.0))
+      elev = FL(-40.0);
+    angle = FMOD(angle, FL(360.0));
+    if(angle < FL(0.0))
+      angle += FL(360.0);
+    e = (int32_t) ((elev - minelev) / elevincrement + FL(0.5));
+    if (e > 13) e = 13;
+    a = (int32_t) (angle / (FL(360.0) / elevationarray[e]) + FL(0.5));
+    a %= elevationarray[e];
+    for (i = 0; i < e; i++)
+      pt += elevationarray[i];
+    return pt + a;
+}
+
+/* acc += g * h * x, packed real fft format */
+static inline void hrtf_macc(MYFLT *acc, const MYFLT *h, const MYFLT *x,
+                             int32_t n, MYFLT g)
+{
+    int32_t i;
+    acc[0] += g * h[0] * x[0];
+    acc[1] += g * h[1] * x[1];
+    for (i = 2; i < n; i += 2) {
+      acc[i] += g * (h[i] * x[i] - h[i+1] * x[i+1]);
+      acc[i+1] += g * (h[i] * x[i+1] + h[i+1] * x[i]);
+    }
+}
+
+typedef struct
+{
+        OPDS  h;
+        MYFLT *outsigl, *outsigr;
+        ARRAYDAT *in, *kangle, *kelev;
+        STRINGDAT *ifilel, *ifiler;
+        MYFLT *ofade, *osr;
+
+        int32_t irlength, irlengthpad, overlapsize;
+        int32_t nsrc, fade, counter;
+
+        HRTF_DATASET *data;
+
+        /* per source: input blocks, current and previous measurement,
+           blocks left in crossfade */
+        AUXCH insig, cur, old, fading;
+        /* source spectrum, per ear accumulators, outputs, overlap */
+        AUXCH complexinsig, outspecl, outspecr, outl, outr, overlapl, overlapr;
+
+        void *setup_pad, *isetup_pad;
+}
+hrtfbus;
+
+static int32_t hrtfbus_deinit(CSOUND *csound, hrtfbus *p)
+{
+    csound->ReleaseFFTSetups(csound, &p->h);
+    if (p->data != NULL) {
+      hrtf_dataset_release(p->data);
+      p->data = NULL;
+    }
+    return OK;
+}
+
+static int32_t hrtfbus_init(CSOUND *csound, hrtfbus *p)
+{
+    MYFLT sr = *p->osr;
+    int32_t irlength, irlengthpad, overlapsize, fade, nsrc, i;
+    int32_t *cur;
+
+    if (sr == 0) sr = CS_ESR;
+    if (sr != FL(44100.0) && sr != FL(48000.0) && sr != FL(96000.0))
+      sr = FL(44100.0);
+    if (UNLIKELY(CS_ESR != sr))
+      csound->Message(csound,
+                      Str("\n\nWARNING!!:\nOrchestra SR not compatible with "
+                          "HRTF processing SR of: %.0f\n\n"), sr);
+    irlength = sr == 96000 ? 256 : 128;
+    irlengthpad = 2 * irlength;
+    overlapsize = irlength - 1;
+
+    nsrc = p->in->dimensions == 1 ? p->in->sizes[0] : 0;
+    if (UNLIKELY(nsrc <= 0))
+      return csound->InitError(csound, "%s",
+                               Str("hrtfbus: no input signals"));
+    if (UNLIKELY(p->kangle->data == NULL || p->kelev->data == NULL ||
+                 p->kangle->sizes[0] < nsrc || p->kelev->sizes[0] < nsrc))
+      return csound->InitError(csound, "%s",
+                               Str("hrtfbus: need a position for each source"));
+
+    fade = (int32_t) *p->ofade;
+    if (fade <= 0 || fade > 24)
+      fade = 8;
+
+    hrtfbus_deinit(csound, p);
+    p->data = hrtf_dataset_get(csound, (char*) p->ifilel->data,
+                               (char*) p->ifiler->data, sr,
+                               irlength, irlengthpad);
+    if (UNLIKELY(p->data == NULL))
+      return
+        csound->InitError(csound, "%s",
+                          Str("\n\n\nCannot load HRTF data files, exiting\n\n"));
+
+    p->irlength = irlength;
+    p->irlengthpad = irlengthpad;
+    p->overlapsize = overlapsize;
+    p->nsrc = nsrc;
+    p->fade = fade;
+    p->counter = 0;
+
+    csound->AuxAlloc(csound, nsrc * irlength * sizeof(MYFLT), &p->insig);
+    csound->AuxAlloc(csound, nsrc * sizeof(int32_t), &p->cur);
+    csound->AuxAlloc(csound, nsrc * sizeof(int32_t), &p->old);
+    csound->AuxAlloc(csound, nsrc * sizeof(int32_t), &p->fading);
+    csound->AuxAlloc(csound, irlengthpad * sizeof(MYFLT), &p->complexinsig);
+    csound->AuxAlloc(csound, irlengthpad * sizeof(MYFLT), &p->outspecl);
+    csound->AuxAlloc(csound, irlengthpad * sizeof(MYFLT), &p->outspecr);
+    csound->AuxAlloc(csound, irlengthpad * sizeof(MYFLT), &p->outl);
+    csound->AuxAlloc(csound, irlengthpad * sizeof(MYFLT), &p->outr);
+    csound->AuxAlloc(csound, overlapsize * sizeof(MYFLT), &p->overlapl);
+    csound->AuxAlloc(csound, overlapsize * sizeof(MYFLT), &p->overlapr);
+    /* AuxAlloc zeroes; reset positions so the first block does not fade */
+    cur = (int32_t *) p->cur.auxp;
+    for (i = 0; i < nsrc; i++)
+      cur[i] = -1;
+
+    p->setup_pad =
+      csound->RealFFTSetupFor(csound, irlengthpad, FFT_FWD, &p->h);
+    p->isetup_pad =
+      csound->RealFFTSetupFor(csound, irlengthpad, FFT_INV, &p->h);
+    return OK;
+}
+
+static void hrtfbus_block(CSOUND *csound, hrtfbus *p)
+{
+    int32_t irlength = p->irlength, irlengthpad = p->irlengthpad;
+    int32_t overlapsize = p->overlapsize, fade = p->fade;
+    int32_t nsrc = p->nsrc, s, i, pt;
+    MYFLT *insig = (MYFLT *) p->insig.auxp;
+    MYFLT *complexinsig = (MYFLT *) p->complexinsig.auxp;
+    MYFLT *outspecl = (MYFLT *) p->outspecl.auxp;
+    MYFLT *outspecr = (MYFLT *) p->outspecr.auxp;
+    MYFLT *outl = (MYFLT *) p->outl.auxp, *outr = (MYFLT *) p->outr.auxp;
+    MYFLT *overlapl = (MYFLT *) p->overlapl.auxp;
+    MYFLT *overlapr = (MYFLT *) p->overlapr.auxp;
+    int32_t *cur = (int32_t *) p->cur.auxp, *old = (int32_t *) p->old.auxp;
+    int32_t *fading = (int32_t *) p->fading.auxp;
+    const MYFLT *spec = p->data->spec, *h;
+    MYFLT *kangle = p->kangle->data, *kelev = p->kelev->data, w;
+    /* hrtfstat's output scaling, folded into the gains */
+    MYFLT scale = FL(38000.0) / p->data->sr;
+
+    for(i = 0; i < overlapsize; i++)
+      {
+        overlapl[i] = outl[i + irlength];
+        overlapr[i] = outr[i + irlength];
+      }
+    memset(outspecl, 0, irlengthpad * sizeof(MYFLT));
+    memset(outspecr, 0, irlengthpad * sizeof(MYFLT));
+
+    for (s = 0; s < nsrc; s++) {
+      pt = hrtf_nearest(kangle[s], kelev[s]);
+      if (pt != cur[s]) {
+        if (cur[s] >= 0) {
+          old[s] = cur[s];
+          fading[s] = fade;
+        }
+        cur[s] = pt;
+      }
+
+      memcpy(complexinsig, insig + s * irlength, irlength * sizeof(MYFLT));
+      memset(complexinsig + irlength, 0,
+             (irlengthpad - irlength) * sizeof(MYFLT));
+      csound->RealFFT(csound, p->setup_pad, complexinsig);
+
+      /* stepped crossfade from the previous measurement */
+      w = FL(0.0);
+      if (fading[s] > 0) {
+        w = (MYFLT) fading[s] / (fade + 1);
+        fading[s]--;
+        h = spec + 2 * old[s] * irlengthpad;
+        hrtf_macc(outspecl, h, complexinsig, irlengthpad, w * scale);
+        hrtf_macc(outspecr, h + irlengthpad, complexinsig, irlengthpad,
+                  w * scale);
+      }
+      h = spec + 2 * cur[s] * irlengthpad;
+      hrtf_macc(outspecl, h, complexinsig, irlengthpad, (FL(1.0) - w) * scale);
+      hrtf_macc(outspecr, h + irlengthpad, complexinsig, irlengthpad,
+                (FL(1.0) - w) * scale);
+    }
+
+    /* one inverse fft per ear for all sources */
+    csound->RealFFT(csound, p->isetup_pad, outspecl);
+    csound->RealFFT(csound, p->isetup_pad, outspecr);
+
+    for(i = 0; i < irlengthpad; i++)
+      {
+        outl[i] = outspecl[i] + (i < overlapsize ? overlapl[i] : FL(0.0));
+        outr[i] = outspecr[i] + (i < overlapsize ? overlapr[i] : FL(0.0));
+      }
+}
+
+static int32_t hrtfbus_process(CSOUND *csound, hrtfbus *p)
+{
+    MYFLT *outsigl = p->outsigl, *outsigr = p->outsigr;
+    MYFLT *in = p->in->data;
+    MYFLT *insig = (MYFLT *) p->insig.auxp;
+    MYFLT *outl = (MYFLT *) p->outl.auxp, *outr = (MYFLT *) p->outr.auxp;
+    int32_t counter = p->counter, irlength = p->irlength, s;
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t j, m, nsmps = CS_KSMPS, ksmps = CS_KSMPS;
+
+    if (UNLIKELY(offset)) {
+      memset(outsigl, '\0', offset*sizeof(MYFLT));
+      memset(outsigr, '\0', offset*sizeof(MYFLT));
+    }
+    if (UNLIKELY(early)) {
+      nsmps -= early;
+      memset(&outsigl[nsmps], '\0', early*sizeof(MYFLT));
+      memset(&outsigr[nsmps], '\0', early*sizeof(MYFLT));
+    }
+    for (j = offset; j < nsmps; j += m) {
+      m = irlength - counter;
+      if (m > nsmps - j)
+        m = nsmps - j;
+      for (s = 0; s < p->nsrc; s++)
+        memcpy(insig + s * irlength + counter, in + s * ksmps + j,
+               m * sizeof(MYFLT));
+      memcpy(outsigl + j, outl + counter, m * sizeof(MYFLT));
+      memcpy(outsigr + j, outr + counter, m * sizeof(MYFLT));
+      counter += m;
+      if (counter == irlength) {
+        hrtfbus_block(csound, p);
+        counter = 0;
+      }
+    }
+    p->counter = counter;
+    return OK;
+}
+
 /* see csound manual (extending csound) for details of below */
 static OENTRY hrtfopcodes_localops[] =
 {
  { "hrtfmove", sizeof(hrtfmove),0,  "aa", "akkSSooo",
-    (SUBR)hrtfmove_init, (SUBR)hrtfmove_process },
+    (SUBR)hrtfmove_init, (SUBR)hrtfmove_process, (SUBR)hrtfmove_deinit },
  { "hrtfstat", sizeof(hrtfstat),0,  "aa", "aiiSSoo",
-    (SUBR)hrtfstat_init, (SUBR)hrtfstat_process },
+    (SUBR)hrtfstat_init, (SUBR)hrtfstat_process, (SUBR)hrtfstat_deinit },
  { "hrtfmove2",  sizeof(hrtfmove2),0,  "aa", "akkSSooo",
-    (SUBR)hrtfmove2_init, (SUBR)hrtfmove2_process }
+    (SUBR)hrtfmove2_init, (SUBR)hrtfmove2_process, (SUBR)hrtfmove2_deinit },
+ { "hrtfbus",  sizeof(hrtfbus),0,  "aa", "a[]k[]k[]SSoo",
+    (SUBR)hrtfbus_init, (SUBR)hrtfbus_process, (SUBR)hrtfbus_deinit }
 };
 
 LINKAGE_BUILTIN(hrtfopcodes_localops)
@@ -228,6 +228,13 @@ typedef struct
 
 }hrtfreverb;
 
+/* hands back the FFT setups asked for at init */
+static int32_t hrtfreverb_deinit(CSOUND *csound, hrtfreverb *p)
+{
+  csound->ReleaseFFTSetups(csound, &p->h);
+  return OK;
+}
+
 int32_t hrtfreverb_init(CSOUND *csound, hrtfreverb *p)
 {
   /* left and right data files: spectral mag, phase format */
@@ -878,10 +885,12 @@ int32_t hrtfreverb_init(CSOUND *csound, hrtfreverb *p)
   p->inoldl = 0;
   p->inoldr = 0;
   p->M = M;
-  p->setup_pad = csound->RealFFTSetup(csound, p->irlengthpad, FFT_FWD);
-  p->setup = csound->RealFFTSetup(csound, p->irlength, FFT_FWD);
-  p->isetup_pad = csound->RealFFTSetup(csound, p->irlengthpad, FFT_INV);
-  p->isetup = csound->RealFFTSetup(csound, p->irlength, FFT_INV);
+  p->setup_pad =
+    csound->RealFFTSetupFor(csound, p->irlengthpad, FFT_FWD, &p->h);
+  p->setup = csound->RealFFTSetupFor(csound, p->irlength, FFT_FWD, &p->h);
+  p->isetup_pad =
+    csound->RealFFTSetupFor(csound, p->irlengthpad, FFT_INV, &p->h);
+  p->isetup = csound->RealFFTSetupFor(csound, p->irlength, FFT_INV, &p->h);
 
   return OK;
 }
@@ -1345,7 +1354,8 @@ int32_t hrtfreverb_process(CSOUND *csound, hrtfreverb *p)
 static OENTRY hrtfreverb_localops[] =
   {        {
       "hrtfreverb", sizeof(hrtfreverb), 0, "aai", "aiiSSoop",
-      (SUBR)hrtfreverb_init, (SUBR)hrtfreverb_process
+      (SUBR)hrtfreverb_init, (SUBR)hrtfreverb_process,
+      (SUBR)hrtfreverb_deinit
     }
   };
 
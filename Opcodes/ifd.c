@@ -56,6 +56,13 @@ typedef struct _ifd {
   void  *setup;
 } IFD;
 
+/* hands back the FFT setup asked for at init */
+static int32_t ifd_deinit(CSOUND * csound, IFD * p)
+{
+  csound->ReleaseFFTSetups(csound, &p->h);
+  return OK;
+}
+
 static int32_t ifd_init(CSOUND * csound, IFD * p)
 {
   int32_t     fftsize, hopsize, frames;
@@ -155,7 +162,7 @@ static int32_t ifd_init(CSOUND * csound, IFD * p)
 
   p->factor = CS_ESR / TWOPI_F;
   p->fund = CS_ESR / fftsize;
-  p->setup = csound->RealFFTSetup(csound, fftsize, FFT_FWD);
+  p->setup = csound->RealFFTSetupFor(csound, fftsize, FFT_FWD, &p->h);
   return OK;
 }
 
@@ -391,7 +398,7 @@ static int32_t tifd_process(CSOUND * csound, IFD * p)
 static OENTRY localops[] =
   {
    { "pvsifd", sizeof(IFD), 0,  "ff", "aiiip",
-     (SUBR) ifd_init, (SUBR) ifd_process},
+     (SUBR) ifd_init, (SUBR) ifd_process, (SUBR) ifd_deinit},
    { "tabifd", sizeof(IFD), 0,  "ff", "kkkiiii",
      (SUBR) tifd_init, (SUBR) tifd_process}
   };
@@ -244,6 +244,13 @@ static void set_buf_pointers(liveconv_t *p, int32_t partSize, int32_t nPartition
     p->loader.begin = (load_t*) ptr;
 }
 
+/* hands back the FFT setups asked for at init */
+static int32_t liveconv_deinit(CSOUND *csound, liveconv_t *p)
+{
+    csound->ReleaseFFTSetups(csound, &p->h);
+    return OK;
+}
+
 static int32_t liveconv_init(CSOUND *csound, liveconv_t *p)
 {
     FUNC    *ftp;       // function table
@@ -302,8 +309,10 @@ static int32_t liveconv_init(CSOUND *csound, liveconv_t *p)
     p->cnt = 0;
     p->rbCnt = 0;
 
-    p->fwdsetup = csound->RealFFTSetup(csound, (p->partSize << 1), FFT_FWD);
-    p->invsetup = csound->RealFFTSetup(csound, (p->partSize << 1), FFT_INV);
+    p->fwdsetup =
+      csound->RealFFTSetupFor(csound, (p->partSize << 1), FFT_FWD, &p->h);
+    p->invsetup =
+      csound->RealFFTSetupFor(csound, (p->partSize << 1), FFT_INV, &p->h);
 
     /* clear IR buffer to zero */
     memset(p->IR_Data, 0, n*sizeof(MYFLT));
@@ -519,7 +528,8 @@ static OENTRY liveconv_localops[] = {
     "a",                    // output arguments
     "aiikk",                // input arguments
     (SUBR) liveconv_init,   // init function
-    (SUBR) liveconv_perf    // a-rate function
+    (SUBR) liveconv_perf,   // a-rate function
+    (SUBR) liveconv_deinit  // releases the FFT setups
   }
 };
 
@@ -49,6 +49,7 @@ typedef struct {
   uint8_t  *buf;
   AUXCH    auxch;
   FDCH     fdch;
+  SNDMEMFILE *pcm;        /* decoded frames, once there are any */
 } MP3IN;
 
 
@@ -61,13 +62,97 @@ typedef struct {
 
 int32_t mp3in_cleanup(CSOUND *csound, MP3IN *p)
 {
-  IGN(csound);
   if (LIKELY(p->mpa != NULL))
     mp3dec_uninit(p->mpa);
   p->mpa = NULL;
+  csound->ReleaseDecodedSoundFile(csound, p->pcm);
+  p->pcm = NULL;
   return OK;
 }
 
+/* decode a whole file for the cache of decoded sound files, as the     */
+/* 16 bit frames mp3in plays in the given mode, unless they would take */
+/* more than maxBytes; runs in a thread of its own                     */
+static SNDMEMFILE *mp3in_decode(CSOUND *csound, const char *fullName,
+                                size_t maxBytes, int32_t mode)
+{
+  mpadec_config_t config = { MPADEC_CONFIG_FULL_QUALITY, MPADEC_CONFIG_STEREO,
+                             MPADEC_CONFIG_16BIT, MPADEC_CONFIG_LITTLE_ENDIAN,
+                             MPADEC_CONFIG_REPLAYGAIN_NONE, TRUE, TRUE, TRUE,
+                             0.0 };
+  mpadec_info_t mpainfo;
+  mp3dec_t mpa;
+  SNDMEMFILE *snd = NULL;
+  short    bb[8*1152*2];
+  uint32_t used;
+  int32_t  nch = (mode == MPADEC_CONFIG_MONO ? 1 : 2);
+  size_t   i, n = 0, maxFrames = 65536;
+  size_t   limit = maxBytes / (nch * sizeof(MYFLT));
+  FILE     *f = fopen(fullName, "rb");
+
+  if (f == NULL)
+    return NULL;
+  /* the decoder is given the file itself, not a Csound file handle */
+  if ((mpa = mp3dec_init(csound)) == NULL) {
+    fclose(f);
+    return NULL;
+  }
+  config.mode = mode;
+  if (mp3dec_configure(mpa, &config) == MP3DEC_RETCODE_OK &&
+      mp3dec_init_file(mpa, f, 0, FALSE) == MP3DEC_RETCODE_OK &&
+      mp3dec_get_info(mpa, &mpainfo, MPADEC_INFO_STREAM) ==
+      MP3DEC_RETCODE_OK &&
+      (mpainfo.frames <= 0 || mpainfo.decoded_frame_samples <= 0 ||
+       (uint64_t) mpainfo.frames * mpainfo.decoded_frame_samples
+       <= (uint64_t) limit)) {
+    mp3dec_seek(mpa, 0, MP3DEC_SEEK_SAMPLES);
+    if (maxFrames > limit)
+      maxFrames = limit;
+    snd = (SNDMEMFILE *) csound->Calloc(csound, sizeof(SNDMEMFILE)
+                                        + maxFrames * nch * sizeof(MYFLT));
+    while (mp3dec_decode(mpa, (uint8_t *) bb, sizeof(bb), &used) ==
+           MP3DEC_RETCODE_OK && used > 0) {
+      size_t m = used / (nch * sizeof(short));
+      if (n + m > maxFrames) {
+        if (n + m > limit) {            /* too long after all */
+          csound->Free(csound, snd);
+          snd = NULL;
+          break;
+        }
+        while (n + m > maxFrames)
+          maxFrames = (maxFrames < limit / 2 ? maxFrames * 2 : limit);
+        snd = (SNDMEMFILE *) csound->ReAlloc(csound, snd, sizeof(SNDMEMFILE)
+                                             + maxFrames * nch * sizeof(MYFLT));
+      }
+      for (i = 0; i < nch * m; i++)
+        snd->data[nch * n + i] = (MYFLT) bb[i] / (MYFLT) 0x7fff;
+      n += m;
+    }
+    if (snd != NULL) {
+      snd->nFrames = n;
+      snd->sampleRate = (double) mpainfo.frequency;
+      snd->nChannels = nch;
+      snd->sampleFormat = AE_SHORT;
+      snd->fileType = TYP_MPEG;
+    }
+  }
+  mp3dec_uninit(mpa);
+  fclose(f);
+  return snd;
+}
+
+static SNDMEMFILE *mp3in_decode_mono(CSOUND *csound, const char *fullName,
+                                     size_t maxBytes)
+{
+  return mp3in_decode(csound, fullName, maxBytes, MPADEC_CONFIG_MONO);
+}
+
+static SNDMEMFILE *mp3in_decode_stereo(CSOUND *csound, const char *fullName,
+                                       size_t maxBytes)
+{
+  return mp3in_decode(csound, fullName, maxBytes, MPADEC_CONFIG_STEREO);
+}
+
 
 int32_t mp3ininit_(CSOUND *csound, MP3IN *p, int32_t stringname)
 {
@@ -84,6 +169,7 @@ int32_t mp3ininit_(CSOUND *csound, MP3IN *p, int32_t stringname)
   /* uint64_t maxsize; */
   int32_t r;
   int32_t skip;
+  void    *fd;
   if (p->OUTOCOUNT==1) config.mode = MPADEC_CONFIG_MONO;
   /* if already open, close old file first */
   if (p->fdch.fd != NULL) {
@@ -115,7 +201,7 @@ int32_t mp3ininit_(CSOUND *csound, MP3IN *p, int32_t stringname)
   else strncpy(name, ((STRINGDAT *)p->iFileCode)->data, 1023);
 
 
-  if (UNLIKELY(mp3dec_open_file(mpa, name, &f) == NULL)) {
+  if (UNLIKELY((fd = mp3dec_open_file(mpa, name, &f)) == NULL)) {
     mp3dec_uninit(mpa);
     return
       csound->InitError(csound, Str("mp3in: %s: failed to open file"), name);
@@ -171,6 +257,28 @@ int32_t mp3ininit_(CSOUND *csound, MP3IN *p, int32_t stringname)
                                 "!= orchestra sr (%d)\n"),
                     mpainfo.frequency, (int32_t) (CS_ESR + FL(0.5)));
   }
+  /* once the file has been decoded, play it from the decoded frames; */
+  /* the first time, decoding starts in the background                */
+  csound->ReleaseDecodedSoundFile(csound, p->pcm);
+  if (config.mode == MPADEC_CONFIG_MONO)
+    p->pcm = csound->DecodedSoundFile(csound, csound->GetFileName(fd), 0,
+                                      "mpadec-mono", mp3in_decode_mono);
+  else
+    p->pcm = csound->DecodedSoundFile(csound, csound->GetFileName(fd), 0,
+                                      "mpadec", mp3in_decode_stereo);
+  if (p->pcm != NULL) {
+    /* the decoding below leaves the last block it skips in the buffer, */
+    /* to be played first: start where that block does                 */
+    int32_t block = buffersize / mpainfo.decoded_sample_size;
+    mp3dec_uninit(mpa);
+    p->mpa = NULL;
+    p->r = MP3DEC_RETCODE_OK;
+    p->initDone = -1;
+    p->pos = 0;
+    if (skip > 0 && block > 0)
+      p->pos = skip - ((skip - 1) % block + 1);
+    return OK;
+  }
   /* initialise buffer */
   mp3dec_seek(mpa,0, MP3DEC_SEEK_SAMPLES);
   p->bufSize = buffersize;
@@ -208,6 +316,44 @@ int32_t mp3ininit_S(CSOUND *csound, MP3IN *p){
 }
 
 
+/* mp3in from the decoded frames */
+static int32_t mp3in_decoded(CSOUND *csound, MP3IN *p)
+{
+  const SNDMEMFILE *snd = p->pcm;
+  MYFLT   *al     = p->ar[0];
+  MYFLT   *ar     = p->ar[1];
+  MYFLT   scl     = csound->Get0dBFS(csound);
+  int64_t pos     = p->pos;
+  int64_t nframes = (int64_t) snd->nFrames;
+  uint32_t early  = p->h.insdshead->ksmps_no_end;
+  uint32_t offset = p->h.insdshead->ksmps_offset;
+  uint32_t n, nsmps = CS_KSMPS;
+
+  if (UNLIKELY(offset)) {
+    memset(al, '\0', offset*sizeof(MYFLT));
+    if(p->OUTCOUNT > 1)  memset(ar, '\0', offset*sizeof(MYFLT));
+  }
+  if (UNLIKELY(early)) {
+    nsmps -= early;
+    memset(&al[nsmps], '\0', early*sizeof(MYFLT));
+   if(p->OUTCOUNT > 1)  memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
+  }
+  for (n=offset; n<nsmps && pos < nframes; n++, pos++) {
+    if (snd->nChannels == 1)
+      al[n] = snd->data[pos] * scl;
+    else {
+      al[n] = snd->data[2 * pos] * scl;
+      ar[n] = snd->data[2 * pos + 1] * scl;
+    }
+  }
+  if (n < nsmps) {                      /* past the end */
+    memset(&al[n], 0, (nsmps-n)*sizeof(MYFLT));
+    if(p->OUTCOUNT > 1) memset(&ar[n], 0, (nsmps-n)*sizeof(MYFLT));
+  }
+  p->pos = pos;
+  return OK;
+}
+
 int32_t mp3in(CSOUND *csound, MP3IN *p)
 {
   int32_t r       = p->r;
@@ -220,6 +366,8 @@ int32_t mp3in(CSOUND *csound, MP3IN *p)
   uint32_t offset = p->h.insdshead->ksmps_offset;
   uint32_t i, n, nsmps = CS_KSMPS;
 
+  if (p->pcm != NULL)
+    return mp3in_decoded(csound, p);
   if (UNLIKELY(offset)) {
     memset(al, '\0', offset*sizeof(MYFLT));
     if(p->OUTCOUNT > 1)  memset(ar, '\0', offset*sizeof(MYFLT));
@@ -357,7 +505,7 @@ typedef struct dats{
 
 int32_t mp3scale_cleanup(CSOUND *csound, DATASPACE *p)
 {
-  IGN(csound);
+  csound->ReleaseFFTSetups(csound, &p->h);
   if (p->mpa != NULL)
     mp3dec_uninit(p->mpa);
   return OK;
@@ -429,8 +577,8 @@ static int32_t sinit(CSOUND *csound, DATASPACE *p)
   /*clock_gettime(CLOCK_MONOTONIC, &ts);
     dtime = ts.tv_sec + 1e-9*ts.tv_nsec - dtime;
     csound->Message(csound, "SINIT time %f ms", dtime*1000);*/
-  p->fwdsetup = csound->RealFFTSetup(csound,N,FFT_FWD);
-  p->invsetup = csound->RealFFTSetup(csound,N,FFT_INV);
+  p->fwdsetup = csound->RealFFTSetupFor(csound,N,FFT_FWD,&p->h);
+  p->invsetup = csound->RealFFTSetupFor(csound,N,FFT_INV,&p->h);
   return OK;
 }
 
@@ -25,6 +25,7 @@
 #include "stdopcod.h"
 
 #include "newfils.h"
+#include "lockstep.h"
 #include <math.h>
 
 #define TABSIZE 20000
@@ -79,22 +80,13 @@ static int32_t moogladder_init(CSOUND *csound, moogladder *p)
   return OK;
 }
 
-static int32_t moogladder_process(CSOUND *csound, moogladder *p)
+/* tuning and feedback gain for k-rate frequency and resonance */
+static double moogladder_tune(CSOUND *csound, moogladder *p, double *ptune)
 {
-  MYFLT   *out = p->out;
-  MYFLT   *in = p->in;
   MYFLT   freq = *p->freq;
   MYFLT   res = *p->res;
-  double  res4;
-  double  *delay = p->delay;
-  double  *tanhstg = p->tanhstg;
-  double  stg[4], input;
   double  acr, tune;
   double vt = 1./(1.22070315*csound->Get0dBFS(csound)); /* (1.0 / 40000.0) transistor thermal voltage  */
-  int32_t     j;
-  uint32_t offset = p->h.insdshead->ksmps_offset;
-  uint32_t early  = p->h.insdshead->ksmps_no_end;
-  uint32_t i, nsmps = CS_KSMPS;
 
   if (res < 0) res = 0;
 
@@ -119,7 +111,26 @@ static int32_t moogladder_process(CSOUND *csound, moogladder *p)
     acr = p->oldacr;
     tune = p->oldtune;
   }
-  res4 = 4.0*(double)res*acr;
+  *ptune = tune;
+  return 4.0*(double)res*acr;
+}
+
+static int32_t moogladder_process(CSOUND *csound, moogladder *p)
+{
+  MYFLT   *out = p->out;
+  MYFLT   *in = p->in;
+  double  res4;
+  double  *delay = p->delay;
+  double  *tanhstg = p->tanhstg;
+  double  stg[4], input;
+  double  tune;
+  double vt = 1./(1.22070315*csound->Get0dBFS(csound)); /* (1.0 / 40000.0) transistor thermal voltage  */
+  int32_t     j;
+  uint32_t offset = p->h.insdshead->ksmps_offset;
+  uint32_t early  = p->h.insdshead->ksmps_no_end;
+  uint32_t i, nsmps = CS_KSMPS;
+
+  res4 = moogladder_tune(csound, p, &tune);
 
   if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
   if (UNLIKELY(early)) {
@@ -162,6 +173,87 @@ static int32_t moogladder_process(CSOUND *csound, moogladder *p)
   return OK;
 }
 
+/* moogladder for voices in lockstep.  Each stage takes the tanh of all
+   lanes in one call, to the engine's math functions in double builds.  */
+#ifdef USE_DOUBLE
+#define LANES_TANH(t, x, n) ls->math->tanhv(t, x, n)
+#else
+#define LANES_TANH(t, x, n)                     \
+  { int32_t k_; for (k_ = 0; k_ < n; k_++) t[k_] = tanh(x[k_]); }
+#endif
+
+static int32_t moogladder_lanes(CSOUND *csound, const LOCKSTEP *ls,
+                                OPDS **pp, int32_t n, char *err)
+{
+  moogladder *p[LOCKSTEP_LANES];
+  const MYFLT *in[LOCKSTEP_LANES];
+  double  delay[6][LOCKSTEP_LANES], tanhstg[3][LOCKSTEP_LANES];
+  double  res4[LOCKSTEP_LANES], tune[LOCKSTEP_LANES];
+  double  x[2*LOCKSTEP_LANES], t[2*LOCKSTEP_LANES], stg;
+  double vt = 1./(1.22070315*csound->Get0dBFS(csound));
+  int32_t  j, k, l, m, v = 0;
+  uint32_t i, nsmps = csound->ksmps;
+  IGN(ls);
+  IGN(err);
+
+  while (v < n) {
+    for (m = 0; v < n && m < LOCKSTEP_LANES; v++, m++) {
+      p[m] = (moogladder*) pp[v];
+      res4[m] = moogladder_tune(csound, p[m], &tune[m]);
+      in[m] = p[m]->in;
+      for (k = 0; k < 6; k++) delay[k][m] = p[m]->delay[k];
+      for (k = 0; k < 3; k++) tanhstg[k][m] = p[m]->tanhstg[k];
+    }
+    for (l = m; l < LOCKSTEP_LANES; l++) {   /* spare lanes */
+      res4[l] = res4[0]; tune[l] = tune[0]; in[l] = in[0];
+      for (k = 0; k < 6; k++) delay[k][l] = delay[k][0];
+      for (k = 0; k < 3; k++) tanhstg[k][l] = tanhstg[k][0];
+    }
+    for (i = 0; i < nsmps; i++) {
+      /* oversampling  */
+      for (j = 0; j < 2; j++) {
+        /* filter stages  */
+        for (l = 0; l < LOCKSTEP_LANES; l++)
+          x[l] = (in[l][i] - res4[l]*delay[5][l])*vt;
+        LANES_TANH(t, x, LOCKSTEP_LANES);
+        for (l = 0; l < LOCKSTEP_LANES; l++) {
+          delay[0][l] = delay[0][l] + tune[l]*(t[l] - tanhstg[0][l]);
+          x[l] = delay[0][l]*vt;
+        }
+        LANES_TANH(t, x, LOCKSTEP_LANES);
+        for (l = 0; l < LOCKSTEP_LANES; l++) {
+          stg = delay[1][l] + tune[l]*((tanhstg[0][l] = t[l]) - tanhstg[1][l]);
+          delay[1][l] = stg;
+          x[l] = stg*vt;
+        }
+        LANES_TANH(t, x, LOCKSTEP_LANES);
+        for (l = 0; l < LOCKSTEP_LANES; l++) {
+          stg = delay[2][l] + tune[l]*((tanhstg[1][l] = t[l]) - tanhstg[2][l]);
+          delay[2][l] = stg;
+          x[l] = stg*vt;
+          x[LOCKSTEP_LANES + l] = delay[3][l]*vt;
+        }
+        LANES_TANH(t, x, 2*LOCKSTEP_LANES);
+        for (l = 0; l < LOCKSTEP_LANES; l++) {
+          stg = delay[3][l] + tune[l]*((tanhstg[2][l] = t[l]) -
+                                       t[LOCKSTEP_LANES + l]);
+          delay[3][l] = stg;
+          /* 1/2-sample delay for phase compensation  */
+          delay[5][l] = (stg + delay[4][l])*0.5;
+          delay[4][l] = stg;
+        }
+      }
+      for (l = 0; l < m; l++)
+        p[l]->out[i] = (MYFLT) delay[5][l];
+    }
+    for (l = 0; l < m; l++) {
+      for (k = 0; k < 6; k++) p[l]->delay[k] = delay[k][l];
+      for (k = 0; k < 3; k++) p[l]->tanhstg[k] = tanhstg[k][l];
+    }
+  }
+  return OK;
+}
+
 static int32_t moogladder_process_aa(CSOUND *csound, moogladder *p)
 {
   MYFLT   *out = p->out;
@@ -3761,6 +3853,8 @@ static OENTRY localops[] =
 
 int32_t newfils_init_(CSOUND *csound)
 {
+  (void) csoundLockstepRegister(csound, (SUBR) moogladder_process,
+                                moogladder_lanes);
   return csound->AppendOpcodes(csound, &(localops[0]),
                                (int32_t
                                 ) (sizeof(localops) / sizeof(OENTRY)));
@@ -24,6 +24,12 @@
 #include "stdopcod.h"
 #include "oscbnk.h"
 #include <math.h>
+#if defined(WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
 
 static inline STDOPCOD_GLOBALS *get_oscbnk_globals(CSOUND *csound)
 {
@@ -301,6 +307,7 @@ static int32_t oscbnkset(CSOUND *csound, OSCBNK *p)
   MYFLT    x;
 
   p->init_k = 1;
+  p->lanes = csound->GetOParms(csound)->vector_lanes;
   p->nr_osc = (int32_t) MYFLT2LONG(*(p->args[5]));        /* number of oscs */
   if (p->nr_osc <= 0) p->nr_osc = -1;                     /* no output */
   oscbnk_seedrand(csound, &(p->seed), *(p->args[6]));     /* random seed */
@@ -429,6 +436,62 @@ static int32_t oscbnkset(CSOUND *csound, OSCBNK *p)
 
 /* ---------------- oscbnk performance ---------------- */
 
+/* Render OSCBNK_LANES oscillators without EQ and with integer phase.   */
+/* Phase, frequency and amplitude are held as arrays so that the table  */
+/* reads of all lanes can be done together; lanes are mixed to the     */
+/* output in oscillator order, giving the same result as the scalar     */
+/* loop.                                                                */
+
+static void oscbnk_lanes(OSCBNK *p, OSCBNK_OSC *o, MYFLT *ft, uint32 lobits,
+                         uint32 mask, MYFLT pfrac, int32_t pm_enabled,
+                         int32_t am_enabled, uint32_t offset, uint32_t nsmps)
+{
+  uint32  ph[OSCBNK_LANES], f_i[OSCBNK_LANES], n;
+  MYFLT   a[OSCBNK_LANES], a_d[OSCBNK_LANES], k[OSCBNK_LANES];
+  MYFLT   pm, f, x, *out = p->args[0];
+  uint32_t nn;
+  int32_t l;
+
+  for (l = 0; l < OSCBNK_LANES; l++, o++) {
+    if (p->init_k) oscbnk_lfo(p, o);
+    ph[l] = o->osc_phs;
+    pm = o->osc_phm;
+    if ((p->init_k) && (pm_enabled)) {
+      f = pm - (MYFLT) ((int32) pm);
+      ph[l] = (ph[l] + OSCBNK_PHS2INT(f)) & OSCBNK_PHSMSK;
+    }
+    a[l] = o->osc_amp;
+    f = o->osc_frq;
+    oscbnk_lfo(p, o);
+    f = ((o->osc_frq + f) * FL(0.5) + *(p->args[1])) * p->frq_scl;
+    if (pm_enabled) {
+      f += (MYFLT) ((double) o->osc_phm - (double) pm) / (nsmps-offset);
+      f -= (MYFLT) ((int32) f);
+    }
+    f_i[l] = OSCBNK_PHS2INT(f);
+    a_d[l] = am_enabled ? (o->osc_amp - a[l]) / (nsmps-offset) : FL(0.0);
+  }
+  o -= OSCBNK_LANES;
+
+  for (nn = offset; nn < nsmps; nn++) {
+    for (l = 0; l < OSCBNK_LANES; l++) {
+      n = ph[l] >> lobits; x = ft[n];
+      k[l] = x + (ft[n + 1] - x) * (MYFLT) ((int32) (ph[l] & mask)) * pfrac;
+      ph[l] = (ph[l] + f_i[l]) & OSCBNK_PHSMSK;
+    }
+    if (am_enabled)
+      for (l = 0; l < OSCBNK_LANES; l++)
+        k[l] *= (a[l] += a_d[l]);
+    for (l = 0; l < OSCBNK_LANES; l++)
+      out[nn] += k[l];
+  }
+
+  for (l = 0; l < OSCBNK_LANES; l++, o++) {
+    o->osc_amp = a[l];
+    o->osc_phs = ph[l];
+  }
+}
+
 static int32_t oscbnk(CSOUND *csound, OSCBNK *p)
 {
   int32_t osc_cnt, pm_enabled, am_enabled;
@@ -484,7 +547,14 @@ static int32_t oscbnk(CSOUND *csound, OSCBNK *p)
   }
 
   if (UNLIKELY(early)) nsmps -= early;
-  for (osc_cnt = 0, o = p->osc; osc_cnt < p->nr_osc; osc_cnt++, o++) {
+  osc_cnt = 0; o = p->osc;
+  if (p->lanes && p->ieqmode < 0 && !floatph) {
+    for ( ; osc_cnt + OSCBNK_LANES <= p->nr_osc;
+          osc_cnt += OSCBNK_LANES, o += OSCBNK_LANES)
+      oscbnk_lanes(p, o, ft, lobits, mask, pfrac, pm_enabled, am_enabled,
+                   offset, nsmps);
+  }
+  for ( ; osc_cnt < p->nr_osc; osc_cnt++, o++) {
     if (p->init_k) oscbnk_lfo(p, o);
     ph = o->osc_phs;   /* phase        */
     phf = o->osc_phsf;
@@ -624,6 +694,7 @@ static int32_t oscbnk(CSOUND *csound, OSCBNK *p)
     /* save amplitude and phase */
     o->osc_amp = a;
     o->osc_phs = ph;
+    o->osc_phsf = phf;
   }
   p->init_k = 0;
   return OK;
@@ -647,6 +718,7 @@ static int32_t grain2set(CSOUND *csound, GRAIN2 *p)
   if (i & 1) return OK;               /* skip initialisation */
   p->init_k = 1;
   p->mode = i & 0x0E;
+  p->lanes = csound->GetOParms(csound)->vector_lanes;
   p->nr_osc = (int32_t) MYFLT2LONG(*(p->iovrlp));   /* nr of oscillators */
   if (p->nr_osc < 1) p->nr_osc = -1;
   oscbnk_seedrand(csound, &(p->seed), *(p->iseed)); /* initialise seed */
@@ -674,6 +746,10 @@ static int32_t grain2set(CSOUND *csound, GRAIN2 *p)
   if ((p->auxdata.auxp == NULL) || (p->auxdata.size < n))
     csound->AuxAlloc(csound, n, &(p->auxdata));
   p->osc = (GRAIN2_OSC *) p->auxdata.auxp;
+  /* grain and window phases, frequencies, and output of each grain */
+  n = (uint32_t) p->nr_osc * (3 * sizeof(uint32) + sizeof(MYFLT));
+  if (p->lanes && ((p->lanedata.auxp == NULL) || (p->lanedata.size < n)))
+    csound->AuxAlloc(csound, n, &(p->lanedata));
 
   /* initialise oscillators */
   if(p->floatph) {
@@ -839,11 +915,64 @@ static int32_t grain2(CSOUND *csound, GRAIN2 *p)
     }
   }
   aout = p->ar;                       /* audio output         */
+  if (!floatph && p->lanes) {
+    /* Advance all grains for a sample as one vector loop over arrays, */
+    /* then mix and start new grains in grain order, as the scalar     */
+    /* loop below does.                                                */
+    int32_t  nr_osc = p->nr_osc;
+    MYFLT    *g_out = (MYFLT *) p->lanedata.auxp;
+    uint32   *g_phs = (uint32 *) (g_out + nr_osc);
+    uint32   *g_frq_int = g_phs + nr_osc, *w_phs = g_frq_int + nr_osc;
+    uint32   g, w;
+
+    for (i = 0; i < nr_osc; i++) {
+      g_phs[i] = o[i].grain_phs;
+      g_frq_int[i] = o[i].grain_frq_int;
+      w_phs[i] = o[i].window_phs;
+    }
+    for (nn = offset; nn<nsmps; nn++) {
+      for (i = 0; i < nr_osc; i++) {
+        /* grain waveform */
+        g = g_phs[i];
+        n = g >> lobits; k = ft[n];
+        if (g_interp)
+          k += (ft[n + 1] - k) * (MYFLT) ((int32) (g & mask)) * pfrac;
+        g_phs[i] = (g + g_frq_int[i]) & OSCBNK_PHSMSK;
+        /* window waveform */
+        w = w_phs[i];
+        n = w >> w_lobits; a = w_ft[n];
+        if (w_interp)
+          a += (w_ft[n + 1] - a) * (MYFLT) ((int32) (w & w_mask)) * w_pfrac;
+        w_phs[i] = w + w_frq;
+        g_out[i] = a * k;
+      }
+      for (i = 0; i < nr_osc; i++) {
+        /* mix to output */
+        aout[nn] += g_out[i];
+        if (w_phs[i] >= OSCBNK_PHSMAX) {
+          w_phs[i] &= OSCBNK_PHSMSK;            /* new grain    */
+          grain2_init_grain(p, o + i);
+          /* grain frequency */
+          if (f_nolock) {
+            f = grain_frq + frq_scl * o[i].grain_frq_flt;
+            o[i].grain_frq_int = OSCBNK_PHS2INT(f);
+          }
+          g_phs[i] = o[i].grain_phs;
+          g_frq_int[i] = o[i].grain_frq_int;
+        }
+      }
+    }
+    for (i = 0; i < nr_osc; i++) {
+      o[i].grain_phs = g_phs[i];
+      o[i].window_phs = w_phs[i];
+    }
+    return OK;
+  }
   for (nn = offset; nn<nsmps; nn++) {
     i = p->nr_osc;
     do {
-      /* grain waveform */
       if(!floatph) {
+        /* grain waveform */
         n = o->grain_phs >> lobits; k = ft[n++];
         if (g_interp)
           k += (ft[n] - k) * (MYFLT) ((int32) (o->grain_phs & mask)) * pfrac;
@@ -865,6 +994,7 @@ static int32_t grain2(CSOUND *csound, GRAIN2 *p)
           }
         }
       } else {
+        /* grain waveform */
         MYFLT pos = o->grain_phsf*flen;
         n = (int32_t) pos;
         k = ft[n];
@@ -874,14 +1004,14 @@ static int32_t grain2(CSOUND *csound, GRAIN2 *p)
         pos = o->window_phsf*wflen;
         n = (int32_t) pos;
         a = w_ft[n];
-        if (w_interp) a += (pos - n)*(w_ft[n+1] - k);
+        if (w_interp) a += (pos - n)*(w_ft[n+1] - a);
         o->window_phsf += wf;
         if (o->window_phsf >= FL(1.0)) {
           o->window_phs = PHMOD1(o->window_phs);       /* new grain    */
           grain2_init_grain(p, o);
           /* grain frequency */
           if (f_nolock) {
-            o->grain_frq = grain_frq + frq_scl * o->grain_frq_flt;   
+            o->grain_frq = grain_frq + frq_scl * o->grain_frq_flt;
           }
         }
       }
@@ -910,6 +1040,7 @@ static int32_t grain3set(CSOUND *csound, GRAIN3 *p)
   if (i & 1) return OK;                  /* skip initialisation */
   p->init_k = 1;
   p->mode = i & 0x7E;
+  p->lanes = csound->GetOParms(csound)->vector_lanes;
   p->x_phs = OSCBNK_PHSMAX;
 
   p->ovrlap = (int32_t) MYFLT2LONG(*(p->imaxovr));        /* max. overlap */
@@ -1149,7 +1280,7 @@ static int32_t grain3(CSOUND *csound, GRAIN3 *p)
 
   nn = nsmps; o = p->osc_start;
   while (nn>offset) {
-    if(!floatph) {    
+    if(!floatph) {
       if (x_ph >= OSCBNK_PHSMAX) {      /* check for new grain  */
         x_ph &= OSCBNK_PHSMSK;
         if (!(p->mode & 0x20)) {
@@ -1173,88 +1304,127 @@ static int32_t grain3(CSOUND *csound, GRAIN3 *p)
         else {
           w_phf = FL(0.0);
         }
-        grain3_init_grain_f(p, p->osc_end, w_phf, *phs);
+        grain3_init_grain_f(p, p->osc_end, w_phf, *phsf);
         if (++(p->osc_end) > p->osc_max) p->osc_end = p->osc;
         if (UNLIKELY(p->osc_end == p->osc_start)) goto err2;
       }
+    }
 
-      if (o == p->osc_end) {            /* no active grains     */
-        x_ph += x_frq; nn--; aout0++; phs++; continue;
-        x_phf += x_frq_f;
-      }
+    if (o == p->osc_end) {            /* no active grains     */
+      if(!floatph) { x_ph += x_frq; phs++; }
+      else { x_phf += x_frq_f; phsf++; }
+      nn--; aout0++; continue;
+    }
 
-      if(!floatph) {
-        g_ph = o->grain_phs;              /* grain phase          */
-        if (f_nolock) {
-          /* grain frequency */
-          f = o->grain_frq_flt * frq_scl;
-          g_frq = OSCBNK_PHS2INT(f);
-          g_frq = (g_frq + frq) & OSCBNK_PHSMSK;
-        }
-        else {                    /* lock frequency       */
-          g_frq = o->grain_frq_int;
-        }
-        w_ph = o->window_phs;             /* window phase         */
-      } else {
-        g_phf = o->grain_phsf;              /* grain phase          */
-        if (f_nolock) {
-          /* grain frequency */
-          f = o->grain_frq_flt * frq_scl;
-          g_frqf = f;
-          g_frq = PHMOD1(g_frqf + frqf);
-        }
-        else {                    /* lock frequency       */
-          g_frqf = o->grain_frq;
-        }
-        w_phf = o->window_phsf;             /* window phase         */
+    if(!floatph) {
+      g_ph = o->grain_phs;              /* grain phase          */
+      if (f_nolock) {
+        /* grain frequency */
+        f = o->grain_frq_flt * frq_scl;
+        g_frq = OSCBNK_PHS2INT(f);
+        g_frq = (g_frq + frq) & OSCBNK_PHSMSK;
       }
+      else {                    /* lock frequency       */
+        g_frq = o->grain_frq_int;
+      }
+      w_ph = o->window_phs;             /* window phase         */
+    }
+    if(!floatph && !p->lanes) {
       /* render grain */
       aout = aout0; i = nn;
       while (i--) {
-        if(!floatph) {
-          /* window waveform */
-          n = w_ph >> w_lobits; a = w_ft[n++];
-          if (w_interp) a += (w_ft[n] - a) * w_pfrac
-                          * (MYFLT) ((int32) (w_ph & w_mask));
-          /* grain waveform */
-          n = g_ph >> lobits; k = ft[n++];
-          if (g_interp) k += (ft[n] - k) * pfrac
-                          * (MYFLT) ((int32) (g_ph & mask));
-          /* update phase */
-          g_ph = (g_ph + g_frq) & OSCBNK_PHSMSK;
-          /* check for end of grain */
-          if ((w_ph += w_frq) >= OSCBNK_PHSMAX) {
-            if (++(p->osc_start) > p->osc_max)
-              p->osc_start = p->osc;
-            break;
-          }
+        /* window waveform */
+        n = w_ph >> w_lobits; a = w_ft[n++];
+        if (w_interp) a += (w_ft[n] - a) * w_pfrac
+                        * (MYFLT) ((int32) (w_ph & w_mask));
+        /* grain waveform */
+        n = g_ph >> lobits; k = ft[n++];
+        if (g_interp) k += (ft[n] - k) * pfrac
+                        * (MYFLT) ((int32) (g_ph & mask));
+        /* update phase */
+        g_ph = (g_ph + g_frq) & OSCBNK_PHSMSK;
+        /* check for end of grain */
+        if ((w_ph += w_frq) >= OSCBNK_PHSMAX) {
+          if (++(p->osc_start) > p->osc_max)
+            p->osc_start = p->osc;
+          break;
         }
-        else {
-          /* window waveform */
-          MYFLT pos = w_phf*wflen;
-          n = (int32_t) pos;
-          a = w_ft[n];
-          if (w_interp) a += (pos - n)*(w_ft[n+1] - k);
-          /* grain waveform */
-          pos = g_phf*flen;
-          n = (int32_t) pos;
-          k = ft[n];
-          if (g_interp) k += (pos - n)*(ft[n+1] - k);
-          g_phf = PHMOD1(g_phf+ g_frqf);
-          /* check for end of grain */
-          if ((w_phf += w_frq_f) >= FL(1.0)) {
-            if (++(p->osc_start) > p->osc_max)
-              p->osc_start = p->osc;
-            break;
-          }
+        /* mix to output */
+        *(aout++) += a * k;
+      }
+      /* save phase */
+      o->grain_phs = g_ph; o->window_phs = w_ph;
+    }
+    else if(!floatph) {
+      uint32 j, m, r;
+      /* render grain: the number of samples before the window ends is  */
+      /* known in advance, so the loop below has no exit test and the   */
+      /* phases of each sample are computed independently               */
+      r = (OSCBNK_PHSMAX - 1UL - w_ph) / w_frq;
+      m = (r < nn ? r : nn);
+      aout = aout0;
+      for (j = 0; j < m; j++) {
+        uint32 wp = w_ph + j * w_frq;
+        uint32 gp = (g_ph + j * g_frq) & OSCBNK_PHSMSK;
+        /* window waveform */
+        n = wp >> w_lobits; a = w_ft[n];
+        if (w_interp) a += (w_ft[n + 1] - a) * w_pfrac
+                        * (MYFLT) ((int32) (wp & w_mask));
+        /* grain waveform */
+        n = gp >> lobits; k = ft[n];
+        if (g_interp) k += (ft[n + 1] - k) * pfrac
+                        * (MYFLT) ((int32) (gp & mask));
+        /* mix to output */
+        aout[j] += a * k;
+      }
+      g_ph = (g_ph + m * g_frq) & OSCBNK_PHSMSK;
+      w_ph += m * w_frq;
+      if (m < nn) {                     /* end of grain         */
+        g_ph = (g_ph + g_frq) & OSCBNK_PHSMSK;
+        w_ph += w_frq;
+        if (++(p->osc_start) > p->osc_max)
+          p->osc_start = p->osc;
+      }
+      /* save phase */
+      o->grain_phs = g_ph; o->window_phs = w_ph;
+    }
+    else {
+      g_phf = o->grain_phsf;              /* grain phase          */
+      if (f_nolock) {
+        /* grain frequency */
+        f = o->grain_frq_flt * frq_scl;
+        g_frqf = PHMOD1(f + frqf);
+      }
+      else {                    /* lock frequency       */
+        g_frqf = o->grain_frq;
+      }
+      w_phf = o->window_phsf;             /* window phase         */
+      /* render grain */
+      aout = aout0; i = nn;
+      while (i--) {
+        /* window waveform */
+        MYFLT pos = w_phf*wflen;
+        n = (int32_t) pos;
+        a = w_ft[n];
+        if (w_interp) a += (pos - n)*(w_ft[n+1] - a);
+        /* grain waveform */
+        pos = g_phf*flen;
+        n = (int32_t) pos;
+        k = ft[n];
+        if (g_interp) k += (pos - n)*(ft[n+1] - k);
+        g_phf = PHMOD1(g_phf+ g_frqf);
+        /* check for end of grain */
+        if ((w_phf += w_frq_f) >= FL(1.0)) {
+          if (++(p->osc_start) > p->osc_max)
+            p->osc_start = p->osc;
+          break;
         }
         /* mix to output */
         *(aout++) += a * k;
       }
+      /* save phase */
+      o->grain_phsf = g_phf; o->window_phsf = w_phf;
     }
-    /* save phase */
-    o->grain_phs = g_ph; o->window_phs = w_ph;
-    o->grain_phsf = g_phf; o->window_phsf = w_phf;
     /* next grain */
     if (++o > p->osc_max) o = p->osc;
   }
@@ -1942,9 +2112,11 @@ static void vco2_delete_table_array(CSOUND *csound, int32_t w)
   /* free number of partials list, */
   csound->Free(csound, pp->vco2_tables[w]->nparts);
 #endif
-  /* table data (only if not shared as standard Csound ftables), */
+  /* table data (only if not shared as standard Csound ftables, */
+  /* or through the process-wide cache),                          */
   for (j = 0; j < pp->vco2_tables[w]->ntabl; j++) {
-    if (pp->vco2_tables[w]->base_ftnum < 1)
+    if (pp->vco2_tables[w]->base_ftnum < 1 &&
+        !pp->vco2_tables[w]->tables[j].shared)
       csound->Free(csound, pp->vco2_tables[w]->tables[j].ftable);
   }
   /* table list, */
@@ -1963,6 +2135,7 @@ static void vco2_calculate_table(CSOUND *csound,
   MYFLT   *fftbuf;
   int32_t     i, minh;
     void *setup;
+    OPDS fftkey;          /* only its address is used, to own the setup */
 
   if (UNLIKELY(table->ftable == NULL)) {
     csound->InitError(csound,
@@ -2018,8 +2191,9 @@ static void vco2_calculate_table(CSOUND *csound,
   /* inverse FFT */
   fftbuf[1] = fftbuf[table->size];
   fftbuf[table->size] = fftbuf[(int32_t) table->size + 1] = FL(0.0);
-  setup = csound->RealFFTSetup(csound,table->size,FFT_INV);
+  setup = csound->RealFFTSetupFor(csound,table->size,FFT_INV,&fftkey);
   csound->RealFFT(csound,setup,fftbuf);
+  csound->ReleaseFFTSetups(csound, &fftkey);
   /* copy to table */
   for (i = 0; i < table->size; i++)
     table->ftable[i] = fftbuf[i];
@@ -2029,6 +2203,152 @@ static void vco2_calculate_table(CSOUND *csound,
   csound->Free(csound, fftbuf);
 }
 
+/* Tables of the built-in waveforms depend only on the waveform, the     */
+/* number of partials, the table size and the FFT library that computed  */
+/* them, so they are computed once per process and shared read-only by   */
+/* all engines. If CS_VCO2_CACHE names a directory, tables are also      */
+/* stored there, after a header identifying them, and loaded on later    */
+/* runs.                                                                 */
+
+#define VCO2_CACHE_BUCKETS  64
+
+typedef struct VCO2_CACHED_ {
+  struct VCO2_CACHED_ *next;
+  int32_t waveform, npart, size, fftlib;
+  MYFLT   data[1];            /* size + 1 floats                          */
+} VCO2_CACHED;
+
+static VCO2_CACHED  *vco2_cache[VCO2_CACHE_BUCKETS];
+static static_lock_t vco2_cache_lock = STATIC_LOCK_INIT;
+static volatile long vco2_cache_stores = 0;
+
+/* stored tables start with this header; a file that does not match the */
+/* table wanted, or was written by a differently built Csound, is       */
+/* computed again and overwritten                                       */
+
+#define VCO2_CACHE_VERSION  1
+
+typedef struct {
+  char    magic[8];
+  int32_t version, sampleSize, byteOrder;
+  int32_t waveform, npart, size, fftlib;
+} VCO2_CACHE_HEADER;
+
+static const char vco2_cache_magic[8] = { 'C','S','V','C','O','2','T','B' };
+
+static void vco2_cache_header(VCO2_CACHE_HEADER *hdr, const VCO2_CACHED *e)
+{
+  memset(hdr, 0, sizeof(VCO2_CACHE_HEADER));
+  memcpy(hdr->magic, vco2_cache_magic, sizeof(vco2_cache_magic));
+  hdr->version = VCO2_CACHE_VERSION;
+  hdr->sampleSize = (int32_t) sizeof(MYFLT);
+  hdr->byteOrder = 0x01020304;
+  hdr->waveform = e->waveform;
+  hdr->npart = e->npart;
+  hdr->size = e->size;
+  hdr->fftlib = e->fftlib;
+}
+
+static VCO2_CACHED *vco2_cache_find(int32_t waveform, int32_t npart,
+                                    int32_t size, int32_t fftlib, uint32_t h)
+{
+  VCO2_CACHED *e;
+  for (e = vco2_cache[h]; e != NULL; e = e->next)
+    if (e->waveform == waveform && e->npart == npart && e->size == size &&
+        e->fftlib == fftlib)
+      return e;
+  return NULL;
+}
+
+static void vco2_cache_path(CSOUND *csound, char *path, size_t len,
+                            const char *dir, VCO2_TABLE *table,
+                            VCO2_TABLE_PARAMS *tp, int32_t fftlib)
+{
+  IGN(csound);
+  snprintf(path, len, "%s/vco2-%d-%d-%d-%d-%d.tab", dir, tp->waveform,
+           (int32_t) table->npart, (int32_t) table->size,
+           (int32_t) sizeof(MYFLT), fftlib);
+}
+
+/* return the cached data of a built-in waveform table, generating it if */
+/* needed; NULL if out of memory                                         */
+
+static MYFLT *vco2_cached_table(CSOUND *csound, VCO2_TABLE *table,
+                                VCO2_TABLE_PARAMS *tp)
+{
+  int32_t     fftlib = csound->GetOParms(csound)->fft_lib;
+  uint32_t    h = ((uint32_t) tp->waveform * 7919U
+                   + (uint32_t) table->npart * 31U + (uint32_t) table->size
+                   + (uint32_t) fftlib * 131U) % VCO2_CACHE_BUCKETS;
+  size_t      n = (size_t) table->size + 1;
+  const char  *dir = csound->GetEnv(csound, "CS_VCO2_CACHE");
+  char        path[1024];
+  VCO2_CACHED *e, *e2;
+  MYFLT       *ftable = table->ftable;
+  FILE        *f;
+  int32_t     loaded = 0;
+
+  csoundStaticLock(&vco2_cache_lock);
+  e = vco2_cache_find(tp->waveform, table->npart, table->size, fftlib, h);
+  csoundStaticUnLock(&vco2_cache_lock);
+  if (e != NULL)
+    return e->data;
+
+  /* not cached: load or calculate outside the lock */
+  e = (VCO2_CACHED*) malloc(sizeof(VCO2_CACHED) + (n - 1) * sizeof(MYFLT));
+  if (UNLIKELY(e == NULL))
+    return NULL;
+  e->waveform = tp->waveform;
+  e->npart = table->npart;
+  e->size = table->size;
+  e->fftlib = fftlib;
+  if (dir != NULL && dir[0] != '\0') {
+    vco2_cache_path(csound, path, sizeof(path), dir, table, tp, fftlib);
+    if ((f = fopen(path, "rb")) != NULL) {
+      VCO2_CACHE_HEADER want, hdr;
+      vco2_cache_header(&want, e);
+      loaded = (fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+                !memcmp(&hdr, &want, sizeof(hdr)) &&
+                fread(e->data, sizeof(MYFLT), n, f) == n && fgetc(f) == EOF);
+      fclose(f);
+    }
+  }
+  if (!loaded) {
+    table->ftable = e->data;
+    vco2_calculate_table(csound, table, tp);
+    table->ftable = ftable;
+    if (dir != NULL && dir[0] != '\0') {
+      char tmp[1040];
+      long serial = ATOMIC_INCR(vco2_cache_stores);
+      VCO2_CACHE_HEADER hdr;
+      vco2_cache_header(&hdr, e);
+      /* write to a temporary file first, so that concurrent readers */
+      /* never see a partial table                                    */
+      snprintf(tmp, sizeof(tmp), "%s.%d.%ld", path, (int32_t) getpid(),
+               serial);
+      if ((f = fopen(tmp, "wb")) != NULL) {
+        int32_t ok = (fwrite(&hdr, sizeof(hdr), 1, f) == 1 &&
+                      fwrite(e->data, sizeof(MYFLT), n, f) == n);
+        if (fclose(f) != 0 || !ok || rename(tmp, path) != 0)
+          remove(tmp);
+      }
+    }
+  }
+
+  csoundStaticLock(&vco2_cache_lock);
+  e2 = vco2_cache_find(tp->waveform, table->npart, table->size, fftlib, h);
+  if (e2 == NULL) {
+    e->next = vco2_cache[h];
+    vco2_cache[h] = e;
+  }
+  csoundStaticUnLock(&vco2_cache_lock);
+  if (e2 != NULL) {             /* another engine got there first */
+    free(e);
+    e = e2;
+  }
+  return e->data;
+}
+
 /* set default table parameters depending on waveform */
 
 static void vco2_default_table_params(int32_t w, VCO2_TABLE_PARAMS *tp)
@@ -2096,8 +2416,8 @@ static int32_t vco2_tables_create(CSOUND *csound, int32_t waveform,
   double            npart_f;
   VCO2_TABLE_ARRAY  *tables;
   VCO2_TABLE_PARAMS tp2;
+  MYFLT             *cached;
  
-
   /* set default table parameters if not specified in tp */
   if (tp == NULL) {
     if (waveform < 0) return -1;
@@ -2165,6 +2485,9 @@ static int32_t vco2_tables_create(CSOUND *csound, int32_t waveform,
                       &(tables->tables[i].mask),
                       &(tables->tables[i].lobits),
                       &(tables->tables[i].pfrac));
+    /* built-in waveforms come from the process-wide cache */
+    cached = (tp->waveform >= 0 ?
+              vco2_cached_table(csound, &(tables->tables[i]), tp) : NULL);
     /* if base ftable was specified, generate empty table ... */
     if (base_ftable > 0) {
       FUNC *ftp;
@@ -2173,13 +2496,21 @@ static int32_t vco2_tables_create(CSOUND *csound, int32_t waveform,
       ftp = csound->FTFind(csound, &ftable);
       tables->tables[i].ftable = ftp->ftable;
       base_ftable++;                /* next table number */
+      if (cached != NULL)
+        memcpy(ftp->ftable, cached,
+               sizeof(MYFLT) * (tables->tables[i].size + 1));
+    }
+    else if (cached != NULL) {    /* ... or share the cached data, */
+      tables->tables[i].ftable = cached;
+      tables->tables[i].shared = 1;
     }
     else    /* ... else allocate memory (cannot be accessed as a       */
       tables->tables[i].ftable =      /* standard Csound ftable) */
         (MYFLT*) csound->Malloc(csound, sizeof(MYFLT)
                                 * (tables->tables[i].size + 1));
     /* now calculate the table */
-    vco2_calculate_table(csound, &(tables->tables[i]), tp);
+    if (cached == NULL)
+      vco2_calculate_table(csound, &(tables->tables[i]), tp);
     /* next table */
     vco2_next_npart(&npart_f, tp);
   } while (++i < ntables);
@@ -2278,8 +2609,9 @@ static int32_t vco2init(CSOUND *csound, VCO2INIT *p)
       tp.w_fftbuf = (MYFLT*) csound->Malloc(csound, sizeof(MYFLT) * (i + 2));
       for (j = 0; j < ftp->flen; j++)
         tp.w_fftbuf[j] = ftp->ftable[j] / (MYFLT) (ftp->flen >> 1);
-      setup = csound->RealFFTSetup(csound, ftp->flen, FFT_FWD);
+      setup = csound->RealFFTSetupFor(csound, ftp->flen, FFT_FWD, &p->h);
       csound->RealFFT(csound, setup, tp.w_fftbuf);
+      csound->ReleaseFFTSetups(csound, &p->h);
       tp.w_fftbuf[ftp->flen] = tp.w_fftbuf[1];
       tp.w_fftbuf[1] = tp.w_fftbuf[(int32_t) ftp->flen + 1] = FL(0.0);
       /* generate table array */
@@ -44,6 +44,7 @@
 #define OSCBNK_PHSMAX   0x80000000UL    /* max. phase   */
 #define OSCBNK_PHSMSK   0x7FFFFFFFUL    /* phase mask   */
 #define OSCBNK_RNDPHS   0               /* 31 bit rand -> phase bit shift */
+#define OSCBNK_LANES    8               /* oscillators per vector kernel  */
 
 /* convert floating point phase value to integer */
 
@@ -95,6 +96,7 @@ typedef struct {
         int32    outft_len;              /* (optional)                   */
         int32    tabl_cnt;               /* current param in table       */
         int32    floatph, flen1, flen2;
+        int32_t     lanes;                  /* --vector-lanes               */
         AUXCH   auxdata;
         OSCBNK_OSC      *osc;           /* oscillator array             */
 } OSCBNK;
@@ -125,8 +127,10 @@ typedef struct {
         MYFLT   *wft, wft_pfrac;        /* window table                 */
         uint32   wft_lobits, wft_mask;
         int32   floatph, wflen;
+        int32_t     lanes;                  /* --vector-lanes               */
         AUXCH   auxdata;
         GRAIN2_OSC      *osc;           /* oscillator array             */
+        AUXCH   lanedata;               /* grain phases as arrays       */
 } GRAIN2;
 
 /* -------- grain3 types -------- */
@@ -154,6 +158,7 @@ typedef struct {
         MYFLT   *wft, wft_pfrac;        /* window table                 */
         uint32   wft_lobits, wft_mask;
   int32   wflen, floatph;
+        int32_t     lanes;                  /* --vector-lanes               */
         double  x_phsf, *phasef;
         AUXCH   auxdata;
         uint32   *phase;         /* grain phase offset           */
@@ -221,6 +226,7 @@ typedef struct {
             lobits, mask;       /*   and interpolation                       */
     MYFLT   pfrac;
     MYFLT   *ftable;            /* table data (size + 1 floats)              */
+    int32_t shared;             /* ftable is in the process-wide cache       */
 } VCO2_TABLE;
 
 struct VCO2_TABLE_ARRAY_ {
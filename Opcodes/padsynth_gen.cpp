@@ -468,6 +468,7 @@ static int32_t padsynth_gen(FGDATA *ff, FUNC *ftp) {
   MYFLT p1_function_table_number = ff->fno;
   MYFLT p2_score_time = ff->e.p[2];
   void *setup;
+  OPDS fftkey; // only its address is used, to own the FFT setup
   int32_t N = ff->flen;
   if (N <= 0) return csound->FtError(ff, Str("Illegal table size %d"), N);
 
@@ -557,8 +558,9 @@ static int32_t padsynth_gen(FGDATA *ff, FUNC *ftp) {
     spectrum[complexI].imag(real * std::sin(random_phase));
   };
   spectrum[0].imag(0);
-  setup = csound->RealFFTSetup(csound,N,FFT_INV);
+  setup = csound->RealFFTSetupFor(csound,N,FFT_INV,&fftkey);
   csound->RealFFT(csound,setup,ftp->ftable);
+  csound->ReleaseFFTSetups(csound, &fftkey);
   // Normalize,
   MYFLT maximum = FL(0.0);
   for (int32_t i = 0; i < N; ++i) {
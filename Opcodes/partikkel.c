@@ -313,9 +313,11 @@ static int32_t partikkel_init(CSOUND *csound, PARTIKKEL *p)
     p->distindex = 0;
     p->synced = 0;
     p->graininc = 0.0;
+    p->lanes = csound->GetOParms(csound)->vector_lanes;
 
-    /* allocate memory for the grain mix buffer */
-    size = CS_KSMPS*sizeof(MYFLT);
+    /* allocate memory for the grain mix buffer, followed by the fm
+     * envelope and wave phase buffers used while rendering a grain */
+    size = CS_KSMPS*(2*sizeof(MYFLT) + sizeof(double));
     if (p->aux.auxp == NULL || p->aux.size < size)
         csound->AuxAlloc(csound, size, &p->aux);
     else
@@ -675,9 +677,73 @@ static int32_t schedule_grains(CSOUND *csound, PARTIKKEL *p)
 
 /* Main synthesis loops */
 /* NOTE: the main synthesis loop is duplicated for both wavetable and
- * trainlet synthesis for speed */
+ * trainlet synthesis for speed. Each first runs the phase accumulator on
+ * its own, storing the phases in phs, so that the table reads, which no
+ * longer depend on the previous sample, can be vectorised.
+ * fmenv holds the fm envelope of the grain, or is NULL if there is no fm */
 static inline void render_wave(PARTIKKEL *p, GRAIN *grain, WAVEDATA *wav,
-                               MYFLT *buf, uint32_t stop)
+                               MYFLT *buf, const MYFLT *fmenv, double *phs,
+                               uint32_t stop)
+{
+    uint32_t n;
+    const double tablen = (double)wav->table->flen;
+    const MYFLT *ftable = wav->table->ftable;
+    const MYFLT gain = wav->gain;
+
+    for (n = grain->start; n < stop; ++n) {
+        /* make sure phase accumulator stays within bounds */
+        while (UNLIKELY(wav->phase >= tablen))
+            wav->phase -= tablen;
+        while (UNLIKELY(wav->phase < 0.0))
+            wav->phase += tablen;
+        phs[n] = wav->phase;
+        if (fmenv != NULL)
+            wav->phase += wav->delta + wav->delta*p->fm[n]*grain->fmamp*fmenv[n];
+        else
+            wav->phase += wav->delta;
+        /* apply sweep */
+        wav->delta = wav->delta*wav->sweepdecay + wav->sweepoffset;
+    }
+
+    /* wavetable synthesis */
+    for (n = grain->start; n < stop; ++n) {
+        /* sample table lookup with linear interpolation */
+        const uint32_t x0 = (uint32_t)phs[n];
+        const MYFLT frac = (MYFLT)(phs[n] - x0);
+        buf[n] += lrp(ftable[x0], ftable[x0 + 1], frac)*gain;
+    }
+}
+
+static inline void render_trainlet(PARTIKKEL *p, GRAIN *grain, WAVEDATA *wav,
+                                   MYFLT *buf, const MYFLT *fmenv,
+                                   double *phs, uint32_t stop)
+{
+    uint32_t n;
+
+    for (n = grain->start; n < stop; ++n) {
+        while (UNLIKELY(wav->phase >= 1.0))
+            wav->phase -= 1.0;
+        while (UNLIKELY(wav->phase < 0.0))
+            wav->phase += 1.0;
+        phs[n] = wav->phase;
+        if (fmenv != NULL)
+            wav->phase += wav->delta + wav->delta*p->fm[n]*grain->fmamp*fmenv[n];
+        else
+            wav->phase += wav->delta;
+        wav->delta = wav->delta*wav->sweepdecay + wav->sweepoffset;
+    }
+
+    /* dsf/trainlet synthesis */
+    for (n = grain->start; n < stop; ++n)
+        buf[n] += wav->gain*dsf(p->costab, grain, phs[n], p->zscale,
+                                p->cosineshift);
+}
+
+/* the same, one sample at a time, reading the fm envelope per waveform;
+ * used with --no-vector-lanes */
+static inline void render_wave_serial(PARTIKKEL *p, GRAIN *grain,
+                                      WAVEDATA *wav, MYFLT *buf,
+                                      uint32_t stop)
 {
     uint32_t n;
     double fmenvphase = grain->envphase;
@@ -701,20 +767,21 @@ static inline void render_wave(PARTIKKEL *p, GRAIN *grain, WAVEDATA *wav,
         frac = (MYFLT)(wav->phase - x0);
         buf[n] += lrp(wav->table->ftable[x0], wav->table->ftable[x0 + 1],
                       frac)*wav->gain;
-        if(floatph) 
-          fmenv = grain->fmenvtab->ftable[(size_t) (fmenvphase*flen)];
-        else 
-        fmenv = grain->fmenvtab->ftable[(size_t)(fmenvphase*FMAXLEN)
-                                        >> grain->fmenvtab->lobits];
+        if (floatph)
+            fmenv = grain->fmenvtab->ftable[(size_t)(fmenvphase*flen)];
+        else
+            fmenv = grain->fmenvtab->ftable[(size_t)(fmenvphase*FMAXLEN)
+                                            >> grain->fmenvtab->lobits];
         fmenvphase += grain->envinc;
         wav->phase += wav->delta + wav->delta*p->fm[n]*grain->fmamp*fmenv;
         /* apply sweep */
         wav->delta = wav->delta*wav->sweepdecay + wav->sweepoffset;
-     }
+    }
 }
 
-static inline void render_trainlet(PARTIKKEL *p, GRAIN *grain, WAVEDATA *wav,
-                                   MYFLT *buf, uint32_t stop)
+static inline void render_trainlet_serial(PARTIKKEL *p, GRAIN *grain,
+                                          WAVEDATA *wav, MYFLT *buf,
+                                          uint32_t stop)
 {
     uint32_t n;
     double fmenvphase = grain->envphase;
@@ -733,11 +800,11 @@ static inline void render_trainlet(PARTIKKEL *p, GRAIN *grain, WAVEDATA *wav,
         /* dsf/trainlet synthesis */
         buf[n] += wav->gain*dsf(p->costab, grain, wav->phase, p->zscale,
                                 p->cosineshift);
-        if(floatph) 
-          fmenv = grain->fmenvtab->ftable[(size_t) (fmenvphase*flen)];
-        else 
-        fmenv = grain->fmenvtab->ftable[(size_t)(fmenvphase*FMAXLEN)
-                                        >> grain->fmenvtab->lobits];
+        if (floatph)
+            fmenv = grain->fmenvtab->ftable[(size_t)(fmenvphase*flen)];
+        else
+            fmenv = grain->fmenvtab->ftable[(size_t)(fmenvphase*FMAXLEN)
+                                            >> grain->fmenvtab->lobits];
         fmenvphase += grain->envinc;
         wav->phase += wav->delta + wav->delta*p->fm[n]*grain->fmamp*fmenv;
         wav->delta = wav->delta*wav->sweepdecay + wav->sweepoffset;
@@ -755,10 +822,28 @@ static inline void render_grain(CSOUND *csound, PARTIKKEL *p, GRAIN *grain)
     uint32_t stop = grain->stop > CS_KSMPS
                     ? CS_KSMPS : grain->stop;
     MYFLT *buf = (MYFLT *)p->aux.auxp;
+    MYFLT *fmenv = buf + CS_KSMPS;
+    double *phs = (double *)(fmenv + CS_KSMPS);
     int32_t floatph = p->floatph, flen2 = p->env2_tab->flen;
 
     if (grain->start >= CS_KSMPS)
         return; /* grain starts at a later kperiod */
+
+    /* the fm envelope is shared by all waveforms, so read it once */
+    if (grain->fmamp != FL(0.0) && p->lanes) {
+        double fmenvphase = grain->envphase;
+        int32_t flen = p->fmenvtab->flen;
+        for (n = grain->start; n < stop; ++n) {
+            if (floatph)
+                fmenv[n] = grain->fmenvtab->ftable[(size_t)(fmenvphase*flen)];
+            else
+                fmenv[n] = grain->fmenvtab->ftable[(size_t)(fmenvphase*FMAXLEN)
+                                                   >> grain->fmenvtab->lobits];
+            fmenvphase += grain->envinc;
+        }
+    } else
+        fmenv = NULL;
+
     for (i = 0; i < 5; ++i) {
         WAVEDATA *curwav = &grain->wav[i];
 
@@ -766,10 +851,16 @@ static inline void render_grain(CSOUND *csound, PARTIKKEL *p, GRAIN *grain)
         if (curwav->table == NULL)
             continue;
 
-        if (i != WAV_TRAINLET)
-            render_wave(p, grain, curwav, buf, stop);
+        if (!p->lanes) {
+            if (i != WAV_TRAINLET)
+                render_wave_serial(p, grain, curwav, buf, stop);
+            else
+                render_trainlet_serial(p, grain, curwav, buf, stop);
+        }
+        else if (i != WAV_TRAINLET)
+            render_wave(p, grain, curwav, buf, fmenv, phs, stop);
         else
-            render_trainlet(p, grain, curwav, buf, stop);
+            render_trainlet(p, grain, curwav, buf, fmenv, phs, stop);
     }
 
     /* apply envelopes */
@@ -158,6 +158,7 @@ typedef struct PARTIKKEL {
     double grainphase, graininc;
     FUNC *pantab;
     int32_t floatph;
+    int32_t lanes;      /* split phase and lookup passes, --vector-lanes */
 } PARTIKKEL;
 
 typedef struct {
@@ -172,8 +172,15 @@ static int32_t ps_init(CSOUND* csound, PAULSTRETCH *p)
     }
     p->start_pos = FL(0.0);
     p->counter = 0;
-    p->setup = csound->RealFFTSetup(csound, p->windowsize, FFT_FWD);
-    p->isetup = csound->RealFFTSetup(csound, p->windowsize, FFT_INV);
+    p->setup = csound->RealFFTSetupFor(csound, p->windowsize, FFT_FWD, &p->h);
+    p->isetup = csound->RealFFTSetupFor(csound, p->windowsize, FFT_INV, &p->h);
+    return OK;
+}
+
+/* hands back the FFT setups asked for at init */
+static int32_t ps_deinit(CSOUND* csound, PAULSTRETCH *p)
+{
+    csound->ReleaseFFTSetups(csound, &p->h);
     return OK;
 }
 
@@ -206,7 +213,8 @@ static int32_t paulstretch_perf(CSOUND* csound, PAULSTRETCH *p)
 static OENTRY paulstretch_localops[] = {
   { "paulstretch", (int32_t) sizeof(PAULSTRETCH), TR,  "a", "iii",
     (int32_t (*)(CSOUND *, void *)) ps_init,
-    (int32_t (*)(CSOUND *, void *)) paulstretch_perf}
+    (int32_t (*)(CSOUND *, void *)) paulstretch_perf,
+    (int32_t (*)(CSOUND *, void *)) ps_deinit}
 };
 
 LINKAGE_BUILTIN(paulstretch_localops)
@@ -240,7 +240,7 @@ int32_t pvinterpset_(CSOUND *csound, PVINTERP *p, int32_t stringname)
   /* for (i = 0; i< pvfrsiz(p); ++i) */
   /*   p->outBuf[i] = FL(0.0); */
   MakeSinc(p->pp);                    /* sinctab is same for all instances */
-  p->setup = csound->RealFFTSetup(csound, pvfrsiz(p), FFT_INV);
+  p->setup = csound->RealFFTSetupFor(csound, pvfrsiz(p), FFT_INV, &p->h);
 
   return OK;
 }
@@ -433,7 +433,7 @@ int32_t pvcrossset_(CSOUND *csound, PVCROSS *p, int32_t stringname)
   if (p->memenv.auxp == NULL || p->memenv.size < pvdasiz(p)*sizeof(MYFLT))
     csound->AuxAlloc(csound, pvdasiz(p) * sizeof(MYFLT), &p->memenv);
 
-  p->setup = csound->RealFFTSetup(csound, pvfrsiz(p), FFT_INV);
+  p->setup = csound->RealFFTSetupFor(csound, pvfrsiz(p), FFT_INV, &p->h);
   return OK;
 }
 
@@ -73,6 +73,12 @@ typedef struct dats1 {
   void *fwdsetup, *invsetup;
 } DATASPACEM;
 
+/* hands back the FFT setups an opcode asked for at init */
+static int32_t fft_deinit(CSOUND *csound, void *p)
+{
+    csound->ReleaseFFTSetups(csound, (OPDS *) p);
+    return OK;
+}
 
 static int32_t sinit(CSOUND *csound, DATASPACE *p)
 {
@@ -137,8 +143,8 @@ static int32_t sinit(CSOUND *csound, DATASPACE *p)
     p->N = N;
     p->decim = decim;
 
-    p->fwdsetup = csound->RealFFTSetup(csound, N, FFT_FWD);
-    p->invsetup = csound->RealFFTSetup(csound, N, FFT_INV);
+    p->fwdsetup = csound->RealFFTSetupFor(csound, N, FFT_FWD, &p->h);
+    p->invsetup = csound->RealFFTSetupFor(csound, N, FFT_INV, &p->h);
 
     return OK;
 }
@@ -206,8 +212,8 @@ static int32_t sinitm(CSOUND *csound, DATASPACEM *p)
     p->N = N;
     p->decim = decim;
 
-    p->fwdsetup = csound->RealFFTSetup(csound, N, FFT_FWD);
-    p->invsetup = csound->RealFFTSetup(csound, N, FFT_INV);
+    p->fwdsetup = csound->RealFFTSetupFor(csound, N, FFT_FWD, &p->h);
+    p->invsetup = csound->RealFFTSetupFor(csound, N, FFT_INV, &p->h);
 
     return OK;
 }
@@ -1662,15 +1668,15 @@ int32_t am_fm(CSOUND *csound, AMFM *p) {
 static OENTRY pvlock_localops[] =
   {
    {"mincer", sizeof(DATASPACEM), 0, "a", "akkkkoo",
-    (SUBR)sinit1m,(SUBR)sprocess1m },
+    (SUBR)sinit1m,(SUBR)sprocess1m,(SUBR)fft_deinit },
    {"mincer", sizeof(DATASPACE), 0, "mm", "akkkkoo",
-    (SUBR)sinit1,(SUBR)sprocess1 },
+    (SUBR)sinit1,(SUBR)sprocess1,(SUBR)fft_deinit },
    {"temposcal", sizeof(DATASPACEM), 0, "a", "kkkkkooPOP",
-    (SUBR)sinit2m,(SUBR)sprocess2m },
+    (SUBR)sinit2m,(SUBR)sprocess2m,(SUBR)fft_deinit },
    {"temposcal", sizeof(DATASPACE), 0, "mm", "kkkkkooPOP",
-    (SUBR)sinit2,(SUBR)sprocess2 },
+    (SUBR)sinit2,(SUBR)sprocess2,(SUBR)fft_deinit },
    {"filescal", sizeof(DATASPACE), 0, "mm", "kkkSkooPOP",
-    (SUBR)sinit3,(SUBR)sprocess3 },
+    (SUBR)sinit3,(SUBR)sprocess3,(SUBR)fft_deinit },
    {"hilbert2", sizeof(HILB), 0, "aa", "aii", (SUBR) hilbert_init,
     (SUBR) hilbert_proc},
    {"fmanal", sizeof(AMFM), 0, "aa", "aa", (SUBR) am_fm_init,
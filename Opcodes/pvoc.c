@@ -43,23 +43,38 @@ int32_t     pvinterpset_S(CSOUND *, void *);
 
 #define S(x)    sizeof(x)
 
+/* hands back the FFT setup an opcode asked for at init */
+static int32_t pvoc_deinit(CSOUND *csound, void *p)
+{
+    csound->ReleaseFFTSetups(csound, (OPDS *) p);
+    return OK;
+}
+
 static OENTRY pvoc_localops[] =
   {
-   { "pvoc",      S(PVOC),      0, "a",  "kkSoooo", pvset_S, pvoc        },
-   { "pvoc.i",      S(PVOC),      0, "a",  "kkioooo", pvset, pvoc        },
+   { "pvoc",      S(PVOC),      0, "a",  "kkSoooo", pvset_S, pvoc,
+     pvoc_deinit },
+   { "pvoc.i",      S(PVOC),      0, "a",  "kkioooo", pvset, pvoc,
+     pvoc_deinit },
 { "tableseg",  S(TABLESEG),  TR, "",   "iim",     tblesegset, ktableseg, NULL  },
 { "ktableseg", S(TABLESEG),  _QQ|TR, "",   "iim",  tblesegset, ktableseg, NULL },
 { "tablexseg", S(TABLESEG),  TW, "",   "iin",     tblesegset, ktablexseg, NULL },
-   { "vpvoc",     S(VPVOC),     TR, "a",  "kkSoo",   vpvset_S, vpvoc        },
-   { "vpvoc.i",     S(VPVOC),     TR, "a",  "kkioo",   vpvset, vpvoc        },
+   { "vpvoc",     S(VPVOC),     TR, "a",  "kkSoo",   vpvset_S, vpvoc,
+     pvoc_deinit },
+   { "vpvoc.i",     S(VPVOC),     TR, "a",  "kkioo",   vpvset, vpvoc,
+     pvoc_deinit },
 { "pvread",    S(PVREAD),  0,  "kk", "kSi",     pvreadset_S, pvread, NULL      },
 { "pvread.i",    S(PVREAD),  0,  "kk", "kii",     pvreadset, pvread, NULL      },
-   { "pvcross",   S(PVCROSS), 0,  "a",  "kkSkko",  pvcrossset_S, pvcross    },
+   { "pvcross",   S(PVCROSS), 0,  "a",  "kkSkko",  pvcrossset_S, pvcross,
+     pvoc_deinit },
 { "pvbufread", S(PVBUFREAD),0, "",   "kS",      pvbufreadset_S, pvbufread, NULL},
-   { "pvinterp",  S(PVINTERP), 0, "a",  "kkSkkkkkk", pvinterpset_S, pvinterp},
-   { "pvcross.i",   S(PVCROSS), 0,  "a",  "kkikko",  pvcrossset, pvcross    },
+   { "pvinterp",  S(PVINTERP), 0, "a",  "kkSkkkkkk", pvinterpset_S, pvinterp,
+     pvoc_deinit },
+   { "pvcross.i",   S(PVCROSS), 0,  "a",  "kkikko",  pvcrossset, pvcross,
+     pvoc_deinit },
 { "pvbufread.i", S(PVBUFREAD),0, "",   "ki",      pvbufreadset, pvbufread, NULL},
-   { "pvinterp.i",  S(PVINTERP), 0, "a",  "kkikkkkkk", pvinterpset, pvinterp},
+   { "pvinterp.i",  S(PVINTERP), 0, "a",  "kkikkkkkk", pvinterpset, pvinterp,
+     pvoc_deinit },
    { "pvadd",     S(PVADD),   0,  "a",  "kkSiiopooo", pvaddset_S, pvadd     },
    { "pvadd.i",     S(PVADD),   0,  "a",  "kkiiiopooo", pvaddset, pvadd     }
 };
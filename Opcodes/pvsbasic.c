@@ -28,6 +28,7 @@
 #include "pvs_ops.h"
 #include "pvsbasic.h"
 #include "pvfileio.h"
+#include "pvsplit.h"
 #include <math.h>
 #define MAXOUTS 16
 
@@ -59,6 +60,8 @@ static int32_t pvsgainset(CSOUND *csound, PVSGAIN *p){
         p->fout->frame.size < sizeof(float) * (N + 2))
       csound->AuxAlloc(csound, (N + 2) * sizeof(float), &p->fout->frame);
   p->fout->N = N;
+  if (pvs_split_has(p->fa))
+    pvs_split_alloc(csound, p->fout);
   p->fout->overlap = p->fa->overlap;
   p->fout->winsize = p->fa->winsize;
   p->fout->wintype = p->fa->wintype;
@@ -113,11 +116,23 @@ static int32_t pvsgain(CSOUND *csound, PVSGAIN *p)
   framesize = p->fa->N + 2;
 
   if (p->lastframe < p->fa->framecount) {
-    for (i = 0; i < framesize; i += 2){
-      fout[i] = fa[i]*gain;
-      fout[i+1] = fa[i+1];
+    const float *a = pvs_split_amps(p->fa);
+    if (a != NULL && pvs_split_has(p->fout)) {
+      int32_t NB = framesize / 2, stride = pvs_split_stride(NB);
+      float   *amp = pvs_split_arrays(p->fout);
+      for (i = 0; i < NB; i++)
+        amp[i] = a[i]*gain;
+      memcpy(amp + stride, a + stride, NB * sizeof(float));
+      p->fout->framecount = p->fa->framecount;
+      pvs_split_done(p->fout);
+    }
+    else {
+      for (i = 0; i < framesize; i += 2){
+        fout[i] = fa[i]*gain;
+        fout[i+1] = fa[i+1];
+      }
+      p->fout->framecount = p->fa->framecount;
     }
-    p->fout->framecount = p->fa->framecount;
     p->lastframe = p->fout->framecount;
   }
   return OK;
@@ -497,6 +512,13 @@ typedef struct _pvst {
   void *fwdsetup;
 } PVST;
 
+/* hands back the FFT setups an opcode asked for at init */
+static int32_t fft_deinit(CSOUND *csound, void *p)
+{
+  csound->ReleaseFFTSetups(csound, (OPDS *) p);
+  return OK;
+}
+
 int32_t pvstanalset(CSOUND *csound, PVST *p)
 {
 
@@ -553,7 +575,7 @@ int32_t pvstanalset(CSOUND *csound, PVST *p)
   p->pos =  *p->offset*CS_ESR;
   //printf("off: %f\n", *p->offset);
   p->accum = 0.0;
-  p->fwdsetup = csound->RealFFTSetup(csound,N,FFT_FWD);
+  p->fwdsetup = csound->RealFFTSetupFor(csound,N,FFT_FWD,&p->h);
   return OK;
 }
 
@@ -636,7 +658,7 @@ int32_t pvstanalset1(CSOUND *csound, PVST1 *p)
   p->pos =  *p->offset*CS_ESR;
   //printf("off: %f\n", *p->offset);
   p->accum = 0.0;
-  p->fwdsetup = csound->RealFFTSetup(csound,N,FFT_FWD);
+  p->fwdsetup = csound->RealFFTSetupFor(csound,N,FFT_FWD,&p->h);
   return OK;
 }
 
@@ -1310,6 +1332,8 @@ static int32_t pvsmoothset(CSOUND *csound, PVSMOOTH *p)
     }
   memset(p->del.auxp, 0, (N + 2) * sizeof(float));
   p->fout->N = N;
+  if (pvs_split_has(p->fin))
+    pvs_split_alloc(csound, p->fout);
   p->fout->overlap = p->fin->overlap;
   p->fout->winsize = p->fin->winsize;
   p->fout->wintype = p->fin->wintype;
@@ -1383,6 +1407,7 @@ static int32_t pvsmoothprocess(CSOUND *csound, PVSMOOTH *p)
   }
   if (p->lastframe < p->fin->framecount) {
     float   *fout, *fin, *del;
+    const float *a;
     double  costh1, costh2, coef1, coef2;
     fout = (float *) p->fout->frame.auxp;
     fin = (float *) p->fin->frame.auxp;
@@ -1395,6 +1420,21 @@ static int32_t pvsmoothprocess(CSOUND *csound, PVSMOOTH *p)
     coef1 = sqrt(costh1 * costh1 - 1.0) - costh1;
     coef2 = sqrt(costh2 * costh2 - 1.0) - costh2;
 
+    if ((a = pvs_split_amps(p->fin)) != NULL && pvs_split_has(p->fout)) {
+      int32_t NB = framesize / 2, stride = pvs_split_stride(NB);
+      float   *amp = pvs_split_arrays(p->fout), *fr = amp + stride;
+      const float *f = a + stride;
+      /* del stays interleaved for the frames that are not split */
+      for (i = 0; i < NB; i++) {
+        amp[i] = (float) (a[i] * (1.0 + coef1) - del[2 * i] * coef1);
+        fr[i] = (float) (f[i] * (1.0 + coef2) - del[2 * i + 1] * coef2);
+        del[2 * i] = amp[i];
+        del[2 * i + 1] = fr[i];
+      }
+      p->fout->framecount = p->lastframe = p->fin->framecount;
+      pvs_split_done(p->fout);
+      return OK;
+    }
     for (i = 0; i < framesize; i += 2) {
       /* amp smoothing */
       fout[i] = (float) (fin[i] * (1.0 + coef1) - del[i] * coef1);
@@ -1428,6 +1468,8 @@ static int32_t pvsmixset(CSOUND *csound, PVSMIX *p)
         p->fout->frame.size < sizeof(float) * (N + 2))
       csound->AuxAlloc(csound, (N + 2) * sizeof(float), &p->fout->frame);
   p->fout->N = N;
+  if (pvs_split_has(p->fa))
+    pvs_split_alloc(csound, p->fout);
   p->fout->overlap = p->fa->overlap;
   p->fout->winsize = p->fa->winsize;
   p->fout->wintype = p->fa->wintype;
@@ -1475,6 +1517,19 @@ static int32_t pvsmix(CSOUND *csound, PVSMIX *p)
   framesize = p->fa->N + 2;
 
   if (p->lastframe < p->fa->framecount) {
+    const float *a = pvs_split_amps(p->fa), *b = pvs_split_amps(p->fb);
+    if (a != NULL && b != NULL && pvs_split_has(p->fout)) {
+      int32_t NB = framesize / 2, stride = pvs_split_stride(NB);
+      float   *amp = pvs_split_arrays(p->fout), *fr = amp + stride;
+      for (i = 0; i < NB; i++) {
+        test = a[i] >= b[i];
+        amp[i] = test ? a[i] : b[i];
+        fr[i] = test ? a[i + stride] : b[i + stride];
+      }
+      p->fout->framecount = p->lastframe = p->fa->framecount;
+      pvs_split_done(p->fout);
+      return OK;
+    }
     for (i = 0; i < framesize; i += 2) {
       test = fa[i] >= fb[i];
       if (test) {
@@ -1521,6 +1576,8 @@ static int32_t pvsfilterset(CSOUND *csound, PVSFILTER *p)
         p->fout->frame.size < sizeof(float) * (N + 2))
       csound->AuxAlloc(csound, sizeof(float) * (N + 2), &p->fout->frame);
   p->fout->N = N;
+  if (pvs_split_has(p->fin))
+    pvs_split_alloc(csound, p->fout);
   p->fout->overlap = p->fin->overlap;
   p->fout->winsize = p->fin->winsize;
   p->fout->wintype = p->fin->wintype;
@@ -1572,8 +1629,25 @@ static int32_t pvsfilter(CSOUND *csound, PVSFILTER *p)
     return OK;
   }
   if (p->lastframe < p->fin->framecount) {
+    const float *a = pvs_split_amps(p->fin);
     kdepth = kdepth >= 0 ? (kdepth <= 1 ? kdepth : 1) : FL(0.0);
     dirgain = (1 - kdepth);
+    if (a != NULL && pvs_split_has(p->fout)) {
+      int32_t NB = N / 2 + 1, stride = pvs_split_stride(NB);
+      const float *fa = pvs_split_amps(p->fil);
+      int32_t step = 1;
+      float   *amp = pvs_split_arrays(p->fout);
+      if (fa == NULL) {
+        fa = fil;
+        step = 2;
+      }
+      for (i = 0; i < NB; i++)
+        amp[i] = (float) (a[i] * (dirgain + fa[i * step] * kdepth))*g;
+      memcpy(amp + stride, a + stride, NB * sizeof(float));
+      p->fout->framecount = p->lastframe = p->fin->framecount;
+      pvs_split_done(p->fout);
+      return OK;
+    }
     for (i = 0; i < N + 2; i += 2) {
       fout[i] = (float) (fin[i] * (dirgain + fil[i] * kdepth))*g;
       fout[i + 1] = fin[i + 1];
@@ -1630,6 +1704,8 @@ static int32_t pvsscaleset(CSOUND *csound, PVSSCALE *p)
     csound->AuxAlloc(csound, sizeof(float) * (N + 2), &p->ftmp);
 
   p->fout->N = N;
+  if (pvs_split_has(p->fin))
+    pvs_split_alloc(csound, p->fout);
   p->fout->overlap = p->fin->overlap;
   p->fout->winsize = p->fin->winsize;
   p->fout->wintype = p->fin->wintype;
@@ -1645,8 +1721,8 @@ static int32_t pvsscaleset(CSOUND *csound, PVSSCALE *p)
       p->fenv.size < sizeof(MYFLT) * (N+2))
     csound->AuxAlloc(csound, sizeof(MYFLT) * (N + 2), &p->fenv);
   memset(p->fenv.auxp, 0, sizeof(MYFLT)*(N+2));
-  p->fwdsetup = csound->RealFFTSetup(csound, N/2, FFT_FWD);
-  p->invsetup = csound->RealFFTSetup(csound, N/2, FFT_INV);
+  p->fwdsetup = csound->RealFFTSetupFor(csound, N/2, FFT_FWD, &p->h);
+  p->invsetup = csound->RealFFTSetupFor(csound, N/2, FFT_INV, &p->h);
   return OK;
 }
 
@@ -1712,6 +1788,33 @@ static int32_t pvsscale(CSOUND *csound, PVSSCALE *p)
   }
   if (p->lastframe < p->fin->framecount) {
     int32_t n;
+    const float *a;
+    if (!keepform && p->fin != p->fout &&
+        (a = pvs_split_amps(p->fin)) != NULL && pvs_split_has(p->fout)) {
+      int32_t NB = N / 2 + 1, stride = pvs_split_stride(NB);
+      float   *amp = pvs_split_arrays(p->fout), *fr = amp + stride;
+      const float *f = a + stride;
+      amp[0] = a[0];
+      amp[NB - 1] = a[NB - 1];
+      for (i = 1; i < NB - 1; i++) {
+        amp[i] = 0.0f;
+        fr[i] = -1.0f;
+      }
+      for (chan = 1; chan < NB - 1; chan++) {
+        n = (int32_t) ((chan * pscal)+0.5);
+        if (n < NB - 1 && n > 0) {
+          amp[n] = a[chan];
+          fr[n] = (float) (f[chan] * pscal);
+        }
+      }
+      for (i = 1; i < NB - 1; i++) {
+        if (isnan(amp[i])) amp[i] = 0.0f;
+        amp[i] = (fr[i] == -1.0f) ? 0.0f : amp[i] * g;
+      }
+      p->fout->framecount = p->lastframe = p->fin->framecount;
+      pvs_split_done(p->fout);
+      return OK;
+    }
     fout[0] = fin[0];
     fout[N] = fin[N];
     memcpy(ftmp,fin,sizeof(float)*(N+2));
@@ -2831,13 +2934,13 @@ static OENTRY localops[] = {
   {"pvsfilter", sizeof(PVSFILTER),0, "f", "ffxp", (SUBR) pvsfilterset,
    (SUBR) pvsfilter},
   {"pvscale", sizeof(PVSSCALE),0, "f", "fxOPO", (SUBR) pvsscaleset,
-   (SUBR) pvsscale},
+   (SUBR) pvsscale, (SUBR) fft_deinit},
   {"pvshift", sizeof(PVSSHIFT),0, "f", "fxkOPO", (SUBR) pvsshiftset,
    (SUBR) pvsshift},
   {"pvsfilter", sizeof(PVSFILTER),0, "f", "fffp", (SUBR) pvsfilterset,
    (SUBR) pvsfilter},
   {"pvscale", sizeof(PVSSCALE),0, "f", "fkOPO",
-   (SUBR) pvsscaleset, (SUBR) pvsscale},
+   (SUBR) pvsscaleset, (SUBR) pvsscale, (SUBR) fft_deinit},
   {"pvshift", sizeof(PVSSHIFT),0, "f", "fkkOPO", (SUBR) pvsshiftset,
    (SUBR) pvsshift},
   {"pvsmix", sizeof(PVSMIX),0, "f", "ff", (SUBR) pvsmixset, (SUBR)pvsmix, NULL},
@@ -2861,9 +2964,9 @@ static OENTRY localops[] = {
   {"pvsdiskin.i", sizeof(pvsdiskin),0, "f", "ikkopP",(SUBR) pvsdiskinset,
    (SUBR) pvsdiskinproc, NULL},
   {"pvstanal", sizeof(PVST1),0, "f", "kkkkPPoooP",
-   (SUBR) pvstanalset1, (SUBR) pvstanal1, NULL},
+   (SUBR) pvstanalset1, (SUBR) pvstanal1, (SUBR) fft_deinit},
   {"pvstanal", sizeof(PVST),0, "FFFFFFFFFFFFFFFF", "kkkkPPoooP",
-   (SUBR) pvstanalset, (SUBR) pvstanal, NULL},
+   (SUBR) pvstanalset, (SUBR) pvstanal, (SUBR) fft_deinit},
   {"pvswarp", sizeof(PVSWARP),0, "f", "fkkOPPO",
    (SUBR) pvswarpset, (SUBR) pvswarp},
   {"pvsenvftw", sizeof(PVSENVW),0, "k", "fkPPO",
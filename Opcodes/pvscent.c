@@ -183,6 +183,13 @@ typedef struct _cent {
   AUXCH frame, windowed, win;
 } CENT;
 
+/* hands back the FFT setup asked for at init */
+static int32_t cent_deinit(CSOUND *csound, CENT *p)
+{
+    csound->ReleaseFFTSetups(csound, &p->h);
+    return OK;
+}
+
 static int32_t cent_i(CSOUND *csound, CENT *p)
 {
     int32_t fftsize = *p->ifftsize;
@@ -210,7 +217,7 @@ static int32_t cent_i(CSOUND *csound, CENT *p)
     p->old = 0;
     memset(p->frame.auxp, 0, p->fsize*sizeof(MYFLT));
     memset(p->windowed.auxp, 0, p->fsize*sizeof(MYFLT));
-    p->setup = csound->RealFFTSetup(csound,p->fsize,FFT_FWD);
+    p->setup = csound->RealFFTSetupFor(csound,p->fsize,FFT_FWD,&p->h);
     return OK;
 }
 
@@ -455,7 +462,8 @@ static OENTRY localops[] = {
                              (SUBR)pvscentset, (SUBR)pvsbandw },
   { "pvscent", sizeof(PVSCENT), 0,  "a", "f",
                              (SUBR)pvscentset, (SUBR)pvsscent },
-  { "centroid", sizeof(CENT), 0,  "k", "aki", (SUBR)cent_i, (SUBR)cent_k, NULL},
+  { "centroid", sizeof(CENT), 0,  "k", "aki", (SUBR)cent_i, (SUBR)cent_k,
+    (SUBR)cent_deinit},
   { "pvspitch", sizeof(PVSPITCH), 0,  "kk", "fk",
                             (SUBR)pvspitch_init, (SUBR)pvspitch_process, NULL}
 };
@@ -186,8 +186,8 @@ struct TVConv : csnd::Plugin<1, 6> {
       pars = rpow2(pars);
       fils = rpow2(fils) * 2;
       ffts = pars * 2;
-      fwd = csound->fft_setup(ffts, FFT_FWD);
-      inv = csound->fft_setup(ffts, FFT_INV);
+      fwd = csound->fft_setup(ffts, FFT_FWD, this);
+      inv = csound->fft_setup(ffts, FFT_INV, this);
       out.allocate(csound, ffts);
       insp.allocate(csound, fils);
       irsp.allocate(csound, fils);
@@ -206,6 +206,11 @@ struct TVConv : csnd::Plugin<1, 6> {
     return OK;
   }
 
+  int32_t deinit() {
+    csound->release_fft_setups(this);
+    return OK;
+  }
+
   int32_t pconv() {
     csnd::AudioSig insig(this, inargs(0));
     csnd::AudioSig irsig(this, inargs(1));
@@ -35,6 +35,7 @@
 */
 
 #include "stdopcod.h"
+#include "fdn.h"
 #include <math.h>
 
 #define DEFAULT_SRATE   44100.0
@@ -64,19 +65,6 @@ static const double reverbParams[8][4] = {
 static const double outputGain  = 0.35;
 static const double jpScale     = 0.25;
 
-typedef struct {
-    int32_t         writePos;
-    int32_t         bufferSize;
-    int32_t         readPos;
-    int32_t         readPosFrac;
-    int32_t         readPosFrac_inc;
-    int32_t         dummy;
-    int32_t         seedVal;
-    int32_t         randLine_cnt;
-    double      filterState;
-    MYFLT       buf[1];
-} delayLine;
-
 typedef struct {
     OPDS        h;
     MYFLT       *aoutL, *aoutR, *ainL, *ainR, *kFeedBack, *kLPFreq;
@@ -85,7 +73,12 @@ typedef struct {
     double      dampFact;
     MYFLT       prv_LPFreq;
     int32_t         initDone;
-    delayLine   *delayLines[8];
+    FDN         lines;          /* the delay lines and their lowpass filters */
+    int32_t     readPos[8];
+    int32_t     readPosFrac[8];
+    int32_t     readPosFrac_inc[8];
+    int32_t     seedVal[8];
+    int32_t     randLine_cnt[8];
     AUXCH       auxData;
 } SC_REVERB;
 
@@ -98,68 +91,50 @@ static int32_t delay_line_max_samples(SC_REVERB *p, int32_t n)
     return (int32_t) (maxDel * p->sampleRate + 16.5);
 }
 
-static int32_t delay_line_bytes_alloc(SC_REVERB *p, int32_t n)
-{
-    int32_t nBytes;
-
-    nBytes = (int32_t) sizeof(delayLine) - (int32_t) sizeof(MYFLT);
-    nBytes += (delay_line_max_samples(p, n) * (int32_t) sizeof(MYFLT));
-    nBytes = (nBytes + 15) & (~15);
-    return nBytes;
-}
-
-static void next_random_lineseg(SC_REVERB *p, delayLine *lp, int32_t n)
+static void next_random_lineseg(SC_REVERB *p, int32_t n)
 {
     double  prvDel, nxtDel, phs_incVal;
 
     /* update random seed */
-    if (lp->seedVal < 0)
-      lp->seedVal += 0x10000;
-    lp->seedVal = (lp->seedVal * 15625 + 1) & 0xFFFF;
-    if (lp->seedVal >= 0x8000)
-      lp->seedVal -= 0x10000;
+    if (p->seedVal[n] < 0)
+      p->seedVal[n] += 0x10000;
+    p->seedVal[n] = (p->seedVal[n] * 15625 + 1) & 0xFFFF;
+    if (p->seedVal[n] >= 0x8000)
+      p->seedVal[n] -= 0x10000;
     /* length of next segment in samples */
-    lp->randLine_cnt = (int32_t) ((p->sampleRate / reverbParams[n][2]) + 0.5);
-    prvDel = (double) lp->writePos;
-    prvDel -= ((double) lp->readPos
-               + ((double) lp->readPosFrac / (double) DELAYPOS_SCALE));
+    p->randLine_cnt[n] = (int32_t) ((p->sampleRate / reverbParams[n][2]) + 0.5);
+    prvDel = (double) p->lines.pos[n];
+    prvDel -= ((double) p->readPos[n]
+               + ((double) p->readPosFrac[n] / (double) DELAYPOS_SCALE));
     while (prvDel < 0.0)
-      prvDel += (double) lp->bufferSize;
+      prvDel += (double) p->lines.size[n];
     prvDel = prvDel / p->sampleRate;    /* previous delay time in seconds */
-    nxtDel = (double) lp->seedVal * reverbParams[n][1] / 32768.0;
+    nxtDel = (double) p->seedVal[n] * reverbParams[n][1] / 32768.0;
     /* next delay time in seconds */
     nxtDel = reverbParams[n][0] + (nxtDel * (double) *(p->iPitchMod));
     /* calculate phase increment per sample */
-    phs_incVal = (prvDel - nxtDel) / (double) lp->randLine_cnt;
+    phs_incVal = (prvDel - nxtDel) / (double) p->randLine_cnt[n];
     phs_incVal = phs_incVal * p->sampleRate + 1.0;
-    lp->readPosFrac_inc = (int32_t) (phs_incVal * DELAYPOS_SCALE + 0.5);
+    p->readPosFrac_inc[n] = (int32_t) (phs_incVal * DELAYPOS_SCALE + 0.5);
 }
 
-static void init_delay_line(SC_REVERB *p, delayLine *lp, int32_t n)
+static void init_delay_line(SC_REVERB *p, void *mem, int32_t n)
 {
     double  readPos;
-    /* int32_t     i; */
 
-    /* calculate length of delay line */
-    lp->bufferSize = delay_line_max_samples(p, n);
-    lp->dummy = 0;
-    lp->writePos = 0;
+    /* calculate length of delay line, and clear it to zero */
+    fdn_line_init(&(p->lines), n, mem, delay_line_max_samples(p, n));
     /* set random seed */
-    lp->seedVal = (int32_t) (reverbParams[n][3] + 0.5);
+    p->seedVal[n] = (int32_t) (reverbParams[n][3] + 0.5);
     /* set initial delay time */
-    readPos = (double) lp->seedVal * reverbParams[n][1] / 32768;
+    readPos = (double) p->seedVal[n] * reverbParams[n][1] / 32768;
     readPos = reverbParams[n][0] + (readPos * (double) *(p->iPitchMod));
-    readPos = (double) lp->bufferSize - (readPos * p->sampleRate);
-    lp->readPos = (int32_t) readPos;
-    readPos = (readPos - (double) lp->readPos) * (double) DELAYPOS_SCALE;
-    lp->readPosFrac = (int32_t) (readPos + 0.5);
+    readPos = (double) p->lines.size[n] - (readPos * p->sampleRate);
+    p->readPos[n] = (int32_t) readPos;
+    readPos = (readPos - (double) p->readPos[n]) * (double) DELAYPOS_SCALE;
+    p->readPosFrac[n] = (int32_t) (readPos + 0.5);
     /* initialise first random line segment */
-    next_random_lineseg(p, lp, n);
-    /* clear delay line to zero */
-    lp->filterState = 0.0;
-    memset(lp->buf, 0, sizeof(MYFLT)*lp->bufferSize);
-    /* for (i = 0; i < lp->bufferSize; i++) */
-    /*   lp->buf[i] = FL(0.0); */
+    next_random_lineseg(p, n);
 }
 
 static int32_t sc_reverb_init(CSOUND *csound, SC_REVERB *p)
@@ -184,18 +159,18 @@ static int32_t sc_reverb_init(CSOUND *csound, SC_REVERB *p)
     /* calculate the number of bytes to allocate */
     nBytes = 0;
     for (i = 0; i < 8; i++)
-      nBytes += delay_line_bytes_alloc(p, i);
+      nBytes += (int32_t) fdn_line_bytes(delay_line_max_samples(p, i));
     if (nBytes != (int32_t)p->auxData.size)
       csound->AuxAlloc(csound, (size_t) nBytes, &(p->auxData));
     else if (p->initDone && *(p->iSkipInit) != FL(0.0))
       return OK;    /* skip initialisation if requested */
     /* set up delay lines */
     nBytes = 0;
+    p->lines.nlines = 8;
     for (i = 0; i < 8; i++) {
-      p->delayLines[i] = (delayLine*) ((unsigned char*) (p->auxData.auxp)
-                                       + (int32_t) nBytes);
-      init_delay_line(p, p->delayLines[i], i);
-      nBytes += delay_line_bytes_alloc(p, i);
+      init_delay_line(p, (unsigned char*) (p->auxData.auxp) + (int32_t) nBytes,
+                      i);
+      nBytes += (int32_t) fdn_line_bytes(p->lines.size[i]);
     }
     p->dampFact = 1.0;
     p->prv_LPFreq = FL(0.0);
@@ -206,14 +181,16 @@ static int32_t sc_reverb_init(CSOUND *csound, SC_REVERB *p)
 
 static int32_t sc_reverb_perf(CSOUND *csound, SC_REVERB *p)
 {
-    double    ainL, ainR, aoutL, aoutR;
-    double    vm1, v0, v1, v2, am1, a0, a1, a2, frac;
-    delayLine *lp;
-    int32_t       readPos;
+    double    ainL, ainR, aoutL, aoutR, feedBack;
+    double    vm1[8], v0[8], v1[8], v2[8], frac[8], state[8];
+    int32_t   im1[8], i0[8], i1[8], i2[8];
+    int32_t   readPos[8], readPosFrac[8], readPosFrac_inc[8];
+    MYFLT     blk[FDN_BLOCK][FDN_LINES];
+    FDN       *lines = &(p->lines);
+    int32_t   n;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t i, n, nsmps = CS_KSMPS;
-    int32_t       bufferSize; /* Local copy */
+    uint32_t i, k, len, nsmps = CS_KSMPS;
     double    dampFact = p->dampFact;
 
     if (UNLIKELY(p->initDone <= 0)) goto err1;
@@ -232,74 +209,86 @@ static int32_t sc_reverb_perf(CSOUND *csound, SC_REVERB *p)
       memset(&p->aoutL[nsmps], '\0', early*sizeof(MYFLT));
       memset(&p->aoutR[nsmps], '\0', early*sizeof(MYFLT));
     }
-    /* update delay lines */
-    for (i = offset; i < nsmps; i++) {
-      /* calculate "resultant junction pressure" and mix to input signals */
-      ainL = aoutL = aoutR = 0.0;
-      for (n = 0; n < 8; n++)
-        ainL += p->delayLines[n]->filterState;
-      ainL *= jpScale;
-      ainR = ainL + (double) p->ainR[i];
-      ainL = ainL + (double) p->ainL[i];
-      /* loop through all delay lines */
+    feedBack = (double) *(p->kFeedBack);
+    for (n = 0; n < 8; n++)
+      state[n] = lines->state[n];
+    /* update delay lines, a block at a time; the shortest delay is far
+       longer than a block, so the reads never see the block's writes */
+    for (i = offset; i < nsmps; i += len) {
+      /* a block ends where a line starts its next random segment */
+      len = fdn_span(lines, nsmps - i);
       for (n = 0; n < 8; n++) {
-        lp = p->delayLines[n];
-        bufferSize = lp->bufferSize;
-        /* send input signal and feedback to delay line */
-        lp->buf[lp->writePos] = (MYFLT) ((n & 1 ? ainR : ainL)
-                                         - lp->filterState);
-        if (UNLIKELY(++lp->writePos >= bufferSize))
-          lp->writePos -= bufferSize;
-        /* read from delay line with cubic interpolation */
-        if (lp->readPosFrac >= DELAYPOS_SCALE) {
-          lp->readPos += (lp->readPosFrac >> DELAYPOS_SHIFT);
-          lp->readPosFrac &= DELAYPOS_MASK;
+        if ((uint32_t) p->randLine_cnt[n] < len)
+          len = (uint32_t) p->randLine_cnt[n];
+        readPos[n] = p->readPos[n];
+        readPosFrac[n] = p->readPosFrac[n];
+        readPosFrac_inc[n] = p->readPosFrac_inc[n];
+      }
+      for (k = 0; k < len; k++) {
+        /* calculate "resultant junction pressure" and mix to input signals */
+        ainL = aoutL = aoutR = 0.0;
+        for (n = 0; n < 8; n++)
+          ainL += state[n];
+        ainL *= jpScale;
+        ainR = ainL + (double) p->ainR[i + k];
+        ainL = ainL + (double) p->ainL[i + k];
+        /* send input signal and feedback to delay lines */
+        for (n = 0; n < 8; n++)
+          blk[k][n] = (MYFLT) ((n & 1 ? ainR : ainL) - state[n]);
+        /* read positions, and the four samples around them */
+        for (n = 0; n < 8; n++) {
+          int32_t bufferSize = lines->size[n];
+          int32_t pos = readPos[n] + (readPosFrac[n] >> DELAYPOS_SHIFT);
+          readPosFrac[n] &= DELAYPOS_MASK;
+          if (pos >= bufferSize)
+            pos -= bufferSize;
+          readPos[n] = pos;
+          frac[n] = (double) readPosFrac[n] * (1.0 / (double) DELAYPOS_SCALE);
+          /* at buffer wrap-around the neighbours wrap too */
+          im1[n] = (pos > 0 ? pos : bufferSize) - 1;
+          i0[n] = pos;
+          i1[n] = (pos + 1 < bufferSize ? pos + 1 : 0);
+          i2[n] = (pos + 2 < bufferSize ? pos + 2 : pos + 2 - bufferSize);
         }
-        if (UNLIKELY(lp->readPos >= bufferSize))
-          lp->readPos -= bufferSize;
-        readPos = lp->readPos;
-        frac = (double) lp->readPosFrac * (1.0 / (double) DELAYPOS_SCALE);
-        /* calculate interpolation coefficients */
-        a2 = frac * frac; a2 -= 1.0; a2 *= (1.0 / 6.0);
-        a1 = frac; a1 += 1.0; a1 *= 0.5; am1 = a1 - 1.0;
-        a0 = 3.0 * a2; a1 -= a0; am1 -= a2; a0 -= frac;
-        /* read four samples for interpolation */
-        if (LIKELY(readPos > 0 && readPos < (bufferSize - 2))) {
-          vm1 = (double) (lp->buf[readPos - 1]);
-          v0  = (double) (lp->buf[readPos]);
-          v1  = (double) (lp->buf[readPos + 1]);
-          v2  = (double) (lp->buf[readPos + 2]);
+        for (n = 0; n < 8; n++) {
+          const MYFLT *buf = lines->buf[n];
+          vm1[n] = (double) buf[im1[n]];
+          v0[n]  = (double) buf[i0[n]];
+          v1[n]  = (double) buf[i1[n]];
+          v2[n]  = (double) buf[i2[n]];
         }
-        else {
-          /* at buffer wrap-around, need to check index */
-          if (--readPos < 0) readPos += bufferSize;
-          vm1 = (double) lp->buf[readPos];
-          if (++readPos >= bufferSize) readPos -= bufferSize;
-          v0 = (double) lp->buf[readPos];
-          if (++readPos >= bufferSize) readPos -= bufferSize;
-          v1 = (double) lp->buf[readPos];
-          if (++readPos >= bufferSize) readPos -= bufferSize;
-          v2 = (double) lp->buf[readPos];
+        /* cubic interpolation, feedback gain and lowpass filter */
+        for (n = 0; n < 8; n++) {
+          double  am1, a0, a1, a2, x;
+          a2 = frac[n] * frac[n]; a2 -= 1.0; a2 *= (1.0 / 6.0);
+          a1 = frac[n]; a1 += 1.0; a1 *= 0.5; am1 = a1 - 1.0;
+          a0 = 3.0 * a2; a1 -= a0; am1 -= a2; a0 -= frac[n];
+          x = (am1 * vm1[n] + a0 * v0[n] + a1 * v1[n] + a2 * v2[n]) * frac[n]
+            + v0[n];
+          /* update buffer read position */
+          readPosFrac[n] += readPosFrac_inc[n];
+          x *= feedBack;
+          state[n] = (state[n] - x) * dampFact + x;
         }
-        v0 = (am1 * vm1 + a0 * v0 + a1 * v1 + a2 * v2) * frac + v0;
-        /* update buffer read position */
-        lp->readPosFrac += lp->readPosFrac_inc;
-        /* apply feedback gain and lowpass filter */
-        v0 *= (double) *(p->kFeedBack);
-        v0 = (lp->filterState - v0) * dampFact + v0;
-        lp->filterState = v0;
         /* mix to output */
-        if (n & 1)
-          aoutR += v0;
-        else
-          aoutL += v0;
+        for (n = 0; n < 8; n += 2) {
+          aoutL += state[n];
+          aoutR += state[n + 1];
+        }
+        p->aoutL[i + k] = (MYFLT) (aoutL * outputGain);
+        p->aoutR[i + k] = (MYFLT) (aoutR * outputGain);
+      }
+      fdn_write(lines, blk, len);
+      for (n = 0; n < 8; n++) {
+        p->readPos[n] = readPos[n];
+        p->readPosFrac[n] = readPosFrac[n];
         /* start next random line segment if current one has reached endpoint */
-        if (--(lp->randLine_cnt) <= 0)
-          next_random_lineseg(p, lp, n);
+        if ((p->randLine_cnt[n] -= (int32_t) len) <= 0)
+          next_random_lineseg(p, n);
       }
-      p->aoutL[i] = (MYFLT) (aoutL * outputGain);
-      p->aoutR[i] = (MYFLT) (aoutR * outputGain);
     }
+    for (n = 0; n < 8; n++)
+      lines->state[n] = state[n];
 
     return OK;
  err1:
@@ -64,6 +64,8 @@ struct _instrType {
         char *name;
         BYTE splits_num;
         splitType *split;
+        int32_t *keyZone;       /* 129 offsets into zone, by key */
+        splitType **zone;       /* the splits sounding each key */
 } PACKED;
 typedef struct _instrType instrType;
 
@@ -84,6 +86,12 @@ struct _layerType {
 } PACKED;
 typedef struct _layerType layerType;
 
+struct _zoneType {
+        layerType *layer;
+        splitType *split;
+} PACKED;
+typedef struct _zoneType zoneType;
+
 struct _presetType {
         char *name;
         int32_t num;
@@ -91,6 +99,8 @@ struct _presetType {
         WORD bank;
         int32_t layers_num;
         layerType *layer;
+        int32_t *keyZone;       /* 129 offsets into zone, by key */
+        zoneType *zone;         /* the layer and split sounding each key */
 } PACKED;
 typedef struct _presetType presetType;
 
@@ -125,6 +135,7 @@ struct _SFBANK {
         instrType *instr;
         SHORT *sampleData;
         CHUNKS chunk;
+        void *mapping;          /* shared file mapping and tables, or NULL */
 } PACKED;
 typedef struct _SFBANK SFBANK;
 
@@ -44,6 +44,12 @@
 #endif
 #include "sfenum.h"
 #include "sfont.h"
+#if !defined(WIN32) && !defined(__wasi__) && !defined(WORDS_BIGENDIAN)
+/* little endian data can be used in place, straight from the file */
+#define SF_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 #define s2d(x)  *((DWORD *) (x))
 
@@ -51,7 +57,9 @@
 
 static int32_t chunk_read(CSOUND *, FILE *f, CHUNK *chunk);
 static void fill_SfPointers(CSOUND *);
-static int32_t  fill_SfStruct(CSOUND *);
+static int32_t  fill_SfStruct(CSOUND *, int32_t shared);
+static void free_SfStruct(CSOUND *, presetType *, int32_t, instrType *, int32_t,
+                          int32_t shared);
 static void layerDefaults(layerType *layer);
 static void splitDefaults(splitType *split);
 
@@ -72,6 +80,149 @@ typedef struct _sfontg {
   MYFLT pitches[128];
 } sfontg;
 
+#ifdef SF_MMAP
+/* SoundFont files mapped into memory, shared by all instances in the
+   process. The preset and instrument tables are parsed by the first
+   instance to load a file and shared with the mapping; sample data is
+   paged in by the OS as notes read it. */
+typedef struct sfMap_s {
+  struct sfMap_s *next;
+  dev_t   dev;
+  ino_t   ino;
+  time_t  mtime;
+  off_t   size;
+  BYTE    *addr;
+  int32_t refs;
+  presetType *preset;
+  int32_t presets_num;
+  instrType *instr;
+  int32_t instrs_num;
+} sfMap;
+
+static sfMap        *sfMaps = NULL;
+static static_lock_t sfMapsLock = STATIC_LOCK_INIT;
+
+/* map the RIFF chunk of an open file, or share an existing mapping */
+static sfMap *sf_map(FILE *fil, CHUNK *chunk)
+{
+    struct stat st;
+    sfMap *m;
+    DWORD size;
+    int32_t fd = fileno(fil);
+
+    if (fstat(fd, &st) != 0 || st.st_size < 8)
+      return NULL;
+    csoundStaticLock(&sfMapsLock);
+    for (m = sfMaps; m != NULL; m = m->next)
+      if (m->dev == st.st_dev && m->ino == st.st_ino &&
+          m->mtime == st.st_mtime && m->size == st.st_size)
+        break;
+    if (m == NULL) {
+      void *addr = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED,
+                        fd, 0);
+      if (addr != MAP_FAILED && (m = (sfMap *) calloc(1, sizeof(sfMap)))) {
+        m->dev = st.st_dev;
+        m->ino = st.st_ino;
+        m->mtime = st.st_mtime;
+        m->size = st.st_size;
+        m->addr = (BYTE *) addr;
+        m->next = sfMaps;
+        sfMaps = m;
+      }
+      else if (addr != MAP_FAILED)
+        munmap(addr, (size_t) st.st_size);
+    }
+    if (m != NULL)
+      m->refs++;
+    csoundStaticUnLock(&sfMapsLock);
+    if (m == NULL)
+      return NULL;
+    memcpy(chunk->ckID, m->addr, 4);
+    memcpy(&size, m->addr + 4, 4);
+    if ((off_t) size > m->size - 8)
+      size = (DWORD) (m->size - 8);
+    chunk->ckSize = size;
+    chunk->ckDATA = m->addr + 8;
+    return m;
+}
+
+static void sf_unmap(sfMap *map)
+{
+    sfMap **mp;
+    csoundStaticLock(&sfMapsLock);
+    if (--map->refs == 0) {
+      for (mp = &sfMaps; *mp != NULL; mp = &(*mp)->next)
+        if (*mp == map) {
+          *mp = map->next;
+          break;
+        }
+      free_SfStruct(NULL, map->preset, map->presets_num,
+                    map->instr, map->instrs_num, 1);
+      munmap(map->addr, (size_t) map->size);
+      free(map);
+    }
+    csoundStaticUnLock(&sfMapsLock);
+}
+
+/* take the tables of a mapped file, parsing them if no other instance
+   has; of two instances parsing at once, the second drops its copy */
+static void sf_share_tables(CSOUND *csound, SFBANK *soundFont)
+{
+    sfMap *m = (sfMap *) soundFont->mapping;
+    presetType *preset = NULL;
+    instrType *instr = NULL;
+    int32_t presets_num = 0, instrs_num = 0;
+
+    csoundStaticLock(&sfMapsLock);
+    soundFont->preset = m->preset;
+    soundFont->presets_num = m->presets_num;
+    soundFont->instr = m->instr;
+    soundFont->instrs_num = m->instrs_num;
+    csoundStaticUnLock(&sfMapsLock);
+    if (soundFont->preset != NULL)
+      return;
+    if (UNLIKELY(fill_SfStruct(csound, 1) != OK)) {
+      free_SfStruct(NULL, soundFont->preset, soundFont->presets_num,
+                    soundFont->instr, soundFont->instrs_num, 1);
+      soundFont->preset = NULL;
+      soundFont->instr = NULL;
+      soundFont->presets_num = soundFont->instrs_num = 0;
+      return;
+    }
+    csoundStaticLock(&sfMapsLock);
+    if (m->preset == NULL) {
+      m->preset = soundFont->preset;
+      m->presets_num = soundFont->presets_num;
+      m->instr = soundFont->instr;
+      m->instrs_num = soundFont->instrs_num;
+    }
+    else {
+      preset = soundFont->preset;
+      presets_num = soundFont->presets_num;
+      instr = soundFont->instr;
+      instrs_num = soundFont->instrs_num;
+      soundFont->preset = m->preset;
+      soundFont->presets_num = m->presets_num;
+      soundFont->instr = m->instr;
+      soundFont->instrs_num = m->instrs_num;
+    }
+    csoundStaticUnLock(&sfMapsLock);
+    free_SfStruct(NULL, preset, presets_num, instr, instrs_num, 1);
+}
+#endif
+
+/* the tables of a mapped file outlive the instance that parsed them */
+static void *sf_calloc(CSOUND *csound, size_t size, int32_t shared)
+{
+    return shared ? calloc(1, size) : csound->Calloc(csound, size);
+}
+
+static void sf_free(CSOUND *csound, void *p, int32_t shared)
+{
+    if (shared) free(p);
+    else csound->Free(csound, p);
+}
+
 static int32_t SoundFontLoad(CSOUND *csound, char *fname)
 {
     FILE *fil;
@@ -98,6 +249,7 @@ static int32_t SoundFontLoad(CSOUND *csound, char *fname)
       //printf("name[%d]: %s \n",  i, globals->sfArray[i].name);
       if (strcmp(fname, globals->sfArray[i].name)==0) {
         csound->Warning(csound, "%s already loaded", fname);
+        csound->FileClose(csound, fd);
         return i;
       }
     }
@@ -108,12 +260,27 @@ static int32_t SoundFontLoad(CSOUND *csound, char *fname)
     /* } */
     strncpy(soundFont->name, csound->GetFileName(fd), 256);
     //soundFont->name[255]='\0';
+#ifdef SF_MMAP
+    soundFont->mapping = sf_map(fil, &soundFont->chunk.main_chunk);
+    if (soundFont->mapping == NULL)
+#endif
     if (UNLIKELY(chunk_read(csound, fil, &soundFont->chunk.main_chunk)<0))
       csound->Message(csound, "%s", Str("sfont: failed to read file\n"));
     csound->FileClose(csound, fd);
     globals->soundFont = soundFont;
     fill_SfPointers(csound);
-    fill_SfStruct(csound);
+#ifdef SF_MMAP
+    if (soundFont->mapping != NULL)
+      sf_share_tables(csound, soundFont);
+    else
+#endif
+    if (UNLIKELY(fill_SfStruct(csound, 0) != OK)) {
+      free_SfStruct(csound, soundFont->preset, soundFont->presets_num,
+                    soundFont->instr, soundFont->instrs_num, 0);
+      soundFont->preset = NULL;
+      soundFont->instr = NULL;
+      soundFont->presets_num = soundFont->instrs_num = 0;
+    }
     return -1;
 }
 
@@ -129,14 +296,11 @@ static int32_t compare(presetType * elem1, presetType *elem2)
         ihandle SfLoad "filename"
 */
 
-static char *Gfname;            /* NOT THREAD SAFE */
-
 static int32_t SfLoad_(CSOUND *csound, SFLOAD *p, int32_t istring)
                                        /* open a file and return its handle */
 {                                      /* the handle is simply a stack index */
     char *fname;
     int32_t hand;
-    SFBANK *sf;
     sfontg *globals;
     globals = (sfontg *) (csound->QueryGlobalVariable(csound, "::sfontg"));
     if (UNLIKELY(globals==NULL)) {
@@ -151,13 +315,9 @@ static int32_t SfLoad_(CSOUND *csound, SFLOAD *p, int32_t istring)
                                 0);
     }
     /*    strcpy(fname, (char*) p->fname); */
-    Gfname = fname;
     hand = SoundFontLoad(csound, fname);
     if (hand<0) {
       *p->ihandle = (MYFLT) globals->currSFndx;
-      sf = &globals->sfArray[globals->currSFndx];
-      qsort(sf->preset, sf->presets_num, sizeof(presetType),
-            (int32_t (*)(const void *, const void * )) compare);
       csound->Free(csound,fname);
       if (UNLIKELY(++globals->currSFndx>=globals->maxSFndx)) {
         globals->maxSFndx += 5;
@@ -318,14 +478,25 @@ static int32_t SfPreset(CSOUND *csound, SFPRESET *p)
                                presetHandle, (int32_t) MAX_SFPRESET - 1);
     }
 
-    for (j=0; j< sf->presets_num; j++) {
-      if (sf->preset[j].prog == (WORD) *p->iprog &&
-          sf->preset[j].bank == (WORD) *p->ibank )
-        {
-          globals->presetp[presetHandle] = &sf->preset[j];
-          globals->sampleBase[presetHandle] = sf->sampleData;
-          break;
-        }
+    /* presets are sorted by bank and program at load, so a binary
+       search finds one in at most 9 steps for a full GM bank; this runs
+       once per sfpreset at init time, which does not pay for a second
+       bank/program index kept next to the shared mapping */
+    {
+      int32_t key = (WORD) *p->ibank * 128 + (WORD) *p->iprog;
+      int32_t lo = 0, hi = sf->presets_num;
+      while (lo < hi) {
+        j = (lo + hi) >> 1;
+        if (sf->preset[j].bank * 128 + sf->preset[j].prog < key)
+          lo = j + 1;
+        else hi = j;
+      }
+      if (lo < sf->presets_num &&
+          sf->preset[lo].prog == (WORD) *p->iprog &&
+          sf->preset[lo].bank == (WORD) *p->ibank) {
+        globals->presetp[presetHandle] = &sf->preset[lo];
+        globals->sampleBase[presetHandle] = sf->sampleData;
+      }
     }
     *p->ipresethandle = (MYFLT) presetHandle;
 
@@ -346,7 +517,7 @@ static int32_t SfPlay_set(CSOUND *csound, SFPLAY *p)
     DWORD index = (DWORD) *p->ipresethandle;
     presetType *preset;
     SHORT *sBase;
-    int32_t layersNum, j, spltNum = 0, flag = (int32_t) *p->iflag;
+    int32_t z = 0, zEnd = 0, spltNum = 0, flag = (int32_t) *p->iflag;
     sfontg *globals;
 
     globals = (sfontg *) (csound->QueryGlobalVariable(csound, "::sfontg"));
@@ -360,103 +531,87 @@ static int32_t SfPlay_set(CSOUND *csound, SFPLAY *p)
       return csound->InitError(csound, "%s", Str("sfplay: invalid or "
                                            "out-of-range preset number"));
     }
-    layersNum = preset->layers_num;
-    // csound->Message(csound, "sfplay: %d layers in preset %d-%s\n", layersNum, index, preset->name);
-    for (j =0; j < layersNum; j++) {
-      layerType *layer = &preset->layer[j];
-      uint32_t vel = (uint32_t) abs((int32_t) *p->ivel),
-        notnum = (uint32_t) abs((int32_t) *p->inotnum);
-      /* csound->Message(csound, "layer: %d, vel:%d minvel: %d maxvel: %d" 
-                                     "\n\t note: %d minnote: %d maxmote: %d \n",
-                        j, vel, layer->minVelRange, layer->maxVelRange,
-                        notnum, layer->minNoteRange, layer->maxNoteRange); */
-      if (notnum >= layer->minNoteRange &&
-          notnum <= layer->maxNoteRange &&
-          vel    >= layer->minVelRange  &&
-          vel    <= layer->maxVelRange) {
-        int32_t splitsNum = layer->splits_num, k; 
-        for (k = 0; k < splitsNum; k++) {
-          splitType *split = &layer->split[k];
-          /* csound->Message(csound, "split: %d, vel:%d minvel: %d maxvel: %d" 
-                                     "\n\t note: %d minnote: %d maxmote: %d \n",
-                         k, vel, split->minVelRange, split->maxVelRange,
-                         notnum, split->minNoteRange, split->maxNoteRange); */
-          if (notnum  >= split->minNoteRange &&
-              notnum  <= split->maxNoteRange &&
-              vel     >= split->minVelRange  &&
-              vel     <= split->maxVelRange) {
-            sfSample *sample = split->sample;
-            
-            DWORD start=sample->dwStart;
-            MYFLT attenuation;
-            double pan;
-            double freq, orgfreq;
-            double tuneCorrection = split->coarseTune + layer->coarseTune +
-              (split->fineTune + layer->fineTune)*0.01;
-            int32_t orgkey = split->overridingRootKey, nm = notnum;
-            if (orgkey == -1) orgkey = sample->byOriginalKey;
-            orgfreq = globals->pitches[orgkey];
-            if (flag) {
-              freq = orgfreq * pow(2.0, ONETWELTH * tuneCorrection);
-              p->si[spltNum]= (freq/(orgfreq*orgfreq))*
-                               sample->dwSampleRate*CS_ONEDSR;
-            }
-            else {
-              freq = orgfreq*
-                pow(2.0, ONETWELTH * tuneCorrection)*
-                pow(2.0, ONETWELTH * (split->scaleTuning*0.01) * (nm-orgkey));
-              p->si[spltNum]= (freq/orgfreq) * sample->dwSampleRate*CS_ONEDSR;
-            }
-              ;
-            attenuation = (MYFLT) (layer->initialAttenuation +
-                                   split->initialAttenuation);
-            attenuation = POWER(FL(2.0), (-FL(1.0)/FL(60.0)) * attenuation )
-              * GLOBAL_ATTENUATION;
-            pan = (double)(split->pan + layer->pan) / 1000.0 + 0.5;
-            if (pan > 1.0) pan = 1.0;
-            else if (pan < 0.0) pan = 0.0;
-            /* Suggested fix from steven yi Oct 2002 */
-            p->base[spltNum] = sBase + start;
-            p->phs[spltNum] = (double) split->startOffset + *p->ioffset;
-            p->end[spltNum] = (DWORD) (sample->dwEnd + split->endOffset - start);
-            p->startloop[spltNum] =  (DWORD) 
-              (sample->dwStartloop + split->startLoopOffset  - start);
-            p->endloop[spltNum] =  (DWORD) 
-              (sample->dwEndloop + split->endLoopOffset - start);
-            p->leftlevel[spltNum] = (MYFLT) sqrt(1.0-pan) * attenuation;
-            p->rightlevel[spltNum] = (MYFLT) sqrt(pan) * attenuation;
-            p->mode[spltNum]= split->sampleModes;
-            p->attack[spltNum] = split->attack*CS_EKR;
-            p->decay[spltNum] = split->decay*CS_EKR;
-            p->sustain[spltNum] = split->sustain;
-            p->release[spltNum] = split->release*CS_EKR;
-
-            if (*p->ienv > 1) {
-              p->attr[spltNum] = 1.0/(CS_EKR*split->attack);
-              p->decr[spltNum] = pow((split->sustain+0.0001),
-                                     1.0/(CS_EKR*
-                                          split->decay+0.0001));
-              if (split->attack != 0.0) p->env[spltNum] = 0.0;
-              else p->env[spltNum] = 1.0;
-            }
-            else if (*p->ienv > 0) {
-              p->attr[spltNum] = 1.0/(CS_EKR*split->attack);
-              p->decr[spltNum] = (split->sustain-1.0)/(CS_EKR*
-                                                       split->decay);
-              if (split->attack != 0.0) p->env[spltNum] = 0.0;
-              else p->env[spltNum] = 1.0;
-            }
-            else {
-              p->env[spltNum] = 1.0;
-            }
-            p->ti[spltNum] = 0;
-            /*csound->Message(csound, "play: split %d, samplebase:%p freq: %f orig: %f" 
-                                     "\n\t atten:%f pan:%f mode:%d \n",
-                            k, p->base[spltNum],
-                            freq, orgfreq,  attenuation, pan, split->sampleModes);*/
-            spltNum++;
-          }
+    uint32_t vel = (uint32_t) abs((int32_t) *p->ivel),
+      notnum = (uint32_t) abs((int32_t) *p->inotnum);
+    if (notnum < 128) {
+      z = preset->keyZone[notnum];
+      zEnd = preset->keyZone[notnum + 1];
+    }
+    for (; z < zEnd; z++) {
+      layerType *layer = preset->zone[z].layer;
+      splitType *split = preset->zone[z].split;
+      if (vel >= layer->minVelRange && vel <= layer->maxVelRange &&
+          vel >= split->minVelRange && vel <= split->maxVelRange) {
+        sfSample *sample = split->sample;
+        
+        DWORD start=sample->dwStart;
+        MYFLT attenuation;
+        double pan;
+        double freq, orgfreq;
+        double tuneCorrection = split->coarseTune + layer->coarseTune +
+          (split->fineTune + layer->fineTune)*0.01;
+        int32_t orgkey = split->overridingRootKey, nm = notnum;
+        if (orgkey == -1) orgkey = sample->byOriginalKey;
+        orgfreq = globals->pitches[orgkey];
+        if (flag) {
+          freq = orgfreq * pow(2.0, ONETWELTH * tuneCorrection);
+          p->si[spltNum]= (freq/(orgfreq*orgfreq))*
+                           sample->dwSampleRate*CS_ONEDSR;
+        }
+        else {
+          freq = orgfreq*
+            pow(2.0, ONETWELTH * tuneCorrection)*
+            pow(2.0, ONETWELTH * (split->scaleTuning*0.01) * (nm-orgkey));
+          p->si[spltNum]= (freq/orgfreq) * sample->dwSampleRate*CS_ONEDSR;
+        }
+          ;
+        attenuation = (MYFLT) (layer->initialAttenuation +
+                               split->initialAttenuation);
+        attenuation = POWER(FL(2.0), (-FL(1.0)/FL(60.0)) * attenuation )
+          * GLOBAL_ATTENUATION;
+        pan = (double)(split->pan + layer->pan) / 1000.0 + 0.5;
+        if (pan > 1.0) pan = 1.0;
+        else if (pan < 0.0) pan = 0.0;
+        /* Suggested fix from steven yi Oct 2002 */
+        p->base[spltNum] = sBase + start;
+        p->phs[spltNum] = (double) split->startOffset + *p->ioffset;
+        p->end[spltNum] = (DWORD) (sample->dwEnd + split->endOffset - start);
+        p->startloop[spltNum] =  (DWORD) 
+          (sample->dwStartloop + split->startLoopOffset  - start);
+        p->endloop[spltNum] =  (DWORD) 
+          (sample->dwEndloop + split->endLoopOffset - start);
+        p->leftlevel[spltNum] = (MYFLT) sqrt(1.0-pan) * attenuation;
+        p->rightlevel[spltNum] = (MYFLT) sqrt(pan) * attenuation;
+        p->mode[spltNum]= split->sampleModes;
+        p->attack[spltNum] = split->attack*CS_EKR;
+        p->decay[spltNum] = split->decay*CS_EKR;
+        p->sustain[spltNum] = split->sustain;
+        p->release[spltNum] = split->release*CS_EKR;
+
+        if (*p->ienv > 1) {
+          p->attr[spltNum] = 1.0/(CS_EKR*split->attack);
+          p->decr[spltNum] = pow((split->sustain+0.0001),
+                                 1.0/(CS_EKR*
+                                      split->decay+0.0001));
+          if (split->attack != 0.0) p->env[spltNum] = 0.0;
+          else p->env[spltNum] = 1.0;
+        }
+        else if (*p->ienv > 0) {
+          p->attr[spltNum] = 1.0/(CS_EKR*split->attack);
+          p->decr[spltNum] = (split->sustain-1.0)/(CS_EKR*
+                                                   split->decay);
+          if (split->attack != 0.0) p->env[spltNum] = 0.0;
+          else p->env[spltNum] = 1.0;
+        }
+        else {
+          p->env[spltNum] = 1.0;
         }
+        p->ti[spltNum] = 0;
+        /*csound->Message(csound, "play: split %d, samplebase:%p freq: %f orig: %f" 
+                                 "\n\t atten:%f pan:%f mode:%d \n",
+                        k, p->base[spltNum],
+                        freq, orgfreq,  attenuation, pan, split->sampleModes);*/
+        spltNum++;
       }
     }
     p->spltNum = spltNum;
@@ -712,7 +867,7 @@ static int32_t SfPlayMono_set(CSOUND *csound, SFPLAYMONO *p)
     DWORD index = (DWORD) *p->ipresethandle;
     presetType *preset;
     SHORT *sBase;
-    int32_t layersNum, j, spltNum = 0, flag=(int32_t) *p->iflag;
+    int32_t z = 0, zEnd = 0, spltNum = 0, flag=(int32_t) *p->iflag;
     sfontg *globals;
     globals = (sfontg *) (csound->QueryGlobalVariable(csound, "::sfontg"));
     //printf("*** index= %d  maximum = %d\n", index, globals->currSFndx);
@@ -728,79 +883,72 @@ static int32_t SfPlayMono_set(CSOUND *csound, SFPLAYMONO *p)
       return csound->InitError(csound, "%s", Str("sfplaym: invalid or "
                                            "out-of-range preset number"));
     }
-    layersNum= preset->layers_num;
-    for (j =0; j < layersNum; j++) {
-      layerType *layer = &preset->layer[j];
-      uint32_t vel= (uint32_t) abs((int32_t) *p->ivel),
-        notnum= (uint32_t) abs((int32_t)*p->inotnum);
-      if (notnum >= layer->minNoteRange &&
-          notnum <= layer->maxNoteRange &&
-          vel >= layer->minVelRange  &&
-          vel <= layer->maxVelRange) {
-        int32_t splitsNum = layer->splits_num, k;
-        for (k = 0; k < splitsNum; k++) {
-          splitType *split = &layer->split[k];
-          if (notnum >= split->minNoteRange &&
-              notnum <= split->maxNoteRange &&
-              vel >= split->minVelRange  &&
-              vel <= split->maxVelRange) {
-            sfSample *sample = split->sample;
-            DWORD start=sample->dwStart;
-            double freq, orgfreq;
-            double tuneCorrection = split->coarseTune + layer->coarseTune +
-              (split->fineTune + layer->fineTune)*0.01;
-            int32_t orgkey = split->overridingRootKey, nn = notnum;
-            if (orgkey == -1) orgkey = sample->byOriginalKey;
-            orgfreq = globals->pitches[orgkey] ;
-            if (flag) {
-              freq = orgfreq * pow(2.0, ONETWELTH * tuneCorrection);
-              p->si[spltNum]= (freq/(orgfreq*orgfreq))*
-                               sample->dwSampleRate*CS_ONEDSR;
-            }
-            else {
-              freq = orgfreq * pow(2.0, ONETWELTH * tuneCorrection) *
-                pow( 2.0, ONETWELTH* (split->scaleTuning*0.01) * (nn-orgkey));
-              p->si[spltNum]= (freq/orgfreq) * sample->dwSampleRate*CS_ONEDSR;
-            }
-            p->attenuation[spltNum] =
-              POWER(FL(2.0), (-FL(1.0)/FL(60.0)) * (layer->initialAttenuation +
-                                                    split->initialAttenuation)) *
-              GLOBAL_ATTENUATION;
-            p->base[spltNum] =  sBase+ start;
-            p->phs[spltNum] = (double) split->startOffset + *p->ioffset;
-            p->end[spltNum] =  (DWORD) (sample->dwEnd + split->endOffset - start);
-            p->startloop[spltNum] =  (DWORD) (sample->dwStartloop +
-                                              split->startLoopOffset - start);
-            p->endloop[spltNum] =  (DWORD)
-              (sample->dwEndloop + split->endLoopOffset - start);
-            p->mode[spltNum]= split->sampleModes;
-            p->attack[spltNum] = split->attack*CS_EKR;
-            p->decay[spltNum] = split->decay*CS_EKR;
-            p->sustain[spltNum] = split->sustain;
-            p->release[spltNum] = split->release*CS_EKR;
-
-            if (*p->ienv > 1) {
-             p->attr[spltNum] = 1.0/(CS_EKR*split->attack);
-             p->decr[spltNum] = pow((split->sustain+0.0001),
-                                    1.0/(CS_EKR*
-                                         split->decay+0.0001));
-            if (split->attack != 0.0) p->env[spltNum] = 0.0;
-            else p->env[spltNum] = 1.0;
-            }
-            else if (*p->ienv > 0) {
-            p->attr[spltNum] = 1.0/(CS_EKR*split->attack);
-            p->decr[spltNum] = (split->sustain-1.0)/(CS_EKR*
-                                                     split->decay);
-            if (split->attack != 0.0) p->env[spltNum] = 0.0;
-            else p->env[spltNum] = 1.0;
-            }
-            else {
-              p->env[spltNum] = 1.0;
-            }
-            p->ti[spltNum] = 0;
-            spltNum++;
-          }
+    uint32_t vel = (uint32_t) abs((int32_t) *p->ivel),
+      notnum = (uint32_t) abs((int32_t) *p->inotnum);
+    if (notnum < 128) {
+      z = preset->keyZone[notnum];
+      zEnd = preset->keyZone[notnum + 1];
+    }
+    for (; z < zEnd; z++) {
+      layerType *layer = preset->zone[z].layer;
+      splitType *split = preset->zone[z].split;
+      if (vel >= layer->minVelRange && vel <= layer->maxVelRange &&
+          vel >= split->minVelRange && vel <= split->maxVelRange) {
+        sfSample *sample = split->sample;
+        DWORD start=sample->dwStart;
+        double freq, orgfreq;
+        double tuneCorrection = split->coarseTune + layer->coarseTune +
+          (split->fineTune + layer->fineTune)*0.01;
+        int32_t orgkey = split->overridingRootKey, nn = notnum;
+        if (orgkey == -1) orgkey = sample->byOriginalKey;
+        orgfreq = globals->pitches[orgkey] ;
+        if (flag) {
+          freq = orgfreq * pow(2.0, ONETWELTH * tuneCorrection);
+          p->si[spltNum]= (freq/(orgfreq*orgfreq))*
+                           sample->dwSampleRate*CS_ONEDSR;
+        }
+        else {
+          freq = orgfreq * pow(2.0, ONETWELTH * tuneCorrection) *
+            pow( 2.0, ONETWELTH* (split->scaleTuning*0.01) * (nn-orgkey));
+          p->si[spltNum]= (freq/orgfreq) * sample->dwSampleRate*CS_ONEDSR;
+        }
+        p->attenuation[spltNum] =
+          POWER(FL(2.0), (-FL(1.0)/FL(60.0)) * (layer->initialAttenuation +
+                                                split->initialAttenuation)) *
+          GLOBAL_ATTENUATION;
+        p->base[spltNum] =  sBase+ start;
+        p->phs[spltNum] = (double) split->startOffset + *p->ioffset;
+        p->end[spltNum] =  (DWORD) (sample->dwEnd + split->endOffset - start);
+        p->startloop[spltNum] =  (DWORD) (sample->dwStartloop +
+                                          split->startLoopOffset - start);
+        p->endloop[spltNum] =  (DWORD)
+          (sample->dwEndloop + split->endLoopOffset - start);
+        p->mode[spltNum]= split->sampleModes;
+        p->attack[spltNum] = split->attack*CS_EKR;
+        p->decay[spltNum] = split->decay*CS_EKR;
+        p->sustain[spltNum] = split->sustain;
+        p->release[spltNum] = split->release*CS_EKR;
+
+        if (*p->ienv > 1) {
+         p->attr[spltNum] = 1.0/(CS_EKR*split->attack);
+         p->decr[spltNum] = pow((split->sustain+0.0001),
+                                1.0/(CS_EKR*
+                                     split->decay+0.0001));
+        if (split->attack != 0.0) p->env[spltNum] = 0.0;
+        else p->env[spltNum] = 1.0;
+        }
+        else if (*p->ienv > 0) {
+        p->attr[spltNum] = 1.0/(CS_EKR*split->attack);
+        p->decr[spltNum] = (split->sustain-1.0)/(CS_EKR*
+                                                 split->decay);
+        if (split->attack != 0.0) p->env[spltNum] = 0.0;
+        else p->env[spltNum] = 1.0;
         }
+        else {
+          p->env[spltNum] = 1.0;
+        }
+        p->ti[spltNum] = 0;
+        spltNum++;
       }
     }
     p->spltNum = spltNum;
@@ -991,7 +1139,7 @@ static int32_t SfInstrPlay_set(CSOUND *csound, SFIPLAY *p)
       return csound->InitError(csound, "%s", Str("invalid soundfont"));
     sf = &globals->sfArray[index];
     if (*p->iskip && p->spltNum)  return OK;
-    if (UNLIKELY(*p->instrNum >  sf->instrs_num)) {
+    if (UNLIKELY(*p->instrNum >= sf->instrs_num)) {
       return csound->InitError(csound, "%s", Str("sfinstr: instrument out of range"));
     }
     else {
@@ -1000,13 +1148,15 @@ static int32_t SfInstrPlay_set(CSOUND *csound, SFIPLAY *p)
       int32_t spltNum = 0, flag=(int32_t) *p->iflag;
       uint32_t vel= (uint32_t) abs((int32_t) *p->ivel),
         notnum= (uint32_t) abs((int32_t)*p->inotnum);
-      uint32_t splitsNum = layer->splits_num, k;
+      int32_t z = 0, zEnd = 0;
       
-      for (k = 0; k < splitsNum; k++) {
-        splitType *split = &layer->split[k];
-        if (notnum >= split->minNoteRange &&
-            notnum <= split->maxNoteRange &&
-            vel >= split->minVelRange  &&
+      if (notnum < 128) {
+        z = layer->keyZone[notnum];
+        zEnd = layer->keyZone[notnum + 1];
+      }
+      for (; z < zEnd; z++) {
+        splitType *split = layer->zone[z];
+        if (vel >= split->minVelRange &&
             vel <= split->maxVelRange) {
           sfSample *sample = split->sample;
           DWORD start=sample->dwStart;
@@ -1268,7 +1418,7 @@ static int32_t SfInstrPlayMono_set(CSOUND *csound, SFIPLAYMONO *p)
       return csound->InitError(csound, "%s", Str("invalid soundfont"));
 
     sf = &globals->sfArray[index];
-    if (UNLIKELY( *p->instrNum >  sf->instrs_num)) {
+    if (UNLIKELY( *p->instrNum >= sf->instrs_num)) {
       return csound->InitError(csound, "%s", Str("sfinstr: instrument out of range"));
     }
     else {
@@ -1276,16 +1426,18 @@ static int32_t SfInstrPlayMono_set(CSOUND *csound, SFIPLAYMONO *p)
       SHORT *sBase = sf->sampleData;
       int32_t spltNum = 0, flag=(int32_t) *p->iflag;
       uint32_t vel= (int32_t) *p->ivel, notnum= (int32_t) *p->inotnum;
-      int32_t splitsNum = layer->splits_num, k;
+      int32_t z = 0, zEnd = 0;
 
       if (*p->iskip && p->spltNum) return OK;
      
-      for (k = 0; k < splitsNum; k++) {
-        splitType *split = &layer->split[k];
-        if (notnum >= split->minNoteRange &&
-            notnum <= split->maxNoteRange &&
-            vel >= split->minVelRange  &&
-            vel     <= split->maxVelRange) {
+      if (notnum < 128) {
+        z = layer->keyZone[notnum];
+        zEnd = layer->keyZone[notnum + 1];
+      }
+      for (; z < zEnd; z++) {
+        splitType *split = layer->zone[z];
+        if (vel >= split->minVelRange &&
+            vel <= split->maxVelRange) {
           sfSample *sample = split->sample;
           DWORD start=sample->dwStart;
           double freq, orgfreq;
@@ -1565,7 +1717,78 @@ static void ChangeByteOrder(char *fmt, char *p, int32 size)
 #define ChangeByteOrder(fmt, p, size) /* nothing */
 #endif
 
-static int32_t fill_SfStruct(CSOUND *csound)
+/* the zones of a preset that can sound a key, in the order sfplay
+   plays them; counted if zone is NULL */
+static int32_t preset_zones(presetType *preset, int32_t key, zoneType *zone)
+{
+    int32_t j, k, n = 0;
+    for (j = 0; j < preset->layers_num; j++) {
+      layerType *layer = &preset->layer[j];
+      if (key < layer->minNoteRange || key > layer->maxNoteRange)
+        continue;
+      for (k = 0; k < layer->splits_num; k++) {
+        splitType *split = &layer->split[k];
+        if (key >= split->minNoteRange && key <= split->maxNoteRange) {
+          if (zone != NULL) {
+            zone[n].layer = layer;
+            zone[n].split = split;
+          }
+          n++;
+        }
+      }
+    }
+    return n;
+}
+
+static int32_t instr_zones(instrType *instr, int32_t key, splitType **zone)
+{
+    int32_t k, n = 0;
+    for (k = 0; k < instr->splits_num; k++) {
+      splitType *split = &instr->split[k];
+      if (key >= split->minNoteRange && key <= split->maxNoteRange) {
+        if (zone != NULL)
+          zone[n] = split;
+        n++;
+      }
+    }
+    return n;
+}
+
+/* index the zones of every preset and instrument by key, so that a note
+   looks only at those covering it and checks just their velocity */
+static void index_keys(CSOUND *csound, SFBANK *soundFont, int32_t shared)
+{
+    int32_t j, key, n;
+    for (j = 0; j < soundFont->presets_num; j++) {
+      presetType *preset = &soundFont->preset[j];
+      preset->keyZone =
+        (int32_t *) sf_calloc(csound, 129 * sizeof(int32_t), shared);
+      for (key = n = 0; key < 128; key++) {
+        preset->keyZone[key] = n;
+        n += preset_zones(preset, key, NULL);
+      }
+      preset->keyZone[128] = n;
+      preset->zone = (zoneType *) sf_calloc(csound, n * sizeof(zoneType), shared);
+      for (key = 0; key < 128; key++)
+        preset_zones(preset, key, preset->zone + preset->keyZone[key]);
+    }
+    for (j = 0; j < soundFont->instrs_num; j++) {
+      instrType *instr = &soundFont->instr[j];
+      instr->keyZone =
+        (int32_t *) sf_calloc(csound, 129 * sizeof(int32_t), shared);
+      for (key = n = 0; key < 128; key++) {
+        instr->keyZone[key] = n;
+        n += instr_zones(instr, key, NULL);
+      }
+      instr->keyZone[128] = n;
+      instr->zone =
+        (splitType **) sf_calloc(csound, n * sizeof(splitType *), shared);
+      for (key = 0; key < 128; key++)
+        instr_zones(instr, key, instr->zone + instr->keyZone[key]);
+    }
+}
+
+static int32_t fill_SfStruct(CSOUND *csound, int32_t shared)
 {
     int32_t j, k, i, l, m, size, iStart, iEnd, kk, ll, mStart, mEnd;
     int32_t pbag_num,first_pbag,layer_num;
@@ -1584,7 +1807,9 @@ static int32_t fill_SfStruct(CSOUND *csound)
     sfontg *globals;
     globals = (sfontg *) (csound->QueryGlobalVariable(csound, "::sfontg"));
     soundFont = globals->soundFont;
-
+    soundFont->preset = NULL;
+    soundFont->instr = NULL;
+    soundFont->instrs_num = 0;
 
 /*  imod = soundFont->chunk.imod; */
     igen = soundFont->chunk.igen;
@@ -1599,7 +1824,7 @@ static int32_t fill_SfStruct(CSOUND *csound)
 
     size = phdrChunk->ckSize / sizeof(sfPresetHeader);
     soundFont->presets_num = size;
-    preset = (presetType *) csound->Malloc(csound, size * sizeof(presetType));
+    preset = (presetType *) sf_calloc(csound, size * sizeof(presetType), shared);
     for (j=0; j < size; j++) {
       preset[j].name = phdr[j].achPresetName;
       if (strcmp(preset[j].name,"EOP")==0) {
@@ -1623,7 +1848,7 @@ static int32_t fill_SfStruct(CSOUND *csound)
       }
       preset[j].layers_num = layer_num;
       preset[j].layer =
-        (layerType *) csound->Malloc(csound, layer_num * sizeof(layerType));
+        (layerType *) sf_calloc(csound, layer_num * sizeof(layerType), shared);
       for (k=0; k <layer_num; k++) {
         layerDefaults(&preset[j].layer[k]);
       }
@@ -1657,7 +1882,8 @@ static int32_t fill_SfStruct(CSOUND *csound)
               }
               layer->splits_num = split_num;
               layer->split =
-                (splitType *) csound->Malloc(csound, split_num * sizeof(splitType));
+                (splitType *) sf_calloc(csound, split_num * sizeof(splitType),
+                                        shared);
               for (l=0; l<split_num; l++) {
                 splitDefaults(&layer->split[l]);
               }
@@ -1730,14 +1956,15 @@ static int32_t fill_SfStruct(CSOUND *csound)
                         split->num= num;
                         split->sample = &shdr[num];
                         if (UNLIKELY(split->sample->sfSampleType & 0x8000)) {
-                          csound->Free(csound, preset);
+                          soundFont->preset = preset;
+                          soundFont->presets_num = j + 1;
                           csound->ErrorMsg(csound, Str("SoundFont file \"%s\" "
                                                        "contains ROM samples !\n"
                                                        "At present time only RAM "
                                                        "samples are allowed "
                                                        "by sfload.\n"
                                                        "Session aborted !"),
-                                           Gfname);
+                                           soundFont->name);
                             return NOTOK;
                         }
                         //sglobal_zone = 0;
@@ -1873,7 +2100,7 @@ static int32_t fill_SfStruct(CSOUND *csound)
       instrType *instru;
       size = soundFont->chunk.instChunk->ckSize / sizeof(sfInst);
       soundFont->instrs_num = size;
-      instru = (instrType *) csound->Malloc(csound, size * sizeof(layerType));
+      instru = (instrType *) sf_calloc(csound, size * sizeof(instrType), shared);
       for (j=0; j < size; j++) {
 #define UNUSE 0x7fffffff
         int32_t GsampleModes=UNUSE, GcoarseTune=UNUSE, GfineTune=UNUSE;
@@ -1900,7 +2127,7 @@ static int32_t fill_SfStruct(CSOUND *csound)
         }
         instru[j].splits_num = split_num;
         instru[j].split =
-          (splitType *) csound->Malloc(csound, split_num * sizeof(splitType));
+          (splitType *) sf_calloc(csound, split_num * sizeof(splitType), shared);
         for (l=0; l<split_num; l++) {
           splitDefaults(&instru[j].split[l]);
         }
@@ -1971,12 +2198,13 @@ static int32_t fill_SfStruct(CSOUND *csound)
                   split->num= num;
                   split->sample = &shdr[num];
                   if (UNLIKELY(split->sample->sfSampleType & 0x8000)) {
-                    csound->Free(csound, instru);
+                    soundFont->instr = instru;
+                    soundFont->instrs_num = j + 1;
                     csound->ErrorMsg(csound, Str("SoundFont file \"%s\" contains "
                                             "ROM samples !\n"
                                             "At present time only RAM samples "
                                             "are allowed by sfload.\n"
-                                            "Session aborted !"), Gfname);
+                                            "Session aborted !"), soundFont->name);
                     return NOTOK;
                   }
                   //sglobal_zone = 0;
@@ -2053,9 +2281,32 @@ static int32_t fill_SfStruct(CSOUND *csound)
     end_fill_layers:
       soundFont->instr = instru;
     }
+    qsort(soundFont->preset, soundFont->presets_num, sizeof(presetType),
+          (int32_t (*)(const void *, const void * )) compare);
+    index_keys(csound, soundFont, shared);
     return OK;
 }
 
+static void free_SfStruct(CSOUND *csound, presetType *preset, int32_t presets_num,
+                          instrType *instr, int32_t instrs_num, int32_t shared)
+{
+    int32_t j, k;
+    for (j = 0; j < presets_num && preset != NULL; j++) {
+      for (k = 0; k < preset[j].layers_num && preset[j].layer != NULL; k++)
+        sf_free(csound, preset[j].layer[k].split, shared);
+      sf_free(csound, preset[j].layer, shared);
+      sf_free(csound, preset[j].keyZone, shared);
+      sf_free(csound, preset[j].zone, shared);
+    }
+    sf_free(csound, preset, shared);
+    for (j = 0; j < instrs_num && instr != NULL; j++) {
+      sf_free(csound, instr[j].split, shared);
+      sf_free(csound, instr[j].keyZone, shared);
+      sf_free(csound, instr[j].zone, shared);
+    }
+    sf_free(csound, instr, shared);
+}
+
 static void layerDefaults(layerType *layer)
 {
     layer->splits_num         = 0;
@@ -2335,7 +2586,7 @@ static int32_t sflooper_init(CSOUND *csound, sflooper *p)
     DWORD index = (DWORD) *p->ipresethandle;
     presetType *preset;
     SHORT *sBase;
-    int32_t layersNum, j, spltNum = 0;
+    int32_t z = 0, zEnd = 0, j, spltNum = 0;
     sfontg *globals;
     globals = (sfontg *) (csound->QueryGlobalVariable(csound, "::sfontg"));
 
@@ -2345,58 +2596,51 @@ static int32_t sflooper_init(CSOUND *csound, sflooper *p)
       return csound->InitError(csound, "%s", Str("sfplay: invalid or "
                                            "out-of-range preset number"));
     }
-    layersNum = preset->layers_num;
-    for (j =0; j < layersNum; j++) {
-      layerType *layer = &preset->layer[j];
-      int32_t vel= (int32_t) *p->ivel, notnum= (int32_t) *p->inotnum;
-      if (notnum >= layer->minNoteRange &&
-          notnum <= layer->maxNoteRange &&
-          vel    >= layer->minVelRange  &&
-          vel    <= layer->maxVelRange) {
-        int32_t splitsNum = layer->splits_num, k;
-        for (k = 0; k < splitsNum; k++) {
-          splitType *split = &layer->split[k];
-          if (notnum  >= split->minNoteRange &&
-              notnum  <= split->maxNoteRange &&
-              vel     >= split->minVelRange  &&
-              vel     <= split->maxVelRange) {
-            sfSample *sample = split->sample;
-            DWORD start=sample->dwStart;
-            MYFLT attenuation;
-            double pan;
-            double freq, orgfreq;
-            double tuneCorrection = split->coarseTune + layer->coarseTune +
-              (split->fineTune + layer->fineTune)*0.01;
-            int32_t orgkey = split->overridingRootKey;
-            if (orgkey == -1) orgkey = sample->byOriginalKey;
-            orgfreq = globals->pitches[orgkey];
-
-            if (*p->iflag) {
-              freq = orgfreq * pow(2.0, ONETWELTH * tuneCorrection);
-              p->freq[spltNum]= (freq/(orgfreq*orgfreq))*
-                               sample->dwSampleRate*CS_ONEDSR;
-            }
-            else {
-              freq = orgfreq * pow(2.0, ONETWELTH * tuneCorrection) *
-                pow(2.0, ONETWELTH * (split->scaleTuning*0.01) * (notnum-orgkey));
-              p->freq[spltNum]= (freq/orgfreq) * sample->dwSampleRate*CS_ONEDSR;
-            }
-
-            attenuation = (MYFLT) (layer->initialAttenuation +
-                                   split->initialAttenuation);
-            attenuation = POWER(FL(2.0), (-FL(1.0)/FL(60.0)) * attenuation )
-              * GLOBAL_ATTENUATION;
-            pan = (double)(split->pan + layer->pan) / 1000.0 + 0.5;
-            if (pan > 1.0) pan = 1.0;
-            else if (pan < 0.0) pan = 0.0;
-            p->sBase[spltNum] = sBase;
-            p->sstart[spltNum] = start;
-            p->end[spltNum] =  (DWORD) (sample->dwEnd + split->endOffset);
-            p->leftlevel[spltNum] = (MYFLT) sqrt(1.0-pan) * attenuation;
-            p->rightlevel[spltNum] = (MYFLT) sqrt(pan) * attenuation;
-            spltNum++;
-          }
+    int32_t vel = (int32_t) *p->ivel, notnum = (int32_t) *p->inotnum;
+    if (notnum >= 0 && notnum < 128) {
+      z = preset->keyZone[notnum];
+      zEnd = preset->keyZone[notnum + 1];
+    }
+    for (; z < zEnd; z++) {
+      layerType *layer = preset->zone[z].layer;
+      splitType *split = preset->zone[z].split;
+      if (vel >= layer->minVelRange && vel <= layer->maxVelRange &&
+          vel >= split->minVelRange && vel <= split->maxVelRange) {
+        sfSample *sample = split->sample;
+        DWORD start=sample->dwStart;
+        MYFLT attenuation;
+        double pan;
+        double freq, orgfreq;
+        double tuneCorrection = split->coarseTune + layer->coarseTune +
+          (split->fineTune + layer->fineTune)*0.01;
+        int32_t orgkey = split->overridingRootKey;
+        if (orgkey == -1) orgkey = sample->byOriginalKey;
+        orgfreq = globals->pitches[orgkey];
+
+        if (*p->iflag) {
+          freq = orgfreq * pow(2.0, ONETWELTH * tuneCorrection);
+          p->freq[spltNum]= (freq/(orgfreq*orgfreq))*
+                           sample->dwSampleRate*CS_ONEDSR;
         }
+        else {
+          freq = orgfreq * pow(2.0, ONETWELTH * tuneCorrection) *
+            pow(2.0, ONETWELTH * (split->scaleTuning*0.01) * (notnum-orgkey));
+          p->freq[spltNum]= (freq/orgfreq) * sample->dwSampleRate*CS_ONEDSR;
+        }
+
+        attenuation = (MYFLT) (layer->initialAttenuation +
+                               split->initialAttenuation);
+        attenuation = POWER(FL(2.0), (-FL(1.0)/FL(60.0)) * attenuation )
+          * GLOBAL_ATTENUATION;
+        pan = (double)(split->pan + layer->pan) / 1000.0 + 0.5;
+        if (pan > 1.0) pan = 1.0;
+        else if (pan < 0.0) pan = 0.0;
+        p->sBase[spltNum] = sBase;
+        p->sstart[spltNum] = start;
+        p->end[spltNum] =  (DWORD) (sample->dwEnd + split->endOffset);
+        p->leftlevel[spltNum] = (MYFLT) sqrt(1.0-pan) * attenuation;
+        p->rightlevel[spltNum] = (MYFLT) sqrt(pan) * attenuation;
+        spltNum++;
       }
     }
   p->spltNum = spltNum;
@@ -2785,7 +3029,7 @@ int32_t sfont_ModuleInit(CSOUND *csound)
 
 int32_t sfont_ModuleDestroy(CSOUND *csound)
 {
-    int32_t j,k,l;
+    int32_t j;
     SFBANK *sfArray;
     sfontg *globals;
     globals = (sfontg *) (csound->QueryGlobalVariable(csound, "::sfontg"));
@@ -2793,17 +3037,14 @@ int32_t sfont_ModuleDestroy(CSOUND *csound)
     sfArray = globals->sfArray;
 
     for (j=0; j<globals->currSFndx; j++) {
-      for (k=0; k< sfArray[j].presets_num; k++) {
-        for (l=0; l<sfArray[j].preset[k].layers_num; l++) {
-          csound->Free(csound, sfArray[j].preset[k].layer[l].split);
-        }
-        csound->Free(csound, sfArray[j].preset[k].layer);
-      }
-      csound->Free(csound, sfArray[j].preset);
-      for (l=0; l< sfArray[j].instrs_num; l++) {
-        csound->Free(csound, sfArray[j].instr[l].split);
+#ifdef SF_MMAP
+      if (sfArray[j].mapping != NULL) {
+        sf_unmap((sfMap *) sfArray[j].mapping);
+        continue;
       }
-      csound->Free(csound, sfArray[j].instr);
+#endif
+      free_SfStruct(csound, sfArray[j].preset, sfArray[j].presets_num,
+                    sfArray[j].instr, sfArray[j].instrs_num, 0);
       csound->Free(csound, sfArray[j].chunk.main_chunk.ckDATA);
     }
     csound->Free(csound, sfArray);
@@ -123,7 +123,9 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <functional>
@@ -209,6 +211,19 @@ bool operator<(const EventBlock &a, const EventBlock &b) {
   return false;
 }
 
+/**
+ * The sources of one inlet instance: the outlet lists it is connected
+ * to, and a flat copy of the outlet instances in them. The copy is only
+ * rebuilt when the topology has changed since it was made, so inlets
+ * read it at k-rate without taking signal_flow_ports_lock.
+ */
+template <typename T> struct InletRoute {
+  std::vector<std::vector<T *> *> sources;
+  std::vector<T *> outlets;
+  uint64_t topology;
+  InletRoute() : topology(UINT64_MAX) {}
+};
+
 // Identifiers are always "sourcename:outletname" and "sinkname:inletname",
 // or "sourcename:idname:outletname" and "sinkname:inletname."
 
@@ -228,29 +243,50 @@ struct SignalFlowGraphState {
   std::map<std::string, std::vector<Inletkid *>> kidinletsForSinkInletIds;
   std::map<std::string, std::vector<std::string>> connections;
   std::map<EventBlock, int> functionTablesForEvtblks;
-  std::vector<std::vector<std::vector<Outleta *> *> *> aoutletVectors;
-  std::vector<std::vector<std::vector<Outletk *> *> *> koutletVectors;
-  std::vector<std::vector<std::vector<Outletf *> *> *> foutletVectors;
-  std::vector<std::vector<std::vector<Outletv *> *> *> voutletVectors;
-  std::vector<std::vector<std::vector<Outletkid *> *> *> kidoutletVectors;
-  SignalFlowGraphState(CSOUND *csound_) {
+  std::vector<InletRoute<Outleta> *> aoutletVectors;
+  std::vector<InletRoute<Outletk> *> koutletVectors;
+  std::vector<InletRoute<Outletf> *> foutletVectors;
+  std::vector<InletRoute<Outletv> *> voutletVectors;
+  std::vector<InletRoute<Outletkid> *> kidoutletVectors;
+  std::atomic<uint64_t> topology;
+  SignalFlowGraphState(CSOUND *csound_) : topology(0) {
     csound = csound_;
     signal_flow_ports_lock = csound->Create_Mutex(0);
     signal_flow_ftables_lock = csound->Create_Mutex(0);
   }
   ~SignalFlowGraphState() {}
+  /**
+   * Call with signal_flow_ports_lock held when outlets come or go.
+   */
+  void changed() { topology.fetch_add(1, std::memory_order_release); }
+  /**
+   * Bring an inlet's flat outlet list up to date. Only takes the lock
+   * if the topology has changed since the list was made.
+   */
+  template <typename T> const std::vector<T *> &outlets(InletRoute<T> *route) {
+    if (route->topology != topology.load(std::memory_order_acquire)) {
+      LockGuard guard(csound, signal_flow_ports_lock);
+      route->outlets.clear();
+      for (size_t i = 0, n = route->sources.size(); i < n; i++) {
+        route->outlets.insert(route->outlets.end(), route->sources[i]->begin(),
+                              route->sources[i]->end());
+      }
+      route->topology = topology.load(std::memory_order_relaxed);
+    }
+    return route->outlets;
+  }
   void clear() {
     LockGuard guard(csound, signal_flow_ports_lock);
 
-    for (std::vector<std::vector<std::vector<Outleta *> *> *>::iterator it = aoutletVectors.begin(), end = aoutletVectors.end(); it != end; it++)
+    for (std::vector<InletRoute<Outleta> *>::iterator it = aoutletVectors.begin(), end = aoutletVectors.end(); it != end; it++)
       delete *it;
-    for (std::vector<std::vector<std::vector<Outletk *> *> *>::iterator it = koutletVectors.begin(), end = koutletVectors.end(); it != end; it++)
+    for (std::vector<InletRoute<Outletk> *>::iterator it = koutletVectors.begin(), end = koutletVectors.end(); it != end; it++)
       delete *it;
-    for (std::vector<std::vector<std::vector<Outletf *> *> *>::iterator it = foutletVectors.begin(), end = foutletVectors.end(); it != end; it++)
+    for (std::vector<InletRoute<Outletf> *>::iterator it = foutletVectors.begin(), end = foutletVectors.end(); it != end; it++)
       delete *it;
-    for (std::vector<std::vector<std::vector<Outletv *> *> *>::iterator it = voutletVectors.begin(), end = voutletVectors.end(); it != end; it++)
+    for (std::vector<InletRoute<Outletv> *>::iterator it = voutletVectors.begin(), end = voutletVectors.end(); it != end; it++)
       delete *it;
-    for (std::vector<std::vector<std::vector<Outletkid *> *> *>::iterator it = kidoutletVectors.begin(), end = kidoutletVectors.end(); it != end; it++)
+    for (std::vector<InletRoute<Outletkid> *>::iterator it = kidoutletVectors.begin(), end = kidoutletVectors.end(); it != end; it++)
       delete *it;
 
     aoutletsForSourceOutletIds.clear();
@@ -304,6 +340,7 @@ struct Outleta : public OpcodeNoteoffBase<Outleta> {
         sfg_globals->aoutletsForSourceOutletIds[sourceOutletId];
     if (std::find(aoutlets.begin(), aoutlets.end(), this) == aoutlets.end()) {
       aoutlets.push_back(this);
+      sfg_globals->changed();
       warn(csound, Str("Created instance 0x%x of %d instances of outlet %s\n"),
            this, aoutlets.size(), sourceOutletId);
     }
@@ -316,7 +353,10 @@ struct Outleta : public OpcodeNoteoffBase<Outleta> {
         sfg_globals->aoutletsForSourceOutletIds[sourceOutletId];
     std::vector<Outleta *>::iterator thisoutlet =
         std::find(aoutlets.begin(), aoutlets.end(), this);
-    aoutlets.erase(thisoutlet);
+    if (thisoutlet != aoutlets.end()) {
+      aoutlets.erase(thisoutlet);
+      sfg_globals->changed();
+    }
     warn(csound, Str("Removed instance 0x%x of %d instances of outleta %s\n"),
          this, aoutlets.size(), sourceOutletId);
     return OK;
@@ -336,7 +376,7 @@ struct Inleta : public OpcodeBase<Inleta> {
    * State.
    */
   char sinkInletId[MAX_STRING];
-  std::vector<std::vector<Outleta *> *> *sourceOutlets;
+  InletRoute<Outleta> *sourceOutlets;
   int32_t sampleN;
   SignalFlowGraphState *sfg_globals;
   int32_t init(CSOUND *csound) {
@@ -350,10 +390,11 @@ struct Inleta : public OpcodeBase<Inleta> {
     if (std::find(sfg_globals->aoutletVectors.begin(),
                   sfg_globals->aoutletVectors.end(),
                   sourceOutlets) == sfg_globals->aoutletVectors.end()) {
-      sourceOutlets = new std::vector<std::vector<Outleta *> *>;
+      sourceOutlets = new InletRoute<Outleta>;
       sfg_globals->aoutletVectors.push_back(sourceOutlets);
     } else {
-      sourceOutlets->clear();
+      sourceOutlets->sources.clear();
+      sourceOutlets->topology = UINT64_MAX;
     }
     warn(csound, "sourceOutlets: 0x%x\n", sourceOutlets);
     sinkInletId[0] = 0;
@@ -380,9 +421,10 @@ struct Inleta : public OpcodeBase<Inleta> {
       const std::string &sourceOutletId = sourceOutletIds[i];
       std::vector<Outleta *> &aoutlets =
           sfg_globals->aoutletsForSourceOutletIds[sourceOutletId];
-      if (std::find(sourceOutlets->begin(), sourceOutlets->end(), &aoutlets) ==
-          sourceOutlets->end()) {
-        sourceOutlets->push_back(&aoutlets);
+      if (std::find(sourceOutlets->sources.begin(),
+          sourceOutlets->sources.end(), &aoutlets) ==
+          sourceOutlets->sources.end()) {
+        sourceOutlets->sources.push_back(&aoutlets);
         warn(csound, Str("Connected instances of outlet %s to instance 0x%x of "
                          "inlet %s.\n"),
              sourceOutletId.c_str(), this, sinkInletId);
@@ -395,30 +437,25 @@ struct Inleta : public OpcodeBase<Inleta> {
    * Sum arate values from active outlets feeding this inlet.
    */
   int32_t audio(CSOUND *csound) {
-    LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
-    // warn(csound, "BEGAN Inleta::audio()...\n");
+    const std::vector<Outleta *> &outlets = sfg_globals->outlets(sourceOutlets);
+    MYFLT *sink = asignal;
     // Zero the inlet buffer.
     for (int32_t sampleI = 0; sampleI < sampleN; sampleI++) {
-      asignal[sampleI] = FL(0.0);
+      sink[sampleI] = FL(0.0);
     }
-    // Loop over the source connections...
-    for (size_t sourceI = 0, sourceN = sourceOutlets->size(); sourceI < sourceN;
-         sourceI++) {
-      // Loop over the source connection instances...
-      std::vector<Outleta *> *instances = sourceOutlets->at(sourceI);
-      for (size_t instanceI = 0, instanceN = instances->size();
-           instanceI < instanceN; instanceI++) {
-        Outleta *sourceOutlet = instances->at(instanceI);
-        // Skip inactive instances.
-        if (sourceOutlet->opds.insdshead->actflg) {
-          for (int32_t sampleI = 0, sampleN = ksmps(); sampleI < sampleN;
-               ++sampleI) {
-            asignal[sampleI] += sourceOutlet->asignal[sampleI];
-          }
+    // Sum the active outlet instances, without locking.
+    for (size_t outletI = 0, outletN = outlets.size(); outletI < outletN;
+         outletI++) {
+      const Outleta *sourceOutlet = outlets[outletI];
+      // Skip inactive instances.
+      if (sourceOutlet->opds.insdshead->actflg) {
+        const MYFLT *source = sourceOutlet->asignal;
+        for (int32_t sampleI = 0, sampleN = ksmps(); sampleI < sampleN;
+             ++sampleI) {
+          sink[sampleI] += source[sampleI];
         }
       }
     }
-    // warn(csound, "ENDED Inleta::audio().\n");
     return OK;
   }
 };
@@ -449,6 +486,7 @@ struct Outletk : public OpcodeNoteoffBase<Outletk> {
         sfg_globals->koutletsForSourceOutletIds[sourceOutletId];
     if (std::find(koutlets.begin(), koutlets.end(), this) == koutlets.end()) {
       koutlets.push_back(this);
+      sfg_globals->changed();
       warn(csound, Str("Created instance 0x%x of %d instances of outlet %s\n"),
            this, koutlets.size(), sourceOutletId);
     }
@@ -460,7 +498,10 @@ struct Outletk : public OpcodeNoteoffBase<Outletk> {
         sfg_globals->koutletsForSourceOutletIds[sourceOutletId];
     std::vector<Outletk *>::iterator thisoutlet =
         std::find(koutlets.begin(), koutlets.end(), this);
-    koutlets.erase(thisoutlet);
+    if (thisoutlet != koutlets.end()) {
+      koutlets.erase(thisoutlet);
+      sfg_globals->changed();
+    }
     warn(csound, Str("Removed 0x%x of %d instances of outletk %s\n"), this,
          koutlets.size(), sourceOutletId);
     return OK;
@@ -480,7 +521,7 @@ struct Inletk : public OpcodeBase<Inletk> {
    * State.
    */
   char sinkInletId[MAX_STRING];
-  std::vector<std::vector<Outletk *> *> *sourceOutlets;
+  InletRoute<Outletk> *sourceOutlets;
   int32_t ksmps;
   SignalFlowGraphState *sfg_globals;
   int32_t init(CSOUND *csound) {
@@ -490,10 +531,11 @@ struct Inletk : public OpcodeBase<Inletk> {
     if (std::find(sfg_globals->koutletVectors.begin(),
                   sfg_globals->koutletVectors.end(),
                   sourceOutlets) == sfg_globals->koutletVectors.end()) {
-      sourceOutlets = new std::vector<std::vector<Outletk *> *>;
+      sourceOutlets = new InletRoute<Outletk>;
       sfg_globals->koutletVectors.push_back(sourceOutlets);
     } else {
-      sourceOutlets->clear();
+      sourceOutlets->sources.clear();
+      sourceOutlets->topology = UINT64_MAX;
     }
     sinkInletId[0] = 0;
     const char *insname =
@@ -519,9 +561,10 @@ struct Inletk : public OpcodeBase<Inletk> {
       const std::string &sourceOutletId = sourceOutletIds[i];
       std::vector<Outletk *> &koutlets =
           sfg_globals->koutletsForSourceOutletIds[sourceOutletId];
-      if (std::find(sourceOutlets->begin(), sourceOutlets->end(), &koutlets) ==
-          sourceOutlets->end()) {
-        sourceOutlets->push_back(&koutlets);
+      if (std::find(sourceOutlets->sources.begin(),
+          sourceOutlets->sources.end(), &koutlets) ==
+          sourceOutlets->sources.end()) {
+        sourceOutlets->sources.push_back(&koutlets);
         warn(csound, Str("Connected instances of outlet %s to instance 0x%x"
                          "of inlet %s.\n"),
              sourceOutletId.c_str(), this, sinkInletId);
@@ -533,23 +576,17 @@ struct Inletk : public OpcodeBase<Inletk> {
    * Sum krate values from active outlets feeding this inlet.
    */
   int32_t kontrol(CSOUND *csound) {
-    LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
-    // Zero the inlet buffer.
-    *ksignal = FL(0.0);
-    // Loop over the source connections...
-    for (size_t sourceI = 0, sourceN = sourceOutlets->size(); sourceI < sourceN;
-         sourceI++) {
-      // Loop over the source connection instances...
-      const std::vector<Outletk *> *instances = sourceOutlets->at(sourceI);
-      for (size_t instanceI = 0, instanceN = instances->size();
-           instanceI < instanceN; instanceI++) {
-        const Outletk *sourceOutlet = instances->at(instanceI);
-        // Skip inactive instances.
-        if (sourceOutlet->opds.insdshead->actflg) {
-          *ksignal += *sourceOutlet->ksignal;
-        }
+    const std::vector<Outletk *> &outlets = sfg_globals->outlets(sourceOutlets);
+    MYFLT sum = FL(0.0);
+    for (size_t outletI = 0, outletN = outlets.size(); outletI < outletN;
+         outletI++) {
+      const Outletk *sourceOutlet = outlets[outletI];
+      // Skip inactive instances.
+      if (sourceOutlet->opds.insdshead->actflg) {
+        sum += *sourceOutlet->ksignal;
       }
     }
+    *ksignal = sum;
     return OK;
   }
 };
@@ -580,17 +617,22 @@ struct Outletf : public OpcodeNoteoffBase<Outletf> {
         sfg_globals->foutletsForSourceOutletIds[sourceOutletId];
     if (std::find(foutlets.begin(), foutlets.end(), this) == foutlets.end()) {
       foutlets.push_back(this);
+      sfg_globals->changed();
       warn(csound, Str("Created instance 0x%x of outlet %s\n"), this,
            sourceOutletId);
     }
     return OK;
   }
   int32_t noteoff(CSOUND *csound) {
+    LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
     std::vector<Outletf *> &foutlets =
         sfg_globals->foutletsForSourceOutletIds[sourceOutletId];
     std::vector<Outletf *>::iterator thisoutlet =
         std::find(foutlets.begin(), foutlets.end(), this);
-    foutlets.erase(thisoutlet);
+    if (thisoutlet != foutlets.end()) {
+      foutlets.erase(thisoutlet);
+      sfg_globals->changed();
+    }
     warn(csound, Str("Removed 0x%x of %d instances of outletf %s\n"), this,
          foutlets.size(), sourceOutletId);
     return OK;
@@ -610,7 +652,7 @@ struct Inletf : public OpcodeBase<Inletf> {
    * State.
    */
   char sinkInletId[MAX_STRING];
-  std::vector<std::vector<Outletf *> *> *sourceOutlets;
+  InletRoute<Outletf> *sourceOutlets;
   int32_t ksmps;
   int32_t lastframe;
   bool fsignalInitialized;
@@ -624,10 +666,11 @@ struct Inletf : public OpcodeBase<Inletf> {
     if (std::find(sfg_globals->foutletVectors.begin(),
                   sfg_globals->foutletVectors.end(),
                   sourceOutlets) == sfg_globals->foutletVectors.end()) {
-      sourceOutlets = new std::vector<std::vector<Outletf *> *>;
+      sourceOutlets = new InletRoute<Outletf>;
       sfg_globals->foutletVectors.push_back(sourceOutlets);
     } else {
-      sourceOutlets->clear();
+      sourceOutlets->sources.clear();
+      sourceOutlets->topology = UINT64_MAX;
     }
     sinkInletId[0] = 0;
     const char *insname =
@@ -653,9 +696,10 @@ struct Inletf : public OpcodeBase<Inletf> {
       const std::string &sourceOutletId = sourceOutletIds[i];
       std::vector<Outletf *> &foutlets =
           sfg_globals->foutletsForSourceOutletIds[sourceOutletId];
-      if (std::find(sourceOutlets->begin(), sourceOutlets->end(), &foutlets) ==
-          sourceOutlets->end()) {
-        sourceOutlets->push_back(&foutlets);
+      if (std::find(sourceOutlets->sources.begin(),
+          sourceOutlets->sources.end(), &foutlets) ==
+          sourceOutlets->sources.end()) {
+        sourceOutlets->sources.push_back(&foutlets);
         warn(csound, Str("Connected instances of outlet %s to instance 0x%x of "
                          "inlet %s.\n"),
              sourceOutletId.c_str(), this, sinkInletId);
@@ -667,82 +711,76 @@ struct Inletf : public OpcodeBase<Inletf> {
    * Mix fsig values from active outlets feeding this inlet.
    */
   int32_t audio(CSOUND *csound) {
-    LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
+    const std::vector<Outletf *> &outlets = sfg_globals->outlets(sourceOutlets);
     int32_t result = OK;
     float *sink = 0;
     float *source = 0;
     CMPLX *sinkFrame = 0;
     CMPLX *sourceFrame = 0;
-    // Loop over the source connections...
-    for (size_t sourceI = 0, sourceN = sourceOutlets->size(); sourceI < sourceN;
-         sourceI++) {
-      // Loop over the source connection instances...
-      const std::vector<Outletf *> *instances = sourceOutlets->at(sourceI);
-      for (size_t instanceI = 0, instanceN = instances->size();
-           instanceI < instanceN; instanceI++) {
-        const Outletf *sourceOutlet = instances->at(instanceI);
-        // Skip inactive instances.
-        if (sourceOutlet->opds.insdshead->actflg) {
-          if (!fsignalInitialized) {
-            int32 N = sourceOutlet->fsignal->N;
-            if (UNLIKELY(sourceOutlet->fsignal == fsignal)) {
-              csound->Warning(csound,
-                              "%s", Str("Unsafe to have same fsig as in and out"));
-            }
-            fsignal->sliding = 0;
-            if (sourceOutlet->fsignal->sliding) {
-              if (fsignal->frame.auxp == 0 ||
-                  fsignal->frame.size <
-                      sizeof(MYFLT) * opds.insdshead->ksmps * (N + 2))
-                csound->AuxAlloc(
-                    csound, (N + 2) * sizeof(MYFLT) * opds.insdshead->ksmps,
-                    &fsignal->frame);
-              fsignal->NB = sourceOutlet->fsignal->NB;
-              fsignal->sliding = 1;
-            } else if (fsignal->frame.auxp == 0 ||
-                       fsignal->frame.size < sizeof(float) * (N + 2)) {
-              csound->AuxAlloc(csound, (N + 2) * sizeof(float),
-                               &fsignal->frame);
-            }
-            fsignal->N = N;
-            fsignal->overlap = sourceOutlet->fsignal->overlap;
-            fsignal->winsize = sourceOutlet->fsignal->winsize;
-            fsignal->wintype = sourceOutlet->fsignal->wintype;
-            fsignal->format = sourceOutlet->fsignal->format;
-            fsignal->framecount = 1;
-            lastframe = 0;
-            if (UNLIKELY(!((fsignal->format == PVS_AMP_FREQ) ||
-                           (fsignal->format == PVS_AMP_PHASE))))
-              result = csound->InitError(csound,
-                                         "%s", Str("inletf: signal format "
-                                             "must be amp-phase or amp-freq."));
-            fsignalInitialized = true;
+    for (size_t outletI = 0, outletN = outlets.size(); outletI < outletN;
+         outletI++) {
+      const Outletf *sourceOutlet = outlets[outletI];
+      // Skip inactive instances.
+      if (sourceOutlet->opds.insdshead->actflg) {
+        if (!fsignalInitialized) {
+          int32 N = sourceOutlet->fsignal->N;
+          if (UNLIKELY(sourceOutlet->fsignal == fsignal)) {
+            csound->Warning(csound,
+                            "%s", Str("Unsafe to have same fsig as in and out"));
+          }
+          fsignal->sliding = 0;
+          if (sourceOutlet->fsignal->sliding) {
+            if (fsignal->frame.auxp == 0 ||
+                fsignal->frame.size <
+                    sizeof(MYFLT) * opds.insdshead->ksmps * (N + 2))
+              csound->AuxAlloc(
+                  csound, (N + 2) * sizeof(MYFLT) * opds.insdshead->ksmps,
+                  &fsignal->frame);
+            fsignal->NB = sourceOutlet->fsignal->NB;
+            fsignal->sliding = 1;
+          } else if (fsignal->frame.auxp == 0 ||
+                     fsignal->frame.size < sizeof(float) * (N + 2)) {
+            csound->AuxAlloc(csound, (N + 2) * sizeof(float),
+                             &fsignal->frame);
           }
-          if (fsignal->sliding) {
-            for (int32_t frameI = 0; frameI < ksmps; frameI++) {
-              sinkFrame = (CMPLX *)fsignal->frame.auxp + (fsignal->NB * frameI);
-              sourceFrame = (CMPLX *)sourceOutlet->fsignal->frame.auxp +
-                            (fsignal->NB * frameI);
-              for (size_t binI = 0, binN = fsignal->NB; binI < binN; binI++) {
-                if (sourceFrame[binI].re > sinkFrame[binI].re) {
-                  sinkFrame[binI] = sourceFrame[binI];
-                }
+          fsignal->N = N;
+          fsignal->overlap = sourceOutlet->fsignal->overlap;
+          fsignal->winsize = sourceOutlet->fsignal->winsize;
+          fsignal->wintype = sourceOutlet->fsignal->wintype;
+          fsignal->format = sourceOutlet->fsignal->format;
+          fsignal->framecount = 1;
+          lastframe = 0;
+          if (UNLIKELY(!((fsignal->format == PVS_AMP_FREQ) ||
+                         (fsignal->format == PVS_AMP_PHASE))))
+            result = csound->InitError(csound,
+                                       "%s", Str("inletf: signal format "
+                                           "must be amp-phase or amp-freq."));
+          fsignalInitialized = true;
+        }
+        if (fsignal->sliding) {
+          for (int32_t frameI = 0; frameI < ksmps; frameI++) {
+            sinkFrame = (CMPLX *)fsignal->frame.auxp + (fsignal->NB * frameI);
+            sourceFrame = (CMPLX *)sourceOutlet->fsignal->frame.auxp +
+                          (fsignal->NB * frameI);
+            for (size_t binI = 0, binN = fsignal->NB; binI < binN; binI++) {
+              if (sourceFrame[binI].re > sinkFrame[binI].re) {
+                sinkFrame[binI] = sourceFrame[binI];
               }
             }
           }
-        } else {
-          sink = (float *)fsignal->frame.auxp;
-          source = (float *)sourceOutlet->fsignal->frame.auxp;
-          if (lastframe < int(fsignal->framecount)) {
-            for (size_t binI = 0, binN = fsignal->N + 2; binI < binN;
-                 binI += 2) {
-              if (source[binI] > sink[binI]) {
-                source[binI] = sink[binI];
-                source[binI + 1] = sink[binI + 1];
-              }
+        }
+      } else {
+        sink = (float *)fsignal->frame.auxp;
+        source = (float *)sourceOutlet->fsignal->frame.auxp;
+        if (lastframe < int(fsignal->framecount)) {
+          for (size_t binI = 0, binN = fsignal->N + 2; binI < binN;
+               binI += 2) {
+            if (source[binI] > sink[binI]) {
+              source[binI] = sink[binI];
+              source[binI + 1] = sink[binI + 1];
             }
-            fsignal->framecount = lastframe = sourceOutlet->fsignal->framecount;
           }
+          fsignal->framecount = lastframe = sourceOutlet->fsignal->framecount;
         }
       }
     }
@@ -778,6 +816,7 @@ struct Outletv : public OpcodeNoteoffBase<Outletv> {
         sfg_globals->voutletsForSourceOutletIds[sourceOutletId];
     if (std::find(voutlets.begin(), voutlets.end(), this) == voutlets.end()) {
       voutlets.push_back(this);
+      sfg_globals->changed();
       warn(csound,
            Str("Created instance 0x%x of %d instances of outlet %s (out "
                "arraydat: 0x%x dims: %2d size: %4d [%4d] data: 0x%x (0x%x))\n"),
@@ -794,7 +833,10 @@ struct Outletv : public OpcodeNoteoffBase<Outletv> {
         sfg_globals->voutletsForSourceOutletIds[sourceOutletId];
     std::vector<Outletv *>::iterator thisoutlet =
         std::find(voutlets.begin(), voutlets.end(), this);
-    voutlets.erase(thisoutlet);
+    if (thisoutlet != voutlets.end()) {
+      voutlets.erase(thisoutlet);
+      sfg_globals->changed();
+    }
     warn(csound, Str("Removed 0x%x of %d instances of outletv %s\n"), this,
          voutlets.size(), sourceOutletId);
     return OK;
@@ -814,7 +856,7 @@ struct Inletv : public OpcodeBase<Inletv> {
    * State.
    */
   char sinkInletId[MAX_STRING];
-  std::vector<std::vector<Outletv *> *> *sourceOutlets;
+  InletRoute<Outletv> *sourceOutlets;
   size_t arraySize;
   size_t myFltsPerArrayElement;
   int32_t sampleN;
@@ -837,10 +879,11 @@ struct Inletv : public OpcodeBase<Inletv> {
     if (std::find(sfg_globals->voutletVectors.begin(),
                   sfg_globals->voutletVectors.end(),
                   sourceOutlets) == sfg_globals->voutletVectors.end()) {
-      sourceOutlets = new std::vector<std::vector<Outletv *> *>;
+      sourceOutlets = new InletRoute<Outletv>;
       sfg_globals->voutletVectors.push_back(sourceOutlets);
     } else {
-      sourceOutlets->clear();
+      sourceOutlets->sources.clear();
+      sourceOutlets->topology = UINT64_MAX;
     }
     warn(csound, "sourceOutlets: 0x%x\n", sourceOutlets);
     sinkInletId[0] = 0;
@@ -869,9 +912,10 @@ struct Inletv : public OpcodeBase<Inletv> {
       const std::string &sourceOutletId = sourceOutletIds[i];
       std::vector<Outletv *> &voutlets =
           sfg_globals->voutletsForSourceOutletIds[sourceOutletId];
-      if (std::find(sourceOutlets->begin(), sourceOutlets->end(), &voutlets) ==
-          sourceOutlets->end()) {
-        sourceOutlets->push_back(&voutlets);
+      if (std::find(sourceOutlets->sources.begin(),
+          sourceOutlets->sources.end(), &voutlets) ==
+          sourceOutlets->sources.end()) {
+        sourceOutlets->sources.push_back(&voutlets);
         warn(csound, Str("Connected instances of outlet %s to instance 0x%x of "
                          "inlet %s\n"),
              sourceOutletId.c_str(), this, sinkInletId);
@@ -884,33 +928,22 @@ struct Inletv : public OpcodeBase<Inletv> {
    * Sum values from active outlets feeding this inlet.
    */
   int32_t audio(CSOUND *csound) {
-    // warn(csound, "BEGAN Inletv::audio()...\n");
-    LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
+    const std::vector<Outletv *> &outlets = sfg_globals->outlets(sourceOutlets);
+    MYFLT *sink = vsignal->data;
     for (uint32_t signalI = 0; signalI < arraySize; ++signalI) {
-      vsignal->data[signalI] = FL(0.0);
+      sink[signalI] = FL(0.0);
     }
-    // Loop over the source connections...
-    for (size_t sourceI = 0, sourceN = sourceOutlets->size(); sourceI < sourceN;
-         sourceI++) {
-      // Loop over the source connection instances...
-      std::vector<Outletv *> *instances = sourceOutlets->at(sourceI);
-      for (size_t instanceI = 0, instanceN = instances->size();
-           instanceI < instanceN; instanceI++) {
-        Outletv *sourceOutlet = instances->at(instanceI);
-        // Skip inactive instances.
-        if (sourceOutlet->opds.insdshead->actflg) {
-          for (uint32_t signalI = 0; signalI < arraySize; ++signalI) {
-            ARRAYDAT *insignal = sourceOutlet->vsignal;
-            MYFLT *indata = insignal->data;
-            // warn(csound, "Inletv::audio: sourceOutlet: 0%x in arraydat: 0x%x
-            // data: 0x%x (0x%x)\n", sourceOutlet, insignal, indata,
-            // &insignal->data);
-            vsignal->data[signalI] += indata[signalI];
-          }
+    for (size_t outletI = 0, outletN = outlets.size(); outletI < outletN;
+         outletI++) {
+      const Outletv *sourceOutlet = outlets[outletI];
+      // Skip inactive instances.
+      if (sourceOutlet->opds.insdshead->actflg) {
+        const MYFLT *source = sourceOutlet->vsignal->data;
+        for (uint32_t signalI = 0; signalI < arraySize; ++signalI) {
+          sink[signalI] += source[signalI];
         }
       }
     }
-    // warn(csound, "ENDED Inletv::audio().\n");
     return OK;
   }
 };
@@ -951,6 +984,7 @@ struct Outletkid : public OpcodeNoteoffBase<Outletkid> {
         sfg_globals->kidoutletsForSourceOutletIds[sourceOutletId];
     if (std::find(koutlets.begin(), koutlets.end(), this) == koutlets.end()) {
       koutlets.push_back(this);
+      sfg_globals->changed();
       warn(csound, Str("Created instance 0x%x of %d instances of outlet %s\n"),
            this, koutlets.size(), sourceOutletId);
     }
@@ -962,7 +996,10 @@ struct Outletkid : public OpcodeNoteoffBase<Outletkid> {
         sfg_globals->kidoutletsForSourceOutletIds[sourceOutletId];
     std::vector<Outletkid *>::iterator thisoutlet =
         std::find(koutlets.begin(), koutlets.end(), this);
-    koutlets.erase(thisoutlet);
+    if (thisoutlet != koutlets.end()) {
+      koutlets.erase(thisoutlet);
+      sfg_globals->changed();
+    }
     warn(csound, Str("Removed 0x%x of %d instances of outletkid %s\n"), this,
          koutlets.size(), sourceOutletId);
     return OK;
@@ -984,7 +1021,7 @@ struct Inletkid : public OpcodeBase<Inletkid> {
    */
   char sinkInletId[MAX_STRING];
   char *instanceId;
-  std::vector<std::vector<Outletkid *> *> *sourceOutlets;
+  InletRoute<Outletkid> *sourceOutlets;
   int32_t ksmps;
   SignalFlowGraphState *sfg_globals;
   int32_t init(CSOUND *csound) {
@@ -994,10 +1031,11 @@ struct Inletkid : public OpcodeBase<Inletkid> {
     if (std::find(sfg_globals->kidoutletVectors.begin(),
                   sfg_globals->kidoutletVectors.end(),
                   sourceOutlets) == sfg_globals->kidoutletVectors.end()) {
-      sourceOutlets = new std::vector<std::vector<Outletkid *> *>;
+      sourceOutlets = new InletRoute<Outletkid>;
       sfg_globals->kidoutletVectors.push_back(sourceOutlets);
     } else {
-      sourceOutlets->clear();
+      sourceOutlets->sources.clear();
+      sourceOutlets->topology = UINT64_MAX;
     }
     sinkInletId[0] = 0;
     instanceId = csound->StringArg2Name(csound, (char *)0, SinstanceId->data,
@@ -1025,9 +1063,10 @@ struct Inletkid : public OpcodeBase<Inletkid> {
       const std::string &sourceOutletId = sourceOutletIds[i];
       std::vector<Outletkid *> &koutlets =
           sfg_globals->kidoutletsForSourceOutletIds[sourceOutletId];
-      if (std::find(sourceOutlets->begin(), sourceOutlets->end(), &koutlets) ==
-          sourceOutlets->end()) {
-        sourceOutlets->push_back(&koutlets);
+      if (std::find(sourceOutlets->sources.begin(),
+          sourceOutlets->sources.end(), &koutlets) ==
+          sourceOutlets->sources.end()) {
+        sourceOutlets->sources.push_back(&koutlets);
         warn(csound, Str("Connected instances of outlet %s to instance 0x%x of "
                          "inlet %s.\n"),
              sourceOutletId.c_str(), this, sinkInletId);
@@ -1039,25 +1078,19 @@ struct Inletkid : public OpcodeBase<Inletkid> {
    * Replay instance signal.
    */
   int32_t kontrol(CSOUND *csound) {
-    LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
-    // Zero the / buffer.
-    *ksignal = FL(0.0);
-    // Loop over the source connections...
-    for (size_t sourceI = 0, sourceN = sourceOutlets->size(); sourceI < sourceN;
-         sourceI++) {
-      // Loop over the source connection instances...
-      const std::vector<Outletkid *> *instances = sourceOutlets->at(sourceI);
-      for (size_t instanceI = 0, instanceN = instances->size();
-           instanceI < instanceN; instanceI++) {
-        const Outletkid *sourceOutlet = instances->at(instanceI);
-        // Skip inactive instances and also all non-matching instances.
-        if (sourceOutlet->opds.insdshead->actflg) {
-          if (std::strcmp(sourceOutlet->instanceId, instanceId) == 0) {
-            *ksignal += *sourceOutlet->ksignal;
-          }
-        }
+    const std::vector<Outletkid *> &outlets =
+        sfg_globals->outlets(sourceOutlets);
+    MYFLT sum = FL(0.0);
+    for (size_t outletI = 0, outletN = outlets.size(); outletI < outletN;
+         outletI++) {
+      const Outletkid *sourceOutlet = outlets[outletI];
+      // Skip inactive instances and also all non-matching instances.
+      if (sourceOutlet->opds.insdshead->actflg &&
+          std::strcmp(sourceOutlet->instanceId, instanceId) == 0) {
+        sum += *sourceOutlet->ksignal;
       }
     }
+    *ksignal = sum;
     return OK;
   }
 };
@@ -1442,19 +1475,20 @@ static OENTRY oentries[] = {
     {(char *)"inleta", sizeof(Inleta), _CR,  (char *)"a", (char *)"S",
      (SUBR)&Inleta::init_, (SUBR)&Inleta::audio_},
     {(char *)"outletk", sizeof(Outletk), _CW,  (char *)"", (char *)"Sk",
-     (SUBR)&Outletk::init_, (SUBR)&Outletk::kontrol_, (SUBR)&Outleta::deinit_},
+     (SUBR)&Outletk::init_, (SUBR)&Outletk::kontrol_, (SUBR)&Outletk::deinit_},
     {(char *)"inletk", sizeof(Inletk), _CR,  (char *)"k", (char *)"S",
      (SUBR)&Inletk::init_, (SUBR)&Inletk::kontrol_, 0},
     {(char *)"outletkid", sizeof(Outletkid), _CW,  (char *)"", (char *)"SSk",
-     (SUBR)&Outletk::init_, (SUBR)&Outletk::kontrol_, (SUBR)&Outleta::deinit_},
+     (SUBR)&Outletkid::init_, (SUBR)&Outletkid::kontrol_,
+     (SUBR)&Outletkid::deinit_},
     {(char *)"inletkid", sizeof(Inletkid), _CR,  (char *)"k", (char *)"SS",
-     (SUBR)&Inletk::init_, (SUBR)&Inletk::kontrol_, 0},
+     (SUBR)&Inletkid::init_, (SUBR)&Inletkid::kontrol_, 0},
     {(char *)"outletf", sizeof(Outletf), _CW,  (char *)"", (char *)"Sf",
-     (SUBR)&Outletf::init_, (SUBR)&Outletf::audio_, (SUBR)&Outleta::deinit_},
+     (SUBR)&Outletf::init_, (SUBR)&Outletf::audio_, (SUBR)&Outletf::deinit_},
     {(char *)"inletf", sizeof(Inletf), _CR,  (char *)"f", (char *)"S",
      (SUBR)&Inletf::init_, (SUBR)&Inletf::audio_},
     {(char *)"outletv", sizeof(Outletv), _CW,  (char *)"", (char *)"Sa[]",
-     (SUBR)&Outletv::init_, (SUBR)&Outletv::audio_, (SUBR)&Outleta::deinit_},
+     (SUBR)&Outletv::init_, (SUBR)&Outletv::audio_, (SUBR)&Outletv::deinit_},
     {(char *)"inletv", sizeof(Inletv), _CR,  (char *)"a[]", (char *)"S",
      (SUBR)&Inletv::init_, (SUBR)&Inletv::audio_},
     {(char *)"connect", sizeof(Connect), 0,  (char *)"", (char *)"iSiSp",
@@ -65,6 +65,7 @@ int32_t stdopc_ModuleInit(CSOUND *csound)
     err |= dam_init_(csound);
     err |= dcblockr_init_(csound);
     err |= filter_init_(csound);
+    err |= filterbank_init_(csound);
     err |= flanger_init_(csound);
     err |= follow_init_(csound);
     err |= fout_init_(csound);
@@ -86,6 +86,7 @@ extern int32_t cross2_init_(CSOUND *);
 extern int32_t dam_init_(CSOUND *);
 extern int32_t dcblockr_init_(CSOUND *);
 extern int32_t filter_init_(CSOUND *);
+extern int32_t filterbank_init_(CSOUND *);
 extern int32_t flanger_init_(CSOUND *);
 extern int32_t follow_init_(CSOUND *);
 extern int32_t fout_init_(CSOUND *);
@@ -129,7 +129,7 @@ int32_t pvset_(CSOUND *csound, PVOC *p, int32_t stringname)
   if (p->memenv.auxp == NULL || p->memenv.size < pvdasiz(p)*sizeof(MYFLT))
     csound->AuxAlloc(csound, pvdasiz(p) * sizeof(MYFLT), &p->memenv);
 
-  p->setup = csound->RealFFTSetup(csound, pvfrsiz(p), FFT_INV);
+  p->setup = csound->RealFFTSetupFor(csound, pvfrsiz(p), FFT_INV, &p->h);
   return OK;
 }
 
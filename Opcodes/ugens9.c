@@ -28,6 +28,13 @@
 #include "soundio.h"
 #include <inttypes.h>
 
+/* hands back the FFT setups an opcode asked for at init */
+static int32_t fft_deinit(CSOUND *csound, void *p)
+{
+  csound->ReleaseFFTSetups(csound, (OPDS *) p);
+  return OK;
+}
+
 static int32_t cvset_(CSOUND *csound, CONVOLVE *p, int32_t stringname)
 {
   char     cvfilnam[MAXNAME];
@@ -139,8 +146,8 @@ static int32_t cvset_(CSOUND *csound, CONVOLVE *p, int32_t stringname)
   p->incount = 0;
   p->obufend = p->outbuf + obufsiz - 1;
   p->outhead = p->outail = p->outbuf;
-  p->fwdsetup = csound->RealFFTSetup(csound, Hlenpadded, FFT_FWD);
-  p->invsetup = csound->RealFFTSetup(csound, Hlenpadded, FFT_INV);
+  p->fwdsetup = csound->RealFFTSetupFor(csound, Hlenpadded, FFT_FWD, &p->h);
+  p->invsetup = csound->RealFFTSetupFor(csound, Hlenpadded, FFT_INV, &p->h);
   return OK;
 }
 
@@ -453,8 +460,8 @@ static int32_t pconvset_(CSOUND *csound, PCONVOLVE *p, int32_t stringname)
   csound->AuxAlloc(csound, p->numPartitions * (p->Hlenpadded + 2) *
                    sizeof(MYFLT) * p->nchanls, &p->H);
   IRblock = (MYFLT *)p->H.auxp;
-  p->fwdsetup = csound->RealFFTSetup(csound,p->Hlenpadded, FFT_FWD);
-  p->invsetup = csound->RealFFTSetup(csound,p->Hlenpadded, FFT_INV);
+  p->fwdsetup = csound->RealFFTSetupFor(csound,p->Hlenpadded, FFT_FWD, &p->h);
+  p->invsetup = csound->RealFFTSetupFor(csound,p->Hlenpadded, FFT_INV, &p->h);
   
   /* form each partition and take its FFT */
   for (part = 0; part < p->numPartitions; part++) {
@@ -652,17 +659,17 @@ static int32_t pconvolve(CSOUND *csound, PCONVOLVE *p)
 static OENTRY localops[] =
   {
    { "convolve", sizeof(CONVOLVE),   0, "mmmm", "aSo",
-            (SUBR) cvset_S,    (SUBR) convolve   },
+            (SUBR) cvset_S,    (SUBR) convolve, (SUBR) fft_deinit },
    { "convle",   sizeof(CONVOLVE),   0,  "mmmm", "aSo",
-            (SUBR) cvset_S,    (SUBR) convolve   },
+            (SUBR) cvset_S,    (SUBR) convolve, (SUBR) fft_deinit },
    { "pconvolve",sizeof(PCONVOLVE),  0,  "mmmm", "aSoo",
-      (SUBR) pconvset_S,    (SUBR) pconvolve  },
+      (SUBR) pconvset_S,    (SUBR) pconvolve, (SUBR) fft_deinit },
    { "convolve.i", sizeof(CONVOLVE),   0,  "mmmm", "aio",
-            (SUBR) cvset,    (SUBR) convolve   },
+            (SUBR) cvset,    (SUBR) convolve, (SUBR) fft_deinit },
    { "convle.i",   sizeof(CONVOLVE),   0,  "mmmm", "aio",
-            (SUBR) cvset,    (SUBR) convolve   },
+            (SUBR) cvset,    (SUBR) convolve, (SUBR) fft_deinit },
    { "pconvolve.i",sizeof(PCONVOLVE),  0, "mmmm", "aioo",
-            (SUBR) pconvset,    (SUBR) pconvolve  }
+            (SUBR) pconvset,    (SUBR) pconvolve, (SUBR) fft_deinit }
 };
 
 
@@ -25,6 +25,7 @@
 #include "new_opts.h"
 #include "csmodule.h"
 #include "corfile.h"
+#include "vecops.h"
 #include <ctype.h>
 
 static void list_audio_devices(CSOUND *csound, int32_t output);
@@ -314,6 +315,22 @@ static const char *longUsageList[] = {
     Str_noop(
         "--sample-accurate       use sample-accurate timing of score events"),
     Str_noop("--realtime              realtime priority mode"),
+    Str_noop("--expression-opt        fuse a-rate expressions into "
+             "one opcode"),
+    Str_noop("--math-accuracy=MODE    exact, ulp or fast a-rate math functions"),
+    Str_noop("--lockstep              perform the instances of an instrument "
+             "together"),
+    Str_noop("--pvs-split             keep pvsanal frames split into amplitude "
+             "and frequency arrays"),
+    Str_noop("--diskin-cache=N        megabytes of sound file pages shared by "
+             "diskin2 (0: none)"),
+    Str_noop("--diskin-sinc-tables    diskin2 sinc interpolation from tables "
+             "shared by all instances"),
+    Str_noop("--decode-cache=N        megabytes of decoded FLAC, Ogg and MP3 "
+             "files kept (default 0: none)"),
+    Str_noop("--no-vector-lanes       render oscbnk, grain2, grain3 and "
+             "partikkel one oscillator"),
+    Str_noop("                          or grain sample at a time"),
     Str_noop("--nchnls=N              override number of audio channels"),
     Str_noop("--nchnls_i=N            override number of input audio channels"),
     Str_noop("--0dbfs=N               override 0dbfs (max positive signal "
@@ -337,7 +354,7 @@ static const char *longUsageList[] = {
              "                        output (e.g. -odac) to be defined first"),
     Str_noop("--ksmps=N               override ksmps"),
     Str_noop("--fftlib=N              actual FFT lib to use (FFTLIB=0, "
-             "PFFFT = 1, vDSP =2)"),
+             "PFFFT = 1, vDSP =2, double PFFFT = 3)"),
     Str_noop("--udp-echo              echo UDP commands on terminal"),
     Str_noop(
         "--aft-zero              set aftertouch to zero, not 127 (default)"),
@@ -933,14 +950,63 @@ static int32_t decode_long(CSOUND *csound, char *s, int32_t argc, char **argv) {
     return 1;
   }
   /* IV - Jan 27 2005: --expression-opt */
-  /* NOTE these do nothing */
+  /* now turns fusion of a-rate expressions on or off */
   else if (!(strcmp(s, "expression-opt"))) {
-    // O->expr_opt = 1;
-    csound->Warning(csound, Str("option expresson-opt has no affect\n"));
+    O->expr_fuse = 1;
     return 1;
   } else if (!(strcmp(s, "no-expression-opt"))) {
-    // O->expr_opt = 0;
-    csound->Warning(csound, Str("option no-expresson-opt has no affect\n"));
+    O->expr_fuse = 0;
+    return 1;
+  } else if (!(strncmp(s, "math-accuracy=", 14))) {
+    s += 14;
+    if (!strcmp(s, "exact"))
+      O->math_accuracy = VECMATH_EXACT;
+    else if (!strcmp(s, "ulp"))
+      O->math_accuracy = VECMATH_ULP;
+    else if (!strcmp(s, "fast"))
+      O->math_accuracy = VECMATH_FAST;
+    else
+      dieu(csound, Str("math-accuracy must be exact, ulp or fast"));
+    return 1;
+  } else if (!(strcmp(s, "lockstep"))) {
+    O->lockstep = 1;
+    return 1;
+  } else if (!(strcmp(s, "no-lockstep"))) {
+    O->lockstep = 0;
+    return 1;
+  } else if (!(strcmp(s, "pvs-split"))) {
+    O->pvs_split = 1;
+    return 1;
+  } else if (!(strcmp(s, "no-pvs-split"))) {
+    O->pvs_split = 0;
+    return 1;
+  } else if (!(strcmp(s, "diskin-sinc-tables"))) {
+    O->diskin_sinc_tables = 1;
+    return 1;
+  } else if (!(strcmp(s, "no-diskin-sinc-tables"))) {
+    O->diskin_sinc_tables = 0;
+    return 1;
+  } else if (!(strncmp(s, "diskin-cache=", 13))) {
+    s += 13;
+    if (UNLIKELY(*s == '\0'))
+      dieu(csound, Str("no diskin-cache size"));
+    O->diskin_cache = atoi(s);
+    if (O->diskin_cache < 0)
+      O->diskin_cache = 0;
+    return 1;
+  } else if (!(strncmp(s, "decode-cache=", 13))) {
+    s += 13;
+    if (UNLIKELY(*s == '\0'))
+      dieu(csound, Str("no decode-cache size"));
+    O->decode_cache = atoi(s);
+    if (O->decode_cache < 0)
+      O->decode_cache = 0;
+    return 1;
+  } else if (!(strcmp(s, "vector-lanes"))) {
+    O->vector_lanes = 1;
+    return 1;
+  } else if (!(strcmp(s, "no-vector-lanes"))) {
+    O->vector_lanes = 0;
     return 1;
   } else if (!(strncmp(s, "env:", 4))) {
     if (csoundParseEnv(csound, s + 4) == CSOUND_SUCCESS)
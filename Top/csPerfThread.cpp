@@ -23,6 +23,11 @@
 
 #include <iostream>
 #include <exception>
+#include <atomic>
+#include <cstddef>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 #include "csound.hpp"
 #include "csound_files.h"
@@ -118,6 +123,22 @@ public:
 
 // ----------------------------------------------------------------------------
 
+/**
+ * Message classes that are recycled through a free list instead of being
+ * deleted after use; see CsPerfThreadQueue.
+ */
+
+enum {
+    CSPT_POOL_SCOREEVENT = 0,
+    CSPT_POOL_INPUTMESSAGE,
+    CSPT_POOL_COUNT
+};
+
+/* number of messages of each pooled class allocated up front */
+#define CSPT_POOL_PREALLOC  64
+/* free lists are not allowed to grow beyond this */
+#define CSPT_POOL_MAX       4096
+
 /**
  * Base class for event messages.
  */
@@ -154,6 +175,11 @@ class CsoundPerformanceThreadMessage {
  public:
     CsoundPerformanceThreadMessage *nxt;
     virtual int run() = 0;
+    /**
+     * Returns the free list this message is recycled through once it has
+     * been processed, or -1 if it is simply deleted.
+     */
+    virtual int32_t PoolIndex() { return -1; }
     CsoundPerformanceThreadMessage(CsoundPerformanceThread *pt)
     {
       pt_ = pt;
@@ -382,24 +408,50 @@ class CsPerfThreadMsg_ScoreEvent : public CsoundPerformanceThreadMessage {
     char    opcod;
     int32_t    absp2mode;
     int32_t     pcnt;
+    int32_t     psize;
     MYFLT   *pp;
     MYFLT   p[10];
  public:
+    CsPerfThreadMsg_ScoreEvent(CsoundPerformanceThread *pt)
+    : CsoundPerformanceThreadMessage(pt)
+    {
+      this->opcod = 'i';
+      this->absp2mode = 0;
+      this->pcnt = 0;
+      this->psize = 10;
+      this->pp = &(this->p[0]);
+    }
     CsPerfThreadMsg_ScoreEvent(CsoundPerformanceThread *pt,
                                int absp2mode, char opcod,
                                int pcnt, const MYFLT *p)
     : CsoundPerformanceThreadMessage(pt)
+    {
+      this->psize = 10;
+      this->pp = &(this->p[0]);
+      Set(absp2mode, opcod, pcnt, p);
+    }
+    /**
+     * (Re)initialises the event; the p-field buffer is only reallocated
+     * if it is too small, so recycled messages normally do not allocate.
+     */
+    void Set(int absp2mode, char opcod, int pcnt, const MYFLT *p)
     {
       this->opcod = opcod;
       this->absp2mode = absp2mode;
-      this->pcnt = pcnt;
-      if (pcnt <= 10)
-        this->pp = &(this->p[0]);
-      else
+      if (pcnt > psize) {
+        if (pp != &(this->p[0]))
+          delete[] pp;
         this->pp = new MYFLT[(unsigned int) pcnt];
+        this->psize = pcnt;
+      }
+      this->pcnt = pcnt;
       for (int i = 0; i < pcnt; i++)
         this->pp[i] = p[i];
     }
+    int32_t PoolIndex()
+    {
+      return CSPT_POOL_SCOREEVENT;
+    }
     int32_t run() {
       CSOUND  *csound = pt_->GetCsound();
       if (absp2mode && pcnt > 1) {
@@ -422,7 +474,7 @@ class CsPerfThreadMsg_ScoreEvent : public CsoundPerformanceThreadMessage {
     }
     ~CsPerfThreadMsg_ScoreEvent()
     {
-      if (pcnt > 10)
+      if (pp != &(this->p[0]))
         delete[] pp;
     }
 };
@@ -433,18 +485,33 @@ class CsPerfThreadMsg_ScoreEvent : public CsoundPerformanceThreadMessage {
 
 class CsPerfThreadMsg_InputMessage : public CsoundPerformanceThreadMessage {
  private:
-    int32_t len;
+    int32_t size;
     char    *sp;
     char    s[128];
  public:
+    CsPerfThreadMsg_InputMessage(CsoundPerformanceThread *pt)
+    : CsoundPerformanceThreadMessage(pt)
+    {
+      this->size = 128;
+      this->sp = &(this->s[0]);
+      this->sp[0] = '\0';
+    }
     CsPerfThreadMsg_InputMessage(CsoundPerformanceThread *pt, const char *s)
     : CsoundPerformanceThreadMessage(pt)
     {
-      len = (int32_t) strlen(s);
-      if (len < 128)
-        this->sp = &(this->s[0]);
-      else
+      this->size = 128;
+      this->sp = &(this->s[0]);
+      Set(s);
+    }
+    void Set(const char *s)
+    {
+      int32_t len = (int32_t) strlen(s);
+      if (len >= size) {
+        if (sp != &(this->s[0]))
+          delete[] sp;
         this->sp = new char[(unsigned int) (len + 1)];
+        this->size = len + 1;
+      }
       strcpy(this->sp, s);
     }
     int run()
@@ -452,9 +519,13 @@ class CsPerfThreadMsg_InputMessage : public CsoundPerformanceThreadMessage {
       csoundInputMessage(pt_->GetCsound(), sp);
       return 0;
     }
+    int32_t PoolIndex()
+    {
+      return CSPT_POOL_INPUTMESSAGE;
+    }
     ~CsPerfThreadMsg_InputMessage()
     {
-      if (len >= 128)
+      if (sp != &(this->s[0]))
         delete[] sp;
     }
 };
@@ -575,6 +646,135 @@ public:
 
 
 
+// ----------------------------------------------------------------------------
+
+/**
+ * Message queue shared by the control threads and the performance thread.
+ *
+ * Any number of threads may post to inbox; the performance thread posts
+ * the messages it has processed to done. Both are intrusive lock-free
+ * stacks linked through CsoundPerformanceThreadMessage::nxt, and each has
+ * a single consumer that always takes the whole list at once, so there is
+ * no ABA problem. Processed messages are deleted, or returned to the free
+ * lists, by the control threads the next time they post a message, so the
+ * performance thread never locks a mutex or calls the allocator to handle
+ * messages.
+ */
+
+struct CsPerfThreadQueue {
+    std::atomic<CsoundPerformanceThreadMessage*> inbox;
+    std::atomic<CsoundPerformanceThreadMessage*> done;
+    std::atomic<size_t>  queued;        // number of messages posted
+    std::atomic<size_t>  processed;     // number of messages retired
+    std::atomic<int32_t> flushWaiting;  // threads in FlushMessageQueue()
+    void    *poolLock;                  // protects the free lists
+    CsoundPerformanceThreadMessage *freeList[CSPT_POOL_COUNT];
+    int32_t freeCount[CSPT_POOL_COUNT];
+    CsPerfThreadQueue()
+    : inbox(NULL), done(NULL), queued(0), processed(0), flushWaiting(0)
+    {
+      poolLock = (void*) 0;
+      for (int i = 0; i < CSPT_POOL_COUNT; i++) {
+        freeList[i] = (CsoundPerformanceThreadMessage*) 0;
+        freeCount[i] = 0;
+      }
+    }
+};
+
+static inline void
+csPerfThreadPush(std::atomic<CsoundPerformanceThreadMessage*> &head,
+                 CsoundPerformanceThreadMessage *msg)
+{
+    CsoundPerformanceThreadMessage *old = head.load(std::memory_order_relaxed);
+    do {
+      msg->nxt = old;
+    } while (!head.compare_exchange_weak(old, msg,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed));
+}
+
+/* puts a processed message on its free list, or deletes it;
+   the caller holds poolLock */
+
+static void csPerfThreadPoolPut(CsPerfThreadQueue *q,
+                                CsoundPerformanceThreadMessage *msg)
+{
+    int32_t n = msg->PoolIndex();
+    if (n < 0 || q->freeCount[n] >= CSPT_POOL_MAX) {
+      delete msg;
+      return;
+    }
+    msg->nxt = q->freeList[n];
+    q->freeList[n] = msg;
+    q->freeCount[n]++;
+}
+
+static CsoundPerformanceThreadMessage *
+csPerfThreadPoolGet(CsPerfThreadQueue *q, int32_t n)
+{
+    CsoundPerformanceThreadMessage *msg;
+    if (!q)
+      return (CsoundPerformanceThreadMessage*) 0;
+    csoundLockMutex(q->poolLock);
+    msg = q->freeList[n];
+    if (msg) {
+      q->freeList[n] = msg->nxt;
+      q->freeCount[n]--;
+      msg->nxt = (CsoundPerformanceThreadMessage*) 0;
+    }
+    csoundUnlockMutex(q->poolLock);
+    return msg;
+}
+
+/**
+ * Removes all pending messages from the queue, and returns them
+ * in the order they were posted. Called by the performance thread.
+ */
+
+CsoundPerformanceThreadMessage *CsoundPerformanceThread::TakeMessages()
+{
+    CsoundPerformanceThreadMessage *msg, *prv = NULL;
+    msg = queue->inbox.exchange(NULL, std::memory_order_acquire);
+    // the inbox is a stack, reverse it to get the oldest message first
+    while (msg) {
+      CsoundPerformanceThreadMessage *nxt = msg->nxt;
+      msg->nxt = prv;
+      prv = msg;
+      msg = nxt;
+    }
+    return prv;
+}
+
+/**
+ * Hands a processed (or discarded) message back to the control threads.
+ */
+
+void CsoundPerformanceThread::RetireMessage(CsoundPerformanceThreadMessage *msg)
+{
+    csPerfThreadPush(queue->done, msg);
+    queue->processed.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * Deletes or recycles the messages retired by the performance thread.
+ * Never called from the performance thread.
+ */
+
+void CsoundPerformanceThread::ReclaimMessages()
+{
+    CsoundPerformanceThreadMessage *msg;
+    msg = queue->done.exchange(NULL, std::memory_order_acquire);
+    if (!msg)
+      return;
+    csoundLockMutex(queue->poolLock);
+    while (msg) {
+      CsoundPerformanceThreadMessage *nxt = msg->nxt;
+      csPerfThreadPoolPut(queue, msg);
+      msg = nxt;
+    }
+    csoundUnlockMutex(queue->poolLock);
+}
+
 // ----------------------------------------------------------------------------
 
 /**
@@ -587,76 +787,92 @@ int32_t CsoundPerformanceThread::Perform()
 {
     int retval = 0;
     do {
-      while (firstMessage) {
-        csoundLockMutex(queueLock);
-        do {
-          CsoundPerformanceThreadMessage *msg;
-          // get oldest message
-          msg = (CsoundPerformanceThreadMessage*) firstMessage;
-          if (!msg)
-            break;
-          // unlink from FIFO
-          firstMessage = msg->nxt;
-          if (!msg->nxt)
-            lastMessage = (CsoundPerformanceThreadMessage*) 0;
-          // process and destroy message
-          retval = msg->run();
-          // TODO: This should be moved out of the Perform function
-          delete msg; 
-        } while (!retval);
-        if (paused)
-          csoundWaitThreadLock(pauseLock, (size_t) 0);
-        // mark queue as empty
-        csoundNotifyThreadLock(flushLock);
-        csoundUnlockMutex(queueLock);
-        // if error or end of score, return now
-        if (retval)
-          goto endOfPerf;
-        // fprintf(stderr, "Error or end of score, returning now.");
-        // if paused, wait until a new message is received, then loop back
-        if (!paused)
-          break;
-        // VL: if this is paused, then it will double lock.
-        csoundWaitThreadLockNoTimeout(pauseLock);
-        csoundNotifyThreadLock(pauseLock);
+      retval = ProcessMessages();
+      // if paused, wait until a new message is received, then loop back;
+      // the lock is taken before looking at the queue again, so that
+      // the wake-up from a message posted in between is not lost
+      while (!retval && paused) {
+        csoundWaitThreadLock(pauseLock, (size_t) 0);
+        if (!HasMessages())
+          csoundWaitThreadLockNoTimeout(pauseLock);
+        retval = ProcessMessages();
       }
-      if(processcallback != NULL)
-           processcallback(cdata);
-      retval = csoundPerformKsmps(csound);
-      if (recordData.running) {
-          const MYFLT *spout = csoundGetSpout(csound);
-          int len = csoundGetKsmps(csound) * csoundGetNchnls(csound);
-          int written = csoundWriteCircularBuffer(NULL, recordData.cbuf,
-                                                  spout, len);
-          if (written != len) {
-              csoundMessage(csound,
-                            "perfThread record buffer overrun.\n");
-          }
-      }
-      csoundCondSignal(recordData.condvar);
-      // Needs to be outside the if
-      // for the case where stop record was requested
+      // if error or end of score, return now
+      if (retval)
+        break;
+      retval = PerformBlock();
     } while (!retval);
- endOfPerf:
+    EndPerformance(retval);
+    return retval;
+}
+
+/**
+ * Runs all pending messages, oldest first. Returns non-zero if
+ * performance should end.
+ */
+
+int32_t CsoundPerformanceThread::ProcessMessages()
+{
+    CsoundPerformanceThreadMessage *msg = TakeMessages();
+    int32_t retval = 0;
+    while (msg) {
+      CsoundPerformanceThreadMessage *nxt = msg->nxt;
+      // messages after a stop are discarded
+      if (!retval)
+        retval = msg->run();
+      RetireMessage(msg);
+      msg = nxt;
+    }
+    if (queue->flushWaiting.load(std::memory_order_acquire))
+      csoundNotifyThreadLock(flushLock);
+    return retval;
+}
+
+bool CsoundPerformanceThread::HasMessages()
+{
+    return queue->inbox.load(std::memory_order_acquire) != NULL;
+}
+
+/**
+ * Performs one k-cycle, and passes the output to the recorder.
+ */
+
+int32_t CsoundPerformanceThread::PerformBlock()
+{
+    int32_t retval;
+    if(processcallback != NULL)
+         processcallback(cdata);
+    retval = csoundPerformKsmps(csound);
+    if (recordData.running) {
+        const MYFLT *spout = csoundGetSpout(csound);
+        int len = csoundGetKsmps(csound) * csoundGetNchnls(csound);
+        int written = csoundWriteCircularBuffer(NULL, recordData.cbuf,
+                                                spout, len);
+        if (written != len) {
+            csoundMessage(csound,
+                          "perfThread record buffer overrun.\n");
+        }
+    }
+    csoundCondSignal(recordData.condvar);
+    // Needs to be outside the if
+    // for the case where stop record was requested
+    return retval;
+}
+
+void CsoundPerformanceThread::EndPerformance(int32_t retval)
+{
+    CsoundPerformanceThreadMessage *msg;
     status = retval;
     csoundCleanup(csound);
-    // delete any pending messages
-    csoundLockMutex(queueLock);
-    {
-      CsoundPerformanceThreadMessage *msg;
-      msg = (CsoundPerformanceThreadMessage*) firstMessage;
-      firstMessage = (CsoundPerformanceThreadMessage*) 0;
-      lastMessage = (CsoundPerformanceThreadMessage*) 0;
-      while (msg) {
-        CsoundPerformanceThreadMessage *nxt = msg->nxt;
-        delete msg;
-        msg = nxt;
-      }
+    // discard any pending messages, they are deleted by Join()
+    msg = TakeMessages();
+    while (msg) {
+      CsoundPerformanceThreadMessage *nxt = msg->nxt;
+      RetireMessage(msg);
+      msg = nxt;
     }
-    csoundNotifyThreadLock(flushLock);
-    csoundUnlockMutex(queueLock);
     running = 0;
-    return retval;
+    csoundNotifyThreadLock(flushLock);
 }
 
 class CsPerfThread_PerformScore {
@@ -688,12 +904,27 @@ extern "C" {
   }
 }
 
-void CsoundPerformanceThread::csPerfThread_constructor(CSOUND *csound_)
+void CsoundPerformanceThread::csPerfThread_createQueue()
+{
+    queue = new CsPerfThreadQueue();
+    queue->poolLock = csoundCreateMutex(0);
+    // playback is paused by default
+    csPerfThreadPush(queue->inbox, new CsPerfThreadMsg_Pause(this));
+    queue->queued.store(1);
+    for (int i = 0; i < CSPT_POOL_PREALLOC; i++) {
+      csPerfThreadPoolPut(queue, new CsPerfThreadMsg_ScoreEvent(this));
+      csPerfThreadPoolPut(queue, new CsPerfThreadMsg_InputMessage(this));
+    }
+}
+
+void CsoundPerformanceThread::csPerfThread_constructor(
+                                  CSOUND *csound_,
+                                  CsoundPerformanceThreadPool *pool_,
+                                  int32_t priority)
 {
     csound = csound_;
-    firstMessage = (CsoundPerformanceThreadMessage*) 0;
-    lastMessage = (CsoundPerformanceThreadMessage*) 0;
-    queueLock = (void*) 0;
+    pool = (CsoundPerformanceThreadPool*) 0;
+    queue = (CsPerfThreadQueue*) 0;
     pauseLock = (void*) 0;
     flushLock = (void*) 0;
     recordLock = (void *) 0;
@@ -703,9 +934,6 @@ void CsoundPerformanceThread::csPerfThread_constructor(CSOUND *csound_)
     cdata = 0;
     processcallback = 0;
     running = 0;
-    queueLock = csoundCreateMutex(0);
-    if (!queueLock)
-      return;
     pauseLock = csoundCreateThreadLock();
     if (!pauseLock)
       return;
@@ -716,16 +944,17 @@ void CsoundPerformanceThread::csPerfThread_constructor(CSOUND *csound_)
     if (!recordLock)
       return;
 #ifdef EMSCRIPTEN
-    lastMessage = new CsPerfThreadMsg_Pause(this);
+    csPerfThread_createQueue();
 #else
     try {
-      lastMessage = new CsPerfThreadMsg_Pause(this);
+      csPerfThread_createQueue();
     }
     catch (std::bad_alloc&) {
       return;
     }
 #endif
-    firstMessage = lastMessage;
+    if (!queue->poolLock)
+      return;
     recordData.cbuf = NULL;
     recordData.sfile = NULL;
     recordData.thread = NULL;
@@ -734,6 +963,13 @@ void CsoundPerformanceThread::csPerfThread_constructor(CSOUND *csound_)
         recordData.mutex = csoundCreateMutex (0);
         recordData.condvar = csoundCreateCondVar();
 
+    if (pool_) {
+      status = 0;
+      running = 1;
+      pool = pool_;
+      pool->Attach(this, priority);
+      return;
+    }
     perfThread = csoundCreateThread(csoundPerformanceThread_, (void*) this);
     if (perfThread) {
       status = 0;
@@ -767,6 +1003,14 @@ CsoundPerformanceThread::CsoundPerformanceThread(CSOUND *csound)
     csPerfThread_constructor(csound);
 }
 
+CsoundPerformanceThread::CsoundPerformanceThread(
+                             CSOUND *csound,
+                             CsoundPerformanceThreadPool *pool,
+                             int32_t priority)
+{
+    csPerfThread_constructor(csound, pool, priority);
+}
+
 CsoundPerformanceThread::CsoundPerformanceThread(Csound &csound)
 {
   csPerfThread_constructor(csound.GetCsound());
@@ -778,9 +1022,6 @@ CsoundPerformanceThread::~CsoundPerformanceThread()
     if (!status)
       this->Stop();     // FIXME: should handle memory errors here
     this->Join();
-    if (queueLock) {
-        csoundDestroyMutex(queueLock);
-    }
     if (pauseLock) {
         csoundDestroyMutex(pauseLock);
     }
@@ -802,22 +1043,19 @@ CsoundPerformanceThread::~CsoundPerformanceThread()
 
 void CsoundPerformanceThread::QueueMessage(CsoundPerformanceThreadMessage *msg)
 {
-    if (status) {
+    if (status || !queue) {
       delete msg;
       return;
     }
-    csoundLockMutex(queueLock);
-    // link message into FIFO
-    if (!lastMessage)
-      firstMessage = msg;
-    else
-      lastMessage->nxt = msg;
-    lastMessage = msg;
-    // mark queue as non-empty
-    csoundWaitThreadLock(flushLock, (size_t) 0);
+    // recycle whatever the performance thread has finished with
+    ReclaimMessages();
+    queue->queued.fetch_add(1, std::memory_order_relaxed);
+    csPerfThreadPush(queue->inbox, msg);
     // wake up from pause
-    csoundNotifyThreadLock(pauseLock);
-    csoundUnlockMutex(queueLock);
+    if (pool)
+      pool->Wake();
+    else
+      csoundNotifyThreadLock(pauseLock);
 }
 
 void CsoundPerformanceThread::Play()
@@ -856,13 +1094,24 @@ void CsoundPerformanceThread::StopRecord()
 void CsoundPerformanceThread::ScoreEvent(int absp2mode, char opcod,
                                          int pcnt, const MYFLT *p)
 {
-    QueueMessage(new CsPerfThreadMsg_ScoreEvent(this,
-                                                absp2mode, opcod, pcnt, p));
+    CsPerfThreadMsg_ScoreEvent *msg = (CsPerfThreadMsg_ScoreEvent*)
+      csPerfThreadPoolGet(queue, CSPT_POOL_SCOREEVENT);
+    if (msg)
+      msg->Set(absp2mode, opcod, pcnt, p);
+    else
+      msg = new CsPerfThreadMsg_ScoreEvent(this, absp2mode, opcod, pcnt, p);
+    QueueMessage(msg);
 }
 
 void CsoundPerformanceThread::InputMessage(const char *s)
 {
-    QueueMessage(new CsPerfThreadMsg_InputMessage(this, s));
+    CsPerfThreadMsg_InputMessage *msg = (CsPerfThreadMsg_InputMessage*)
+      csPerfThreadPoolGet(queue, CSPT_POOL_INPUTMESSAGE);
+    if (msg)
+      msg->Set(s);
+    else
+      msg = new CsPerfThreadMsg_InputMessage(this, s);
+    QueueMessage(msg);
 }
 
 void CsoundPerformanceThread::SetScoreOffsetSeconds(double timeVal)
@@ -900,24 +1149,37 @@ int32_t CsoundPerformanceThread::Join()
       retval = (int32_t) csoundJoinThread(perfThread);
       perfThread = (void*) 0;
     }
+    else if (pool) {
+      pool->Detach(this);
+      pool = (CsoundPerformanceThreadPool*) 0;
+      retval = status;
+    }
 
-    // delete any pending messages
-    {
+    // delete any pending messages, and the message pools
+    if (queue) {
       CsoundPerformanceThreadMessage *msg;
-      msg = (CsoundPerformanceThreadMessage*) firstMessage;
-      firstMessage = (CsoundPerformanceThreadMessage*) 0;
-      lastMessage = (CsoundPerformanceThreadMessage*) 0;
+      if (queue->poolLock)
+        ReclaimMessages();
+      msg = TakeMessages();
       while (msg) {
         CsoundPerformanceThreadMessage *nxt = msg->nxt;
         delete msg;
         msg = nxt;
       }
+      for (int i = 0; i < CSPT_POOL_COUNT; i++) {
+        msg = queue->freeList[i];
+        while (msg) {
+          CsoundPerformanceThreadMessage *nxt = msg->nxt;
+          delete msg;
+          msg = nxt;
+        }
+      }
+      if (queue->poolLock)
+        csoundDestroyMutex(queue->poolLock);
+      delete queue;
+      queue = (CsPerfThreadQueue*) 0;
     }
     // delete all thread locks
-    if (queueLock) {
-      csoundDestroyMutex(queueLock);
-      queueLock = (void*) 0;
-    }
     if (pauseLock) {
       csoundNotifyThreadLock(pauseLock);
       csoundDestroyThreadLock(pauseLock);
@@ -940,10 +1202,316 @@ int32_t CsoundPerformanceThread::Join()
 
 void CsoundPerformanceThread::FlushMessageQueue()
 {
-    if (firstMessage) {
-      csoundWaitThreadLockNoTimeout(flushLock);
-      csoundNotifyThreadLock(flushLock);
+    size_t  target;
+    if (!queue)
+      return;
+    target = queue->queued.load(std::memory_order_relaxed);
+    queue->flushWaiting.fetch_add(1, std::memory_order_acq_rel);
+    while (running &&
+           (std::ptrdiff_t) (queue->processed.load(std::memory_order_acquire)
+                             - target) < 0) {
+      // the timeout only matters if several threads are flushing at once
+      csoundWaitThreadLock(flushLock, (size_t) 100);
+    }
+    queue->flushWaiting.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+
+// ----------------------------------------------------------------------------
+
+/**
+ * Scheduling state of one performance run by a pool.
+ */
+
+struct CsPerfThreadPoolEntry {
+    CsoundPerformanceThread *pt;
+    int32_t priority;
+    double  period;     // duration of one k-cycle in seconds
+    double  deadline;   // time at which the next k-cycle should be done
+    bool    busy;       // a worker is running this instance
+    bool    idle;       // paused, deadline restarts when it resumes
+    bool    finished;   // performance has ended
+};
+
+struct CsPerfThreadPoolData {
+    std::vector<CsPerfThreadPoolEntry*> entries;
+    std::vector<void*> threads;
+    void    *mutex;     // protects everything below and the entries
+    void    *cond;      // signalled when an instance may become ready
+    bool    realtime;
+    bool    stopping;
+    // statistics
+    double  statsStart;
+    double  busyTime;
+    double  blocks;
+    double  missedDeadlines;
+    double  maxLateness;
+};
+
+static double csPerfThreadPoolTime()
+{
+    return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class CsPerfThreadPool_Worker {
+ private:
+    CsoundPerformanceThreadPool *pool;
+ public:
+    void Run()
+    {
+      pool->Worker();
+    }
+    CsPerfThreadPool_Worker(void *p)
+    {
+      pool = (CsoundPerformanceThreadPool*) p;
+    }
+};
+
+extern "C" {
+  static uintptr_t csoundPerformanceThreadPoolWorker_(void *userData)
+  {
+    CsPerfThreadPool_Worker w(userData);
+    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+    w.Run();
+    return 0;
+  }
+}
+
+CsoundPerformanceThreadPool::CsoundPerformanceThreadPool(int32_t numThreads,
+                                                         bool realtime)
+{
+    data = new CsPerfThreadPoolData();
+    data->mutex = csoundCreateMutex(0);
+    data->cond = csoundCreateCondVar();
+    data->realtime = realtime;
+    data->stopping = false;
+    data->statsStart = csPerfThreadPoolTime();
+    data->busyTime = data->blocks = 0.0;
+    data->missedDeadlines = data->maxLateness = 0.0;
+    if (numThreads < 1)
+      numThreads = 1;
+    for (int32_t i = 0; i < numThreads; i++) {
+      void *thread = csoundCreateThread(csoundPerformanceThreadPoolWorker_,
+                                        (void*) this);
+      if (thread)
+        data->threads.push_back(thread);
+    }
+}
+
+CsoundPerformanceThreadPool::~CsoundPerformanceThreadPool()
+{
+    csoundLockMutex(data->mutex);
+    data->stopping = true;
+    for (size_t i = 0; i < data->threads.size(); i++)
+      csoundCondSignal(data->cond);
+    csoundUnlockMutex(data->mutex);
+    for (size_t i = 0; i < data->threads.size(); i++)
+      csoundJoinThread(data->threads[i]);
+    // performances that were not joined are stopped here
+    for (size_t i = 0; i < data->entries.size(); i++) {
+      CsPerfThreadPoolEntry *e = data->entries[i];
+      if (!e->finished)
+        e->pt->EndPerformance(1);
+      e->pt->pool = (CsoundPerformanceThreadPool*) 0;
+      delete e;
+    }
+    csoundDestroyCondVar(data->cond);
+    csoundDestroyMutex(data->mutex);
+    delete data;
+}
+
+void CsoundPerformanceThreadPool::Attach(CsoundPerformanceThread *pt,
+                                         int32_t priority)
+{
+    CsPerfThreadPoolEntry *e = new CsPerfThreadPoolEntry();
+    CSOUND  *csound = pt->GetCsound();
+    e->pt = pt;
+    e->priority = priority;
+    e->period = (double) csoundGetKsmps(csound) / (double) csoundGetSr(csound);
+    e->deadline = 0.0;
+    e->busy = false;
+    e->idle = true;
+    e->finished = false;
+    csoundLockMutex(data->mutex);
+    data->entries.push_back(e);
+    csoundCondSignal(data->cond);
+    csoundUnlockMutex(data->mutex);
+}
+
+/**
+ * Waits until the performance has ended and removes it from the pool.
+ */
+
+void CsoundPerformanceThreadPool::Detach(CsoundPerformanceThread *pt)
+{
+    csoundLockMutex(data->mutex);
+    for (size_t i = 0; i < data->entries.size(); i++) {
+      CsPerfThreadPoolEntry *e = data->entries[i];
+      if (e->pt != pt)
+        continue;
+      while (e->busy || !e->finished) {
+        csoundUnlockMutex(data->mutex);
+        // notified by EndPerformance(), the timeout covers the time
+        // until the worker has let go of the instance
+        csoundWaitThreadLock(pt->flushLock, (size_t) 10);
+        csoundLockMutex(data->mutex);
+      }
+      data->entries.erase(data->entries.begin() + i);
+      delete e;
+      break;
+    }
+    csoundUnlockMutex(data->mutex);
+}
+
+void CsoundPerformanceThreadPool::Wake()
+{
+    csoundLockMutex(data->mutex);
+    csoundCondSignal(data->cond);
+    csoundUnlockMutex(data->mutex);
+}
+
+void CsoundPerformanceThreadPool::Worker()
+{
+    csoundLockMutex(data->mutex);
+    while (!data->stopping) {
+      CsPerfThreadPoolEntry *e = (CsPerfThreadPoolEntry*) 0;
+      double  now = csPerfThreadPoolTime();
+      double  wakeAt = 0.0, earliest = 0.0;
+      // when not paced, an instance that resumes joins the others at the
+      // earliest pending deadline, so that it neither starves nor
+      // monopolises the workers
+      if (!data->realtime) {
+        for (size_t i = 0; i < data->entries.size(); i++) {
+          CsPerfThreadPoolEntry *x = data->entries[i];
+          if (!x->idle && !x->finished &&
+              (earliest == 0.0 || x->deadline < earliest))
+            earliest = x->deadline;
+        }
+      }
+      // pick the ready instance with the highest priority,
+      // then the earliest deadline
+      for (size_t i = 0; i < data->entries.size(); i++) {
+        CsPerfThreadPoolEntry *x = data->entries[i];
+        if (x->busy || x->finished)
+          continue;
+        if (x->pt->paused) {
+          // paused instances only need their messages run, which is
+          // cheap, so they go first regardless of priority
+          if (x->pt->HasMessages()) {
+            e = x;
+            break;
+          }
+          x->idle = true;
+          continue;
+        }
+        if (x->idle) {
+          x->deadline = (earliest > 0.0 ? earliest : now + x->period);
+          x->idle = false;
+        }
+        if (data->realtime && x->deadline - x->period > now) {
+          if (wakeAt == 0.0 || x->deadline - x->period < wakeAt)
+            wakeAt = x->deadline - x->period;
+          continue;
+        }
+        if (!e || x->priority > e->priority ||
+            (x->priority == e->priority && x->deadline < e->deadline))
+          e = x;
+      }
+      if (!e) {
+        // a paced wait still ends early on Wake(), Attach() or Stop()
+        if (wakeAt > 0.0)
+          csoundCondWaitTimeout(data->cond, data->mutex,
+                                (size_t) ((wakeAt - now) * 1e6) + 1);
+        else
+          csoundCondWait(data->cond, data->mutex);
+        continue;
+      }
+      e->busy = true;
+      csoundUnlockMutex(data->mutex);
+      {
+        CsoundPerformanceThread *pt = e->pt;
+        int32_t retval = pt->ProcessMessages();
+        bool    performed = false;
+        if (!retval && !pt->paused) {
+          retval = pt->PerformBlock();
+          performed = true;
+        }
+        if (retval)
+          pt->EndPerformance(retval);
+        double  end = csPerfThreadPoolTime();
+        csoundLockMutex(data->mutex);
+        data->busyTime += end - now;
+        if (performed) {
+          // resumed by the messages that were just run
+          if (e->idle) {
+            e->deadline = (earliest > 0.0 ? earliest : now + e->period);
+            e->idle = false;
+          }
+          data->blocks += 1.0;
+          if (data->realtime && end > e->deadline) {
+            data->missedDeadlines += 1.0;
+            if (end - e->deadline > data->maxLateness)
+              data->maxLateness = end - e->deadline;
+          }
+          e->deadline += e->period;
+        }
+        e->busy = false;
+        if (retval)
+          e->finished = true;
+      }
+    }
+    csoundUnlockMutex(data->mutex);
+}
+
+int32_t CsoundPerformanceThreadPool::GetNumThreads()
+{
+    return (int32_t) data->threads.size();
+}
+
+int32_t CsoundPerformanceThreadPool::GetNumInstances()
+{
+    int32_t n;
+    csoundLockMutex(data->mutex);
+    n = (int32_t) data->entries.size();
+    csoundUnlockMutex(data->mutex);
+    return n;
+}
+
+void CsoundPerformanceThreadPool::SetPriority(CsoundPerformanceThread *pt,
+                                              int32_t priority)
+{
+    csoundLockMutex(data->mutex);
+    for (size_t i = 0; i < data->entries.size(); i++) {
+      if (data->entries[i]->pt == pt)
+        data->entries[i]->priority = priority;
     }
+    csoundUnlockMutex(data->mutex);
+}
+
+void CsoundPerformanceThreadPool::GetStatistics(
+                                      CS_PERF_THREAD_POOL_STATS *stats)
+{
+    double  elapsed;
+    csoundLockMutex(data->mutex);
+    elapsed = csPerfThreadPoolTime() - data->statsStart;
+    stats->numThreads = (int32_t) data->threads.size();
+    stats->numInstances = (int32_t) data->entries.size();
+    stats->blocks = data->blocks;
+    stats->missedDeadlines = data->missedDeadlines;
+    stats->maxLateness = data->maxLateness;
+    stats->load = (elapsed > 0.0 && stats->numThreads > 0 ?
+                   data->busyTime / (elapsed * stats->numThreads) : 0.0);
+    csoundUnlockMutex(data->mutex);
+}
+
+void CsoundPerformanceThreadPool::ResetStatistics()
+{
+    csoundLockMutex(data->mutex);
+    data->statsStart = csPerfThreadPoolTime();
+    data->busyTime = data->blocks = 0.0;
+    data->missedDeadlines = data->maxLateness = 0.0;
+    csoundUnlockMutex(data->mutex);
 }
 
 
@@ -1085,5 +1653,50 @@ PUBLIC void csoundPerformanceThreadRequestCallback(Cpt pt, void (*func)(void *pt
   cpt->RequestCallback(func2);
 }
 
+typedef void* Cptp;
+
+PUBLIC Cptp csoundCreatePerformanceThreadPool(int32_t numThreads,
+                                              int32_t realtime)
+{
+  CsoundPerformanceThreadPool *pool =
+    new CsoundPerformanceThreadPool(numThreads, realtime != 0);
+  return (void *)pool;
+}
+
+PUBLIC void csoundDestroyPerformanceThreadPool(Cptp pool)
+{
+  CsoundPerformanceThreadPool *cptp = (CsoundPerformanceThreadPool *)pool;
+  delete cptp;
+}
+
+PUBLIC Cpt csoundCreatePooledPerformanceThread(CSOUND *csound, Cptp pool,
+                                               int32_t priority)
+{
+  CsoundPerformanceThreadPool *cptp = (CsoundPerformanceThreadPool *)pool;
+  CsoundPerformanceThread *pt =
+    new CsoundPerformanceThread(csound, cptp, priority);
+  return (void *)pt;
+}
+
+PUBLIC void csoundPerformanceThreadPoolSetPriority(Cptp pool, Cpt pt,
+                                                   int32_t priority)
+{
+  CsoundPerformanceThreadPool *cptp = (CsoundPerformanceThreadPool *)pool;
+  cptp->SetPriority((CsoundPerformanceThread *)pt, priority);
+}
+
+PUBLIC void csoundPerformanceThreadPoolGetStats(Cptp pool,
+                                                CS_PERF_THREAD_POOL_STATS *stats)
+{
+  CsoundPerformanceThreadPool *cptp = (CsoundPerformanceThreadPool *)pool;
+  cptp->GetStatistics(stats);
+}
+
+PUBLIC void csoundPerformanceThreadPoolResetStats(Cptp pool)
+{
+  CsoundPerformanceThreadPool *cptp = (CsoundPerformanceThreadPool *)pool;
+  cptp->ResetStatistics();
+}
+
 } // extern "C"
 
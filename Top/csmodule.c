@@ -81,6 +81,13 @@
 #include "csoundCore.h"
 #include "csmodule.h"
 
+#if defined(WIN32)
+#include <process.h>
+#define getpid _getpid
+#elif !defined(__wasi__)
+#include <unistd.h>
+#endif
+
 #if defined(__MACH__)
 #include <TargetConditionals.h>
 #if (TARGET_OS_IPHONE == 0) && (TARGET_IPHONE_SIMULATOR == 0)
@@ -192,6 +199,7 @@ typedef struct csoundModule_s {
     pluginLibFunc_t   p;                  /* generic plugin interface      */
     opcodeLibFunc_t   o;                  /* opcode library interface      */
   } fn;
+  void        *manifest;                  /* manifest entry to fill in     */
   char        name[1];                    /* name of the module            */
 } csoundModule_t;
 
@@ -236,6 +244,11 @@ int32_t csoundCloseLibrary(void *library);
 void *csoundGetLibrarySymbol(void *library, const char *symbolName);
 
 
+#ifndef __wasi__
+static void manifest_record(CSOUND *csound, void *p,
+                            const OENTRY *ep, int32_t cnt);
+#endif
+
 /**
  * Initialise a single module.
  * Return value is CSOUND_SUCCESS if there was no error.
@@ -274,6 +287,12 @@ static CS_NOINLINE int32_t csoundInitModule(CSOUND *csound, csoundModule_t *m)
                                            (int32_t) length) != 0))
             return CSOUND_ERROR;
         }
+#ifndef __wasi__
+        if (m->manifest != NULL) {
+          manifest_record(csound, m->manifest, opcodlst_n, (int32_t) length);
+          m->manifest = NULL;
+        }
+#endif
       }
     }
   }
@@ -371,6 +390,14 @@ int32_t csoundLoadAndInitModules(CSOUND *csound, const char *opdir) {
   return 0;
 }
 
+int32_t csoundLoadDeferredOpcodes(CSOUND *csound, const char *opname) {
+  return 0;
+}
+
+int32_t csoundLoadAllDeferredOpcodes(CSOUND *csound) {
+  return 0;
+}
+
 #else /* __wasi__ */
 
 
@@ -544,6 +571,324 @@ static int32_t csoundCheckOpcodeDeny(CSOUND * csound, const char *fname)
 }
 
 
+/*
+ * Opcode manifest cache.
+ *
+ * If CS_PLUGIN_MANIFEST names a file, csoundLoadModules() keeps a list
+ * in it of the plugin libraries it has seen. Each entry has the size
+ * and mtime of the library and, for opcode-only libraries
+ * (csound_opcode_init, no fgens, no csoundModuleCreate), the names of
+ * the opcodes it provides. A listed library that has not changed is not
+ * opened at startup. Its opcode names are registered as deferred, and
+ * the library is loaded when the compiler first looks one of them up.
+ * Other libraries are loaded as before. New or changed libraries are
+ * loaded now and recorded, and the file is rewritten after
+ * csoundInitModules().
+ *
+ * File format, one item per line:
+ *   csound-plugin-manifest <format> <version>.<subversion> <sizeof(MYFLT)>
+ *   lib <lazy> <mtime> <size> <count> <path>
+ *   <opcode name>                      (count lines)
+ */
+
+#define MANIFEST_FORMAT 1
+#define MANIFEST_VARNAME "::PLUGIN_MANIFEST::"
+
+typedef struct manifestLib_s {
+  struct manifestLib_s *nxt;
+  int64_t     mtime, size;
+  int32_t     lazy;                       /* opcode names are complete     */
+  int32_t     seen;                       /* still in the search path      */
+  int32_t     loaded;
+  int32_t     count;                      /* number of opcode names        */
+  char        **names;
+  char        path[1];
+} manifestLib_t;
+
+typedef struct pluginManifest_s {
+  char          *file;
+  manifestLib_t *libs;
+  CS_HASH_TABLE *deferred;    /* opcode name -> cons list of libraries */
+  int32_t       dirty;
+} pluginManifest_t;
+
+static pluginManifest_t *manifest_get(CSOUND *csound)
+{
+  pluginManifest_t **pp = (pluginManifest_t **)
+    csound->QueryGlobalVariableNoCheck(csound, MANIFEST_VARNAME);
+  return pp != NULL ? *pp : NULL;
+}
+
+static manifestLib_t *manifest_find(pluginManifest_t *mf, const char *path)
+{
+  manifestLib_t *lib;
+  for (lib = mf->libs; lib != NULL; lib = lib->nxt)
+    if (lib->mtime >= 0 && strcmp(lib->path, path) == 0)
+      return lib;
+  return NULL;
+}
+
+static manifestLib_t *manifest_add(CSOUND *csound, pluginManifest_t *mf,
+                                   const char *path, int64_t mtime,
+                                   int64_t size)
+{
+  manifestLib_t *lib = (manifestLib_t *)
+    csound->Calloc(csound, sizeof(manifestLib_t) + strlen(path));
+  strcpy(lib->path, path);
+  lib->mtime = mtime;
+  lib->size = size;
+  lib->nxt = mf->libs;
+  mf->libs = lib;
+  return lib;
+}
+
+/* returns 0 if there is no usable manifest, which must then be written */
+static int32_t manifest_read(CSOUND *csound, pluginManifest_t *mf)
+{
+  char    line[1024];
+  FILE    *f = fopen(mf->file, "r");
+  manifestLib_t *lib = NULL;
+  int32_t fmt, ver, subver, fltsize, n = 0;
+
+  if (f == NULL)
+    return 0;
+  if (fgets(line, sizeof(line), f) == NULL ||
+      sscanf(line, "csound-plugin-manifest %d %d.%d %d",
+             &fmt, &ver, &subver, &fltsize) != 4 ||
+      fmt != MANIFEST_FORMAT || ver != CS_VERSION || subver != CS_SUBVER ||
+      fltsize != (int32_t) sizeof(MYFLT)) {
+    fclose(f);
+    return 0;
+  }
+  while (fgets(line, sizeof(line), f) != NULL) {
+    size_t  len = strlen(line);
+    if (len > 0 && line[len - 1] == '\n')
+      line[--len] = '\0';
+    if (lib != NULL && n < lib->count) {
+      lib->names[n++] = cs_strdup(csound, line);
+      continue;
+    }
+    {
+      long long mtime, size;
+      int32_t   lazy, count, pos = 0;
+      if (sscanf(line, "lib %d %lld %lld %d %n",
+                 &lazy, &mtime, &size, &count, &pos) < 4 || pos == 0 ||
+          count < 0) {
+        lib = NULL;               /* damaged file: keep what was read */
+        break;
+      }
+      lib = manifest_add(csound, mf, line + pos, (int64_t) mtime,
+                         (int64_t) size);
+      lib->lazy = lazy;
+      lib->count = count;
+      lib->names = (char **) csound->Calloc(csound,
+                                            sizeof(char *) * (count + 1));
+      n = 0;
+    }
+  }
+  /* a truncated entry cannot be trusted */
+  if (lib != NULL && n < lib->count)
+    lib->mtime = -1;
+  fclose(f);
+  return 1;
+}
+
+static void manifest_write(CSOUND *csound, pluginManifest_t *mf)
+{
+  char    tmp[1024];
+  FILE    *f;
+  manifestLib_t *lib;
+  int32_t i;
+
+  /* write a private file and rename it, as other engines may read it; */
+  /* the name holds the pid, as engines in other processes may write it */
+#if defined(__wasi__)
+  snprintf(tmp, sizeof(tmp), "%s.%p.tmp", mf->file, (void *) csound);
+#else
+  snprintf(tmp, sizeof(tmp), "%s.%d.%p.tmp", mf->file, (int32_t) getpid(),
+           (void *) csound);
+#endif
+  if ((f = fopen(tmp, "w")) == NULL) {
+    csound->Warning(csound, Str("could not write plugin manifest '%s'"),
+                    mf->file);
+    return;
+  }
+  fprintf(f, "csound-plugin-manifest %d %d.%d %d\n", MANIFEST_FORMAT,
+          CS_VERSION, CS_SUBVER, (int32_t) sizeof(MYFLT));
+  for (lib = mf->libs; lib != NULL; lib = lib->nxt) {
+    if (!lib->seen || lib->mtime < 0)
+      continue;
+    fprintf(f, "lib %d %lld %lld %d %s\n", lib->lazy, (long long) lib->mtime,
+            (long long) lib->size, lib->count, lib->path);
+    for (i = 0; i < lib->count; i++)
+      fprintf(f, "%s\n", lib->names[i]);
+  }
+  fclose(f);
+#ifdef WIN32
+  remove(mf->file);
+#endif
+  if (rename(tmp, mf->file) != 0)
+    remove(tmp);
+  mf->dirty = 0;
+}
+
+/* called from csoundInitModule() with the opcodes a library registered */
+static void manifest_record(CSOUND *csound, void *p,
+                            const OENTRY *ep, int32_t cnt)
+{
+  manifestLib_t *lib = (manifestLib_t *) p;
+  int32_t i, j, n = 0;
+
+  lib->names = (char **) csound->Calloc(csound, sizeof(char *) * (cnt + 1));
+  for (i = 0; i < cnt; i++) {
+    char    *name;
+    size_t  len;
+    if (ep[i].opname == NULL)
+      continue;
+    len = strcspn(ep[i].opname, ".");
+    for (j = 0; j < n; j++)
+      if (strncmp(lib->names[j], ep[i].opname, len) == 0 &&
+          lib->names[j][len] == '\0')
+        break;
+    if (j < n)
+      continue;
+    name = (char *) csound->Malloc(csound, len + 1);
+    memcpy(name, ep[i].opname, len);
+    name[len] = '\0';
+    lib->names[n++] = name;
+  }
+  lib->count = n;
+  lib->lazy = 1;
+}
+
+static void manifest_defer(CSOUND *csound, pluginManifest_t *mf,
+                           manifestLib_t *lib)
+{
+  int32_t i;
+  for (i = 0; i < lib->count; i++) {
+    CONS_CELL *libs = (CONS_CELL *)
+      cs_hash_table_get(csound, mf->deferred, lib->names[i]);
+    cs_hash_table_put(csound, mf->deferred, lib->names[i],
+                      cs_cons(csound, lib, libs));
+  }
+}
+
+/* load, or defer, one library found in the plugin search path */
+static int32_t manifest_load(CSOUND *csound, pluginManifest_t *mf,
+                             const char *path)
+{
+  struct stat     st;
+  manifestLib_t   *lib;
+  csoundModule_t  *m;
+  int32_t         err;
+
+  if (stat(path, &st) != 0)
+    return csoundLoadExternal(csound, path);
+  lib = manifest_find(mf, path);
+  if (lib != NULL && lib->mtime == (int64_t) st.st_mtime &&
+      lib->size == (int64_t) st.st_size) {
+    lib->seen = 1;
+    if (lib->lazy) {
+      manifest_defer(csound, mf, lib);
+      return CSOUND_SUCCESS;
+    }
+    return csoundLoadExternal(csound, path);
+  }
+  /* new or changed: load it now, and find out what it provides */
+  if (lib != NULL)
+    lib->mtime = -1;
+  m = (csoundModule_t *) csound->csmodule_db;
+  err = csoundLoadExternal(csound, path);
+  if (err == CSOUND_SUCCESS && csound->csmodule_db != (void *) m) {
+    m = (csoundModule_t *) csound->csmodule_db;
+    lib = manifest_add(csound, mf, path, (int64_t) st.st_mtime,
+                       (int64_t) st.st_size);
+    lib->seen = lib->loaded = 1;
+    /* only pure opcode libraries can wait until they are needed */
+    if (m->PreInitFunc == NULL && m->fn.o.fgen_init == NULL)
+      m->manifest = (void *) lib;
+    mf->dirty = 1;
+  }
+  return err;
+}
+
+static pluginManifest_t *manifest_open(CSOUND *csound)
+{
+  pluginManifest_t **pp, *mf;
+  const char *file = csoundGetEnv(csound, "CS_PLUGIN_MANIFEST");
+
+  if (file == NULL || file[0] == '\0')
+    return NULL;
+  if (csound->CreateGlobalVariable(csound, MANIFEST_VARNAME,
+                                   sizeof(pluginManifest_t *)) != 0)
+    return manifest_get(csound);
+  pp = (pluginManifest_t **)
+    csound->QueryGlobalVariableNoCheck(csound, MANIFEST_VARNAME);
+  mf = *pp = (pluginManifest_t *)
+    csound->Calloc(csound, sizeof(pluginManifest_t));
+  mf->file = cs_strdup(csound, (char *) file);
+  mf->deferred = cs_hash_table_create(csound);
+  /* a missing or out of date file is replaced at once, even if there
+     are no plugin libraries to record */
+  if (!manifest_read(csound, mf))
+    mf->dirty = 1;
+  return mf;
+}
+
+/**
+ * Load the plugin libraries deferred by the manifest that provide an
+ * opcode called 'opname' (without any '.' suffix). Returns the number
+ * of libraries loaded.
+ */
+int32_t csoundLoadDeferredOpcodes(CSOUND *csound, const char *opname)
+{
+  pluginManifest_t *mf = manifest_get(csound);
+  CONS_CELL *libs, *cell;
+  int32_t   cnt = 0;
+
+  if (mf == NULL || opname == NULL)
+    return 0;
+  libs = (CONS_CELL *)
+    cs_hash_table_get(csound, mf->deferred, (char *) opname);
+  if (libs == NULL)
+    return 0;
+  cs_hash_table_remove(csound, mf->deferred, (char *) opname);
+  for (cell = libs; cell != NULL; cell = cell->next) {
+    manifestLib_t *lib = (manifestLib_t *) cell->value;
+    if (lib->loaded)
+      continue;
+    lib->loaded = 1;
+    if (UNLIKELY(csound->oparms->odebug))
+      csound->Message(csound, Str("Loading '%s' for opcode '%s'\n"),
+                    lib->path, opname);
+    if (csoundLoadAndInitModule(csound, lib->path) == CSOUND_SUCCESS)
+      cnt++;
+  }
+  cs_cons_free(csound, libs);
+  return cnt;
+}
+
+/**
+ * Load every library deferred by the manifest, e.g. to list all opcodes.
+ */
+int32_t csoundLoadAllDeferredOpcodes(CSOUND *csound)
+{
+  pluginManifest_t *mf = manifest_get(csound);
+  manifestLib_t *lib;
+  int32_t cnt = 0;
+
+  if (mf == NULL)
+    return 0;
+  for (lib = mf->libs; lib != NULL; lib = lib->nxt) {
+    if (lib->seen && lib->lazy && !lib->loaded && lib->mtime >= 0) {
+      lib->loaded = 1;
+      if (csoundLoadAndInitModule(csound, lib->path) == CSOUND_SUCCESS)
+        cnt++;
+    }
+  }
+  return cnt;
+}
+
 static int32_t _dir_exists(char *path) {
   // returns 1 if path is a directory and it exists
   struct stat s;
@@ -580,9 +925,11 @@ int32_t csoundLoadModules(CSOUND *csound)
 #ifdef __HAIKU__
   int32_t dfltdir = 0;
 #endif
+  pluginManifest_t *manifest;
 
   if (UNLIKELY(csound->csmodule_db != NULL))
     return CSOUND_ERROR;
+  manifest = manifest_open(csound);
 
   /* open plugin directory */
   dname = csoundGetEnv(csound, (sizeof(MYFLT) == sizeof(float) ?
@@ -733,7 +1080,10 @@ int32_t csoundLoadModules(CSOUND *csound)
       if (UNLIKELY(csound->oparms->odebug)) {
         csoundMessage(csound, Str("Loading '%s'\n"), buf);
       }
-      n = csoundLoadExternal(csound, buf);
+      if (manifest != NULL)
+        n = manifest_load(csound, manifest, buf);
+      else
+        n = csoundLoadExternal(csound, buf);
       if (UNLIKELY(UNLIKELY(n == CSOUND_ERROR)))
         continue;               /* ignore non-plugin files */
       if (UNLIKELY(n < err))
@@ -807,6 +1157,7 @@ int32_t csoundLoadExternals(CSOUND *csound)
 int32_t csoundInitModules(CSOUND *csound)
 {
   csoundModule_t  *m;
+  pluginManifest_t *mf;
   int32_t             i, retval = CSOUND_SUCCESS;
   /* call init functions */
   for (m = (csoundModule_t*) csound->csmodule_db; m != NULL; m = m->nxt) {
@@ -814,6 +1165,9 @@ int32_t csoundInitModules(CSOUND *csound)
     if (UNLIKELY(i != CSOUND_SUCCESS && i < retval))
       retval = i;
   }
+  /* now that new libraries have listed their opcodes */
+  if ((mf = manifest_get(csound)) != NULL && mf->dirty)
+    manifest_write(csound, mf);
   /* return with error code */
   return retval;
 }
@@ -1262,59 +1616,74 @@ NGFENS *farey_fgens_init(CSOUND *);
 NGFENS *padsyn_fgen_init(CSOUND *);
 NGFENS *mp3in_fgen_init(CSOUND *);
 
-CS_NOINLINE int32_t csoundInitStaticModules(CSOUND *csound)
-{
-  int32_t     i;
-  int32_t length;
-  OENTRY  *opcodlst_n;
-  const INITFN staticmodules[] = {
+/* statically linked opcode libraries, in load order */
+static const INITFN staticmodules[] = {
 #if defined(LINUX)
-    cpumeter_localops_init,
+  cpumeter_localops_init,
 #endif
 #if !(defined(__wasi__))
-    counter_localops_init,
-    system_localops_init,
+  counter_localops_init,
+  system_localops_init,
 #ifndef NO_SERIAL_OPCODES
-    serial_localops_init,
+  serial_localops_init,
 #endif
 #ifdef HAVE_SOCKETS
-    sockrecv_localops_init,
-    socksend_localops_init,
+  sockrecv_localops_init,
+  socksend_localops_init,
 #endif
 #endif  // !wasi
 #if defined(LINUX) || defined(__MACH__)
-    control_localops_init, urandom_localops_init,
+  control_localops_init, urandom_localops_init,
 #endif
-    scnoise_localops_init, afilts_localops_init,
-    mp3in_localops_init, hrtferX_localops_init,
-    hrtfearly_localops_init, hrtfreverb_localops_init,
-    bformdec2_localops_init, babo_localops_init,
-    bilbar_localops_init, vosim_localops_init,
-    compress_localops_init,  pinker_localops_init,
-    squinewave_localops_init,  eqfil_localops_init,
-    hrtfopcodes_localops_init, lufs_localops_init,
-    sterrain_localops_init,date_localops_init,
-    liveconv_localops_init, gamma_localops_init,
-    wpfilters_localops_init, gendy_localops_init,
-    phisem_localops_init, physmod_localops_init,
-    framebuffer_localops_init, cell_localops_init,
-    exciter_localops_init, buchla_localops_init,
-    select_localops_init, platerev_localops_init,
-    sequencer_localops_init,grain4_localops_init,
-    loscilx_localops_init, pan2_localops_init,
-    minmax_localops_init, vaops_localops_init,
-    ugakbari_localops_init, harmon_localops_init,
-    pitchtrack_localops_init, partikkel_localops_init,
-    shape_localops_init, tabsum_localops_init,
-    crossfm_localops_init, pvlock_localops_init,
-    fareyseq_localops_init,  paulstretch_localops_init,
-    tabaudio_localops_init,  scoreline_localops_init,
-    modmatrix_localops_init, ambicode1_localops_init,
-    arrayvars_localops_init, zak_localops_init,
-    scugens_localops_init, emugens_localops_init,
-    pvoc_localops_init, spectra_localops_init,
-    vbap_localops_init,
-    NULL };
+  scnoise_localops_init, afilts_localops_init,
+  mp3in_localops_init, hrtferX_localops_init,
+  hrtfearly_localops_init, hrtfreverb_localops_init,
+  bformdec2_localops_init, babo_localops_init,
+  bilbar_localops_init, vosim_localops_init,
+  compress_localops_init,  pinker_localops_init,
+  squinewave_localops_init,  eqfil_localops_init,
+  hrtfopcodes_localops_init, lufs_localops_init,
+  sterrain_localops_init,date_localops_init,
+  liveconv_localops_init, gamma_localops_init,
+  wpfilters_localops_init, gendy_localops_init,
+  phisem_localops_init, physmod_localops_init,
+  framebuffer_localops_init, cell_localops_init,
+  exciter_localops_init, buchla_localops_init,
+  select_localops_init, platerev_localops_init,
+  sequencer_localops_init,grain4_localops_init,
+  loscilx_localops_init, pan2_localops_init,
+  minmax_localops_init, vaops_localops_init,
+  ugakbari_localops_init, harmon_localops_init,
+  pitchtrack_localops_init, partikkel_localops_init,
+  shape_localops_init, tabsum_localops_init,
+  crossfm_localops_init, pvlock_localops_init,
+  fareyseq_localops_init,  paulstretch_localops_init,
+  tabaudio_localops_init,  scoreline_localops_init,
+  modmatrix_localops_init, ambicode1_localops_init,
+  arrayvars_localops_init, zak_localops_init,
+  scugens_localops_init, emugens_localops_init,
+  pvoc_localops_init, spectra_localops_init,
+  vbap_localops_init,
+  NULL };
+
+/**
+ * Get the OENTRY list of the i-th statically linked opcode library.
+ * Returns the number of entries, 0 if the library failed, or -1 if there
+ * are fewer than i+1 libraries. These lists are the same for every
+ * instance and go into the shared built-in opcode table.
+ */
+int32_t csoundGetStaticOpcodes(CSOUND *csound, int32_t i, OENTRY **ep)
+{
+  int32_t length;
+  if (i < 0 || i >= (int32_t) (sizeof(staticmodules) / sizeof(INITFN)) - 1)
+    return -1;
+  length = (staticmodules[i])(csound, ep);
+  return length > 0 ? length / (int32_t) sizeof(OENTRY) : 0;
+}
+
+CS_NOINLINE int32_t csoundInitStaticModules(CSOUND *csound)
+{
+  int32_t     i;
 
   const INITFN2 staticmodules2[] = {
     stdopc_ModuleInit,
@@ -1345,17 +1714,7 @@ CS_NOINLINE int32_t csoundInitStaticModules(CSOUND *csound)
     padsyn_fgen_init, mp3in_fgen_init, NULL };
 
 
-  for (i=0; staticmodules[i]!=NULL; i++) {
-    length = (staticmodules[i])(csound, &opcodlst_n);
-
-    if (UNLIKELY(length <= 0L)) return CSOUND_ERROR;
-    length /= (int32_t) sizeof(OENTRY);
-    if (length) {
-      if (UNLIKELY(csoundAppendOpcodes(csound, opcodlst_n, length) != 0))
-        return CSOUND_ERROR;
-    }
-  }
-
+  /* the staticmodules[] opcodes are in the built-in table already */
   for (i=0; staticmodules2[i]!=NULL; i++) {
     if(UNLIKELY(staticmodules2[i](csound))) return CSOUND_ERROR;
   }
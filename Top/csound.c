@@ -105,6 +105,7 @@ static void set_util_sr(CSOUND *csound, MYFLT sr);
 static void set_util_nchnls(CSOUND *csound, int32_t nchnls);
 
 extern void cscoreRESET(CSOUND *);
+extern INSDS *lockstep_perf(CSOUND *, INSDS *, double);
 extern void memRESET(CSOUND *);
 extern MYFLT csoundPow2(CSOUND *csound, MYFLT a);
 extern int32_t csoundInitStaticModules(CSOUND *);
@@ -208,6 +209,291 @@ void print_engine_parameters(CSOUND *csound) {
   csoundErrorMsg(csound, Str(" A4 tuning = %.1f\n"), csound->A4);
 }
 
+/* Built-in opcode table, shared by all instances.
+   opcodlst_1 and the statically linked opcode libraries are the same
+   for every instance, so they are hashed once per process into a
+   table that is never modified. csound->opcodes only holds the opcodes
+   an instance adds itself: plugins, UDOs and modules that register
+   opcodes from their init functions. A name found there hides its
+   built-in list, which is copied into it the first time the instance
+   adds to that name, so lookups see the same order as before. */
+
+typedef struct {
+  const char  *name;                  /* short name, NULL if slot free */
+  CONS_CELL   *list;                  /* entries in load order         */
+} BUILTIN_NAME;
+
+typedef struct {
+  OENTRY        *entries;
+  int32_t       count;
+  CONS_CELL     *cells;
+  BUILTIN_NAME  *slots;               /* indexed by the perfect hash   */
+  uint32_t      *disp;                /* displacement of each bucket   */
+  uint32_t      nslots, nbuckets;
+} BUILTIN_OPCODES;
+
+static BUILTIN_OPCODES *builtin_opcodes = NULL;
+
+#ifndef BUILD_PLUGINS
+extern int32_t csoundGetStaticOpcodes(CSOUND *, int32_t, OENTRY **);
+#else
+static inline int32_t csoundGetStaticOpcodes(CSOUND *csound, int32_t i,
+                                             OENTRY **ep) {
+  IGN(csound); IGN(i); IGN(ep);
+  return -1;
+}
+#endif
+
+static inline uint32_t builtin_hash(const char *s, uint32_t seed)
+{
+  uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+  while (*s != '\0' && *s != '.')
+    h = (h ^ (uint8_t) *s++) * 16777619u;
+  return h ^ (h >> 15);
+}
+
+static inline int32_t builtin_name_eq(const char *name, const char *s)
+{
+  size_t n = strlen(name);
+  return strncmp(name, s, n) == 0 && (s[n] == '\0' || s[n] == '.');
+}
+
+static CONS_CELL *builtin_find(const BUILTIN_OPCODES *t, const char *name)
+{
+  const BUILTIN_NAME *slot;
+  if (t == NULL)
+    return NULL;
+  slot = &t->slots[builtin_hash(name, t->disp[builtin_hash(name, 0)
+                                               % t->nbuckets]) % t->nslots];
+  return (slot->name != NULL && builtin_name_eq(slot->name, name)) ?
+    slot->list : NULL;
+}
+
+/* place every name, largest buckets first (hash and displace) */
+static int32_t builtin_place(BUILTIN_OPCODES *t, BUILTIN_NAME *names,
+                             uint32_t nnames)
+{
+  uint32_t  *bucket_of = (uint32_t *) malloc(sizeof(uint32_t) * nnames);
+  uint32_t  *order = (uint32_t *) calloc(t->nbuckets * 2, sizeof(uint32_t));
+  uint32_t  *size = order + t->nbuckets, *pos, i, j, b, d;
+  uint32_t  *placed = (uint32_t *) malloc(sizeof(uint32_t) * nnames);
+  int32_t   ok = 1;
+
+  if (bucket_of == NULL || order == NULL || placed == NULL) {
+    free(bucket_of); free(order); free(placed);
+    return 0;
+  }
+  for (i = 0; i < nnames; i++) {
+    bucket_of[i] = builtin_hash(names[i].name, 0) % t->nbuckets;
+    size[bucket_of[i]]++;
+  }
+  for (i = 0; i < t->nbuckets; i++)
+    order[i] = i;
+  /* insertion sort by size: buckets hold a handful of names */
+  for (i = 1; i < t->nbuckets; i++) {
+    uint32_t o = order[i];
+    for (j = i; j > 0 && size[order[j - 1]] < size[o]; j--)
+      order[j] = order[j - 1];
+    order[j] = o;
+  }
+  pos = placed;
+  for (i = 0; i < t->nbuckets && ok; i++) {
+    uint32_t  n = 0, k;
+    b = order[i];
+    if (size[b] == 0)
+      break;
+    for (j = 0; j < nnames; j++)
+      if (bucket_of[j] == b)
+        pos[n++] = j;
+    for (d = 1; d < (1u << 20); d++) {
+      for (k = 0; k < n; k++) {
+        uint32_t  h = builtin_hash(names[pos[k]].name, d) % t->nslots, m;
+        if (t->slots[h].name != NULL)
+          break;
+        for (m = 0; m < k; m++)
+          if (builtin_hash(names[pos[m]].name, d) % t->nslots == h)
+            break;
+        if (m < k)
+          break;
+      }
+      if (k == n)
+        break;
+    }
+    if (d == (1u << 20)) {
+      ok = 0;
+      break;
+    }
+    t->disp[b] = d;
+    for (k = 0; k < n; k++)
+      t->slots[builtin_hash(names[pos[k]].name, d) % t->nslots] =
+        names[pos[k]];
+  }
+  free(bucket_of); free(order); free(placed);
+  return ok;
+}
+
+/* build the shared table; called once, with the global lock held */
+static BUILTIN_OPCODES *builtin_opcodes_create(CSOUND *csound)
+{
+  BUILTIN_OPCODES *t;
+  BUILTIN_NAME    *names;
+  CS_HASH_TABLE   *index;
+  OENTRY          *ep;
+  int32_t         i, n, m, count = 0;
+  uint32_t        nnames = 0;
+
+  for (ep = opcodlst_1; ep->opname != NULL; ep++)
+    count++;
+  for (i = 0; (n = csoundGetStaticOpcodes(csound, i, &ep)) >= 0; i++) {
+    if (UNLIKELY(n == 0))
+      return NULL;
+    count += n;
+  }
+  t = (BUILTIN_OPCODES *) calloc(1, sizeof(BUILTIN_OPCODES));
+  if (UNLIKELY(t == NULL))
+    return NULL;
+  t->count = count;
+  t->entries = (OENTRY *) malloc(sizeof(OENTRY) * count);
+  t->cells = (CONS_CELL *) calloc(count, sizeof(CONS_CELL));
+  names = (BUILTIN_NAME *) calloc(count, sizeof(BUILTIN_NAME));
+  if (UNLIKELY(t->entries == NULL || t->cells == NULL || names == NULL))
+    goto fail;
+  /* entries in the order csoundAppendOpcodes() would have added them */
+  n = 0;
+  for (ep = opcodlst_1; ep->opname != NULL; ep++)
+    t->entries[n++] = *ep;
+  for (i = 0; (m = csoundGetStaticOpcodes(csound, i, &ep)) > 0; i++) {
+    while (m-- > 0 && ep->opname != NULL)
+      t->entries[n++] = *ep++;
+  }
+  t->count = count = n;
+  /* group entries by short name, keeping their order */
+  index = cs_hash_table_create(csound);
+  for (i = 0; i < count; i++) {
+    OENTRY    *e = &t->entries[i];
+    char      *shortName = get_opcode_short_name(csound, e->opname);
+    CONS_CELL *last = (CONS_CELL *) cs_hash_table_get(csound, index,
+                                                      shortName);
+    e->useropinfo = NULL;
+    t->cells[i].value = e;
+    if (last == NULL) {
+      names[nnames].name = e->opname;
+      names[nnames++].list = &t->cells[i];
+    }
+    else
+      last->next = &t->cells[i];
+    cs_hash_table_put(csound, index, shortName, &t->cells[i]);
+    if (shortName != e->opname)
+      csound->Free(csound, shortName);
+  }
+  cs_hash_table_free(csound, index);
+  /* a name is the first entry's opname, compared up to any '.' */
+  for (i = 0; i < (int32_t) nnames; i++) {
+    const char *s = names[i].name;
+    size_t len = strcspn(s, ".");
+    if (s[len] != '\0') {
+      char *name = (char *) malloc(len + 1);
+      if (UNLIKELY(name == NULL))
+        goto fail;
+      memcpy(name, s, len);
+      name[len] = '\0';
+      names[i].name = name;
+    }
+  }
+  t->nbuckets = nnames / 4 + 1;
+  t->nslots = nnames + nnames / 4 + 1;
+  t->disp = (uint32_t *) calloc(t->nbuckets, sizeof(uint32_t));
+  t->slots = (BUILTIN_NAME *) calloc(t->nslots, sizeof(BUILTIN_NAME));
+  if (UNLIKELY(t->disp == NULL || t->slots == NULL ||
+               !builtin_place(t, names, nnames)))
+    goto fail;
+  free(names);
+  return t;
+ fail:
+  /* short names copied above are not freed: this only fails on OOM */
+  free(names);
+  free(t->slots); free(t->disp); free(t->cells); free(t->entries);
+  free(t);
+  return NULL;
+}
+
+/**
+ * Opcode entries for 'shortName': the instance's own list, else the
+ * shared built-in one. The list must not be modified.
+ */
+CONS_CELL *opcode_list_find(CSOUND *csound, const char *shortName)
+{
+  CONS_CELL *head = (CONS_CELL *)
+    cs_hash_table_get(csound, csound->opcodes, (char *) shortName);
+  return head != NULL ? head : builtin_find(builtin_opcodes, shortName);
+}
+
+/**
+ * All opcode lists, one cons cell per name; free with cs_cons_free().
+ */
+CONS_CELL *opcode_list_values(CSOUND *csound)
+{
+  CONS_CELL *head = cs_hash_table_values(csound, csound->opcodes);
+  uint32_t  i;
+  if (builtin_opcodes == NULL)
+    return head;
+  for (i = 0; i < builtin_opcodes->nslots; i++) {
+    BUILTIN_NAME *slot = &builtin_opcodes->slots[i];
+    if (slot->name != NULL &&
+        cs_hash_table_get(csound, csound->opcodes,
+                          (char *) slot->name) == NULL)
+      head = cs_cons(csound, slot->list, head);
+  }
+  return head;
+}
+
+/* give this instance its own copy of a built-in name's list */
+static CONS_CELL *opcode_list_own(CSOUND *csound, char *shortName)
+{
+  CONS_CELL *builtin = builtin_find(builtin_opcodes, shortName);
+  CONS_CELL *head = NULL, *tail = NULL;
+
+  for ( ; builtin != NULL; builtin = builtin->next) {
+    OENTRY *entryCopy = csound->Malloc(csound, sizeof(OENTRY));
+    CONS_CELL *cell;
+    memcpy(entryCopy, builtin->value, sizeof(OENTRY));
+    cell = cs_cons(csound, entryCopy, NULL);
+    if (tail == NULL)
+      head = cell;
+    else
+      tail->next = cell;
+    tail = cell;
+  }
+  if (head != NULL)
+    cs_hash_table_put(csound, csound->opcodes, shortName, head);
+  return head;
+}
+
+/**
+ * Return an entry that this instance may modify: built-in entries are
+ * shared, so their name's list is copied into csound->opcodes first.
+ */
+OENTRY *opcode_list_unshare(CSOUND *csound, OENTRY *ep)
+{
+  CONS_CELL *src, *dst;
+  char      *shortName;
+
+  if (builtin_opcodes == NULL || ep < builtin_opcodes->entries ||
+      ep >= builtin_opcodes->entries + builtin_opcodes->count)
+    return ep;
+  shortName = get_opcode_short_name(csound, ep->opname);
+  src = builtin_find(builtin_opcodes, shortName);
+  dst = (CONS_CELL *) cs_hash_table_get(csound, csound->opcodes, shortName);
+  if (dst == NULL)
+    dst = opcode_list_own(csound, shortName);
+  if (shortName != ep->opname)
+    csound->Free(csound, shortName);
+  for ( ; src != NULL && dst != NULL; src = src->next, dst = dst->next)
+    if (src->value == (void *) ep)
+      return (OENTRY *) dst->value;
+  return ep;
+}
+
 static void free_opcode_table(CSOUND *csound) {
   int32_t i;
   CS_HASH_TABLE_ITEM *bucket;
@@ -227,17 +513,18 @@ static void free_opcode_table(CSOUND *csound) {
 }
 static void create_opcode_table(CSOUND *csound) {
 
-  int32_t err;
-
   if (csound->opcodes != NULL) {
     free_opcode_table(csound);
   }
   csound->opcodes = cs_hash_table_create(csound);
 
-  /* Basic Entry1 stuff */
-  err = csoundAppendOpcodes(csound, &(opcodlst_1[0]), -1);
+  /* Basic Entry1 stuff and static opcode libraries, built once */
+  csoundLock();
+  if (builtin_opcodes == NULL)
+    builtin_opcodes = builtin_opcodes_create(csound);
+  csoundUnLock();
 
-  if (UNLIKELY(err))
+  if (UNLIKELY(builtin_opcodes == NULL))
     csoundDie(csound, Str("Error allocating opcode list"));
 }
 
@@ -692,11 +979,18 @@ static const CSOUND cenviron_ = {
     cs_strtod,
     cs_sprintf,
     cs_sscanf,
+    /* decoded sound files */
+    csoundDecodedSoundFile,
+    csoundReleaseDecodedSoundFile,
+    /* FFT setups owned by an opcode */
+    csoundRealFFT2SetupFor,
+    csoundDCTSetupFor,
+    csoundReleaseFFTSetups,
     /* space for API expansion */
     {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
      NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
      NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-     NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL},
+     NULL, NULL, NULL, NULL, NULL},
     /* ------- private data (not to be used by hosts or externals) ------- */
     /* callback function pointers */
  /* callback function pointers */
@@ -1114,7 +1408,15 @@ static const CSOUND cenviron_ = {
     0.0,           /*   limiter */
     DFLT_SR, DFLT_KR,  /* defaults */
     0,             /* mp3 mode */
-    0              /* instr redefinition flag */ 
+    0,             /* instr redefinition flag */
+    0,             /* fuse a-rate expressions */
+    0,             /* exact a-rate math functions */
+    0,             /* instances one at a time */
+    0,             /* interleaved pvs frames only */
+    64,            /* diskin2 page cache size in MB */
+    0,             /* diskin2 sinc computed per sample */
+    0,             /* decoded sound file cache size in MB */
+    1              /* oscillator banks in vector lanes */
   },
   {0, 0, {0}}, /* REMOT_BUF */
   NULL,           /* remoteGlobals        */
@@ -1184,7 +1486,7 @@ static const CSOUND cenviron_ = {
   0,              /* mode */
   NULL,           /* opcodedir */
   NULL,           /* score_srt */
-  {NULL, NULL, NULL, 0, 0, NULL}, /* osc_message_anchor */
+  {NULL, NULL, NULL, 0, 0, NULL, 0}, /* osc_message_anchor */
   NULL,
   SPINLOCK_INIT,
   {                /* csound_util */
@@ -1906,6 +2208,14 @@ int32_t kperf_nodebug(CSOUND *csound) {
 
       while (ip != NULL) { /* for each instr active:  */
         INSDS *nxt = ip->nxtact;
+        if (csound->oparms->lockstep) {
+          /* instances of the same instrument go together */
+          INSDS *rest = lockstep_perf(csound, ip, time_end);
+          if (rest != ip) {
+            ip = rest;
+            continue;
+          }
+        }
         if (UNLIKELY(csound->oparms->sampleAccurate && ip->offtim > 0 &&
                      time_end > ip->offtim)) {
           /* this is the last cycle of performance */
@@ -2894,6 +3204,25 @@ int32_t csoundScoreEventAbsoluteInternal(CSOUND *csound, char type,
   return ret;
 }
 
+int32_t csoundScoreEventAtSampleInternal(CSOUND *csound, char type,
+                                         const MYFLT *pfields, long numFields,
+                                         int64_t sample) {
+  EVTBLK evt;
+  int32_t i;
+  memset(&evt, 0, sizeof(EVTBLK));
+
+  evt.strarg = NULL;
+  evt.scnt = 0;
+  evt.opcod = type;
+  evt.pcnt = (int16)numFields;
+  for (i = 0; i < (int32_t)numFields; i++)
+    evt.p[i + 1] = pfields[i];
+  /* events whose time has already passed start now */
+  if (sample < csound->icurTime)
+    sample = csound->icurTime;
+  return insert_score_event_at_sample(csound, &evt, sample);
+}
+
 /*
  *    REAL-TIME AUDIO
  */
@@ -3232,6 +3561,8 @@ static CS_NOINLINE int32_t opcode_list_new_oentry(CSOUND *csound,
 
   shortName = get_opcode_short_name(csound, ep->opname);
   head = cs_hash_table_get(csound, csound->opcodes, shortName);
+  if (head == NULL)
+    head = opcode_list_own(csound, shortName);
   entryCopy = csound->Malloc(csound, sizeof(OENTRY));
   memcpy(entryCopy, ep, sizeof(OENTRY));
   entryCopy->useropinfo = NULL;
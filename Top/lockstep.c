@@ -0,0 +1,193 @@
+/*
+    lockstep.c: running the instances of an instrument in lockstep
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#include "csoundCore.h"
+#include "lockstep.h"
+#include "entry1.h"
+#include "interlocks.h"
+#include "ugens1.h"
+#include "ugens2.h"
+
+/* kernels of the opcodes built into the engine */
+static const struct {
+    SUBR          perf;
+    LOCKSTEP_PERF batch;
+} core_ops[] = {
+    { (SUBR) osckki, osckki_lanes },
+    { (SUBR) linseg, linseg_lanes }
+};
+
+static LOCKSTEP_PERF find_batch(const LOCKSTEP *ls, SUBR perf)
+{
+    int32_t i;
+    for (i = 0; i < (int32_t) (sizeof(core_ops) / sizeof(core_ops[0])); i++)
+      if (core_ops[i].perf == perf)
+        return core_ops[i].batch;
+    for (i = 0; i < ls->count; i++)
+      if (ls->ops[i].perf == perf)
+        return ls->ops[i].batch;
+    return NULL;
+}
+
+/* Whether the instances of an instrument may be interleaved: nothing
+   in it may make one voice see another's writes out of order.        */
+static int32_t lockstep_safe(INSTRTXT *tp)
+{
+    OPTXT   *optxt;
+    if (LIKELY(tp->lockstep != 0))
+      return tp->lockstep > 0;
+    tp->lockstep = 1;
+    for (optxt = tp->nxtop; optxt != NULL; optxt = optxt->nxtop) {
+      OENTRY  *ep = optxt->t.oentry;
+      ARG     *arg;
+      if (ep == NULL)
+        continue;
+      /* the outputs add up in voice order either way, but monitor
+         reads what the other voices have written */
+      if ((ep->flags & (ZW | WI | TW | _CW | SK | WR)) ||
+          ep->init == (SUBR) useropcdset ||
+          strncmp(ep->opname, "subinstr", 8) == 0 ||
+          strncmp(ep->opname, "monitor", 7) == 0)
+        break;
+      for (arg = optxt->t.outArgs; arg != NULL; arg = arg->next)
+        if (arg->type == ARG_GLOBAL)
+          break;
+      if (arg != NULL)
+        break;
+      /* element writes take the array as an input */
+      if (strncmp(ep->opname, "##array_set", 11) == 0 &&
+          optxt->t.inArgs != NULL && optxt->t.inArgs->type == ARG_GLOBAL)
+        break;
+    }
+    if (optxt != NULL)
+      tp->lockstep = -1;
+    return tp->lockstep > 0;
+}
+
+/* whether ip can join a group, which also marks its last cycle */
+static int32_t can_join(CSOUND *csound, INSDS *ip, double time_end)
+{
+    if (UNLIKELY(csound->oparms->sampleAccurate && ip->offtim > 0 &&
+                 time_end > ip->offtim))
+      ip->ksmps_no_end = ip->no_end;
+    return (ATOMIC_GET(ip->init_done) == 1 && ip->actflg &&
+            ip->ksmps == csound->ksmps &&
+            ip->ksmps_offset == 0 && ip->ksmps_no_end == 0);
+}
+
+/* the rest of a cycle of a voice that left its group */
+static void perf_alone(CSOUND *csound, INSDS *ip)
+{
+    OPDS    *opstart = ip->pds;
+    int32_t error = 0;
+    while (error == 0 && opstart != NULL &&
+           (opstart = opstart->nxtp) != NULL && ip->actflg) {
+      opstart->insdshead->pds = opstart;
+      csound->op = opstart->optext->t.opcod;
+      error = (*opstart->perf)(csound, opstart);
+      opstart = opstart->insdshead->pds;
+    }
+}
+
+/* Perform ip and the instances of its instrument that follow it in the
+   active list, one opcode at a time.  Returns the first instance left
+   for kperf to do, which is ip when there is nobody to go along with.  */
+INSDS *lockstep_perf(CSOUND *csound, INSDS *ip, double time_end)
+{
+    INSDS   *ips[LOCKSTEP_VOICES], *alone[LOCKSTEP_VOICES];
+    OPDS    *ops[LOCKSTEP_VOICES];
+    char    stop[LOCKSTEP_VOICES];
+    INSDS   *nxt = ip;
+    LOCKSTEP *ls;
+    int32_t n = 0, nalone = 0, i, j;
+
+    while (nxt != NULL && n < LOCKSTEP_VOICES &&
+           nxt->instr == ip->instr && can_join(csound, nxt, time_end)) {
+      ips[n++] = nxt;
+      nxt = nxt->nxtact;
+    }
+    if (n < 2 || !lockstep_safe(ip->instr))
+      return ip;
+
+    ls = (LOCKSTEP*) csound->QueryGlobalVariable(csound, "::lockstep::");
+    if (UNLIKELY(ls == NULL)) {
+      if (UNLIKELY(csound->CreateGlobalVariable(csound, "::lockstep::",
+                                                sizeof(LOCKSTEP)) != 0))
+        return ip;
+      ls = (LOCKSTEP*) csound->QueryGlobalVariable(csound, "::lockstep::");
+    }
+    ls->math = VECMATH_CS(csound);
+
+    for (i = 0; i < n; i++) {
+      ips[i]->spin = csound->spin;
+      ips[i]->spout = csound->spout_tmp;
+      ips[i]->kcounter = csound->kcounter;
+      ips[i]->pds = ops[i] = (OPDS*) ips[i];
+    }
+    csound->mode = 2;
+    while (n > 0) {
+      OPTXT   *optext;
+      LOCKSTEP_PERF batch;
+      if ((ops[0] = ops[0]->nxtp) == NULL)
+        break;
+      optext = ops[0]->optext;
+      /* a voice whose chain differs goes on by itself */
+      for (i = 1, j = 1; i < n; i++) {
+        OPDS *op = ops[i]->nxtp;
+        if (UNLIKELY(op == NULL || op->optext != optext))
+          alone[nalone++] = ips[i];
+        else {
+          ips[j] = ips[i];
+          ops[j++] = op;
+        }
+      }
+      n = j;
+      for (i = 0; i < n; i++) {
+        ips[i]->pds = ops[i];
+        stop[i] = 0;
+      }
+      csound->op = optext->t.opcod;
+      if (n > 1 && (batch = find_batch(ls, ops[0]->perf)) != NULL) {
+        if (UNLIKELY(batch(csound, ls, ops, n, stop) != OK))
+          memset(stop, 1, n);
+      }
+      else
+        for (i = 0; i < n; i++)
+          stop[i] = ((*ops[i]->perf)(csound, ops[i]) != 0);
+      /* voices that failed or were turned off stop, those that jumped
+         leave the group */
+      for (i = 0, j = 0; i < n; i++) {
+        if (stop[i] || !ips[i]->actflg)
+          continue;
+        if (UNLIKELY(ips[i]->pds != ops[i]))
+          alone[nalone++] = ips[i];
+        else {
+          ips[j] = ips[i];
+          ops[j++] = ops[i];
+        }
+      }
+      n = j;
+    }
+    for (i = 0; i < nalone; i++)
+      perf_alone(csound, alone[i]);
+    csound->mode = 0;
+    return nxt;
+}
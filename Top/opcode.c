@@ -32,6 +32,7 @@
 #include "csoundCore.h"
 #include <ctype.h>
 #include "interlocks.h"
+#include "csmodule.h"
 
 static int32_t opcode_cmp_func(const void *a, const void *b)
 {
@@ -72,8 +73,10 @@ PUBLIC int32_t csoundNewOpcodeList(CSOUND *csound, opcodeListEntry **lstp)
     (*lstp) = NULL;
     if (UNLIKELY(csound->opcodes == NULL))
       return -1;
+    /* the list must include plugins deferred by the opcode manifest */
+    csoundLoadAllDeferredOpcodes(csound);
 
-    head = items = cs_hash_table_values(csound, csound->opcodes);
+    head = items = opcode_list_values(csound);
 
     /* count the number of opcodes, and bytes to allocate */
     while (items != NULL) {
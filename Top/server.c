@@ -33,11 +33,21 @@
 #include <ws2tcpip.h>
 #else
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <poll.h>
 #endif
 
 extern int32_t *csoundGetChannelLock(CSOUND *csound, const char *name);
+extern void csoundScoreEventAtSampleAsync(CSOUND *csound, char type,
+                                          const MYFLT *pfields,
+                                          long numFields, int64_t sample);
+
+#define MAXSTR 1048576 /* 1MB */
+#define UDP_DGRAM 65536  /* largest datagram */
+#define UDP_BATCH 16     /* datagrams taken per receive call */
+#define UDP_POLL  50     /* ms to wait for data before checking status */
 
 typedef struct {
   int32_t port;
@@ -47,11 +57,16 @@ typedef struct {
   void  *cb;
   struct sockaddr_in server_addr;
   unsigned char status;
+  /* receive state, owned by the server thread */
+  char    *dgram[UDP_BATCH];  /* datagram buffers */
+  int32_t dsize[UDP_BATCH];   /* received sizes */
+  char    *orc;               /* orchestra text spanning datagrams */
+  int32_t orclen, cont;
+  int32_t sendsock;           /* socket for channel replies */
 } UDPCOM;
 
 const char *csoundOSCMessageGetNumber(const char *buf,
                                       char type, MYFLT *out);
-#define MAXSTR 1048576 /* 1MB */
 
 /** Add OSC message to linked list
     threadsafe code
@@ -59,7 +74,8 @@ const char *csoundOSCMessageGetNumber(const char *buf,
 void csoundAddOSCMessage(CSOUND *csound, const OSC_MESS *mess) {
   OSC_MESS *p = &csound->osc_message_anchor;
   spin_lock_t *lock = &csound->osc_spinlock;
-  
+  int32_t alen, tlen, need;
+
   csoundSpinLock(lock);
   while(p) {
     // check for empty slots
@@ -72,42 +88,46 @@ void csoundAddOSCMessage(CSOUND *csound, const OSC_MESS *mess) {
     }
     p = p->nxt;
   }
+  // claim the slot, readers skip it until it is complete
+  p->flag = 2;
   csoundSpinUnLock(lock);
-  
-  // if this slot has already been used, free data 
-  if(p->address) {
-    mfree(csound, p->address);
-    mfree(csound, p->type);
-    mfree(csound, p->data);
+
+  // data, address and type share one block, kept for the next message
+  alen = (int32_t) strlen(mess->address) + 1;
+  tlen = (int32_t) strlen(mess->type) + 1;
+  need = ((mess->size + 7) & ~7) + alen + tlen;
+  if(p->capacity < need) {
+    if(p->data)
+      mfree(csound, p->data);
+    p->data = mcalloc(csound, need);
+    p->capacity = need;
   }
-  // copy data
-  p->address = cs_strdup(csound, mess->address);
-  p->type = cs_strdup(csound, mess->type);
-  p->data = mcalloc(csound, mess->size);
   memcpy(p->data, mess->data, mess->size);
+  p->size = mess->size;
+  p->address = p->data + ((mess->size + 7) & ~7);
+  memcpy(p->address, mess->address, alen);
+  p->type = p->address + alen;
+  memcpy(p->type, mess->type, tlen);
   ATOMIC_SET(p->flag, 1);
 }
 
-/** Free OSC message list 
+/** Free OSC message list
  */
 void csoundFreeOSCMessageList(CSOUND *csound) {
   OSC_MESS *p = &csound->osc_message_anchor, *pp;
   // free allocated data
-  while(p != NULL) {
-    if(p->address != NULL) {
-      mfree(csound, p->address);
-      mfree(csound, p->type);
-      mfree(csound, p->data);
-    }
-    p = p->nxt;
-  }
+  if(p->data != NULL)
+    mfree(csound, p->data);
   // free linked list
-  p = (&csound->osc_message_anchor)->nxt;
+  p = p->nxt;
   while(p != NULL) {
     pp = p;
     p = p->nxt;
+    if(pp->data != NULL)
+      mfree(csound, pp->data);
     mfree(csound, pp);
-  }  
+  }
+  memset(&csound->osc_message_anchor, 0, sizeof(OSC_MESS));
 }
 
 static void udp_socksend(CSOUND *csound, int32_t *sock, const char *addr,
@@ -167,202 +187,410 @@ static void udp_socksend(CSOUND *csound, int32_t *sock, const char *addr,
 }
 
 
+/* OSC address routes, matched one path segment at a time */
+enum { OSC_NONE = 0, OSC_COMPILE, OSC_EVENT, OSC_INSTR, OSC_CHANNEL,
+       OSC_END };
+
+typedef struct osc_route {
+  const char *name;
+  int32_t route;                 /* address ends here */
+  int32_t prefix;                /* address continues past here */
+  const struct osc_route *child;
+} OSC_ROUTE;
+
+static const OSC_ROUTE osc_event_routes[] = {
+  { "instr", OSC_INSTR, OSC_NONE, NULL },
+  { "end", OSC_END, OSC_NONE, NULL },
+  { NULL, OSC_NONE, OSC_NONE, NULL }
+};
+
+static const OSC_ROUTE osc_csound_routes[] = {
+  { "compile", OSC_COMPILE, OSC_NONE, NULL },
+  { "event", OSC_EVENT, OSC_NONE, osc_event_routes },
+  { "channel", OSC_NONE, OSC_CHANNEL, NULL },
+  { "exit", OSC_END, OSC_NONE, NULL },
+  { "close", OSC_END, OSC_NONE, NULL },
+  { "stop", OSC_END, OSC_NONE, NULL },
+  { NULL, OSC_NONE, OSC_NONE, NULL }
+};
+
+static const OSC_ROUTE osc_routes[] = {
+  { "csound", OSC_NONE, OSC_NONE, osc_csound_routes },
+  { NULL, OSC_NONE, OSC_NONE, NULL }
+};
+
+/* find the route for an address; for prefix routes,
+   rest is set to the remainder of the address */
+static int32_t osc_route(const char *address, char **rest) {
+  const OSC_ROUTE *node = osc_routes, *r;
+  const char *seg = address, *end;
+  while(node != NULL && *seg == '/') {
+    seg++;
+    for(end = seg; *end != '\0' && *end != '/'; end++);
+    for(r = node; r->name != NULL; r++)
+      if(!strncmp(r->name, seg, end - seg) && r->name[end - seg] == '\0')
+        break;
+    if(r->name == NULL) return OSC_NONE;
+    if(*end == '\0') return r->route;
+    if(r->prefix != OSC_NONE) {
+      *rest = (char *) end + 1;
+      return r->prefix;
+    }
+    node = r->child;
+    seg = end;
+  }
+  return OSC_NONE;
+}
+
+/* size of the padded OSC string at buf, -1 if not terminated */
+static int32_t osc_string_size(const char *buf, const char *end) {
+  const char *s = end > buf ? memchr(buf, '\0', end - buf) : NULL;
+  if(s == NULL) return -1;
+  return (int32_t) (((s - buf) + 4) & ~3);
+}
+
+static int32_t osc_int32(const char *buf) {
+  const unsigned char *b = (const unsigned char *) buf;
+  return (int32_t) (((uint32_t) b[0] << 24) | ((uint32_t) b[1] << 16) |
+                    ((uint32_t) b[2] << 8) | (uint32_t) b[3]);
+}
+
+/* bytes taken by a numeric OSC argument, -1 for other types */
+static int32_t osc_number_size(char type) {
+  switch(type) {
+  case 'f': case 'i': case 'c': return 4;
+  case 'd': case 'h': return 8;
+  default: return -1;
+  }
+}
+
+static double udp_wallclock(void) {
+#if defined(WIN32) && !defined(__CYGWIN__)
+  FILETIME ft;
+  ULARGE_INTEGER t;
+  GetSystemTimeAsFileTime(&ft);
+  t.LowPart = ft.dwLowDateTime;
+  t.HighPart = ft.dwHighDateTime;
+  /* 100 ns ticks since 1601 */
+  return (double) t.QuadPart * 1.0e-7 - 11644473600.0;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (double) tv.tv_sec + (double) tv.tv_usec * 1.0e-6;
+#endif
+}
+
+/* OSC time tags are NTP times, seconds since 1900 in the top 32 bits;
+   they are mapped to engine samples relative to the current wall clock,
+   times already passed giving the current sample */
+#define NTP_UNIX_OFFSET 2208988800.0
+
+static int64_t osc_timetag_sample(CSOUND *csound, const char *buf) {
+  double secs = (double) (uint32_t) osc_int32(buf) - NTP_UNIX_OFFSET +
+    (double) (uint32_t) osc_int32(buf + 4) / 4294967296.0;
+  double delta = secs - udp_wallclock();
+  int64_t now = csoundGetCurrentTimeSamples(csound);
+  return delta > 0.0 ? now + (int64_t) (delta * csoundGetSr(csound)) : now;
+}
+
+/* handle an OSC message; events are scheduled at sample when,
+   or immediately if when < 0 */
+static void udp_osc_message(CSOUND *csound, char *buf, int32_t size,
+                            int64_t when) {
+  OSC_MESS mess;
+  const char *end = buf + size;
+  char *rest = NULL;
+  int32_t len, route;
+  mess.address = buf;
+  if((len = osc_string_size(buf, end)) < 0) return;
+  buf += len;
+  if(buf >= end || *buf != ',' || (len = osc_string_size(buf, end)) < 0)
+    return;
+  mess.type = buf + 1; // jump the starting ','
+  buf += len;
+  route = osc_route(mess.address, &rest);
+  // parse messages
+  if(route == OSC_COMPILE && !strcmp(mess.type, "s")) {
+    csoundCompileOrc(csound, buf, 1);
+  }
+  else if(route == OSC_EVENT) {
+    if(!strcmp(mess.type, "s"))
+      csoundEventString(csound, buf, 1);
+  }
+  else if(route == OSC_INSTR) {
+    // numeric types
+    MYFLT arg[PMAX];
+    int32_t n = (int32_t) strlen(mess.type), i;
+    const char *b = buf;
+    if(n > PMAX) {
+      csound->Warning(csound, Str("OSC event with %d p-fields dropped, "
+                                  "the limit is %d"), n, PMAX);
+      return;
+    }
+    for(i = 0; i < n; i++) {
+      int32_t sz = osc_number_size(mess.type[i]);
+      if(sz < 0) break;
+      if(end - b < sz) {
+        csound->Warning(csound, Str("OSC event with a truncated payload "
+                                    "dropped"));
+        return;
+      }
+      b = csoundOSCMessageGetNumber(b, mess.type[i], &arg[i]);
+    }
+    if(when < 0)
+      csoundEvent(csound, CS_INSTR_EVENT, arg, i, 1);
+    else
+      csoundScoreEventAtSampleAsync(csound, 'i', arg, i, when);
+  }
+  else if(route == OSC_CHANNEL) {
+    char *channel = rest, *delim, *nxt = NULL;
+    int32_t items = (int32_t) strlen(mess.type), i;
+    const char *b = buf;
+    for(i = 0; i < items && b < end; i++) {
+      delim = strchr(channel, '/');
+      if (delim) {
+        *delim = '\0';
+        nxt = delim + 1;
+      }
+      if(mess.type[i] == 's') {
+        if((len = osc_string_size(b, end)) < 0) break;
+        csoundSetStringChannel(csound, channel, (char *) b);
+        b += len;
+      }
+      else  {
+        MYFLT f;
+        int32_t sz = osc_number_size(mess.type[i]);
+        if(sz < 0 || end - b < sz) break;
+        b = csoundOSCMessageGetNumber(b, mess.type[i], &f);
+        csoundSetControlChannel(csound, channel, f);
+      }
+      if(nxt) channel = nxt;
+    }
+  }
+  else if(route == OSC_END) {
+    csoundEventString(csound, "e 0 0", 1);
+  }
+  else {
+    mess.data = buf;
+    mess.size = (int32_t) (end - buf);
+    csoundAddOSCMessage(csound, &mess);
+  }
+}
+
+/* handle an OSC packet, unpacking bundles */
+static void udp_osc_packet(CSOUND *csound, char *buf, int32_t size,
+                           int64_t when) {
+  if(size >= 16 && !memcmp(buf, "#bundle", 8)) {
+    int32_t len;
+    // time tag 1 means immediately
+    if(osc_int32(buf + 8) != 0 || osc_int32(buf + 12) != 1)
+      when = osc_timetag_sample(csound, buf + 8);
+    buf += 16;
+    size -= 16;
+    while(size >= 4) {
+      len = osc_int32(buf);
+      buf += 4;
+      size -= 4;
+      if(len <= 0 || len > size) break;
+      udp_osc_packet(csound, buf, len, when);
+      buf += len;
+      size -= len;
+    }
+  }
+  else if(*buf == '/')
+    udp_osc_message(csound, buf, size, when);
+}
+
+/* handle a text command; returns 1 if the server should stop */
+static int32_t udp_text(CSOUND *csound, UDPCOM *p, char *orchestra,
+                        int32_t received) {
+  if (strncmp("!!close!!",orchestra,9)==0 ||
+      strncmp("##close##",orchestra,9)==0) {
+    csoundEventString(csound, "e 0 0", 1);
+    return 1;
+  }
+  if(*orchestra == '&') {
+    csoundEventString(csound, orchestra+1, 1);
+  }
+  else if(*orchestra == '$') {
+    csoundEventString(csound, orchestra+1, 1);
+  }
+  else if(*orchestra == '@') {
+    char chn[128];
+    MYFLT val;
+    sscanf(orchestra+1, "%s", chn);
+    val = atof(orchestra+1+strlen(chn));
+    csoundSetControlChannel(csound, chn, val);
+  }
+  else if(*orchestra == '%') {
+    char chn[128];
+    char *str;
+    sscanf(orchestra+1, "%s", chn);
+    str = cs_strdup(csound, orchestra+1+strlen(chn));
+    csoundSetStringChannel(csound, chn, str);
+    csound->Free(csound, str);
+  }
+  else if(*orchestra == ':') {
+    char addr[128], chn[128], *msg;
+    int32_t sport, err = 0;
+    MYFLT val;
+    sscanf(orchestra+2, "%s", chn);
+    sscanf(orchestra+2+strlen(chn), "%s", addr);
+    sport = atoi(orchestra+3+strlen(addr)+strlen(chn));
+    if(*(orchestra+1) == '@') {
+      size_t slen = strlen(chn);
+      val = csoundGetControlChannel(csound, chn, &err);
+      msg = (char *) csound->Calloc(csound, slen + 32);
+      snprintf(msg, slen + 32, "%s::%f", chn, val);
+    }
+    else if (*(orchestra+1) == '%') {
+      STRINGDAT* stringdat;
+      if (csoundGetChannelPtr(csound, (void **) &stringdat, chn,
+                              CSOUND_STRING_CHANNEL | CSOUND_OUTPUT_CHANNEL)
+          == CSOUND_SUCCESS) {
+        size_t size = stringdat->size + strlen(chn) + 1;
+        spin_lock_t *lock =
+          (spin_lock_t *) csoundGetChannelLock(csound, (char*) chn);
+        msg = (char *) csound->Calloc(csound, size);
+        if (lock != NULL)
+          csoundSpinLock(lock);
+        snprintf(msg, size, "%s::%s", chn, stringdat->data);
+        if (lock != NULL)
+          csoundSpinUnLock(lock);
+      } else err = -1;
+    }
+    else err = -1;
+    if(!err) {
+      udp_socksend(csound, &p->sendsock, addr, sport,msg);
+      csound->Free(csound, msg);
+    }
+    else
+      csound->Warning(csound, Str("could not retrieve channel %s"), chn);
+  }
+  else if(*orchestra == '{' || p->cont) {
+    // accumulate text until the closing brace
+    char *cp, *chunk = p->orc + p->orclen;
+    if(received > MAXSTR - 1 - p->orclen)
+      received = MAXSTR - 1 - p->orclen;
+    memcpy(chunk, orchestra, received);
+    chunk[received] = '\0';
+    if((cp = strrchr(chunk, '}')) != NULL && *(cp-1) != '}') {
+      *cp = '\0';
+      p->cont = 0;
+    }
+    else {
+      p->orclen += (int32_t) strlen(chunk);
+      p->cont = 1;
+    }
+    if(!p->cont) {
+      p->orclen = 0;
+      csoundCompileOrc(csound, p->orc+1, 1);
+    }
+  }
+  else {
+    csoundCompileOrc(csound, orchestra, 1);
+  }
+  return 0;
+}
+
+/* wait up to UDP_POLL ms for data, then take as many datagrams
+   as are ready (up to UDP_BATCH); returns the number taken */
+static int32_t udp_receive(UDPCOM *p) {
+#ifdef __wasm__
+  csoundSleep(UDP_POLL);
+  return 0;
+#else
+  int32_t n = 0;
+#if defined(WIN32) && !defined(__CYGWIN__)
+  fd_set fds;
+  struct timeval tv = { 0, UDP_POLL*1000 };
+  FD_ZERO(&fds);
+  FD_SET((SOCKET) p->sock, &fds);
+  if (select(p->sock + 1, &fds, NULL, NULL, &tv) <= 0)
+    return 0;
+#else
+  struct pollfd pfd;
+  pfd.fd = p->sock;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  if (poll(&pfd, 1, UDP_POLL) <= 0)
+    return 0;
+#endif
+#if defined(LINUX) && defined(_GNU_SOURCE) && defined(MSG_WAITFORONE)
+  {
+    struct mmsghdr msgs[UDP_BATCH];
+    struct iovec iov[UDP_BATCH];
+    int32_t i;
+    memset(msgs, 0, sizeof(msgs));
+    for (i = 0; i < UDP_BATCH; i++) {
+      iov[i].iov_base = p->dgram[i];
+      iov[i].iov_len = UDP_DGRAM;
+      msgs[i].msg_hdr.msg_iov = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    n = recvmmsg(p->sock, msgs, UDP_BATCH, MSG_DONTWAIT, NULL);
+    if (n < 0) return 0;
+    for (i = 0; i < n; i++)
+      p->dsize[i] = (int32_t) msgs[i].msg_len;
+  }
+#else
+  while (n < UDP_BATCH) {
+    struct sockaddr from;
+    socklen_t clilen = sizeof(from);
+    int32_t received = (int32_t) recvfrom(p->sock, (void *) p->dgram[n],
+                                          UDP_DGRAM, 0, &from, &clilen);
+    if (received < 0) break;
+    p->dsize[n++] = received;
+  }
+#endif
+  return n;
+#endif
+}
+
 static uintptr_t udp_recv(void *pdata){
-  struct sockaddr from;
-  socklen_t clilen = sizeof(from);
   UDPCOM *p = (UDPCOM *) pdata;
   CSOUND *csound = p->cs;
   int32_t port = p->port;
-  char *orchestra = csound->Calloc(csound, MAXSTR);
-  int32_t sock = 0;
-  int32_t received, cont = 0;
-  char *start = orchestra;
-  size_t timout = (size_t) lround(1000/csoundGetKr(csound));
+  int32_t i, n, received;
+  char *msg;
   csoundSpinLockInit(&csound->osc_spinlock);
+  for (i = 0; i < UDP_BATCH; i++)
+    p->dgram[i] = csound->Calloc(csound, UDP_DGRAM + 1);
+  p->orc = csound->Calloc(csound, MAXSTR);
+  p->orclen = p->cont = 0;
+  p->sendsock = 0;
 
   csound->Message(csound, Str("UDP server started on port %d\n"),port);
   while (p->status) {
-#ifndef __wasm__
-    received = (int32_t) recvfrom(p->sock, (void *)orchestra, MAXSTR, 0, &from, &clilen);
-#endif
-    if (received <= 0) {
-      csoundSleep(timout ? timout : 1);
-      continue;
-    }
-    else {
-      orchestra[received] = '\0'; // terminate string
-      if(strlen(orchestra) < 2) continue;
-      if (csound->oparms->echo)
-        csound->Message(csound, "%s", orchestra);
-      if (strncmp("!!close!!",orchestra,9)==0 ||
-          strncmp("##close##",orchestra,9)==0) {
-        csoundEventString(csound, "e 0 0", 1);
-        break;
-      }
-      if(*orchestra == '/') {
-        OSC_MESS mess;
-        int32_t len, siz = 0;
-        const char *buf = orchestra;
-        len = (int32_t) strlen(buf);
-        mess.address = (char *) buf;
-        len = ((int32_t) ceil((len+1)/4.)*4);
-        buf += len;
-        siz += len;
-        len = (int32_t) strlen(buf);
-        mess.type = (char *)buf+1; // jump the starting ','
-        len = ((int32_t) ceil((len+1)/4.)*4);
-        buf += len;
-        siz += len;
-        // parse messages
-        if(!strcmp(mess.address, "/csound/compile") &&
-           !strcmp(mess.type, "s")) {
-          csoundCompileOrc(csound, buf, 1);
-        } else if(!strcmp(mess.address, "/csound/event")){
-          if(!strcmp(mess.type, "s")) 
-            csoundEventString(csound, buf, 1);
-        }
-        else if(!strcmp(mess.address, "/csound/event/instr")){
-            // numeric types
-            int32_t n = (int32_t) strlen(mess.type), i;
-            MYFLT *arg = (MYFLT *) mcalloc(csound, sizeof(MYFLT)*n);
-            for(i = 0; i < n; i++) {
-              buf = csoundOSCMessageGetNumber(buf,
-                                              mess.type[i],
-                                              &arg[i]);
-              if(buf == NULL) break;
-            }
-            csoundEvent(csound, CS_INSTR_EVENT, arg, i, 1);
-            mfree(csound, arg);
-        }
-        else if(!strncmp(mess.address, "/csound/channel",15)) {
-          char *channel = mess.address + 16, *delim, *nxt = NULL;
-          int32_t items = (int32_t) strlen(mess.type), i;
-          for(i = 0; i < items; i++) {
-            delim = strchr(channel, '/');
-            if (delim) {
-              *delim = '\0';
-              nxt = delim + 1;
-            }
-            if(mess.type[i] == 's') {
-              csoundSetStringChannel(csound, channel, (char *) buf);
-              buf += ((size_t) ceil((strlen(buf)+1)/4.)*4);
-            }
-            else  {
-              MYFLT f;
-              
-              buf = csoundOSCMessageGetNumber(buf, mess.type[i],
-                                              &f);
-              csoundSetControlChannel(csound, channel, f);
-            }
-            if(nxt) channel = nxt;
-          }
-        } else if(!strcmp(mess.address, "/csound/event/end") ||
-                  !strcmp(mess.address, "/csound/exit") ||
-                  !strcmp(mess.address, "/csound/close") ||
-                  !strcmp(mess.address, "/csound/stop")) {
-          csoundEventString(csound, "e 0 0", 1);
-        }
-        else {
-          mess.data = (char *) buf;
-          mess.size = received - siz;
-          csoundAddOSCMessage(csound, &mess);
-          continue;
-        }
-      }
-      else if(*orchestra == '&') {
-        csoundEventString(csound, orchestra+1, 1);
-      }
-      else if(*orchestra == '$') {
-        csoundEventString(csound, orchestra+1, 1);
-      }
-      else if(*orchestra == '@') {
-        char chn[128];
-        MYFLT val;
-        sscanf(orchestra+1, "%s", chn);
-        val = atof(orchestra+1+strlen(chn));
-        csoundSetControlChannel(csound, chn, val);
-      }
-      else if(*orchestra == '%') {
-        char chn[128];
-        char *str;
-        sscanf(orchestra+1, "%s", chn);
-        str = cs_strdup(csound, orchestra+1+strlen(chn));
-        csoundSetStringChannel(csound, chn, str);
-        csound->Free(csound, str);
-      }
-      else if(*orchestra == ':') {
-        char addr[128], chn[128], *msg;
-        int32_t sport, err = 0;
-        MYFLT val;
-        sscanf(orchestra+2, "%s", chn);
-        sscanf(orchestra+2+strlen(chn), "%s", addr);
-        sport = atoi(orchestra+3+strlen(addr)+strlen(chn));
-        if(*(orchestra+1) == '@') {
-          size_t slen = strlen(chn);
-          val = csoundGetControlChannel(csound, chn, &err);
-          msg = (char *) csound->Calloc(csound, slen + 32);
-          snprintf(msg, slen + 32, "%s::%f", chn, val);
-        }
-        else if (*(orchestra+1) == '%') {
-          STRINGDAT* stringdat;
-          if (csoundGetChannelPtr(csound, (void **) &stringdat, chn,
-                                  CSOUND_STRING_CHANNEL | CSOUND_OUTPUT_CHANNEL)
-              == CSOUND_SUCCESS) {
-            size_t size = stringdat->size + strlen(chn) + 1;
-            spin_lock_t *lock =
-              (spin_lock_t *) csoundGetChannelLock(csound, (char*) chn);
-            msg = (char *) csound->Calloc(csound, size);
-            if (lock != NULL)
-              csoundSpinLock(lock);
-            snprintf(msg, size, "%s::%s", chn, stringdat->data);
-            if (lock != NULL)
-              csoundSpinUnLock(lock);
-          } else err = -1;
-        }
-        else err = -1;
-        if(!err) {
-          udp_socksend(csound, &sock, addr, sport,msg);
-          csound->Free(csound, msg);
-        }
-        else
-          csound->Warning(csound, Str("could not retrieve channel %s"), chn);
-      }
-      else if(*orchestra == '{' || cont) {
-        char *cp;
-        if((cp = strrchr(orchestra, '}')) != NULL) {
-          if(*(cp-1) != '}') {
-            *cp = '\0';
-            cont = 0;
-          }  else {
-            orchestra += received;
-            cont = 1;
-          }
-        }
-        else {
-          orchestra += received;
-          cont = 1;
-        }
-        if(!cont) {
-          orchestra = start;
-          //csound->Message(csound, "%s\n", orchestra+1);
-          csoundCompileOrc(csound, orchestra+1, 1);
-        }
-      }
+    n = udp_receive(p);
+    for (i = 0; i < n && p->status; i++) {
+      msg = p->dgram[i];
+      received = p->dsize[i];
+      if (received <= 0) continue;
+      msg[received] = '\0'; // terminate string
+      if (*msg == '#' && received >= 16 && !memcmp(msg, "#bundle", 8))
+        udp_osc_packet(csound, msg, received, -1);
       else {
-        //csound->Message(csound, "%s\n", orchestra);
-        csoundCompileOrc(csound, orchestra, 1);
+        if (strlen(msg) < 2) continue;
+        if (csound->oparms->echo)
+          csound->Message(csound, "%s", msg);
+        if (*msg == '/')
+          udp_osc_packet(csound, msg, received, -1);
+        else if (udp_text(csound, p, msg, received))
+          p->status = 0;
       }
     }
   }
   csoundFreeOSCMessageList(csound);
   csound->Message(csound, Str("UDP server on port %d stopped\n"),port);
-  csound->Free(csound, start);
-  // csound->Message(csound, "orchestra dealloc\n");
-  if(sock > 0)
+  for (i = 0; i < UDP_BATCH; i++)
+    csound->Free(csound, p->dgram[i]);
+  csound->Free(csound, p->orc);
+  if(p->sendsock > 0)
 #ifndef WIN32
-    close(sock);
+    close(p->sendsock);
 #else
-  closesocket(sock);
+  closesocket(p->sendsock);
 #endif
   return (uintptr_t) 0;
 
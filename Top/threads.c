@@ -574,6 +574,24 @@ PUBLIC void csoundCondWait(void* condVar, void* mutex) {
         pthread_cond_wait(condVar, mutex);
 }
 
+PUBLIC int32_t csoundCondWaitTimeout(void* condVar, void* mutex,
+                                     size_t microseconds) {
+    struct timeval  tv;
+    struct timespec ts;
+    size_t  s, n;
+#ifndef HAVE_GETTIMEOFDAY
+    gettimeofday_(&tv, NULL);
+#else
+    gettimeofday(&tv, NULL);
+#endif
+    s = microseconds / (size_t) 1000000;
+    n = (microseconds - s * (size_t) 1000000 + (size_t) tv.tv_usec) * 1000;
+    s += (size_t) tv.tv_sec;
+    ts.tv_nsec = (long) (n < (size_t) 1000000000 ? n : n - 1000000000);
+    ts.tv_sec = (time_t) (n < (size_t) 1000000000 ? s : s + 1);
+    return pthread_cond_timedwait(condVar, mutex, &ts);
+}
+
 PUBLIC void csoundCondSignal(void* condVar) {
         pthread_cond_signal(condVar);
 }
@@ -822,6 +840,15 @@ PUBLIC void csoundCondWait(void* condVar, void* mutex) {
     SleepConditionVariableCS(cv, cs, INFINITE);
 }
 
+PUBLIC int32_t csoundCondWaitTimeout(void* condVar, void* mutex,
+                                     size_t microseconds) {
+    CONDITION_VARIABLE* cv = (CONDITION_VARIABLE*)condVar;
+    CRITICAL_SECTION* cs = (CRITICAL_SECTION*)mutex;
+    /* rounded up, as the wait is only to the millisecond */
+    DWORD ms = (DWORD) ((microseconds + 999) / 1000);
+    return (SleepConditionVariableCS(cv, cs, ms) ? 0 : 1);
+}
+
 PUBLIC void csoundCondSignal(void* condVar) {
     CONDITION_VARIABLE* cv = (CONDITION_VARIABLE*)condVar;
     WakeConditionVariable(cv);
@@ -1015,6 +1042,12 @@ PUBLIC void csoundCondWait(void* condVar, void* mutex) {
     //notImplementedWarning_("csoundCreateCondWait");
 }
 
+PUBLIC int32_t csoundCondWaitTimeout(void* condVar, void* mutex,
+                                     size_t microseconds) {
+    //notImplementedWarning_("csoundCondWaitTimeout");
+    return 0;
+}
+
 PUBLIC void csoundCondSignal(void* condVar) {
     // notImplementedWarning_("csoundCreateCondSignal");
 }
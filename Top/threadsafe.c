@@ -47,13 +47,17 @@ int32_t csoundScoreEventInternal(CSOUND *csound, char type,
 int32_t csoundScoreEventAbsoluteInternal(CSOUND *csound, char type,
                                      const MYFLT *pfields, long numFields,
                                      double time_ofs);
+int32_t csoundScoreEventAtSampleInternal(CSOUND *csound, char type,
+                                         const MYFLT *pfields, long numFields,
+                                         int64_t sample);
 void set_channel_data_ptr(CSOUND *csound, const char *name,
                           void *ptr, int32_t newSize);
 
 void named_instr_assign_numbers(CSOUND *csound, ENGINE_STATE *engineState);
 
 enum {INPUT_MESSAGE=1, READ_SCORE, SCORE_EVENT, SCORE_EVENT_ABS,
-      TABLE_COPY_OUT, TABLE_COPY_IN, TABLE_SET, MERGE_STATE, KILL_INSTANCE};
+      TABLE_COPY_OUT, TABLE_COPY_IN, TABLE_SET, MERGE_STATE, KILL_INSTANCE,
+      SCORE_EVENT_SAMPLE};
 
 /* MAX QUEUE SIZE */
 #define API_MAX_QUEUE 1024
@@ -65,6 +69,7 @@ typedef struct _message_queue {
   int64_t message;  /* message id */
   char *args;   /* args, arg pointers */
   int64_t rtn;  /* return value */
+  int32_t argsize; /* allocated size of args, reused by later messages */
 } message_queue_t;
 
 
@@ -112,9 +117,13 @@ void *message_enqueue(CSOUND *csound, int32_t message, char *args,
       csound->msg_queue[atomicGet_Incr_Mod(&csound->msg_queue_wget,
                                            API_MAX_QUEUE)];
     msg->message = message;
-    if(msg->args != NULL)
-      csound->Free(csound, msg->args);
-    msg->args = (char *)csound->Calloc(csound, argsiz);
+    /* the slot keeps its args buffer, which only grows */
+    if(msg->args == NULL || msg->argsize < argsiz) {
+      if(msg->args != NULL)
+        csound->Free(csound, msg->args);
+      msg->args = (char *)csound->Calloc(csound, argsiz);
+      msg->argsize = argsiz;
+    }
     memcpy(msg->args, args, argsiz);
     rtn = &msg->rtn;
     csound->msg_queue[atomicGet_Incr_Mod(&csound->msg_queue_wput,
@@ -177,6 +186,20 @@ void message_dequeue(CSOUND *csound) {
                                              ofs);
         }
         break;
+      case SCORE_EVENT_SAMPLE:
+        {
+          int64_t sample;
+          int32_t numFields;
+          char type = msg->args[ARG_ALIGN];
+          memcpy(&sample, msg->args, sizeof(int64_t));
+          memcpy(&numFields, msg->args + ARG_ALIGN + 4, sizeof(int32_t));
+          msg->rtn =
+            csoundScoreEventAtSampleInternal(csound, type,
+                                             (MYFLT *) (msg->args +
+                                                        2*ARG_ALIGN),
+                                             numFields, sample);
+        }
+        break;
       case TABLE_COPY_OUT:
         {
           int32_t table;
@@ -293,8 +316,14 @@ static inline int64_t *csoundScoreEvent_enqueue(CSOUND *csound, char type,
                                                 const MYFLT *pfields,
                                                 long numFields)
 {
-  const int32_t argsize = (int32_t) (sizeof(MYFLT)*(numFields+2));
-  MYFLT *args = mcalloc(csound, argsize);
+  MYFLT args[PMAX+2];
+  int32_t argsize;
+  if (UNLIKELY(numFields > PMAX)) {
+    csound->Warning(csound, Str("score event with %ld p-fields dropped, "
+                                "the limit is %d"), numFields, PMAX);
+    return NULL;
+  }
+  argsize = (int32_t) (sizeof(MYFLT)*(numFields+2));
   memcpy(&args[2], pfields, argsize - sizeof(MYFLT)*2);
   args[0] = (MYFLT) type;
   args[1] = numFields;
@@ -317,6 +346,27 @@ static inline int64_t *csoundScoreEventAbsolute_enqueue(CSOUND *csound, char typ
   return message_enqueue(csound,SCORE_EVENT_ABS, args, argsize);
 }
 
+static inline int64_t *csoundScoreEventAtSample_enqueue(CSOUND *csound,
+                                                        char type,
+                                                        const MYFLT *pfields,
+                                                        long numFields,
+                                                        int64_t sample)
+{
+  char args[ARG_ALIGN*2 + sizeof(MYFLT)*PMAX];
+  int32_t n = (int32_t) numFields, argsize;
+  if (UNLIKELY(numFields > PMAX)) {
+    csound->Warning(csound, Str("score event with %ld p-fields dropped, "
+                                "the limit is %d"), numFields, PMAX);
+    return NULL;
+  }
+  argsize = (int32_t) (ARG_ALIGN*2 + sizeof(MYFLT)*n);
+  memcpy(args, &sample, sizeof(int64_t));
+  args[ARG_ALIGN] = type;
+  memcpy(args + ARG_ALIGN + 4, &n, sizeof(int32_t));
+  memcpy(args + 2*ARG_ALIGN, pfields, sizeof(MYFLT)*n);
+  return message_enqueue(csound, SCORE_EVENT_SAMPLE, args, argsize);
+}
+
 /* this is to be called from
    csoundKillInstanceInternal() in insert.c
 */
@@ -467,6 +517,15 @@ void csoundScoreEventAbsoluteAsync(CSOUND *csound, char type,
   csoundScoreEventAbsolute_enqueue(csound, type, pfields, numFields, time_ofs);
 }
 
+/* schedules an event at an absolute engine time in samples;
+   p2 is added on top, and times already passed start immediately */
+void csoundScoreEventAtSampleAsync(CSOUND *csound, char type,
+                                   const MYFLT *pfields, long numFields,
+                                   int64_t sample)
+{
+  csoundScoreEventAtSample_enqueue(csound, type, pfields, numFields, sample);
+}
+
 int32_t csoundCompileTreeAsync(CSOUND *csound, TREE *root) {
   int32_t async = 1;
   return csoundCompileTreeInternal(csound, root, async);
@@ -157,7 +157,7 @@ static const uint32_t PHMASK = (1 << 24) - 1;
 #define LBUFSIZ   32768
   
   typedef int32_t (*SUBR)(CSOUND *, void *); 
-  enum {FFT_LIB=0, PFFT_LIB, VDSP_LIB};
+  enum {FFT_LIB=0, PFFT_LIB, VDSP_LIB, PFFTD_LIB};
   enum {FFT_FWD=0, FFT_INV};
   
 #ifdef __cplusplus
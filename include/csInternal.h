@@ -136,6 +136,7 @@ extern "C" {
     int32_t size;
     int32_t flag;
     struct osc_mess *nxt;
+    int32_t capacity;   /* bytes allocated for data, address and type */
   } OSC_MESS;
 
   typedef struct eventnode {
@@ -28,6 +28,19 @@
 extern "C" {
 #endif
   typedef void CS_PERF_THREAD;
+  typedef void CS_PERF_THREAD_POOL;
+
+  /**
+     Aggregate load statistics of a performance thread pool.
+  */
+  typedef struct {
+    int32_t numThreads;       /* worker threads */
+    int32_t numInstances;     /* performances attached to the pool */
+    double  blocks;           /* k-cycles performed */
+    double  missedDeadlines;  /* k-cycles finished after their deadline */
+    double  maxLateness;      /* worst lateness of a k-cycle, in seconds */
+    double  load;             /* busy time over available worker time */
+  } CS_PERF_THREAD_POOL_STATS;
 
   /**
      Runs Csound in a separate thread.
@@ -168,6 +181,46 @@ extern "C" {
   */
   PUBLIC void csoundPerformanceThreadFlushMessageQueue(CS_PERF_THREAD* pt);
 
+  /**
+     Creates a pool of numThreads worker threads that run any number of
+     Csound performances. If realtime is non-zero, the performances are
+     paced to their nominal sample rate, otherwise they run as fast
+     as possible.
+  */
+  PUBLIC CS_PERF_THREAD_POOL* csoundCreatePerformanceThreadPool(
+    int32_t numThreads, int32_t realtime);
+
+  /**
+     Destroys a performance thread pool. All the performances it runs
+     must have been joined first.
+  */
+  PUBLIC void csoundDestroyPerformanceThreadPool(CS_PERF_THREAD_POOL* pool);
+
+  /**
+     Like csoundCreatePerformanceThread(), but the performance is run
+     by the worker threads of pool. Instances with a higher priority
+     are served first.
+  */
+  PUBLIC CS_PERF_THREAD* csoundCreatePooledPerformanceThread(CSOUND *csound,
+    CS_PERF_THREAD_POOL* pool, int32_t priority);
+
+  /**
+     Changes the priority of a performance run by pool.
+  */
+  PUBLIC void csoundPerformanceThreadPoolSetPriority(CS_PERF_THREAD_POOL* pool,
+    CS_PERF_THREAD* pt, int32_t priority);
+
+  /**
+     Gets the aggregate load statistics of pool.
+  */
+  PUBLIC void csoundPerformanceThreadPoolGetStats(CS_PERF_THREAD_POOL* pool,
+    CS_PERF_THREAD_POOL_STATS *stats);
+
+  /**
+     Resets the load statistics of pool.
+  */
+  PUBLIC void csoundPerformanceThreadPoolResetStats(CS_PERF_THREAD_POOL* pool);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -26,11 +26,16 @@
 
 class CsoundPerformanceThreadMessage;
 class CsPerfThread_PerformScore;
+class CsPerfThreadPool_Worker;
+class CsoundPerformanceThreadPool;
+struct CsPerfThreadQueue;
+struct CsPerfThreadPoolData;
 
 #ifdef SWIG
 %include <std_string.i>
 #else
 #include <string>
+#include "csPerfThread.h"
 #endif
 
 /**
@@ -113,13 +118,12 @@ typedef struct {
 class PUBLIC CsoundPerformanceThread {
  private:
     CSOUND  *csound;
-    volatile CsoundPerformanceThreadMessage *firstMessage;
-    CsoundPerformanceThreadMessage *lastMessage;
-    void    *queueLock;         // this is actually a mutex
+    CsPerfThreadQueue *queue;   // lock-free message FIFO and message pool
     void    *pauseLock;
     void    *flushLock;
     void    *recordLock;
     void    *perfThread;
+    CsoundPerformanceThreadPool *pool;  // non-NULL if run by a thread pool
     int32_t     paused;
     int32_t     status;
     void    *cdata;
@@ -127,8 +131,18 @@ class PUBLIC CsoundPerformanceThread {
     int32_t  running;
     void (*processcallback)(void *cdata);
     int32_t  Perform();
-    void csPerfThread_constructor(CSOUND *);
+    int32_t  ProcessMessages();
+    bool     HasMessages();
+    int32_t  PerformBlock();
+    void     EndPerformance(int32_t retval);
+    void csPerfThread_constructor(CSOUND *,
+                                  CsoundPerformanceThreadPool * = NULL,
+                                  int32_t priority = 0);
+    void csPerfThread_createQueue();
     void QueueMessage(CsoundPerformanceThreadMessage *);
+    CsoundPerformanceThreadMessage *TakeMessages();
+    void RetireMessage(CsoundPerformanceThreadMessage *);
+    void ReclaimMessages();
  public:
 #ifdef SWIGPYTHON
   PyThreadState *_tstate;
@@ -241,10 +255,74 @@ class PUBLIC CsoundPerformanceThread {
     CsoundPerformanceThread(Csound *);
     CsoundPerformanceThread(Csound &);
     CsoundPerformanceThread(CSOUND *);
+    /**
+     * Creates a performance that does not get a thread of its own, but is
+     * run by the worker threads of 'pool' (see CsoundPerformanceThreadPool).
+     * All other methods behave as for a stand-alone performance thread.
+     */
+    CsoundPerformanceThread(CSOUND *, CsoundPerformanceThreadPool *pool,
+                            int32_t priority = 0);
     ~CsoundPerformanceThread();
     // --------
     friend class CsoundPerformanceThreadMessage;
     friend class CsPerfThread_PerformScore;
+    friend class CsoundPerformanceThreadPool;
+};
+
+/**
+ * CsoundPerformanceThreadPool(int32_t numThreads, bool realtime)
+ *
+ * Runs any number of Csound performances on a fixed set of worker
+ * threads, instead of one thread per instance. Performances are added by
+ * constructing a CsoundPerformanceThread with the pool as argument, and
+ * keep the message, record and callback interface of stand-alone
+ * performance threads.
+ *
+ * Each k-cycle of an instance has a deadline, one ksmps period after the
+ * previous one. Workers always pick the ready instance with the highest
+ * priority and, among those, the earliest deadline; messages sent to
+ * paused instances are handled before anything else. If 'realtime' is
+ * true, a k-cycle is not started before its period begins, so instances
+ * run at their nominal sample rate; otherwise they run as fast as the
+ * workers allow, and an instance only gets worker time when no instance
+ * of higher priority is ready.
+ *
+ * All performances must have been joined before the pool is destroyed.
+ */
+
+class PUBLIC CsoundPerformanceThreadPool {
+ private:
+    CsPerfThreadPoolData *data;
+    void Attach(CsoundPerformanceThread *, int32_t priority);
+    void Detach(CsoundPerformanceThread *);
+    void Wake();
+    void Worker();
+ public:
+    /**
+     * Returns the number of worker threads.
+     */
+    int32_t GetNumThreads();
+    /**
+     * Returns the number of performances currently attached to the pool.
+     */
+    int32_t GetNumInstances();
+    /**
+     * Changes the scheduling priority of a performance in this pool;
+     * higher values are served first.
+     */
+    void SetPriority(CsoundPerformanceThread *pt, int32_t priority);
+    /**
+     * Fills 'stats' with the aggregate load statistics of the pool,
+     * collected since it was created or ResetStatistics() was called.
+     */
+    void GetStatistics(CS_PERF_THREAD_POOL_STATS *stats);
+    void ResetStatistics();
+    // --------
+    CsoundPerformanceThreadPool(int32_t numThreads, bool realtime = false);
+    ~CsoundPerformanceThreadPool();
+    // --------
+    friend class CsoundPerformanceThread;
+    friend class CsPerfThreadPool_Worker;
 };
 
 
@@ -254,6 +254,22 @@ extern "C" {
     int32_t     mp3_mode;
     /* instr redefinition flag */
     int32_t     redef;
+    /* fuse a-rate expressions flag */
+    int32_t     expr_fuse;
+    /* accuracy of the a-rate math functions: exact, ulp or fast */
+    int32_t     math_accuracy;
+    /* perform the instances of an instrument in lockstep */
+    int32_t     lockstep;
+    /* keep pvsanal frames split into amplitudes and frequencies */
+    int32_t     pvs_split;
+    /* megabytes of sound file pages shared by diskin2, 0 for none */
+    int32_t     diskin_cache;
+    /* diskin2 sinc interpolation from shared polyphase tables */
+    int32_t     diskin_sinc_tables;
+    /* megabytes of decoded compressed sound files kept, 0 for none */
+    int32_t     decode_cache;
+    /* render oscillator and grain banks in vector lanes */
+    int32_t     vector_lanes;
   } OPARMS;
  
   /**
@@ -134,6 +134,7 @@ typedef struct instr {
   int32_t instcnt;               /* Count number of instances ever */
   int32_t isNew;                 /* is this a new definition */
   int32_t nocheckpcnt;           /* Control checks on pcnt */
+  int32_t lockstep;              /* 1 may run in lockstep, -1 not, 0 unknown */
 } INSTRTXT;
 
 /**
@@ -1375,11 +1376,26 @@ struct CSOUND_ {
   int32_t (*Sprintf)(char *str, const char *format, ...);
   int32_t (*Sscanf)(char *str, const char *format, ...);
   /**@}*/
+  /** @name Decoded sound files */
+  /**@{ */
+  SNDMEMFILE *(*DecodedSoundFile)(CSOUND *, const char *fullName,
+                                  int32_t wait, const char *decoder,
+                                  SNDMEMFILE *(*decode)(CSOUND *,
+                                                        const char *,
+                                                        size_t));
+  void (*ReleaseDecodedSoundFile)(CSOUND *, SNDMEMFILE *);
+  /**@}*/
+  /** @name FFT setups owned by an opcode */
+  /**@{ */
+  void *(*RealFFTSetupFor)(CSOUND *, int32_t FFTsize, int32_t d, OPDS *owner);
+  void *(*DCTSetupFor)(CSOUND *, int32_t FFTsize, int32_t d, OPDS *owner);
+  void (*ReleaseFFTSetups)(CSOUND *, OPDS *owner);
+  /**@}*/
   /** @name Placeholders
       To allow the API to grow while maintining backward binary compatibility.
    */
   /**@{ */
-  SUBR dummyfn_2[40];
+  SUBR dummyfn_2[35];
   /**@}*/
 #ifdef __BUILDING_LIBCSOUND
   /* ------- private data (not to be used by hosts or externals) ------- */
@@ -183,6 +183,13 @@ extern "C" {
   /** Waits up on a conditional variable and mutex */
   PUBLIC void csoundCondWait(void* condVar, void* mutex);
 
+  /**
+   * As csoundCondWait(), but returns after at most the given number of
+   * microseconds; returns zero if signalled, non-zero on a timeout.
+   */
+  PUBLIC int32_t csoundCondWaitTimeout(void* condVar, void* mutex,
+                                       size_t microseconds);
+
   /** Signals a conditional variable */
   PUBLIC void csoundCondSignal(void* condVar);
 
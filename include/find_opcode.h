@@ -32,4 +32,11 @@ PUBLIC OENTRY* find_opcode_exact(CSOUND* csound, char* opname,
 /* find OENTRY with the specified name in opcode list */
 
 OENTRY* find_opcode(CSOUND *, char *);
+
+/* entries for a short name: the instance's own list, else the built-in one */
+CONS_CELL *opcode_list_find(CSOUND *, const char *);
+/* every name's entry list, in a cons list to free with cs_cons_free() */
+CONS_CELL *opcode_list_values(CSOUND *);
+/* copy of a shared built-in entry that this instance may modify */
+OENTRY *opcode_list_unshare(CSOUND *, OENTRY *);
 #endif
@@ -214,6 +214,18 @@ public:
     return (fftp)RealFFTSetup(this, size, direction);
   }
 
+  /** FFT setup belonging to an opcode: asking again from the same
+      opcode returns the same setup. Its deinit must hand it back
+      with release_fft_setups().
+   */
+  fftp fft_setup(uint32_t size, uint32_t direction, OPDS *owner) {
+    return (fftp)RealFFTSetupFor(this, size, direction, owner);
+  }
+
+  /** Hands back the FFT setups of an opcode
+   */
+  void release_fft_setups(OPDS *owner) { ReleaseFFTSetups(this, owner); }
+
   /** FFT operation, in-place, but also
       returning a pointer to std::complex<MYFLT>
       to the transformed data memory.
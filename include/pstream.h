@@ -24,6 +24,8 @@
 #ifndef __PSTREAM_H_INCLUDED
 #define __PSTREAM_H_INCLUDED
 
+#include <stddef.h>
+
 /* pstream.h.  Implementation of PVOCEX streaming opcodes.
    (c) Richard Dobson August 2001
    NB pvoc routines based on CARL distribution (Mark Dolson).
@@ -32,13 +34,20 @@
 
 /* opcodes:     PROVISIONAL DEFINITIONS
 
-  fsig      pvsanal ain,ifftsize,ioverlap,iwinsize,iwintype[,iformat,iinit]
+  fsig      pvsanal ain,ifftsize,ioverlap,iwinsize,iwintype[,iformat,iinit,
+                    ithreads,ilowbin,ihighbin]
 
     iwintype:   0 =  HAMMING, 1 =  VonHann, 2 = Kaiser(?)
     iformat:    only PVS_AMP_FREQ (0) supported at present
                 (TODO: add f-table support for custom window)
                 ( But: really need a param to associate with the window too,
                        or just use a standard default value...)
+    ithreads:   sliding (SDFT) case only: parts to split the bins into,
+                all but one done by worker threads the engine keeps for
+                all such analyses (default 0, the caller's alone)
+    ilowbin, ihighbin:
+                sliding case only: the bins analysed, the others left
+                at 0 (default all)
 
   fsig      pvsfread ktimpt,ifn[,ichan]
 
@@ -90,8 +99,14 @@ struct pvsdat {
         uint32          framecount;
         AUXCH           frame;          /* RWD MUST always be 32bit floats */
                                         /* But not in sliding case when MYFLT */
+        AUXCH           split;          /* split frame, see pvsplit.h */
+        uint32          splitcount;     /* framecount split was written for */
 };
 
+/* the leading bytes of a PVSDAT that copies of its header take, leaving
+   out the memory it owns */
+#define PVSDAT_HEADER   offsetof(PVSDAT, frame)
+
 /* may be no point supporting Kaiser in an opcode unless we can support
    the param too but we can have kaiser in a PVOCEX file. */
 
@@ -105,6 +120,8 @@ typedef struct {
         MYFLT   *wintype;
         MYFLT   *format;                /* always PVS_AMP_FREQ at present */
         MYFLT   *init;                  /* not yet implemented */
+        MYFLT   *threads;               /* SDFT: threads to share the bins */
+        MYFLT   *lobin, *hibin;         /* SDFT: the bins analysed */
         /* internal */
         int32    buflen;
         float   fund,arate;
@@ -121,6 +138,7 @@ typedef struct {
         AUXCH           trig;
         double          *cosine, *sine;
         void    *setup;
+        AUXCH   sdft;           /* SDFT: state of the bins, in parts */
 } PVSANAL;
 
 typedef struct {
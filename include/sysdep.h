@@ -558,7 +558,10 @@ typedef int32_t spin_lock_t;
 
 #elif defined(__GNUC__) && defined(HAVE_PTHREAD_SPIN_LOCK)
 typedef pthread_spinlock_t spin_lock_t;
-#define SPINLOCK_INIT PTHREAD_SPINLOCK_INITIALIZER
+/* only a placeholder: the unlocked value of a pthread spinlock is not
+   portable (it is 1 on x86 glibc), so these must be set up with
+   csoundSpinLockInit() and cannot be initialised statically */
+#define SPINLOCK_INIT 0
 #elif defined(__GNUC__) && defined(HAVE_ATOMIC_BUILTIN)
 typedef char spin_lock_t;
 #define SPINLOCK_INIT 0
@@ -568,6 +571,20 @@ typedef int32_t spin_lock_t;
 #define SPINLOCK_INIT 0
 #endif
 
+/* a lock for process-wide data, which can be initialised statically */
+#if !defined(WIN32) && !defined(MACOSX) && \
+    defined(__GNUC__) && defined(HAVE_PTHREAD_SPIN_LOCK)
+typedef pthread_mutex_t static_lock_t;
+#define STATIC_LOCK_INIT PTHREAD_MUTEX_INITIALIZER
+#define csoundStaticLock(l) pthread_mutex_lock(l)
+#define csoundStaticUnLock(l) pthread_mutex_unlock(l)
+#else
+typedef spin_lock_t static_lock_t;
+#define STATIC_LOCK_INIT SPINLOCK_INIT
+#define csoundStaticLock(l) csoundSpinLock(l)
+#define csoundStaticUnLock(l) csoundSpinUnLock(l)
+#endif
+
 #if (defined(__MACH__) || defined(ANDROID) || defined(NACL) \
   || defined(__CYGWIN__) || defined(__HAIKU__))
 #include <pthread.h>
@@ -0,0 +1,251 @@
+/*
+ * File:   csound_benchmarks.cpp
+ *
+ * Timings of the optimised paths against the ones they replace. These are
+ * not tests: the unit tests check that both paths agree, this only reports
+ * how long each takes. Run with no arguments for every benchmark, or with
+ * names to run only those.
+ */
+
+#define __BUILDING_LIBCSOUND
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include "csoundCore.h"
+#include "vecops.h"
+#include "csound_render_helpers.h"
+
+template <typename F> static double seconds (F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                         - start).count();
+}
+
+static double compileSeconds (const std::string &orc, const char *threads)
+{
+    CSOUND *cs = csoundCreate (NULL, NULL);
+    csoundSetOption (cs, "-n --logfile=null");
+    csoundSetOption (cs, threads);
+    double t = seconds ([&] { csoundCompileOrc (cs, orc.c_str(), 0); });
+    csoundDestroy (cs);
+    return t;
+}
+
+static void parallelVerify (void)
+{
+    std::string orc = bigOrchestra (400);
+    printf ("compiling %zu bytes: -j1 %.3fs, -j4 %.3fs\n", orc.size(),
+            compileSeconds (orc, "-j1"), compileSeconds (orc, "-j4"));
+}
+
+static void fftBackends (void)
+{
+    const int32_t sizes[] = { 1024, 4096, 1536 };
+    const int32_t libs[] = { FFT_LIB, PFFT_LIB, PFFTD_LIB };
+    CSOUND *csound = csoundCreate (NULL, NULL);
+    csoundSetOption (csound, "-n --logfile=null");
+    csoundStart (csound);
+    for (int32_t size : sizes) {
+      std::vector<MYFLT> sig(size + 2);
+      for (int32_t i = 0; i < size; i++)
+        sig[i] = sin(i * 0.37) + 0.3 * cos(i * 1.1);
+      for (int32_t lib : libs) {
+        csound->oparms->fft_lib = lib;
+        void *fwd = csound->RealFFTSetup (csound, size, FFT_FWD);
+        void *inv = csound->RealFFTSetup (csound, size, FFT_INV);
+        double t = seconds ([&] {
+            for (int32_t k = 0; k < 1000; k++) {
+              csound->RealFFT (csound, fwd, sig.data());
+              csound->RealFFT (csound, inv, sig.data());
+            }
+          });
+        printf ("fftlib=%d N=%d: %.1f us/pair\n", lib, size, t * 1000);
+      }
+    }
+    csoundDestroy (csound);
+}
+
+static void createInstance (void)
+{
+    const char *file = "plugin_manifest_bench.txt";
+    auto create = [] { csoundDestroy (csoundCreate (NULL, NULL)); };
+    remove (file);
+    double t0 = seconds (create);
+    csoundSetGlobalEnv ("CS_PLUGIN_MANIFEST", file);
+    double t1 = seconds (create);       /* loads everything, writes file */
+    double t2 = seconds (create);       /* defers opcode libraries */
+    csoundSetGlobalEnv ("CS_PLUGIN_MANIFEST", NULL);
+    remove (file);
+    printf ("csoundCreate: %.1f ms, manifest cold %.1f ms, warm %.1f ms\n",
+            t0 * 1000, t1 * 1000, t2 * 1000);
+}
+
+static void vectorKernels (void)
+{
+    const uint32_t n = 64;
+    std::vector<MYFLT> a(n), b(n), r(n);
+    for (uint32_t i = 0; i < n; i++) {
+      a[i] = sin(i * 0.37) + 2;
+      b[i] = cos(i * 1.1) + 2;
+    }
+    for (int32_t level = VECOPS_SCALAR; level <= VECOPS_NEON; level++) {
+      const VECOPS *v = csoundVecOpsLevel (level);
+      if (v == NULL)
+        continue;
+      const std::pair<const char *, std::function<void()> > ops[] = {
+        { "add",  [&] { v->add (r.data(), a.data(), b.data(), n); } },
+        { "mul",  [&] { v->mul (r.data(), a.data(), b.data(), n); } },
+        { "div",  [&] { v->div (r.data(), a.data(), b.data(), n); } },
+        { "mulk", [&] { v->mulk (r.data(), a.data(), b[5], n); } },
+        { "sqrt", [&] { v->sqrtv (r.data(), a.data(), n); } }
+      };
+      for (const auto &op : ops) {
+        double t = seconds ([&] {
+            for (int32_t j = 0; j < 20000; j++)
+              op.second ();
+          });
+        printf ("%-6s %-4s %.3f ns/sample\n", v->name, op.first,
+                t * 1e9 / (20000 * n));
+      }
+    }
+}
+
+static void vectorMath (void)
+{
+    typedef void (*MATHFN)(MYFLT *, const MYFLT *, uint32_t);
+    const std::pair<const char *, MATHFN VECMATH::*> fns[] = {
+      { "exp", &VECMATH::expv }, { "log", &VECMATH::logv },
+      { "sin", &VECMATH::sinv }, { "tanh", &VECMATH::tanhv }
+    };
+    std::vector<MYFLT> a(256), r(256);
+    for (uint32_t i = 0; i < 256; i++)
+      a[i] = 0.01 + i * 0.03;
+    for (const auto &f : fns)
+      for (int32_t acc = VECMATH_EXACT; acc <= VECMATH_FAST; acc++) {
+        const VECMATH *vm = csoundVecMath (acc);
+        double t = seconds ([&] {
+            for (int32_t j = 0; j < 2000; j++)
+              (vm->*f.second) (r.data(), a.data(), 256);
+          });
+        printf ("%-5s %-5s %.3f ns/sample\n", vm->name, f.first,
+                t * 1e9 / (2000 * 256));
+      }
+}
+
+static void lockstep (void)
+{
+    const char *voice = "a2 oscili 0.1, p4\n"
+      "a3 linseg 0, 0.05, 1, 0.1, 0.5\n"
+      "a1 moogladder a2 * a3, 2000, 0.5";
+    double t = seconds ([&] { renderVoices (voice, 64, 400); });
+    double tl = seconds ([&] { renderVoices (voice, 64, 400, "--lockstep"); });
+    printf ("64 voices: one at a time %.3fs, lockstep %.3fs\n", t, tl);
+}
+
+static void filterBanks (void)
+{
+    std::string freqs, qs, sections;
+    char line[128];
+    for (int32_t l = 0; l < 32; l++) {
+      double f = 100.0 * pow(1.12, l), q = 4.0 + l % 5;
+      snprintf (line, sizeof(line), "%s%g", l ? ", " : "", f);
+      freqs += line;
+      snprintf (line, sizeof(line), "%s%g", l ? ", " : "", q);
+      qs += line;
+      snprintf (line, sizeof(line), "a1 += butbp(an, %g, %g)\n", f, f / q);
+      sections += line;
+    }
+    std::string arrays = "an noise 0.5, 0\nkf[] fillarray " + freqs +
+      "\nkq[] fillarray " + qs + "\n";
+    double tb = seconds ([&] {
+        renderOpcode (arrays + "a1 bqbank an, kf, kq", 300); });
+    double ts = seconds ([&] {
+        renderOpcode (arrays + "a1 = 0\n" + sections, 300); });
+    printf ("32 bandpass sections: bqbank %.3fs, butbp %.3fs\n", tb, ts);
+}
+
+static void pvsSplitFrames (void)
+{
+    for (int32_t n = 512; n <= 8192; n *= 2) {
+      char body[512];
+      snprintf (body, sizeof(body), "an noise 0.5, 0\n"
+                "fa pvsanal an, %d, %d, %d, 1\n"
+                "fb pvscale fa, 1.5\n"
+                "fc pvsmooth fb, 0.1, 0.2\n"
+                "fd pvsfilter fc, fa, 0.5\n"
+                "fe pvsgain fd, 0.8\n"
+                "ff pvsmix fe, fa\n"
+                "a1 pvsynth ff", n, n / 4, n);
+      double ts = seconds ([&] { renderOpcode (body, 600, "--pvs-split"); });
+      double ti = seconds ([&] { renderOpcode (body, 600); });
+      printf ("pvs chain, %d point frames: split %.3fs, interleaved %.3fs\n",
+              n, ts, ti);
+    }
+}
+
+static void slidingAnalysis (void)
+{
+    const char *fmt = "a2 oscili 0.5, 440\n"
+      "fa pvsanal a2, 1024, 32, 1024, 1, 0, 0, %d, %d, %d\n"
+      "a1 pvsynth fa";
+    char b1[256], b4[256], bb[256];
+    snprintf (b1, sizeof(b1), fmt, 0, 0, -1);
+    snprintf (b4, sizeof(b4), fmt, 4, 0, -1);
+    snprintf (bb, sizeof(bb), fmt, 0, 5, 15);
+    double t1 = seconds ([&] { renderOpcode (b1, 100); });
+    double t4 = seconds ([&] { renderOpcode (b4, 100); });
+    double tb = seconds ([&] { renderOpcode (bb, 100); });
+    printf ("sliding pvsanal, 1024 point frames: %.3fs, 4 threads %.3fs, "
+            "bins 5 to 15 %.3fs\n", t1, t4, tb);
+}
+
+static void diskinVoices (void)
+{
+    const char *file = "diskin2_pages_bench.wav";
+    renderOpcode (std::string("a1 oscili 0.5, 441\nfout \"") + file +
+                  "\", 16, a1", 1400);
+    std::string body = "a1 = 0\n";
+    for (int32_t i = 0; i < 64; i++)
+      body += "ax diskin2 \"" + std::string(file) + "\", " +
+        std::to_string(0.5 + i / 32.0) + ", " + std::to_string(i / 64.0) +
+        ", 1, 0, 32\na1 = a1 + ax / 64\n";
+    double tc = seconds ([&] { renderOpcode (body, 1000); });
+    double tn = seconds ([&] { renderOpcode (body, 1000, "--diskin-cache=0"); });
+    double tt = seconds ([&] {
+        renderOpcode (body, 1000, "--diskin-sinc-tables");
+      });
+    printf ("diskin2, 64 voices of one file: shared pages %.3fs, "
+            "own buffers %.3fs, sinc tables %.3fs\n", tc, tn, tt);
+    remove (file);
+}
+
+int main (int argc, char **argv)
+{
+    const std::pair<const char *, void (*)(void)> benchmarks[] = {
+      { "parallel-verify", parallelVerify },
+      { "fft-backends", fftBackends },
+      { "create", createInstance },
+      { "vector-kernels", vectorKernels },
+      { "vector-math", vectorMath },
+      { "lockstep", lockstep },
+      { "filter-banks", filterBanks },
+      { "pvs-split", pvsSplitFrames },
+      { "sliding-pvsanal", slidingAnalysis },
+      { "diskin2", diskinVoices }
+    };
+    for (const auto &b : benchmarks) {
+      bool run = argc < 2;
+      for (int i = 1; i < argc; i++)
+        run = run || !strcmp (argv[i], b.first);
+      if (run)
+        b.second ();
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * File:   csound_fft_test.cpp
+ *
+ * FFT setups, plan sharing and backends.
+ */
+
+#define __BUILDING_LIBCSOUND
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include "csoundCore.h"
+#include "gtest/gtest.h"
+
+class FFTTests : public ::testing::Test {
+public:
+    FFTTests ()
+    {
+    }
+
+    virtual ~FFTTests ()
+    {
+    }
+
+    virtual void SetUp ()
+    {
+        csound = csoundCreate (NULL,NULL);
+        csoundSetOption (csound, "--logfile=null");
+    }
+
+    virtual void TearDown ()
+    {
+        csoundDestroy (csound);
+        csound = nullptr;
+    }
+
+    CSOUND* csound {nullptr};
+};
+
+TEST_F (FFTTests, testFFTPlanCache)
+{
+    csoundSetOption (csound, "-n --fftlib=1");
+    ASSERT_EQ (0, csoundStart (csound));
+    CSOUND_FFT_SETUP *fwd =
+      (CSOUND_FFT_SETUP *) csound->RealFFTSetup (csound, 1024, FFT_FWD);
+    CSOUND_FFT_SETUP *inv =
+      (CSOUND_FFT_SETUP *) csound->RealFFTSetup (csound, 1024, FFT_INV);
+    /* separate setups, with their own scratch, share one plan */
+    ASSERT_NE (fwd, inv);
+    ASSERT_NE (fwd->buffer, inv->buffer);
+    ASSERT_EQ (fwd->setup, inv->setup);
+
+    MYFLT sig[1024], orig[1024];
+    for (int32_t i = 0; i < 1024; i++)
+      orig[i] = sig[i] = (MYFLT) ((i * 37) % 101) / 101.0;
+    csound->RealFFT (csound, fwd, sig);
+    csound->RealFFT (csound, inv, sig);
+    for (int32_t i = 0; i < 1024; i++)
+      ASSERT_NEAR (orig[i], sig[i], 1e-4);
+}
+
+TEST_F (FFTTests, testFFTSetupOwners)
+{
+    csoundSetOption (csound, "-n --fftlib=1");
+    ASSERT_EQ (0, csoundStart (csound));
+    OPDS a, b;
+    void *fa = csound->RealFFTSetupFor (csound, 512, FFT_FWD, &a);
+    void *fb = csound->RealFFTSetupFor (csound, 512, FFT_FWD, &b);
+    /* each opcode keeps its own scratch, and gets it back on reinit */
+    ASSERT_NE (fa, fb);
+    ASSERT_EQ (fa, csound->RealFFTSetupFor (csound, 512, FFT_FWD, &a));
+    /* unowned setups are never handed out twice */
+    ASSERT_NE (csound->RealFFTSetup (csound, 512, FFT_FWD),
+               csound->RealFFTSetup (csound, 512, FFT_FWD));
+    csound->ReleaseFFTSetups (csound, &a);
+    /* a setup handed back goes to the next opcode asking for it */
+    OPDS c;
+    ASSERT_EQ (fa, csound->RealFFTSetupFor (csound, 512, FFT_FWD, &c));
+    ASSERT_NE (fa, csound->RealFFTSetupFor (csound, 512, FFT_INV, &c));
+    csound->ReleaseFFTSetups (csound, &c);
+    void *d = csound->DCTSetupFor (csound, 64, FFT_FWD, &a);
+    ASSERT_EQ (d, csound->DCTSetupFor (csound, 64, FFT_FWD, &a));
+    ASSERT_EQ (fb, csound->RealFFTSetupFor (csound, 512, FFT_FWD, &b));
+    csound->ReleaseFFTSetups (csound, &a);
+    csound->ReleaseFFTSetups (csound, &b);
+
+    /* opcodes release their setups when the note ends */
+    const char *orc =
+      "instr 1\n"
+      "kin[] init 256\n"
+      "kin[3] = p4\n"
+      "kout[] rfft kin\n"
+      "kback[] rifft kout\n"
+      "kc[] dct kin\n"
+      "endin\n";
+    ASSERT_EQ (0, csoundCompileOrc (csound, orc, 0));
+    for (int32_t i = 0; i < 20; i++) {
+      char sco[64];
+      snprintf (sco, sizeof (sco), "i1 %f 0.01 %d\n", i * 0.005, i);
+      csoundEventString (csound, sco, 0);
+    }
+    for (int32_t i = 0; i < 1000; i++)
+      csoundPerformKsmps (csound);
+}
+
+TEST_F (FFTTests, testFFTBackends)
+{
+    const int32_t sizes[] = { 1024, 4096, 1536 };
+    const int32_t libs[] = { FFT_LIB, PFFT_LIB, PFFTD_LIB };
+    csoundSetOption (csound, "-n");
+    ASSERT_EQ (0, csoundStart (csound));
+    for (int32_t size : sizes) {
+      std::vector<MYFLT> orig(size + 2), ref(size + 2), sig(size + 2);
+      for (int32_t i = 0; i < size; i++)
+        orig[i] = sin(i * 0.37) + 0.3 * cos(i * 1.1);
+      for (int32_t lib : libs) {
+        csound->oparms->fft_lib = lib;
+        void *fwd = csound->RealFFTSetup (csound, size, FFT_FWD);
+        void *inv = csound->RealFFTSetup (csound, size, FFT_INV);
+        MYFLT diff = 0, err = 0;
+        sig = orig;
+        csound->RealFFT (csound, fwd, sig.data());
+        if (lib == FFT_LIB)
+          ref = sig;
+        for (int32_t i = 0; i < size + 2; i++)
+          diff = std::max(diff, (MYFLT) fabs(sig[i] - ref[i]));
+        csound->RealFFT (csound, inv, sig.data());
+        for (int32_t i = 0; i < size; i++)
+          err = std::max(err, (MYFLT) fabs(sig[i] - orig[i]));
+        if (lib == PFFTD_LIB && sizeof(MYFLT) == sizeof(double)) {
+          ASSERT_LT (diff, 1e-9) << "N=" << size;
+          ASSERT_LT (err, 1e-12) << "N=" << size;
+        }
+      }
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * File:   csound_opcode_table_test.cpp
+ *
+ * The shared built-in opcode table and the deferred plugin manifest.
+ */
+
+#define __BUILDING_LIBCSOUND
+
+#include <stdio.h>
+#include "csoundCore.h"
+#include "gtest/gtest.h"
+
+static int32_t createAndList (void)
+{
+    opcodeListEntry *lst;
+    CSOUND *cs = csoundCreate (NULL, NULL);
+    csoundSetOption (cs, "-n --logfile=null");
+    EXPECT_EQ (0, csoundCompileOrc (cs, "instr 1\n"
+                                    "a1 oscili 0.5, 440\n"
+                                    "out a1\n"
+                                    "endin\n", 0));
+    EXPECT_EQ (0, csoundStart (cs));
+    int32_t count = csoundNewOpcodeList (cs, &lst);
+    csoundDisposeOpcodeList (cs, lst);
+    csoundDestroy (cs);
+    return count;
+}
+
+TEST (OpcodeTableTests, testPluginManifest)
+{
+    const char *file = "plugin_manifest_test.txt";
+    remove (file);
+    int32_t n0 = createAndList ();
+    ASSERT_EQ (0, csoundSetGlobalEnv ("CS_PLUGIN_MANIFEST", file));
+    int32_t n1 = createAndList ();      /* loads everything, writes file */
+    FILE *f = fopen (file, "r");
+    ASSERT_TRUE (f != NULL) << "the manifest was not written";
+    fclose (f);
+    int32_t n2 = createAndList ();      /* defers opcode libraries */
+    csoundSetGlobalEnv ("CS_PLUGIN_MANIFEST", NULL);
+    remove (file);
+    /* deferred libraries are loaded for the opcode list */
+    ASSERT_EQ (n0, n1);
+    ASSERT_EQ (n0, n2);
+}
+
+static int32_t dummyOpcode (CSOUND *csound, void *p)
+{
+    (void) csound; (void) p;
+    return OK;
+}
+
+TEST (OpcodeTableTests, testBuiltinOpcodeTable)
+{
+    CSOUND *csound = csoundCreate (NULL, NULL);
+    CSOUND *other = csoundCreate (NULL, NULL);
+    csoundSetOption (csound, "-n --logfile=null");
+    /* built-in entries are shared */
+    ASSERT_EQ (find_opcode (csound, (char *) "oscili"),
+               find_opcode (other, (char *) "oscili"));
+    ASSERT_EQ (find_opcode (csound, (char *) "oscili.kk"),
+               find_opcode (other, (char *) "oscili"));
+    ASSERT_EQ (NULL, find_opcode (csound, (char *) "no_such_opcode"));
+    int32_t n = cs_cons_length (opcode_list_find (csound, "oscili"));
+    ASSERT_GT (n, 1);
+    /* an overload added to one instance stays there */
+    ASSERT_EQ (0, csoundAppendOpcode (csound, "oscili.test", sizeof(OPDS),
+                                      0, "k", "kkkk", dummyOpcode,
+                                      dummyOpcode, NULL));
+    ASSERT_EQ (n + 1, cs_cons_length (opcode_list_find (csound, "oscili")));
+    ASSERT_EQ (n, cs_cons_length (opcode_list_find (other, "oscili")));
+    ASSERT_NE (find_opcode (csound, (char *) "oscili"),
+               find_opcode (other, (char *) "oscili"));
+    ASSERT_EQ (0, csoundCompileOrc (csound, "instr 1\n"
+                                    "a1 oscili 0.5, 440\n"
+                                    "endin\n", 0));
+    csoundDestroy (other);
+    csoundDestroy (csound);
+}
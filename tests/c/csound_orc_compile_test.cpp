@@ -10,8 +10,15 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <math.h>
 #include "csoundCore.h"
 #include "gtest/gtest.h"
+#include "csound_render_helpers.h"
 
 #define csoundCompileOrc(a,b) csoundCompileOrc(a,b,0)
 #define csoundReadScore(a,b) csoundEventString(a,b,0)
@@ -247,4 +254,191 @@ schedule(1,6/sr,0.5)
 
 }
 
+static void compileAndRun (const std::string &orc, const char *threads,
+                           MYFLT *out, MYFLT *outnew)
+{
+    CSOUND *cs = csoundCreate (NULL, NULL);
+    csoundSetOption (cs, "-n --logfile=null");
+    csoundSetOption (cs, threads);
+    EXPECT_EQ (0, csoundCompileOrc (cs, orc.c_str()));
+    EXPECT_EQ (0, csoundStart (cs));
+    csoundEventString (cs, "i 17 0 1 0.5\ni 1000 0 1 2", 0);
+    csoundPerformKsmps (cs);
+    *out = csoundGetControlChannel (cs, "out17", NULL);
+    *outnew = csoundGetControlChannel (cs, "outnew", NULL);
+    csoundDestroy (cs);
+}
 
+TEST_F (OrcCompileTests, testParallelVerify)
+{
+    std::string orc = bigOrchestra (400);
+    MYFLT out1, out4, new1, new4;
+    compileAndRun (orc, "-j1", &out1, &new1);
+    compileAndRun (orc, "-j4", &out4, &new4);
+    ASSERT_EQ (out1, out4);
+    ASSERT_EQ (new1, new4);
+    ASSERT_EQ (3.0, new4);
+}
+
+static int32_t compileWith (const std::string &orc, const char *threads)
+{
+    CSOUND *cs = csoundCreate (NULL, NULL);
+    csoundSetOption (cs, "-n --logfile=null");
+    csoundSetOption (cs, threads);
+    int32_t result = csoundCompileOrc (cs, orc.c_str());
+    csoundDestroy (cs);
+    return result;
+}
+
+TEST_F (OrcCompileTests, testParallelVerifyErrors)
+{
+    /* a malformed body among enough others to be verified on workers */
+    std::string bad = bigOrchestra (40) +
+      "instr 2000\n"
+      "k1 = kundefined + 1\n"
+      "endin\n";
+    ASSERT_NE (0, compileWith (bad, "-j1"));
+    ASSERT_NE (0, compileWith (bad, "-j4"));
+    ASSERT_EQ (0, compileWith (bigOrchestra (40), "-j4"));
+
+    /* a global defined after the body that uses it */
+    std::string forward = bigOrchestra (40) +
+      "instr 2000\n"
+      "chnset gklater, \"later\"\n"
+      "endin\n"
+      "gklater init 1\n";
+    ASSERT_NE (0, compileWith (forward, "-j1"));
+    ASSERT_NE (0, compileWith (forward, "-j4"));
+
+    /* UDO bodies are verified on workers as well */
+    std::string badudo = bigOrchestra (40) +
+      "opcode Broken, k, k\n"
+      "kin xin\n"
+      "xout kin + kundefined\n"
+      "endop\n";
+    ASSERT_NE (0, compileWith (badudo, "-j1"));
+    ASSERT_NE (0, compileWith (badudo, "-j4"));
+
+    /* and xin and xout still have to match the signature */
+    std::string mismatch = bigOrchestra (40) +
+      "opcode Mismatch, k, k\n"
+      "kin xin\n"
+      "xout a(kin)\n"
+      "endop\n";
+    ASSERT_NE (0, compileWith (mismatch, "-j1"));
+    ASSERT_NE (0, compileWith (mismatch, "-j4"));
+}
+
+static std::vector<MYFLT> renderOpcode (const std::string &body, int32_t kcycles,
+                                        double *secs,
+                                        const char *options = NULL)
+{
+    std::string orc = "sr = 44100\nksmps = 64\nnchnls = 1\n0dbfs = 1\n"
+      "gi1 ftgen 1, 0, 4096, 10, 1\n"
+      "gi2 ftgen 2, 0, 4095, 10, 1\n"
+      "gi3 ftgen 3, 0, 4096, 20, 2, 1\n"
+      "instr 1\n" + body + "\nout a1\nendin\n";
+    std::vector<MYFLT> out;
+    CSOUND *cs = csoundCreate (NULL, NULL);
+    csoundSetOption (cs, "-n --logfile=null");
+    if (options != NULL)
+      csoundSetOption (cs, options);
+    EXPECT_EQ (0, csoundCompileOrc (cs, orc.c_str()));
+    EXPECT_EQ (0, csoundStart (cs));
+    csoundEventString (cs, "i 1 0 -1", 0);
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < kcycles; i++) {
+      csoundPerformKsmps (cs);
+      const MYFLT *spout = csoundGetSpout (cs);
+      out.insert (out.end(), spout, spout + csoundGetKsmps (cs));
+    }
+    *secs = std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                          - start).count();
+    csoundDestroy (cs);
+    return out;
+}
+
+TEST_F (OrcCompileTests, testFusedExpressions)
+{
+    std::string body = "a2 oscili 0.5, 220\n"
+      "a3 oscili 0.3, 331\n"
+      "a4 oscili 2, 3\n"
+      "k1 linseg 0, 1, 1\n"
+      "a1 = (a2*k1 + a3) * 0.5 + sin(a4)\n";
+    for (int32_t i = 0; i < 32; i++)
+      body += "a1 = a1 * 0.5 + tanh(a2 * 3 - a3 / (abs(a4) + 1)) * 0.25 "
+        "+ floor(a4 * k1) * 0.01 - sqrt(abs(a1 - a3)) % 0.5\n";
+    std::vector<MYFLT> fused = renderOpcode (body, 400, "--expression-opt");
+    std::vector<MYFLT> ref = renderOpcode (body, 400);
+    ASSERT_EQ (ref.size(), fused.size());
+    for (size_t i = 0; i < ref.size(); i++)
+      ASSERT_EQ (ref[i], fused[i]);
+}
+
+TEST_F (OrcCompileTests, testFusedExpressionsKeepUDOs)
+{
+    /* a UDO overriding a fusable function must still be called */
+    const char *orc =
+      "opcode sin, a, a\n"
+      "ain xin\n"
+      "xout ain * 2\n"
+      "endop\n"
+      "instr 1\n"
+      "a2 oscili 0.5, 220\n"
+      "a1 = sin(a2) * 0.5 + a2 - a2 * 2\n"
+      "out a1\n"
+      "endin\n";
+    for (const char *opt : { "--expression-opt", "--no-expression-opt" }) {
+      CSOUND *cs = csoundCreate (NULL, NULL);
+      csoundSetOption (cs, "-n --logfile=null --ksmps=16");
+      csoundSetOption (cs, opt);
+      ASSERT_EQ (0, csoundCompileOrc (cs, orc));
+      csoundReadScore (cs, "i1 0 1\n");
+      ASSERT_EQ (0, csoundStart (cs));
+      for (int32_t i = 0; i < 20; i++) {
+        csoundPerformKsmps (cs);
+        const MYFLT *spout = csoundGetSpout (cs);
+        /* exactly 0 through the UDO, not through the built-in sin */
+        for (int32_t n = 0; n < 16; n++)
+          ASSERT_DOUBLE_EQ (spout[n], 0.0) << opt;
+      }
+      csoundDestroy (cs);
+    }
+}
+
+TEST_F (OrcCompileTests, testDecodedSoundFileCache)
+{
+    const char *file = "decode_cache_test.flac";
+    double t;
+    /* two seconds of a 441 Hz sine, as FLAC */
+    renderOpcode (std::string("a1 oscili 0.5, 441\nfout \"") + file +
+                  "\", -1, a1", 1400, &t, "--format=flac:short");
+    FILE *f = fopen (file, "rb");
+    ASSERT_TRUE (f != NULL) << "could not write a FLAC file";
+    fclose (f);
+
+    /* GEN01 decodes the file into the cache, and diskin2, started again */
+    /* at every reinit, then reads it from the decoded frames, which     */
+    /* must hold what the pages read from disk without the cache hold    */
+    std::string body = std::string("i1 ftgen 0, 0, 0, 1, \"") + file +
+      "\", 0, 0, 0\n"
+      "k1 metro 20\n"
+      "if k1 == 1 then\n reinit again\nendif\n"
+      "again:\n"
+      "a2 diskin2 \"" + file + "\", 1.25, 0, 1\n"
+      "rireturn\n"
+      "andx phasor 44100 / ftlen(i1)\n"
+      "a3 table andx, i1, 1\n"
+      "a1 = a2 + a3\n";
+    std::vector<MYFLT> cached = renderOpcode (body, 1000, &t,
+                                              "--decode-cache=64");
+    std::vector<MYFLT> plain = renderOpcode (body, 1000, &t);
+    ASSERT_EQ (cached.size(), plain.size());
+    MYFLT peak = 0;
+    for (size_t i = 0; i < cached.size(); i++) {
+      ASSERT_EQ (cached[i], plain[i]) << "at " << i;
+      peak = std::max(peak, (MYFLT) fabs(cached[i]));
+    }
+    ASSERT_GT (peak, 0.5);
+    std::remove (file);
+}
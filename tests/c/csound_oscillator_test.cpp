@@ -0,0 +1,138 @@
+/*
+ * File:   csound_oscillator_test.cpp
+ *
+ * Oscillator banks, granular synthesis and band-limited oscillators.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include "csound.h"
+#include "gtest/gtest.h"
+#include "csound_render_helpers.h"
+
+TEST (OscillatorTests, testOscillatorBankKernels)
+{
+    /* each opcode on the same power of two table, in vector lanes and */
+    /* one oscillator at a time; only contraction into fused multiply- */
+    /* adds may tell them apart                                        */
+    const char *opcodes[] = {
+      "a1 oscbnk 220, 0, 0, 0, 1024, 1, 0, 0, 0, 0, 0, "
+      "0, 0, 0, 0, 0, 0, -1, 1",
+      "a1 grain2 440, 10, 0.05, 1000, 1, 3, 0, 12345",
+      "a1 grain3 440, 0, 10, 0.1, 0.05, 2000, 200, 1, 3, 0, 0, 12345"
+    };
+    const double eps = sizeof(MYFLT) == sizeof(double) ? 1e-12 : 1e-5;
+    for (const char *op : opcodes) {
+      std::vector<MYFLT> vec = renderOpcode (op, 200);
+      std::vector<MYFLT> ref = renderOpcode (op, 200, "--no-vector-lanes");
+      ASSERT_EQ (ref.size(), vec.size());
+      MYFLT peak = 0;
+      for (MYFLT x : ref)
+        peak = std::max (peak, (MYFLT) fabs (x));
+      ASSERT_GT (peak, 1.0) << op;
+      for (size_t i = 0; i < vec.size(); i++)
+        ASSERT_NEAR (ref[i], vec[i], eps * peak) << op << " at " << i;
+    }
+}
+
+TEST (OscillatorTests, testPartikkelGrainPasses)
+{
+    /* four waveforms and a trainlet, with fm, rendered in split phase */
+    /* and lookup passes and by the old one sample at a time loop       */
+    const char *body =
+      "iwamp ftgentmp 0, 0, 8, -2, 0, 0, 0.3, 0.2, 0.2, 0, 0.3, 0\n"
+      "afm oscili 0.3, 310\n"
+      "async = 0\n"
+      "a1 partikkel 80, 0, -1, async, 0, -1, 3, 3, 0.5, 0.5, 40, 0.5, -1, "
+      "440, 0.5, -1, -1, afm, -1, -1, 1, 220, 8, 1, -1, 0, 1, 2, 1, 1, "
+      "iwamp, async, async, async, async, 1, 1.5, 0.75, 1, 100";
+    const double eps = sizeof(MYFLT) == sizeof(double) ? 1e-12 : 1e-5;
+    std::vector<MYFLT> vec = renderOpcode (body, 300);
+    std::vector<MYFLT> ref = renderOpcode (body, 300, "--no-vector-lanes");
+    ASSERT_EQ (ref.size(), vec.size());
+    MYFLT peak = 0;
+    for (MYFLT x : ref)
+      peak = std::max (peak, (MYFLT) fabs (x));
+    ASSERT_GT (peak, 0.1);
+    for (size_t i = 0; i < vec.size(); i++)
+      ASSERT_NEAR (ref[i], vec[i], eps * peak) << "at " << i;
+}
+
+/* removes the saw tables of size points vco2init stores in the current
+   directory, and the 16 point one it adds below them */
+static void removeVco2Tables (int32_t size, int32_t lib)
+{
+    char name[64];
+    for (int32_t npart = 0; npart <= size / 2; npart++) {
+      snprintf (name, sizeof(name), "./vco2-0-%d-%d-%d-%d.tab", npart,
+                npart == 0 ? 16 : size, (int32_t) sizeof(MYFLT), lib);
+      remove (name);
+    }
+}
+
+TEST (OscillatorTests, testVco2CacheKeysFFTLibrary)
+{
+    /* saw tables of 64 points are built by no other test, so both    */
+    /* engines compute them and store one file per FFT library        */
+    const char *header = "gi1 vco2init 1, 0, 0, 64, 64\n";
+    char names[2][64];
+    for (int32_t lib = 0; lib < 2; lib++) {
+      snprintf (names[lib], sizeof(names[lib]), "./vco2-0-1-64-%d-%d.tab",
+                (int32_t) sizeof(MYFLT), lib);
+      remove (names[lib]);
+    }
+    ASSERT_EQ (0, csoundSetGlobalEnv ("CS_VCO2_CACHE", "."));
+    std::vector<MYFLT> ref = renderVoices ("a1 vco2 0.5, 20000", 1, 100,
+                                           "--fftlib=0", header);
+    std::vector<MYFLT> out = renderVoices ("a1 vco2 0.5, 20000", 1, 100,
+                                           "--fftlib=1", header);
+    csoundSetGlobalEnv ("CS_VCO2_CACHE", NULL);
+    for (int32_t lib = 0; lib < 2; lib++) {
+      FILE *f = fopen (names[lib], "rb");
+      EXPECT_TRUE (f != NULL) << names[lib] << " was not written";
+      if (f != NULL)
+        fclose (f);
+      removeVco2Tables (64, lib);
+    }
+    /* the libraries agree up to rounding */
+    ASSERT_EQ (ref.size(), out.size());
+    MYFLT peak = 0;
+    for (size_t i = 0; i < ref.size(); i++) {
+      ASSERT_NEAR (ref[i], out[i], 1e-5);
+      peak = std::max (peak, (MYFLT) fabs (ref[i]));
+    }
+    ASSERT_GT (peak, 0.1);
+}
+
+TEST (OscillatorTests, testVco2CacheChecksHeader)
+{
+    /* a table stored without a header, as it was before the cache had */
+    /* one, is computed again and replaced                             */
+    const char *header = "gi1 vco2init 1, 0, 0, 32, 32\n";
+    char name[64];
+    snprintf (name, sizeof(name), "./vco2-0-1-32-%d-0.tab",
+              (int32_t) sizeof(MYFLT));
+    std::vector<MYFLT> stale (33, 0.25);
+    FILE *f = fopen (name, "wb");
+    ASSERT_TRUE (f != NULL);
+    fwrite (stale.data(), sizeof(MYFLT), stale.size(), f);
+    fclose (f);
+    ASSERT_EQ (0, csoundSetGlobalEnv ("CS_VCO2_CACHE", "."));
+    std::vector<MYFLT> out = renderVoices ("a1 vco2 0.5, 20000", 1, 100,
+                                           "--fftlib=0", header);
+    csoundSetGlobalEnv ("CS_VCO2_CACHE", NULL);
+    char magic[8] = { 0 };
+    f = fopen (name, "rb");
+    ASSERT_TRUE (f != NULL);
+    EXPECT_EQ (1u, fread (magic, sizeof(magic), 1, f));
+    fclose (f);
+    removeVco2Tables (32, 0);
+    ASSERT_EQ (0, memcmp (magic, "CSVCO2TB", sizeof(magic)));
+    /* a constant table would give a constant output */
+    MYFLT step = 0;
+    for (size_t i = 1; i < out.size(); i++)
+      step = std::max (step, (MYFLT) fabs (out[i] - out[i - 1]));
+    ASSERT_GT (step, 0.1);
+}
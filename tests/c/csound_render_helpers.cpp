@@ -0,0 +1,90 @@
+/*
+ * File:   csound_render_helpers.cpp
+ *
+ * Orchestras and renderers shared by the opcode tests and the benchmarks.
+ */
+
+#include "csound_render_helpers.h"
+#include "gtest/gtest.h"
+
+static std::vector<MYFLT> render (const std::string &orc, const std::string &sco,
+                                  int32_t kcycles, const char *options)
+{
+    std::vector<MYFLT> out;
+    CSOUND *cs = csoundCreate (NULL, NULL);
+    csoundSetOption (cs, "-n --logfile=null");
+    if (options != NULL)
+      csoundSetOption (cs, options);
+    EXPECT_EQ (0, csoundCompileOrc (cs, orc.c_str(), 0));
+    EXPECT_EQ (0, csoundStart (cs));
+    csoundEventString (cs, sco.c_str(), 0);
+    for (int32_t i = 0; i < kcycles; i++) {
+      csoundPerformKsmps (cs);
+      const MYFLT *spout = csoundGetSpout (cs);
+      out.insert (out.end(), spout, spout + csoundGetKsmps (cs));
+    }
+    csoundDestroy (cs);
+    return out;
+}
+
+std::vector<MYFLT> renderOpcode (const std::string &body, int32_t kcycles,
+                                 const char *options)
+{
+    std::string orc = "sr = 44100\nksmps = 64\nnchnls = 1\n0dbfs = 1\n"
+      "gi1 ftgen 1, 0, 4096, 10, 1\n"
+      "gi2 ftgen 2, 0, 4095, 10, 1\n"
+      "gi3 ftgen 3, 0, 4096, 20, 2, 1\n"
+      "instr 1\n" + body + "\nout a1\nendin\n";
+    return render (orc, "i 1 0 -1", kcycles, options);
+}
+
+std::vector<MYFLT> renderVoices (const std::string &body, int32_t voices,
+                                 int32_t kcycles, const char *options,
+                                 const char *header)
+{
+    std::string orc = "sr = 44100\nksmps = 64\nnchnls = 1\n0dbfs = 1\n" +
+      std::string (header) + "instr 1\n" + body + "\nout a1\nendin\n";
+    std::string sco;
+    for (int32_t i = 0; i < voices; i++)
+      sco += "i 1 0 -1 " + std::to_string (110 + 7 * i) + "\n";
+    return render (orc, sco, kcycles, options);
+}
+
+std::string bigOrchestra (int32_t instrs)
+{
+    std::string orc = "gkbase init 1\n";
+    for (int32_t i = 1; i <= instrs; i++) {
+      std::string n = std::to_string(i);
+      orc += "opcode Scale" + n + ", k, k\n"
+        "kin xin\n"
+        "kout = kin * " + n + "\n"
+        "if kout > 100 then\n"
+        "  kout = 100\n"
+        "endif\n"
+        "xout kout + gkbase\n"
+        "endop\n"
+        "instr " + n + "\n"
+        "k1 Scale" + n + " p4\n"
+        "if k1 > 10 then\n"
+        "  k2 = k1 * 2\n"
+        "elseif k1 > 5 then\n"
+        "  k2 = k1 + 1\n"
+        "else\n"
+        "  k2 = k1\n"
+        "endif\n"
+        "kcnt = 0\n"
+        "while kcnt < 4 do\n"
+        "  k2 += kcnt\n"
+        "  kcnt += 1\n"
+        "od\n"
+        "a1 oscili 0.1, 440 + k2, -1\n"
+        "chnset k2, \"out" + n + "\"\n"
+        "endin\n";
+    }
+    /* defines a global of its own, so is verified serially */
+    orc += "instr 1000\n"
+      "gknew = p4 + gkbase\n"
+      "chnset gknew, \"outnew\"\n"
+      "endin\n";
+    return orc;
+}
@@ -0,0 +1,31 @@
+/*
+ * File:   csound_render_helpers.h
+ *
+ * Orchestras and renderers shared by the opcode tests and the benchmarks.
+ */
+
+#ifndef CSOUND_RENDER_HELPERS_H
+#define CSOUND_RENDER_HELPERS_H
+
+#include <string>
+#include <vector>
+#include "csound.h"
+
+/* renders kcycles of instr 1, whose body sets a1, in a mono orchestra at
+   44100 Hz with ksmps 64; gi1 is a 4096 point sine, gi2 a 4095 point one
+   and gi3 a 4096 point window */
+std::vector<MYFLT> renderOpcode (const std::string &body, int32_t kcycles,
+                                 const char *options = NULL);
+
+/* as renderOpcode, but with voices notes of instr 1 at once, note i having
+   p4 = 110 + 7 * i, and header placed before the instrument */
+std::vector<MYFLT> renderVoices (const std::string &body, int32_t voices,
+                                 int32_t kcycles, const char *options = NULL,
+                                 const char *header = "");
+
+/* an orchestra of instrs similar instruments, each calling a UDO of its
+   own, with loops and branches, and one more defining a global; note 17
+   sets "out17" and note 1000 "outnew" */
+std::string bigOrchestra (int32_t instrs);
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * File:   csound_sample_playback_test.cpp
+ *
+ * Playback of sound files and SoundFonts.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "csound.h"
+#include "gtest/gtest.h"
+#include "csound_render_helpers.h"
+
+TEST (SamplePlaybackTests, testDiskin2SharedPages)
+{
+    const char *file = "diskin2_pages_test.wav";
+    std::string body;
+    /* two seconds of a 441 Hz sine, as 32 bit floats */
+    renderOpcode (std::string("a1 oscili 0.5, 441\nfout \"") + file +
+                  "\", 16, a1", 1400);
+    FILE *f = fopen (file, "rb");
+    if (f == NULL)
+      GTEST_SKIP() << "could not write a WAV file";
+    fclose (f);
+
+    /* the sinc interpolation of a transposed sine is that sine, computed */
+    /* per sample or from the tables                                      */
+    for (const char *opt : { "--no-diskin-sinc-tables",
+                             "--diskin-sinc-tables" }) {
+      for (MYFLT ratio : {0.77, 1.0003, 1.5, 2.0}) {
+        std::vector<MYFLT> out =
+          renderOpcode (std::string("a1 diskin2 \"") + file + "\", " +
+                        std::to_string(ratio) + ", 0, 0, 0, 32", 300, opt);
+        MYFLT diff = 0;
+        for (size_t n = 64; n < out.size(); n++)
+          diff = std::max(diff, (MYFLT) fabs(out[n] - 0.5 *
+                                             sin(2 * M_PI * 441 * ratio *
+                                                 n / 44100)));
+        ASSERT_LT (diff, 1e-3) << opt << " " << ratio;
+      }
+
+      /* a glide across many bands keeps the level of the sine */
+      std::vector<MYFLT> out =
+        renderOpcode (std::string("kr line 0.8, 0.07, 1.9\n"
+                                  "a1 diskin2 \"") + file +
+                      "\", kr, 0, 0, 0, 32", 300, opt);
+      MYFLT peak = 0;
+      for (size_t n = 64; n < out.size(); n++) {
+        ASSERT_TRUE (std::isfinite(out[n]));
+        peak = std::max(peak, (MYFLT) fabs(out[n]));
+      }
+      ASSERT_NEAR (peak, 0.5, 0.01) << opt;
+    }
+
+    /* many voices of one file, with and without the shared pages */
+    body = "a1 = 0\n";
+    for (int32_t i = 0; i < 64; i++)
+      body += "ax diskin2 \"" + std::string(file) + "\", " +
+        std::to_string(0.5 + i / 32.0) + ", " + std::to_string(i / 64.0) +
+        ", 1, 0, 32\na1 = a1 + ax / 64\n";
+    std::vector<MYFLT> cached = renderOpcode (body, 1000);
+    std::vector<MYFLT> plain = renderOpcode (body, 1000, "--diskin-cache=0");
+    ASSERT_EQ (cached.size(), plain.size());
+    MYFLT peak = 0;
+    for (size_t i = 0; i < cached.size(); i++) {
+      ASSERT_TRUE (std::isfinite(cached[i]));
+      ASSERT_EQ (cached[i], plain[i]);
+      peak = std::max(peak, (MYFLT) fabs(cached[i]));
+    }
+    ASSERT_GT (peak, 0.01);
+    std::remove (file);
+}
+
+TEST (SamplePlaybackTests, testSoundFontPresets)
+{
+    const std::string header = std::string ("gisf sfload \"") +
+      CSOUND_SAMPLES_DIR "/sf_GMbank.sf2\"\n"
+      "gi0 sfpreset 0, 0, gisf, 0\n"       /* first preset */
+      "gi1 sfpreset 40, 0, gisf, 1\n"
+      "gi2 sfpreset 127, 128, gisf, 2\n"   /* last one */
+      "gi3 sfpreset 0, 77, gisf, 3\n";     /* no such bank */
+    const char *instr =
+      "instr 1\n"
+      "a1 sfplaym 100, 60, 1, 1, p4\n"
+      "chnset 1, sprintf(\"found%d\", p4)\n"
+      "out a1\n"
+      "endin\n";
+    CSOUND *cs[2];
+    for (int32_t e = 0; e < 2; e++) {
+      cs[e] = csoundCreate (NULL, NULL);
+      csoundSetOption (cs[e], "-n --logfile=null");
+      ASSERT_EQ (0, csoundCompileOrc (cs[e], (header + instr).c_str(), 0));
+      ASSERT_EQ (0, csoundStart (cs[e]));
+    }
+    /* the presets asked for are found, and only those */
+    csoundEventString (cs[0], "i1 0 0.001 0\ni1 0 0.001 1\n"
+                       "i1 0 0.001 2\ni1 0 0.001 3\n", 0);
+    csoundPerformKsmps (cs[0]);
+    ASSERT_EQ (1.0, csoundGetControlChannel (cs[0], "found0", NULL));
+    ASSERT_EQ (1.0, csoundGetControlChannel (cs[0], "found1", NULL));
+    ASSERT_EQ (1.0, csoundGetControlChannel (cs[0], "found2", NULL));
+    ASSERT_EQ (0.0, csoundGetControlChannel (cs[0], "found3", NULL));
+    for (int32_t k = 0; k < 10; k++)        /* let those notes end */
+      csoundPerformKsmps (cs[0]);
+
+    /* two engines sharing the file play the same samples, and the */
+    /* second keeps them after the first has gone                  */
+    std::vector<MYFLT> out[2];
+    for (int32_t e = 0; e < 2; e++)
+      csoundEventString (cs[e], "i1 0 0.5 1\n", 0);
+    for (int32_t k = 0; k < 400; k++) {
+      if (k == 200)
+        csoundDestroy (cs[0]);
+      for (int32_t e = (k < 200 ? 0 : 1); e < 2; e++) {
+        csoundPerformKsmps (cs[e]);
+        const MYFLT *spout = csoundGetSpout (cs[e]);
+        out[e].insert (out[e].end(), spout, spout + csoundGetKsmps (cs[e]));
+      }
+    }
+    csoundDestroy (cs[1]);
+    MYFLT peak = 0;
+    for (size_t i = 0; i < out[0].size(); i++) {
+      ASSERT_EQ (out[0][i], out[1][i]);
+      peak = std::max (peak, (MYFLT) fabs (out[0][i]));
+    }
+    ASSERT_GT (peak, 0.0);
+    for (size_t i = out[0].size(); i < out[1].size(); i++)
+      ASSERT_TRUE (std::isfinite (out[1][i]));
+}
@@ -0,0 +1,93 @@
+/*
+ * File:   csound_spectral_test.cpp
+ *
+ * Streaming phase vocoder analysis and processing.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include "csound.h"
+#include "gtest/gtest.h"
+#include "csound_render_helpers.h"
+
+TEST (SpectralTests, testPvsSplitFrames)
+{
+    for (int32_t n = 512; n <= 8192; n *= 2) {
+      char body[512];
+      snprintf (body, sizeof(body), "an noise 0.5, 0\n"
+                "fa pvsanal an, %d, %d, %d, 1\n"
+                "fb pvscale fa, 1.5\n"
+                "fc pvsmooth fb, 0.1, 0.2\n"
+                "fd pvsfilter fc, fa, 0.5\n"
+                "fe pvsgain fd, 0.8\n"
+                "ff pvsmix fe, fa\n"
+                "a1 pvsynth ff", n, n / 4, n);
+      std::vector<MYFLT> split = renderOpcode (body, 600, "--pvs-split");
+      std::vector<MYFLT> ref = renderOpcode (body, 600);
+      MYFLT diff = 0, peak = 0;
+      ASSERT_EQ (ref.size(), split.size());
+      for (size_t i = 0; i < ref.size(); i++) {
+        ASSERT_TRUE (std::isfinite(split[i]));
+        diff = std::max(diff, (MYFLT) fabs(split[i] - ref[i]));
+        peak = std::max(peak, (MYFLT) fabs(ref[i]));
+      }
+      ASSERT_GT (peak, 0.01);
+      ASSERT_LT (diff, 1e-5 * peak);
+    }
+}
+
+TEST (SpectralTests, testSlidingAnalysis)
+{
+    /* an overlap below ksmps makes pvsanal slide one sample at a time */
+    const char *fmt = "a2 oscili 0.5, 440\n"
+      "fa pvsanal a2, 1024, 32, 1024, 1, 0, 0, %d, %d, %d\n"
+      "a1 pvsynth fa";
+    char body[256];
+    snprintf (body, sizeof(body), fmt, 0, 0, -1);
+    std::vector<MYFLT> ref = renderOpcode (body, 100);
+    snprintf (body, sizeof(body), fmt, 4, 0, -1);
+    std::vector<MYFLT> thr = renderOpcode (body, 100);
+    /* 440 Hz is bin 10 of 1024 at 44100 */
+    snprintf (body, sizeof(body), fmt, 0, 5, 15);
+    std::vector<MYFLT> band = renderOpcode (body, 100);
+    ASSERT_EQ (ref.size(), thr.size());
+    ASSERT_EQ (ref.size(), band.size());
+    MYFLT diff = 0, peak = 0;
+    for (size_t i = 0; i < ref.size(); i++) {
+      ASSERT_TRUE (std::isfinite(ref[i]));
+      ASSERT_EQ (ref[i], thr[i]);
+      /* past the first window, when the onset has spread over every bin */
+      if (i >= 2048) {
+        diff = std::max(diff, (MYFLT) fabs(band[i] - ref[i]));
+        peak = std::max(peak, (MYFLT) fabs(ref[i]));
+      }
+    }
+    ASSERT_GT (peak, 0.1);
+    ASSERT_LT (diff, 1e-3 * peak);
+}
+
+TEST (SpectralTests, testSlidingAnalysisVoices)
+{
+    /* the voices share the engine's worker threads, or do without when
+       another has them, and are still running when the engine goes */
+    const char *fmt = "a2 oscili 0.2, p4\n"
+      "fa pvsanal a2, 1024, 32, 1024, 1, 0, 0, %d\n"
+      "a1 pvsynth fa";
+    char body[256];
+    snprintf (body, sizeof(body), fmt, 0);
+    std::vector<MYFLT> ref = renderVoices (body, 3, 100);
+    snprintf (body, sizeof(body), fmt, 4);
+    std::vector<MYFLT> thr = renderVoices (body, 3, 100);
+    std::vector<MYFLT> par = renderVoices (body, 3, 100, "-j2");
+    ASSERT_EQ (ref.size(), thr.size());
+    ASSERT_EQ (ref.size(), par.size());
+    MYFLT peak = 0;
+    for (size_t i = 0; i < ref.size(); i++) {
+      ASSERT_EQ (ref[i], thr[i]);
+      ASSERT_EQ (ref[i], par[i]);
+      peak = std::max(peak, (MYFLT) fabs(ref[i]));
+    }
+    ASSERT_GT (peak, 0.1);
+}
@@ -0,0 +1,157 @@
+/*
+ * File:   csound_vecops_test.cpp
+ *
+ * Vector kernels for a-rate arithmetic and the vectorized math functions.
+ */
+
+#define __BUILDING_LIBCSOUND
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <functional>
+#include <limits>
+#include "csoundCore.h"
+#include "vecops.h"
+#include "gtest/gtest.h"
+
+TEST (VecOpsTests, testVectorKernels)
+{
+    typedef std::function<void(const VECOPS *, MYFLT *, uint32_t)> KERNEL;
+    const uint32_t n = 1027;        /* odd, so every tail length occurs */
+    std::vector<MYFLT> a(n), b(n), r0(n), r1(n);
+    for (uint32_t i = 0; i < n; i++) {
+      a[i] = (i % 13 == 0 ? 0 : sin(i * 0.37) * (i % 7 - 3.5));
+      b[i] = (i % 17 == 0 ? 0 : cos(i * 1.1) + 1e-3 * i);
+    }
+    MYFLT k = b[5];
+    const std::pair<const char *, KERNEL> ops[] = {
+      { "add",  [&](const VECOPS *v, MYFLT *r, uint32_t m) {
+          v->add (r, a.data(), b.data(), m); } },
+      { "sub",  [&](const VECOPS *v, MYFLT *r, uint32_t m) {
+          v->sub (r, a.data(), b.data(), m); } },
+      { "mul",  [&](const VECOPS *v, MYFLT *r, uint32_t m) {
+          v->mul (r, a.data(), b.data(), m); } },
+      { "div",  [&](const VECOPS *v, MYFLT *r, uint32_t m) {
+          v->div (r, a.data(), b.data(), m); } },
+      { "addk", [&](const VECOPS *v, MYFLT *r, uint32_t m) {
+          v->addk (r, a.data(), k, m); } },
+      { "subk", [&](const VECOPS *v, MYFLT *r, uint32_t m) {
+          v->subk (r, a.data(), k, m); } },
+      { "mulk", [&](const VECOPS *v, MYFLT *r, uint32_t m) {
+          v->mulk (r, a.data(), k, m); } },
+      { "divk", [&](const VECOPS *v, MYFLT *r, uint32_t m) {
+          v->divk (r, a.data(), k, m); } },
+      { "ksub", [&](const VECOPS *v, MYFLT *r, uint32_t m) {
+          v->ksub (r, a.data(), k, m); } },
+      { "kdiv", [&](const VECOPS *v, MYFLT *r, uint32_t m) {
+          v->kdiv (r, a.data(), k, m); } },
+      { "abs",  [&](const VECOPS *v, MYFLT *r, uint32_t m) {
+          v->absv (r, a.data(), m); } },
+      { "sqrt", [&](const VECOPS *v, MYFLT *r, uint32_t m) {
+          v->sqrtv (r, a.data(), m); } }
+    };
+    const VECOPS *ref = csoundVecOpsLevel (VECOPS_SCALAR);
+    ASSERT_NE (nullptr, ref);
+    ASSERT_NE (nullptr, csoundVecOps ());
+    for (int32_t level = VECOPS_SCALAR; level <= VECOPS_NEON; level++) {
+      const VECOPS *v = csoundVecOpsLevel (level);
+      if (v == NULL)
+        continue;
+      for (const auto &op : ops) {
+        /* bit for bit the same as the C loops, NaNs aside */
+        for (uint32_t m : { 0U, 1U, 3U, 5U, 7U, 64U, n }) {
+          op.second (ref, r0.data(), m);
+          op.second (v, r1.data(), m);
+          for (uint32_t i = 0; i < m; i++) {
+            if (!(std::isnan(r0[i]) && std::isnan(r1[i]))) {
+              ASSERT_EQ (0, memcmp (&r0[i], &r1[i], sizeof(MYFLT)))
+                << v->name << " " << op.first << " at " << i;
+            }
+          }
+        }
+      }
+      ASSERT_EQ (ref->anyzero (a.data(), n) != 0, v->anyzero (a.data(), n) != 0);
+      ASSERT_EQ (0, v->anyzero (a.data() + 1, 12));
+    }
+}
+
+TEST (VecOpsTests, testVectorMath)
+{
+    typedef void (*MATHFN)(MYFLT *, const MYFLT *, uint32_t);
+    struct {
+      const char *name;
+      MATHFN VECMATH::*fn;
+      long double (*ref)(long double);
+      double lo, hi, ulps;
+    } fns[] = {
+      { "exp",   &VECMATH::expv,   expl,   -80.0, 80.0, 1 },
+      { "exp2",  &VECMATH::exp2v,  exp2l,  -100.0, 100.0, 1 },
+      { "log",   &VECMATH::logv,   logl,   1e-6, 1e6, 1 },
+      { "log2",  &VECMATH::log2v,  log2l,  1e-6, 1e6, 1 },
+      { "log10", &VECMATH::log10v, log10l, 1e-6, 1e6, 1 },
+      { "sin",   &VECMATH::sinv,   sinl,   -1000.0, 1000.0, 1 },
+      { "cos",   &VECMATH::cosv,   cosl,   -1000.0, 1000.0, 1 },
+      { "tan",   &VECMATH::tanv,   tanl,   -10.0, 10.0, 3 },
+      { "sinh",  &VECMATH::sinhv,  sinhl,  -20.0, 20.0, 3 },
+      { "cosh",  &VECMATH::coshv,  coshl,  -20.0, 20.0, 3 },
+      { "tanh",  &VECMATH::tanhv,  tanhl,  -20.0, 20.0, 3 }
+    };
+    const uint32_t n = 4099;
+    const long double eps = std::numeric_limits<MYFLT>::epsilon();
+    std::vector<MYFLT> a(n), r(n);
+    for (const auto &f : fns) {
+      for (uint32_t i = 0; i < n; i++)
+        a[i] = f.lo + (f.hi - f.lo) * i / (n - 1);
+      for (int32_t acc = VECMATH_EXACT; acc <= VECMATH_FAST; acc++) {
+        const VECMATH *vm = csoundVecMath (acc);
+        ASSERT_EQ (acc, vm->accuracy);
+        (vm->*f.fn) (r.data(), a.data(), n);
+        for (uint32_t i = 0; i < n; i++) {
+          long double y = f.ref (a[i]);
+          /* ulps of MYFLT, which are float ulps in a float build */
+          double err = fabsl (r[i] - y) /
+            (fabsl (y) < eps ? eps : ldexpl (eps, ilogbl (y)));
+          if (acc == VECMATH_FAST) {
+            ASSERT_LE (fabsl (r[i] - y), 1e-7 * fabsl (y))
+              << vm->name << " " << f.name << "(" << a[i] << ")";
+          }
+          else if (acc == VECMATH_ULP) {
+            ASSERT_LE (err, f.ulps)
+              << vm->name << " " << f.name << "(" << a[i] << ")";
+          }
+        }
+        /* in place, with an input out of the kernels' range */
+        std::vector<MYFLT> b (a);
+        b[100] = f.hi * 1e3;
+        (vm->*f.fn) (b.data(), b.data(), n);
+        for (uint32_t i = 128; i < n; i++)
+          ASSERT_EQ (0, memcmp (&b[i], &r[i], sizeof(MYFLT)))
+            << vm->name << " " << f.name << " at " << i;
+      }
+    }
+}
+
+TEST (VecOpsTests, testMathAccuracyOption)
+{
+    /* fast functions stay close to the exact ones in an orchestra */
+    const char *orc = "sr = 44100\nksmps = 16\nnchnls = 2\n0dbfs = 1\n"
+      "instr 1\n"
+      "a1 = 0.3\n"
+      "out exp(a1) * sin(a1), ampdb(a1 * 20)\n"
+      "endin\n";
+    CSOUND *csound = csoundCreate (NULL, NULL);
+    csoundSetOption (csound, "-n --logfile=null");
+    csoundSetOption (csound, "--math-accuracy=fast");
+    ASSERT_EQ (VECMATH_FAST, csound->oparms->math_accuracy);
+    ASSERT_EQ (0, csoundCompileOrc (csound, orc, 0));
+    ASSERT_EQ (0, csoundStart (csound));
+    csoundEventString (csound, "i 1 0 1", 0);
+    for (int32_t i = 0; i < 4; i++)
+      csoundPerformKsmps (csound);
+    const MYFLT *spout = csoundGetSpout (csound);
+    ASSERT_NEAR (exp(0.3) * sin(0.3), spout[0], 1e-6);
+    ASSERT_NEAR (pow(10.0, 0.3), spout[1], 1e-6);
+    csoundDestroy (csound);
+}
@@ -1,8 +1,12 @@
 #include "csound.h"
 #include "csound_graph_display.h"
 #include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
 #include "gtest/gtest.h"
 #include "time.h"
+#include "csound_render_helpers.h"
 
 class EngineTests : public ::testing::Test {
 public:
@@ -37,3 +41,73 @@ TEST_F (EngineTests, testUdpServer)
     csoundStart(csound);
     csoundSleep(1000);
 }
+
+TEST_F (EngineTests, testSignalFlowGraphRouting)
+{
+    csoundSetOption (csound, "-n -j2");
+    ASSERT_EQ (0, csoundCompileOrc (csound,
+                                    "ksmps = 32\n"
+                                    "connect 1, \"out\", 2, \"in\"\n"
+                                    "instr 1\n"
+                                    "outleta \"out\", a(p4)\n"
+                                    "endin\n"
+                                    "instr 2\n"
+                                    "a1 inleta \"in\"\n"
+                                    "chnset k(a1), \"sum\"\n"
+                                    "endin\n", 0));
+    ASSERT_EQ (0, csoundStart (csound));
+    csoundEventString (csound, "i 1.1 0 -1 0.25\n"
+                       "i 1.2 0 -1 0.5\n"
+                       "i 2 0 -1", 0);
+    /* with -j the instances of a cycle run in any order, so an outlet
+       may reach the inlet a cycle late; a(p4) settles after one cycle */
+    for (int32_t i = 0; i < 4; i++)
+      csoundPerformKsmps (csound);
+    ASSERT_DOUBLE_EQ (0.75, csoundGetControlChannel (csound, "sum", NULL));
+    /* the inlet stops reading an outlet once its note is off */
+    csoundEventString (csound, "i -1.2 0 0", 0);
+    for (int32_t i = 0; i < 4; i++)
+      csoundPerformKsmps (csound);
+    ASSERT_DOUBLE_EQ (0.25, csoundGetControlChannel (csound, "sum", NULL));
+}
+
+TEST_F (EngineTests, testLockstepPolyphony)
+{
+    /* oscillator, envelope and filter all have batch kernels, and the
+       outputs add up in the same order, so lockstep changes nothing */
+    const char *voice = "a2 oscili 0.1, p4\n"
+      "a3 linseg 0, 0.05, 1, 0.1, 0.5\n"
+      "a1 moogladder a2 * a3, 2000, 0.5";
+    std::vector<MYFLT> ref = renderVoices (voice, 64, 400);
+    std::vector<MYFLT> out = renderVoices (voice, 64, 400, "--lockstep");
+    ASSERT_EQ (ref.size(), out.size());
+    MYFLT peak = 0;
+    for (size_t i = 0; i < ref.size(); i++) {
+      ASSERT_EQ (ref[i], out[i]) << "at " << i;
+      peak = std::max(peak, (MYFLT) fabs(ref[i]));
+    }
+    ASSERT_GT (peak, 0.01);
+
+    /* voices whose branches differ leave the group and finish alone */
+    const char *branchy = "a1 oscili 0.01, p4\n"
+      "kf = p4\n"
+      "if kf > 300 then\n"
+      "a1 = a1 * 0.5\n"
+      "endif";
+    ref = renderVoices (branchy, 16, 20);
+    out = renderVoices (branchy, 16, 20, "--lockstep");
+    ASSERT_EQ (ref.size(), out.size());
+    for (size_t i = 0; i < ref.size(); i++)
+      ASSERT_NEAR (ref[i], out[i], 1e-6) << "at " << i;
+
+    /* each voice reads what the one before it wrote to a global, so
+       the instrument must not be interleaved */
+    const char *chained = "k1 = gkacc\n"
+      "gkacc = k1 * 0.5 + p4 * 0.001\n"
+      "a1 oscili 0.01, 200 + k1 * 100";
+    ref = renderVoices (chained, 16, 20, NULL, "gkacc init 0\n");
+    out = renderVoices (chained, 16, 20, "--lockstep", "gkacc init 0\n");
+    ASSERT_EQ (ref.size(), out.size());
+    for (size_t i = 0; i < ref.size(); i++)
+      ASSERT_EQ (ref[i], out[i]) << "at " << i;
+}
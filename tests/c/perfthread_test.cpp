@@ -4,6 +4,8 @@
 # include "unistd.h"
 #endif
 #include <stdio.h>
+#include <chrono>
+#include <thread>
 #include "gtest/gtest.h"
 
 #include "csound.hpp"
@@ -65,3 +67,126 @@ TEST(PerfThreadsTests, Record) {
     performanceThread1.Join();
     csound.Reset();
 }
+
+/* waits until the channel holds value, for at most ten seconds */
+static bool waitForChannel(Csound *csound, const char *name, MYFLT value)
+{
+    std::chrono::steady_clock::time_point end =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (csound->GetControlChannel(name) != value) {
+      if (std::chrono::steady_clock::now() > end)
+        return false;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+typedef struct {
+    std::chrono::steady_clock::time_point last;
+    double maxBlock;
+    long   blocks;
+} blockTiming_t;
+
+static void measureBlock(void *data)
+{
+    blockTiming_t *t = (blockTiming_t *) data;
+    std::chrono::steady_clock::time_point now =
+      std::chrono::steady_clock::now();
+    if (t->blocks++) {
+      double d = std::chrono::duration<double>(now - t->last).count();
+      if (d > t->maxBlock)
+        t->maxBlock = d;
+    }
+    t->last = now;
+}
+
+TEST(PerfThreadsTests, ScoreEventFlood) {
+    const char *instrument =
+        "giCount init 0 \n"
+        "instr 1 \n"
+        "giCount = giCount + 1 \n"
+        "chnset giCount, \"count\" \n"
+        "endin \n";
+    const int numEvents = 20000;
+
+    Csound csound;
+    csound.SetOption("-n");
+    csound.CompileOrc(instrument);
+    csound.EventString("f 0 z");
+    csound.Start();
+
+    blockTiming_t timing;
+    timing.maxBlock = 0.0;
+    timing.blocks = 0;
+    CsoundPerformanceThread performanceThread(csound.GetCsound());
+    performanceThread.SetProcessCallback(measureBlock, &timing);
+    performanceThread.Play();
+
+    std::thread sender([&performanceThread, numEvents]() {
+        MYFLT p[3] = { 1, 0, 0 };
+        for (int i = 0; i < numEvents; i++)
+          performanceThread.ScoreEvent(0, 'i', 3, p);
+    });
+    sender.join();
+    performanceThread.FlushMessageQueue();
+    ASSERT_TRUE(waitForChannel(&csound, "count", (MYFLT) numEvents));
+    printf("%d score events, %ld blocks, worst-case block time %.3f ms\n",
+           numEvents, timing.blocks, timing.maxBlock * 1000.0);
+
+    performanceThread.Stop();
+    performanceThread.Join();
+    csound.Reset();
+}
+
+TEST(PerfThreadsTests, ThreadPool) {
+    const char *instrument =
+        "ksmps = 64\n"
+        "giCount init 0 \n"
+        "instr 1 \n"
+        "giCount = giCount + 1 \n"
+        "chnset giCount, \"count\" \n"
+        "out oscili(0.1, 440) \n"
+        "endin \n";
+    const int numInstances = 8;
+
+    CsoundPerformanceThreadPool pool(2, true);
+    Csound *csound[numInstances];
+    CsoundPerformanceThread *performanceThread[numInstances];
+    for (int i = 0; i < numInstances; i++) {
+      csound[i] = new Csound();
+      csound[i]->SetOption("-n");
+      csound[i]->CompileOrc(instrument);
+      csound[i]->EventString("f 0 z");
+      csound[i]->Start();
+      performanceThread[i] =
+        new CsoundPerformanceThread(csound[i]->GetCsound(), &pool, i & 1);
+      performanceThread[i]->Play();
+    }
+    ASSERT_EQ(pool.GetNumInstances(), numInstances);
+
+    MYFLT p[3] = { 1, 0, 0 };
+    for (int i = 0; i < numInstances; i++) {
+      for (int j = 0; j <= i; j++)
+        performanceThread[i]->ScoreEvent(0, 'i', 3, p);
+      performanceThread[i]->FlushMessageQueue();
+    }
+    for (int i = 0; i < numInstances; i++)
+      ASSERT_TRUE(waitForChannel(csound[i], "count", (MYFLT) (i + 1)));
+
+    CS_PERF_THREAD_POOL_STATS stats;
+    pool.GetStatistics(&stats);
+    ASSERT_EQ(stats.numThreads, 2);
+    ASSERT_GT(stats.blocks, 0.0);
+    printf("%d instances on %d threads: %.0f blocks, %.0f late, "
+           "load %.3f\n", stats.numInstances, stats.numThreads,
+           stats.blocks, stats.missedDeadlines, stats.load);
+
+    for (int i = 0; i < numInstances; i++)
+      performanceThread[i]->Stop();
+    for (int i = 0; i < numInstances; i++) {
+      performanceThread[i]->Join();
+      delete performanceThread[i];
+      delete csound[i];
+    }
+    ASSERT_EQ(pool.GetNumInstances(), 0);
+}
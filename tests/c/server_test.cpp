@@ -1,4 +1,7 @@
 #include <stdio.h>
+#include <chrono>
+#include <thread>
+#include <string>
 #include "gtest/gtest.h"
 #if defined(WIN32) && !defined(__CYGWIN__) 
 # include <winsock2.h>
@@ -18,7 +21,7 @@
 #include "csound.hpp"
 #include "csPerfThread.hpp"
 
-void udp_send(const char* msg) {
+void udp_send_data(const char* msg, size_t len, int port = 44100) {
     struct sockaddr_in server_addr;
     int32_t sock;
 #if defined(WIN32) && !defined(__CYGWIN__)
@@ -52,12 +55,66 @@ void udp_send(const char* msg) {
 #else
     inet_aton("127.0.0.1", &server_addr.sin_addr);
 #endif
-    server_addr.sin_port = htons((int)44100);
-    sendto(sock, msg, strlen(msg) + 1, 0,
+    server_addr.sin_port = htons(port);
+    sendto(sock, msg, len, 0,
         (const struct sockaddr*)&server_addr,
         sizeof(server_addr));
 }
 
+void udp_send(const char* msg) {
+    udp_send_data(msg, strlen(msg) + 1);
+}
+
+/* OSC encoding helpers for the bundle test */
+static size_t osc_put_string(char* buf, const char* s) {
+    size_t n = strlen(s), size = (n + 4) & ~3;
+    memset(buf, 0, size);
+    memcpy(buf, s, n);
+    return size;
+}
+
+static size_t osc_put_int(char* buf, uint32_t v) {
+    buf[0] = (char) (v >> 24);
+    buf[1] = (char) (v >> 16);
+    buf[2] = (char) (v >> 8);
+    buf[3] = (char) v;
+    return 4;
+}
+
+static size_t osc_put_float(char* buf, float f) {
+    uint32_t v;
+    memcpy(&v, &f, 4);
+    return osc_put_int(buf, v);
+}
+
+/* sends one OSC message with a float, an int or an empty string */
+static void osc_send_number(int port, const char* path, char type, float v) {
+    char msg[128];
+    size_t len = osc_put_string(msg, path);
+    char types[3] = {',', type, 0};
+    len += osc_put_string(msg + len, types);
+    if (type == 'f')
+      len += osc_put_float(msg + len, v);
+    else if (type == 'i')
+      len += osc_put_int(msg + len, (uint32_t) (int32_t) v);
+    else
+      len += osc_put_string(msg + len, "");
+    udp_send_data(msg, len, port);
+}
+
+/* performs until the channel holds value, for at most ten seconds */
+static bool performUntil(CSOUND* csound, const char* name, MYFLT value) {
+    std::chrono::steady_clock::time_point end =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (csoundGetControlChannel(csound, name, NULL) != value) {
+      if (std::chrono::steady_clock::now() > end)
+        return false;
+      csoundPerformKsmps(csound);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
 class ServerTests : public ::testing::Test {
 public:
     ServerTests ()
@@ -111,3 +168,258 @@ TEST_F (ServerTests, testServer) {
     performanceThread.Join();
     csound.Reset();
 }
+
+TEST_F (ServerTests, testOSCBundle) {
+    const char  *instrument =
+        "instr 1 \n"
+        "chnset chnget:i(\"count\") + p4, \"count\" \n"
+        "endin \n";
+    char bundle[1024], msg[64];
+    size_t size = 0, len;
+    int i;
+
+    Csound csound;
+    csound.SetOption("-n");
+    csound.SetOption("--port=44100");
+    csound.Start();
+
+    CsoundPerformanceThread performanceThread(csound.GetCsound());
+    performanceThread.Play();
+
+    udp_send(instrument);
+    csoundSleep(500);
+
+    /* time tag 1 means immediately */
+    size += osc_put_string(bundle, "#bundle");
+    size += osc_put_int(bundle + size, 0);
+    size += osc_put_int(bundle + size, 1);
+    for (i = 0; i < 10; i++) {
+        len = osc_put_string(msg, "/csound/event/instr");
+        len += osc_put_string(msg + len, ",ffff");
+        len += osc_put_float(msg + len, 1);
+        len += osc_put_float(msg + len, 0);
+        len += osc_put_float(msg + len, 0);
+        len += osc_put_float(msg + len, 1);
+        size += osc_put_int(bundle + size, (uint32_t) len);
+        memcpy(bundle + size, msg, len);
+        size += len;
+    }
+    len = osc_put_string(msg, "/csound/channel/amp");
+    len += osc_put_string(msg + len, ",f");
+    len += osc_put_float(msg + len, 0.5f);
+    size += osc_put_int(bundle + size, (uint32_t) len);
+    memcpy(bundle + size, msg, len);
+    size += len;
+    udp_send_data(bundle, size);
+
+    csoundSleep(500);
+    ASSERT_DOUBLE_EQ (csound.GetChannel("count"), 10.0);
+    ASSERT_DOUBLE_EQ (csound.GetChannel("amp"), 0.5);
+
+    udp_send("##close##");
+
+    performanceThread.Join();
+    csound.Reset();
+}
+
+TEST_F (ServerTests, testOSCBundleTimeTag) {
+    const char  *instrument =
+        "instr 1 \n"
+        "chnset chnget:i(\"count\") + p4, \"count\" \n"
+        "endin \n";
+    char bundle[256], msg[64];
+    size_t size = 0, len;
+
+    Csound csound;
+    /* time tags are wall-clock times, so the engine must run in real
+       time: the null audio module paces it without a device */
+    csound.SetOption("-odac");
+    csound.SetOption("-+rtaudio=null");
+    csound.SetOption("--port=44100");
+    csound.Start();
+
+    CsoundPerformanceThread performanceThread(csound.GetCsound());
+    performanceThread.Play();
+
+    udp_send(instrument);
+    csoundSleep(500);
+
+    /* a bundle due one second from now, as an NTP time */
+    double due = std::chrono::duration<double>(
+      std::chrono::system_clock::now().time_since_epoch()).count() + 1.0;
+    double secs = due + 2208988800.0;
+    size += osc_put_string(bundle, "#bundle");
+    size += osc_put_int(bundle + size, (uint32_t) secs);
+    size += osc_put_int(bundle + size,
+                        (uint32_t) ((secs - (uint32_t) secs) * 4294967296.0));
+    len = osc_put_string(msg, "/csound/event/instr");
+    len += osc_put_string(msg + len, ",ffff");
+    len += osc_put_float(msg + len, 1);
+    len += osc_put_float(msg + len, 0);
+    len += osc_put_float(msg + len, 0);
+    len += osc_put_float(msg + len, 1);
+    size += osc_put_int(bundle + size, (uint32_t) len);
+    memcpy(bundle + size, msg, len);
+    size += len;
+    udp_send_data(bundle, size);
+
+    /* not before it is due, but soon after */
+    csoundSleep(300);
+    ASSERT_DOUBLE_EQ (csound.GetChannel("count"), 0.0);
+    double late;
+    for (;;) {
+      late = std::chrono::duration<double>(
+        std::chrono::system_clock::now().time_since_epoch()).count() - due;
+      if (csound.GetChannel("count") != 0.0 || late > 5.0)
+        break;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_DOUBLE_EQ (csound.GetChannel("count"), 1.0);
+    ASSERT_GT (late, -0.1);
+
+    udp_send("##close##");
+
+    performanceThread.Join();
+    csound.Reset();
+}
+
+TEST_F (ServerTests, testOSCTruncatedEvent) {
+    const char  *instrument =
+        "instr 1 \n"
+        "chnset chnget:i(\"count\") + p4, \"count\" \n"
+        "endin \n";
+    char msg[64];
+    size_t len;
+
+    Csound csound;
+    csound.SetOption("-n");
+    csound.SetOption("--port=44100");
+    csound.Start();
+
+    CsoundPerformanceThread performanceThread(csound.GetCsound());
+    performanceThread.Play();
+
+    udp_send(instrument);
+    csoundSleep(500);
+
+    /* four p-fields declared, three sent: the event is dropped */
+    len = osc_put_string(msg, "/csound/event/instr");
+    len += osc_put_string(msg + len, ",ffff");
+    len += osc_put_float(msg + len, 1);
+    len += osc_put_float(msg + len, 0);
+    len += osc_put_float(msg + len, 0);
+    udp_send_data(msg, len);
+    len += osc_put_float(msg + len, 1);
+    udp_send_data(msg, len);
+
+    csoundSleep(500);
+    ASSERT_DOUBLE_EQ (csound.GetChannel("count"), 1.0);
+
+    udp_send("##close##");
+
+    performanceThread.Join();
+    csound.Reset();
+}
+
+TEST_F (ServerTests, testOSClistenDispatch) {
+    const char  *orc =
+        "giport OSCinit 7770\n"
+        "instr 1\n"
+        "kna init 0\n"
+        "knb init 0\n"
+        "ksum init 0\n"
+        "kf init 0\n"
+        "ki init 0\n"
+        "nxta:\n"
+        "ka OSClisten giport, \"/test/a\", \"f\", kf\n"
+        "if ka == 0 kgoto nxtb\n"
+        "kna += 1\n"
+        "chnset kf, \"lasta\"\n"
+        "chnset kna, \"na\"\n"
+        "kgoto nxta\n"
+        "nxtb:\n"
+        "kb OSClisten giport, \"/test/b\", \"i\", ki\n"
+        "if kb == 0 kgoto done\n"
+        "knb += 1\n"
+        "ksum += ki\n"
+        "chnset ksum, \"sumb\"\n"
+        "chnset knb, \"nb\"\n"
+        "kgoto nxtb\n"
+        "done:\n"
+        "endin\n";
+
+    csoundSetOption(csound, "-n");
+    if (csoundCompileOrc(csound, orc, 0) != 0)
+      GTEST_SKIP() << "OSC opcodes not available";
+    ASSERT_EQ (0, csoundStart(csound));
+    csoundEventString(csound, "i1 0 -1", 0);
+    csoundPerformKsmps(csound);
+
+    /* each path reaches only its own listener, in order; a path with */
+    /* no listener and a type no listener takes are ignored           */
+    for (int i = 1; i <= 5; i++) {
+      osc_send_number(7770, "/test/a", 'f', (float) i);
+      if (i <= 3)
+        osc_send_number(7770, "/test/b", 'i', (float) (10 * i));
+    }
+    osc_send_number(7770, "/test/c", 'f', 100);
+    osc_send_number(7770, "/test/b", 's', 0);
+    ASSERT_TRUE (performUntil(csound, "na", 5));
+    ASSERT_TRUE (performUntil(csound, "nb", 3));
+    csoundSleep(200);
+    for (int k = 0; k < 20; k++)
+      csoundPerformKsmps(csound);
+    ASSERT_DOUBLE_EQ (csoundGetControlChannel(csound, "na", NULL), 5.0);
+    ASSERT_DOUBLE_EQ (csoundGetControlChannel(csound, "lasta", NULL), 5.0);
+    ASSERT_DOUBLE_EQ (csoundGetControlChannel(csound, "nb", NULL), 3.0);
+    ASSERT_DOUBLE_EQ (csoundGetControlChannel(csound, "sumb", NULL), 60.0);
+}
+
+TEST_F (ServerTests, testOSClistenOverflow) {
+    const char  *orc =
+        "giport OSCinit 7771\n"
+        "instr 1\n"
+        "kn init 0\n"
+        "kv init 0\n"
+        "kpoll chnget \"poll\"\n"
+        "if kpoll == 0 kgoto done\n"
+        "nxt:\n"
+        "kk OSClisten giport, \"/test/q\", \"f\", kv\n"
+        "if kk == 0 kgoto done\n"
+        "kn += 1\n"
+        "chnset kv, \"last\"\n"
+        "chnset kn, \"n\"\n"
+        "kgoto nxt\n"
+        "done:\n"
+        "endin\n";
+
+    csoundSetOption(csound, "-n");
+    if (csoundCompileOrc(csound, orc, 0) != 0)
+      GTEST_SKIP() << "OSC opcodes not available";
+    ASSERT_EQ (0, csoundStart(csound));
+    csoundEventString(csound, "i1 0 -1", 0);
+    csoundPerformKsmps(csound);
+
+    /* nobody reads while 160 messages arrive: the queue keeps the */
+    /* first 127 and drops the rest, with a warning                */
+    for (int i = 1; i <= 160; i++)
+      osc_send_number(7771, "/test/q", 'f', (float) i);
+    csoundSleep(500);
+    csoundSetControlChannel(csound, "poll", 1);
+    ASSERT_TRUE (performUntil(csound, "n", 127));
+    for (int k = 0; k < 20; k++)
+      csoundPerformKsmps(csound);
+    ASSERT_DOUBLE_EQ (csoundGetControlChannel(csound, "n", NULL), 127.0);
+    ASSERT_DOUBLE_EQ (csoundGetControlChannel(csound, "last", NULL), 127.0);
+    std::string messages;
+    while (csoundGetMessageCnt(csound)) {
+      messages += csoundGetFirstMessage(csound);
+      csoundPopFirstMessage(csound);
+    }
+    ASSERT_NE (std::string::npos, messages.find("dropped, queue full"));
+
+    /* and it takes messages again once drained */
+    osc_send_number(7771, "/test/q", 'f', 1000);
+    ASSERT_TRUE (performUntil(csound, "n", 128));
+    ASSERT_DOUBLE_EQ (csoundGetControlChannel(csound, "last", NULL), 1000.0);
+}
@@ -457,6 +457,7 @@ in pkgs.stdenvNoCC.mkDerivation rec {
       ../Opcodes/fareygen.c \
       ../Opcodes/fareyseq.c \
       ../Opcodes/filter.c \
+      ../Opcodes/filterbank.c \
       ../Opcodes/flanger.c \
       ../Opcodes/fm4op.c \
       ../Opcodes/follow.c \